@@ -1,10 +1,150 @@
 #include "bcm_func.h"
+#include "bcm_fleet.h"
+#include "bcm_scheduler.h"
+#include "../common_includes/ecu_shutdown.h"
+#include <getopt.h>
 
 #define CAN_INTERFACE       ("vcan0")
+#define DEFAULT_CYCLE       ("../src/bcm/full_simu.csv")
 #define ERROR_CODE          (1)
 
-int main(void)
+// Split a comma separated option in place; returns the number of items
+static unsigned int split_list(char *text, const char **items, unsigned int max_items)
 {
+    unsigned int count = 0U;
+    char *save = NULL;
+
+    for (char *item = strtok_r(text, ",", &save); (item != NULL) && (count < max_items);
+         item = strtok_r(NULL, ",", &save))
+    {
+        items[count++] = item;
+    }
+    return count;
+}
+
+/* Several vehicles from one process: one send socket per interface, all
+   vehicles driven by the fleet timer wheel on this thread */
+static int run_fleet(BcmFleetConfig *config, const char **ifaces, unsigned int num_ifaces)
+{
+    BcmFleet *fleet = (BcmFleet *)malloc(sizeof(BcmFleet));
+    int status = EXIT_SUCCESS;
+
+    if (fleet == NULL)
+    {
+        return ERROR_CODE;
+    }
+    for (unsigned int i = 0U; i < num_ifaces; i++)
+    {
+        config->socks[i] = create_can_socket(ifaces[i]);
+        if (config->socks[i] < 0)
+        {
+            free(fleet);
+            return ERROR_CODE;
+        }
+        config->num_socks++;
+    }
+
+    if (bcm_fleet_init(fleet, config, timer_wheel_now_ms()))
+    {
+        // Opt-in snapshots (ECU_CHECKPOINT_DIR): a long fleet run survives a restart
+        static Checkpoint checkpoint;
+        if (checkpoint_init(&checkpoint, "bcm_fleet"))
+        {
+            if (bcm_fleet_restore(fleet, &checkpoint, timer_wheel_now_ms()))
+            {
+                printf("Resumed from checkpoint %llu\n", (unsigned long long)checkpoint.sequence);
+            }
+            fleet->checkpoint = &checkpoint;
+            // The periodic snapshots are written off the event loop
+            (void)checkpoint_start_writer(&checkpoint);
+        }
+        printf("Simulating %u vehicles\n", fleet->count);
+        fflush(stdout);
+        bcm_fleet_run(fleet, ecu_shutdown_fd());
+        if (fleet->checkpoint != NULL)
+        {
+            checkpoint_stop_writer(fleet->checkpoint);
+            (void)bcm_fleet_checkpoint(fleet, fleet->checkpoint, timer_wheel_now_ms());
+        }
+
+        for (unsigned int i = 0U; i < fleet->count; i++)
+        {
+            const BcmVehicle *vehicle = &fleet->vehicles[i];
+            printf("vehicle %u: ids 0x%03X/0x%03X, %lu steps, %lu laps%s\n", i,
+                   (unsigned int)vehicle->sensor_can_id, (unsigned int)vehicle->command_can_id,
+                   vehicle->published, vehicle->laps, (vehicle->fault_flags != 0U) ? ", faulted" : "");
+        }
+        bcm_fleet_free(fleet);
+    }
+    else
+    {
+        status = ERROR_CODE;
+    }
+
+    for (unsigned int i = 0U; i < config->num_socks; i++)
+    {
+        close_can_socket(config->socks[i]);
+    }
+    free(fleet);
+    return status;
+}
+
+int main(int argc, char **argv)
+{
+    BcmFleetConfig fleet_config;
+    const char *ifaces[FLEET_MAX_VEHICLES] = { CAN_INTERFACE };
+    unsigned int num_ifaces = 1U;
+    int opt;
+
+    (void)memset(&fleet_config, 0, sizeof(fleet_config));
+    fleet_config.cycle_paths[0] = DEFAULT_CYCLE;
+    fleet_config.num_cycles = 1U;
+    fleet_config.step_ms = FLEET_STEP_MS;
+
+    while ((opt = getopt(argc, argv, "n:c:i:o:p:l")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n': fleet_config.count = (unsigned int)atoi(optarg); break;
+        case 'c': fleet_config.num_cycles = split_list(optarg, fleet_config.cycle_paths, FLEET_MAX_VEHICLES); break;
+        case 'i': num_ifaces = split_list(optarg, ifaces, FLEET_MAX_VEHICLES); break;
+        case 'o': fleet_config.can_id_stride = (canid_t)strtoul(optarg, NULL, 0); break;
+        case 'p': fleet_config.step_ms = atoll(optarg); break;
+        case 'l': fleet_config.loop = true; break;
+        default:
+            fprintf(stderr, "Usage: %s [-n VEHICLES [-c CYCLE,...] [-i IFACE,...] [-o ID_STRIDE] [-p STEP_MS] [-l]]\n",
+                    argv[0]);
+            return ERROR_CODE;
+        }
+    }
+
+    // SIGINT/SIGTERM wake the main loop through a signalfd (ecu_shutdown.h)
+    if (!ecu_shutdown_init())
+    {
+        return ERROR_CODE;
+    }
+
+    // Opt-in RT mode (ECU_RT=1); every mode runs on this one thread
+    (void)rt_init("bcm");
+    (void)rt_configure_thread("bcm", 0U, 0);
+
+    // Identify this ECU in every secured message it sends
+    set_can_node_id(CAN_NODE_BCM);
+    metrics_init("bcm");
+
+    if (fleet_config.count > 0U)
+    {
+        if (!init_logging_system())
+        {
+            fprintf(stderr, "Failed to open log file for writing.\n");
+            return ERROR_CODE;
+        }
+        const int status = run_fleet(&fleet_config, ifaces, num_ifaces);
+        (void)metrics_write();
+        cleanup_logging_system();
+        return status;
+    }
+
     // Create CAN send socket using the defined interface (vcan0)
     sock_send = create_can_socket(CAN_INTERFACE);
     if (sock_send < 0)
@@ -27,36 +167,52 @@ int main(void)
     // Set simulation order to RUN
     simu_order = ORDER_RUN;
 
-    // Initialize semaphores
-    sem_init(&sem_comms, 0, 0);         // Comms must wait
-
-    // Initialize mutex for simulation
-    pthread_mutex_init(&mutex_bcm, NULL);
-
-    pthread_t thread_speed;
-    pthread_t thread_comms;
-    pthread_t thread_comms_rec;
-    pthread_t thread_battery;
-
-    // Start simulation threads: speed simulation, communication, and battery sensor
-    pthread_create(&thread_speed, NULL, simu_speed, vehicle_data);
-    pthread_create(&thread_comms, NULL, comms, NULL);
-    pthread_create(&thread_comms_rec, NULL, comms_reception, NULL);
-    pthread_create(&thread_battery, NULL, sensor_battery, NULL);
-
-    // Wait for threads to finish (in a real simulation these might run indefinitely)
-    pthread_join(thread_speed, NULL);
-    pthread_join(thread_comms, NULL);
-    pthread_join(thread_comms_rec, NULL);
-    pthread_join(thread_battery, NULL);
+    /* Battery, step, publish and reception all run on this thread, from one
+       timer wheel and one epoll loop: no semaphore, no mutex */
+    static BcmScheduler scheduler;
+    static RtJitterReport jitter;
+    if (!bcm_scheduler_init(&scheduler, sock_recv, timer_wheel_now_ms()))
+    {
+        return ERROR_CODE;
+    }
+    rt_jitter_init(&jitter, "bcm");
+    bcm_scheduler_track_jitter(&scheduler, &jitter);
 
-    // Clean up
-    pthread_mutex_destroy(&mutex_bcm);
+    // Opt-in snapshots (ECU_CHECKPOINT_DIR): resume a run in progress
+    static Checkpoint checkpoint;
+    if (checkpoint_init(&checkpoint, "bcm"))
+    {
+        if (bcm_scheduler_restore(&scheduler, &checkpoint, timer_wheel_now_ms()))
+        {
+            printf("Resumed at step %d of %d (checkpoint %llu)\n", simu_curr_step, data_size,
+                   (unsigned long long)checkpoint.sequence);
+            fflush(stdout);
+        }
+        scheduler.checkpoint = &checkpoint;
+        // The periodic snapshots are written off the step loop
+        (void)checkpoint_start_writer(&checkpoint);
+    }
 
-    sem_destroy(&sem_comms);
+    // Each published step is mirrored for monitors that are not on the bus
+    static LiveState live;
+    if (live_state_create(&live, "bcm"))
+    {
+        scheduler.live = &live;
+    }
+    bcm_scheduler_run(&scheduler, ecu_shutdown_fd());
+    if (scheduler.checkpoint != NULL)
+    {
+        // Stopped here, resumed from here on the next start
+        checkpoint_stop_writer(scheduler.checkpoint);
+        (void)bcm_scheduler_checkpoint(&scheduler, scheduler.checkpoint, timer_wheel_now_ms());
+    }
+    bcm_scheduler_close(&scheduler);
+    live_state_close(&live);
 
     close_can_socket(sock_send);
     close_can_socket(sock_recv);
+    // Counters since the last periodic export, then the log
+    (void)metrics_write();
     cleanup_logging_system();
 
     return EXIT_SUCCESS;
@@ -0,0 +1,367 @@
+#include "bcm_fleet.h"
+#include <errno.h>
+#include <poll.h>
+
+static void stop_vehicle(BcmVehicle *vehicle)
+{
+    if (vehicle->running)
+    {
+        timer_wheel_cancel(&vehicle->fleet->wheel, &vehicle->battery_timer);
+        timer_wheel_cancel(&vehicle->fleet->wheel, &vehicle->step_timer);
+        health_watchdog_reset(&vehicle->watchdog);
+        vehicle->running = false;
+        vehicle->fleet->running--;
+    }
+}
+
+// Battery sensor event: same model as bcm_scheduler, on this vehicle's state
+static void vehicle_battery_event(TimerEntry *timer, long long due_ms)
+{
+    BcmVehicle *vehicle = (BcmVehicle *)timer->arg;
+    VehicleData *row = &vehicle->cycle[vehicle->step];
+
+    (void)due_ms;
+    battery_model_update(&vehicle->batt_soc, &vehicle->batt_volt, row->speed);
+    row->batt_soc = vehicle->batt_soc;
+    row->batt_volt = vehicle->batt_volt;
+}
+
+// Safety watchdog deadline: report on this vehicle's command ID and stop it
+static void vehicle_fault_expired(void *arg, unsigned int faults, long long due_ms)
+{
+    BcmVehicle *vehicle = (BcmVehicle *)arg;
+
+    report_health_fault(vehicle->sock, vehicle->command_can_id, faults);
+    vehicle->fault_flags = faults;
+    vehicle->fault_ms = due_ms;
+    stop_vehicle(vehicle);
+}
+
+/**
+ * @brief Step event: what the step and publish events of bcm_scheduler do
+ * for the single vehicle, on this vehicle's cycle, CAN IDs and safety
+ * watchdog.
+ * @requirement SWR2.1
+ * @requirement SWR6.4
+ */
+static void vehicle_step_event(TimerEntry *timer, long long due_ms)
+{
+    BcmVehicle *vehicle = (BcmVehicle *)timer->arg;
+    const bool last_step = (vehicle->step + 1 >= vehicle->cycle_size);
+
+    // A deadline due at this very instant comes before the next sample
+    if (health_watchdog_check(&vehicle->watchdog, due_ms))
+    {
+        return;
+    }
+    if (!last_step)
+    {
+        derive_step_controls(vehicle->cycle, vehicle->step);
+    }
+    publish_sensor_data(&vehicle->publish, &vehicle->cycle[vehicle->step],
+                        vehicle->sock, vehicle->sensor_can_id);
+    vehicle->published++;
+    vehicle->step++;
+
+    health_watchdog_sample(&vehicle->watchdog, health_fault_flags(&vehicle->cycle[vehicle->step]), due_ms);
+    if (!vehicle->running)
+    {
+        return;     // Fired at once (no timeout)
+    }
+
+    if (last_step)
+    {
+        vehicle->laps++;
+        if (vehicle->fleet->loop)
+        {
+            vehicle->step = 0;
+            (void)memset(&vehicle->publish, 0, sizeof(vehicle->publish));
+        }
+        else
+        {
+            stop_vehicle(vehicle);
+        }
+    }
+}
+
+static bool load_cycle(BcmVehicle *vehicle, const char *path, VehicleData *scratch)
+{
+    const int steps = read_csv_into(path, scratch, SPEED_ARRAY_MAX_SIZE);
+
+    if (steps < 1)
+    {
+        (void)fprintf(stderr, "Vehicle %u: no drive cycle in %s\n", vehicle->index, path);
+        return false;
+    }
+
+    // One extra row: the last step looks ahead at the next speed
+    vehicle->cycle = (VehicleData *)malloc((size_t)(steps + 1) * sizeof(VehicleData));
+    if (vehicle->cycle == NULL)
+    {
+        return false;
+    }
+    (void)memcpy(vehicle->cycle, scratch, (size_t)(steps + 1) * sizeof(VehicleData));
+    for (int i = 0; i <= steps; i++)
+    {
+        vehicle->cycle[i].temp_set = DEFAULT_SET_TEMP;
+    }
+    vehicle->cycle_size = steps;
+    return true;
+}
+
+static bool can_id_usable(canid_t can_id)
+{
+    return (can_id <= CAN_SFF_MASK) && (can_id != CAN_ID_ERROR_DASH) && (can_id != CAN_ID_ECU_RESTART);
+}
+
+static bool config_valid(const BcmFleetConfig *config)
+{
+    if ((config->count == 0U) || (config->count > FLEET_MAX_VEHICLES) ||
+        (config->num_cycles == 0U) || (config->num_cycles > FLEET_MAX_VEHICLES) ||
+        (config->num_socks == 0U) || (config->num_socks > FLEET_MAX_VEHICLES) ||
+        (config->step_ms < FLEET_TICK_MS))
+    {
+        return false;
+    }
+    // Sensor and command IDs of neighbouring vehicles must not overlap
+    if (config->can_id_stride == 1U)
+    {
+        return false;
+    }
+    for (unsigned int i = 1U; (config->can_id_stride != 0U) && (i < config->count); i++)
+    {
+        if (!can_id_usable(CAN_ID_SENSOR_READ + (i * config->can_id_stride)) ||
+            !can_id_usable(CAN_ID_COMMAND + (i * config->can_id_stride)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool bcm_fleet_init(BcmFleet *fleet, const BcmFleetConfig *config, long long now_ms)
+{
+    (void)memset(fleet, 0, sizeof(*fleet));
+    if (!config_valid(config))
+    {
+        (void)fprintf(stderr, "Invalid fleet configuration\n");
+        return false;
+    }
+
+    VehicleData *scratch = (VehicleData *)calloc(SPEED_ARRAY_MAX_SIZE, sizeof(VehicleData));
+    if (scratch == NULL)
+    {
+        return false;
+    }
+
+    fleet->loop = config->loop;
+    timer_wheel_init(&fleet->wheel, FLEET_TICK_MS, now_ms);
+
+    // Battery events keep their ratio to the step period when time is scaled
+    long long battery_ms = (config->step_ms * FLEET_BATTERY_MS) / FLEET_STEP_MS;
+    if (battery_ms < FLEET_TICK_MS)
+    {
+        battery_ms = FLEET_TICK_MS;
+    }
+    // So does the safety timeout, unless the caller sets it
+    long long timeout_ms = config->timeout_ms;
+    if (timeout_ms <= 0)
+    {
+        timeout_ms = (config->step_ms * (long long)safety_timeout_ms) / FLEET_STEP_MS;
+    }
+
+    bool ok = true;
+    for (unsigned int i = 0U; ok && (i < config->count); i++)
+    {
+        BcmVehicle *vehicle = &fleet->vehicles[i];
+        const long long phase_ms = (config->step_ms * (long long)i) / (long long)config->count;
+
+        vehicle->index = i;
+        vehicle->fleet = fleet;
+        vehicle->batt_soc = DEFAULT_BATTERY_SOC;
+        vehicle->batt_volt = DEFAULT_BATTERY_VOLTAGE;
+        vehicle->sock = config->socks[i % config->num_socks];
+        vehicle->sensor_can_id = CAN_ID_SENSOR_READ + (i * config->can_id_stride);
+        vehicle->command_can_id = CAN_ID_COMMAND + (i * config->can_id_stride);
+        health_watchdog_init(&vehicle->watchdog, &fleet->wheel, timeout_ms, vehicle_fault_expired, vehicle);
+        fleet->count++;
+
+        ok = load_cycle(vehicle, config->cycle_paths[i % config->num_cycles], scratch);
+        if (ok)
+        {
+            // Battery first, so a step publishes the charge sampled at the same instant
+            ok = timer_wheel_add(&fleet->wheel, &vehicle->battery_timer, now_ms, phase_ms,
+                                 battery_ms, vehicle_battery_event, vehicle) &&
+                 timer_wheel_add(&fleet->wheel, &vehicle->step_timer, now_ms, phase_ms,
+                                 config->step_ms, vehicle_step_event, vehicle);
+            vehicle->running = ok;
+            fleet->running += ok ? 1U : 0U;
+        }
+    }
+
+    free(scratch);
+    if (!ok)
+    {
+        bcm_fleet_free(fleet);
+    }
+    return ok;
+}
+
+void bcm_fleet_stop_vehicle(BcmFleet *fleet, unsigned int index)
+{
+    if (index < fleet->count)
+    {
+        stop_vehicle(&fleet->vehicles[index]);
+    }
+}
+
+size_t bcm_fleet_advance(BcmFleet *fleet, long long now_ms)
+{
+    return timer_wheel_advance(&fleet->wheel, now_ms);
+}
+
+void bcm_fleet_run(BcmFleet *fleet, int stop_fd)
+{
+    struct pollfd stop = { .fd = stop_fd, .events = POLLIN, .revents = 0 };
+
+    while (fleet->running > 0U)
+    {
+        const long long next_ms = timer_wheel_next_expiry(&fleet->wheel);
+        if (next_ms < 0)
+        {
+            break;
+        }
+
+        // Wait measured from the absolute deadline, so late wake-ups do not shift later events
+        const long long wait_ms = next_ms - timer_wheel_now_ms();
+        const int ready = poll(&stop, (stop_fd >= 0) ? 1U : 0U, (wait_ms > 0) ? (int)wait_ms : 0);
+        if ((ready > 0) && ((stop.revents & POLLIN) != 0))
+        {
+            break;
+        }
+        if ((ready < 0) && (errno != EINTR))
+        {
+            perror("BCM fleet");
+            break;
+        }
+        const long long now_ms = timer_wheel_now_ms();
+        (void)bcm_fleet_advance(fleet, now_ms);
+        metrics_flush(now_ms);
+        if ((fleet->checkpoint != NULL) && checkpoint_due(fleet->checkpoint, now_ms))
+        {
+            (void)bcm_fleet_checkpoint(fleet, fleet->checkpoint, now_ms);
+        }
+    }
+}
+
+bool bcm_fleet_checkpoint(const BcmFleet *fleet, Checkpoint *checkpoint, long long now_ms)
+{
+    BcmVehicleCheckpoint saved[FLEET_MAX_VEHICLES];
+    struct iovec part;
+
+    (void)memset(saved, 0, sizeof(saved));
+    for (unsigned int i = 0U; i < fleet->count; i++)
+    {
+        const BcmVehicle *vehicle = &fleet->vehicles[i];
+        BcmVehicleCheckpoint *entry = &saved[i];
+
+        entry->step = vehicle->step;
+        entry->cycle_size = vehicle->cycle_size;
+        entry->running = vehicle->running ? 1U : 0U;
+        entry->fault_flags = vehicle->fault_flags;
+        entry->fault_elapsed_ms = -1;
+        if (health_watchdog_active(&vehicle->watchdog))
+        {
+            entry->faults = vehicle->watchdog.faults;
+            entry->fault_elapsed_ms = now_ms - vehicle->watchdog.onset_ms;
+        }
+        entry->batt_soc = vehicle->batt_soc;
+        entry->batt_volt = vehicle->batt_volt;
+        entry->published = vehicle->published;
+        entry->laps = vehicle->laps;
+    }
+
+    part.iov_base = saved;
+    part.iov_len = (size_t)fleet->count * sizeof(BcmVehicleCheckpoint);
+    return checkpoint_write(checkpoint, FLEET_CHECKPOINT_VERSION, &part, 1);
+}
+
+// The snapshot fits the fleet just initialized and has a vehicle left to run
+static bool snapshot_fits(const BcmFleet *fleet, const BcmVehicleCheckpoint *saved, size_t size)
+{
+    bool running = false;
+
+    if (size != ((size_t)fleet->count * sizeof(BcmVehicleCheckpoint)))
+    {
+        return false;
+    }
+    for (unsigned int i = 0U; i < fleet->count; i++)
+    {
+        if ((saved[i].cycle_size != fleet->vehicles[i].cycle_size) ||
+            (saved[i].step < 0) || (saved[i].step >= saved[i].cycle_size))
+        {
+            return false;
+        }
+        running = running || (saved[i].running != 0U);
+    }
+    return running;
+}
+
+bool bcm_fleet_restore(BcmFleet *fleet, Checkpoint *checkpoint, long long now_ms)
+{
+    CheckpointSnapshot snapshot;
+    BcmVehicleCheckpoint saved[FLEET_MAX_VEHICLES];
+
+    if (!checkpoint_open(checkpoint, &snapshot, FLEET_CHECKPOINT_VERSION))
+    {
+        return false;
+    }
+    bool resumed = snapshot.state_size <= sizeof(saved);
+    if (resumed)
+    {
+        (void)memcpy(saved, snapshot.state, snapshot.state_size);
+        resumed = snapshot_fits(fleet, saved, snapshot.state_size);
+    }
+    checkpoint_close(&snapshot);
+    if (!resumed)
+    {
+        return false;
+    }
+
+    for (unsigned int i = 0U; i < fleet->count; i++)
+    {
+        BcmVehicle *vehicle = &fleet->vehicles[i];
+        const BcmVehicleCheckpoint *entry = &saved[i];
+
+        vehicle->step = entry->step;
+        vehicle->batt_soc = entry->batt_soc;
+        vehicle->batt_volt = entry->batt_volt;
+        vehicle->cycle[vehicle->step].batt_soc = entry->batt_soc;
+        vehicle->cycle[vehicle->step].batt_volt = entry->batt_volt;
+        vehicle->fault_flags = entry->fault_flags;
+        vehicle->published = (unsigned long)entry->published;
+        vehicle->laps = (unsigned long)entry->laps;
+        // publish is still zeroed by bcm_fleet_init: a full refresh goes first
+        if (entry->running == 0U)
+        {
+            stop_vehicle(vehicle);
+        }
+        else
+        {
+            health_watchdog_resume(&vehicle->watchdog, entry->faults, entry->fault_elapsed_ms, now_ms);
+        }
+    }
+    return true;
+}
+
+void bcm_fleet_free(BcmFleet *fleet)
+{
+    for (unsigned int i = 0U; i < fleet->count; i++)
+    {
+        BcmVehicle *vehicle = &fleet->vehicles[i];
+        stop_vehicle(vehicle);
+        free(vehicle->cycle);
+        vehicle->cycle = NULL;
+    }
+    fleet->count = 0U;
+}
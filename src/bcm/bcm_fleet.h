@@ -0,0 +1,108 @@
+#ifndef BCM_FLEET_H
+#define BCM_FLEET_H
+
+#include "bcm_func.h"
+#include "health_watchdog.h"
+#include "../common_includes/timer_wheel.h"
+#include "../common_includes/checkpoint.h"
+
+/*
+ * Several independent vehicles simulated by one BCM process.
+ *
+ * Every vehicle owns a copy of its drive cycle, its battery model, its publish
+ * delta state and its safety watchdog. Instead of one set of threads per vehicle,
+ * a single timer wheel fires each vehicle's battery and step events; vehicles
+ * are phase-shifted across the step period so their traffic interleaves on
+ * the bus instead of bursting at the same instant.
+ */
+#define FLEET_MAX_VEHICLES      (64U)
+#define FLEET_TICK_MS           (10LL)
+#define FLEET_STEP_MS           (1000LL)    // Same pace as BCM_SCHED_STEP_MS
+#define FLEET_BATTERY_MS        (500LL)     // Same pace as BCM_SCHED_BATTERY_MS
+#define FLEET_CHECKPOINT_VERSION (1U)
+
+struct BcmFleet;
+
+typedef struct {
+    unsigned int index;
+    struct BcmFleet *fleet;
+    VehicleData *cycle;         // Own copy, battery and controls are written into it
+    int cycle_size;             // Steps, as read_csv counts them
+    int step;
+    bool running;
+    double batt_soc;
+    double batt_volt;
+    HealthWatchdog watchdog;
+    unsigned int fault_flags;   // HEALTH_FAULT_* bits reported, 0 while healthy
+    long long fault_ms;         // When the fault was reported
+    PublishState publish;
+    int sock;
+    canid_t sensor_can_id;
+    canid_t command_can_id;
+    unsigned long published;    // Steps put on the bus
+    unsigned long laps;         // Completed passes over the cycle
+    TimerEntry battery_timer;
+    TimerEntry step_timer;
+} BcmVehicle;
+
+typedef struct BcmFleet {
+    BcmVehicle vehicles[FLEET_MAX_VEHICLES];
+    unsigned int count;
+    unsigned int running;
+    bool loop;
+    TimerWheel wheel;
+    Checkpoint *checkpoint;     // NULL: no periodic snapshots
+} BcmFleet;
+
+/* Checkpointed vehicle; the cycles are not saved, a fleet resumes against
+   the same configuration (same count, same cycle lengths) */
+typedef struct {
+    int32_t step;
+    int32_t cycle_size;
+    uint32_t running;
+    uint32_t fault_flags;
+    uint32_t faults;            // Watchdog condition, 0 while healthy
+    uint32_t reserved;
+    int64_t fault_elapsed_ms;   // Time since its onset, -1 while healthy
+    double batt_soc;
+    double batt_volt;
+    uint64_t published;
+    uint64_t laps;
+} BcmVehicleCheckpoint;
+
+typedef struct {
+    unsigned int count;
+    const char *cycle_paths[FLEET_MAX_VEHICLES];    // Assigned round-robin
+    unsigned int num_cycles;
+    int socks[FLEET_MAX_VEHICLES];                  // Assigned round-robin
+    unsigned int num_socks;
+    canid_t can_id_stride;      // Vehicle n uses the base IDs + n * stride
+    long long step_ms;
+    long long timeout_ms;       // SWR6.4 timeout, 0: safety_timeout_ms scaled like step_ms
+    bool loop;                  // Restart each cycle instead of stopping at its end
+} BcmFleetConfig;
+
+// Load the cycles and arm every vehicle's timers, starting at now_ms
+bool bcm_fleet_init(BcmFleet *fleet, const BcmFleetConfig *config, long long now_ms);
+
+// Stop one vehicle as its watchdog would (the system was disabled elsewhere)
+void bcm_fleet_stop_vehicle(BcmFleet *fleet, unsigned int index);
+
+// Fire every event due up to now_ms; returns the number of events fired
+size_t bcm_fleet_advance(BcmFleet *fleet, long long now_ms);
+
+/* Run on timer_wheel_now_ms() until every vehicle finished or stop_fd
+   becomes readable (-1: never); the wait between two events watches it */
+void bcm_fleet_run(BcmFleet *fleet, int stop_fd);
+
+// Snapshot every vehicle now
+bool bcm_fleet_checkpoint(const BcmFleet *fleet, Checkpoint *checkpoint, long long now_ms);
+
+/* Resume the vehicles saved in the ECU's snapshot, right after bcm_fleet_init
+   with the same configuration, if one of them was still running; vehicles
+   stopped then stay stopped. Returns true if resumed. */
+bool bcm_fleet_restore(BcmFleet *fleet, Checkpoint *checkpoint, long long now_ms);
+
+void bcm_fleet_free(BcmFleet *fleet);
+
+#endif // BCM_FLEET_H
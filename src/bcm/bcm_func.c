@@ -1,10 +1,5 @@
 #include "bcm_func.h"
 
-// CAN receiver
-#define CAN_DATA_LENGTH (8)
-
-#define MICRO_CONSTANT_CONV (1000000L)
-#define NANO_CONSTANT_CONV (1000)
 #define CSV_LINE_BUFFER (256)
 #define CSV_MAX_FIELDS (7)
 #define CSV_MAX_TOKEN_SIZE (50)
@@ -15,10 +10,6 @@
 #define CSV_NUM_FIELD_4 (4)
 #define CSV_NUM_FIELD_5 (5)
 #define CSV_NUM_FIELD_6 (6)
-#define THREAD_SLEEP_TIME (1000000U)
-#define THREAD_RECV_SLEEP_TIME (50000U)
-#define THREAD_BATTERY_SLEEP_TIME (500000U)
-#define NUM_DISABLE_RETRIES (3)
 #define BATTERY_VOLT_MUL (0.01125f)
 #define BATTERY_VOLT_SUM (11.675f)
 #define BATTERY_SOC_MUL (5.0f)
@@ -26,15 +17,39 @@
 #define SOC_THRESHOLD (30.0f)
 #define VOLTAGE_DEC (0.5f)
 #define SAFETY_TIMEOUT (2000)
-#define SEC_TO_MS  1000ULL       // Seconds -> milliseconds
-#define NSEC_TO_MS 1000000ULL    // Nanoseconds -> microseconds (in ms)
 #define DOOR_OK_STATUS_1 (0)
 #define DOOR_OK_STATUS_2 (1)
 #define ENGINE_TEMP_OK_STATUS (120.0)
 #define TILT_OK_STATUS (60.0)
 
+typedef enum {
+    SIGNAL_INT,
+    SIGNAL_DOUBLE
+} SignalType;
+
+// One row per sensor signal, indexed by SensorSignalId
+typedef struct {
+    size_t offset;          // Field offset inside VehicleData
+    SignalType type;
+    double deadband;
+} SignalPublishRule;
+
+static const SignalPublishRule publish_rules[PUBLISH_SIGNAL_COUNT] = {
+    [SENSOR_SIG_SPEED]     = { offsetof(VehicleData, speed),         SIGNAL_DOUBLE, DEADBAND_EXACT },
+    [SENSOR_SIG_IN_TEMP]   = { offsetof(VehicleData, internal_temp), SIGNAL_INT,    DEADBAND_EXACT },
+    [SENSOR_SIG_EX_TEMP]   = { offsetof(VehicleData, external_temp), SIGNAL_INT,    DEADBAND_EXACT },
+    [SENSOR_SIG_DOOR]      = { offsetof(VehicleData, door_open),     SIGNAL_INT,    DEADBAND_EXACT },
+    [SENSOR_SIG_TILT]      = { offsetof(VehicleData, tilt_angle),    SIGNAL_DOUBLE, DEADBAND_TILT },
+    [SENSOR_SIG_ACCEL]     = { offsetof(VehicleData, accel),         SIGNAL_INT,    DEADBAND_EXACT },
+    [SENSOR_SIG_BRAKE]     = { offsetof(VehicleData, brake),         SIGNAL_INT,    DEADBAND_EXACT },
+    [SENSOR_SIG_TEMP_SET]  = { offsetof(VehicleData, temp_set),      SIGNAL_INT,    DEADBAND_EXACT },
+    [SENSOR_SIG_BATT_SOC]  = { offsetof(VehicleData, batt_soc),      SIGNAL_DOUBLE, DEADBAND_BATT_SOC },
+    [SENSOR_SIG_BATT_VOLT] = { offsetof(VehicleData, batt_volt),     SIGNAL_DOUBLE, DEADBAND_BATT_VOLT },
+    [SENSOR_SIG_ENGI_TEMP] = { offsetof(VehicleData, engi_temp),     SIGNAL_DOUBLE, DEADBAND_ENGI_TEMP },
+    [SENSOR_SIG_GEAR]      = { offsetof(VehicleData, gear),          SIGNAL_INT,    DEADBAND_EXACT }
+};
+
 // Global variables definitions
-pthread_mutex_t mutex_bcm;
 volatile int simu_curr_step = 0;
 volatile int simu_state = STATE_STOPPED;
 volatile int simu_order = ORDER_STOP;
@@ -45,39 +60,13 @@ int data_size = 0;
 VehicleData vehicle_data[SPEED_ARRAY_MAX_SIZE] = {0};
 int sock_send = -1;
 int sock_recv = -1;
-char send_msg[AES_BLOCK_SIZE + 1] = {0};
-bool test_mode = false;
-sem_t sem_comms;
 bool fault_active = false;
-int fault_start_time = 0;
 const int safety_timeout_ms = SAFETY_TIMEOUT;
 bool data_updated = false;
-
-// Sleep for a given number of microseconds
-void sleep_microseconds(long int microseconds)
-{
-    struct timespec tsc;
-    tsc.tv_sec = microseconds / MICRO_CONSTANT_CONV;
-    tsc.tv_nsec = (microseconds % MICRO_CONSTANT_CONV) * NANO_CONSTANT_CONV;
-    nanosleep(&tsc, NULL);
-}
-
-int getCurrentTimeMs_real(void)
-{
-    struct timespec tss;
-    clock_gettime(CLOCK_MONOTONIC, &tss);
-
-    unsigned long long wideMs = ((unsigned long long)tss.tv_sec * SEC_TO_MS)
-                     + (tss.tv_nsec / NSEC_TO_MS);
-
-    return (int)wideMs;
-}
-#ifdef UNIT_TEST
-    int mock_time_ms = 0;
-    int getCurrentTimeMs(void) { return mock_time_ms; }
-#else
-    int getCurrentTimeMs(void) { return getCurrentTimeMs_real(); }
-#endif
+CanReassembler bcm_reassembler = {0};
+PublishState publish_state = {0};
+// Set by error_disabled; only a restart of the BCM clears it
+static bool disable_latched = false;
 
 void read_csv_default(void)
 {
@@ -91,20 +80,64 @@ void read_csv_default(void)
  */
 void read_csv(const char *path)
 {
+    const int steps = read_csv_into(path, &vehicle_data[data_size], SPEED_ARRAY_MAX_SIZE - data_size);
+    if (steps >= 0)
+    {
+        data_size += steps;
+    }
+}
+
+// Copy a binary cycle file (bin/cycle_gen) into rows, same step count as a CSV
+static int read_cycle_into(const char *path, VehicleData *rows, int max_rows)
+{
+    DriveCycleReader reader;
+
+    if (!drive_cycle_open_reader(&reader, path))
+    {
+        return -1;
+    }
+    int count = 0;
+    while ((count < max_rows) && ((size_t)count < reader.count))
+    {
+        const DriveCycleRow *row = &reader.rows[count];
+        rows[count].time = row->time;
+        rows[count].speed = (double)row->speed;
+        rows[count].tilt_angle = (double)row->tilt_angle;
+        rows[count].internal_temp = row->internal_temp;
+        rows[count].external_temp = row->external_temp;
+        rows[count].door_open = row->door_open;
+        rows[count].engi_temp = (double)row->engi_temp;
+        count++;
+    }
+    drive_cycle_close_reader(&reader);
+    return count - 1;
+}
+
+/* Parse a drive cycle into rows. Returns the number of simulation steps
+   (the last row only serves as look-ahead), or -1 if the file can't be read.
+   Binary cycle files written by cycle_gen are accepted as well. */
+int read_csv_into(const char *path, VehicleData *rows, int max_rows)
+{
+    if (drive_cycle_is_binary(path))
+    {
+        return read_cycle_into(path, rows, max_rows);
+    }
+
     FILE *file = fopen(path, "r");
     if (!file)
     {
         perror("Error opening file");
-        return;
+        return -1;
     }
 
     char line[CSV_LINE_BUFFER];
     char temp_line[CSV_LINE_BUFFER];
     char *token;
+    int count = 0;
     // Skip CSV header
     fgets(line, sizeof(line), file);
 
-    while (fgets(line, sizeof(line), file))
+    while ((count < max_rows) && fgets(line, sizeof(line), file))
     {
         strncpy(temp_line, line, sizeof(temp_line));
         temp_line[strcspn(temp_line, "\n")] = '\0';
@@ -121,25 +154,25 @@ void read_csv(const char *path)
             switch (field)
             {
             case CSV_NUM_FIELD_0:
-                vehicle_data[data_size].time = atoi(clean_token);
+                rows[count].time = atoi(clean_token);
                 break;
             case CSV_NUM_FIELD_1:
-                vehicle_data[data_size].speed = atof(clean_token);
+                rows[count].speed = atof(clean_token);
                 break;
             case CSV_NUM_FIELD_2:
-                vehicle_data[data_size].tilt_angle = atof(clean_token);
+                rows[count].tilt_angle = atof(clean_token);
                 break;
             case CSV_NUM_FIELD_3:
-                vehicle_data[data_size].internal_temp = atoi(clean_token);
+                rows[count].internal_temp = atoi(clean_token);
                 break;
             case CSV_NUM_FIELD_4:
-                vehicle_data[data_size].external_temp = atoi(clean_token);
+                rows[count].external_temp = atoi(clean_token);
                 break;
             case CSV_NUM_FIELD_5:
-                vehicle_data[data_size].door_open = atoi(clean_token);
+                rows[count].door_open = atoi(clean_token);
                 break;
             case CSV_NUM_FIELD_6:
-                vehicle_data[data_size].engi_temp = atof(clean_token);
+                rows[count].engi_temp = atof(clean_token);
                 break;
             default:
                 break;
@@ -147,15 +180,37 @@ void read_csv(const char *path)
             token = strtok_r(NULL, ",", &saveptr);
             field++;
         }
-        data_size++;
+        count++;
     }
-    data_size--;
     fclose(file);
+    return count - 1;
+}
+
+// Disable the system for good: check_order honours it
+void latch_system_disable(void)
+{
+    __atomic_store_n(&disable_latched, true, __ATOMIC_RELEASE);
+    simu_order = ORDER_STOP;
+}
+
+bool system_disable_latched(void)
+{
+    return __atomic_load_n(&disable_latched, __ATOMIC_ACQUIRE);
+}
+
+void clear_system_disable(void)
+{
+    __atomic_store_n(&disable_latched, false, __ATOMIC_RELEASE);
 }
 
 // Check the simulation order and update the state accordingly
 void check_order(int order)
 {
+    if (system_disable_latched())
+    {
+        // No order written since overrides the disable
+        order = ORDER_STOP;
+    }
     if (order != simu_state)
     {
         switch (order)
@@ -175,6 +230,7 @@ void check_order(int order)
                 memset(vehicle_data, 0, sizeof(vehicle_data));
                 data_size = 0;
                 read_csv_default();
+                reset_publish_state();
                 simu_state = STATE_RUNNING;
                 printf("Simulation Running!\n");
                 fflush(stdout);
@@ -200,124 +256,130 @@ void check_order(int order)
     }
 }
 
-void simu_speed_step(VehicleData *sim_data, ControlData controls)
+// Pedal and gear positions implied by the speed profile of one step
+static void derive_controls(double speed_now, double speed_next, int *accel, int *brake, int *gear)
 {
-    if (simu_state == STATE_RUNNING)
+    // Accelerating OR Constant speed, with speed > 0
+    if (speed_next - speed_now > 0.0 || ((speed_next == speed_now) && speed_now > 0.0))
     {
-        if (simu_curr_step + 1 != data_size)
-        {
-            // Accelerating OR Constant speed, with speed > 0
-            if (*(controls.speed[simu_curr_step + 1]) - *(controls.speed[simu_curr_step]) > 0.0
-                ||
-                ((*(controls.speed[simu_curr_step + 1]) == *(controls.speed[simu_curr_step])) &&
-                *(controls.speed[simu_curr_step]) > 0.0))
-            {
-                *(controls.accel[simu_curr_step]) = 1;
-                *(controls.brake[simu_curr_step]) = 0;
-                *(controls.gear[simu_curr_step]) = DRIVE;
-            }
-            // Braking
-            else if (*(controls.speed[simu_curr_step + 1]) - *(controls.speed[simu_curr_step]) < 0.0 && *(controls.speed[simu_curr_step]) > 0.0)
-            {
-                *(controls.brake[simu_curr_step]) = 1;
-                *(controls.accel[simu_curr_step]) = 0;
-                *(controls.gear[simu_curr_step]) = DRIVE;
-            }
-            // Stopped
-            else
-            {
-                *(controls.brake[simu_curr_step]) = 1;
-                *(controls.accel[simu_curr_step]) = 0;
-                if (sim_data[simu_curr_step].speed == 0)
-                {
-                    *(controls.gear[simu_curr_step]) = PARKING;
-                }
-            }
-        }
-
-        data_updated = true;
-
-        if (simu_curr_step + 1 == data_size)
+        *accel = 1;
+        *brake = 0;
+        *gear = DRIVE;
+    }
+    // Braking
+    else if (speed_next - speed_now < 0.0 && speed_now > 0.0)
+    {
+        *brake = 1;
+        *accel = 0;
+        *gear = DRIVE;
+    }
+    // Stopped
+    else
+    {
+        *brake = 1;
+        *accel = 0;
+        if (speed_now == 0)
         {
-            simu_order = ORDER_STOP;
+            *gear = PARKING;
         }
-        sem_post(&sem_comms);
     }
 }
 
-// Thread function to simulate speed updates
-void *simu_speed(void *arg)
+// Controls of one step of a cycle; step + 1 must be a valid row
+void derive_step_controls(VehicleData *cycle, int step)
 {
-    VehicleData *sim_data = (VehicleData *)arg;
-    check_order(simu_order);
+    derive_controls(cycle[step].speed, cycle[step + 1].speed,
+                    &cycle[step].accel, &cycle[step].brake, &cycle[step].gear);
+}
 
-    double *speed[data_size];
-    int *accel[data_size];
-    int *brake[data_size];
-    int *gear[data_size];
-    int *temp_set[data_size];
+// Forget what was sent, so the next update is a full refresh
+void reset_publish_state(void)
+{
+    (void)memset(&publish_state, 0, sizeof(publish_state));
+}
 
-    for (int i = 0; i < data_size; i++)
+static double read_signal(const VehicleData *data, const SignalPublishRule *rule)
+{
+    const char *field = (const char *)data + rule->offset;
+    double value = 0.0;
+
+    if (rule->type == SIGNAL_INT)
     {
-        speed[i] = &sim_data[i].speed;
-        accel[i] = &sim_data[i].accel;
-        brake[i] = &sim_data[i].brake;
-        gear[i] = &sim_data[i].gear;
-        temp_set[i] = &sim_data[i].temp_set;
-        *temp_set[i] = DEFAULT_SET_TEMP;
+        int int_value = 0;
+        (void)memcpy(&int_value, field, sizeof(int_value));
+        value = (double)int_value;
     }
-
-    ControlData control_data = {speed, accel, brake, gear};
-
-    while (!test_mode)
+    else
     {
-        pthread_mutex_lock(&mutex_bcm);
-        check_order(simu_order);
-        simu_speed_step(sim_data, control_data);
-        pthread_mutex_unlock(&mutex_bcm);
-        sleep_microseconds(THREAD_SLEEP_TIME);
+        (void)memcpy(&value, field, sizeof(value));
     }
-    return NULL;
+    return value;
 }
 
-// Function to check for updates in simulation data and send CAN messages
-void send_data_update(void)
+static void fill_sensor_pdu(const VehicleData *data, SensorPdu *pdu)
 {
-    snprintf(send_msg, sizeof(send_msg), "speed: %.1lf", vehicle_data[simu_curr_step].speed);
-    send_encrypted_message(sock_send, send_msg, CAN_ID_SENSOR_READ);
-
-    snprintf(send_msg, sizeof(send_msg), "in_temp: %d", vehicle_data[simu_curr_step].internal_temp);
-    send_encrypted_message(sock_send, send_msg, CAN_ID_SENSOR_READ);
-
-    snprintf(send_msg, sizeof(send_msg), "ex_temp: %d", vehicle_data[simu_curr_step].external_temp);
-    send_encrypted_message(sock_send, send_msg, CAN_ID_SENSOR_READ);
-
-    snprintf(send_msg, sizeof(send_msg), "door: %d", vehicle_data[simu_curr_step].door_open);
-    send_encrypted_message(sock_send, send_msg, CAN_ID_SENSOR_READ);
-
-    snprintf(send_msg, sizeof(send_msg), "tilt: %.1lf", vehicle_data[simu_curr_step].tilt_angle);
-    send_encrypted_message(sock_send, send_msg, CAN_ID_SENSOR_READ);
+    pdu->speed = data->speed;
+    pdu->internal_temp = data->internal_temp;
+    pdu->external_temp = data->external_temp;
+    pdu->door_open = data->door_open;
+    pdu->tilt_angle = data->tilt_angle;
+    pdu->accel = data->accel;
+    pdu->brake = data->brake;
+    pdu->temp_set = data->temp_set;
+    pdu->batt_soc = data->batt_soc;
+    pdu->batt_volt = data->batt_volt;
+    pdu->engi_temp = data->engi_temp;
+    pdu->gear = data->gear;
+}
 
-    snprintf(send_msg, sizeof(send_msg), "accel: %d", vehicle_data[simu_curr_step].accel);
-    send_encrypted_message(sock_send, send_msg, CAN_ID_SENSOR_READ);
+/**
+ * @brief Send the sensor signals that changed beyond their deadband,
+ * multiplexed in a single sensor PDU. Every PUBLISH_REFRESH_STEPS calls
+ * all signals are sent again.
+ * @requirement SWR2.1
+ */
+void send_data_update(void)
+{
+    publish_sensor_data(&publish_state, &vehicle_data[simu_curr_step], sock_send, CAN_ID_SENSOR_READ);
+}
 
-    snprintf(send_msg, sizeof(send_msg), "brake: %d", vehicle_data[simu_curr_step].brake);
-    send_encrypted_message(sock_send, send_msg, CAN_ID_SENSOR_READ);
+// Publish one step of data against the given delta state (one per vehicle)
+void publish_sensor_data(PublishState *state, const VehicleData *data, int sock, canid_t can_id)
+{
+    bool full_refresh = (!state->valid) ||
+                        (state->steps_since_refresh >= (PUBLISH_REFRESH_STEPS - 1U));
+    SensorPdu pdu = {0};
+    unsigned char block[SENSOR_PDU_SIZE];
 
-    snprintf(send_msg, sizeof(send_msg), "temp_set: %d", vehicle_data[simu_curr_step].temp_set);
-    send_encrypted_message(sock_send, send_msg, CAN_ID_SENSOR_READ);
+    fill_sensor_pdu(data, &pdu);
 
-    snprintf(send_msg, sizeof(send_msg), "batt_soc: %.1lf", vehicle_data[simu_curr_step].batt_soc);
-    send_encrypted_message(sock_send, send_msg, CAN_ID_SENSOR_READ);
+    for (unsigned int i = 0; i < PUBLISH_SIGNAL_COUNT; i++)
+    {
+        const SignalPublishRule *rule = &publish_rules[i];
+        double value = read_signal(data, rule);
 
-    snprintf(send_msg, sizeof(send_msg), "batt_volt: %.1lf", vehicle_data[simu_curr_step].batt_volt);
-    send_encrypted_message(sock_send, send_msg, CAN_ID_SENSOR_READ);
+        if (full_refresh || fabs(value - state->last_sent[i]) > rule->deadband)
+        {
+            pdu.present |= (uint16_t)(1U << i);
+            state->last_sent[i] = value;
+        }
+    }
 
-    snprintf(send_msg, sizeof(send_msg), "engi_temp: %.1lf", vehicle_data[simu_curr_step].engi_temp);
-    send_encrypted_message(sock_send, send_msg, CAN_ID_SENSOR_READ);
+    if (pdu.present != 0U)
+    {
+        sensor_pdu_encode(&pdu, block);
+        send_encrypted_block(sock, block, (int)can_id);
+    }
 
-    snprintf(send_msg, sizeof(send_msg), "gear: %d", vehicle_data[simu_curr_step].gear);
-    send_encrypted_message(sock_send, send_msg, CAN_ID_SENSOR_READ);
+    if (full_refresh)
+    {
+        state->valid = true;
+        state->steps_since_refresh = 0U;
+    }
+    else
+    {
+        state->steps_since_refresh++;
+    }
 }
 
 // Check if can_id is valid
@@ -338,19 +400,18 @@ bool check_can_id(canid_t can_id)
     return is_valid;
 }
 
+/**
+ * @brief Handle a message received from another ECU.
+ * @requirement SWR6.4
+ */
 void parse_input_received_bcm(char *input)
 {
-    // if system is disabled, order simulation to stop
+    // if system is disabled, order simulation to stop, and keep it stopped
     if (strcmp(input, "error_disabled") == 0)
     {
         printf("error received\n");
         fflush(stdout);
-        /* Set simu_order to stop simulation multiple times,
-           to overwrite if any other orders are received for a while*/
-        for (size_t i = 0; i < NUM_DISABLE_RETRIES; i++){
-            simu_order = ORDER_STOP;
-            sleep_microseconds(THREAD_SLEEP_TIME);
-        }
+        latch_system_disable();
     }
     /* // if simulation is stopped and we want to restart
     if (simu_state == STATE_STOPPED && 
@@ -362,206 +423,102 @@ void parse_input_received_bcm(char *input)
     } */
 }
 
-/* Function to check if system was disabled by another ECU,
-so that simulation will halt. */
-void check_system_disable(int sock)
+// Feed one received frame to the reassembler; on BCM_RX_MESSAGE, message holds the text
+BcmRxResult bcm_receive_frame(const struct can_frame *frame, char *message)
 {
-    struct can_frame frame;
-    unsigned char encrypted_data[AES_BLOCK_SIZE];
-    char decrypted_message[AES_BLOCK_SIZE];
-    int received_bytes = 0;
-    char error_log[MAX_MSG_SIZE];
+    unsigned char encrypted_data[CAN_MSG_WIRE_SIZE];
 
-    while(received_bytes < AES_BLOCK_SIZE)
+    if (!check_can_id(frame->can_id))
     {
-        if (receive_can_frame(sock, &frame) == 0)
-        {
-            if (check_can_id(frame.can_id))
-            {
-                if (frame.can_dlc == CAN_DATA_LENGTH)
-                {
-                    memcpy(encrypted_data + received_bytes, frame.data, CAN_DATA_LENGTH);
-                    received_bytes += CAN_DATA_LENGTH;
-                    if (received_bytes == AES_BLOCK_SIZE)
-                    {
-                        decrypt_data(encrypted_data, decrypted_message, received_bytes);
-                        parse_input_received_bcm(decrypted_message);
-                        //received_bytes = 0;           
-                    }
-                }
-                else
-                {
-                    snprintf(error_log, sizeof(error_log), "Warn: Frame ignored (size %u bytes > 8).", frame.can_dlc);
-                }
-            }
-        }
-        
+        metrics_inc(METRIC_FRAMES_FILTERED);
+        return BCM_RX_PENDING;
     }
+    if (can_reasm_push(&bcm_reassembler, frame, can_reasm_now_ms(),
+                       encrypted_data) != CAN_REASM_COMPLETE)
+    {
+        return BCM_RX_PENDING;
+    }
+    // Forged, corrupted or replayed blocks are never parsed
+    if (decrypt_data(encrypted_data, message, CAN_MSG_WIRE_SIZE, frame->can_id) != DECRYPT_OK)
+    {
+        return BCM_RX_REJECTED;
+    }
+    return BCM_RX_MESSAGE;
 }
 
-/**
- * @brief Function to evaluate system health.
- * @requirement SWR6.1
- * @requirement SWR6.2
- * @requirement SWR6.3
- * @requirement SWR6.4
- */
-void check_health_signals(void)
+// Adverse conditions present in one step of data (HEALTH_FAULT_* bits)
+unsigned int health_fault_flags(const VehicleData *data)
 {
-    int doorVal         = vehicle_data[simu_curr_step].door_open;
-    double engTemp      = vehicle_data[simu_curr_step].engi_temp;
-    double tilt         = vehicle_data[simu_curr_step].tilt_angle;
-
-    bool invalidDoor = (doorVal != DOOR_OK_STATUS_1 && doorVal != DOOR_OK_STATUS_2);
-
-    bool engineOvertemp = (engTemp > ENGINE_TEMP_OK_STATUS);
+    unsigned int faults = 0U;
 
-    bool excessiveTilt = (tilt > TILT_OK_STATUS);
-
-    bool anyAdverseCondition = (invalidDoor || engineOvertemp || excessiveTilt);
-
-    if (anyAdverseCondition)
+    if (data->door_open != DOOR_OK_STATUS_1 && data->door_open != DOOR_OK_STATUS_2)
     {
-        if (!fault_active)
-        {
-            fault_active = true;
-            fault_start_time = getCurrentTimeMs(); 
-        }
-        else
-        {
-            int elapsed = getCurrentTimeMs() - fault_start_time;
-            if (elapsed >= safety_timeout_ms)
-            {
-                send_encrypted_message(sock_send, "error_disabled", CAN_ID_COMMAND);
-                log_toggle_event("Fault: SWR6.4 (System Disabling Error)");
-                if (invalidDoor)
-                {
-                    log_toggle_event("Fault: SWR6.4 (Invalid door status)");
-                }
-                if (engineOvertemp)
-                {
-                    log_toggle_event("Fault: SWR6.4 (Engine overtemperature)");
-                }
-                if (excessiveTilt)
-                {
-                    log_toggle_event("Fault: SWR6.4 (Excessive tilt value)");
-                }
-
-                simu_order = ORDER_STOP;
-            }
-        }
+        faults |= HEALTH_FAULT_DOOR;
     }
-    else
+    if (data->engi_temp > ENGINE_TEMP_OK_STATUS)
     {
-        fault_active = false;
+        faults |= HEALTH_FAULT_ENGINE_TEMP;
     }
-}
-
-// Communication thread function
-void *comms(void *arg)
-{
-    (void)arg;
-    #ifdef UNIT_TEST
-        int max_iterations = 2;
-        int iter;
-        for (iter = 0; iter < max_iterations; ++iter)
-    #else
-        while (!test_mode)
-    #endif
+    if (data->tilt_angle > TILT_OK_STATUS)
     {
-        sem_wait(&sem_comms);
-
-        int lock_result = pthread_mutex_lock(&mutex_bcm);
-        if (lock_result != 0)
-        {
-            return NULL;
-        }
-        if (simu_state == STATE_RUNNING && data_updated)
-        {
-            send_data_update();
-            data_updated = false; // ready to update data again after sending
-            simu_curr_step++;
-            check_health_signals();
-        }
-        pthread_mutex_unlock(&mutex_bcm);
-        sleep_microseconds(THREAD_SLEEP_TIME);
+        faults |= HEALTH_FAULT_TILT;
     }
-    return NULL;
+    return faults;
 }
 
-void *comms_reception(void *arg)
+// Tell the other ECUs the system is disabled and log the causes
+void report_health_fault(int sock, canid_t can_id, unsigned int faults)
 {
-    (void)arg;
-    #ifdef UNIT_TEST
-        int max_iterations = 2;
-        int iter;
-        for (iter = 1; iter < max_iterations; ++iter)
-    #else
-        while (!test_mode)
-    #endif
+    send_encrypted_message(sock, "error_disabled", (int)can_id);
+    log_toggle_event("Fault: SWR6.4 (System Disabling Error)");
+    if ((faults & HEALTH_FAULT_DOOR) != 0U)
     {
-        check_system_disable(sock_recv);
-        sleep_microseconds(THREAD_RECV_SLEEP_TIME);
+        log_toggle_event("Fault: SWR6.4 (Invalid door status)");
+    }
+    if ((faults & HEALTH_FAULT_ENGINE_TEMP) != 0U)
+    {
+        log_toggle_event("Fault: SWR6.4 (Engine overtemperature)");
+    }
+    if ((faults & HEALTH_FAULT_TILT) != 0U)
+    {
+        log_toggle_event("Fault: SWR6.4 (Excessive tilt value)");
     }
-    return NULL;
 }
 
 // Update battery state of charge based on vehicle speed
 void update_battery_soc(double vehicle_speed)
+{
+    battery_model_update(&batt_soc, &batt_volt, vehicle_speed);
+
+    vehicle_data[simu_curr_step].batt_soc = batt_soc;
+    vehicle_data[simu_curr_step].batt_volt = batt_volt;
+}
+
+// Battery model on caller-owned state (one per simulated vehicle)
+void battery_model_update(double *soc, double *volt, double vehicle_speed)
 {
     if (vehicle_speed > 0.0)
     {
-        batt_soc += BATTERY_SOC_INCREMENT;
-        if (batt_soc > MAX_BATTERY_SOC)
+        *soc += BATTERY_SOC_INCREMENT;
+        if (*soc > MAX_BATTERY_SOC)
         {
-            batt_soc = MAX_BATTERY_SOC;
+            *soc = MAX_BATTERY_SOC;
         }
-        batt_volt = (BATTERY_VOLT_MUL * batt_soc) + BATTERY_VOLT_SUM;
+        *volt = (BATTERY_VOLT_MUL * *soc) + BATTERY_VOLT_SUM;
     }
     else
     {
-        batt_soc -= (BATTERY_SOC_DECREMENT * BATTERY_SOC_MUL);
-        if (batt_soc < 0)
+        *soc -= (BATTERY_SOC_DECREMENT * BATTERY_SOC_MUL);
+        if (*soc < 0)
         {
-            batt_soc = 0.0;
+            *soc = 0.0;
         }
 
-        batt_volt = (BATTERY_VOLT_MUL * batt_soc) + BATTERY_VOLT_SUM + VOLTAGE_OFFSET_VALUE;
-
-        if (batt_soc < SOC_THRESHOLD)
-        {
-            batt_volt -= VOLTAGE_DEC;
-        }
-    }
+        *volt = (BATTERY_VOLT_MUL * *soc) + BATTERY_VOLT_SUM + VOLTAGE_OFFSET_VALUE;
 
-    vehicle_data[simu_curr_step].batt_soc = batt_soc;
-    vehicle_data[simu_curr_step].batt_volt = batt_volt;
-}
-
-// Battery sensor thread function
-void *sensor_battery(void *arg)
-{
-    (void)arg;
-#ifdef UNIT_TEST
-    // Bounded loop
-    int max_iterations = 2;
-    int i;
-    for (i = 0; i < max_iterations; i++)
-#else
-    while (!test_mode)
-#endif
-    {
-        int lock_result = pthread_mutex_lock(&mutex_bcm);
-        if (lock_result != 0)
-        {
-            return NULL;
-        }
-        if (simu_state == STATE_RUNNING)
+        if (*soc < SOC_THRESHOLD)
         {
-            update_battery_soc(vehicle_data[simu_curr_step].speed);
+            *volt -= VOLTAGE_DEC;
         }
-        pthread_mutex_unlock(&mutex_bcm);
-        sleep_microseconds(THREAD_BATTERY_SLEEP_TIME);
     }
-    return NULL;
 }
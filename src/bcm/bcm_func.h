@@ -3,24 +3,25 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
 #include <time.h>
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
-#include <pthread.h>
 #include <signal.h>
 #include <math.h>
 #include <stdbool.h>
-#include <semaphore.h>
 
 #include "../common_includes/can_id_list.h"
 #include "../common_includes/can_socket.h"
+#include "../common_includes/can_reassembly.h"
+#include "../common_includes/sensor_pdu.h"
+#include "../common_includes/metrics.h"
+#include "../common_includes/drive_cycle.h"
 #include "../common_includes/logging.h"
 
-extern sem_t sem_comms;
-
 // CAN receiver
 #define MAX_MSG_SIZE    50
 
@@ -50,6 +51,22 @@ extern sem_t sem_comms;
 // Maximum number of simulation data points
 #define SPEED_ARRAY_MAX_SIZE 5000
 
+// Sensor publishing: a signal is sent only when it moved beyond its deadband
+// since the last time it was sent, plus a full refresh for late joiners.
+// All signals that need sending go out together in one sensor PDU.
+#define PUBLISH_SIGNAL_COUNT     (SENSOR_SIG_COUNT)
+#define PUBLISH_REFRESH_STEPS    10U     // Full refresh every N simulation steps
+#define DEADBAND_EXACT           0.0     // Any change is published
+#define DEADBAND_TILT            0.5     // degrees
+#define DEADBAND_BATT_SOC        0.2     // %
+#define DEADBAND_BATT_VOLT       0.05    // V
+#define DEADBAND_ENGI_TEMP       0.5     // degrees C
+
+// Adverse conditions found by health_fault_flags (SWR6.x)
+#define HEALTH_FAULT_DOOR        (1U << 0)
+#define HEALTH_FAULT_ENGINE_TEMP (1U << 1)
+#define HEALTH_FAULT_TILT        (1U << 2)
+
 // Vehicle data structure
 typedef struct {
     int time;
@@ -67,16 +84,21 @@ typedef struct {
     int gear;
 } VehicleData;
 
-// Struct used in simu_speed_step
+// Last values put on the bus by send_data_update
 typedef struct {
-    double **speed;
-    int **accel;
-    int **brake;
-    int **gear;
-} ControlData;
+    double last_sent[PUBLISH_SIGNAL_COUNT];
+    bool valid;                     // false forces a full refresh
+    unsigned int steps_since_refresh;
+} PublishState;
+
+// Outcome of feeding one received frame to the BCM
+typedef enum {
+    BCM_RX_PENDING = 0,     // Ignored ID or message not complete yet
+    BCM_RX_REJECTED,        // Complete but failed authentication
+    BCM_RX_MESSAGE          // Complete, authentic message
+} BcmRxResult;
 
 // Global variables (declared here as extern for use in main and testing)
-extern pthread_mutex_t mutex_bcm;
 extern volatile int simu_curr_step;
 extern volatile int simu_state;
 extern volatile int simu_order;
@@ -87,27 +109,29 @@ extern int data_size;
 extern VehicleData vehicle_data[SPEED_ARRAY_MAX_SIZE];
 extern int sock_send;
 extern int sock_recv;
-extern char send_msg[];
-extern bool test_mode;
 extern bool fault_active;
-extern int fault_start_time;
 extern const int safety_timeout_ms;
 extern bool data_updated;
+extern CanReassembler bcm_reassembler;
+extern PublishState publish_state;
 
 // Function prototypes for simulation functions (for unit testing purposes)
-void sleep_microseconds(long int microseconds);
-int getCurrentTimeMs_real(void);
 void read_csv_default(void);
 void read_csv(const char *path);
+int read_csv_into(const char *path, VehicleData *rows, int max_rows);
 void check_order(int order);
-void simu_speed_step(VehicleData *sim_data, ControlData controls);
-void* simu_speed(void *arg);
+void latch_system_disable(void);
+bool system_disable_latched(void);
+void clear_system_disable(void);
+void derive_step_controls(VehicleData *cycle, int step);
+void reset_publish_state(void);
 void send_data_update(void);
-void check_health_signals(void);
-void* comms(void *arg);
-void *comms_reception(void *arg);
+void publish_sensor_data(PublishState *state, const VehicleData *data, int sock, canid_t can_id);
+unsigned int health_fault_flags(const VehicleData *data);
+void report_health_fault(int sock, canid_t can_id, unsigned int faults);
 void update_battery_soc(double vehicle_speed);
-void* sensor_battery(void *arg);
-void check_system_disable(int sock_recv);
+void battery_model_update(double *soc, double *volt, double vehicle_speed);
+void parse_input_received_bcm(char *input);
+BcmRxResult bcm_receive_frame(const struct can_frame *frame, char *message);
 
 #endif // SIMU_BCM_H
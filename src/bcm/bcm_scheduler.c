@@ -0,0 +1,370 @@
+#include "bcm_scheduler.h"
+#include <errno.h>
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+
+#define NSEC_PER_MS         (1000000LL)
+#define MS_PER_SEC          (1000LL)
+#define US_PER_MS           (1000LL)
+#define SCHED_MAX_EVENTS    (2)
+
+// Battery sensor event
+static void battery_event(TimerEntry *timer, long long due_ms)
+{
+    BcmScheduler *sched = (BcmScheduler *)timer->arg;
+
+    (void)due_ms;
+    rt_loop_tick(sched->jitter, sched->battery_loop, rt_now_ns());
+    if (simu_state == STATE_RUNNING)
+    {
+        update_battery_soc(vehicle_data[simu_curr_step].speed);
+    }
+}
+
+// Speed step event: controls of the current step, end of cycle
+static void step_event(TimerEntry *timer, long long due_ms)
+{
+    BcmScheduler *sched = (BcmScheduler *)timer->arg;
+
+    rt_loop_tick(sched->jitter, sched->step_loop, rt_now_ns());
+    // A deadline due at this very instant comes before the next step
+    (void)health_watchdog_check(&sched->watchdog, due_ms);
+    check_order(simu_order);
+    if (simu_state == STATE_STOPPED)
+    {
+        // A restart reloads the cycle: monitor it afresh
+        health_watchdog_reset(&sched->watchdog);
+    }
+    if (simu_state != STATE_RUNNING)
+    {
+        return;
+    }
+    if (simu_curr_step + 1 != data_size)
+    {
+        derive_step_controls(vehicle_data, simu_curr_step);
+    }
+    data_updated = true;
+    if (simu_curr_step + 1 == data_size)
+    {
+        simu_order = ORDER_STOP;
+    }
+    sched->steps++;
+}
+
+// Mirror the step just put on the bus to the live state segment
+static void publish_live(const BcmScheduler *sched, int step)
+{
+    const VehicleData *data = &vehicle_data[step];
+    LiveSignals signals;
+
+    if (sched->live == NULL)
+    {
+        return;
+    }
+    (void)memset(&signals, 0, sizeof(signals));
+    signals.present = LIVE_HAS_SIGNALS | LIVE_HAS_FAULTS | LIVE_HAS_STEP;
+    signals.step = step;
+    signals.speed = data->speed;
+    signals.tilt_angle = data->tilt_angle;
+    signals.batt_soc = data->batt_soc;
+    signals.batt_volt = data->batt_volt;
+    signals.engi_temp = data->engi_temp;
+    signals.internal_temp = data->internal_temp;
+    signals.external_temp = data->external_temp;
+    signals.temp_set = data->temp_set;
+    signals.door_open = data->door_open;
+    signals.accel = data->accel;
+    signals.brake = data->brake;
+    signals.gear = data->gear;
+    signals.error_system = fault_active ? 1U : 0U;
+    signals.fault_flags = health_fault_flags(data);
+    live_state_publish(sched->live, &signals);
+}
+
+// Safety watchdog deadline: disable the system, the next step stops the run
+static void health_expired(void *arg, unsigned int faults, long long due_ms)
+{
+    (void)arg;
+    (void)due_ms;
+    report_health_fault(sock_send, CAN_ID_COMMAND, faults);
+    simu_order = ORDER_STOP;
+}
+
+/**
+ * @brief Publish event: send the step computed just
+ * before at the same instant, move on and feed the next step's health to the
+ * safety watchdog.
+ * @requirement SWR2.1
+ * @requirement SWR6.4
+ */
+static void publish_event(TimerEntry *timer, long long due_ms)
+{
+    BcmScheduler *sched = (BcmScheduler *)timer->arg;
+
+    if (simu_state == STATE_RUNNING && data_updated)
+    {
+        send_data_update();
+        publish_live(sched, simu_curr_step);
+        data_updated = false;
+        simu_curr_step++;
+        health_watchdog_sample(&sched->watchdog, health_fault_flags(&vehicle_data[simu_curr_step]), due_ms);
+        fault_active = health_watchdog_active(&sched->watchdog);
+    }
+}
+
+static bool arm_timer_fd(const BcmScheduler *sched)
+{
+    struct itimerspec spec;
+    const long long next_ms = timer_wheel_next_expiry(&sched->wheel);
+
+    (void)memset(&spec, 0, sizeof(spec));
+    if (next_ms >= 0)
+    {
+        spec.it_value.tv_sec = (time_t)(next_ms / MS_PER_SEC);
+        spec.it_value.tv_nsec = (long)((next_ms % MS_PER_SEC) * NSEC_PER_MS);
+        if ((spec.it_value.tv_sec == 0) && (spec.it_value.tv_nsec == 0))
+        {
+            spec.it_value.tv_nsec = 1;  // An all-zero value would disarm the timer
+        }
+    }
+    return timerfd_settime(sched->timer_fd, TFD_TIMER_ABSTIME, &spec, NULL) == 0;
+}
+
+static bool watch_fd(const BcmScheduler *sched, int fd)
+{
+    struct epoll_event event;
+
+    (void)memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    return epoll_ctl(sched->epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+bool bcm_scheduler_init(BcmScheduler *sched, int sock_recv, long long now_ms)
+{
+    (void)memset(sched, 0, sizeof(*sched));
+    sched->epoll_fd = -1;
+    sched->timer_fd = -1;
+    sched->sock_recv = sock_recv;
+    sched->stop_fd = -1;
+
+    // Load the drive cycle and start running
+    check_order(simu_order);
+    for (int i = 0; i < data_size; i++)
+    {
+        vehicle_data[i].temp_set = DEFAULT_SET_TEMP;
+    }
+
+    // Armed in this order so equal deadlines fire battery -> step -> publish
+    timer_wheel_init(&sched->wheel, BCM_SCHED_TICK_MS, now_ms);
+    health_watchdog_init(&sched->watchdog, &sched->wheel, (long long)safety_timeout_ms, health_expired, NULL);
+    if (!timer_wheel_add(&sched->wheel, &sched->battery_timer, now_ms, 0, BCM_SCHED_BATTERY_MS,
+                         battery_event, sched) ||
+        !timer_wheel_add(&sched->wheel, &sched->step_timer, now_ms, 0, BCM_SCHED_STEP_MS,
+                         step_event, sched) ||
+        !timer_wheel_add(&sched->wheel, &sched->publish_timer, now_ms, 0, BCM_SCHED_STEP_MS,
+                         publish_event, sched))
+    {
+        return false;
+    }
+
+    sched->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    sched->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if ((sched->timer_fd < 0) || (sched->epoll_fd < 0) || !watch_fd(sched, sched->timer_fd) ||
+        ((sock_recv >= 0) && !watch_fd(sched, sock_recv)) || !arm_timer_fd(sched))
+    {
+        perror("Error setting up the BCM scheduler");
+        bcm_scheduler_close(sched);
+        return false;
+    }
+    return true;
+}
+
+void bcm_scheduler_track_jitter(BcmScheduler *sched, RtJitterReport *report)
+{
+    sched->jitter = report;
+    sched->step_loop = rt_jitter_add(report, "step", BCM_SCHED_STEP_MS * US_PER_MS);
+    sched->battery_loop = rt_jitter_add(report, "battery", BCM_SCHED_BATTERY_MS * US_PER_MS);
+}
+
+size_t bcm_scheduler_advance(BcmScheduler *sched, long long now_ms)
+{
+    return timer_wheel_advance(&sched->wheel, now_ms);
+}
+
+// One frame per readiness event; epoll reports the socket again while frames remain
+static void receive_event(BcmScheduler *sched, uint32_t events)
+{
+    struct can_frame frame;
+    char message[AES_BLOCK_SIZE + 1];
+
+    if ((events & (EPOLLERR | EPOLLHUP)) != 0U)
+    {
+        (void)fprintf(stderr, "BCM receive socket closed, reception stopped\n");
+        (void)epoll_ctl(sched->epoll_fd, EPOLL_CTL_DEL, sched->sock_recv, NULL);
+        sched->sock_recv = -1;
+        return;
+    }
+    if (receive_can_frame(sched->sock_recv, &frame) != 0)
+    {
+        return;
+    }
+
+    sched->frames++;
+    if (bcm_receive_frame(&frame, message) == BCM_RX_MESSAGE)
+    {
+        sched->messages++;
+        // error_disabled latches: the next step stops and nothing restarts it
+        parse_input_received_bcm(message);
+    }
+}
+
+bool bcm_scheduler_poll(BcmScheduler *sched, int timeout_ms)
+{
+    struct epoll_event events[SCHED_MAX_EVENTS];
+
+    const int count = epoll_wait(sched->epoll_fd, events, SCHED_MAX_EVENTS, timeout_ms);
+    if (count < 0)
+    {
+        return errno == EINTR;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        if (events[i].data.fd == sched->timer_fd)
+        {
+            uint64_t expirations = 0U;
+            (void)read(sched->timer_fd, &expirations, sizeof(expirations));
+            const long long now_ms = timer_wheel_now_ms();
+            (void)bcm_scheduler_advance(sched, now_ms);
+            metrics_flush(now_ms);
+            rt_jitter_flush(sched->jitter, now_ms);
+            if ((sched->checkpoint != NULL) && checkpoint_due(sched->checkpoint, now_ms))
+            {
+                (void)bcm_scheduler_checkpoint(sched, sched->checkpoint, now_ms);
+            }
+            if (!arm_timer_fd(sched))
+            {
+                return false;
+            }
+        }
+        else if ((sched->sock_recv >= 0) && (events[i].data.fd == sched->sock_recv))
+        {
+            receive_event(sched, events[i].events);
+        }
+        else if ((sched->stop_fd >= 0) && (events[i].data.fd == sched->stop_fd))
+        {
+            sched->stopping = true;
+        }
+        else
+        {
+            // Stale event for a descriptor dropped earlier in this batch
+        }
+    }
+    return true;
+}
+
+void bcm_scheduler_run(BcmScheduler *sched, int stop_fd)
+{
+    if ((stop_fd >= 0) && watch_fd(sched, stop_fd))
+    {
+        sched->stop_fd = stop_fd;
+    }
+    while (!sched->stopping)
+    {
+        if (!bcm_scheduler_poll(sched, -1))
+        {
+            perror("BCM scheduler");
+            break;
+        }
+    }
+    if (sched->stop_fd >= 0)
+    {
+        (void)epoll_ctl(sched->epoll_fd, EPOLL_CTL_DEL, sched->stop_fd, NULL);
+        sched->stop_fd = -1;
+    }
+}
+
+bool bcm_scheduler_checkpoint(BcmScheduler *sched, Checkpoint *checkpoint, long long now_ms)
+{
+    BcmCheckpointState state;
+    struct iovec parts[2];
+
+    if ((data_size < 1) || (data_size >= SPEED_ARRAY_MAX_SIZE))
+    {
+        return false;   // No cycle loaded
+    }
+    (void)memset(&state, 0, sizeof(state));
+    state.step = simu_curr_step;
+    state.state = simu_state;
+    state.data_size = data_size;
+    state.batt_soc = batt_soc;
+    state.batt_volt = batt_volt;
+    state.steps = sched->steps;
+    state.fault_elapsed_ms = -1;
+    if (health_watchdog_active(&sched->watchdog))
+    {
+        state.faults = sched->watchdog.faults;
+        state.fault_elapsed_ms = now_ms - sched->watchdog.onset_ms;
+    }
+
+    parts[0].iov_base = &state;
+    parts[0].iov_len = sizeof(state);
+    parts[1].iov_base = vehicle_data;
+    parts[1].iov_len = (size_t)(data_size + 1) * sizeof(VehicleData);
+    return checkpoint_write(checkpoint, BCM_CHECKPOINT_VERSION, parts, 2);
+}
+
+bool bcm_scheduler_restore(BcmScheduler *sched, Checkpoint *checkpoint, long long now_ms)
+{
+    CheckpointSnapshot snapshot;
+    BcmCheckpointState state;
+
+    if (!checkpoint_open(checkpoint, &snapshot, BCM_CHECKPOINT_VERSION))
+    {
+        return false;
+    }
+    bool resumed = snapshot.state_size >= sizeof(state);
+    if (resumed)
+    {
+        (void)memcpy(&state, snapshot.state, sizeof(state));
+        resumed = (state.data_size >= 1) && (state.data_size < SPEED_ARRAY_MAX_SIZE) &&
+                  (state.step >= 0) && (state.step < state.data_size) &&
+                  (snapshot.state_size == sizeof(state) + ((size_t)(state.data_size + 1) * sizeof(VehicleData))) &&
+                  ((state.state == STATE_RUNNING) || (state.state == STATE_PAUSED));
+    }
+    if (resumed)
+    {
+        // The cycle as it was, battery and derived controls included
+        (void)memcpy(vehicle_data, snapshot.state + sizeof(state),
+                     (size_t)(state.data_size + 1) * sizeof(VehicleData));
+        data_size = state.data_size;
+        simu_curr_step = state.step;
+        simu_state = state.state;
+        simu_order = (state.state == STATE_PAUSED) ? ORDER_PAUSE : ORDER_RUN;
+        batt_soc = state.batt_soc;
+        batt_volt = state.batt_volt;
+        data_updated = false;
+        reset_publish_state();      // Receivers get a full refresh first
+        sched->steps = (unsigned long)state.steps;
+        health_watchdog_resume(&sched->watchdog, state.faults, state.fault_elapsed_ms, now_ms);
+        fault_active = health_watchdog_active(&sched->watchdog);
+    }
+    checkpoint_close(&snapshot);
+    return resumed;
+}
+
+void bcm_scheduler_close(BcmScheduler *sched)
+{
+    if (sched->epoll_fd >= 0)
+    {
+        (void)close(sched->epoll_fd);
+        sched->epoll_fd = -1;
+    }
+    if (sched->timer_fd >= 0)
+    {
+        (void)close(sched->timer_fd);
+        sched->timer_fd = -1;
+    }
+}
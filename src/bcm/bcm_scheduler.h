@@ -0,0 +1,89 @@
+#ifndef BCM_SCHEDULER_H
+#define BCM_SCHEDULER_H
+
+#include "bcm_func.h"
+#include "health_watchdog.h"
+#include "../common_includes/timer_wheel.h"
+#include "../common_includes/rt_sched.h"
+#include "../common_includes/live_state.h"
+#include "../common_includes/checkpoint.h"
+
+/*
+ * Single-threaded BCM main loop.
+ *
+ * The battery, step and publish events sit on a timer wheel, a timerfd is
+ * armed for the earliest one, and epoll waits on that timerfd and on the
+ * receive socket together. Events due at the same instant fire in the order
+ * battery -> step -> publish, so every step publishes the data computed for
+ * it, one step period after the previous one, with no semaphore or mutex.
+ * The SWR6.4 watchdog deadline sits on the same wheel, so the timerfd wakes
+ * the loop for it even between two steps.
+ */
+#define BCM_SCHED_TICK_MS       (10LL)
+#define BCM_SCHED_STEP_MS       (1000LL)
+#define BCM_SCHED_BATTERY_MS    (500LL)
+#define BCM_CHECKPOINT_VERSION  (1U)
+
+/* Checkpointed simulation, followed by the rows of the loaded cycle
+   (data_size + 1, the look-ahead row included) */
+typedef struct {
+    int32_t step;               // simu_curr_step
+    int32_t state;              // simu_state
+    int32_t data_size;
+    uint32_t faults;            // Watchdog condition, 0 while healthy
+    int64_t fault_elapsed_ms;   // Time since its onset, -1 while healthy
+    double batt_soc;
+    double batt_volt;
+    uint64_t steps;
+} BcmCheckpointState;
+
+typedef struct {
+    TimerWheel wheel;
+    TimerEntry battery_timer;
+    TimerEntry step_timer;
+    TimerEntry publish_timer;
+    HealthWatchdog watchdog;        // safety_timeout_ms from the first faulty step published
+    int epoll_fd;
+    int timer_fd;
+    int sock_recv;
+    int stop_fd;                    // Readable to stop bcm_scheduler_run, -1 if none
+    bool stopping;
+    unsigned long steps;            // Step events that found the simulation running
+    unsigned long frames;           // Frames read from sock_recv
+    unsigned long messages;         // Authentic messages among them
+    RtJitterReport *jitter;         // NULL: periods are not measured
+    RtLoop *step_loop;
+    RtLoop *battery_loop;
+    LiveState *live;                // NULL: published steps are not mirrored
+    Checkpoint *checkpoint;         // NULL: no periodic snapshots
+} BcmScheduler;
+
+/* Load the drive cycle, start the simulation and arm the events from now_ms.
+   sock_recv may be -1 to run without reception. */
+bool bcm_scheduler_init(BcmScheduler *sched, int sock_recv, long long now_ms);
+
+/* Measure the actual period of the step and battery events against their
+   targets, BCM_SCHED_STEP_MS and BCM_SCHED_BATTERY_MS */
+void bcm_scheduler_track_jitter(BcmScheduler *sched, RtJitterReport *report);
+
+// Fire the events due up to now_ms; returns how many fired
+size_t bcm_scheduler_advance(BcmScheduler *sched, long long now_ms);
+
+/* One loop iteration: wait up to timeout_ms (-1: until the next event) for a
+   timer or a frame and handle it. Returns false on an unrecoverable error. */
+bool bcm_scheduler_poll(BcmScheduler *sched, int timeout_ms);
+
+/* Loop until stop_fd becomes readable (-1: forever) or an error occurs. The
+   descriptor joins the epoll set, so the loop stops within one wake-up. */
+void bcm_scheduler_run(BcmScheduler *sched, int stop_fd);
+
+// Snapshot the simulation, its loaded cycle and the watchdog condition now
+bool bcm_scheduler_checkpoint(BcmScheduler *sched, Checkpoint *checkpoint, long long now_ms);
+
+/* Resume the run saved in the ECU's snapshot, if it was running or paused
+   (a finished or disabled run starts over); returns true if resumed */
+bool bcm_scheduler_restore(BcmScheduler *sched, Checkpoint *checkpoint, long long now_ms);
+
+void bcm_scheduler_close(BcmScheduler *sched);
+
+#endif // BCM_SCHEDULER_H
@@ -0,0 +1,57 @@
+#include "bcm_trace.h"
+#include "bcm_fleet.h"
+
+// Battery model updates per published step, as the fleet timers fire them
+#define BATTERY_UPDATES_PER_STEP ((int)(FLEET_STEP_MS / FLEET_BATTERY_MS))
+
+/**
+ * @brief Build the clean trace of a drive cycle, step by step as
+ * vehicle_battery_event and vehicle_step_event would publish it.
+ * @requirement SWR2.1
+ */
+bool bcm_cycle_trace(const char *path, SignalTrace *trace)
+{
+    VehicleData *rows = (VehicleData *)calloc(SPEED_ARRAY_MAX_SIZE, sizeof(VehicleData));
+    double soc = DEFAULT_BATTERY_SOC;
+    double volt = DEFAULT_BATTERY_VOLTAGE;
+
+    if (rows == NULL)
+    {
+        return false;
+    }
+    const int steps = read_csv_into(path, rows, SPEED_ARRAY_MAX_SIZE);
+    if ((steps < 1) || !signal_trace_alloc(trace, (size_t)steps))
+    {
+        free(rows);
+        return false;
+    }
+
+    for (int i = 0; i < steps; i++)
+    {
+        VehicleData *row = &rows[i];
+        // The last step has no next speed to derive from, as in the fleet
+        if ((i + 1) < steps)
+        {
+            derive_step_controls(rows, i);
+        }
+        for (int b = 0; b < BATTERY_UPDATES_PER_STEP; b++)
+        {
+            battery_model_update(&soc, &volt, row->speed);
+        }
+
+        trace->values[TRACE_SPEED][i] = row->speed;
+        trace->values[TRACE_INTERNAL_TEMP][i] = (double)row->internal_temp;
+        trace->values[TRACE_EXTERNAL_TEMP][i] = (double)row->external_temp;
+        trace->values[TRACE_DOOR_OPEN][i] = (double)row->door_open;
+        trace->values[TRACE_TILT_ANGLE][i] = row->tilt_angle;
+        trace->values[TRACE_ACCEL][i] = (double)row->accel;
+        trace->values[TRACE_BRAKE][i] = (double)row->brake;
+        trace->values[TRACE_TEMP_SET][i] = (double)DEFAULT_SET_TEMP;
+        trace->values[TRACE_BATT_SOC][i] = soc;
+        trace->values[TRACE_BATT_VOLT][i] = volt;
+        trace->values[TRACE_ENGI_TEMP][i] = row->engi_temp;
+        trace->values[TRACE_GEAR][i] = (double)row->gear;
+    }
+    free(rows);
+    return true;
+}
@@ -0,0 +1,20 @@
+#ifndef BCM_TRACE_H
+#define BCM_TRACE_H
+
+#include <stdbool.h>
+
+#include "../common_includes/sensor_noise.h"
+
+/*
+ * A drive cycle as the BCM puts it on the bus, one step per published PDU,
+ * as a SignalTrace for offline studies (Monte Carlo noise runs). Only
+ * neutral types are exposed so powertrain-side code can include this header.
+ */
+
+/* Load a cycle file (CSV or binary) and derive each step as the fleet mode
+   does: pedals and gear from the speed profile, the battery model run at its
+   own pace from the default charge, the default AC set point. Allocates
+   trace; false if the file holds no step. */
+bool bcm_cycle_trace(const char *path, SignalTrace *trace);
+
+#endif // BCM_TRACE_H
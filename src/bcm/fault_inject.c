@@ -0,0 +1,148 @@
+#include "fault_inject.h"
+#include "bcm_fleet.h"
+
+_Static_assert(FAULT_BIT(FAULT_DOOR) == HEALTH_FAULT_DOOR, "fault bits differ");
+_Static_assert(FAULT_BIT(FAULT_ENGINE_TEMP) == HEALTH_FAULT_ENGINE_TEMP, "fault bits differ");
+_Static_assert(FAULT_BIT(FAULT_TILT) == HEALTH_FAULT_TILT, "fault bits differ");
+
+static BcmFleetConfig single_vehicle(const char *cycle_path, long long step_ms, int sock)
+{
+    BcmFleetConfig config;
+
+    (void)memset(&config, 0, sizeof(config));
+    config.count = 1U;
+    config.cycle_paths[0] = cycle_path;
+    config.num_cycles = 1U;
+    config.socks[0] = sock;
+    config.num_socks = 1U;
+    config.step_ms = step_ms;
+    // The step period is the sampling rate under test, not a time scale
+    config.timeout_ms = (long long)safety_timeout_ms;
+    return config;
+}
+
+long long fault_inject_timeout_ms(void)
+{
+    return (long long)safety_timeout_ms;
+}
+
+bool fault_inject_cycle_healthy(const char *cycle_path, uint32_t steps)
+{
+    const BcmFleetConfig config = single_vehicle(cycle_path, FLEET_STEP_MS, -1);
+    BcmFleet *fleet = (BcmFleet *)calloc(1U, sizeof(BcmFleet));
+    bool healthy = false;
+
+    if ((fleet == NULL) || !bcm_fleet_init(fleet, &config, 0))
+    {
+        free(fleet);
+        return false;
+    }
+
+    const BcmVehicle *vehicle = &fleet->vehicles[0];
+    healthy = ((int)steps < vehicle->cycle_size);
+    for (uint32_t row = 1U; healthy && (row <= steps); row++)
+    {
+        healthy = (health_fault_flags(&vehicle->cycle[row]) == 0U);
+    }
+
+    bcm_fleet_free(fleet);
+    free(fleet);
+    return healthy;
+}
+
+static void inject(const FaultScenario *scenario, VehicleData *cycle)
+{
+    for (uint32_t row = 1U; row <= scenario->steps; row++)
+    {
+        // Later episodes win where causes of the same type overlap
+        for (unsigned int e = 0U; e < scenario->num_episodes; e++)
+        {
+            const FaultEpisode *episode = &scenario->episodes[e];
+
+            if (!fault_episode_active(episode, row))
+            {
+                continue;
+            }
+            if (episode->type == FAULT_DOOR)
+            {
+                cycle[row].door_open = (int)episode->value;
+            }
+            else if (episode->type == FAULT_ENGINE_TEMP)
+            {
+                cycle[row].engi_temp = episode->value;
+            }
+            else if (episode->type == FAULT_TILT)
+            {
+                cycle[row].tilt_angle = episode->value;
+            }
+            else
+            {
+                // No other fault type
+            }
+        }
+    }
+}
+
+/**
+ * @brief Inject a fault scenario into a drive cycle and run the fleet step
+ * event on it until the fault is reported or the scenario window ends.
+ * @requirement SWR6.4
+ */
+bool fault_inject_run(const char *cycle_path, const FaultScenario *scenario, long long step_ms,
+                      int sock, FaultInjectStepFn on_step, void *arg, FaultInjectResult *result)
+{
+    const BcmFleetConfig config = single_vehicle(cycle_path, step_ms, sock);
+    BcmFleet *fleet = (BcmFleet *)calloc(1U, sizeof(BcmFleet));
+
+    (void)memset(result, 0, sizeof(*result));
+    result->latency_ms = -1;
+    if ((fleet == NULL) || !bcm_fleet_init(fleet, &config, 0))
+    {
+        free(fleet);
+        return false;
+    }
+
+    BcmVehicle *vehicle = &fleet->vehicles[0];
+    if ((int)scenario->steps >= vehicle->cycle_size)
+    {
+        bcm_fleet_free(fleet);
+        free(fleet);
+        return false;
+    }
+    inject(scenario, vehicle->cycle);
+
+    /* One advance per period: row `step` is sampled at (step - 1) * step_ms,
+       and a watchdog deadline between two samples fires in the advance after it */
+    for (long long now_ms = 0; vehicle->running && ((uint32_t)vehicle->step < scenario->steps); now_ms += step_ms)
+    {
+        (void)bcm_fleet_advance(fleet, now_ms);
+        if (on_step != NULL)
+        {
+            on_step(arg);
+        }
+    }
+
+    result->published = vehicle->published;
+    if (vehicle->fault_flags != 0U)
+    {
+        result->detected = true;
+        result->step = (uint32_t)vehicle->step;
+        result->faults = vehicle->fault_flags;
+
+        // Back to the first row of the injected run the report belongs to
+        uint32_t start = result->step;
+        while ((start > 1U) && (fault_scenario_mask(scenario, start - 1U) != 0U))
+        {
+            start--;
+        }
+        if (fault_scenario_mask(scenario, result->step) != 0U)
+        {
+            result->onset_ms = (long long)(start - 1U) * step_ms;
+            result->latency_ms = vehicle->fault_ms - result->onset_ms;
+        }
+    }
+
+    bcm_fleet_free(fleet);
+    free(fleet);
+    return true;
+}
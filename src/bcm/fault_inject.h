@@ -0,0 +1,43 @@
+#ifndef FAULT_INJECT_H
+#define FAULT_INJECT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../common_includes/fault_scenario.h"
+
+/*
+ * Runs a fault scenario through the BCM health monitoring, in virtual time.
+ *
+ * The drive cycle is loaded as a one-vehicle fleet, the scenario's adverse
+ * values are written into its rows and the fleet is advanced one step period
+ * at a time, so the watchdog sees exactly step_ms between samples and
+ * reports at onset + safety_timeout_ms, on the last row sampled before. Every
+ * PDU and the error_disabled report go to `sock` as on the real bus.
+ *
+ * Kept free of the BCM headers so a campaign can be linked against the
+ * other ECUs' code too (their VehicleData types differ).
+ */
+typedef struct {
+    bool detected;
+    uint32_t step;          // Row the fault was reported on
+    unsigned int faults;    // FAULT_BIT causes reported
+    long long onset_ms;     // Sampling of the first row of the injected run reported
+    long long latency_ms;   // Report time - onset_ms, -1 when reported on a healthy row
+    unsigned long published;
+} FaultInjectResult;
+
+// Called after every step period, e.g. to forward what was sent on sock
+typedef void (*FaultInjectStepFn)(void *arg);
+
+// Configured SWR6.4 timeout
+long long fault_inject_timeout_ms(void);
+
+/* Whether rows 1..steps of the cycle exist and hold no fault of their own,
+   so that every fault seen in a scenario is an injected one */
+bool fault_inject_cycle_healthy(const char *cycle_path, uint32_t steps);
+
+bool fault_inject_run(const char *cycle_path, const FaultScenario *scenario, long long step_ms,
+                      int sock, FaultInjectStepFn on_step, void *arg, FaultInjectResult *result);
+
+#endif // FAULT_INJECT_H
@@ -0,0 +1,115 @@
+#include "health_watchdog.h"
+#include <stddef.h>
+
+static void fire(HealthWatchdog *watchdog, long long due_ms)
+{
+    watchdog->expired = true;
+    if (watchdog->on_expired != NULL)
+    {
+        watchdog->on_expired(watchdog->arg, watchdog->faults, due_ms);
+    }
+}
+
+static void deadline_event(TimerEntry *timer, long long due_ms)
+{
+    fire((HealthWatchdog *)timer->arg, due_ms);
+}
+
+void health_watchdog_init(HealthWatchdog *watchdog, TimerWheel *wheel, long long timeout_ms,
+                          HealthWatchdogFn on_expired, void *arg)
+{
+    watchdog->wheel = wheel;
+    watchdog->timer.armed = false;
+    watchdog->timeout_ms = timeout_ms;
+    watchdog->faults = 0U;
+    watchdog->onset_ms = -1;
+    watchdog->expired = false;
+    watchdog->on_expired = on_expired;
+    watchdog->arg = arg;
+}
+
+bool health_watchdog_check(HealthWatchdog *watchdog, long long now_ms)
+{
+    if (!watchdog->timer.armed || (watchdog->timer.expires_ms > now_ms))
+    {
+        return false;
+    }
+    // Same tick as an earlier event: deliver it here, at its own time
+    const long long due_ms = watchdog->timer.expires_ms;
+    timer_wheel_cancel(watchdog->wheel, &watchdog->timer);
+    fire(watchdog, due_ms);
+    return true;
+}
+
+/**
+ * @brief Start the deadline on the first faulty sample, cancel it on a
+ * healthy one.
+ * @requirement SWR6.4
+ */
+void health_watchdog_sample(HealthWatchdog *watchdog, unsigned int faults, long long now_ms)
+{
+    if (health_watchdog_check(watchdog, now_ms) || watchdog->expired)
+    {
+        return;
+    }
+
+    if (faults == 0U)
+    {
+        timer_wheel_cancel(watchdog->wheel, &watchdog->timer);
+        watchdog->faults = 0U;
+        watchdog->onset_ms = -1;
+    }
+    else if (watchdog->onset_ms < 0)
+    {
+        watchdog->faults = faults;
+        watchdog->onset_ms = now_ms;
+        if (watchdog->timeout_ms <= 0)
+        {
+            fire(watchdog, now_ms);
+        }
+        else
+        {
+            (void)timer_wheel_add(watchdog->wheel, &watchdog->timer, now_ms, watchdog->timeout_ms, 0,
+                                  deadline_event, watchdog);
+        }
+    }
+    else
+    {
+        // Still adverse: the deadline stands, the causes are the latest ones
+        watchdog->faults = faults;
+    }
+}
+
+bool health_watchdog_active(const HealthWatchdog *watchdog)
+{
+    return watchdog->onset_ms >= 0;
+}
+
+void health_watchdog_reset(HealthWatchdog *watchdog)
+{
+    timer_wheel_cancel(watchdog->wheel, &watchdog->timer);
+    watchdog->faults = 0U;
+    watchdog->onset_ms = -1;
+    watchdog->expired = false;
+}
+
+void health_watchdog_resume(HealthWatchdog *watchdog, unsigned int faults, long long elapsed_ms,
+                            long long now_ms)
+{
+    health_watchdog_reset(watchdog);
+    if ((faults == 0U) || (elapsed_ms < 0))
+    {
+        return;
+    }
+    watchdog->faults = faults;
+    watchdog->onset_ms = now_ms - elapsed_ms;
+    if (elapsed_ms >= watchdog->timeout_ms)
+    {
+        fire(watchdog, now_ms);
+    }
+    else
+    {
+        (void)timer_wheel_add(watchdog->wheel, &watchdog->timer, now_ms, watchdog->timeout_ms - elapsed_ms, 0,
+                              deadline_event, watchdog);
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef HEALTH_WATCHDOG_H
+#define HEALTH_WATCHDOG_H
+
+#include <stdbool.h>
+
+#include "../common_includes/timer_wheel.h"
+
+/*
+ * SWR6.4 safety watchdog.
+ *
+ * The first faulty sample arms a one-shot timer on the caller's timer wheel
+ * for onset + timeout_ms; a healthy sample cancels it. The disable therefore
+ * fires at the deadline itself, as soon as whoever drives the wheel (a
+ * timerfd armed for its earliest timer, or a virtual clock) reaches it, and
+ * not on the first sample taken after it. A sample never waits for the timer
+ * to be delivered: when the deadline has already passed, it fires first.
+ *
+ * The watchdog latches once it has fired, until health_watchdog_reset.
+ */
+typedef void (*HealthWatchdogFn)(void *arg, unsigned int faults, long long due_ms);
+
+typedef struct {
+    TimerWheel *wheel;
+    TimerEntry timer;
+    long long timeout_ms;
+    unsigned int faults;        // HEALTH_FAULT_* bits of the last faulty sample
+    long long onset_ms;         // First sample of the adverse condition, -1 while healthy
+    bool expired;
+    HealthWatchdogFn on_expired;
+    void *arg;
+} HealthWatchdog;
+
+void health_watchdog_init(HealthWatchdog *watchdog, TimerWheel *wheel, long long timeout_ms,
+                          HealthWatchdogFn on_expired, void *arg);
+
+/* Fire the deadline if it is due at now_ms and the wheel has not delivered it
+   yet; returns true if it fired in this call */
+bool health_watchdog_check(HealthWatchdog *watchdog, long long now_ms);
+
+// Feed the HEALTH_FAULT_* bits sampled at now_ms
+void health_watchdog_sample(HealthWatchdog *watchdog, unsigned int faults, long long now_ms);
+
+// An adverse condition is present (its deadline pending or reached)
+bool health_watchdog_active(const HealthWatchdog *watchdog);
+
+// Disarm and forget the condition and the latch
+void health_watchdog_reset(HealthWatchdog *watchdog);
+
+/* Take over a condition that had lasted elapsed_ms (restored from a
+   checkpoint): the deadline stays timeout_ms after its original onset */
+void health_watchdog_resume(HealthWatchdog *watchdog, unsigned int faults, long long elapsed_ms,
+                            long long now_ms);
+
+#endif // HEALTH_WATCHDOG_H
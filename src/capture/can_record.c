@@ -0,0 +1,116 @@
+/*
+ * CAN bus recorder.
+ *
+ * Writes every frame seen on the interface, with its kernel receive
+ * timestamp, to a binary capture file (see can_capture.h). Frames are stored
+ * as they are on the bus, still encrypted, so a capture can be replayed
+ * later with can_replay or exported to candump text.
+ */
+#include <getopt.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../common_includes/can_socket.h"
+#include "../common_includes/can_capture.h"
+
+#define CAN_INTERFACE       ("vcan0")
+#define ERROR_CODE          (1)
+#define DEFAULT_CAPTURE     ("capture.bin")
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void handle_stop(int signum)
+{
+    (void)signum;
+    stop_requested = 1;
+}
+
+static void usage(const char *prog)
+{
+    (void)fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  -i IFACE    CAN interface (default %s)\n"
+        "  -o FILE     capture file (default %s)\n"
+        "  -n COUNT    stop after COUNT frames (default: until Ctrl+C)\n"
+        "  -v          also print each frame in candump -L format\n",
+        prog, CAN_INTERFACE, DEFAULT_CAPTURE);
+}
+
+int main(int argc, char **argv)
+{
+    const char *iface = CAN_INTERFACE;
+    const char *path = DEFAULT_CAPTURE;
+    unsigned long max_frames = 0UL;
+    bool verbose = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "i:o:n:vh")) != -1)
+    {
+        switch (opt)
+        {
+        case 'i': iface = optarg; break;
+        case 'o': path = optarg; break;
+        case 'n': max_frames = strtoul(optarg, NULL, 10); break;
+        case 'v': verbose = true; break;
+        default:
+            usage(argv[0]);
+            return ERROR_CODE;
+        }
+    }
+
+    int sock = create_can_socket(iface);
+    if (sock < 0)
+    {
+        return ERROR_CODE;
+    }
+    if (!can_capture_enable_timestamps(sock))
+    {
+        (void)fprintf(stderr, "Kernel timestamps unavailable, using receive time\n");
+    }
+
+    static CanCaptureWriter writer;
+    if (!can_capture_open_writer(&writer, path))
+    {
+        close_can_socket(sock);
+        return ERROR_CODE;
+    }
+
+    // No SA_RESTART: a signal must interrupt the blocking receive
+    struct sigaction action;
+    (void)memset(&action, 0, sizeof(action));
+    action.sa_handler = handle_stop;
+    (void)sigaction(SIGINT, &action, NULL);
+    (void)sigaction(SIGTERM, &action, NULL);
+
+    struct can_frame frame;
+    uint64_t timestamp_ns = 0U;
+    char line[CAN_CAPTURE_LINE_SIZE];
+
+    while ((stop_requested == 0) && ((max_frames == 0UL) || (writer.records < max_frames)))
+    {
+        if (can_capture_receive(sock, &frame, &timestamp_ns) < 0)
+        {
+            continue;
+        }
+        if (!can_capture_write(&writer, &frame, timestamp_ns))
+        {
+            perror("Error writing capture file");
+            break;
+        }
+        if (verbose)
+        {
+            const CanCaptureRecord *last = (const CanCaptureRecord *)
+                &writer.buffer[writer.used - sizeof(CanCaptureRecord)];
+            (void)can_capture_format_candump(last, iface, line, sizeof(line));
+            (void)printf("%s\n", line);
+        }
+    }
+
+    const bool ok = can_capture_close_writer(&writer);
+    (void)fprintf(stderr, "%lu frames written to %s\n", writer.records, path);
+    close_can_socket(sock);
+    return ok ? EXIT_SUCCESS : ERROR_CODE;
+}
@@ -0,0 +1,108 @@
+/*
+ * CAN capture replayer and exporter.
+ *
+ * Sends the frames of a capture written by can_record back onto a CAN
+ * interface, keeping the recorded timing at 1x, scaled by a speed factor or
+ * as fast as possible (-s 0). With -e the capture is printed in candump -L
+ * text format instead, for canplayer, Wireshark and other can-utils tools.
+ */
+#include <getopt.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../common_includes/can_socket.h"
+#include "../common_includes/can_capture.h"
+
+#define CAN_INTERFACE       ("vcan0")
+#define ERROR_CODE          (1)
+#define DEFAULT_SPEED       (1.0)
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void handle_stop(int signum)
+{
+    (void)signum;
+    stop_requested = 1;
+}
+
+static void usage(const char *prog)
+{
+    (void)fprintf(stderr,
+        "Usage: %s [options] CAPTURE\n"
+        "  -i IFACE    CAN interface (default %s)\n"
+        "  -s SPEED    replay speed factor, 0 = as fast as possible (default %.0f)\n"
+        "  -e          print the capture in candump -L format and exit\n",
+        prog, CAN_INTERFACE, DEFAULT_SPEED);
+}
+
+static void export_candump(const CanCaptureReader *reader, const char *iface)
+{
+    char line[CAN_CAPTURE_LINE_SIZE];
+
+    for (size_t i = 0U; i < reader->count; i++)
+    {
+        (void)can_capture_format_candump(&reader->records[i], iface, line, sizeof(line));
+        (void)printf("%s\n", line);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const char *iface = CAN_INTERFACE;
+    double speed = DEFAULT_SPEED;
+    bool export_only = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "i:s:eh")) != -1)
+    {
+        switch (opt)
+        {
+        case 'i': iface = optarg; break;
+        case 's': speed = atof(optarg); break;
+        case 'e': export_only = true; break;
+        default:
+            usage(argv[0]);
+            return ERROR_CODE;
+        }
+    }
+    if ((optind >= argc) || (speed < 0.0))
+    {
+        usage(argv[0]);
+        return ERROR_CODE;
+    }
+
+    CanCaptureReader reader;
+    if (!can_capture_open_reader(&reader, argv[optind]))
+    {
+        return ERROR_CODE;
+    }
+
+    if (export_only)
+    {
+        export_candump(&reader, iface);
+        can_capture_close_reader(&reader);
+        return EXIT_SUCCESS;
+    }
+
+    int sock = create_can_socket(iface);
+    if (sock < 0)
+    {
+        can_capture_close_reader(&reader);
+        return ERROR_CODE;
+    }
+
+    (void)signal(SIGINT, handle_stop);
+    (void)signal(SIGTERM, handle_stop);
+
+    /* Played once: the receivers' replay protection rejects a second pass
+       with the same freshness counters, as it would on a real bus */
+    const size_t sent = can_replay_run(&reader, sock, speed, &stop_requested);
+    (void)fprintf(stderr, "%zu of %zu frames replayed on %s\n", sent, reader.count, iface);
+
+    close_can_socket(sock);
+    can_capture_close_reader(&reader);
+    return EXIT_SUCCESS;
+}
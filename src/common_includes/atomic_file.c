@@ -0,0 +1,27 @@
+#include "atomic_file.h"
+#include <unistd.h>
+
+FILE *atomic_file_open(AtomicFile *atomic, const char *path)
+{
+    atomic->path = path;
+    (void)snprintf(atomic->tmp_path, sizeof(atomic->tmp_path), "%s%s", path,
+                   ATOMIC_FILE_TMP_SUFFIX);
+    atomic->file = fopen(atomic->tmp_path, "w");
+    return atomic->file;
+}
+
+bool atomic_file_commit(AtomicFile *atomic, bool sync)
+{
+    bool ok = (ferror(atomic->file) == 0) && (fflush(atomic->file) == 0);
+
+    // On disk before it replaces the previous file
+    ok = ok && (!sync || (fsync(fileno(atomic->file)) == 0));
+    ok = (fclose(atomic->file) == 0) && ok;
+    atomic->file = NULL;
+    if (!ok || (rename(atomic->tmp_path, atomic->path) != 0))
+    {
+        (void)unlink(atomic->tmp_path);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,30 @@
+#ifndef ATOMIC_FILE_H
+#define ATOMIC_FILE_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+/*
+ * Whole-file replacement for the files other processes read while the ECUs
+ * run (stats, metrics, jitter report, checkpoints). The content is written to
+ * "<path>.tmp", which atomic_file_commit renames over path: a reader opens
+ * either the previous file or the new one, never a half-written one.
+ */
+#define ATOMIC_FILE_TMP_SUFFIX  ".tmp"
+#define ATOMIC_FILE_PATH_SIZE   (256)
+
+typedef struct {
+    FILE *file;
+    const char *path;           // Caller-owned, must outlive the commit
+    char tmp_path[ATOMIC_FILE_PATH_SIZE + sizeof(ATOMIC_FILE_TMP_SUFFIX)];
+} AtomicFile;
+
+// Open the temporary file of path for writing; NULL on error
+FILE *atomic_file_open(AtomicFile *atomic, const char *path);
+
+/* Close the temporary file and rename it over path, after an fsync if sync is
+   set. On any write error the temporary file is removed and path is left as
+   it was. */
+bool atomic_file_commit(AtomicFile *atomic, bool sync);
+
+#endif // ATOMIC_FILE_H
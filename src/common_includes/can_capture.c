@@ -0,0 +1,295 @@
+#include "can_capture.h"
+#include "can_socket.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#define NSEC_PER_SEC     (1000000000ULL)
+#define NSEC_PER_USEC    (1000ULL)
+#define CAPTURE_CMSG_SIZE (64U)
+
+static uint64_t realtime_ns(void)
+{
+    struct timespec now;
+    (void)clock_gettime(CLOCK_REALTIME, &now);
+    return ((uint64_t)now.tv_sec * NSEC_PER_SEC) + (uint64_t)now.tv_nsec;
+}
+
+static bool write_all(int fd, const unsigned char *data, size_t len)
+{
+    while (len > 0U)
+    {
+        const ssize_t written = write(fd, data, len);
+        if (written <= 0)
+        {
+            return false;
+        }
+        data += written;
+        len -= (size_t)written;
+    }
+    return true;
+}
+
+bool can_capture_open_writer(CanCaptureWriter *writer, const char *path)
+{
+    CanCaptureHeader header;
+
+    writer->used = 0U;
+    writer->records = 0UL;
+    writer->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (writer->fd < 0)
+    {
+        perror("Error opening capture file");
+        return false;
+    }
+
+    (void)memset(&header, 0, sizeof(header));
+    (void)memcpy(header.magic, CAN_CAPTURE_MAGIC, CAN_CAPTURE_MAGIC_SIZE);
+    header.version = CAN_CAPTURE_VERSION;
+    header.record_size = (uint32_t)sizeof(CanCaptureRecord);
+
+    (void)memcpy(writer->buffer, &header, sizeof(header));
+    writer->used = sizeof(header);
+    return true;
+}
+
+bool can_capture_flush(CanCaptureWriter *writer)
+{
+    const bool ok = write_all(writer->fd, writer->buffer, writer->used);
+    writer->used = 0U;
+    return ok;
+}
+
+bool can_capture_write(CanCaptureWriter *writer, const struct can_frame *frame,
+                       uint64_t timestamp_ns)
+{
+    CanCaptureRecord record;
+
+    if ((writer->used + sizeof(record)) > sizeof(writer->buffer))
+    {
+        if (!can_capture_flush(writer))
+        {
+            return false;
+        }
+    }
+
+    (void)memset(&record, 0, sizeof(record));
+    record.timestamp_ns = timestamp_ns;
+    record.can_id = frame->can_id;
+    record.dlc = (frame->can_dlc <= CAN_MAX_DLEN) ? frame->can_dlc : CAN_MAX_DLEN;
+    (void)memcpy(record.data, frame->data, record.dlc);
+
+    (void)memcpy(&writer->buffer[writer->used], &record, sizeof(record));
+    writer->used += sizeof(record);
+    writer->records++;
+    return true;
+}
+
+bool can_capture_close_writer(CanCaptureWriter *writer)
+{
+    bool ok = true;
+
+    if (writer->fd >= 0)
+    {
+        ok = can_capture_flush(writer);
+        ok = (close(writer->fd) == 0) && ok;
+        writer->fd = -1;
+    }
+    return ok;
+}
+
+bool can_capture_open_reader(CanCaptureReader *reader, const char *path)
+{
+    struct stat info;
+    const CanCaptureHeader *header = NULL;
+
+    (void)memset(reader, 0, sizeof(*reader));
+
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        perror("Error opening capture file");
+        return false;
+    }
+    if ((fstat(fd, &info) != 0) || ((size_t)info.st_size < sizeof(CanCaptureHeader)))
+    {
+        (void)fprintf(stderr, "Capture file too short: %s\n", path);
+        (void)close(fd);
+        return false;
+    }
+
+    void *map = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    (void)close(fd);
+    if (map == MAP_FAILED)
+    {
+        perror("Error mapping capture file");
+        return false;
+    }
+
+    header = (const CanCaptureHeader *)map;
+    if ((memcmp(header->magic, CAN_CAPTURE_MAGIC, CAN_CAPTURE_MAGIC_SIZE) != 0) ||
+        (header->version != CAN_CAPTURE_VERSION) ||
+        (header->record_size != sizeof(CanCaptureRecord)))
+    {
+        (void)fprintf(stderr, "Not a CAN capture file: %s\n", path);
+        (void)munmap(map, (size_t)info.st_size);
+        return false;
+    }
+
+    reader->map = (const unsigned char *)map;
+    reader->map_size = (size_t)info.st_size;
+    reader->records = (const CanCaptureRecord *)(reader->map + sizeof(CanCaptureHeader));
+    // A truncated last record (recorder killed mid-write) is ignored
+    reader->count = (reader->map_size - sizeof(CanCaptureHeader)) / sizeof(CanCaptureRecord);
+    return true;
+}
+
+void can_capture_close_reader(CanCaptureReader *reader)
+{
+    if (reader->map != NULL)
+    {
+        (void)munmap((void *)reader->map, reader->map_size);
+    }
+    (void)memset(reader, 0, sizeof(*reader));
+}
+
+void can_capture_to_frame(const CanCaptureRecord *record, struct can_frame *frame)
+{
+    (void)memset(frame, 0, sizeof(*frame));
+    frame->can_id = record->can_id;
+    frame->can_dlc = (record->dlc <= CAN_MAX_DLEN) ? record->dlc : CAN_MAX_DLEN;
+    (void)memcpy(frame->data, record->data, frame->can_dlc);
+}
+
+int can_capture_format_candump(const CanCaptureRecord *record, const char *iface,
+                               char *line, size_t size)
+{
+    const unsigned long long sec = record->timestamp_ns / NSEC_PER_SEC;
+    const unsigned long long usec = (record->timestamp_ns % NSEC_PER_SEC) / NSEC_PER_USEC;
+    const uint8_t dlc = (record->dlc <= CAN_MAX_DLEN) ? record->dlc : CAN_MAX_DLEN;
+    int len = 0;
+
+    // Same layout as "candump -L", so canplayer and other can-utils accept it
+    if ((record->can_id & CAN_EFF_FLAG) != 0U)
+    {
+        len = snprintf(line, size, "(%010llu.%06llu) %s %08X#", sec, usec, iface,
+                       (unsigned int)(record->can_id & CAN_EFF_MASK));
+    }
+    else
+    {
+        len = snprintf(line, size, "(%010llu.%06llu) %s %03X#", sec, usec, iface,
+                       (unsigned int)(record->can_id & CAN_SFF_MASK));
+    }
+
+    for (uint8_t i = 0U; (i < dlc) && (len > 0) && ((size_t)len < size); i++)
+    {
+        len += snprintf(&line[len], size - (size_t)len, "%02X", record->data[i]);
+    }
+    return len;
+}
+
+bool can_capture_enable_timestamps(int sock)
+{
+    const int enable = 1;
+    return setsockopt(sock, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable)) == 0;
+}
+
+int can_capture_receive(int sock, struct can_frame *frame, uint64_t *timestamp_ns)
+{
+    struct iovec iov = { .iov_base = frame, .iov_len = sizeof(*frame) };
+    unsigned char control[CAPTURE_CMSG_SIZE];
+    struct msghdr msg;
+
+    (void)memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    const ssize_t nbytes = recvmsg(sock, &msg, 0);
+    if (nbytes < 0)
+    {
+        return SOCKET_ERROR;
+    }
+
+    *timestamp_ns = 0U;
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg))
+    {
+        if ((cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SCM_TIMESTAMPNS))
+        {
+            struct timespec stamp;
+            (void)memcpy(&stamp, CMSG_DATA(cmsg), sizeof(stamp));
+            *timestamp_ns = ((uint64_t)stamp.tv_sec * NSEC_PER_SEC) + (uint64_t)stamp.tv_nsec;
+        }
+    }
+    if (*timestamp_ns == 0U)
+    {
+        *timestamp_ns = realtime_ns();
+    }
+    return (int)nbytes;
+}
+
+static void add_ns(struct timespec *time, uint64_t delta_ns)
+{
+    const uint64_t total = (uint64_t)time->tv_nsec + (delta_ns % NSEC_PER_SEC);
+    time->tv_sec += (time_t)(delta_ns / NSEC_PER_SEC) + (time_t)(total / NSEC_PER_SEC);
+    time->tv_nsec = (long)(total % NSEC_PER_SEC);
+}
+
+size_t can_replay_run(const CanCaptureReader *reader, int sock, double speed,
+                      const volatile sig_atomic_t *stop)
+{
+    struct timespec start;
+    struct can_frame frame;
+    size_t sent = 0U;
+
+    if (reader->count == 0U)
+    {
+        return 0U;
+    }
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &start);
+    const uint64_t first_ns = reader->records[0].timestamp_ns;
+
+    for (size_t i = 0U; i < reader->count; i++)
+    {
+        if ((stop != NULL) && (*stop != 0))
+        {
+            break;
+        }
+
+        const CanCaptureRecord *record = &reader->records[i];
+        if (speed > 0.0)
+        {
+            /* Sleep until an absolute deadline measured from the start, so
+               sleep overshoot does not accumulate over a long capture */
+            const uint64_t offset_ns = (record->timestamp_ns > first_ns) ?
+                                       (record->timestamp_ns - first_ns) : 0U;
+            struct timespec deadline = start;
+            add_ns(&deadline, (uint64_t)((double)offset_ns / speed));
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR)
+            {
+                /* Interrupted by a signal: resume the wait */
+                if ((stop != NULL) && (*stop != 0))
+                {
+                    break;
+                }
+            }
+        }
+
+        can_capture_to_frame(record, &frame);
+        if (send_can_frame(sock, &frame) < 0)
+        {
+            break;
+        }
+        sent++;
+    }
+    return sent;
+}
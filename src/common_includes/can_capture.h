@@ -0,0 +1,82 @@
+#ifndef CAN_CAPTURE_H
+#define CAN_CAPTURE_H
+
+#include <signal.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <linux/can.h>
+
+/*
+ * Binary CAN capture file:
+ *   header  : "SSCANCAP" magic (8) | version u32 | record size u32
+ *   records : CanCaptureRecord, fixed size, host byte order
+ * Frames are stored exactly as seen on the bus (still encrypted).
+ */
+#define CAN_CAPTURE_MAGIC       "SSCANCAP"
+#define CAN_CAPTURE_MAGIC_SIZE  (8U)
+#define CAN_CAPTURE_VERSION     (1U)
+#define CAN_CAPTURE_BUFFER_SIZE (64U * 1024U)   // Writer buffer, flushed when full
+#define CAN_CAPTURE_LINE_SIZE   (96U)           // Enough for one candump -L line
+
+// Replay speed: 0 plays the capture as fast as possible
+#define CAN_REPLAY_MAX_SPEED    (0.0)
+
+typedef struct {
+    char magic[CAN_CAPTURE_MAGIC_SIZE];
+    uint32_t version;
+    uint32_t record_size;
+} CanCaptureHeader;
+
+typedef struct {
+    uint64_t timestamp_ns;      // Kernel receive time (CLOCK_REALTIME)
+    uint32_t can_id;
+    uint8_t dlc;
+    uint8_t reserved[3];
+    uint8_t data[CAN_MAX_DLEN];
+} CanCaptureRecord;
+
+typedef struct {
+    int fd;
+    size_t used;
+    unsigned long records;
+    unsigned char buffer[CAN_CAPTURE_BUFFER_SIZE];
+} CanCaptureWriter;
+
+typedef struct {
+    const unsigned char *map;   // Whole file, mmap'd read-only
+    size_t map_size;
+    const CanCaptureRecord *records;
+    size_t count;
+} CanCaptureReader;
+
+// Writer: create/truncate path and write the header
+bool can_capture_open_writer(CanCaptureWriter *writer, const char *path);
+bool can_capture_write(CanCaptureWriter *writer, const struct can_frame *frame,
+                       uint64_t timestamp_ns);
+bool can_capture_flush(CanCaptureWriter *writer);
+bool can_capture_close_writer(CanCaptureWriter *writer);
+
+// Reader: map a capture file; records are then accessed in place
+bool can_capture_open_reader(CanCaptureReader *reader, const char *path);
+void can_capture_close_reader(CanCaptureReader *reader);
+void can_capture_to_frame(const CanCaptureRecord *record, struct can_frame *frame);
+
+// Format one record as a candump log line: "(sec.usec) iface ID#DATA"
+int can_capture_format_candump(const CanCaptureRecord *record, const char *iface,
+                               char *line, size_t size);
+
+// Receive one frame with its kernel timestamp (falls back to the current time)
+int can_capture_receive(int sock, struct can_frame *frame, uint64_t *timestamp_ns);
+
+// Enable kernel receive timestamps on a socket
+bool can_capture_enable_timestamps(int sock);
+
+/* Send every record to sock, keeping the recorded gaps divided by speed
+   (CAN_REPLAY_MAX_SPEED for no pacing). Stops early once *stop becomes
+   nonzero, so it can be set from a signal handler. Returns the number of
+   frames sent. */
+size_t can_replay_run(const CanCaptureReader *reader, int sock, double speed,
+                      const volatile sig_atomic_t *stop);
+
+#endif // CAN_CAPTURE_H
@@ -6,4 +6,11 @@
 #define CAN_ID_ERROR_DASH    (0x101U)
 #define CAN_ID_ECU_RESTART   (0x7E0U)
 
+// Sender node identifiers carried in every secured message
+#define CAN_NODE_BCM                (0x01U)
+#define CAN_NODE_POWERTRAIN         (0x02U)
+#define CAN_NODE_INSTRUMENT_CLUSTER (0x03U)
+#define CAN_NODE_DASHBOARD          (0x04U)
+#define CAN_NODE_LOADGEN            (0x0FU)
+
 #endif
\ No newline at end of file
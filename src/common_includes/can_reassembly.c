@@ -0,0 +1,171 @@
+#include "can_reassembly.h"
+#include "metrics.h"
+#include <string.h>
+#include <time.h>
+
+#define SEC_TO_MS   (1000LL)
+#define NSEC_TO_MS  (1000000LL)
+
+// Per-reassembler counter plus the ECU-wide reassembly error metric
+static void count_error(unsigned int *counter)
+{
+    (*counter)++;
+    metrics_inc(METRIC_REASSEMBLY_ERRORS);
+}
+
+// Virtual clock of a simulation, CLOCK_MONOTONIC when NULL
+static CanReasmClock reasm_clock = NULL;
+
+void can_reasm_set_clock(CanReasmClock clock)
+{
+    reasm_clock = clock;
+}
+
+long long can_reasm_now_ms(void)
+{
+    struct timespec tss;
+
+    if (reasm_clock != NULL)
+    {
+        return reasm_clock();
+    }
+    clock_gettime(CLOCK_MONOTONIC, &tss);
+    return ((long long)tss.tv_sec * SEC_TO_MS) + (tss.tv_nsec / NSEC_TO_MS);
+}
+
+void can_reasm_reset(CanReassembler *reasm)
+{
+    (void)memset(reasm, 0, sizeof(*reasm));
+}
+
+static unsigned int frag_payload_len(uint8_t index)
+{
+    const unsigned int offset = (unsigned int)index * CAN_FRAG_PAYLOAD_SIZE;
+    const unsigned int left = CAN_MSG_WIRE_SIZE - offset;
+
+    return (left < CAN_FRAG_PAYLOAD_SIZE) ? left : CAN_FRAG_PAYLOAD_SIZE;
+}
+
+void can_frag_build(struct can_frame *frame, canid_t can_id, uint8_t seq,
+                    uint8_t index, const unsigned char *msg)
+{
+    const unsigned int len = frag_payload_len(index);
+
+    (void)memset(frame, 0, sizeof(*frame));
+    frame->can_id = can_id;
+    frame->can_dlc = (uint8_t)(CAN_FRAG_HEADER_SIZE + len);
+    frame->data[0] = (uint8_t)(((seq & CAN_FRAG_SEQ_MASK) << CAN_FRAG_SEQ_SHIFT) |
+                               (index & CAN_FRAG_INDEX_MASK));
+    (void)memcpy(&frame->data[CAN_FRAG_HEADER_SIZE],
+                 msg + ((unsigned int)index * CAN_FRAG_PAYLOAD_SIZE), len);
+}
+
+/* Find the context owning can_id, or claim a free one. When the table is
+   full the least recently used context is recycled. */
+static CanReasmContext *find_context(CanReassembler *reasm, canid_t can_id)
+{
+    CanReasmContext *oldest = &reasm->ctx[0];
+
+    for (unsigned int i = 0; i < CAN_REASM_MAX_CONTEXTS; i++)
+    {
+        CanReasmContext *ctx = &reasm->ctx[i];
+        if (ctx->in_use && ctx->can_id == can_id)
+        {
+            return ctx;
+        }
+    }
+
+    for (unsigned int i = 0; i < CAN_REASM_MAX_CONTEXTS; i++)
+    {
+        CanReasmContext *ctx = &reasm->ctx[i];
+        if (!ctx->in_use)
+        {
+            oldest = ctx;
+            break;
+        }
+        if (ctx->last_ms < oldest->last_ms)
+        {
+            oldest = ctx;
+        }
+    }
+
+    if (oldest->in_use && oldest->active)
+    {
+        count_error(&reasm->stale_drops);
+    }
+    (void)memset(oldest, 0, sizeof(*oldest));
+    oldest->in_use = true;
+    oldest->can_id = can_id;
+    return oldest;
+}
+
+static CanReasmResult drop_fragment(CanReassembler *reasm, CanReasmContext *ctx)
+{
+    ctx->active = false;
+    ctx->next_frag = 0;
+    ctx->filled = 0;
+    count_error(&reasm->sequence_errors);
+    return CAN_REASM_DROPPED;
+}
+
+CanReasmResult can_reasm_push(CanReassembler *reasm, const struct can_frame *frame,
+                              long long now_ms, unsigned char *out)
+{
+    if (frame->can_dlc <= CAN_FRAG_HEADER_SIZE || frame->can_dlc > CAN_FRAG_MAX_DLC)
+    {
+        count_error(&reasm->sequence_errors);
+        return CAN_REASM_DROPPED;
+    }
+
+    const uint8_t seq = (uint8_t)((frame->data[0] >> CAN_FRAG_SEQ_SHIFT) & CAN_FRAG_SEQ_MASK);
+    const uint8_t index = (uint8_t)(frame->data[0] & CAN_FRAG_INDEX_MASK);
+    CanReasmContext *ctx = find_context(reasm, frame->can_id);
+
+    // Drop a half-received message whose sender went quiet
+    if (ctx->active && (now_ms - ctx->last_ms) > CAN_REASM_TIMEOUT_MS)
+    {
+        ctx->active = false;
+        count_error(&reasm->stale_drops);
+    }
+    ctx->last_ms = now_ms;
+
+    if (index == 0U)
+    {
+        if (ctx->active)
+        {
+            // Previous message never completed
+            count_error(&reasm->sequence_errors);
+        }
+        ctx->active = true;
+        ctx->seq = seq;
+        ctx->next_frag = 0;
+        ctx->filled = 0;
+    }
+
+    if (!ctx->active || seq != ctx->seq || index != ctx->next_frag ||
+        index >= CAN_FRAGS_PER_MSG)
+    {
+        return drop_fragment(reasm, ctx);
+    }
+
+    const unsigned int len = frag_payload_len(index);
+    if ((unsigned int)frame->can_dlc != (CAN_FRAG_HEADER_SIZE + len))
+    {
+        return drop_fragment(reasm, ctx);
+    }
+
+    (void)memcpy(&ctx->data[ctx->filled], &frame->data[CAN_FRAG_HEADER_SIZE], len);
+    ctx->filled += len;
+    ctx->next_frag++;
+
+    if (ctx->filled < CAN_MSG_WIRE_SIZE)
+    {
+        return CAN_REASM_PENDING;
+    }
+
+    (void)memcpy(out, ctx->data, CAN_MSG_WIRE_SIZE);
+    ctx->active = false;
+    ctx->next_frag = 0;
+    ctx->filled = 0;
+    return CAN_REASM_COMPLETE;
+}
@@ -0,0 +1,71 @@
+#ifndef CAN_REASSEMBLY_H
+#define CAN_REASSEMBLY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <linux/can.h>
+
+#include "can_socket.h"
+
+/*
+ * Fragment layout (one classic CAN frame):
+ *   data[0]    -> bits 7..4 message sequence counter, bits 3..0 fragment index
+ *   data[1..7] -> up to CAN_FRAG_PAYLOAD_SIZE bytes of the message
+ */
+#define CAN_FRAG_HEADER_SIZE    (1U)
+#define CAN_FRAG_MAX_DLC        (8U)
+#define CAN_FRAG_PAYLOAD_SIZE   (CAN_FRAG_MAX_DLC - CAN_FRAG_HEADER_SIZE)
+#define CAN_FRAG_SEQ_SHIFT      (4U)
+#define CAN_FRAG_SEQ_MASK       (0x0FU)
+#define CAN_FRAG_INDEX_MASK     (0x0FU)
+
+// Size of one message on the wire (one secured block)
+#define CAN_MSG_WIRE_SIZE       (SECURED_MSG_SIZE)
+#define CAN_FRAGS_PER_MSG       ((CAN_MSG_WIRE_SIZE + CAN_FRAG_PAYLOAD_SIZE - 1U) / CAN_FRAG_PAYLOAD_SIZE)
+
+// One context per CAN ID; half-received messages older than this are dropped
+#define CAN_REASM_MAX_CONTEXTS  (8U)
+#define CAN_REASM_TIMEOUT_MS    (200LL)
+
+typedef enum {
+    CAN_REASM_PENDING = 0,  // Fragment stored, message not complete yet
+    CAN_REASM_COMPLETE,     // Message complete and copied to the output buffer
+    CAN_REASM_DROPPED       // Fragment (and any partial message) discarded
+} CanReasmResult;
+
+typedef struct {
+    canid_t can_id;
+    bool in_use;
+    bool active;
+    uint8_t seq;
+    uint8_t next_frag;
+    unsigned int filled;
+    long long last_ms;
+    unsigned char data[CAN_MSG_WIRE_SIZE];
+} CanReasmContext;
+
+typedef struct {
+    CanReasmContext ctx[CAN_REASM_MAX_CONTEXTS];
+    unsigned int stale_drops;       // Partial messages dropped on timeout
+    unsigned int sequence_errors;   // Fragments out of order, wrong size or orphaned
+} CanReassembler;
+
+// Reset every context of a reassembler (a zero-initialized one is also valid)
+void can_reasm_reset(CanReassembler *reasm);
+
+// Feed one received frame; on CAN_REASM_COMPLETE the message is copied to out
+CanReasmResult can_reasm_push(CanReassembler *reasm, const struct can_frame *frame,
+                              long long now_ms, unsigned char *out);
+
+// Build fragment number index of a message with the given sequence counter
+void can_frag_build(struct can_frame *frame, canid_t can_id, uint8_t seq,
+                    uint8_t index, const unsigned char *msg);
+
+// Monotonic time in milliseconds, used for the stale timeout
+long long can_reasm_now_ms(void);
+
+// Take the time from clock instead (a simulation's virtual time), NULL to go back
+typedef long long (*CanReasmClock)(void);
+void can_reasm_set_clock(CanReasmClock clock);
+
+#endif // CAN_REASSEMBLY_H
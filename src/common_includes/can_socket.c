@@ -1,10 +1,22 @@
 #include "can_socket.h"
+#include "can_reassembly.h"
+#include "metrics.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <time.h>
 
 #define OPERATION_SUCCESS    (0)
 #define MAX_INTERFACE_LEN    (IFNAMSIZ - 1U)
 #define CAN_FRAME_SIZE       (sizeof(struct can_frame))
-#define CAN_DLC              (8U)
 #define CAN_MAX_PAD          (16U)
+#define AEAD_SALT_SIZE       (3)
+#define AEAD_FULL_TAG_SIZE   (16)
+#define REPLAY_WINDOW_BITS   (64U)
+#define BYTE_SHIFT_1         (8U)
+#define BYTE_SHIFT_2         (16U)
+#define BYTE_SHIFT_3         (24U)
+#define SEC_TO_MS            (1000ULL)
+#define NSEC_TO_MS           (1000000ULL)
 
 const unsigned char AES_USER_KEY[16] = "0123456789abcdef";
 const unsigned char AES_USER_IV[16] = "abcdef9876543210";  
@@ -70,6 +82,18 @@ void close_can_socket(int sock)
     }
 }
 
+int create_can_loopback_pair(int socks[2])
+{
+    /* SOCK_SEQPACKET keeps frame boundaries, so send_can_frame and
+       receive_can_frame work unchanged on both ends */
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, socks) != 0)
+    {
+        perror("Error creating loopback transport");
+        return SOCKET_ERROR;
+    }
+    return OPERATION_SUCCESS;
+}
+
 int send_can_frame(int sock, const struct can_frame *frame)
 {
     const ssize_t sent_bytes = write(sock, frame, CAN_FRAME_SIZE);
@@ -80,6 +104,7 @@ int send_can_frame(int sock, const struct can_frame *frame)
         return SOCKET_ERROR;
     }
     
+    metrics_inc(METRIC_FRAMES_SENT);
     return OPERATION_SUCCESS;
 }
 
@@ -105,59 +130,252 @@ int receive_can_frame(int sock, struct can_frame *frame)
         return SOCKET_ERROR;
     }
 
+    metrics_inc(METRIC_FRAMES_RECEIVED);
     return OPERATION_SUCCESS;
 }
 
-void encrypt_data(const unsigned char *input, unsigned char *output, int *output_len) 
+int receive_can_frame_nowait(int sock, struct can_frame *frame)
+{
+    ssize_t result;
+
+    do {
+        result = recv(sock, frame, CAN_FRAME_SIZE, MSG_DONTWAIT);
+    } while (result < 0 && errno == EINTR);
+
+    if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return SOCKET_NO_FRAME;
+    }
+    if (result < 0) {
+        fprintf(stderr,
+                "receive_can_frame_nowait: %s\n", strerror(errno));
+        return SOCKET_ERROR;
+    }
+
+    // 0 bytes: the in-process transport was closed by its other end
+    if (result != (ssize_t)CAN_FRAME_SIZE) {
+        return SOCKET_ERROR;
+    }
+
+    metrics_inc(METRIC_FRAMES_RECEIVED);
+    return OPERATION_SUCCESS;
+}
+
+/* Sender identity, counters and replay windows of this process. The
+   freshness counter is seeded from the wall clock so it keeps moving forward
+   across ECU restarts. */
+static CanSecurityContext process_security;
+static pthread_once_t tx_counter_once = PTHREAD_ONCE_INIT;
+static CanSecurityContext *active_security = &process_security;
+static pthread_mutex_t replay_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Cipher contexts keep the expanded key; only the nonce changes per message */
+static __thread EVP_CIPHER_CTX *tls_enc_ctx = NULL;
+static __thread EVP_CIPHER_CTX *tls_dec_ctx = NULL;
+
+void set_can_node_id(uint8_t node_id)
+{
+    process_security.node_id = node_id;
+}
+
+void can_security_init(CanSecurityContext *security, uint8_t node_id, uint32_t first_counter)
+{
+    (void)memset(security, 0, sizeof(*security));
+    security->node_id = node_id;
+    // The counter is incremented before use
+    security->tx_counter = first_counter - 1U;
+}
+
+void can_security_select(CanSecurityContext *security)
+{
+    active_security = (security != NULL) ? security : &process_security;
+}
+
+static void seed_tx_counter(void)
+{
+    struct timespec tss;
+    clock_gettime(CLOCK_REALTIME, &tss);
+    process_security.tx_counter = (uint32_t)(((uint64_t)tss.tv_sec * SEC_TO_MS) + ((uint64_t)tss.tv_nsec / NSEC_TO_MS));
+}
+
+static void put_be32(unsigned char *dst, uint32_t value)
+{
+    dst[0] = (unsigned char)(value >> BYTE_SHIFT_3);
+    dst[1] = (unsigned char)(value >> BYTE_SHIFT_2);
+    dst[2] = (unsigned char)(value >> BYTE_SHIFT_1);
+    dst[3] = (unsigned char)value;
+}
+
+static uint32_t get_be32(const unsigned char *src)
+{
+    return ((uint32_t)src[0] << BYTE_SHIFT_3) | ((uint32_t)src[1] << BYTE_SHIFT_2) |
+           ((uint32_t)src[2] << BYTE_SHIFT_1) | (uint32_t)src[3];
+}
+
+// nonce = salt | node | CAN ID | counter
+static void build_nonce(unsigned char *nonce, uint8_t node, canid_t can_id, uint32_t counter)
+{
+    (void)memcpy(nonce, AES_USER_IV, AEAD_SALT_SIZE);
+    nonce[AEAD_SALT_SIZE] = node;
+    put_be32(&nonce[AEAD_SALT_SIZE + AEAD_NODE_SIZE], (uint32_t)can_id);
+    put_be32(&nonce[AEAD_NONCE_SIZE - AEAD_COUNTER_SIZE], counter);
+}
+
+static EVP_CIPHER_CTX *get_cipher_ctx(EVP_CIPHER_CTX **slot, int encrypt)
 {
-    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+    if (*slot == NULL)
+    {
+        EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+        if (ctx == NULL)
+        {
+            return NULL;
+        }
+        (void)EVP_CipherInit_ex(ctx, EVP_aes_128_gcm(), NULL, NULL, NULL, encrypt);
+        (void)EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_IVLEN, AEAD_NONCE_SIZE, NULL);
+        (void)EVP_CipherInit_ex(ctx, NULL, NULL, AES_USER_KEY, NULL, encrypt);
+        *slot = ctx;
+    }
+    return *slot;
+}
+
+/* Accept a counter once: newer than anything seen, or inside the window
+   and not seen yet. Serial number arithmetic handles wrap-around. */
+static bool replay_accept(CanSecurityContext *security, uint8_t node, uint32_t counter)
+{
+    bool fresh = false;
+
+    pthread_mutex_lock(&replay_mutex);
+    CanReplayWindow *state = &security->replay[node];
+
+    if (!state->seen)
+    {
+        state->seen = true;
+        state->highest = counter;
+        state->window = 1U;
+        fresh = true;
+    }
+    else if ((int32_t)(counter - state->highest) > 0)
+    {
+        const uint32_t ahead = counter - state->highest;
+        state->window = (ahead >= REPLAY_WINDOW_BITS) ? 1U : ((state->window << ahead) | 1U);
+        state->highest = counter;
+        fresh = true;
+    }
+    else
+    {
+        const uint32_t behind = state->highest - counter;
+        if (behind < REPLAY_WINDOW_BITS)
+        {
+            const uint64_t bit = (uint64_t)1U << behind;
+            if ((state->window & bit) == 0U)
+            {
+                state->window |= bit;
+                fresh = true;
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&replay_mutex);
+    return fresh;
+}
+
+/**
+ * @brief Seal one 16-byte block into a secured message for can_id.
+ * @requirement SWR1.4
+ */
+void encrypt_data(const unsigned char *input, unsigned char *output, int *output_len, canid_t can_id) 
+{
+    EVP_CIPHER_CTX *ctx = get_cipher_ctx(&tls_enc_ctx, 1);
+    unsigned char nonce[AEAD_NONCE_SIZE];
+    unsigned char tag[AEAD_FULL_TAG_SIZE];
     int len = 0;
     int ciphertext_len = 0;
 
-    EVP_EncryptInit_ex(ctx, EVP_aes_128_cbc(), NULL, AES_USER_KEY, AES_USER_IV);
-    EVP_CIPHER_CTX_set_padding(ctx, 0);
+    *output_len = 0;
+    if (ctx == NULL)
+    {
+        (void)fprintf(stderr, "Error creating cipher context\n");
+        return;
+    }
 
-    EVP_EncryptUpdate(ctx, output, &len, input, AES_BLOCK_SIZE);
+    CanSecurityContext *security = active_security;
+    if (security == &process_security)
+    {
+        (void)pthread_once(&tx_counter_once, seed_tx_counter);
+    }
+    const uint32_t counter = __atomic_add_fetch(&security->tx_counter, 1U, __ATOMIC_RELAXED);
+
+    output[0] = security->node_id;
+    put_be32(&output[AEAD_NODE_SIZE], counter);
+    build_nonce(nonce, security->node_id, can_id, counter);
+
+    unsigned char *ciphertext = &output[AEAD_FRESHNESS_SIZE];
+    (void)EVP_EncryptInit_ex(ctx, NULL, NULL, NULL, nonce);
+    (void)EVP_EncryptUpdate(ctx, ciphertext, &len, input, AES_BLOCK_SIZE);
     ciphertext_len = len;
 
-    if (!EVP_EncryptFinal_ex(ctx, output + len, &len)) 
+    if (!EVP_EncryptFinal_ex(ctx, ciphertext + len, &len)) 
     {
         (void)fprintf(stderr, "Error in EVP_EncryptFinal_ex\n");
     }
     ciphertext_len += len;
 
-    EVP_CIPHER_CTX_free(ctx);
+    (void)EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, AEAD_FULL_TAG_SIZE, tag);
+    (void)memcpy(ciphertext + ciphertext_len, tag, AEAD_TAG_SIZE);
 
-    *output_len = ciphertext_len;
+    *output_len = AEAD_FRESHNESS_SIZE + ciphertext_len + AEAD_TAG_SIZE;
 }
 
-void decrypt_data(const unsigned char *input, char *output, int input_len) 
+/**
+ * @brief Verify and open a secured message. The plaintext is only written
+ *        when the tag matches and the counter was not seen before.
+ * @requirement SWR1.4
+ */
+int decrypt_data(const unsigned char *input, char *output, int input_len, canid_t can_id) 
 {
-    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+    EVP_CIPHER_CTX *ctx = get_cipher_ctx(&tls_dec_ctx, 0);
+    unsigned char nonce[AEAD_NONCE_SIZE];
+    unsigned char plaintext[AES_BLOCK_SIZE + 1] = {0};
     int len = 0;
-    int plaintext_len = 0;
-    
-    memset(output, 0, AES_BLOCK_SIZE);
 
-    EVP_DecryptInit_ex(ctx, EVP_aes_128_cbc(), NULL, AES_USER_KEY, AES_USER_IV);
-    EVP_CIPHER_CTX_set_padding(ctx, 0);
+    memset(output, 0, AES_BLOCK_SIZE + 1);
 
-    if (!EVP_DecryptUpdate(ctx, (unsigned char*)output, &len, input, input_len)) 
+    if (ctx == NULL || input_len != SECURED_MSG_SIZE)
+    {
+        metrics_inc(METRIC_DECRYPT_FAILURES);
+        return DECRYPT_AUTH_FAILED;
+    }
+
+    const uint8_t node = input[0];
+    const uint32_t counter = get_be32(&input[AEAD_NODE_SIZE]);
+    const unsigned char *ciphertext = &input[AEAD_FRESHNESS_SIZE];
+
+    build_nonce(nonce, node, can_id, counter);
+
+    (void)EVP_DecryptInit_ex(ctx, NULL, NULL, NULL, nonce);
+    if (!EVP_DecryptUpdate(ctx, plaintext, &len, ciphertext, AES_BLOCK_SIZE)) 
     {
         (void)fprintf(stderr, "Error in EVP_DecryptUpdate\n");
+        metrics_inc(METRIC_DECRYPT_FAILURES);
+        return DECRYPT_AUTH_FAILED;
     }
-    plaintext_len = len;
 
-    int ret = EVP_DecryptFinal_ex(ctx, (unsigned char*)output + len, &len);
-    if (ret <= 0) 
+    (void)EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, AEAD_TAG_SIZE,
+                              (void *)(ciphertext + AES_BLOCK_SIZE));
+    if (EVP_DecryptFinal_ex(ctx, plaintext + len, &len) <= 0) 
     {
-        (void)fprintf(stderr, "Error in EVP_DecryptFinal_ex\n");
+        metrics_inc(METRIC_DECRYPT_FAILURES);
+        return DECRYPT_AUTH_FAILED;
     }
 
-    plaintext_len += len;
-    EVP_CIPHER_CTX_free(ctx);
+    if (!replay_accept(active_security, node, counter))
+    {
+        metrics_inc(METRIC_DECRYPT_FAILURES);
+        return DECRYPT_REPLAYED;
+    }
 
-    output[plaintext_len] = '\0';
+    (void)memcpy(output, plaintext, AES_BLOCK_SIZE);
+    output[AES_BLOCK_SIZE] = '\0';
+    return DECRYPT_OK;
 }
 
 /**
@@ -166,28 +384,34 @@ void decrypt_data(const unsigned char *input, char *output, int input_len)
  */
 void send_encrypted_message(int sock, const char *message, int can_id) 
 {
-    struct can_frame frame;
-    unsigned char encrypted_data[AES_BLOCK_SIZE] = {0};
-
     char padded_message[AES_BLOCK_SIZE + CAN_MAX_PAD] = {0};
-    int encrypted_len = 0;
     strncpy(padded_message, message, AES_BLOCK_SIZE);
 
-    encrypt_data((unsigned char*)padded_message, encrypted_data, &encrypted_len);
+    send_encrypted_block(sock, (const unsigned char *)padded_message, can_id);
+}
+
+void send_encrypted_block(int sock, const unsigned char *block, int can_id)
+{
+    struct can_frame frame;
+    unsigned char encrypted_data[SECURED_MSG_SIZE] = {0};
+    int encrypted_len = 0;
 
-    if (encrypted_len != AES_BLOCK_SIZE) 
+    encrypt_data(block, encrypted_data, &encrypted_len, (canid_t)can_id);
+
+    if (encrypted_len != SECURED_MSG_SIZE) 
     {
         printf("Unexpected encrypted data length: %d\n", encrypted_len);
         fflush(stdout);
         return;
     }
 
-    frame.can_id = can_id;
-    frame.can_dlc = CAN_DLC;
-    memcpy(frame.data, encrypted_data, CAN_DLC);
-    send_can_frame(sock, &frame);
+    // Tag every fragment so receivers can reassemble per CAN ID
+    const uint8_t seq = (uint8_t)(__atomic_fetch_add(&active_security->tx_sequence, 1U, __ATOMIC_RELAXED) &
+                                  CAN_FRAG_SEQ_MASK);
 
-    frame.can_dlc = CAN_DLC;
-    memcpy(frame.data, encrypted_data + CAN_DLC, CAN_DLC);
-    send_can_frame(sock, &frame);
+    for (uint8_t index = 0U; index < CAN_FRAGS_PER_MSG; index++)
+    {
+        can_frag_build(&frame, (canid_t)can_id, seq, index, encrypted_data);
+        send_can_frame(sock, &frame);
+    }
 }
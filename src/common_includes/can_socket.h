@@ -3,6 +3,8 @@
 
 #include <openssl/aes.h>
 #include <openssl/evp.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -16,9 +18,49 @@
 #include <errno.h>
 
 #define SOCKET_ERROR         (-1)
+#define SOCKET_NO_FRAME      (1)     // Non-blocking receive: nothing pending
 
 #define AES_BLOCK_SIZE 16
 
+/*
+ * Secured message layout (AES-128-GCM, truncated tag):
+ *   [sender node 1][freshness counter 4][ciphertext 16][tag 4]
+ * The nonce is built from a salt, the node, the CAN ID and the counter,
+ * so a message cannot be replayed or moved to another CAN ID.
+ */
+#define AEAD_NODE_SIZE       (1)
+#define AEAD_COUNTER_SIZE    (4)
+#define AEAD_FRESHNESS_SIZE  (AEAD_NODE_SIZE + AEAD_COUNTER_SIZE)
+#define AEAD_TAG_SIZE        (4)
+#define AEAD_NONCE_SIZE      (12)
+#define SECURED_MSG_SIZE     (AEAD_FRESHNESS_SIZE + AES_BLOCK_SIZE + AEAD_TAG_SIZE)
+
+#define DECRYPT_OK           (0)
+#define DECRYPT_AUTH_FAILED  (-1)
+#define DECRYPT_REPLAYED     (-2)
+
+#define CAN_SECURITY_NODES   (UINT8_MAX + 1)
+
+/* Receiver replay window, one per sender node */
+typedef struct {
+    bool seen;
+    uint32_t highest;
+    uint64_t window;
+} CanReplayWindow;
+
+/*
+ * Sender identity, freshness counter, fragment sequence and replay windows of
+ * one ECU. Every process has its own (set_can_node_id, counter seeded from
+ * the wall clock); a co-simulation hosting several ECUs in one thread gives
+ * each of them a context and selects it before running the ECU's code.
+ */
+typedef struct {
+    uint8_t node_id;
+    uint32_t tx_counter;
+    unsigned int tx_sequence;
+    CanReplayWindow replay[CAN_SECURITY_NODES];
+} CanSecurityContext;
+
 extern const unsigned char AES_USER_KEY[AES_BLOCK_SIZE];
 extern const unsigned char AES_USER_IV[AES_BLOCK_SIZE];
 
@@ -26,14 +68,26 @@ extern const unsigned char AES_USER_IV[AES_BLOCK_SIZE];
 int create_can_socket(const char *interface);
 void close_can_socket(int sock);
 
+// In-process transport: a connected socket pair carrying whole CAN frames
+int create_can_loopback_pair(int socks[2]);
+
 //define function to send one CAN frame
 int send_can_frame(int sock, const struct can_frame *frame);
 
 //define function to receive one CAN frame
 int receive_can_frame(int sock, struct can_frame *frame);
+// Same without blocking: SOCKET_NO_FRAME when no frame is pending
+int receive_can_frame_nowait(int sock, struct can_frame *frame);
 
 //define functions used in data encryption
-void encrypt_data(const unsigned char *input, unsigned char *output, int *output_len);
-void decrypt_data(const unsigned char *input, char *output, int input_len);
+void set_can_node_id(uint8_t node_id);
+// Start a context sending as node_id from first_counter, with no counter seen yet
+void can_security_init(CanSecurityContext *security, uint8_t node_id, uint32_t first_counter);
+// Use security for the next messages sent and received (NULL: the process context)
+void can_security_select(CanSecurityContext *security);
+void encrypt_data(const unsigned char *input, unsigned char *output, int *output_len, canid_t can_id);
+int decrypt_data(const unsigned char *input, char *output, int input_len, canid_t can_id);
 void send_encrypted_message(int sock, const char *message, int can_id);
+// Encrypt and send one raw AES_BLOCK_SIZE block (binary payloads)
+void send_encrypted_block(int sock, const unsigned char *block, int can_id);
 #endif
\ No newline at end of file
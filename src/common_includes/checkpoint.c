@@ -0,0 +1,316 @@
+#include "checkpoint.h"
+#include "atomic_file.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define NSEC_PER_SEC        (1000000000LL)
+#define FNV_PRIME           (0x100000001b3ULL)
+
+uint64_t checkpoint_digest(uint64_t digest, const void *data, size_t size)
+{
+    const unsigned char *bytes = (const unsigned char *)data;
+
+    for (size_t i = 0U; i < size; i++)
+    {
+        digest ^= bytes[i];
+        digest *= FNV_PRIME;
+    }
+    return digest;
+}
+
+bool checkpoint_init(Checkpoint *checkpoint, const char *ecu_name)
+{
+    const char *dir = getenv(CHECKPOINT_DIR_ENV);
+    const char *period = getenv(CHECKPOINT_PERIOD_ENV);
+
+    (void)memset(checkpoint, 0, sizeof(*checkpoint));
+    checkpoint->last_ms = -1;
+    checkpoint->period_ms = CHECKPOINT_DEFAULT_PERIOD_MS;
+    if ((period != NULL) && (atoll(period) > 0))
+    {
+        checkpoint->period_ms = atoll(period);
+    }
+    (void)snprintf(checkpoint->ecu, sizeof(checkpoint->ecu), "%s", ecu_name);
+    if ((dir == NULL) || (dir[0] == '\0'))
+    {
+        return false;
+    }
+    (void)snprintf(checkpoint->path, sizeof(checkpoint->path), "%s/checkpoint_%s.bin", dir, ecu_name);
+    return true;
+}
+
+bool checkpoint_enabled(const Checkpoint *checkpoint)
+{
+    return checkpoint->path[0] != '\0';
+}
+
+bool checkpoint_due(Checkpoint *checkpoint, long long now_ms)
+{
+    if (!checkpoint_enabled(checkpoint))
+    {
+        return false;
+    }
+    if (checkpoint->last_ms < 0)
+    {
+        checkpoint->last_ms = now_ms;
+        return false;
+    }
+    if ((now_ms - checkpoint->last_ms) < checkpoint->period_ms)
+    {
+        return false;
+    }
+    checkpoint->last_ms = now_ms;
+    return true;
+}
+
+// Write one snapshot file; runs on the caller or on the writer thread
+static bool write_file(Checkpoint *checkpoint, uint32_t state_version,
+                       const struct iovec *parts, int count)
+{
+    CheckpointHeader header;
+    struct timespec now;
+
+    (void)memset(&header, 0, sizeof(header));
+    (void)memcpy(header.magic, CHECKPOINT_MAGIC, CHECKPOINT_MAGIC_SIZE);
+    header.version = CHECKPOINT_VERSION;
+    header.state_version = state_version;
+    (void)memcpy(header.ecu, checkpoint->ecu, sizeof(header.ecu));
+    header.sequence = checkpoint->sequence + 1U;
+    (void)clock_gettime(CLOCK_REALTIME, &now);
+    header.time_ns = ((int64_t)now.tv_sec * NSEC_PER_SEC) + now.tv_nsec;
+    header.digest = CHECKPOINT_DIGEST_INIT;
+    for (int i = 0; i < count; i++)
+    {
+        header.state_size += parts[i].iov_len;
+        header.digest = checkpoint_digest(header.digest, parts[i].iov_base, parts[i].iov_len);
+    }
+
+    AtomicFile atomic;
+    FILE *file = atomic_file_open(&atomic, checkpoint->path);
+    if (file == NULL)
+    {
+        perror("Error opening checkpoint file");
+        return false;
+    }
+
+    bool ok = fwrite(&header, sizeof(header), 1U, file) == 1U;
+    for (int i = 0; ok && (i < count); i++)
+    {
+        ok = (parts[i].iov_len == 0U) || (fwrite(parts[i].iov_base, parts[i].iov_len, 1U, file) == 1U);
+    }
+    // A failed fwrite leaves the error flag set: the commit then keeps the
+    // previous snapshot. Synced before it replaces it.
+    if (!atomic_file_commit(&atomic, true))
+    {
+        perror("Error writing checkpoint file");
+        return false;
+    }
+    checkpoint->sequence = header.sequence;
+    return true;
+}
+
+static void *writer_thread(void *arg)
+{
+    Checkpoint *checkpoint = (Checkpoint *)arg;
+
+    (void)pthread_mutex_lock(&checkpoint->mutex);
+    for (;;)
+    {
+        while (!checkpoint->posted && !checkpoint->stopping)
+        {
+            (void)pthread_cond_wait(&checkpoint->cond, &checkpoint->mutex);
+        }
+        if (!checkpoint->posted)
+        {
+            break;      // Stopping with nothing left to write
+        }
+        // The buffer is not touched by the loop while posted is set
+        const struct iovec part = { checkpoint->buffer, checkpoint->buffer_size };
+        const uint32_t state_version = checkpoint->posted_version;
+        (void)pthread_mutex_unlock(&checkpoint->mutex);
+        (void)write_file(checkpoint, state_version, &part, 1);
+        (void)pthread_mutex_lock(&checkpoint->mutex);
+        checkpoint->posted = false;
+    }
+    (void)pthread_mutex_unlock(&checkpoint->mutex);
+    return NULL;
+}
+
+// Copy the parts for the writer thread (mutex held)
+static bool post_locked(Checkpoint *checkpoint, uint32_t state_version,
+                        const struct iovec *parts, int count)
+{
+    size_t size = 0U;
+
+    for (int i = 0; i < count; i++)
+    {
+        size += parts[i].iov_len;
+    }
+    if (size > checkpoint->buffer_capacity)
+    {
+        unsigned char *buffer = (unsigned char *)realloc(checkpoint->buffer, size);
+        if (buffer == NULL)
+        {
+            return false;
+        }
+        checkpoint->buffer = buffer;
+        checkpoint->buffer_capacity = size;
+    }
+    size_t offset = 0U;
+    for (int i = 0; i < count; i++)
+    {
+        (void)memcpy(checkpoint->buffer + offset, parts[i].iov_base, parts[i].iov_len);
+        offset += parts[i].iov_len;
+    }
+    checkpoint->buffer_size = size;
+    checkpoint->posted_version = state_version;
+    checkpoint->posted = true;
+    (void)pthread_cond_signal(&checkpoint->cond);
+    return true;
+}
+
+bool checkpoint_write(Checkpoint *checkpoint, uint32_t state_version,
+                      const struct iovec *parts, int count)
+{
+    if (!checkpoint_enabled(checkpoint))
+    {
+        return false;
+    }
+    if (!checkpoint->writer_running)
+    {
+        return write_file(checkpoint, state_version, parts, count);
+    }
+
+    bool posted = false;
+    (void)pthread_mutex_lock(&checkpoint->mutex);
+    if (checkpoint->posted)
+    {
+        checkpoint->dropped++;
+    }
+    else
+    {
+        posted = post_locked(checkpoint, state_version, parts, count);
+    }
+    (void)pthread_mutex_unlock(&checkpoint->mutex);
+    return posted;
+}
+
+bool checkpoint_start_writer(Checkpoint *checkpoint)
+{
+    if (!checkpoint_enabled(checkpoint))
+    {
+        return false;
+    }
+    if (checkpoint->writer_running)
+    {
+        return true;
+    }
+    checkpoint->posted = false;
+    checkpoint->stopping = false;
+    if (pthread_mutex_init(&checkpoint->mutex, NULL) != 0)
+    {
+        return false;
+    }
+    if (pthread_cond_init(&checkpoint->cond, NULL) != 0)
+    {
+        (void)pthread_mutex_destroy(&checkpoint->mutex);
+        return false;
+    }
+    if (pthread_create(&checkpoint->writer, NULL, writer_thread, checkpoint) != 0)
+    {
+        perror("Error starting the checkpoint writer");
+        (void)pthread_cond_destroy(&checkpoint->cond);
+        (void)pthread_mutex_destroy(&checkpoint->mutex);
+        return false;
+    }
+    checkpoint->writer_running = true;
+    return true;
+}
+
+void checkpoint_stop_writer(Checkpoint *checkpoint)
+{
+    if (!checkpoint->writer_running)
+    {
+        return;
+    }
+    (void)pthread_mutex_lock(&checkpoint->mutex);
+    checkpoint->stopping = true;
+    (void)pthread_cond_signal(&checkpoint->cond);
+    (void)pthread_mutex_unlock(&checkpoint->mutex);
+    (void)pthread_join(checkpoint->writer, NULL);
+    (void)pthread_cond_destroy(&checkpoint->cond);
+    (void)pthread_mutex_destroy(&checkpoint->mutex);
+    checkpoint->writer_running = false;
+    free(checkpoint->buffer);
+    checkpoint->buffer = NULL;
+    checkpoint->buffer_size = 0U;
+    checkpoint->buffer_capacity = 0U;
+}
+
+bool checkpoint_open(Checkpoint *checkpoint, CheckpointSnapshot *snapshot, uint32_t state_version)
+{
+    struct stat info;
+
+    (void)memset(snapshot, 0, sizeof(*snapshot));
+    if (!checkpoint_enabled(checkpoint))
+    {
+        return false;
+    }
+    const int fd = open(checkpoint->path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;   // No snapshot yet: a fresh run
+    }
+    if ((fstat(fd, &info) != 0) || ((size_t)info.st_size < sizeof(CheckpointHeader)))
+    {
+        (void)fprintf(stderr, "Checkpoint file too short: %s\n", checkpoint->path);
+        (void)close(fd);
+        return false;
+    }
+
+    void *map = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    (void)close(fd);
+    if (map == MAP_FAILED)
+    {
+        perror("Error mapping checkpoint file");
+        return false;
+    }
+
+    const CheckpointHeader *header = (const CheckpointHeader *)map;
+    const unsigned char *state = (const unsigned char *)map + sizeof(CheckpointHeader);
+    const size_t state_size = (size_t)info.st_size - sizeof(CheckpointHeader);
+    if ((memcmp(header->magic, CHECKPOINT_MAGIC, CHECKPOINT_MAGIC_SIZE) != 0) ||
+        (header->version != CHECKPOINT_VERSION) ||
+        (header->state_version != state_version) ||
+        (strncmp(header->ecu, checkpoint->ecu, sizeof(header->ecu)) != 0) ||
+        (header->state_size != state_size) ||
+        (header->digest != checkpoint_digest(CHECKPOINT_DIGEST_INIT, state, state_size)))
+    {
+        (void)fprintf(stderr, "Checkpoint %s does not match this ECU, ignored\n", checkpoint->path);
+        (void)munmap(map, (size_t)info.st_size);
+        return false;
+    }
+
+    snapshot->map = (const unsigned char *)map;
+    snapshot->map_size = (size_t)info.st_size;
+    snapshot->header = header;
+    snapshot->state = state;
+    snapshot->state_size = state_size;
+    checkpoint->sequence = header->sequence;
+    return true;
+}
+
+void checkpoint_close(CheckpointSnapshot *snapshot)
+{
+    if (snapshot->map != NULL)
+    {
+        (void)munmap((void *)snapshot->map, snapshot->map_size);
+    }
+    (void)memset(snapshot, 0, sizeof(*snapshot));
+}
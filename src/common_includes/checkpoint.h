@@ -0,0 +1,115 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/uio.h>
+
+/*
+ * Binary state snapshot of one ECU, to resume a long run after a stop or a
+ * crash instead of starting it over.
+ *
+ *   header : "SSCHKPNT" magic (8) | version u32 | state version u32 |
+ *            ECU name (32) | sequence u64 | time ns i64 | state size u64 |
+ *            digest u64
+ *   state  : the ECU's own structures, host byte order
+ *
+ * Checkpoints are opt-in: an ECU writes "<dir>/checkpoint_<name>.bin" only
+ * when the ECU_CHECKPOINT_DIR environment variable is set, every
+ * ECU_CHECKPOINT_MS (CHECKPOINT_DEFAULT_PERIOD_MS by default) and once more
+ * on shutdown. A snapshot goes to a temporary file, synced, then renamed
+ * over the previous one, so a crash mid-write leaves the last complete one.
+ * Once the ECU started the writer thread, the periodic snapshots called from
+ * its timed loops only copy the state into a buffer; the file write, fsync
+ * and rename happen on the writer, so a slow disk never delays a step or a
+ * watchdog deadline. The shutdown snapshot is written in place after the
+ * writer stopped.
+ * On start-up the ECU maps the snapshot and copies its state back; a missing
+ * file, another ECU's snapshot, another state layout or a digest mismatch
+ * (FNV-1a over the state) is refused and the run starts from zero.
+ */
+#define CHECKPOINT_DIR_ENV              "ECU_CHECKPOINT_DIR"
+#define CHECKPOINT_PERIOD_ENV           "ECU_CHECKPOINT_MS"
+#define CHECKPOINT_DEFAULT_PERIOD_MS    (10000LL)
+#define CHECKPOINT_MAGIC                "SSCHKPNT"
+#define CHECKPOINT_MAGIC_SIZE           (8U)
+#define CHECKPOINT_VERSION              (1U)
+#define CHECKPOINT_ECU_SIZE             (32)
+#define CHECKPOINT_PATH_SIZE            (256)
+#define CHECKPOINT_DIGEST_INIT          (0xcbf29ce484222325ULL)
+
+typedef struct {
+    char magic[CHECKPOINT_MAGIC_SIZE];
+    uint32_t version;
+    uint32_t state_version;         // Layout of the state, set by the ECU
+    char ecu[CHECKPOINT_ECU_SIZE];
+    uint64_t sequence;              // Snapshots of this ECU, across restores
+    int64_t time_ns;                // CLOCK_REALTIME of the write
+    uint64_t state_size;
+    uint64_t digest;
+} CheckpointHeader;
+
+typedef struct {
+    char path[CHECKPOINT_PATH_SIZE];    // Empty: checkpoints disabled
+    char ecu[CHECKPOINT_ECU_SIZE];
+    long long period_ms;
+    long long last_ms;                  // Start of the current period, -1 before the first
+    uint64_t sequence;                  // Of the last snapshot written or restored
+    // Writer thread (checkpoint_start_writer)
+    pthread_t writer;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool writer_running;
+    bool stopping;
+    bool posted;                        // A copy waits for, or is in, the writer
+    uint32_t posted_version;
+    unsigned char *buffer;              // The posted copy of the state
+    size_t buffer_size;
+    size_t buffer_capacity;
+    unsigned long dropped;              // Snapshots skipped while the writer was busy
+} Checkpoint;
+
+typedef struct {
+    const unsigned char *map;           // Whole file, mmap'd read-only
+    size_t map_size;
+    const CheckpointHeader *header;
+    const unsigned char *state;
+    size_t state_size;
+} CheckpointSnapshot;
+
+/* Build the snapshot path of ecu_name from ECU_CHECKPOINT_DIR (no writer
+   running); returns false, with checkpoints disabled, if it is not set */
+bool checkpoint_init(Checkpoint *checkpoint, const char *ecu_name);
+
+bool checkpoint_enabled(const Checkpoint *checkpoint);
+
+/* True once per period, from the first call on; the caller then builds its
+   state and writes it. now_ms is monotonic (timer_wheel_now_ms), so a wall
+   clock step neither skips nor bunches snapshots */
+bool checkpoint_due(Checkpoint *checkpoint, long long now_ms);
+
+/* Write the parts, concatenated, as the ECU's state (temporary file, fsync,
+   rename). While the writer thread runs, only copy them for it and return:
+   false if the previous snapshot is still being written (this one is
+   dropped, the next period brings a newer one). */
+bool checkpoint_write(Checkpoint *checkpoint, uint32_t state_version,
+                      const struct iovec *parts, int count);
+
+/* Hand the periodic writes to a thread of their own; false if checkpoints
+   are disabled or the thread could not start (writes stay in place) */
+bool checkpoint_start_writer(Checkpoint *checkpoint);
+
+// Finish the snapshot the writer holds and stop it; later writes are in place
+void checkpoint_stop_writer(Checkpoint *checkpoint);
+
+/* Map the ECU's snapshot and check it; the sequence continues from it.
+   Returns false if there is none or it does not fit this state version. */
+bool checkpoint_open(Checkpoint *checkpoint, CheckpointSnapshot *snapshot, uint32_t state_version);
+void checkpoint_close(CheckpointSnapshot *snapshot);
+
+// FNV-1a 64 of data, continuing from digest (CHECKPOINT_DIGEST_INIT to start)
+uint64_t checkpoint_digest(uint64_t digest, const void *data, size_t size);
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,422 @@
+#include "coro.h"
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+
+#define NSEC_PER_MS         (1000000LL)
+#define MS_PER_SEC          (1000LL)
+#define CORO_MAX_EVENTS     (16)
+
+static void enqueue_ready(Coro *co)
+{
+    CoroScheduler *sched = co->sched;
+
+    co->state = CORO_READY;
+    co->next = NULL;
+    if (sched->ready_tail == NULL)
+    {
+        sched->ready_head = co;
+    }
+    else
+    {
+        sched->ready_tail->next = co;
+    }
+    sched->ready_tail = co;
+}
+
+static void leave_event(Coro *co)
+{
+    CoroEvent *event = co->event;
+    Coro *prev = NULL;
+
+    if (event == NULL)
+    {
+        return;
+    }
+    for (Coro *waiter = event->head; waiter != NULL; waiter = waiter->next)
+    {
+        if (waiter == co)
+        {
+            if (prev == NULL)
+            {
+                event->head = co->next;
+            }
+            else
+            {
+                prev->next = co->next;
+            }
+            if (event->tail == co)
+            {
+                event->tail = prev;
+            }
+            break;
+        }
+        prev = waiter;
+    }
+    co->event = NULL;
+    co->next = NULL;
+}
+
+static void forget_fd(Coro *co)
+{
+    if ((co->fd >= 0) && (co->sched->epoll_fd >= 0))
+    {
+        (void)epoll_ctl(co->sched->epoll_fd, EPOLL_CTL_DEL, co->fd, NULL);
+    }
+    co->fd = -1;
+}
+
+// Sleep over, or a wait timed out
+static void wake_on_timer(TimerEntry *timer, long long due_ms)
+{
+    Coro *co = (Coro *)timer->arg;
+
+    (void)due_ms;
+    if (co->state == CORO_WAITING)
+    {
+        co->timed_out = true;
+        leave_event(co);
+        // The registration is still armed: drop it so it cannot wake a later wait
+        forget_fd(co);
+        enqueue_ready(co);
+    }
+    else if (co->state == CORO_SLEEPING)
+    {
+        enqueue_ready(co);
+    }
+    else
+    {
+        // Already woken by its descriptor or event in the same pass
+    }
+}
+
+static void start_timeout(Coro *co, long long timeout_ms)
+{
+    if (timeout_ms >= 0)
+    {
+        (void)timer_wheel_add(&co->sched->wheel, &co->timer, co->sched->now_ms, timeout_ms, 0,
+                              wake_on_timer, co);
+    }
+}
+
+void coro_ready(Coro *co)
+{
+    if ((co->state != CORO_READY) && (co->state != CORO_DONE))
+    {
+        timer_wheel_cancel(&co->sched->wheel, &co->timer);
+        enqueue_ready(co);
+    }
+}
+
+void coro_sleep_until(Coro *co, long long due_ms)
+{
+    const long long delay_ms = due_ms - co->sched->now_ms;
+
+    co->state = CORO_SLEEPING;
+    (void)timer_wheel_add(&co->sched->wheel, &co->timer, co->sched->now_ms,
+                          (delay_ms > 0) ? delay_ms : 0, 0, wake_on_timer, co);
+}
+
+static bool register_fd(Coro *co, int fd)
+{
+    struct epoll_event event;
+    const int epoll_fd = co->sched->epoll_fd;
+
+    (void)memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN | EPOLLONESHOT;
+    event.data.ptr = co;
+    if (co->fd == fd)
+    {
+        // Still registered from the last wait, disarmed by EPOLLONESHOT
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &event) == 0)
+        {
+            return true;
+        }
+        if (errno != ENOENT)
+        {
+            return false;
+        }
+    }
+    else
+    {
+        forget_fd(co);
+    }
+    co->fd = -1;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0)
+    {
+        return false;
+    }
+    co->fd = fd;
+    return true;
+}
+
+void coro_wait_readable(Coro *co, int fd, long long timeout_ms)
+{
+    co->timed_out = false;
+    if ((co->sched->epoll_fd < 0) || (fd < 0) || !register_fd(co, fd))
+    {
+        // Nothing can report readiness: resume at once, as after a timeout
+        co->timed_out = true;
+        enqueue_ready(co);
+        return;
+    }
+    co->state = CORO_WAITING;
+    start_timeout(co, timeout_ms);
+}
+
+void coro_wait_event(Coro *co, CoroEvent *event, long long timeout_ms)
+{
+    co->timed_out = false;
+    co->state = CORO_WAITING;
+    co->event = event;
+    co->next = NULL;
+    if (event->tail == NULL)
+    {
+        event->head = co;
+    }
+    else
+    {
+        event->tail->next = co;
+    }
+    event->tail = co;
+    start_timeout(co, timeout_ms);
+}
+
+void coro_exit(Coro *co)
+{
+    if (co->state == CORO_DONE)
+    {
+        return;
+    }
+    timer_wheel_cancel(&co->sched->wheel, &co->timer);
+    leave_event(co);
+    forget_fd(co);
+    co->state = CORO_DONE;
+    co->sched->live--;
+}
+
+void coro_event_init(CoroEvent *event)
+{
+    event->head = NULL;
+    event->tail = NULL;
+}
+
+unsigned int coro_event_signal(CoroEvent *event)
+{
+    unsigned int woken = 0U;
+    Coro *co = event->head;
+
+    event->head = NULL;
+    event->tail = NULL;
+    while (co != NULL)
+    {
+        Coro *next = co->next;
+        timer_wheel_cancel(&co->sched->wheel, &co->timer);
+        co->event = NULL;
+        enqueue_ready(co);
+        woken++;
+        co = next;
+    }
+    return woken;
+}
+
+bool coro_spawn(CoroScheduler *sched, Coro *co, const char *name, CoroFn fn, void *arg)
+{
+    if (fn == NULL)
+    {
+        return false;
+    }
+    (void)memset(co, 0, sizeof(*co));
+    co->name = name;
+    co->fn = fn;
+    co->arg = arg;
+    co->sched = sched;
+    co->fd = -1;
+    sched->live++;
+    enqueue_ready(co);
+    return true;
+}
+
+// Resume the coroutines ready now; those they make ready wait for the next pass
+static size_t run_ready(CoroScheduler *sched)
+{
+    Coro *co = sched->ready_head;
+    size_t resumed = 0U;
+
+    sched->ready_head = NULL;
+    sched->ready_tail = NULL;
+    while (co != NULL)
+    {
+        Coro *next = co->next;
+
+        co->next = NULL;
+        co->state = CORO_RUNNING;
+        co->resumes++;
+        sched->switches++;
+        co->fn(co);
+        if (co->state == CORO_RUNNING)
+        {
+            coro_exit(co);  // Returned without a suspension point
+        }
+        resumed++;
+        co = next;
+    }
+    return resumed;
+}
+
+size_t coro_sched_advance(CoroScheduler *sched, long long now_ms)
+{
+    size_t resumed = 0U;
+
+    if (now_ms > sched->now_ms)
+    {
+        sched->now_ms = now_ms;
+    }
+    for (;;)
+    {
+        (void)timer_wheel_advance(&sched->wheel, sched->now_ms);
+        if (sched->ready_head == NULL)
+        {
+            break;
+        }
+        resumed += run_ready(sched);
+    }
+    return resumed;
+}
+
+long long coro_sched_run_virtual(CoroScheduler *sched, long long end_ms)
+{
+    (void)coro_sched_advance(sched, sched->now_ms);
+    for (;;)
+    {
+        const long long next_ms = timer_wheel_next_expiry(&sched->wheel);
+        if ((next_ms < 0) || ((end_ms != CORO_NO_TIMEOUT) && (next_ms > end_ms)))
+        {
+            break;
+        }
+        (void)coro_sched_advance(sched, next_ms);
+    }
+    if (end_ms != CORO_NO_TIMEOUT)
+    {
+        (void)coro_sched_advance(sched, end_ms);
+    }
+    return sched->now_ms;
+}
+
+void coro_sched_init_virtual(CoroScheduler *sched, long long tick_ms, long long now_ms)
+{
+    (void)memset(sched, 0, sizeof(*sched));
+    timer_wheel_init(&sched->wheel, tick_ms, now_ms);
+    sched->now_ms = now_ms;
+    sched->epoll_fd = -1;
+    sched->timer_fd = -1;
+}
+
+bool coro_sched_init(CoroScheduler *sched, long long tick_ms)
+{
+    struct epoll_event event;
+
+    coro_sched_init_virtual(sched, tick_ms, timer_wheel_now_ms());
+    sched->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    sched->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+
+    (void)memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.ptr = sched;
+    if ((sched->timer_fd < 0) || (sched->epoll_fd < 0) ||
+        (epoll_ctl(sched->epoll_fd, EPOLL_CTL_ADD, sched->timer_fd, &event) != 0))
+    {
+        perror("Error setting up the coroutine scheduler");
+        coro_sched_close(sched);
+        return false;
+    }
+    return true;
+}
+
+static bool arm_timer_fd(const CoroScheduler *sched)
+{
+    struct itimerspec spec;
+    const long long next_ms = timer_wheel_next_expiry(&sched->wheel);
+
+    (void)memset(&spec, 0, sizeof(spec));
+    if (next_ms >= 0)
+    {
+        spec.it_value.tv_sec = (time_t)(next_ms / MS_PER_SEC);
+        spec.it_value.tv_nsec = (long)((next_ms % MS_PER_SEC) * NSEC_PER_MS);
+        if ((spec.it_value.tv_sec == 0) && (spec.it_value.tv_nsec == 0))
+        {
+            spec.it_value.tv_nsec = 1;  // An all-zero value would disarm the timer
+        }
+    }
+    return timerfd_settime(sched->timer_fd, TFD_TIMER_ABSTIME, &spec, NULL) == 0;
+}
+
+bool coro_sched_poll(CoroScheduler *sched, int timeout_ms)
+{
+    struct epoll_event events[CORO_MAX_EVENTS];
+
+    (void)coro_sched_advance(sched, timer_wheel_now_ms());
+    if (!arm_timer_fd(sched))
+    {
+        return false;
+    }
+
+    const int count = epoll_wait(sched->epoll_fd, events, CORO_MAX_EVENTS, timeout_ms);
+    if (count < 0)
+    {
+        return errno == EINTR;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        Coro *co = (Coro *)events[i].data.ptr;
+        if (events[i].data.ptr == (void *)sched)
+        {
+            uint64_t expirations = 0U;
+            (void)read(sched->timer_fd, &expirations, sizeof(expirations));
+        }
+        else if ((co->state == CORO_WAITING) && (co->fd >= 0) && (co->event == NULL))
+        {
+            // Readable, or hung up: the coroutine finds out when it reads
+            timer_wheel_cancel(&sched->wheel, &co->timer);
+            enqueue_ready(co);
+        }
+        else
+        {
+            // Stale event for a wait that already timed out in this batch
+        }
+    }
+    (void)coro_sched_advance(sched, timer_wheel_now_ms());
+    return true;
+}
+
+void coro_sched_run(CoroScheduler *sched, const volatile bool *stop)
+{
+    while (((stop == NULL) || !*stop) && (sched->live > 0U))
+    {
+        if (!coro_sched_poll(sched, -1))
+        {
+            perror("Coroutine scheduler");
+            break;
+        }
+    }
+}
+
+void coro_sched_close(CoroScheduler *sched)
+{
+    if (sched->epoll_fd >= 0)
+    {
+        (void)close(sched->epoll_fd);
+        sched->epoll_fd = -1;
+    }
+    if (sched->timer_fd >= 0)
+    {
+        (void)close(sched->timer_fd);
+        sched->timer_fd = -1;
+    }
+}
@@ -0,0 +1,128 @@
+#ifndef CORO_H
+#define CORO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "timer_wheel.h"
+
+/*
+ * Stackless coroutines multiplexed on one thread.
+ *
+ * A coroutine is a function resumed where it last waited: CORO_BEGIN and
+ * CORO_END wrap its body, and each CORO_YIELD, CORO_SLEEP*, CORO_WAIT_*
+ * records the resume point (a switch on the line number) and returns to the
+ * scheduler. There is no stack per coroutine, so thousands of them cost a
+ * Coro each. Locals do not survive a wait: what must lives in the structure
+ * passed as arg. A wait cannot sit inside a switch of the coroutine body, and
+ * two waits cannot share a line.
+ *
+ * Ready coroutines run in the order they became ready. Sleeps and wait
+ * timeouts are timers on a timer wheel, descriptor waits are one-shot epoll
+ * registrations. In real time a timerfd armed for the earliest timer is in
+ * the same epoll set, so one epoll_wait covers both. In virtual time there is
+ * no epoll: the caller moves the clock, or coro_sched_run_virtual jumps from
+ * one timer to the next.
+ */
+#define CORO_NO_TIMEOUT     (-1LL)
+
+typedef enum {
+    CORO_READY = 0,
+    CORO_RUNNING,
+    CORO_SLEEPING,
+    CORO_WAITING,       // For a descriptor or an event
+    CORO_DONE
+} CoroState;
+
+struct Coro;
+struct CoroEvent;
+struct CoroScheduler;
+
+typedef void (*CoroFn)(struct Coro *co);
+
+typedef struct Coro {
+    const char *name;
+    CoroFn fn;
+    void *arg;
+    struct CoroScheduler *sched;
+    int resume;                 // Line to resume at, 0 to start
+    CoroState state;
+    bool timed_out;             // The last wait ended without its descriptor or event
+    int fd;                     // Descriptor registered with epoll, -1 if none
+    TimerEntry timer;           // Sleeps and wait timeouts
+    struct CoroEvent *event;    // Event waited for, NULL if none
+    struct Coro *next;          // Ready queue or event wait list
+    unsigned long resumes;
+} Coro;
+
+// Coroutines waiting for a condition another coroutine signals
+typedef struct CoroEvent {
+    Coro *head;
+    Coro *tail;
+} CoroEvent;
+
+typedef struct CoroScheduler {
+    TimerWheel wheel;
+    long long now_ms;
+    Coro *ready_head;
+    Coro *ready_tail;
+    int epoll_fd;               // -1 in virtual time
+    int timer_fd;
+    unsigned int live;          // Spawned and not done
+    unsigned long switches;     // Resumes, all coroutines together
+} CoroScheduler;
+
+#define CORO_BEGIN(co)      switch ((co)->resume) { case 0:
+#define CORO_END(co)        } coro_exit(co); return
+
+// Suspend with call, which decides when the coroutine is ready again
+#define CORO_SUSPEND_(co, call) \
+    do { (co)->resume = __LINE__; call; return; case __LINE__:; } while (0)
+
+// Let the other ready coroutines run first
+#define CORO_YIELD(co)                      CORO_SUSPEND_(co, coro_ready(co))
+#define CORO_SLEEP(co, delay_ms)            CORO_SUSPEND_(co, coro_sleep_until(co, (co)->sched->now_ms + (delay_ms)))
+#define CORO_SLEEP_UNTIL(co, due_ms)        CORO_SUSPEND_(co, coro_sleep_until(co, due_ms))
+#define CORO_WAIT_READABLE(co, fd, timeout_ms) CORO_SUSPEND_(co, coro_wait_readable(co, fd, timeout_ms))
+#define CORO_WAIT_EVENT(co, event, timeout_ms) CORO_SUSPEND_(co, coro_wait_event(co, event, timeout_ms))
+#define CORO_EXIT(co)       do { coro_exit(co); return; } while (0)
+
+// Real time: epoll and a timerfd, clock timer_wheel_now_ms
+bool coro_sched_init(CoroScheduler *sched, long long tick_ms);
+// Virtual time from now_ms: timers only, the caller moves the clock
+void coro_sched_init_virtual(CoroScheduler *sched, long long tick_ms, long long now_ms);
+
+// Start fn(co) on the next pass; co must stay valid until it is done
+bool coro_spawn(CoroScheduler *sched, Coro *co, const char *name, CoroFn fn, void *arg);
+
+// Suspension points (through the CORO_* macros)
+void coro_ready(Coro *co);
+void coro_sleep_until(Coro *co, long long due_ms);
+/* Resume once fd is readable (or hung up) or after timeout_ms. One coroutine
+   waits on a descriptor at a time; real time only. */
+void coro_wait_readable(Coro *co, int fd, long long timeout_ms);
+void coro_wait_event(Coro *co, CoroEvent *event, long long timeout_ms);
+void coro_exit(Coro *co);
+
+void coro_event_init(CoroEvent *event);
+// Make every coroutine waiting for event ready; returns how many
+unsigned int coro_event_signal(CoroEvent *event);
+
+/* Fire the timers due up to now_ms and run the ready coroutines until none
+   is left at that time; returns the resumes */
+size_t coro_sched_advance(CoroScheduler *sched, long long now_ms);
+
+/* Virtual time: jump from timer to timer until end_ms (CORO_NO_TIMEOUT: until
+   no timer is left); returns the time reached */
+long long coro_sched_run_virtual(CoroScheduler *sched, long long end_ms);
+
+/* Real time: one pass, waiting up to timeout_ms (-1: until the next timer)
+   for a descriptor or a timer. Returns false on an unrecoverable error. */
+bool coro_sched_poll(CoroScheduler *sched, int timeout_ms);
+
+// Real time: run until *stop is set (NULL: never), no coroutine is left or an error occurs
+void coro_sched_run(CoroScheduler *sched, const volatile bool *stop);
+
+void coro_sched_close(CoroScheduler *sched);
+
+#endif // CORO_H
@@ -0,0 +1,550 @@
+#include "drive_cycle.h"
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define BASE_LINE_SIZE          (256)
+#define BASE_INITIAL_ROWS       (2048U)
+
+// Default parameters (gen_simu.py)
+#define DEFAULT_SEED            (1U)
+#define DEFAULT_INTERNAL_MIN    (20)
+#define DEFAULT_INTERNAL_MAX    (25)
+#define DEFAULT_EXTERNAL_MIN    (26)
+#define DEFAULT_EXTERNAL_MAX    (31)
+#define DEFAULT_CHANGE_PROB     (0.01)
+#define DEFAULT_DOOR_PROB       (0.1)
+#define DEFAULT_TILT_CHANGE     (1.0)
+
+// Temperature and tilt models
+#define INTERNAL_STEP           (0.5)       // Largest internal temperature change
+#define EXTERNAL_NOISE          (1.0)       // External temperature noise around the daily curve
+#define EXTERNAL_DAILY_SWING    (2.0)
+#define SECONDS_PER_DAY         (86400.0)
+#define TILT_MIN                (0.0)
+#define TILT_MAX                (10.0)
+#define ENGINE_WARM_START       (70.0)      // First row when the cycle starts moving
+#define ENGINE_TARGET           (90.0)
+#define ENGINE_SLOW_SPEED       (30.0)      // Slow traffic heats more
+#define ENGINE_SLOW_OFFSET      (2.5)
+#define ENGINE_FAST_SPEED       (100.0)     // High speed cools a bit
+#define ENGINE_FAST_OFFSET      (-1.5)
+#define ENGINE_GAIN             (0.1)
+#define ENGINE_NOISE            (2.5)       // Only while moving
+#define ENGINE_HOT              (105.0)
+#define ENGINE_COOL_PROB        (0.3)
+#define ENGINE_COOL_MIN         (2.0)
+#define ENGINE_COOL_MAX         (5.0)
+#define ENGINE_MAX              (110.0)
+#define ENGINE_BELOW_AMBIENT    (5.0)
+
+// One independent stream per random decision of a row
+typedef enum {
+    CH_INTERNAL_INIT = 0,
+    CH_EXTERNAL_INIT,
+    CH_INTERNAL_CHANGE,
+    CH_INTERNAL_STEP,
+    CH_EXTERNAL_CHANGE,
+    CH_EXTERNAL_STEP,
+    CH_DOOR,
+    CH_TILT,
+    CH_ENGINE_NOISE,
+    CH_ENGINE_COOL,
+    CH_ENGINE_COOL_STEP
+} CycleChannel;
+
+static double uniform_range(uint64_t key, uint32_t row, unsigned int channel, double low, double high)
+{
+    return low + ((high - low) * drive_cycle_uniform(key, row, channel));
+}
+
+static double clip(double value, double low, double high)
+{
+    return (value < low) ? low : ((value > high) ? high : value);
+}
+
+static double round_tenth(double value)
+{
+    return nearbyint(value * 10.0) / 10.0;
+}
+
+void drive_cycle_default_params(DriveCycleParams *params)
+{
+    params->seed = DEFAULT_SEED;
+    params->internal_min = DEFAULT_INTERNAL_MIN;
+    params->internal_max = DEFAULT_INTERNAL_MAX;
+    params->external_min = DEFAULT_EXTERNAL_MIN;
+    params->external_max = DEFAULT_EXTERNAL_MAX;
+    params->change_probability = DEFAULT_CHANGE_PROB;
+    params->door_probability = DEFAULT_DOOR_PROB;
+    params->max_tilt_change = DEFAULT_TILT_CHANGE;
+    params->speed_scale = 1.0;
+}
+
+/* -----------------------------------------------------------------------------
+ * Base trace
+ * ---------------------------------------------------------------------------*/
+// Second column of "12,34.5", "12,\"34,5\"" or "12,34.5,..."
+static double parse_speed(const char *field)
+{
+    char number[BASE_LINE_SIZE];
+    size_t len = 0U;
+    const bool quoted = (*field == '"');
+
+    if (quoted)
+    {
+        field++;
+    }
+    while ((*field != '\0') && (*field != '\r') && (*field != '\n') && (len < (sizeof(number) - 1U)))
+    {
+        if ((quoted && (*field == '"')) || (!quoted && (*field == ',')))
+        {
+            break;
+        }
+        number[len++] = (*field == ',') ? '.' : *field;
+        field++;
+    }
+    number[len] = '\0';
+    return strtod(number, NULL);
+}
+
+static bool grow_base(DriveCycleBase *base, size_t *capacity)
+{
+    const size_t size = (*capacity == 0U) ? BASE_INITIAL_ROWS : (*capacity * 2U);
+    int32_t *time = (int32_t *)realloc(base->time, size * sizeof(*time));
+    if (time == NULL)
+    {
+        return false;
+    }
+    base->time = time;
+    double *speed = (double *)realloc(base->speed, size * sizeof(*speed));
+    if (speed == NULL)
+    {
+        return false;
+    }
+    base->speed = speed;
+    *capacity = size;
+    return true;
+}
+
+bool drive_cycle_load_base(DriveCycleBase *base, const char *path)
+{
+    char line[BASE_LINE_SIZE];
+    size_t capacity = 0U;
+    bool ok = true;
+
+    (void)memset(base, 0, sizeof(*base));
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        perror("Error opening base trace");
+        return false;
+    }
+
+    // Skip the column line (may start with a UTF-8 BOM)
+    if (fgets(line, sizeof(line), file) == NULL)
+    {
+        ok = false;
+    }
+    while (ok && (fgets(line, sizeof(line), file) != NULL))
+    {
+        const char *field = line;
+        char *end = NULL;
+        const long time = strtol(field, &end, 10);
+        if ((end == field) || (*end != ','))
+        {
+            continue;   // Blank or malformed line
+        }
+        if ((base->rows == capacity) && !grow_base(base, &capacity))
+        {
+            ok = false;
+            break;
+        }
+        base->time[base->rows] = (int32_t)time;
+        base->speed[base->rows] = parse_speed(end + 1);
+        base->rows++;
+    }
+    (void)fclose(file);
+
+    if (!ok || (base->rows == 0U))
+    {
+        (void)fprintf(stderr, "No speed trace in %s\n", path);
+        drive_cycle_free_base(base);
+        return false;
+    }
+    return true;
+}
+
+void drive_cycle_free_base(DriveCycleBase *base)
+{
+    free(base->time);
+    free(base->speed);
+    (void)memset(base, 0, sizeof(*base));
+}
+
+/* -----------------------------------------------------------------------------
+ * Synthesis (same models as gen_simu.py)
+ * ---------------------------------------------------------------------------*/
+static double engine_temp(uint64_t key, uint32_t row, double speed, double ambient, double previous)
+{
+    double target = ENGINE_TARGET;
+
+    if (speed < ENGINE_SLOW_SPEED)
+    {
+        target += ENGINE_SLOW_OFFSET;
+    }
+    else if (speed > ENGINE_FAST_SPEED)
+    {
+        target += ENGINE_FAST_OFFSET;
+    }
+    else
+    {
+        // Cruising: no offset
+    }
+
+    double change = (target - previous) * ENGINE_GAIN;
+    if (speed > 0.0)
+    {
+        change += uniform_range(key, row, CH_ENGINE_NOISE, -ENGINE_NOISE, ENGINE_NOISE);
+    }
+    double temp = previous + change;
+
+    // Occasional overheating, with a chance of faster cooling
+    if ((temp > ENGINE_HOT) && (drive_cycle_uniform(key, row, CH_ENGINE_COOL) < ENGINE_COOL_PROB))
+    {
+        temp -= uniform_range(key, row, CH_ENGINE_COOL_STEP, ENGINE_COOL_MIN, ENGINE_COOL_MAX);
+    }
+    return round_tenth(clip(temp, ambient - ENGINE_BELOW_AMBIENT, ENGINE_MAX));
+}
+
+void drive_cycle_synthesize(const DriveCycleBase *base, const DriveCycleParams *params,
+                            uint32_t cycle, DriveCycleRow *rows)
+{
+    const uint64_t key = drive_cycle_key(params->seed, cycle);
+    const double internal_min = (double)params->internal_min;
+    const double internal_max = (double)params->internal_max;
+    const double external_min = (double)params->external_min;
+    const double external_max = (double)params->external_max;
+    const double external_mid = (double)((params->external_min + params->external_max) / 2);
+
+    // Integer start values, upper bound excluded (numpy randint)
+    double internal = floor(uniform_range(key, 0U, CH_INTERNAL_INIT, internal_min, internal_max));
+    double external = floor(uniform_range(key, 0U, CH_EXTERNAL_INIT, external_min, external_max));
+    double tilt = 0.0;
+    double engine = 0.0;
+
+    for (size_t i = 0U; i < base->rows; i++)
+    {
+        const uint32_t row = (uint32_t)i;
+        const double speed = round_tenth(base->speed[i] * params->speed_scale);
+        const double previous_external = nearbyint(external);
+        DriveCycleRow *out = &rows[i];
+
+        if (drive_cycle_uniform(key, row, CH_INTERNAL_CHANGE) < params->change_probability)
+        {
+            internal += uniform_range(key, row, CH_INTERNAL_STEP, -INTERNAL_STEP, INTERNAL_STEP);
+            internal = clip(internal, internal_min, internal_max);
+        }
+        if (drive_cycle_uniform(key, row, CH_EXTERNAL_CHANGE) < params->change_probability)
+        {
+            const double daily = EXTERNAL_DAILY_SWING *
+                                 sin((2.0 * M_PI * (double)base->time[i]) / SECONDS_PER_DAY);
+            external = external_mid + daily +
+                       uniform_range(key, row, CH_EXTERNAL_STEP, -EXTERNAL_NOISE, EXTERNAL_NOISE);
+            external = clip(external, external_min, external_max);
+        }
+
+        if (i == 0U)
+        {
+            // A cycle starting on the move has a warm engine
+            engine = (speed == 0.0) ? nearbyint(external) : ENGINE_WARM_START;
+        }
+        else
+        {
+            engine = engine_temp(key, row, speed, previous_external, engine);
+            // Tilt only changes while moving and holds its last value when stopped
+            if (speed > 0.0)
+            {
+                tilt += uniform_range(key, row, CH_TILT, -params->max_tilt_change, params->max_tilt_change);
+                tilt = round_tenth(clip(tilt, TILT_MIN, TILT_MAX));
+            }
+        }
+
+        out->time = base->time[i];
+        out->speed = (float)speed;
+        out->tilt_angle = (float)tilt;
+        out->engi_temp = (float)engine;
+        out->internal_temp = (int8_t)nearbyint(internal);
+        out->external_temp = (int8_t)nearbyint(external);
+        out->door_open = ((speed == 0.0) &&
+                          (drive_cycle_uniform(key, row, CH_DOOR) < params->door_probability)) ? 1U : 0U;
+        out->reserved = 0U;
+    }
+}
+
+/* -----------------------------------------------------------------------------
+ * CSV formatting (no printf: this is the generator's hot path)
+ * ---------------------------------------------------------------------------*/
+static size_t put_uint(char *out, unsigned long value)
+{
+    char digits[24];
+    size_t count = 0U;
+
+    do
+    {
+        digits[count++] = (char)('0' + (value % 10UL));
+        value /= 10UL;
+    } while (value > 0UL);
+
+    for (size_t i = 0U; i < count; i++)
+    {
+        out[i] = digits[count - 1U - i];
+    }
+    return count;
+}
+
+static size_t put_int(char *out, long value)
+{
+    size_t len = 0U;
+
+    if (value < 0L)
+    {
+        out[len++] = '-';
+        return len + put_uint(&out[len], (unsigned long)(-value));
+    }
+    return put_uint(out, (unsigned long)value);
+}
+
+// One decimal, as pandas writes the rounded columns ("4.8", "90.0")
+static size_t put_tenths(char *out, float value)
+{
+    const long tenths = lrintf(value * 10.0F);
+    const unsigned long magnitude = (unsigned long)((tenths < 0L) ? -tenths : tenths);
+    size_t len = 0U;
+
+    if (tenths < 0L)
+    {
+        out[len++] = '-';
+    }
+    len += put_uint(&out[len], magnitude / 10UL);
+    out[len++] = '.';
+    out[len++] = (char)('0' + (magnitude % 10UL));
+    return len;
+}
+
+size_t drive_cycle_format_csv(const DriveCycleRow *row, char *line)
+{
+    size_t len = put_int(line, (long)row->time);
+    line[len++] = ',';
+    len += put_tenths(&line[len], row->speed);
+    line[len++] = ',';
+    len += put_tenths(&line[len], row->tilt_angle);
+    line[len++] = ',';
+    len += put_int(&line[len], (long)row->internal_temp);
+    line[len++] = ',';
+    len += put_int(&line[len], (long)row->external_temp);
+    line[len++] = ',';
+    len += put_uint(&line[len], (unsigned long)row->door_open);
+    line[len++] = ',';
+    len += put_tenths(&line[len], row->engi_temp);
+    line[len++] = '\n';
+    return len;
+}
+
+/* -----------------------------------------------------------------------------
+ * Writer
+ * ---------------------------------------------------------------------------*/
+static bool write_all(int fd, const unsigned char *data, size_t len)
+{
+    while (len > 0U)
+    {
+        const ssize_t written = write(fd, data, len);
+        if (written <= 0)
+        {
+            return false;
+        }
+        data += written;
+        len -= (size_t)written;
+    }
+    return true;
+}
+
+static bool flush_writer(DriveCycleWriter *writer)
+{
+    const bool ok = write_all(writer->fd, writer->buffer, writer->used);
+    writer->used = 0U;
+    return ok;
+}
+
+static bool append(DriveCycleWriter *writer, const void *data, size_t len)
+{
+    if (((writer->used + len) > sizeof(writer->buffer)) && !flush_writer(writer))
+    {
+        return false;
+    }
+    (void)memcpy(&writer->buffer[writer->used], data, len);
+    writer->used += len;
+    return true;
+}
+
+bool drive_cycle_open_writer(DriveCycleWriter *writer, const char *path, DriveCycleFormat format)
+{
+    writer->format = format;
+    writer->used = 0U;
+    writer->rows = 0UL;
+    writer->cycles = 0UL;
+    if (strcmp(path, DRIVE_CYCLE_STDOUT) == 0)
+    {
+        writer->fd = STDOUT_FILENO;
+        return true;
+    }
+    writer->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (writer->fd < 0)
+    {
+        perror("Error opening cycle file");
+        return false;
+    }
+    return true;
+}
+
+bool drive_cycle_write(DriveCycleWriter *writer, uint64_t seed, uint32_t cycle,
+                       const DriveCycleRow *rows, size_t count)
+{
+    bool ok;
+
+    if (writer->format == DRIVE_CYCLE_BINARY)
+    {
+        DriveCycleHeader header;
+        (void)memset(&header, 0, sizeof(header));
+        (void)memcpy(header.magic, DRIVE_CYCLE_MAGIC, DRIVE_CYCLE_MAGIC_SIZE);
+        header.version = DRIVE_CYCLE_VERSION;
+        header.record_size = (uint32_t)sizeof(DriveCycleRow);
+        header.seed = seed;
+        header.cycle = cycle;
+        header.rows = (uint32_t)count;
+        ok = append(writer, &header, sizeof(header));
+        for (size_t i = 0U; ok && (i < count); i++)
+        {
+            ok = append(writer, &rows[i], sizeof(rows[i]));
+        }
+    }
+    else
+    {
+        ok = append(writer, DRIVE_CYCLE_CSV_HEADER, sizeof(DRIVE_CYCLE_CSV_HEADER) - 1U);
+        for (size_t i = 0U; ok && (i < count); i++)
+        {
+            // Format in place when there is room, saves a copy per row
+            if (((writer->used + DRIVE_CYCLE_LINE_SIZE) > sizeof(writer->buffer)) && !flush_writer(writer))
+            {
+                ok = false;
+                break;
+            }
+            writer->used += drive_cycle_format_csv(&rows[i], (char *)&writer->buffer[writer->used]);
+        }
+    }
+    if (ok)
+    {
+        writer->rows += (unsigned long)count;
+        writer->cycles++;
+    }
+    return ok;
+}
+
+bool drive_cycle_close_writer(DriveCycleWriter *writer)
+{
+    bool ok = true;
+
+    if (writer->fd >= 0)
+    {
+        ok = flush_writer(writer);
+        if (writer->fd != STDOUT_FILENO)
+        {
+            ok = (close(writer->fd) == 0) && ok;
+        }
+        writer->fd = -1;
+    }
+    return ok;
+}
+
+/* -----------------------------------------------------------------------------
+ * Reader
+ * ---------------------------------------------------------------------------*/
+bool drive_cycle_is_binary(const char *path)
+{
+    char magic[DRIVE_CYCLE_MAGIC_SIZE];
+    bool binary = false;
+
+    FILE *file = fopen(path, "rb");
+    if (file != NULL)
+    {
+        binary = (fread(magic, 1U, sizeof(magic), file) == sizeof(magic)) &&
+                 (memcmp(magic, DRIVE_CYCLE_MAGIC, DRIVE_CYCLE_MAGIC_SIZE) == 0);
+        (void)fclose(file);
+    }
+    return binary;
+}
+
+bool drive_cycle_open_reader(DriveCycleReader *reader, const char *path)
+{
+    struct stat info;
+    const DriveCycleHeader *header = NULL;
+
+    (void)memset(reader, 0, sizeof(*reader));
+
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        perror("Error opening cycle file");
+        return false;
+    }
+    if ((fstat(fd, &info) != 0) || ((size_t)info.st_size < sizeof(DriveCycleHeader)))
+    {
+        (void)fprintf(stderr, "Cycle file too short: %s\n", path);
+        (void)close(fd);
+        return false;
+    }
+
+    void *map = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    (void)close(fd);
+    if (map == MAP_FAILED)
+    {
+        perror("Error mapping cycle file");
+        return false;
+    }
+
+    header = (const DriveCycleHeader *)map;
+    if ((memcmp(header->magic, DRIVE_CYCLE_MAGIC, DRIVE_CYCLE_MAGIC_SIZE) != 0) ||
+        (header->version != DRIVE_CYCLE_VERSION) ||
+        (header->record_size != sizeof(DriveCycleRow)))
+    {
+        (void)fprintf(stderr, "Not a drive cycle file: %s\n", path);
+        (void)munmap(map, (size_t)info.st_size);
+        return false;
+    }
+
+    reader->map = (const unsigned char *)map;
+    reader->map_size = (size_t)info.st_size;
+    reader->header = header;
+    reader->rows = (const DriveCycleRow *)(reader->map + sizeof(DriveCycleHeader));
+    // First cycle only; a truncated file gives the complete rows it holds
+    reader->count = (reader->map_size - sizeof(DriveCycleHeader)) / sizeof(DriveCycleRow);
+    if (reader->count > header->rows)
+    {
+        reader->count = header->rows;
+    }
+    return true;
+}
+
+void drive_cycle_close_reader(DriveCycleReader *reader)
+{
+    if (reader->map != NULL)
+    {
+        (void)munmap((void *)reader->map, reader->map_size);
+    }
+    (void)memset(reader, 0, sizeof(*reader));
+}
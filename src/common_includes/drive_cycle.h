@@ -0,0 +1,155 @@
+#ifndef DRIVE_CYCLE_H
+#define DRIVE_CYCLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Drive cycle synthesis: expands a base speed trace (ftp75.csv) into the
+ * channels replayed by the BCM (tilt, internal/external temperature, door,
+ * engine temperature), with the models of the former bcm/gen_simu.py.
+ *
+ * Random draws are counter based: each one is a hash of (seed, cycle, row,
+ * channel) and no generator state is carried between rows or cycles. Cycle N
+ * of a seed is therefore the same whichever thread builds it, in any order,
+ * and thousands of distinct cycles can be generated in parallel.
+ *
+ * Binary cycle file (one cycle, loaded by the BCM like a CSV file):
+ *   header : "SSDRVCYC" magic (8) | version u32 | record size u32 |
+ *            seed u64 | cycle u32 | rows u32
+ *   rows   : DriveCycleRow, fixed size, host byte order
+ * Streams (output "-") hold several cycles back to back, each with its header.
+ */
+#define DRIVE_CYCLE_MAGIC       "SSDRVCYC"
+#define DRIVE_CYCLE_MAGIC_SIZE  (8U)
+#define DRIVE_CYCLE_VERSION     (1U)
+#define DRIVE_CYCLE_BUFFER_SIZE (256U * 1024U)  // Writer buffer, flushed when full
+#define DRIVE_CYCLE_LINE_SIZE   (96U)           // Enough for one CSV row
+#define DRIVE_CYCLE_STDOUT      "-"
+
+// Column line of the CSV files read by the BCM (bcm/full_simu.csv)
+#define DRIVE_CYCLE_CSV_HEADER \
+    "Time (seconds),Speed (km/h),Tilt Angle (deg),Internal Temp (C)," \
+    "External Temp (C),Door Open,Engine Temp (C)\n"
+
+typedef enum {
+    DRIVE_CYCLE_CSV = 0,
+    DRIVE_CYCLE_BINARY
+} DriveCycleFormat;
+
+typedef struct {
+    char magic[DRIVE_CYCLE_MAGIC_SIZE];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t seed;
+    uint32_t cycle;
+    uint32_t rows;
+} DriveCycleHeader;
+
+// One second of a cycle; decimals are already rounded to 0.1
+typedef struct {
+    int32_t time;           // s
+    float speed;            // km/h
+    float tilt_angle;       // degrees
+    float engi_temp;        // degrees C
+    int8_t internal_temp;   // degrees C
+    int8_t external_temp;   // degrees C
+    uint8_t door_open;
+    uint8_t reserved;
+} DriveCycleRow;
+
+// Base speed trace: "time,speed" rows, the speed may use a decimal comma
+typedef struct {
+    int32_t *time;
+    double *speed;
+    size_t rows;
+} DriveCycleBase;
+
+// Synthesis parameters, defaults are those of gen_simu.py
+typedef struct {
+    uint64_t seed;
+    int internal_min;               // Internal temperature range, degrees C
+    int internal_max;
+    int external_min;               // External temperature range, degrees C
+    int external_max;
+    double change_probability;      // Per row chance of a temperature change
+    double door_probability;        // Per stopped row chance of an open door
+    double max_tilt_change;         // Largest tilt step while moving, degrees
+    double speed_scale;             // Applied to every base speed
+} DriveCycleParams;
+
+typedef struct {
+    int fd;
+    DriveCycleFormat format;
+    size_t used;
+    unsigned long rows;
+    unsigned long cycles;
+    unsigned char buffer[DRIVE_CYCLE_BUFFER_SIZE];
+} DriveCycleWriter;
+
+typedef struct {
+    const unsigned char *map;   // Whole file, mmap'd read-only
+    size_t map_size;
+    const DriveCycleHeader *header;
+    const DriveCycleRow *rows;
+    size_t count;
+} DriveCycleReader;
+
+// Load a base trace (ftp75.csv, or the first two columns of a cycle CSV)
+bool drive_cycle_load_base(DriveCycleBase *base, const char *path);
+void drive_cycle_free_base(DriveCycleBase *base);
+
+void drive_cycle_default_params(DriveCycleParams *params);
+
+// splitmix64 finalizer, the hash behind every draw
+#define DRIVE_CYCLE_GAMMA       (0x9E3779B97F4A7C15ULL)
+#define DRIVE_CYCLE_CHANNEL_BITS (8U)
+
+static inline uint64_t drive_cycle_mix(uint64_t x)
+{
+    x ^= x >> 30U;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27U;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31U;
+    return x;
+}
+
+// Key of one cycle (or replica) of a seed
+static inline uint64_t drive_cycle_key(uint64_t seed, uint32_t cycle)
+{
+    return drive_cycle_mix(drive_cycle_mix(seed + DRIVE_CYCLE_GAMMA) +
+                           (DRIVE_CYCLE_GAMMA * ((uint64_t)cycle + 1U)));
+}
+
+/* Uniform draw in [0, 1) for (row, channel), channel < 256. Inline and
+   stateless, so loops over rows have no dependency between iterations. */
+static inline double drive_cycle_uniform(uint64_t key, uint32_t row, unsigned int channel)
+{
+    const uint64_t counter = ((uint64_t)row << DRIVE_CYCLE_CHANNEL_BITS) | (uint64_t)channel;
+    return (double)(drive_cycle_mix(key ^ (counter * DRIVE_CYCLE_GAMMA)) >> 11U) *
+           (1.0 / 9007199254740992.0);     // 2^-53
+}
+
+// Fill rows[0 .. base->rows - 1] with cycle number `cycle`
+void drive_cycle_synthesize(const DriveCycleBase *base, const DriveCycleParams *params,
+                            uint32_t cycle, DriveCycleRow *rows);
+
+// Format one row as a CSV line (with '\n', no terminator); returns its length
+size_t drive_cycle_format_csv(const DriveCycleRow *row, char *line);
+
+// Writer: create/truncate path ("-" for stdout); each cycle gets its own header
+bool drive_cycle_open_writer(DriveCycleWriter *writer, const char *path, DriveCycleFormat format);
+bool drive_cycle_write(DriveCycleWriter *writer, uint64_t seed, uint32_t cycle,
+                       const DriveCycleRow *rows, size_t count);
+bool drive_cycle_close_writer(DriveCycleWriter *writer);
+
+// True if path starts with the binary cycle magic
+bool drive_cycle_is_binary(const char *path);
+
+// Reader: map a binary cycle file; rows are then accessed in place
+bool drive_cycle_open_reader(DriveCycleReader *reader, const char *path);
+void drive_cycle_close_reader(DriveCycleReader *reader);
+
+#endif // DRIVE_CYCLE_H
@@ -0,0 +1,72 @@
+#include "ecu_shutdown.h"
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/signalfd.h>
+
+static int shutdown_fd = -1;
+static volatile bool shutdown_requested = false;
+
+bool ecu_shutdown_init(void)
+{
+    sigset_t stop_signals;
+
+    if (shutdown_fd >= 0)
+    {
+        return true;
+    }
+    (void)sigemptyset(&stop_signals);
+    (void)sigaddset(&stop_signals, SIGINT);
+    (void)sigaddset(&stop_signals, SIGTERM);
+    if (pthread_sigmask(SIG_BLOCK, &stop_signals, NULL) != 0)
+    {
+        return false;
+    }
+    shutdown_fd = signalfd(-1, &stop_signals, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (shutdown_fd < 0)
+    {
+        perror("Error creating the shutdown signalfd");
+        return false;
+    }
+    return true;
+}
+
+int ecu_shutdown_fd(void)
+{
+    return shutdown_fd;
+}
+
+bool ecu_shutdown_check(void)
+{
+    if (!shutdown_requested && (shutdown_fd >= 0))
+    {
+        struct pollfd pfd = { .fd = shutdown_fd, .events = POLLIN, .revents = 0 };
+        if ((poll(&pfd, 1U, 0) > 0) && ((pfd.revents & POLLIN) != 0))
+        {
+            shutdown_requested = true;
+        }
+    }
+    return shutdown_requested;
+}
+
+const volatile bool *ecu_shutdown_flag(void)
+{
+    return &shutdown_requested;
+}
+
+static void shutdown_task(Coro *co)
+{
+    CORO_BEGIN(co);
+    while (!ecu_shutdown_check())
+    {
+        CORO_WAIT_READABLE(co, shutdown_fd, CORO_NO_TIMEOUT);
+    }
+    CORO_END(co);
+}
+
+bool ecu_shutdown_spawn(CoroScheduler *sched, Coro *co)
+{
+    return (shutdown_fd >= 0) && coro_spawn(sched, co, "shutdown", shutdown_task, NULL);
+}
@@ -0,0 +1,38 @@
+#ifndef ECU_SHUTDOWN_H
+#define ECU_SHUTDOWN_H
+
+#include <stdbool.h>
+
+#include "coro.h"
+
+/*
+ * Graceful shutdown on SIGINT and SIGTERM.
+ *
+ * ecu_shutdown_init blocks both signals in the calling thread before any
+ * other thread starts, so every thread inherits the mask and none is ever
+ * interrupted, and routes them to a signalfd. Each loop adds that descriptor
+ * to what it already waits on (epoll, poll, or a coroutine through
+ * ecu_shutdown_spawn) and leaves through its normal cleanup as soon as it
+ * becomes readable, with logs, telemetry and counters flushed.
+ *
+ * The signal is never read, only detected: it stays pending, so the signalfd
+ * stays readable and every waiter sees it, whichever thread it runs on and
+ * however late it looks. This matters as PID 1 in a container, where an
+ * unhandled SIGTERM is ignored and the ECU used to be killed at the timeout.
+ */
+bool ecu_shutdown_init(void);
+
+// Readable once a stop signal arrived, -1 before ecu_shutdown_init
+int ecu_shutdown_fd(void);
+
+// True once a stop signal arrived (does not wait)
+bool ecu_shutdown_check(void);
+
+// Set by ecu_shutdown_check and the coroutine, for coro_sched_run
+const volatile bool *ecu_shutdown_flag(void);
+
+/* Spawn a coroutine that waits on the signalfd and sets the flag, so that
+   coro_sched_run(sched, ecu_shutdown_flag()) returns on the signal */
+bool ecu_shutdown_spawn(CoroScheduler *sched, Coro *co);
+
+#endif // ECU_SHUTDOWN_H
@@ -0,0 +1,48 @@
+#include "ecu_stats.h"
+#include "metrics.h"
+#include <stdint.h>
+#include <string.h>
+
+static void from_counts(EcuStats *stats, const uint64_t *counts)
+{
+    stats->frames_rx = (unsigned long)counts[METRIC_FRAMES_ACCEPTED];
+    stats->msgs_processed = (unsigned long)counts[METRIC_MESSAGES_PROCESSED];
+    stats->msgs_rejected = (unsigned long)counts[METRIC_DECRYPT_FAILURES];
+    stats->frags_dropped = (unsigned long)counts[METRIC_REASSEMBLY_ERRORS];
+    stats->queue_dropped = (unsigned long)counts[METRIC_BUFFER_DROPS];
+}
+
+void ecu_stats_get(EcuStats *stats)
+{
+    uint64_t counts[METRIC_COUNT];
+
+    for (unsigned int id = 0U; id < (unsigned int)METRIC_COUNT; id++)
+    {
+        counts[id] = metrics_get((MetricId)id);
+    }
+    from_counts(stats, counts);
+}
+
+void ecu_stats_restore(const EcuStats *saved)
+{
+    metrics_add(METRIC_FRAMES_ACCEPTED, saved->frames_rx);
+    metrics_add(METRIC_MESSAGES_PROCESSED, saved->msgs_processed);
+    metrics_add(METRIC_DECRYPT_FAILURES, saved->msgs_rejected);
+    metrics_add(METRIC_REASSEMBLY_ERRORS, saved->frags_dropped);
+    metrics_add(METRIC_BUFFER_DROPS, saved->queue_dropped);
+}
+
+bool ecu_stats_read(const char *ecu_name, EcuStats *stats)
+{
+    char path[METRICS_PATH_SIZE];
+    uint64_t counts[METRIC_COUNT];
+
+    metrics_file_path(ecu_name, path, sizeof(path));
+    (void)memset(stats, 0, sizeof(*stats));
+    if (!metrics_read(path, counts))
+    {
+        return false;
+    }
+    from_counts(stats, counts);
+    return true;
+}
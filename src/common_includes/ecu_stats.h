@@ -0,0 +1,36 @@
+#ifndef ECU_STATS_H
+#define ECU_STATS_H
+
+#include <stdbool.h>
+
+/*
+ * Receive counters of the consumer ECUs, a view over the metrics counters
+ * (metrics.h) of the same events: there is a single count of each. In the ECU
+ * process they are read with ecu_stats_get; external tools such as can_loadgen
+ * read them back from the metrics file the ECU exports to
+ * "<dir>/ecu_metrics_<name>.prom" (dir taken from the ECU_STATS_DIR environment
+ * variable, /tmp by default) at most every ECU_STATS_FLUSH_MS.
+ */
+#define ECU_STATS_DIR_ENV       "ECU_STATS_DIR"
+#define ECU_STATS_DEFAULT_DIR   "/tmp"
+#define ECU_STATS_PATH_SIZE     (256)
+#define ECU_STATS_FLUSH_MS      (250LL)
+
+typedef struct {
+    unsigned long frames_rx;        // Frames received with an accepted CAN ID
+    unsigned long msgs_processed;   // Messages decrypted and handed to the parser
+    unsigned long msgs_rejected;    // Messages failing authentication or replayed
+    unsigned long frags_dropped;    // Fragments discarded by reassembly
+    unsigned long queue_dropped;    // Messages lost because a queue was full
+} EcuStats;
+
+// Current counters of this process
+void ecu_stats_get(EcuStats *stats);
+
+// Continue from the counters of a previous run (a restored checkpoint)
+void ecu_stats_restore(const EcuStats *saved);
+
+// Read the counters exported by ecu_name; false if its file is missing
+bool ecu_stats_read(const char *ecu_name, EcuStats *stats);
+
+#endif // ECU_STATS_H
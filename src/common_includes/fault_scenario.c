@@ -0,0 +1,178 @@
+#include "fault_scenario.h"
+#include "drive_cycle.h"
+#include <math.h>
+#include <string.h>
+
+#define DEFAULT_STEPS           (40U)
+#define DEFAULT_MAX_DURATION    (4U)
+#define DEFAULT_MAX_EPISODES    (3U)
+#define DEFAULT_INTERMITTENT    (0.25)
+#define MAX_PERIOD              (6U)
+
+// Draw channels of an episode; the scenario level draws use row FAULT_MAX_EPISODES
+#define CHANNEL_TYPE            (0U)
+#define CHANNEL_ONSET           (1U)
+#define CHANNEL_DURATION        (2U)
+#define CHANNEL_INTERMITTENT    (3U)
+#define CHANNEL_PERIOD          (4U)
+#define CHANNEL_VALUE           (5U)
+#define CHANNEL_COUNT           (0U)
+
+typedef struct {
+    const char *name;
+    double min;             // Injected values, all past the SWR6.4 limits
+    double max;
+    bool integer;
+} FaultTypeInfo;
+
+static const FaultTypeInfo fault_types[FAULT_TYPE_COUNT] = {
+    [FAULT_DOOR]        = { "door",        2.0,   5.0,  true },   // Only 0 and 1 are valid
+    [FAULT_ENGINE_TEMP] = { "engine_temp", 120.5, 160.0, false },  // Limit 120 C
+    [FAULT_TILT]        = { "tilt",        60.5,  90.0,  false }   // Limit 60 deg
+};
+
+const char *fault_type_name(FaultType type)
+{
+    return ((unsigned int)type < FAULT_TYPE_COUNT) ? fault_types[type].name : NULL;
+}
+
+void fault_gen_config_default(FaultGenConfig *config)
+{
+    config->steps = DEFAULT_STEPS;
+    config->max_duration = DEFAULT_MAX_DURATION;
+    config->max_episodes = DEFAULT_MAX_EPISODES;
+    config->types = FAULT_ALL_TYPES;
+    config->intermittent = DEFAULT_INTERMITTENT;
+}
+
+bool fault_gen_config_valid(const FaultGenConfig *config)
+{
+    return (config->steps >= 2U) && (config->steps <= FAULT_MAX_STEPS) &&
+           (config->max_duration >= 1U) && (config->max_duration <= config->steps) &&
+           (config->max_episodes >= 1U) && (config->max_episodes <= FAULT_MAX_EPISODES) &&
+           (config->types != 0U) && ((config->types & ~FAULT_ALL_TYPES) == 0U) &&
+           (config->intermittent >= 0.0) && (config->intermittent <= 1.0);
+}
+
+// Uniform integer in [min, max]
+static uint32_t draw_range(uint64_t key, uint32_t row, unsigned int channel, uint32_t min, uint32_t max)
+{
+    const double span = (double)(max - min) + 1.0;
+    const uint32_t offset = (uint32_t)(drive_cycle_uniform(key, row, channel) * span);
+    return min + ((offset > (max - min)) ? (max - min) : offset);
+}
+
+/**
+ * @brief Draw the fault episodes of one campaign scenario.
+ * @requirement SWR6.4
+ */
+void fault_scenario_generate(const FaultGenConfig *config, uint64_t seed, uint32_t id,
+                             FaultScenario *scenario)
+{
+    const uint64_t key = drive_cycle_key(seed, id);
+    FaultType enabled[FAULT_TYPE_COUNT];
+    uint32_t num_enabled = 0U;
+
+    for (unsigned int t = 0U; t < FAULT_TYPE_COUNT; t++)
+    {
+        if ((config->types & FAULT_BIT(t)) != 0U)
+        {
+            enabled[num_enabled] = (FaultType)t;
+            num_enabled++;
+        }
+    }
+
+    (void)memset(scenario, 0, sizeof(*scenario));
+    scenario->id = id;
+    scenario->steps = config->steps;
+    scenario->num_episodes = draw_range(key, FAULT_MAX_EPISODES, CHANNEL_COUNT, 1U, config->max_episodes);
+
+    for (uint32_t e = 0U; e < scenario->num_episodes; e++)
+    {
+        FaultEpisode *episode = &scenario->episodes[e];
+        const FaultTypeInfo *info = NULL;
+
+        episode->type = enabled[draw_range(key, e, CHANNEL_TYPE, 0U, num_enabled - 1U)];
+        episode->onset = draw_range(key, e, CHANNEL_ONSET, 1U, config->steps);
+        episode->duration = draw_range(key, e, CHANNEL_DURATION, 1U, config->max_duration);
+        if (drive_cycle_uniform(key, e, CHANNEL_INTERMITTENT) < config->intermittent)
+        {
+            episode->period = draw_range(key, e, CHANNEL_PERIOD, 2U, MAX_PERIOD);
+        }
+
+        info = &fault_types[episode->type];
+        episode->value = info->min + (drive_cycle_uniform(key, e, CHANNEL_VALUE) * (info->max - info->min));
+        if (info->integer)
+        {
+            episode->value = floor(episode->value);
+        }
+    }
+}
+
+bool fault_episode_active(const FaultEpisode *episode, uint32_t row)
+{
+    if ((row < episode->onset) || ((row - episode->onset) >= episode->duration))
+    {
+        return false;
+    }
+    return (episode->period == 0U) || (((row - episode->onset) % episode->period) != (episode->period - 1U));
+}
+
+unsigned int fault_scenario_mask(const FaultScenario *scenario, uint32_t row)
+{
+    unsigned int mask = 0U;
+
+    for (unsigned int e = 0U; e < scenario->num_episodes; e++)
+    {
+        if (fault_episode_active(&scenario->episodes[e], row))
+        {
+            mask |= FAULT_BIT(scenario->episodes[e].type);
+        }
+    }
+    return mask;
+}
+
+/**
+ * @brief Reference outcome of a scenario: the first fault run that is still
+ * present on every sample taken before its safety deadline.
+ * @requirement SWR6.4
+ */
+void fault_scenario_expect(const FaultScenario *scenario, long long step_ms, long long timeout_ms,
+                           FaultExpectation *expect)
+{
+    // Rows sampled strictly before the deadline, the first one included
+    uint32_t timeout_steps = (timeout_ms > 0) ? (uint32_t)((timeout_ms + step_ms - 1) / step_ms) : 1U;
+    uint32_t run_start = 0U;
+    bool in_run = false;
+
+    (void)memset(expect, 0, sizeof(*expect));
+    for (uint32_t row = 1U; row <= scenario->steps; row++)
+    {
+        const unsigned int mask = fault_scenario_mask(scenario, row);
+
+        if (mask == 0U)
+        {
+            in_run = false;
+        }
+        else if (!in_run)
+        {
+            in_run = true;
+            run_start = row;
+        }
+        else
+        {
+            // Fault still present, the run goes on
+        }
+
+        // Row r is sampled at (r - 1) * step; the last one at (steps - 1) * step
+        if (in_run && ((row - run_start + 1U) == timeout_steps) &&
+            ((((long long)run_start - 1) * step_ms) + timeout_ms <= ((long long)scenario->steps - 1) * step_ms))
+        {
+            expect->detected = true;
+            expect->step = row;
+            expect->run_start = run_start;
+            expect->faults = mask;
+            return;
+        }
+    }
+}
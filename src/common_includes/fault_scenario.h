@@ -0,0 +1,90 @@
+#ifndef FAULT_SCENARIO_H
+#define FAULT_SCENARIO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Fault scenarios for the BCM health monitoring (SWR6.4) campaigns.
+ *
+ * A scenario injects one or more fault episodes into the first `steps` rows
+ * of a healthy drive cycle. An episode holds one adverse value (invalid door
+ * status, engine overtemperature or excessive tilt) from its onset row for
+ * `duration` rows; an intermittent episode drops back to healthy on the last
+ * row of every `period`. Episodes may overlap, so several causes can be
+ * present at once.
+ *
+ * The expected outcome is worked out from the scenario alone: a fault (of any
+ * cause) first sampled at t must be reported at t + timeout unless a healthy
+ * sample comes strictly before that deadline, and the report belongs to the
+ * last row sampled before it, ceil(timeout / step) - 1 rows after the first
+ * one. A deadline beyond the last sample of the window is not reached. Draws use the counter based generator of drive_cycle.h keyed by
+ * (seed, scenario), so scenario N is the same in every campaign run.
+ */
+#define FAULT_MAX_EPISODES      (4U)
+#define FAULT_MAX_STEPS         (3600U)     // Scenario window, rows
+
+typedef enum {
+    FAULT_DOOR = 0,
+    FAULT_ENGINE_TEMP,
+    FAULT_TILT,
+    FAULT_TYPE_COUNT
+} FaultType;
+
+// Same bit layout as HEALTH_FAULT_* of the BCM
+#define FAULT_BIT(type)         (1U << (unsigned int)(type))
+#define FAULT_ALL_TYPES         ((1U << (unsigned int)FAULT_TYPE_COUNT) - 1U)
+
+typedef struct {
+    FaultType type;
+    uint32_t onset;         // First faulty row, >= 1 (row 0 is never checked)
+    uint32_t duration;      // Rows
+    uint32_t period;        // 0: continuous, else healthy on every period-th row
+    double value;           // Injected door status, engine temp or tilt angle
+} FaultEpisode;
+
+typedef struct {
+    uint32_t id;
+    uint32_t steps;         // Rows 1..steps are checked
+    unsigned int num_episodes;
+    FaultEpisode episodes[FAULT_MAX_EPISODES];
+} FaultScenario;
+
+typedef struct {
+    uint32_t steps;             // Window of every scenario
+    uint32_t max_duration;      // Longest episode, rows
+    unsigned int max_episodes;  // 1..FAULT_MAX_EPISODES per scenario
+    unsigned int types;         // FAULT_BIT mask of the causes to draw from
+    double intermittent;        // Chance that an episode is intermittent
+} FaultGenConfig;
+
+typedef struct {
+    bool detected;
+    uint32_t step;              // Last row sampled before the report
+    uint32_t run_start;         // First row of the fault run that triggers it
+    unsigned int faults;        // FAULT_BIT causes present on that row
+} FaultExpectation;
+
+const char *fault_type_name(FaultType type);
+
+// Defaults: 40 rows, episodes up to 4 rows, 1..3 episodes of any cause
+void fault_gen_config_default(FaultGenConfig *config);
+bool fault_gen_config_valid(const FaultGenConfig *config);
+
+// Scenario `id` of the campaign keyed by `seed`
+void fault_scenario_generate(const FaultGenConfig *config, uint64_t seed, uint32_t id,
+                             FaultScenario *scenario);
+
+// Whether an episode holds its adverse value on a row
+bool fault_episode_active(const FaultEpisode *episode, uint32_t row);
+
+// FAULT_BIT causes present on a row
+unsigned int fault_scenario_mask(const FaultScenario *scenario, uint32_t row);
+
+/* Outcome required by SWR6.4 when every row is sampled step_ms after the
+   previous one and a fault must persist timeout_ms */
+void fault_scenario_expect(const FaultScenario *scenario, long long step_ms, long long timeout_ms,
+                           FaultExpectation *expect);
+
+#endif // FAULT_SCENARIO_H
@@ -0,0 +1,162 @@
+#include "fuel_savings.h"
+#include <stdio.h>
+#include <string.h>
+
+#define ML_PER_LITRE        (1000.0)
+#define MS_PER_HOUR         (3600000.0)
+#define MS_PER_SEC          (1000.0)
+#define TEMP_POINTS         (5U)
+#define AC_POINTS           (3U)
+
+// Idle fuel flow calibration (L/h), 1.6 L gasoline engine
+static const double temp_axis[TEMP_POINTS] = { 20.0, 40.0, 60.0, 80.0, 100.0 };
+static const double ac_axis[AC_POINTS] = { 0.0, 0.5, 1.0 };
+static const double idle_flow_lph[TEMP_POINTS][AC_POINTS] = {
+    { 1.30, 1.50, 1.70 },
+    { 1.10, 1.30, 1.50 },
+    { 0.90, 1.10, 1.30 },
+    { 0.75, 0.95, 1.15 },
+    { 0.70, 0.90, 1.10 },
+};
+
+// Index of the lower breakpoint and the weight of the upper one, clamped to the axis
+static size_t axis_position(const double *axis, size_t points, double value, double *weight)
+{
+    size_t i = 0U;
+
+    if (value <= axis[0])
+    {
+        *weight = 0.0;
+        return 0U;
+    }
+    if (value >= axis[points - 1U])
+    {
+        *weight = 1.0;
+        return points - 2U;
+    }
+    while (value > axis[i + 1U])
+    {
+        i++;
+    }
+    *weight = (value - axis[i]) / (axis[i + 1U] - axis[i]);
+    return i;
+}
+
+double fuel_idle_flow_lph(double engine_temp, double ac_load)
+{
+    double wt = 0.0;
+    double wa = 0.0;
+    const size_t t = axis_position(temp_axis, TEMP_POINTS, engine_temp, &wt);
+    const size_t a = axis_position(ac_axis, AC_POINTS, ac_load, &wa);
+
+    const double low = (idle_flow_lph[t][a] * (1.0 - wa)) + (idle_flow_lph[t][a + 1U] * wa);
+    const double high = (idle_flow_lph[t + 1U][a] * (1.0 - wa)) + (idle_flow_lph[t + 1U][a + 1U] * wa);
+    return (low * (1.0 - wt)) + (high * wt);
+}
+
+double fuel_ac_load(double external_temp, double temp_set)
+{
+    const double load = (external_temp - temp_set) / FUEL_AC_FULL_LOAD_C;
+    return (load < 0.0) ? 0.0 : ((load > 1.0) ? 1.0 : load);
+}
+
+void fuel_savings_reset(FuelSavings *savings)
+{
+    (void)memset(savings, 0, sizeof(*savings));
+    savings->last_ms = -1;
+}
+
+void fuel_savings_update(FuelSavings *savings, long long time_ms, bool engine_off,
+                         double engine_temp, double ac_load)
+{
+    if ((savings->last_ms >= 0) && savings->engine_off)
+    {
+        const long long elapsed_ms = time_ms - savings->last_ms;
+        if ((elapsed_ms > 0) && (elapsed_ms <= FUEL_MAX_GAP_MS))
+        {
+            savings->engine_off_s += (double)elapsed_ms / MS_PER_SEC;
+            savings->idle_fuel_ml += (savings->flow_lph * (double)elapsed_ms * ML_PER_LITRE) / MS_PER_HOUR;
+        }
+        else if (elapsed_ms > FUEL_MAX_GAP_MS)
+        {
+            savings->gaps++;
+        }
+        else
+        {
+            // Same or earlier time: nothing to integrate
+        }
+    }
+
+    if (engine_off && !savings->engine_off)
+    {
+        savings->intervals++;
+    }
+    else if (!engine_off && savings->engine_off)
+    {
+        savings->restarts++;
+        savings->penalty_ml += FUEL_RESTART_PENALTY_ML;
+    }
+    else
+    {
+        // No transition
+    }
+
+    savings->engine_off = engine_off;
+    savings->flow_lph = fuel_idle_flow_lph(engine_temp, ac_load);
+    savings->last_ms = time_ms;
+}
+
+double fuel_savings_net_ml(const FuelSavings *savings)
+{
+    return savings->idle_fuel_ml - savings->penalty_ml;
+}
+
+double fuel_savings_co2_g(const FuelSavings *savings)
+{
+    return fuel_savings_net_ml(savings) * FUEL_CO2_G_PER_ML;
+}
+
+void fuel_savings_merge(FuelSavings *total, const FuelSavings *part)
+{
+    total->engine_off_s += part->engine_off_s;
+    total->idle_fuel_ml += part->idle_fuel_ml;
+    total->penalty_ml += part->penalty_ml;
+    total->intervals += part->intervals;
+    total->restarts += part->restarts;
+    total->gaps += part->gaps;
+}
+
+bool fuel_savings_add_telemetry(FuelSavings *savings, TelemetryReader *reader)
+{
+    const int time_col = telemetry_column_index(reader, "time_ms");
+    const int off_col = telemetry_column_index(reader, "engine_off");
+    const int temp_col = telemetry_column_index(reader, "engi_temp");
+    const int ext_col = telemetry_column_index(reader, "ex_temp");
+    const int set_col = telemetry_column_index(reader, "temp_set");
+
+    if ((time_col < 0) || (off_col < 0) || (temp_col < 0) || (ext_col < 0) || (set_col < 0))
+    {
+        return false;
+    }
+    while (telemetry_read_block(reader))
+    {
+        for (uint32_t row = 0U; row < reader->rows; row++)
+        {
+            const double ac_load = fuel_ac_load(telemetry_value(reader, (uint32_t)ext_col, row),
+                                                telemetry_value(reader, (uint32_t)set_col, row));
+            fuel_savings_update(savings, (long long)telemetry_value(reader, (uint32_t)time_col, row),
+                                telemetry_value(reader, (uint32_t)off_col, row) != 0.0,
+                                telemetry_value(reader, (uint32_t)temp_col, row), ac_load);
+        }
+    }
+    return true;
+}
+
+int fuel_savings_format(const FuelSavings *savings, char *text, size_t size)
+{
+    return snprintf(text, size,
+                    "engine_off_s=%.0f intervals=%lu restarts=%lu idle_fuel_ml=%.1f penalty_ml=%.1f "
+                    "fuel_saved_ml=%.1f co2_saved_g=%.1f",
+                    savings->engine_off_s, savings->intervals, savings->restarts, savings->idle_fuel_ml,
+                    savings->penalty_ml, fuel_savings_net_ml(savings), fuel_savings_co2_g(savings));
+}
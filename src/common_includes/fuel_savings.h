@@ -0,0 +1,68 @@
+#ifndef FUEL_SAVINGS_H
+#define FUEL_SAVINGS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "telemetry.h"
+
+/*
+ * Fuel and CO2 saved by Stop/Start.
+ *
+ * While the engine is off, the idle fuel flow it would have burnt is
+ * integrated over time. The flow comes from a calibration table indexed by
+ * engine temperature (a cold engine idles richer) and AC load (the compressor
+ * is engine driven), interpolated bilinearly. Each restart costs a fixed
+ * amount of fuel, subtracted from the savings.
+ *
+ * The estimator is fed one sample at a time, so the same code runs online in
+ * the powertrain (once per Stop/Start step) and over recorded telemetry, and
+ * the results of several runs can be merged into fleet totals.
+ */
+#define FUEL_RESTART_PENALTY_ML (2.0)       // About 8 s of warm idle with AC
+#define FUEL_CO2_G_PER_ML       (2.31)      // Gasoline, tank to exhaust
+#define FUEL_AC_FULL_LOAD_C     (10.0)      // Ambient above set point for full AC load
+#define FUEL_MAX_GAP_MS         (5000LL)    // Longer gaps between samples are not integrated
+
+typedef struct {
+    double engine_off_s;        // Time integrated with the engine off
+    double idle_fuel_ml;        // Idle fuel not burnt
+    double penalty_ml;          // Fuel spent on restarts
+    unsigned long intervals;    // Engine-off intervals started
+    unsigned long restarts;     // Engine-off intervals ended by a restart
+    unsigned long gaps;         // Sample gaps over FUEL_MAX_GAP_MS, skipped
+    // Last sample
+    bool engine_off;
+    double flow_lph;            // Idle flow at the last sample, L/h
+    long long last_ms;          // -1: no sample yet
+} FuelSavings;
+
+void fuel_savings_reset(FuelSavings *savings);
+
+// Idle fuel flow (L/h) at an engine temperature (C) and AC load (0..1)
+double fuel_idle_flow_lph(double engine_temp, double ac_load);
+
+// AC load (0..1) from the ambient temperature and the cabin set point
+double fuel_ac_load(double external_temp, double temp_set);
+
+/* Add one sample: the interval since the previous sample is integrated with
+   the state of the previous sample. An engine-on sample after an engine-off
+   one is a restart. */
+void fuel_savings_update(FuelSavings *savings, long long time_ms, bool engine_off,
+                         double engine_temp, double ac_load);
+
+// Idle fuel saved minus restart penalties, and the matching CO2
+double fuel_savings_net_ml(const FuelSavings *savings);
+double fuel_savings_co2_g(const FuelSavings *savings);
+
+// Add the totals of part to total (the last sample state of total is kept)
+void fuel_savings_merge(FuelSavings *total, const FuelSavings *part);
+
+/* Feed every row of a powertrain telemetry file (columns time_ms, engine_off,
+   engi_temp, ex_temp, temp_set). False if a column is missing. */
+bool fuel_savings_add_telemetry(FuelSavings *savings, TelemetryReader *reader);
+
+// One line summary: "engine_off_s=... fuel_saved_ml=... co2_saved_g=..."
+int fuel_savings_format(const FuelSavings *savings, char *text, size_t size);
+
+#endif // FUEL_SAVINGS_H
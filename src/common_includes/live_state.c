@@ -0,0 +1,165 @@
+#include "live_state.h"
+#include <fcntl.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SEGMENT_MODE        (0644)
+#define NSEC_PER_MS         (1000000LL)
+#define MS_PER_SEC          (1000LL)
+
+static int64_t now_ms(void)
+{
+    struct timespec now;
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((int64_t)now.tv_sec * MS_PER_SEC) + (now.tv_nsec / NSEC_PER_MS);
+}
+
+void live_state_name(const char *ecu_name, char *name, size_t size)
+{
+    (void)snprintf(name, size, "/ecu_live_%s", ecu_name);
+}
+
+bool live_state_create(LiveState *live, const char *ecu_name)
+{
+    (void)memset(live, 0, sizeof(*live));
+    live_state_name(ecu_name, live->name, sizeof(live->name));
+
+    const int fd = shm_open(live->name, O_CREAT | O_RDWR, SEGMENT_MODE);
+    if (fd < 0)
+    {
+        perror("Error creating the live state segment");
+        return false;
+    }
+    if (ftruncate(fd, (off_t)sizeof(LiveSegment)) != 0)
+    {
+        perror("Error sizing the live state segment");
+        (void)close(fd);
+        return false;
+    }
+
+    void *map = mmap(NULL, sizeof(LiveSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    (void)close(fd);
+    if (map == MAP_FAILED)
+    {
+        perror("Error mapping the live state segment");
+        return false;
+    }
+
+    /* A segment left by a previous run is reset as one update, so readers
+       still attached to it never copy a half-cleared state */
+    LiveSegment *segment = (LiveSegment *)map;
+    const uint32_t seq = __atomic_load_n(&segment->seq, __ATOMIC_RELAXED) | 1U;
+    __atomic_store_n(&segment->seq, seq, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    (void)memset(&segment->signals, 0, sizeof(segment->signals));
+    __atomic_store_n(&segment->seq, seq + 1U, __ATOMIC_RELEASE);
+    segment->version = LIVE_STATE_VERSION;
+    segment->size = (uint32_t)sizeof(LiveSegment);
+    (void)snprintf(segment->ecu, sizeof(segment->ecu), "%s", ecu_name);
+    __atomic_store_n(&segment->magic, LIVE_STATE_MAGIC, __ATOMIC_RELEASE);
+
+    live->segment = segment;
+    live->owner = true;
+    return true;
+}
+
+bool live_state_attach(LiveState *live, const char *ecu_name)
+{
+    struct stat info;
+
+    (void)memset(live, 0, sizeof(*live));
+    live_state_name(ecu_name, live->name, sizeof(live->name));
+
+    const int fd = shm_open(live->name, O_RDONLY, 0);
+    if (fd < 0)
+    {
+        return false;
+    }
+    if ((fstat(fd, &info) != 0) || (info.st_size < (off_t)sizeof(LiveSegment)))
+    {
+        (void)close(fd);
+        return false;
+    }
+
+    void *map = mmap(NULL, sizeof(LiveSegment), PROT_READ, MAP_SHARED, fd, 0);
+    (void)close(fd);
+    if (map == MAP_FAILED)
+    {
+        return false;
+    }
+
+    const LiveSegment *segment = (const LiveSegment *)map;
+    if ((__atomic_load_n(&segment->magic, __ATOMIC_ACQUIRE) != LIVE_STATE_MAGIC) ||
+        (segment->version != LIVE_STATE_VERSION) || (segment->size != sizeof(LiveSegment)))
+    {
+        (void)munmap(map, sizeof(LiveSegment));
+        return false;
+    }
+    live->segment = (LiveSegment *)map;
+    return true;
+}
+
+void live_state_publish(LiveState *live, LiveSignals *signals)
+{
+    LiveSegment *segment = live->segment;
+
+    if ((segment == NULL) || !live->owner)
+    {
+        return;
+    }
+
+    const uint32_t seq = __atomic_load_n(&segment->seq, __ATOMIC_RELAXED);
+    signals->time_ms = now_ms();
+    signals->updates = segment->signals.updates + 1U;
+
+    __atomic_store_n(&segment->seq, seq + 1U, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    (void)memcpy(&segment->signals, signals, sizeof(*signals));
+    __atomic_store_n(&segment->seq, seq + 2U, __ATOMIC_RELEASE);
+}
+
+bool live_state_read(const LiveState *live, LiveSignals *signals)
+{
+    const LiveSegment *segment = live->segment;
+
+    if (segment == NULL)
+    {
+        return false;
+    }
+
+    for (unsigned int attempt = 0U; attempt < LIVE_STATE_READ_TRIES; attempt++)
+    {
+        const uint32_t before = __atomic_load_n(&segment->seq, __ATOMIC_ACQUIRE);
+        if ((before & 1U) == 0U)
+        {
+            (void)memcpy(signals, &segment->signals, sizeof(*signals));
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&segment->seq, __ATOMIC_RELAXED) == before)
+            {
+                return true;
+            }
+        }
+        (void)sched_yield();
+    }
+    return false;
+}
+
+void live_state_close(LiveState *live)
+{
+    if (live->segment == NULL)
+    {
+        return;
+    }
+    (void)munmap(live->segment, sizeof(LiveSegment));
+    if (live->owner)
+    {
+        (void)shm_unlink(live->name);
+    }
+    live->segment = NULL;
+    live->owner = false;
+}
@@ -0,0 +1,97 @@
+#ifndef LIVE_STATE_H
+#define LIVE_STATE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Live ECU state in POSIX shared memory, for monitors that should not have to
+ * join the bus and decrypt it.
+ *
+ * Each ECU owns one segment, "/ecu_live_<name>", holding its current signals.
+ * Updates are protected by a sequence lock: the writer makes the sequence odd,
+ * copies the new state and makes it even again. A reader copies the state
+ * between two reads of the sequence and retries if they differ or are odd, so
+ * it never blocks the ECU and never sees a half-written update. There is one
+ * writer per segment; ECUs updating it from several threads serialize the
+ * calls with their own mutex.
+ */
+#define LIVE_STATE_MAGIC        (0x4556494CU)   // "LIVE"
+#define LIVE_STATE_VERSION      (2U)
+#define LIVE_STATE_NAME_SIZE    (64)
+#define LIVE_STATE_ECU_SIZE     (32)
+#define LIVE_STATE_READ_TRIES   (1000U)
+
+// Groups of fields an ECU fills in (LiveSignals.present)
+#define LIVE_HAS_SIGNALS        (1U << 0U)  // Vehicle signals
+#define LIVE_HAS_STOP_START     (1U << 1U)  // Stop/Start enable, engine state
+#define LIVE_HAS_FAULTS         (1U << 2U)  // System error, fault flags
+#define LIVE_HAS_STEP           (1U << 3U)  // Drive cycle step
+#define LIVE_HAS_COMMANDS       (1U << 4U)  // Driver commands sent
+#define LIVE_HAS_SAVINGS        (1U << 5U)  // Stop/Start fuel savings
+
+typedef struct {
+    int64_t time_ms;            // CLOCK_MONOTONIC time of the update
+    uint64_t updates;           // Updates published since the segment was created
+    uint32_t present;           // LIVE_HAS_* groups valid in this update
+    int32_t step;
+    double speed;
+    double tilt_angle;
+    double batt_soc;
+    double batt_volt;
+    double engi_temp;
+    int32_t internal_temp;
+    int32_t external_temp;
+    int32_t temp_set;
+    int32_t door_open;
+    int32_t accel;
+    int32_t brake;
+    int32_t gear;
+    uint8_t start_stop_active;
+    uint8_t engine_off;
+    uint8_t restart_trigger;
+    uint8_t error_system;
+    uint32_t cond_bits;         // Powertrain engine-off conditions satisfied
+    uint32_t fault_flags;       // BCM HEALTH_FAULT_* raised by the last step
+    uint32_t commands;          // Instrument cluster commands sent
+    double engine_off_s;        // Stop/Start savings since the powertrain started
+    double fuel_saved_ml;
+    double co2_saved_g;
+} LiveSignals;
+
+typedef struct {
+    uint32_t magic;             // Written last by the creator
+    uint32_t version;
+    uint32_t size;              // sizeof(LiveSegment) of the creator
+    uint32_t seq;               // Odd while an update is being written
+    char ecu[LIVE_STATE_ECU_SIZE];
+    LiveSignals signals;
+} LiveSegment;
+
+typedef struct {
+    LiveSegment *segment;       // NULL: not open, publishing is a no-op
+    bool owner;                 // Created the segment, removes it on close
+    char name[LIVE_STATE_NAME_SIZE];
+} LiveState;
+
+// Build the shared memory object name of ecu_name
+void live_state_name(const char *ecu_name, char *name, size_t size);
+
+// Create (or take over) the segment of ecu_name and map it for writing
+bool live_state_create(LiveState *live, const char *ecu_name);
+
+// Map an existing segment read-only; false if missing or incompatible
+bool live_state_attach(LiveState *live, const char *ecu_name);
+
+/* Publish a new state: stamps time_ms and updates. No-op if live is not
+   open, so ECU code may publish unconditionally. */
+void live_state_publish(LiveState *live, LiveSignals *signals);
+
+// Copy a consistent state; false if the writer stayed mid-update
+bool live_state_read(const LiveState *live, LiveSignals *signals);
+
+// Unmap; the owner also removes the segment
+void live_state_close(LiveState *live);
+
+#endif // LIVE_STATE_H
@@ -0,0 +1,206 @@
+#include "metrics.h"
+#include "atomic_file.h"
+#include "ecu_stats.h"
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CACHE_LINE_SIZE     (64)
+#define METRICS_LINE_SIZE   (256)
+#define METRICS_NAME_SIZE   (64)
+
+typedef struct MetricsShard {
+    uint64_t counts[METRIC_COUNT];
+    struct MetricsShard *next;
+} __attribute__((aligned(CACHE_LINE_SIZE))) MetricsShard;
+
+typedef struct {
+    const char *name;
+    const char *help;
+} MetricInfo;
+
+static const MetricInfo metric_info[METRIC_COUNT] = {
+    [METRIC_FRAMES_SENT]        = { "ecu_frames_sent_total", "CAN frames written to a socket." },
+    [METRIC_FRAMES_RECEIVED]    = { "ecu_frames_received_total", "CAN frames read from a socket." },
+    [METRIC_FRAMES_FILTERED]    = { "ecu_frames_filtered_total", "Received CAN frames with an ID this ECU ignores." },
+    [METRIC_FRAMES_ACCEPTED]    = { "ecu_frames_accepted_total", "Received CAN frames with an ID this ECU listens to." },
+    [METRIC_MESSAGES_PROCESSED] = { "ecu_messages_processed_total", "Messages decrypted and handed to the parser." },
+    [METRIC_DECRYPT_FAILURES]   = { "ecu_decrypt_failures_total", "Messages failing authentication or replayed." },
+    [METRIC_REASSEMBLY_ERRORS]  = { "ecu_reassembly_errors_total", "Fragments or partial messages discarded by reassembly." },
+    [METRIC_BUFFER_DROPS]       = { "ecu_buffer_drops_total", "Received messages lost because a queue was full." },
+    [METRIC_ENGINE_OFF_EVENTS]  = { "ecu_engine_off_events_total", "Engine stops commanded by Stop/Start." },
+    [METRIC_RESTART_FAILURES]   = { "ecu_restart_failures_total", "Engine restarts refused for low battery." },
+    [METRIC_LOOP_OVERRUNS]      = { "ecu_loop_overruns_total", "Periodic loop periods over their target plus tolerance." },
+};
+
+// Shards are only ever prepended, so readers can walk the list without the lock
+static MetricsShard *shards = NULL;
+static pthread_mutex_t shards_mutex = PTHREAD_MUTEX_INITIALIZER;
+static __thread MetricsShard *tls_shard = NULL;
+
+static char metrics_ecu[METRICS_ECU_SIZE];
+static char metrics_file[METRICS_PATH_SIZE];
+static long long last_flush_ms = 0;
+static pthread_mutex_t flush_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static MetricsShard *own_shard(void)
+{
+    if (tls_shard == NULL)
+    {
+        MetricsShard *shard = (MetricsShard *)aligned_alloc(CACHE_LINE_SIZE, sizeof(MetricsShard));
+        if (shard == NULL)
+        {
+            return NULL;
+        }
+        (void)memset(shard, 0, sizeof(*shard));
+        (void)pthread_mutex_lock(&shards_mutex);
+        shard->next = shards;
+        __atomic_store_n(&shards, shard, __ATOMIC_RELEASE);
+        (void)pthread_mutex_unlock(&shards_mutex);
+        tls_shard = shard;
+    }
+    return tls_shard;
+}
+
+void metrics_inc(MetricId id)
+{
+    metrics_add(id, 1U);
+}
+
+void metrics_add(MetricId id, uint64_t count)
+{
+    MetricsShard *shard = own_shard();
+
+    if ((shard == NULL) || ((unsigned int)id >= (unsigned int)METRIC_COUNT))
+    {
+        return;
+    }
+    // Only this thread writes its shard: a plain load and store, no lock prefix
+    const uint64_t total = __atomic_load_n(&shard->counts[id], __ATOMIC_RELAXED);
+    __atomic_store_n(&shard->counts[id], total + count, __ATOMIC_RELAXED);
+}
+
+uint64_t metrics_get(MetricId id)
+{
+    uint64_t total = 0U;
+
+    if ((unsigned int)id >= (unsigned int)METRIC_COUNT)
+    {
+        return 0U;
+    }
+    for (const MetricsShard *shard = __atomic_load_n(&shards, __ATOMIC_ACQUIRE); shard != NULL;
+         shard = shard->next)
+    {
+        total += __atomic_load_n(&shard->counts[id], __ATOMIC_RELAXED);
+    }
+    return total;
+}
+
+const char *metrics_name(MetricId id)
+{
+    return ((unsigned int)id < (unsigned int)METRIC_COUNT) ? metric_info[id].name : "";
+}
+
+void metrics_file_path(const char *ecu_name, char *path, unsigned long size)
+{
+    const char *dir = getenv(ECU_STATS_DIR_ENV);
+
+    if ((dir == NULL) || (dir[0] == '\0'))
+    {
+        dir = ECU_STATS_DEFAULT_DIR;
+    }
+    (void)snprintf(path, size, "%s/ecu_metrics_%s.prom", dir, ecu_name);
+}
+
+void metrics_init(const char *ecu_name)
+{
+    (void)pthread_mutex_lock(&flush_mutex);
+    (void)snprintf(metrics_ecu, sizeof(metrics_ecu), "%s", ecu_name);
+    metrics_file_path(ecu_name, metrics_file, sizeof(metrics_file));
+    last_flush_ms = 0;
+    (void)pthread_mutex_unlock(&flush_mutex);
+}
+
+const char *metrics_path(void)
+{
+    return metrics_file;
+}
+
+static bool write_exposition(void)
+{
+    AtomicFile atomic;
+    FILE *file = atomic_file_open(&atomic, metrics_file);
+    if (file == NULL)
+    {
+        return false;
+    }
+    for (unsigned int id = 0U; id < (unsigned int)METRIC_COUNT; id++)
+    {
+        (void)fprintf(file, "# HELP %s %s\n# TYPE %s counter\n%s{ecu=\"%s\"} %" PRIu64 "\n",
+                      metric_info[id].name, metric_info[id].help, metric_info[id].name,
+                      metric_info[id].name, metrics_ecu, metrics_get((MetricId)id));
+    }
+    return atomic_file_commit(&atomic, false);
+}
+
+bool metrics_write(void)
+{
+    bool written = false;
+
+    (void)pthread_mutex_lock(&flush_mutex);
+    if (metrics_file[0] != '\0')
+    {
+        written = write_exposition();
+    }
+    (void)pthread_mutex_unlock(&flush_mutex);
+    return written;
+}
+
+void metrics_flush(long long now_ms)
+{
+    // Loops of other threads may flush at the same time: one of them writes
+    if (pthread_mutex_trylock(&flush_mutex) != 0)
+    {
+        return;
+    }
+    if ((metrics_file[0] != '\0') && ((now_ms - last_flush_ms) >= ECU_STATS_FLUSH_MS))
+    {
+        last_flush_ms = now_ms;
+        (void)write_exposition();
+    }
+    (void)pthread_mutex_unlock(&flush_mutex);
+}
+
+bool metrics_read(const char *path, uint64_t counts[METRIC_COUNT])
+{
+    FILE *file = fopen(path, "r");
+    char line[METRICS_LINE_SIZE];
+    char name[METRICS_NAME_SIZE];
+    uint64_t value = 0U;
+
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    (void)memset(counts, 0, METRIC_COUNT * sizeof(counts[0]));
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        // Samples only: "<name>{ecu="<ecu>"} <value>", comments start with '#'
+        if ((line[0] == '#') || (sscanf(line, "%63[^{ ]%*[^ ] %" SCNu64, name, &value) != 2))
+        {
+            continue;
+        }
+        for (unsigned int id = 0U; id < (unsigned int)METRIC_COUNT; id++)
+        {
+            if (strcmp(name, metric_info[id].name) == 0)
+            {
+                counts[id] = value;
+            }
+        }
+    }
+    (void)fclose(file);
+    return true;
+}
@@ -0,0 +1,71 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Runtime counters shared by all ECUs, exported in the Prometheus text format.
+ *
+ * Every thread counts into its own cache-line aligned shard, created on its
+ * first increment, so the hot paths never share a written cache line and need
+ * no locked instruction. Shards are only summed when the counters are read or
+ * exported. They are kept after their thread exits, so no count is lost.
+ *
+ * metrics_init names the ECU and sets the output file,
+ * "<dir>/ecu_metrics_<name>.prom" (dir from ECU_STATS_DIR, see ecu_stats.h).
+ * metrics_flush rewrites it at most every ECU_STATS_FLUSH_MS, from a loop the
+ * ECU already runs, on the CLOCK_MONOTONIC milliseconds of timer_wheel_now_ms.
+ * Counting works without metrics_init; only the export is skipped.
+ */
+#define METRICS_PATH_SIZE       (256)
+#define METRICS_ECU_SIZE        (32)
+
+typedef enum {
+    METRIC_FRAMES_SENT = 0,     // CAN frames written to a socket
+    METRIC_FRAMES_RECEIVED,     // CAN frames read from a socket
+    METRIC_FRAMES_FILTERED,     // Received frames with a CAN ID the ECU ignores
+    METRIC_FRAMES_ACCEPTED,     // Received frames with a CAN ID the ECU listens to
+    METRIC_MESSAGES_PROCESSED,  // Messages decrypted and handed to the parser
+    METRIC_DECRYPT_FAILURES,    // Messages failing authentication or replayed
+    METRIC_REASSEMBLY_ERRORS,   // Fragments or partial messages discarded
+    METRIC_BUFFER_DROPS,        // Messages lost because a queue was full
+    METRIC_ENGINE_OFF_EVENTS,   // Engine stopped by Stop/Start
+    METRIC_RESTART_FAILURES,    // Restart refused (battery)
+    METRIC_LOOP_OVERRUNS,       // Periodic loop periods longer than allowed
+    METRIC_COUNT
+} MetricId;
+
+// Count one event in the calling thread's shard
+void metrics_inc(MetricId id);
+
+// Count several events at once (e.g. the counters of a restored checkpoint)
+void metrics_add(MetricId id, uint64_t count);
+
+// Current total of one counter over all threads
+uint64_t metrics_get(MetricId id);
+
+// Prometheus name of a counter (e.g. "ecu_frames_sent_total")
+const char *metrics_name(MetricId id);
+
+// Set the ECU label and the export file path
+void metrics_init(const char *ecu_name);
+
+// Write the exposition file now (temporary file, then rename)
+bool metrics_write(void);
+
+/* Write the exposition file if the last write is older than ECU_STATS_FLUSH_MS.
+   now_ms is timer_wheel_now_ms() for every caller: there is a single
+   last-write time per process. */
+void metrics_flush(long long now_ms);
+
+// Export file path (empty until metrics_init)
+const char *metrics_path(void);
+
+// Build the export file path of ecu_name
+void metrics_file_path(const char *ecu_name, char *path, unsigned long size);
+
+// Read back an exposition file into counts; false if the file is missing
+bool metrics_read(const char *path, uint64_t counts[METRIC_COUNT]);
+
+#endif // METRICS_H
@@ -0,0 +1,351 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE     // CPU affinity (cpu_set_t, pthread_setaffinity_np)
+#endif
+#include "rt_sched.h"
+#include "atomic_file.h"
+#include "ecu_stats.h"
+#include "metrics.h"
+#include <errno.h>
+#include <malloc.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#define NSEC_PER_SEC        (1000000000LL)
+#define NSEC_PER_US         (1000LL)
+#define DECIMAL_BASE        (10)
+#define OVERRUN_TOLERANCE   (10LL)      // A period over target + target/10 is an overrun
+
+static RtConfig rt_config;
+
+long long rt_now_ns(void)
+{
+    struct timespec now;
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((long long)now.tv_sec * NSEC_PER_SEC) + now.tv_nsec;
+}
+
+static bool parse_int(const char *text, long *value)
+{
+    char *end = NULL;
+
+    errno = 0;
+    *value = strtol(text, &end, DECIMAL_BASE);
+    return (errno == 0) && (end != text) && (*end == '\0');
+}
+
+// "0,2-3" -> {0, 2, 3}
+static bool parse_cpus(const char *text, RtConfig *config)
+{
+    char list[RT_MAX_CPUS * 4U];
+    char *save = NULL;
+
+    if (strlen(text) >= sizeof(list))
+    {
+        return false;
+    }
+    (void)strcpy(list, text);
+
+    for (char *item = strtok_r(list, ",", &save); item != NULL; item = strtok_r(NULL, ",", &save))
+    {
+        long first = 0;
+        long last = 0;
+        char *dash = strchr(item, '-');
+
+        if (dash != NULL)
+        {
+            *dash = '\0';
+            if (!parse_int(item, &first) || !parse_int(dash + 1, &last))
+            {
+                return false;
+            }
+        }
+        else if (parse_int(item, &first))
+        {
+            last = first;
+        }
+        else
+        {
+            return false;
+        }
+        if ((first < 0) || (last < first) || (last >= CPU_SETSIZE))
+        {
+            return false;
+        }
+        for (long cpu = first; cpu <= last; cpu++)
+        {
+            if (config->num_cpus == RT_MAX_CPUS)
+            {
+                return false;
+            }
+            config->cpus[config->num_cpus++] = (int)cpu;
+        }
+    }
+    return config->num_cpus > 0U;
+}
+
+bool rt_config_load(RtConfig *config)
+{
+    const char *enable = getenv(RT_ENABLE_ENV);
+    const char *cpus = getenv(RT_CPUS_ENV);
+    const char *priority = getenv(RT_PRIORITY_ENV);
+    long value = 0;
+
+    (void)memset(config, 0, sizeof(*config));
+    config->priority = RT_DEFAULT_PRIORITY;
+    if ((enable == NULL) || (strcmp(enable, "1") != 0))
+    {
+        return true;
+    }
+
+    if ((priority != NULL) && (priority[0] != '\0'))
+    {
+        if (!parse_int(priority, &value) || (value < sched_get_priority_min(SCHED_FIFO)) ||
+            (value > sched_get_priority_max(SCHED_FIFO)))
+        {
+            (void)fprintf(stderr, "RT mode: invalid %s \"%s\"\n", RT_PRIORITY_ENV, priority);
+            return false;
+        }
+        config->priority = (int)value;
+    }
+    if ((cpus != NULL) && (cpus[0] != '\0') && !parse_cpus(cpus, config))
+    {
+        (void)fprintf(stderr, "RT mode: invalid %s \"%s\"\n", RT_CPUS_ENV, cpus);
+        config->num_cpus = 0U;
+        return false;
+    }
+    config->enabled = true;
+    return true;
+}
+
+void rt_prefault(void *buf, size_t len)
+{
+    volatile unsigned char *bytes = (volatile unsigned char *)buf;
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+
+    for (size_t i = 0U; i < len; i += page)
+    {
+        bytes[i] = bytes[i];
+    }
+    if (len > 0U)
+    {
+        bytes[len - 1U] = bytes[len - 1U];
+    }
+}
+
+// Grow the stack of the calling thread now rather than in its loop
+static __attribute__((noinline)) void prefault_stack(void)
+{
+    unsigned char stack[RT_STACK_PREFAULT];
+
+    (void)memset(stack, 0, sizeof(stack));
+    rt_prefault(stack, sizeof(stack));
+}
+
+bool rt_init(const char *ecu_name)
+{
+    if (!rt_config_load(&rt_config))
+    {
+        return false;
+    }
+    if (!rt_config.enabled)
+    {
+        return true;
+    }
+
+    bool applied = true;
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+    {
+        perror("RT mode: mlockall");
+        applied = false;
+    }
+
+    /* Freed heap stays mapped and locked: no allocation may reach mmap or
+       hand pages back, so the reserve faulted here is reused afterwards */
+    (void)mallopt(M_TRIM_THRESHOLD, -1);
+    (void)mallopt(M_MMAP_MAX, 0);
+    void *reserve = malloc(RT_HEAP_PREFAULT);
+    if (reserve != NULL)
+    {
+        rt_prefault(reserve, RT_HEAP_PREFAULT);
+        free(reserve);
+    }
+    prefault_stack();
+
+    (void)printf("%s: RT mode, base priority %d, %zu CPU(s) pinned\n", ecu_name,
+                 rt_config.priority, rt_config.num_cpus);
+    (void)fflush(stdout);
+    return applied;
+}
+
+bool rt_enabled(void)
+{
+    return rt_config.enabled;
+}
+
+bool rt_configure_thread(const char *name, size_t index, int priority_offset)
+{
+    bool applied = true;
+    int error = 0;
+
+    if (!rt_config.enabled)
+    {
+        return true;
+    }
+
+    if (rt_config.num_cpus > 0U)
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(rt_config.cpus[index % rt_config.num_cpus], &cpus);
+        error = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        if (error != 0)
+        {
+            (void)fprintf(stderr, "RT mode: pinning %s to CPU %d: %s\n", name,
+                          rt_config.cpus[index % rt_config.num_cpus], strerror(error));
+            applied = false;
+        }
+    }
+
+    struct sched_param param;
+    const int max_priority = sched_get_priority_max(SCHED_FIFO);
+    const int min_priority = sched_get_priority_min(SCHED_FIFO);
+    int priority = rt_config.priority + priority_offset;
+    priority = (priority > max_priority) ? max_priority : priority;
+    priority = (priority < min_priority) ? min_priority : priority;
+    (void)memset(&param, 0, sizeof(param));
+    param.sched_priority = priority;
+    error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (error != 0)
+    {
+        (void)fprintf(stderr, "RT mode: SCHED_FIFO %d for %s: %s\n", priority, name,
+                      strerror(error));
+        applied = false;
+    }
+
+    prefault_stack();
+    return applied;
+}
+
+void rt_jitter_init(RtJitterReport *report, const char *ecu_name)
+{
+    const char *dir = getenv(ECU_STATS_DIR_ENV);
+
+    (void)memset(report, 0, sizeof(*report));
+    (void)pthread_mutex_init(&report->lock, NULL);
+    if ((dir == NULL) || (dir[0] == '\0'))
+    {
+        dir = ECU_STATS_DEFAULT_DIR;
+    }
+    (void)snprintf(report->path, sizeof(report->path), "%s/ecu_jitter_%s.txt", dir, ecu_name);
+}
+
+RtLoop *rt_jitter_add(RtJitterReport *report, const char *name, long long target_us)
+{
+    RtLoop *loop = NULL;
+
+    (void)pthread_mutex_lock(&report->lock);
+    if (report->num_loops < RT_MAX_LOOPS)
+    {
+        loop = &report->loops[report->num_loops++];
+        (void)memset(loop, 0, sizeof(*loop));
+        (void)snprintf(loop->name, sizeof(loop->name), "%s", name);
+        loop->target_us = target_us;
+    }
+    (void)pthread_mutex_unlock(&report->lock);
+    return loop;
+}
+
+// Write a copy of the loops, so the ticking threads never wait on the file
+static bool write_report(const char *path, const RtLoop *loops, size_t num_loops)
+{
+    AtomicFile atomic;
+    FILE *file = atomic_file_open(&atomic, path);
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    (void)fprintf(file, "# loop target_us periods min_us mean_us max_us mean_abs_err_us max_abs_err_us\n");
+    for (size_t i = 0U; i < num_loops; i++)
+    {
+        const RtLoop *loop = &loops[i];
+        const long long divisor = (loop->periods > 0UL) ? (long long)loop->periods : 1LL;
+
+        (void)fprintf(file, "%s %lld %lu %lld %lld %lld %lld %lld\n", loop->name, loop->target_us,
+                      loop->periods, loop->min_us, loop->sum_us / divisor, loop->max_us,
+                      loop->sum_abs_error_us / divisor, loop->max_abs_error_us);
+    }
+    return atomic_file_commit(&atomic, false);
+}
+
+bool rt_jitter_write(RtJitterReport *report)
+{
+    RtLoop loops[RT_MAX_LOOPS];
+
+    if (report->path[0] == '\0')
+    {
+        return false;
+    }
+    (void)pthread_mutex_lock(&report->lock);
+    const size_t num_loops = report->num_loops;
+    (void)memcpy(loops, report->loops, num_loops * sizeof(loops[0]));
+    (void)pthread_mutex_unlock(&report->lock);
+    return write_report(report->path, loops, num_loops);
+}
+
+void rt_jitter_flush(RtJitterReport *report, long long now_ms)
+{
+    if ((report == NULL) || (report->path[0] == '\0'))
+    {
+        return;
+    }
+    // Only the ECU's flush loop calls this: last_flush_ms needs no lock
+    if ((now_ms - report->last_flush_ms) >= ECU_STATS_FLUSH_MS)
+    {
+        report->last_flush_ms = now_ms;
+        (void)rt_jitter_write(report);
+    }
+}
+
+void rt_loop_tick(RtJitterReport *report, RtLoop *loop, long long now_ns)
+{
+    if ((report == NULL) || (loop == NULL))
+    {
+        return;
+    }
+
+    (void)pthread_mutex_lock(&report->lock);
+    if (loop->last_ns != 0)
+    {
+        const long long period_us = (now_ns - loop->last_ns) / NSEC_PER_US;
+        long long error_us = period_us - loop->target_us;
+        error_us = (error_us < 0) ? -error_us : error_us;
+
+        if ((loop->periods == 0UL) || (period_us < loop->min_us))
+        {
+            loop->min_us = period_us;
+        }
+        if (period_us > loop->max_us)
+        {
+            loop->max_us = period_us;
+        }
+        if (error_us > loop->max_abs_error_us)
+        {
+            loop->max_abs_error_us = error_us;
+        }
+        if (period_us > (loop->target_us + (loop->target_us / OVERRUN_TOLERANCE)))
+        {
+            metrics_inc(METRIC_LOOP_OVERRUNS);
+        }
+        loop->sum_us += period_us;
+        loop->sum_abs_error_us += error_us;
+        loop->periods++;
+    }
+    loop->last_ns = now_ns;
+    (void)pthread_mutex_unlock(&report->lock);
+}
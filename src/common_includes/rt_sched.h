@@ -0,0 +1,104 @@
+#ifndef RT_SCHED_H
+#define RT_SCHED_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Opt-in real-time mode and loop jitter report, shared by the four ECUs.
+ *
+ * RT mode is off unless ECU_RT=1. When on, rt_init locks all current and future
+ * memory (mlockall), keeps freed heap mapped and pre-faults the main stack and a
+ * heap reserve, so no page fault lands in a periodic loop. Each ECU thread then
+ * calls rt_configure_thread, which pins it to the next CPU of ECU_RT_CPUS
+ * (round-robin, unpinned if unset), gives it SCHED_FIFO at ECU_RT_PRIORITY plus
+ * its offset and pre-faults its stack. Failures (no CAP_SYS_NICE, bad CPU) are
+ * reported once and the ECU keeps running best effort.
+ *
+ * The jitter report is independent of RT mode, so both can be compared: every
+ * periodic loop ticks an RtLoop once per period, and the measured period is
+ * compared to the loop's target. The report of all loops of an ECU is written
+ * to "<dir>/ecu_jitter_<name>.txt" (dir from ECU_STATS_DIR, as the metrics) by
+ * rt_jitter_flush, from the loop that already flushes the ECU metrics, at most
+ * every ECU_STATS_FLUSH_MS. A tick only updates the counters, so no file I/O
+ * lands in a measured period.
+ */
+#define RT_ENABLE_ENV           "ECU_RT"
+#define RT_CPUS_ENV             "ECU_RT_CPUS"
+#define RT_PRIORITY_ENV         "ECU_RT_PRIORITY"
+#define RT_DEFAULT_PRIORITY     (50)
+#define RT_MAX_CPUS             (64U)
+#define RT_STACK_PREFAULT       (256U * 1024U)
+#define RT_HEAP_PREFAULT        (4U * 1024U * 1024U)
+
+#define RT_MAX_LOOPS            (8U)
+#define RT_LOOP_NAME_SIZE       (32)
+#define RT_REPORT_PATH_SIZE     (256)
+
+typedef struct {
+    bool enabled;
+    int priority;                   // Base SCHED_FIFO priority
+    int cpus[RT_MAX_CPUS];
+    size_t num_cpus;                // 0: threads are not pinned
+} RtConfig;
+
+typedef struct {
+    char name[RT_LOOP_NAME_SIZE];
+    long long target_us;
+    long long last_ns;              // Previous tick, 0 before the first one
+    unsigned long periods;
+    long long min_us;
+    long long max_us;
+    long long sum_us;
+    long long sum_abs_error_us;
+    long long max_abs_error_us;
+} RtLoop;
+
+typedef struct {
+    RtLoop loops[RT_MAX_LOOPS];
+    size_t num_loops;
+    long long last_flush_ms;
+    pthread_mutex_t lock;
+    char path[RT_REPORT_PATH_SIZE];
+} RtJitterReport;
+
+// Parse the RT environment variables; false (and disabled) on a malformed value
+bool rt_config_load(RtConfig *config);
+
+/* Load the configuration and, in RT mode, lock and pre-fault memory.
+   Returns false if RT mode was asked for but could not be fully applied. */
+bool rt_init(const char *ecu_name);
+
+// Whether rt_init enabled RT mode
+bool rt_enabled(void);
+
+/* Pin the calling thread to CPU number index (round-robin over ECU_RT_CPUS),
+   set SCHED_FIFO at the base priority + priority_offset and pre-fault its
+   stack. No-op outside RT mode. */
+bool rt_configure_thread(const char *name, size_t index, int priority_offset);
+
+// Touch every page of a buffer so later accesses do not fault
+void rt_prefault(void *buf, size_t len);
+
+// Start an empty report for ecu_name
+void rt_jitter_init(RtJitterReport *report, const char *ecu_name);
+
+// Register a loop with its target period; NULL when the report is full
+RtLoop *rt_jitter_add(RtJitterReport *report, const char *name, long long target_us);
+
+/* Record one period of loop ending at now_ns (CLOCK_MONOTONIC). loop may be
+   NULL (jitter not tracked). */
+void rt_loop_tick(RtJitterReport *report, RtLoop *loop, long long now_ns);
+
+// Write the report now (temporary file, then rename)
+bool rt_jitter_write(RtJitterReport *report);
+
+/* Write the report if the last write is older than ECU_STATS_FLUSH_MS
+   (now_ms from CLOCK_MONOTONIC). Called from a single thread per report. */
+void rt_jitter_flush(RtJitterReport *report, long long now_ms);
+
+// CLOCK_MONOTONIC in nanoseconds
+long long rt_now_ns(void);
+
+#endif // RT_SCHED_H
@@ -0,0 +1,261 @@
+#include "sensor_noise.h"
+#include "drive_cycle.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHANNELS_PER_SIGNAL (4U)
+#define CHANNEL_GAUSS       (0U)        // And the next one
+#define CHANNEL_JITTER      (2U)
+#define CHANNEL_DROPOUT     (3U)
+#define NOISE_MAX_DELAY     (600UL)     // Steps, 10 minutes at 1 Hz
+#define SPEC_KEY_SIZE       (16U)
+#define TWO_PI              (6.283185307179586)
+
+typedef struct {
+    const char *name;
+    bool integer;
+} TraceSignalInfo;
+
+static const TraceSignalInfo trace_signals[TRACE_SIGNAL_COUNT] = {
+    [TRACE_SPEED]         = { "speed",         false },
+    [TRACE_INTERNAL_TEMP] = { "internal_temp", true },
+    [TRACE_EXTERNAL_TEMP] = { "external_temp", true },
+    [TRACE_DOOR_OPEN]     = { "door_open",     true },
+    [TRACE_TILT_ANGLE]    = { "tilt_angle",    false },
+    [TRACE_ACCEL]         = { "accel",         true },
+    [TRACE_BRAKE]         = { "brake",         true },
+    [TRACE_TEMP_SET]      = { "temp_set",      true },
+    [TRACE_BATT_SOC]      = { "batt_soc",      false },
+    [TRACE_BATT_VOLT]     = { "batt_volt",     false },
+    [TRACE_ENGI_TEMP]     = { "engi_temp",     false },
+    [TRACE_GEAR]          = { "gear",          true }
+};
+
+bool signal_trace_alloc(SignalTrace *trace, size_t steps)
+{
+    (void)memset(trace, 0, sizeof(*trace));
+    trace->steps = steps;
+    for (size_t i = 0U; i < TRACE_SIGNAL_COUNT; i++)
+    {
+        trace->values[i] = (double *)calloc((steps > 0U) ? steps : 1U, sizeof(double));
+        if (trace->values[i] == NULL)
+        {
+            signal_trace_free(trace);
+            return false;
+        }
+    }
+    return true;
+}
+
+void signal_trace_free(SignalTrace *trace)
+{
+    for (size_t i = 0U; i < TRACE_SIGNAL_COUNT; i++)
+    {
+        free(trace->values[i]);
+        trace->values[i] = NULL;
+    }
+    trace->steps = 0U;
+}
+
+const char *signal_trace_name(TraceSignal signal)
+{
+    return ((unsigned int)signal < TRACE_SIGNAL_COUNT) ? trace_signals[signal].name : NULL;
+}
+
+int signal_trace_find(const char *name)
+{
+    for (int i = 0; i < (int)TRACE_SIGNAL_COUNT; i++)
+    {
+        if (strcmp(trace_signals[i].name, name) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void noise_config_clear(NoiseConfig *config)
+{
+    (void)memset(config, 0, sizeof(*config));
+}
+
+static bool parse_setting(NoiseModel *model, const char *key, const char *value)
+{
+    char *end = NULL;
+
+    if ((strcmp(key, "latency") == 0) || (strcmp(key, "jitter") == 0))
+    {
+        const unsigned long steps = strtoul(value, &end, 10);
+        if ((end == value) || (*end != '\0') || (value[0] == '-') || (steps > NOISE_MAX_DELAY))
+        {
+            return false;
+        }
+        if (key[0] == 'l')
+        {
+            model->latency = (unsigned int)steps;
+        }
+        else
+        {
+            model->jitter = (unsigned int)steps;
+        }
+        return true;
+    }
+
+    const double number = strtod(value, &end);
+    if ((end == value) || (*end != '\0') || !isfinite(number))
+    {
+        return false;
+    }
+    if (strcmp(key, "bias") == 0)
+    {
+        model->bias = number;
+    }
+    else if ((strcmp(key, "sigma") == 0) && (number >= 0.0))
+    {
+        model->sigma = number;
+    }
+    else if ((strcmp(key, "dropout") == 0) && (number >= 0.0) && (number <= 1.0))
+    {
+        model->dropout = number;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+bool noise_config_parse(NoiseConfig *config, const char *spec, const char **error)
+{
+    const char *colon = strchr(spec, ':');
+    NoiseModel model;
+    int signal = -1;
+
+    *error = NULL;
+    if (colon == NULL)
+    {
+        *error = "expected signal:key=value[,key=value...]";
+        return false;
+    }
+    const size_t name_len = (size_t)(colon - spec);
+    const bool all = (name_len == 3U) && (strncmp(spec, "all", 3U) == 0);
+    for (int i = 0; (i < (int)TRACE_SIGNAL_COUNT) && !all; i++)
+    {
+        if ((strlen(trace_signals[i].name) == name_len) && (strncmp(trace_signals[i].name, spec, name_len) == 0))
+        {
+            signal = i;
+        }
+    }
+    if (!all && (signal < 0))
+    {
+        *error = "unknown signal";
+        return false;
+    }
+
+    // Settings apply on top of the current model (of each signal for "all")
+    for (int i = 0; i < (int)TRACE_SIGNAL_COUNT; i++)
+    {
+        if (!all && (i != signal))
+        {
+            continue;
+        }
+        model = config->models[i];
+        const char *item = colon + 1;
+        while (*item != '\0')
+        {
+            char key[SPEC_KEY_SIZE];
+            char value[SPEC_KEY_SIZE * 2U];
+            const size_t item_len = strcspn(item, ",");
+            const char *equals = memchr(item, '=', item_len);
+            if ((equals == NULL) || ((size_t)(equals - item) >= sizeof(key)) ||
+                ((item_len - (size_t)(equals - item) - 1U) >= sizeof(value)))
+            {
+                *error = "expected key=value";
+                return false;
+            }
+            (void)memcpy(key, item, (size_t)(equals - item));
+            key[equals - item] = '\0';
+            (void)memcpy(value, equals + 1, item_len - (size_t)(equals - item) - 1U);
+            value[item_len - (size_t)(equals - item) - 1U] = '\0';
+            if (!parse_setting(&model, key, value))
+            {
+                *error = "bad setting (bias, sigma>=0, dropout 0..1, latency, jitter 0..600)";
+                return false;
+            }
+            item += item_len;
+            if (*item == ',')
+            {
+                item++;
+            }
+        }
+        config->models[i] = model;
+    }
+    return true;
+}
+
+double sensor_noise_gaussian(uint64_t key, uint32_t row, unsigned int channel)
+{
+    // Box-Muller; 1 - u is in (0, 1] so the logarithm is finite
+    const double radius = sqrt(-2.0 * log(1.0 - drive_cycle_uniform(key, row, channel)));
+    return radius * cos(TWO_PI * drive_cycle_uniform(key, row, channel + 1U));
+}
+
+static bool model_is_clean(const NoiseModel *model)
+{
+    return (model->bias == 0.0) && (model->sigma == 0.0) && (model->dropout == 0.0) &&
+           (model->latency == 0U) && (model->jitter == 0U);
+}
+
+/**
+ * @brief Perturb every signal of a clean trace with its noise model.
+ * @requirement SWR2.2
+ */
+void sensor_noise_apply(const SignalTrace *clean, const NoiseConfig *config, uint64_t key,
+                        SignalTrace *noisy)
+{
+    const size_t steps = (clean->steps < noisy->steps) ? clean->steps : noisy->steps;
+
+    for (unsigned int sig = 0U; sig < TRACE_SIGNAL_COUNT; sig++)
+    {
+        const NoiseModel *model = &config->models[sig];
+        const double *in = clean->values[sig];
+        double *out = noisy->values[sig];
+        const unsigned int channel = sig * CHANNELS_PER_SIGNAL;
+
+        if (model_is_clean(model))
+        {
+            (void)memcpy(out, in, steps * sizeof(double));
+            continue;
+        }
+
+        // Every step is independent here: delay, bias, noise, rounding
+        for (size_t s = 0U; s < steps; s++)
+        {
+            size_t delay = model->latency;
+            if (model->jitter > 0U)
+            {
+                delay += (size_t)(drive_cycle_uniform(key, (uint32_t)s, channel + CHANNEL_JITTER) *
+                                  (double)(model->jitter + 1U));
+            }
+            double value = in[(s > delay) ? (s - delay) : 0U] + model->bias;
+            if (model->sigma > 0.0)
+            {
+                value += model->sigma * sensor_noise_gaussian(key, (uint32_t)s, channel + CHANNEL_GAUSS);
+            }
+            out[s] = trace_signals[sig].integer ? nearbyint(value) : value;
+        }
+
+        // A lost sample holds the last one received
+        if (model->dropout > 0.0)
+        {
+            for (size_t s = 1U; s < steps; s++)
+            {
+                if (drive_cycle_uniform(key, (uint32_t)s, channel + CHANNEL_DROPOUT) < model->dropout)
+                {
+                    out[s] = out[s - 1U];
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef SENSOR_NOISE_H
+#define SENSOR_NOISE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Sensor noise models for Monte Carlo replays of a drive cycle.
+ *
+ * A cycle is held as a SignalTrace: one array per signal (structure of
+ * arrays), one value per step, so per-step loops over a signal are plain
+ * strided-free array loops. Each signal of a replica is perturbed by:
+ *   - a fixed bias and Gaussian noise (sigma),
+ *   - latency: the receiver sees the value of `latency` steps earlier, plus
+ *     0..jitter extra steps drawn per step,
+ *   - dropout: a lost sample leaves the receiver with the previous one.
+ * Integer signals (door, pedals, gear, cabin temperatures) are rounded after
+ * noise, as a PDU would carry them.
+ *
+ * Draws use the counter based generator of drive_cycle.h keyed by
+ * (seed, replica), so replica N is the same whichever thread runs it.
+ */
+typedef enum {
+    TRACE_SPEED = 0,        // Same order as the Stop/Start rule signals
+    TRACE_INTERNAL_TEMP,
+    TRACE_EXTERNAL_TEMP,
+    TRACE_DOOR_OPEN,
+    TRACE_TILT_ANGLE,
+    TRACE_ACCEL,
+    TRACE_BRAKE,
+    TRACE_TEMP_SET,
+    TRACE_BATT_SOC,
+    TRACE_BATT_VOLT,
+    TRACE_ENGI_TEMP,
+    TRACE_GEAR,
+    TRACE_SIGNAL_COUNT
+} TraceSignal;
+
+typedef struct {
+    size_t steps;
+    double *values[TRACE_SIGNAL_COUNT];     // values[signal][step]
+} SignalTrace;
+
+typedef struct {
+    double bias;            // Added to every sample
+    double sigma;           // Gaussian noise standard deviation
+    double dropout;         // Per step chance that the sample is lost
+    unsigned int latency;   // Fixed delay, steps
+    unsigned int jitter;    // Extra delay drawn in 0..jitter, steps
+} NoiseModel;
+
+typedef struct {
+    NoiseModel models[TRACE_SIGNAL_COUNT];
+} NoiseConfig;
+
+bool signal_trace_alloc(SignalTrace *trace, size_t steps);
+void signal_trace_free(SignalTrace *trace);
+
+// Signal name as used in rule files, and its reverse (-1 if unknown)
+const char *signal_trace_name(TraceSignal signal);
+int signal_trace_find(const char *name);
+
+// No noise on any signal
+void noise_config_clear(NoiseConfig *config);
+
+/* Apply one "signal:key=value[,key=value...]" spec, signal may be "all".
+   Keys: bias, sigma, dropout, latency, jitter. On error sets *error. */
+bool noise_config_parse(NoiseConfig *config, const char *spec, const char **error);
+
+// Standard normal draw for (row, channel), from two uniform draws
+double sensor_noise_gaussian(uint64_t key, uint32_t row, unsigned int channel);
+
+// noisy = clean as received through the noise models of replica `key`
+void sensor_noise_apply(const SignalTrace *clean, const NoiseConfig *config, uint64_t key,
+                        SignalTrace *noisy);
+
+#endif // SENSOR_NOISE_H
@@ -0,0 +1,161 @@
+#include "sensor_pdu.h"
+#include <string.h>
+
+#define PDU_PRESENT_HI      (0)
+#define PDU_PRESENT_LO      (1)
+#define PDU_SPEED           (2)
+#define PDU_TILT            (4)
+#define PDU_BATT_SOC        (6)
+#define PDU_BATT_VOLT       (8)
+#define PDU_ENGI_TEMP       (10)
+#define PDU_IN_TEMP         (12)
+#define PDU_EX_TEMP         (13)
+#define PDU_TEMP_SET        (14)
+#define PDU_FLAGS           (15)
+
+#define PDU_DOOR_MASK       (0x0FU)
+#define PDU_ACCEL_BIT       (0x10U)
+#define PDU_BRAKE_BIT       (0x20U)
+#define PDU_GEAR_BIT        (0x40U)
+
+#define SCALE_TENTH         (10.0)
+#define SCALE_HUNDREDTH     (100.0)
+#define BYTE_SHIFT          (8U)
+#define BYTE_MASK           (0xFFU)
+#define ROUND_HALF          (0.5)
+
+// Scale and round to the nearest integer, saturating at [min, max]
+static long to_fixed(double value, double scale, long min, long max)
+{
+    double scaled = value * scale;
+    long fixed = (long)((scaled >= 0.0) ? (scaled + ROUND_HALF) : (scaled - ROUND_HALF));
+
+    if (fixed < min)
+    {
+        fixed = min;
+    }
+    if (fixed > max)
+    {
+        fixed = max;
+    }
+    return fixed;
+}
+
+static void put_u16(unsigned char *dst, uint16_t value)
+{
+    dst[0] = (unsigned char)((value >> BYTE_SHIFT) & BYTE_MASK);
+    dst[1] = (unsigned char)(value & BYTE_MASK);
+}
+
+static uint16_t get_u16(const unsigned char *src)
+{
+    return (uint16_t)(((unsigned int)src[0] << BYTE_SHIFT) | (unsigned int)src[1]);
+}
+
+bool sensor_pdu_is_pdu(const unsigned char *block)
+{
+    return (block[PDU_PRESENT_HI] & SENSOR_PDU_MARKER_MASK) == SENSOR_PDU_MARKER;
+}
+
+void sensor_pdu_encode(const SensorPdu *pdu, unsigned char *block)
+{
+    const uint16_t present = (uint16_t)(pdu->present & SENSOR_PDU_ALL_PRESENT);
+    unsigned char flags = 0U;
+
+    (void)memset(block, 0, SENSOR_PDU_SIZE);
+    block[PDU_PRESENT_HI] = (unsigned char)(SENSOR_PDU_MARKER | (present >> BYTE_SHIFT));
+    block[PDU_PRESENT_LO] = (unsigned char)(present & BYTE_MASK);
+
+    put_u16(&block[PDU_SPEED],
+            (uint16_t)to_fixed(pdu->speed, SCALE_TENTH, 0L, UINT16_MAX));
+    put_u16(&block[PDU_TILT],
+            (uint16_t)(int16_t)to_fixed(pdu->tilt_angle, SCALE_TENTH, INT16_MIN, INT16_MAX));
+    put_u16(&block[PDU_BATT_SOC],
+            (uint16_t)to_fixed(pdu->batt_soc, SCALE_TENTH, 0L, UINT16_MAX));
+    put_u16(&block[PDU_BATT_VOLT],
+            (uint16_t)to_fixed(pdu->batt_volt, SCALE_HUNDREDTH, 0L, UINT16_MAX));
+    put_u16(&block[PDU_ENGI_TEMP],
+            (uint16_t)(int16_t)to_fixed(pdu->engi_temp, SCALE_TENTH, INT16_MIN, INT16_MAX));
+
+    block[PDU_IN_TEMP] = (unsigned char)(int8_t)to_fixed(pdu->internal_temp, 1.0, INT8_MIN, INT8_MAX);
+    block[PDU_EX_TEMP] = (unsigned char)(int8_t)to_fixed(pdu->external_temp, 1.0, INT8_MIN, INT8_MAX);
+    block[PDU_TEMP_SET] = (unsigned char)to_fixed(pdu->temp_set, 1.0, 0L, UINT8_MAX);
+
+    flags = (unsigned char)((unsigned int)to_fixed(pdu->door_open, 1.0, 0L, PDU_DOOR_MASK) & PDU_DOOR_MASK);
+    if (pdu->accel != 0)
+    {
+        flags |= PDU_ACCEL_BIT;
+    }
+    if (pdu->brake != 0)
+    {
+        flags |= PDU_BRAKE_BIT;
+    }
+    if (pdu->gear != 0)
+    {
+        flags |= PDU_GEAR_BIT;
+    }
+    block[PDU_FLAGS] = flags;
+}
+
+bool sensor_pdu_decode(const unsigned char *block, SensorPdu *pdu)
+{
+    if (!sensor_pdu_is_pdu(block))
+    {
+        return false;
+    }
+
+    const unsigned int flags = block[PDU_FLAGS];
+    pdu->present = (uint16_t)((((unsigned int)block[PDU_PRESENT_HI] & ~SENSOR_PDU_MARKER_MASK) << BYTE_SHIFT) |
+                              (unsigned int)block[PDU_PRESENT_LO]);
+    pdu->present &= SENSOR_PDU_ALL_PRESENT;
+
+    if (sensor_pdu_has(pdu, SENSOR_SIG_SPEED))
+    {
+        pdu->speed = (double)get_u16(&block[PDU_SPEED]) / SCALE_TENTH;
+    }
+    if (sensor_pdu_has(pdu, SENSOR_SIG_TILT))
+    {
+        pdu->tilt_angle = (double)(int16_t)get_u16(&block[PDU_TILT]) / SCALE_TENTH;
+    }
+    if (sensor_pdu_has(pdu, SENSOR_SIG_BATT_SOC))
+    {
+        pdu->batt_soc = (double)get_u16(&block[PDU_BATT_SOC]) / SCALE_TENTH;
+    }
+    if (sensor_pdu_has(pdu, SENSOR_SIG_BATT_VOLT))
+    {
+        pdu->batt_volt = (double)get_u16(&block[PDU_BATT_VOLT]) / SCALE_HUNDREDTH;
+    }
+    if (sensor_pdu_has(pdu, SENSOR_SIG_ENGI_TEMP))
+    {
+        pdu->engi_temp = (double)(int16_t)get_u16(&block[PDU_ENGI_TEMP]) / SCALE_TENTH;
+    }
+    if (sensor_pdu_has(pdu, SENSOR_SIG_IN_TEMP))
+    {
+        pdu->internal_temp = (int)(int8_t)block[PDU_IN_TEMP];
+    }
+    if (sensor_pdu_has(pdu, SENSOR_SIG_EX_TEMP))
+    {
+        pdu->external_temp = (int)(int8_t)block[PDU_EX_TEMP];
+    }
+    if (sensor_pdu_has(pdu, SENSOR_SIG_TEMP_SET))
+    {
+        pdu->temp_set = (int)block[PDU_TEMP_SET];
+    }
+    if (sensor_pdu_has(pdu, SENSOR_SIG_DOOR))
+    {
+        pdu->door_open = (int)(flags & PDU_DOOR_MASK);
+    }
+    if (sensor_pdu_has(pdu, SENSOR_SIG_ACCEL))
+    {
+        pdu->accel = ((flags & PDU_ACCEL_BIT) != 0U) ? 1 : 0;
+    }
+    if (sensor_pdu_has(pdu, SENSOR_SIG_BRAKE))
+    {
+        pdu->brake = ((flags & PDU_BRAKE_BIT) != 0U) ? 1 : 0;
+    }
+    if (sensor_pdu_has(pdu, SENSOR_SIG_GEAR))
+    {
+        pdu->gear = ((flags & PDU_GEAR_BIT) != 0U) ? 1 : 0;
+    }
+    return true;
+}
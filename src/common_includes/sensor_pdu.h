@@ -0,0 +1,80 @@
+#ifndef SENSOR_PDU_H
+#define SENSOR_PDU_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "can_socket.h"
+
+/*
+ * Multiplexed sensor PDU: all sensor signals in one AES block (16 bytes),
+ * binary fixed-point, big-endian.
+ *
+ *   [0]      0xF0 | presence bits 11..8  (high nibble never starts ASCII text)
+ *   [1]      presence bits 7..0          (bit n set -> signal n is carried)
+ *   [2..3]   speed        uint16  0.1 km/h
+ *   [4..5]   tilt         int16   0.1 deg
+ *   [6..7]   batt_soc     uint16  0.1 %
+ *   [8..9]   batt_volt    uint16  0.01 V
+ *   [10..11] engi_temp    int16   0.1 degC
+ *   [12]     in_temp      int8    1 degC
+ *   [13]     ex_temp      int8    1 degC
+ *   [14]     temp_set     uint8   1 degC
+ *   [15]     bits 3..0 door, bit 4 accel, bit 5 brake, bit 6 gear
+ *
+ * Signals whose presence bit is clear are left untouched by the decoder,
+ * so a sender can publish only the signals that changed.
+ */
+#define SENSOR_PDU_SIZE         (AES_BLOCK_SIZE)
+#define SENSOR_PDU_MARKER       (0xF0U)
+#define SENSOR_PDU_MARKER_MASK  (0xF0U)
+
+typedef enum {
+    SENSOR_SIG_SPEED = 0,
+    SENSOR_SIG_IN_TEMP,
+    SENSOR_SIG_EX_TEMP,
+    SENSOR_SIG_DOOR,
+    SENSOR_SIG_TILT,
+    SENSOR_SIG_ACCEL,
+    SENSOR_SIG_BRAKE,
+    SENSOR_SIG_TEMP_SET,
+    SENSOR_SIG_BATT_SOC,
+    SENSOR_SIG_BATT_VOLT,
+    SENSOR_SIG_ENGI_TEMP,
+    SENSOR_SIG_GEAR,
+    SENSOR_SIG_COUNT
+} SensorSignalId;
+
+#define SENSOR_PDU_ALL_PRESENT  ((uint16_t)((1U << SENSOR_SIG_COUNT) - 1U))
+
+typedef struct {
+    uint16_t present;       // Bit n set -> signal SensorSignalId n is valid
+    double speed;
+    int internal_temp;
+    int external_temp;
+    int door_open;
+    double tilt_angle;
+    int accel;
+    int brake;
+    int temp_set;
+    double batt_soc;
+    double batt_volt;
+    double engi_temp;
+    int gear;
+} SensorPdu;
+
+// True when the decrypted block is a sensor PDU rather than a text message
+bool sensor_pdu_is_pdu(const unsigned char *block);
+
+// Pack the present signals of pdu into a SENSOR_PDU_SIZE block
+void sensor_pdu_encode(const SensorPdu *pdu, unsigned char *block);
+
+// Unpack a block; only the present signals of pdu are written
+bool sensor_pdu_decode(const unsigned char *block, SensorPdu *pdu);
+
+static inline bool sensor_pdu_has(const SensorPdu *pdu, SensorSignalId sig)
+{
+    return (pdu->present & (uint16_t)(1U << (unsigned int)sig)) != 0U;
+}
+
+#endif // SENSOR_PDU_H
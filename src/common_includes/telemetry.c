@@ -0,0 +1,332 @@
+#include "telemetry.h"
+#include <string.h>
+
+#ifdef TELEMETRY_ZSTD
+#include <zstd.h>
+#define TELEMETRY_ZSTD_LEVEL    (3)
+#endif
+
+#define VARINT_SHIFT        (7U)
+#define VARINT_MASK         (0x7FU)
+#define VARINT_CONTINUE     (0x80U)
+#define ZIGZAG_SIGN_SHIFT   (63U)
+#define ROUND_HALF          (0.5)
+
+typedef struct {
+    uint32_t rows;
+    uint32_t codec;
+    uint32_t raw_size;
+    uint32_t stored_size;
+} TelemetryBlockHeader;
+
+typedef struct {
+    char magic[TELEMETRY_MAGIC_SIZE];
+    uint32_t version;
+    uint32_t num_columns;
+} TelemetryFileHeader;
+
+static uint64_t zigzag_encode(int64_t value)
+{
+    return ((uint64_t)value << 1U) ^ (uint64_t)(value >> ZIGZAG_SIGN_SHIFT);
+}
+
+static int64_t zigzag_decode(uint64_t value)
+{
+    return (int64_t)(value >> 1U) ^ -(int64_t)(value & 1U);
+}
+
+size_t telemetry_put_varint(unsigned char *out, int64_t value)
+{
+    uint64_t bits = zigzag_encode(value);
+    size_t len = 0U;
+
+    while (bits > VARINT_MASK)
+    {
+        out[len++] = (unsigned char)((bits & VARINT_MASK) | VARINT_CONTINUE);
+        bits >>= VARINT_SHIFT;
+    }
+    out[len++] = (unsigned char)bits;
+    return len;
+}
+
+size_t telemetry_get_varint(const unsigned char *in, size_t size, int64_t *value)
+{
+    uint64_t bits = 0U;
+
+    for (size_t i = 0U; (i < size) && (i < TELEMETRY_VARINT_MAX); i++)
+    {
+        bits |= (uint64_t)(in[i] & VARINT_MASK) << (VARINT_SHIFT * i);
+        if ((in[i] & VARINT_CONTINUE) == 0U)
+        {
+            *value = zigzag_decode(bits);
+            return i + 1U;
+        }
+    }
+    return 0U;  // Truncated or over-long varint
+}
+
+bool telemetry_compression_available(void)
+{
+#ifdef TELEMETRY_ZSTD
+    return true;
+#else
+    return false;
+#endif
+}
+
+int64_t telemetry_scale(double value, uint32_t scale)
+{
+    const double scaled = value * (double)scale;
+    return (int64_t)((scaled >= 0.0) ? (scaled + ROUND_HALF) : (scaled - ROUND_HALF));
+}
+
+bool telemetry_open(TelemetryWriter *writer, const char *path,
+                    const TelemetryColumn *columns, uint32_t num_columns, uint32_t codec)
+{
+    TelemetryFileHeader header;
+
+    if ((num_columns == 0U) || (num_columns > TELEMETRY_MAX_COLUMNS))
+    {
+        return false;
+    }
+
+    writer->file = fopen(path, "wb");
+    if (writer->file == NULL)
+    {
+        return false;
+    }
+
+    writer->codec = telemetry_compression_available() ? codec : TELEMETRY_CODEC_NONE;
+    writer->num_columns = num_columns;
+    writer->rows = 0U;
+    writer->total_rows = 0UL;
+
+    (void)memset(&header, 0, sizeof(header));
+    (void)memcpy(header.magic, TELEMETRY_MAGIC, TELEMETRY_MAGIC_SIZE);
+    header.version = TELEMETRY_VERSION;
+    header.num_columns = num_columns;
+    (void)fwrite(&header, sizeof(header), 1U, writer->file);
+
+    for (uint32_t col = 0U; col < num_columns; col++)
+    {
+        (void)memset(&writer->columns[col], 0, sizeof(TelemetryColumn));
+        (void)strncpy(writer->columns[col].name, columns[col].name, TELEMETRY_NAME_SIZE - 1U);
+        writer->columns[col].scale = (columns[col].scale == 0U) ? 1U : columns[col].scale;
+    }
+    return fwrite(writer->columns, sizeof(TelemetryColumn), num_columns, writer->file) == num_columns;
+}
+
+bool telemetry_append(TelemetryWriter *writer, const int64_t *row)
+{
+    for (uint32_t col = 0U; col < writer->num_columns; col++)
+    {
+        writer->values[col][writer->rows] = row[col];
+    }
+    writer->rows++;
+    writer->total_rows++;
+
+    return (writer->rows < TELEMETRY_BLOCK_ROWS) ? true : telemetry_flush(writer);
+}
+
+static size_t encode_block(TelemetryWriter *writer)
+{
+    size_t len = 0U;
+
+    for (uint32_t col = 0U; col < writer->num_columns; col++)
+    {
+        int64_t previous = 0;
+        for (uint32_t row = 0U; row < writer->rows; row++)
+        {
+            const int64_t value = writer->values[col][row];
+            len += telemetry_put_varint(&writer->raw[len], (int64_t)((uint64_t)value - (uint64_t)previous));
+            previous = value;
+        }
+    }
+    return len;
+}
+
+bool telemetry_flush(TelemetryWriter *writer)
+{
+    TelemetryBlockHeader block;
+    const unsigned char *payload = writer->raw;
+
+    if ((writer->file == NULL) || (writer->rows == 0U))
+    {
+        return writer->file != NULL;
+    }
+
+    block.rows = writer->rows;
+    block.raw_size = (uint32_t)encode_block(writer);
+    block.codec = TELEMETRY_CODEC_NONE;
+    block.stored_size = block.raw_size;
+
+#ifdef TELEMETRY_ZSTD
+    if (writer->codec == TELEMETRY_CODEC_ZSTD)
+    {
+        const size_t packed = ZSTD_compress(writer->packed, sizeof(writer->packed),
+                                            writer->raw, block.raw_size, TELEMETRY_ZSTD_LEVEL);
+        // Keep the raw block when compression does not pay off
+        if (!ZSTD_isError(packed) && (packed < block.raw_size))
+        {
+            block.codec = TELEMETRY_CODEC_ZSTD;
+            block.stored_size = (uint32_t)packed;
+            payload = writer->packed;
+        }
+    }
+#endif
+
+    writer->rows = 0U;
+    if ((fwrite(&block, sizeof(block), 1U, writer->file) != 1U) ||
+        (fwrite(payload, 1U, block.stored_size, writer->file) != block.stored_size))
+    {
+        return false;
+    }
+    return fflush(writer->file) == 0;
+}
+
+bool telemetry_close(TelemetryWriter *writer)
+{
+    bool ok = true;
+
+    if (writer->file != NULL)
+    {
+        ok = telemetry_flush(writer);
+        ok = (fclose(writer->file) == 0) && ok;
+        writer->file = NULL;
+    }
+    return ok;
+}
+
+bool telemetry_reader_open(TelemetryReader *reader, const char *path)
+{
+    TelemetryFileHeader header;
+
+    reader->rows = 0U;
+    reader->file = fopen(path, "rb");
+    if (reader->file == NULL)
+    {
+        return false;
+    }
+
+    if ((fread(&header, sizeof(header), 1U, reader->file) != 1U) ||
+        (memcmp(header.magic, TELEMETRY_MAGIC, TELEMETRY_MAGIC_SIZE) != 0) ||
+        (header.version != TELEMETRY_VERSION) ||
+        (header.num_columns == 0U) || (header.num_columns > TELEMETRY_MAX_COLUMNS) ||
+        (fread(reader->columns, sizeof(TelemetryColumn), header.num_columns, reader->file) !=
+         header.num_columns))
+    {
+        telemetry_reader_close(reader);
+        return false;
+    }
+
+    reader->num_columns = header.num_columns;
+    for (uint32_t col = 0U; col < reader->num_columns; col++)
+    {
+        reader->columns[col].name[TELEMETRY_NAME_SIZE - 1U] = '\0';
+    }
+    return true;
+}
+
+static bool decode_block(TelemetryReader *reader, size_t size)
+{
+    size_t pos = 0U;
+
+    for (uint32_t col = 0U; col < reader->num_columns; col++)
+    {
+        int64_t previous = 0;
+        for (uint32_t row = 0U; row < reader->rows; row++)
+        {
+            int64_t delta = 0;
+            const size_t used = telemetry_get_varint(&reader->raw[pos], size - pos, &delta);
+            if (used == 0U)
+            {
+                return false;
+            }
+            pos += used;
+            previous = (int64_t)((uint64_t)previous + (uint64_t)delta);
+            reader->values[col][row] = previous;
+        }
+    }
+    return pos == size;
+}
+
+bool telemetry_read_block(TelemetryReader *reader)
+{
+    TelemetryBlockHeader block;
+
+    reader->rows = 0U;
+    if ((reader->file == NULL) || (fread(&block, sizeof(block), 1U, reader->file) != 1U))
+    {
+        return false;
+    }
+    if ((block.rows == 0U) || (block.rows > TELEMETRY_BLOCK_ROWS) ||
+        (block.raw_size > sizeof(reader->raw)) || (block.stored_size > sizeof(reader->packed)))
+    {
+        return false;
+    }
+
+    if (block.codec == TELEMETRY_CODEC_NONE)
+    {
+        if ((block.stored_size != block.raw_size) ||
+            (fread(reader->raw, 1U, block.raw_size, reader->file) != block.raw_size))
+        {
+            return false;
+        }
+    }
+#ifdef TELEMETRY_ZSTD
+    else if (block.codec == TELEMETRY_CODEC_ZSTD)
+    {
+        if (fread(reader->packed, 1U, block.stored_size, reader->file) != block.stored_size)
+        {
+            return false;
+        }
+        const size_t raw = ZSTD_decompress(reader->raw, sizeof(reader->raw),
+                                           reader->packed, block.stored_size);
+        if (ZSTD_isError(raw) || (raw != block.raw_size))
+        {
+            return false;
+        }
+    }
+#endif
+    else
+    {
+        // Compressed block and no decompressor built in
+        return false;
+    }
+
+    reader->rows = block.rows;
+    reader->codec = block.codec;
+    reader->stored_size = block.stored_size;
+    if (!decode_block(reader, block.raw_size))
+    {
+        reader->rows = 0U;
+        return false;
+    }
+    return true;
+}
+
+int telemetry_column_index(const TelemetryReader *reader, const char *name)
+{
+    for (uint32_t col = 0U; col < reader->num_columns; col++)
+    {
+        if (strcmp(reader->columns[col].name, name) == 0)
+        {
+            return (int)col;
+        }
+    }
+    return -1;
+}
+
+double telemetry_value(const TelemetryReader *reader, uint32_t column, uint32_t row)
+{
+    return (double)reader->values[column][row] / (double)reader->columns[column].scale;
+}
+
+void telemetry_reader_close(TelemetryReader *reader)
+{
+    if (reader->file != NULL)
+    {
+        (void)fclose(reader->file);
+        reader->file = NULL;
+    }
+}
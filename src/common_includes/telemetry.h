@@ -0,0 +1,88 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Columnar telemetry file.
+ *
+ *   header : "SSTELEM1" magic (8) | version u32 | column count u32
+ *            then per column: name (TELEMETRY_NAME_SIZE bytes) | scale u32
+ *   blocks : row count u32 | codec u32 | raw size u32 | stored size u32
+ *            then the payload: column 0 for every row, then column 1, ...
+ *
+ * Every value is an int64 (real value = stored / scale). Inside a block each
+ * value is stored as the zigzag LEB128 varint of its difference to the
+ * previous row, so slowly changing signals take one byte per row. A block
+ * payload may be compressed with zstd when built with TELEMETRY_ZSTD=1.
+ */
+#define TELEMETRY_MAGIC         "SSTELEM1"
+#define TELEMETRY_MAGIC_SIZE    (8U)
+#define TELEMETRY_VERSION       (1U)
+#define TELEMETRY_NAME_SIZE     (16U)
+#define TELEMETRY_MAX_COLUMNS   (24U)
+#define TELEMETRY_BLOCK_ROWS    (256U)
+#define TELEMETRY_VARINT_MAX    (10U)       // Bytes of a 64-bit LEB128 varint
+#define TELEMETRY_BLOCK_MAX_RAW (TELEMETRY_MAX_COLUMNS * TELEMETRY_BLOCK_ROWS * TELEMETRY_VARINT_MAX)
+
+#define TELEMETRY_CODEC_NONE    (0U)
+#define TELEMETRY_CODEC_ZSTD    (1U)
+
+typedef struct {
+    char name[TELEMETRY_NAME_SIZE];
+    uint32_t scale;         // Fixed-point scale: 10 stores tenths
+} TelemetryColumn;
+
+typedef struct {
+    FILE *file;
+    uint32_t codec;
+    uint32_t num_columns;
+    uint32_t rows;          // Rows buffered in the current block
+    unsigned long total_rows;
+    TelemetryColumn columns[TELEMETRY_MAX_COLUMNS];
+    int64_t values[TELEMETRY_MAX_COLUMNS][TELEMETRY_BLOCK_ROWS];
+    unsigned char raw[TELEMETRY_BLOCK_MAX_RAW];
+    unsigned char packed[TELEMETRY_BLOCK_MAX_RAW + TELEMETRY_BLOCK_MAX_RAW / 64U + 128U];
+} TelemetryWriter;
+
+typedef struct {
+    FILE *file;
+    uint32_t num_columns;
+    uint32_t rows;          // Rows of the current block
+    uint32_t codec;         // Codec of the current block
+    uint32_t stored_size;   // Bytes of the current block in the file
+    TelemetryColumn columns[TELEMETRY_MAX_COLUMNS];
+    int64_t values[TELEMETRY_MAX_COLUMNS][TELEMETRY_BLOCK_ROWS];
+    unsigned char raw[TELEMETRY_BLOCK_MAX_RAW];
+    unsigned char packed[TELEMETRY_BLOCK_MAX_RAW + TELEMETRY_BLOCK_MAX_RAW / 64U + 128U];
+} TelemetryReader;
+
+// Varint helpers (exposed for the reader CLI and unit tests)
+size_t telemetry_put_varint(unsigned char *out, int64_t value);
+size_t telemetry_get_varint(const unsigned char *in, size_t size, int64_t *value);
+
+// True when the library was built with block compression support
+bool telemetry_compression_available(void);
+
+/* Writer. codec TELEMETRY_CODEC_ZSTD falls back to NONE when compression is
+   not built in. Rows are buffered and written one block at a time. */
+bool telemetry_open(TelemetryWriter *writer, const char *path,
+                    const TelemetryColumn *columns, uint32_t num_columns, uint32_t codec);
+bool telemetry_append(TelemetryWriter *writer, const int64_t *row);
+bool telemetry_flush(TelemetryWriter *writer);
+bool telemetry_close(TelemetryWriter *writer);
+
+// Convert a real value to the fixed-point stored in a column
+int64_t telemetry_scale(double value, uint32_t scale);
+
+/* Reader. telemetry_read_block loads the next block into values[][]; it
+   returns false at the end of the file or on a corrupt block. */
+bool telemetry_reader_open(TelemetryReader *reader, const char *path);
+bool telemetry_read_block(TelemetryReader *reader);
+int telemetry_column_index(const TelemetryReader *reader, const char *name);
+double telemetry_value(const TelemetryReader *reader, uint32_t column, uint32_t row);
+void telemetry_reader_close(TelemetryReader *reader);
+
+#endif // TELEMETRY_H
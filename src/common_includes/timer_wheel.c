@@ -0,0 +1,156 @@
+#include "timer_wheel.h"
+#include <string.h>
+#include <time.h>
+
+#define NSEC_PER_MS     (1000000LL)
+#define MS_PER_SEC      (1000LL)
+
+static bool fires_before(const TimerEntry *left, const TimerEntry *right)
+{
+    return (left->expires_ms < right->expires_ms) ||
+           ((left->expires_ms == right->expires_ms) && (left->seq < right->seq));
+}
+
+static void insert(TimerWheel *wheel, TimerEntry *timer)
+{
+    long long tick = timer->expires_ms / wheel->tick_ms;
+
+    // Already overdue: goes into the next slot to be processed
+    if (tick < wheel->next_tick)
+    {
+        tick = wheel->next_tick;
+    }
+    timer->slot = (size_t)(tick % (long long)TIMER_WHEEL_SLOTS);
+    timer->seq = wheel->next_seq++;
+
+    TimerEntry **link = &wheel->slots[timer->slot];
+    while ((*link != NULL) && fires_before(*link, timer))
+    {
+        link = &(*link)->next;
+    }
+    timer->next = *link;
+    *link = timer;
+    timer->armed = true;
+    wheel->armed++;
+}
+
+long long timer_wheel_now_ms(void)
+{
+    struct timespec now;
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((long long)now.tv_sec * MS_PER_SEC) + (now.tv_nsec / NSEC_PER_MS);
+}
+
+void timer_wheel_init(TimerWheel *wheel, long long tick_ms, long long now_ms)
+{
+    (void)memset(wheel, 0, sizeof(*wheel));
+    wheel->tick_ms = (tick_ms > 0) ? tick_ms : 1;
+    wheel->next_tick = now_ms / wheel->tick_ms;
+}
+
+bool timer_wheel_add(TimerWheel *wheel, TimerEntry *timer, long long now_ms,
+                     long long delay_ms, long long period_ms,
+                     TimerCallback callback, void *arg)
+{
+    if ((callback == NULL) || (delay_ms < 0) ||
+        ((period_ms != 0) && (period_ms < wheel->tick_ms)))
+    {
+        return false;
+    }
+
+    timer_wheel_cancel(wheel, timer);
+    timer->expires_ms = now_ms + delay_ms;
+    timer->period_ms = period_ms;
+    timer->callback = callback;
+    timer->arg = arg;
+    insert(wheel, timer);
+    return true;
+}
+
+void timer_wheel_cancel(TimerWheel *wheel, TimerEntry *timer)
+{
+    if (!timer->armed)
+    {
+        return;
+    }
+
+    for (TimerEntry **link = &wheel->slots[timer->slot]; *link != NULL; link = &(*link)->next)
+    {
+        if (*link == timer)
+        {
+            *link = timer->next;
+            break;
+        }
+    }
+    timer->next = NULL;
+    timer->armed = false;
+    wheel->armed--;
+}
+
+long long timer_wheel_next_expiry(const TimerWheel *wheel)
+{
+    long long earliest = -1;
+
+    if (wheel->armed == 0U)
+    {
+        return -1;
+    }
+    // Slots are sorted, so only the heads need looking at
+    for (size_t i = 0U; i < TIMER_WHEEL_SLOTS; i++)
+    {
+        const TimerEntry *head = wheel->slots[i];
+        if ((head != NULL) && ((earliest < 0) || (head->expires_ms < earliest)))
+        {
+            earliest = head->expires_ms;
+        }
+    }
+    return earliest;
+}
+
+size_t timer_wheel_advance(TimerWheel *wheel, long long now_ms)
+{
+    const long long target = now_ms / wheel->tick_ms;
+    size_t fired = 0U;
+
+    while (wheel->next_tick <= target)
+    {
+        // Skip over long idle stretches instead of visiting every empty tick
+        if ((target - wheel->next_tick) > (long long)TIMER_WHEEL_SLOTS)
+        {
+            const long long next = timer_wheel_next_expiry(wheel);
+            const long long next_tick = (next < 0) ? target : (next / wheel->tick_ms);
+            if (next_tick > wheel->next_tick)
+            {
+                wheel->next_tick = (next_tick < target) ? next_tick : target;
+            }
+        }
+
+        TimerEntry **slot = &wheel->slots[wheel->next_tick % (long long)TIMER_WHEEL_SLOTS];
+        while ((*slot != NULL) && ((*slot)->expires_ms <= now_ms) &&
+               (((*slot)->expires_ms / wheel->tick_ms) <= wheel->next_tick))
+        {
+            TimerEntry *timer = *slot;
+            const long long due_ms = timer->expires_ms;
+
+            *slot = timer->next;
+            timer->next = NULL;
+            timer->armed = false;
+            wheel->armed--;
+            if (timer->period_ms > 0)
+            {
+                // Re-armed before the callback runs, so the callback may cancel it
+                timer->expires_ms += timer->period_ms;
+                insert(wheel, timer);
+            }
+            timer->callback(timer, due_ms);
+            fired++;
+        }
+
+        if (wheel->next_tick == target)
+        {
+            break;  // The rest of this tick is not due yet
+        }
+        wheel->next_tick++;
+    }
+    return fired;
+}
@@ -0,0 +1,60 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Hashed timer wheel.
+ *
+ * Time is an absolute count of milliseconds supplied by the caller, so the
+ * same wheel runs on the monotonic clock or on simulated time. A timer lives
+ * in slot (expiry / tick) % TIMER_WHEEL_SLOTS; each slot is kept sorted by
+ * expiry and then by arming order, so timers due at the same time fire in the
+ * order they were armed. Timers are caller-owned: the wheel never allocates.
+ */
+#define TIMER_WHEEL_SLOTS   (256U)
+
+struct TimerEntry;
+typedef void (*TimerCallback)(struct TimerEntry *timer, long long due_ms);
+
+typedef struct TimerEntry {
+    struct TimerEntry *next;
+    long long expires_ms;
+    long long period_ms;        // 0 for a one-shot timer
+    unsigned long seq;          // Arming order, breaks ties between equal expiries
+    size_t slot;
+    TimerCallback callback;
+    void *arg;
+    bool armed;
+} TimerEntry;
+
+typedef struct {
+    TimerEntry *slots[TIMER_WHEEL_SLOTS];
+    long long tick_ms;
+    long long next_tick;        // First tick not processed yet
+    unsigned long next_seq;
+    size_t armed;
+} TimerWheel;
+
+void timer_wheel_init(TimerWheel *wheel, long long tick_ms, long long now_ms);
+
+/* Arm timer to fire at now + delay_ms and then every period_ms (0: once).
+   A periodic timer must not be shorter than the tick. Re-arming an armed
+   timer moves it. The callback may cancel or re-arm its own timer. */
+bool timer_wheel_add(TimerWheel *wheel, TimerEntry *timer, long long now_ms,
+                     long long delay_ms, long long period_ms,
+                     TimerCallback callback, void *arg);
+void timer_wheel_cancel(TimerWheel *wheel, TimerEntry *timer);
+
+/* Fire every timer due at or before now_ms, in expiry order; the callback
+   gets the time the timer was due. Returns how many timers fired. */
+size_t timer_wheel_advance(TimerWheel *wheel, long long now_ms);
+
+// Earliest expiry of an armed timer, or -1 when the wheel is empty
+long long timer_wheel_next_expiry(const TimerWheel *wheel);
+
+// CLOCK_MONOTONIC in ms, the time base when the wheel runs in real time
+long long timer_wheel_now_ms(void);
+
+#endif // TIMER_WHEEL_H
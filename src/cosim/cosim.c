@@ -0,0 +1,178 @@
+#include "cosim.h"
+#include "../common_includes/can_reassembly.h"
+
+#define FNV_OFFSET_BASIS    (0xcbf29ce484222325ULL)
+#define FNV_PRIME           (0x100000001b3ULL)
+#define NSEC_PER_MS         (1000000ULL)
+#define BYTE_BITS           (8U)
+
+// Simulation whose virtual time the reassemblers read
+static const Cosim *running_sim = NULL;
+
+static long long virtual_now_ms(void)
+{
+    return running_sim->now_ms;
+}
+
+static uint64_t digest_bytes(uint64_t digest, uint64_t value, unsigned int bytes)
+{
+    // Little endian whatever the host, so digests compare across machines
+    for (unsigned int i = 0U; i < bytes; i++)
+    {
+        digest ^= (value >> (i * BYTE_BITS)) & 0xFFU;
+        digest *= FNV_PRIME;
+    }
+    return digest;
+}
+
+static void put_on_bus(Cosim *sim, const struct can_frame *frame)
+{
+    sim->frames++;
+    sim->digest = digest_bytes(sim->digest, (uint64_t)sim->now_ms, sizeof(uint64_t));
+    sim->digest = digest_bytes(sim->digest, frame->can_id, sizeof(uint32_t));
+    sim->digest = digest_bytes(sim->digest, frame->can_dlc, 1U);
+    for (unsigned int i = 0U; (i < frame->can_dlc) && (i < CAN_MAX_DLEN); i++)
+    {
+        sim->digest = digest_bytes(sim->digest, frame->data[i], 1U);
+    }
+    if (sim->trace != NULL)
+    {
+        (void)can_capture_write(sim->trace, frame, (uint64_t)sim->now_ms * NSEC_PER_MS);
+    }
+
+    for (unsigned int i = 0U; i < sim->num_nodes; i++)
+    {
+        CosimNode *node = sim->nodes[i];
+        if (node->receive != NULL)
+        {
+            can_security_select(&node->security);
+            node->receive(node, frame, sim->now_ms);
+            node->frames_received++;
+        }
+    }
+}
+
+// Deliver everything sent so far, including what receivers send in turn
+static void deliver(Cosim *sim)
+{
+    bool delivered = true;
+
+    while (delivered)
+    {
+        delivered = false;
+        for (unsigned int i = 0U; i < sim->num_nodes; i++)
+        {
+            CosimNode *sender = sim->nodes[i];
+            struct can_frame frame;
+
+            while (recv(sender->bus_sock, &frame, sizeof(frame), MSG_DONTWAIT) == (ssize_t)sizeof(frame))
+            {
+                sender->frames_sent++;
+                put_on_bus(sim, &frame);
+                delivered = true;
+            }
+        }
+    }
+}
+
+static void run_task(TimerEntry *timer, long long due_ms)
+{
+    CosimTask *task = (CosimTask *)timer->arg;
+    CosimNode *node = task->node;
+    Cosim *sim = node->sim;
+
+    sim->now_ms = due_ms;
+    sim->events++;
+    can_security_select(&node->security);
+    task->run(node, due_ms);
+    deliver(sim);
+}
+
+void cosim_init(Cosim *sim)
+{
+    (void)memset(sim, 0, sizeof(*sim));
+    timer_wheel_init(&sim->wheel, COSIM_TICK_MS, 0);
+    sim->end_ms = COSIM_NO_END;
+    sim->digest = FNV_OFFSET_BASIS;
+}
+
+bool cosim_add_node(Cosim *sim, CosimNode *node, const char *name, uint8_t can_node,
+                    CosimReceiveFn receive, void *ecu)
+{
+    int pair[2];
+
+    if ((sim->num_nodes >= COSIM_MAX_NODES) || (create_can_loopback_pair(pair) != 0))
+    {
+        return false;
+    }
+
+    (void)memset(node, 0, sizeof(*node));
+    node->name = name;
+    node->sim = sim;
+    can_security_init(&node->security, can_node, COSIM_FIRST_COUNTER);
+    node->tx_sock = pair[0];
+    node->bus_sock = pair[1];
+    node->receive = receive;
+    node->ecu = ecu;
+    sim->nodes[sim->num_nodes] = node;
+    sim->num_nodes++;
+    return true;
+}
+
+bool cosim_add_task(Cosim *sim, CosimTask *task, CosimNode *node, long long delay_ms,
+                    long long period_ms, CosimTaskFn run)
+{
+    task->node = node;
+    task->run = run;
+    return timer_wheel_add(&sim->wheel, &task->timer, sim->now_ms, delay_ms, period_ms,
+                           run_task, task);
+}
+
+void cosim_cancel_task(Cosim *sim, CosimTask *task)
+{
+    timer_wheel_cancel(&sim->wheel, &task->timer);
+}
+
+void cosim_stop_at(Cosim *sim, long long end_ms)
+{
+    if ((sim->end_ms == COSIM_NO_END) || (end_ms < sim->end_ms))
+    {
+        sim->end_ms = end_ms;
+    }
+}
+
+/**
+ * @brief Run the co-simulation: virtual time jumps to the next event, runs
+ * every task due then and delivers their frames.
+ */
+long long cosim_run(Cosim *sim)
+{
+    running_sim = sim;
+    can_reasm_set_clock(virtual_now_ms);
+
+    for (;;)
+    {
+        const long long next_ms = timer_wheel_next_expiry(&sim->wheel);
+        if ((next_ms < 0) || ((sim->end_ms != COSIM_NO_END) && (next_ms > sim->end_ms)))
+        {
+            break;
+        }
+        sim->now_ms = next_ms;
+        (void)timer_wheel_advance(&sim->wheel, next_ms);
+    }
+
+    can_reasm_set_clock(NULL);
+    can_security_select(NULL);
+    running_sim = NULL;
+    return sim->now_ms;
+}
+
+void cosim_free(Cosim *sim)
+{
+    for (unsigned int i = 0U; i < sim->num_nodes; i++)
+    {
+        close_can_socket(sim->nodes[i]->tx_sock);
+        close_can_socket(sim->nodes[i]->bus_sock);
+    }
+    sim->num_nodes = 0U;
+}
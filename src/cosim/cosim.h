@@ -0,0 +1,95 @@
+#ifndef COSIM_H
+#define COSIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <linux/can.h>
+
+#include "../common_includes/can_socket.h"
+#include "../common_includes/can_capture.h"
+#include "../common_includes/timer_wheel.h"
+
+/*
+ * Discrete-event co-simulation kernel.
+ *
+ * ECUs run in one thread as nodes of a virtual bus. Their periodic loops are
+ * tasks on a single timer wheel and virtual time jumps straight from one event
+ * to the next: nothing reads the wall clock. The one wait of the ECU loops,
+ * the gap the Stop/Start coroutine leaves between error_battery and
+ * error_disabled on a failed restart, is skipped: the powertrain task sends
+ * the pending error_disabled right away, so both frames are delivered at the
+ * same instant, in the order sent.
+ *
+ * Each node sends through one end of an in-process transport
+ * (create_can_loopback_pair), so the ECU code sends as usual. After every task
+ * the kernel collects the frames sent, node by node in order, and delivers
+ * each one at the same virtual instant to every receiving node, the sender
+ * included, as vcan does between an ECU's send and receive sockets. Every node
+ * has its own security context, selected before its code runs, and frame
+ * reassembly runs on virtual time: a run only depends on its inputs and its
+ * bus traffic, summed up in a digest, is the same on every run.
+ */
+#define COSIM_MAX_NODES     (8U)
+#define COSIM_TICK_MS       (1LL)
+#define COSIM_FIRST_COUNTER (1U)        // Freshness counter of every node at start
+#define COSIM_NO_END        (-1LL)
+
+struct Cosim;
+struct CosimNode;
+
+typedef void (*CosimTaskFn)(struct CosimNode *node, long long now_ms);
+typedef void (*CosimReceiveFn)(struct CosimNode *node, const struct can_frame *frame, long long now_ms);
+
+typedef struct {
+    TimerEntry timer;
+    struct CosimNode *node;
+    CosimTaskFn run;
+} CosimTask;
+
+typedef struct CosimNode {
+    const char *name;
+    struct Cosim *sim;
+    CanSecurityContext security;
+    int tx_sock;                // Sending socket handed to the ECU code
+    int bus_sock;               // Kernel end, where the node's frames are collected
+    CosimReceiveFn receive;     // NULL for a node that only sends
+    void *ecu;                  // State of the ECU adapter
+    unsigned long frames_sent;
+    unsigned long frames_received;
+} CosimNode;
+
+typedef struct Cosim {
+    TimerWheel wheel;
+    long long now_ms;
+    long long end_ms;           // Last instant simulated, COSIM_NO_END for none
+    CosimNode *nodes[COSIM_MAX_NODES];
+    unsigned int num_nodes;
+    unsigned long events;       // Tasks run
+    unsigned long frames;       // Frames put on the bus
+    uint64_t digest;            // FNV-1a over the time, ID and data of every frame
+    CanCaptureWriter *trace;    // Optional capture of the bus, stamped with virtual time
+} Cosim;
+
+void cosim_init(Cosim *sim);
+
+// Attach a node sending as can_node; receive gets every frame put on the bus
+bool cosim_add_node(Cosim *sim, CosimNode *node, const char *name, uint8_t can_node,
+                    CosimReceiveFn receive, void *ecu);
+
+/* Run task for node at now + delay_ms, then every period_ms (0: once). A task
+   may re-arm or cancel itself. */
+bool cosim_add_task(Cosim *sim, CosimTask *task, CosimNode *node, long long delay_ms,
+                    long long period_ms, CosimTaskFn run);
+void cosim_cancel_task(Cosim *sim, CosimTask *task);
+
+// End the run at end_ms, unless it already ends earlier
+void cosim_stop_at(Cosim *sim, long long end_ms);
+
+/* Run every event up to the end, or until none is left; returns the virtual
+   time reached. One simulation runs at a time in a process. */
+long long cosim_run(Cosim *sim);
+
+// Close the transports of every node
+void cosim_free(Cosim *sim);
+
+#endif // COSIM_H
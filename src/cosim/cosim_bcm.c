@@ -0,0 +1,111 @@
+#include "cosim_ecus.h"
+#include "../bcm/bcm_fleet.h"
+
+typedef struct {
+    BcmFleet fleet;
+    CosimTask task;
+    long long step_ms;
+    bool disabled;
+} CosimBcm;
+
+static void finish(CosimNode *node, long long now_ms)
+{
+    CosimBcm *bcm = (CosimBcm *)node->ecu;
+
+    cosim_cancel_task(node->sim, &bcm->task);
+    // One more period, so the other ECUs act on what the last step sent
+    cosim_stop_at(node->sim, now_ms + bcm->step_ms);
+}
+
+// The fleet keeps its own wheel: run it, then wait for its next event
+static void bcm_events(CosimNode *node, long long now_ms)
+{
+    CosimBcm *bcm = (CosimBcm *)node->ecu;
+
+    (void)bcm_fleet_advance(&bcm->fleet, now_ms);
+
+    const long long next_ms = timer_wheel_next_expiry(&bcm->fleet.wheel);
+    if ((bcm->fleet.running == 0U) || (next_ms < 0))
+    {
+        finish(node, now_ms);
+    }
+    else
+    {
+        (void)cosim_add_task(node->sim, &bcm->task, node, next_ms - now_ms, 0, bcm_events);
+    }
+}
+
+static void bcm_receive(CosimNode *node, const struct can_frame *frame, long long now_ms)
+{
+    CosimBcm *bcm = (CosimBcm *)node->ecu;
+    char message[AES_BLOCK_SIZE + 1];
+
+    // System disabled by another ECU: the simulation stops, as in bcm_scheduler
+    if ((bcm_receive_frame(frame, message) == BCM_RX_MESSAGE) &&
+        (strcmp(message, "error_disabled") == 0) && (bcm->fleet.running > 0U))
+    {
+        bcm->disabled = true;
+        bcm_fleet_stop_vehicle(&bcm->fleet, 0U);
+        finish(node, now_ms);
+    }
+}
+
+/**
+ * @brief Add the BCM: one vehicle replaying the scenario's drive cycle.
+ * @requirement SWR2.1
+ * @requirement SWR6.4
+ */
+bool cosim_bcm_attach(Cosim *sim, CosimNode *node, const CosimScenario *scenario)
+{
+    CosimBcm *bcm = (CosimBcm *)calloc(1U, sizeof(CosimBcm));
+    BcmFleetConfig config;
+
+    if ((bcm == NULL) || !cosim_add_node(sim, node, "bcm", CAN_NODE_BCM, bcm_receive, bcm))
+    {
+        free(bcm);
+        return false;
+    }
+
+    (void)memset(&config, 0, sizeof(config));
+    config.count = 1U;
+    config.cycle_paths[0] = scenario->cycle_path;
+    config.num_cycles = 1U;
+    config.socks[0] = node->tx_sock;
+    config.num_socks = 1U;
+    config.step_ms = scenario->step_ms;
+    config.timeout_ms = (long long)safety_timeout_ms;   // Virtual time is vehicle time
+    bcm->step_ms = scenario->step_ms;
+    can_reasm_reset(&bcm_reassembler);
+
+    if (!bcm_fleet_init(&bcm->fleet, &config, sim->now_ms))
+    {
+        free(bcm);
+        node->ecu = NULL;
+        return false;
+    }
+    const long long first_ms = timer_wheel_next_expiry(&bcm->fleet.wheel);
+    return cosim_add_task(sim, &bcm->task, node, first_ms - sim->now_ms, 0, bcm_events);
+}
+
+void cosim_bcm_report(const CosimNode *node, CosimReport *report)
+{
+    const CosimBcm *bcm = (const CosimBcm *)node->ecu;
+    const BcmVehicle *vehicle = &bcm->fleet.vehicles[0];
+
+    report->bcm_steps = vehicle->published;
+    report->bcm_faults = vehicle->fault_flags;
+    report->bcm_fault_ms = vehicle->fault_ms;
+    report->bcm_disabled = bcm->disabled;
+}
+
+void cosim_bcm_detach(CosimNode *node)
+{
+    CosimBcm *bcm = (CosimBcm *)node->ecu;
+
+    if (bcm != NULL)
+    {
+        bcm_fleet_free(&bcm->fleet);
+        free(bcm);
+        node->ecu = NULL;
+    }
+}
@@ -0,0 +1,235 @@
+#include "cosim_ecus.h"
+#include "../dashboard/dashboard_func.h"
+#include "../instrument_cluster/instrument_cluster_func.h"
+
+#define DEFAULT_PRESS_MS    (100LL)
+
+typedef struct {
+    bool (*attach)(Cosim *sim, CosimNode *node, const CosimScenario *scenario);
+    void (*report)(const CosimNode *node, CosimReport *report);
+    void (*detach)(CosimNode *node);
+} CosimAdapter;
+
+// In node order, which is also the order frames are collected in
+static const CosimAdapter adapters[COSIM_ECU_COUNT] = {
+    [COSIM_BCM]                = { cosim_bcm_attach, cosim_bcm_report, cosim_bcm_detach },
+    [COSIM_POWERTRAIN]         = { cosim_powertrain_attach, cosim_powertrain_report, cosim_powertrain_detach },
+    [COSIM_DASHBOARD]          = { cosim_dashboard_attach, cosim_dashboard_report, cosim_dashboard_detach },
+    [COSIM_INSTRUMENT_CLUSTER] = { cosim_cluster_attach, cosim_cluster_report, cosim_cluster_detach }
+};
+
+static const char *const ecu_names[COSIM_ECU_COUNT] = {
+    [COSIM_BCM]                = "bcm",
+    [COSIM_POWERTRAIN]         = "powertrain",
+    [COSIM_DASHBOARD]          = "dashboard",
+    [COSIM_INSTRUMENT_CLUSTER] = "instrument_cluster"
+};
+
+const char *cosim_ecu_name(CosimEcu ecu)
+{
+    return ((unsigned int)ecu < COSIM_ECU_COUNT) ? ecu_names[ecu] : NULL;
+}
+
+void cosim_scenario_default(CosimScenario *scenario)
+{
+    (void)memset(scenario, 0, sizeof(*scenario));
+    scenario->step_ms = COSIM_STEP_MS;
+    scenario->powertrain_phase_ms = COSIM_STEP_MS / 2LL;
+    scenario->presses_ms[0] = DEFAULT_PRESS_MS;
+    scenario->num_presses = 1U;
+    scenario->end_ms = COSIM_NO_END;
+}
+
+typedef struct {
+    unsigned long messages;     // Messages processed by the dashboard
+    unsigned long rejected;     // Messages it refused
+} CosimDashboard;
+
+/* Dashboard: what the receive and process coroutines do with a frame,
+   without the queue between them. The process metrics are shared by all
+   nodes, so the dashboard keeps its own counts. */
+static void dashboard_receive(CosimNode *node, const struct can_frame *frame, long long now_ms)
+{
+    CosimDashboard *dashboard = (CosimDashboard *)node->ecu;
+    char decrypted[AES_BLOCK_SIZE + 1];
+    const uint64_t failures = metrics_get(METRIC_DECRYPT_FAILURES);
+
+    (void)now_ms;
+    if (dashboard_receive_frame(frame, decrypted))
+    {
+        parse_input_received(decrypted);
+        metrics_inc(METRIC_MESSAGES_PROCESSED);
+        dashboard->messages++;
+    }
+    dashboard->rejected += (unsigned long)(metrics_get(METRIC_DECRYPT_FAILURES) - failures);
+}
+
+bool cosim_dashboard_attach(Cosim *sim, CosimNode *node, const CosimScenario *scenario)
+{
+    CosimDashboard *dashboard = (CosimDashboard *)calloc(1U, sizeof(CosimDashboard));
+
+    (void)scenario;
+    (void)memset(&actuators, 0, sizeof(actuators));
+    init_can_buffer();
+    if ((dashboard == NULL) ||
+        !cosim_add_node(sim, node, "dashboard", CAN_NODE_DASHBOARD, dashboard_receive, dashboard))
+    {
+        free(dashboard);
+        cleanup_can_buffer();
+        return false;
+    }
+    return true;
+}
+
+void cosim_dashboard_report(const CosimNode *node, CosimReport *report)
+{
+    const CosimDashboard *dashboard = (const CosimDashboard *)node->ecu;
+
+    report->dash_messages = dashboard->messages;
+    report->dash_rejected = dashboard->rejected;
+    report->dash_enabled = actuators.start_stop_active;
+    report->dash_error = (actuators.error_system != 0);
+}
+
+void cosim_dashboard_detach(CosimNode *node)
+{
+    cleanup_can_buffer();
+    free(node->ecu);
+    node->ecu = NULL;
+}
+
+typedef struct {
+    CosimTask presses[COSIM_MAX_PRESSES];
+    unsigned long sent;
+} CosimCluster;
+
+// The driver presses the Start/Stop button
+static void press_button(CosimNode *node, long long now_ms)
+{
+    CosimCluster *cluster = (CosimCluster *)node->ecu;
+    char command[] = "press_start_stop";
+
+    (void)now_ms;
+    if (check_input_command(command, node->tx_sock))
+    {
+        cluster->sent++;
+    }
+}
+
+bool cosim_cluster_attach(Cosim *sim, CosimNode *node, const CosimScenario *scenario)
+{
+    CosimCluster *cluster = (CosimCluster *)calloc(1U, sizeof(CosimCluster));
+
+    if ((cluster == NULL) ||
+        !cosim_add_node(sim, node, "instrument_cluster", CAN_NODE_INSTRUMENT_CLUSTER, NULL, cluster))
+    {
+        free(cluster);
+        return false;
+    }
+
+    bool ok = true;
+    for (unsigned int i = 0U; ok && (i < scenario->num_presses); i++)
+    {
+        ok = cosim_add_task(sim, &cluster->presses[i], node, scenario->presses_ms[i] - sim->now_ms,
+                            0, press_button);
+    }
+    return ok;
+}
+
+void cosim_cluster_report(const CosimNode *node, CosimReport *report)
+{
+    const CosimCluster *cluster = (const CosimCluster *)node->ecu;
+
+    report->presses = cluster->sent;
+}
+
+void cosim_cluster_detach(CosimNode *node)
+{
+    free(node->ecu);
+    node->ecu = NULL;
+}
+
+static bool scenario_valid(const CosimScenario *scenario)
+{
+    if ((scenario->cycle_path == NULL) || (scenario->step_ms < COSIM_TICK_MS) ||
+        (scenario->powertrain_phase_ms < 0) || (scenario->num_presses > COSIM_MAX_PRESSES))
+    {
+        return false;
+    }
+    for (unsigned int i = 0U; i < scenario->num_presses; i++)
+    {
+        if (scenario->presses_ms[i] < 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Co-simulate the BCM, powertrain, dashboard and instrument cluster
+ * over one scenario, in virtual time.
+ */
+bool cosim_vehicle_run(const CosimScenario *scenario, CosimReport *report)
+{
+    Cosim sim;
+    CosimNode nodes[COSIM_ECU_COUNT];
+    CanCaptureWriter *trace = NULL;
+    unsigned int attached = 0U;
+
+    (void)memset(report, 0, sizeof(*report));
+    if (!scenario_valid(scenario))
+    {
+        (void)fprintf(stderr, "Invalid co-simulation scenario\n");
+        return false;
+    }
+
+    cosim_init(&sim);
+    if (scenario->end_ms != COSIM_NO_END)
+    {
+        cosim_stop_at(&sim, scenario->end_ms);
+    }
+    if (scenario->trace_path != NULL)
+    {
+        trace = (CanCaptureWriter *)malloc(sizeof(CanCaptureWriter));
+        if ((trace == NULL) || !can_capture_open_writer(trace, scenario->trace_path))
+        {
+            free(trace);
+            return false;
+        }
+        sim.trace = trace;
+    }
+
+    while ((attached < COSIM_ECU_COUNT) && adapters[attached].attach(&sim, &nodes[attached], scenario))
+    {
+        attached++;
+    }
+
+    const bool ok = (attached == COSIM_ECU_COUNT);
+    if (ok)
+    {
+        report->sim_ms = cosim_run(&sim);
+        report->events = sim.events;
+        report->frames = sim.frames;
+        report->digest = sim.digest;
+        for (unsigned int i = 0U; i < COSIM_ECU_COUNT; i++)
+        {
+            report->frames_sent[i] = nodes[i].frames_sent;
+            adapters[i].report(&nodes[i], report);
+        }
+    }
+
+    // A failed attach cleaned up after itself
+    while (attached > 0U)
+    {
+        attached--;
+        adapters[attached].detach(&nodes[attached]);
+    }
+    cosim_free(&sim);
+    if (trace != NULL)
+    {
+        (void)can_capture_close_writer(trace);
+        free(trace);
+    }
+    return ok;
+}
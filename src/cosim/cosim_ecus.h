@@ -0,0 +1,96 @@
+#ifndef COSIM_ECUS_H
+#define COSIM_ECUS_H
+
+#include "cosim.h"
+#include "../common_includes/fuel_savings.h"
+
+/*
+ * The four ECUs of the Stop/Start system as co-simulation nodes.
+ *
+ *   BCM                 its fleet of one vehicle (the step and publish
+ *                       events of bcm_scheduler, watchdog included) on
+ *                       virtual time; an error_disabled message stops it
+ *   powertrain          start_stop_step every period, as the start_stop
+ *                       coroutine; frames go through powertrain_receive_frame
+ *                       as they arrive, as in the comms coroutine
+ *   dashboard           dashboard_receive_frame and parse_input_received, as
+ *                       the receive and process coroutines, headless
+ *   instrument cluster  check_input_command at the scripted button presses
+ *
+ * The ECUs keep their state in process-wide variables: the adapters reset it
+ * when a run starts, so runs in the same process are independent.
+ */
+#define COSIM_MAX_PRESSES       (16U)
+#define COSIM_STEP_MS           (1000LL)    // BCM step and Stop/Start period
+
+typedef enum {
+    COSIM_BCM = 0,
+    COSIM_POWERTRAIN,
+    COSIM_DASHBOARD,
+    COSIM_INSTRUMENT_CLUSTER,
+    COSIM_ECU_COUNT
+} CosimEcu;
+
+typedef struct {
+    const char *cycle_path;
+    const char *rules_path;         // NULL: built-in calibration
+    const char *telemetry_path;     // NULL: no powertrain telemetry
+    const char *trace_path;         // NULL: no capture of the bus
+    long long step_ms;
+    long long powertrain_phase_ms;  // First Stop/Start period, from the first BCM step
+    long long presses_ms[COSIM_MAX_PRESSES];    // Start/Stop button presses
+    unsigned int num_presses;
+    long long end_ms;               // COSIM_NO_END: until the drive cycle ends
+} CosimScenario;
+
+typedef struct {
+    long long sim_ms;               // Virtual time reached
+    unsigned long events;
+    unsigned long frames;
+    uint64_t digest;
+    unsigned long frames_sent[COSIM_ECU_COUNT];
+    // BCM
+    unsigned long bcm_steps;        // Steps published
+    unsigned int bcm_faults;        // HEALTH_FAULT_* bits reported, 0 if none
+    long long bcm_fault_ms;
+    bool bcm_disabled;              // Stopped by an error_disabled message
+    // Powertrain
+    unsigned long pt_messages;
+    unsigned long pt_rejected;
+    bool pt_enabled;
+    FuelSavings savings;
+    // Dashboard
+    unsigned long dash_messages;
+    unsigned long dash_rejected;
+    bool dash_enabled;
+    bool dash_error;
+    // Instrument cluster
+    unsigned long presses;
+} CosimReport;
+
+// 1 s steps, Stop/Start half a step after the BCM, one press at 100 ms
+void cosim_scenario_default(CosimScenario *scenario);
+
+const char *cosim_ecu_name(CosimEcu ecu);
+
+// Run the four ECUs over one scenario; false if it could not start
+bool cosim_vehicle_run(const CosimScenario *scenario, CosimReport *report);
+
+// ECU adapters: add the ECU as a node, fill its part of the report, release it
+bool cosim_bcm_attach(Cosim *sim, CosimNode *node, const CosimScenario *scenario);
+void cosim_bcm_report(const CosimNode *node, CosimReport *report);
+void cosim_bcm_detach(CosimNode *node);
+
+bool cosim_powertrain_attach(Cosim *sim, CosimNode *node, const CosimScenario *scenario);
+void cosim_powertrain_report(const CosimNode *node, CosimReport *report);
+void cosim_powertrain_detach(CosimNode *node);
+
+bool cosim_dashboard_attach(Cosim *sim, CosimNode *node, const CosimScenario *scenario);
+void cosim_dashboard_report(const CosimNode *node, CosimReport *report);
+void cosim_dashboard_detach(CosimNode *node);
+
+bool cosim_cluster_attach(Cosim *sim, CosimNode *node, const CosimScenario *scenario);
+void cosim_cluster_report(const CosimNode *node, CosimReport *report);
+void cosim_cluster_detach(CosimNode *node);
+
+#endif // COSIM_ECUS_H
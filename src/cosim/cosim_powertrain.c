@@ -0,0 +1,96 @@
+#include "cosim_ecus.h"
+#include "../powertrain/powertrain_func.h"
+
+typedef struct {
+    CosimTask task;
+    unsigned long messages;     // Messages processed by the powertrain
+    unsigned long rejected;     // Messages it refused
+} CosimPowertrain;
+
+/* One pass of the start_stop coroutine, on virtual time. Virtual time does
+   not pass inside a task: the gap the coroutine leaves between error_battery
+   and error_disabled is skipped, both frames go out at the same instant, in
+   that order. */
+static void powertrain_period(CosimNode *node, long long now_ms)
+{
+    (void)node;
+    start_stop_step(&rec_data);
+    (void)send_pending_disable();
+    record_powertrain_step(&rec_data, now_ms);
+    update_powertrain_savings(&rec_data, now_ms);
+}
+
+// The process metrics are shared by all nodes: count what this frame added
+static void powertrain_receive(CosimNode *node, const struct can_frame *frame, long long now_ms)
+{
+    CosimPowertrain *powertrain = (CosimPowertrain *)node->ecu;
+    const uint64_t processed = metrics_get(METRIC_MESSAGES_PROCESSED);
+    const uint64_t failures = metrics_get(METRIC_DECRYPT_FAILURES);
+
+    (void)now_ms;
+    (void)powertrain_receive_frame(frame);
+    powertrain->messages += (unsigned long)(metrics_get(METRIC_MESSAGES_PROCESSED) - processed);
+    powertrain->rejected += (unsigned long)(metrics_get(METRIC_DECRYPT_FAILURES) - failures);
+}
+
+// State of a powertrain that just started
+static void reset_powertrain(void)
+{
+    (void)memset(&rec_data, 0, sizeof(rec_data));
+    start_stop_manual = false;
+    engine_off = false;
+    restart_trigger = false;
+    disable_pending = false;
+    engine_condition_bits = 0U;
+    can_reasm_reset(&powertrain_reassembler);
+    fuel_savings_reset(&powertrain_savings);
+}
+
+/**
+ * @brief Add the powertrain: Stop/Start every period from the phase on.
+ * @requirement SWR1.2
+ */
+bool cosim_powertrain_attach(Cosim *sim, CosimNode *node, const CosimScenario *scenario)
+{
+    // Rule file errors are reported before anything runs
+    if (!load_stop_start_rules(scenario->rules_path))
+    {
+        return false;
+    }
+    reset_powertrain();
+    if ((scenario->telemetry_path != NULL) && !open_powertrain_telemetry(scenario->telemetry_path, false))
+    {
+        (void)fprintf(stderr, "Failed to open telemetry file %s\n", scenario->telemetry_path);
+        return false;
+    }
+
+    CosimPowertrain *powertrain = (CosimPowertrain *)calloc(1U, sizeof(CosimPowertrain));
+    if ((powertrain == NULL) ||
+        !cosim_add_node(sim, node, "powertrain", CAN_NODE_POWERTRAIN, powertrain_receive, powertrain))
+    {
+        free(powertrain);
+        close_powertrain_telemetry();
+        return false;
+    }
+    sock_sender = node->tx_sock;
+    return cosim_add_task(sim, &powertrain->task, node, scenario->powertrain_phase_ms,
+                          scenario->step_ms, powertrain_period);
+}
+
+void cosim_powertrain_report(const CosimNode *node, CosimReport *report)
+{
+    const CosimPowertrain *powertrain = (const CosimPowertrain *)node->ecu;
+
+    report->pt_messages = powertrain->messages;
+    report->pt_rejected = powertrain->rejected;
+    report->pt_enabled = start_stop_manual;
+    report->savings = powertrain_savings;
+}
+
+void cosim_powertrain_detach(CosimNode *node)
+{
+    close_powertrain_telemetry();
+    sock_sender = -1;
+    free(node->ecu);
+    node->ecu = NULL;
+}
@@ -0,0 +1,198 @@
+/*
+ * Co-simulation of the Stop/Start system: BCM, powertrain, dashboard and
+ * instrument cluster in one process, on one event queue and a virtual CAN
+ * bus (cosim.h, cosim_ecus.h). A drive cycle runs in virtual time, as fast
+ * as the ECU code itself, and the same scenario always gives the same bus
+ * traffic: the digest printed can be compared between builds, and -n runs
+ * the scenario several times and fails unless every digest matches.
+ */
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cosim_ecus.h"
+#include "../dashboard/panels.h"
+
+#define ERROR_CODE          (1)
+#define DEFAULT_CYCLE       ("../src/bcm/full_simu.csv")
+#define MAX_RUNS            (1000U)
+#define MS_PER_SEC          (1000.0)
+#define NSEC_PER_SEC        (1000000000.0)
+#define SAVINGS_TEXT_SIZE   (160U)
+
+// The dashboard runs headless
+ValuePanel *panel_dash = NULL;
+ScrollPanel *panel_log = NULL;
+
+static void usage(const char *prog)
+{
+    (void)fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  -c FILE     drive cycle (default %s)\n"
+        "  -r FILE     Stop/Start rule file (default: built-in calibration)\n"
+        "  -t FILE     powertrain telemetry output\n"
+        "  -o FILE     capture of the bus, stamped with virtual time\n"
+        "  -s MS       BCM step and Stop/Start period (default %lld)\n"
+        "  -P MS       first Stop/Start period (default %lld)\n"
+        "  -p LIST     Start/Stop presses in ms, comma separated, or none (default %lld)\n"
+        "  -d SECONDS  simulated duration (default: until the cycle ends)\n"
+        "  -n RUNS     runs, which must all give the same digest (default 1)\n"
+        "  -v          keep the ECUs' console output\n",
+        prog, DEFAULT_CYCLE, COSIM_STEP_MS, COSIM_STEP_MS / 2LL, COSIM_STEP_MS / 10LL);
+}
+
+static double now_s(void)
+{
+    struct timespec now;
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + ((double)now.tv_nsec / NSEC_PER_SEC);
+}
+
+static bool parse_presses(const char *list, CosimScenario *scenario)
+{
+    char copy[SAVINGS_TEXT_SIZE];
+    char *save = NULL;
+
+    scenario->num_presses = 0U;
+    if (strcmp(list, "none") == 0)
+    {
+        return true;
+    }
+    if (strlen(list) >= sizeof(copy))
+    {
+        return false;
+    }
+    (void)strcpy(copy, list);
+    for (char *item = strtok_r(copy, ",", &save); item != NULL; item = strtok_r(NULL, ",", &save))
+    {
+        char *end = NULL;
+        const long long press_ms = strtoll(item, &end, 10);
+        if ((*end != '\0') || (press_ms < 0) || (scenario->num_presses >= COSIM_MAX_PRESSES))
+        {
+            return false;
+        }
+        scenario->presses_ms[scenario->num_presses] = press_ms;
+        scenario->num_presses++;
+    }
+    return scenario->num_presses > 0U;
+}
+
+static void print_report(FILE *out, const CosimReport *report, double wall_s)
+{
+    char savings[SAVINGS_TEXT_SIZE];
+    const double sim_s = (double)report->sim_ms / MS_PER_SEC;
+
+    (void)fuel_savings_format(&report->savings, savings, sizeof(savings));
+    (void)fprintf(out, "Simulated %.3f s in %.4f s (%.0fx real time)\n", sim_s, wall_s,
+                  (wall_s > 0.0) ? (sim_s / wall_s) : 0.0);
+    (void)fprintf(out, "Events %lu, frames %lu, digest %016llx\n", report->events, report->frames,
+                  (unsigned long long)report->digest);
+    (void)fprintf(out, "  %-18s sent %lu, steps %lu, faults 0x%x at %lld ms, disabled %s\n",
+                  cosim_ecu_name(COSIM_BCM), report->frames_sent[COSIM_BCM], report->bcm_steps,
+                  report->bcm_faults, report->bcm_fault_ms, report->bcm_disabled ? "yes" : "no");
+    (void)fprintf(out, "  %-18s sent %lu, messages %lu, rejected %lu, Stop/Start %s, %s\n",
+                  cosim_ecu_name(COSIM_POWERTRAIN), report->frames_sent[COSIM_POWERTRAIN],
+                  report->pt_messages, report->pt_rejected, report->pt_enabled ? "on" : "off", savings);
+    (void)fprintf(out, "  %-18s messages %lu, rejected %lu, Stop/Start %s, error %s\n",
+                  cosim_ecu_name(COSIM_DASHBOARD), report->dash_messages, report->dash_rejected,
+                  report->dash_enabled ? "on" : "off", report->dash_error ? "yes" : "no");
+    (void)fprintf(out, "  %-18s sent %lu, presses %lu\n",
+                  cosim_ecu_name(COSIM_INSTRUMENT_CLUSTER), report->frames_sent[COSIM_INSTRUMENT_CLUSTER],
+                  report->presses);
+}
+
+int main(int argc, char **argv)
+{
+    CosimScenario scenario;
+    unsigned int runs = 1U;
+    bool verbose = false;
+    int opt;
+
+    cosim_scenario_default(&scenario);
+    scenario.cycle_path = DEFAULT_CYCLE;
+
+    while ((opt = getopt(argc, argv, "c:r:t:o:s:P:p:d:n:vh")) != -1)
+    {
+        bool valid = true;
+        switch (opt)
+        {
+        case 'c': scenario.cycle_path = optarg; break;
+        case 'r': scenario.rules_path = optarg; break;
+        case 't': scenario.telemetry_path = optarg; break;
+        case 'o': scenario.trace_path = optarg; break;
+        case 's': scenario.step_ms = strtoll(optarg, NULL, 10); break;
+        case 'P': scenario.powertrain_phase_ms = strtoll(optarg, NULL, 10); break;
+        case 'p': valid = parse_presses(optarg, &scenario); break;
+        case 'd': scenario.end_ms = (long long)(strtod(optarg, NULL) * MS_PER_SEC); break;
+        case 'n': runs = (unsigned int)strtoul(optarg, NULL, 10); break;
+        case 'v': verbose = true; break;
+        default: valid = false; break;
+        }
+        if (!valid)
+        {
+            usage(argv[0]);
+            return ERROR_CODE;
+        }
+    }
+    if ((runs == 0U) || (runs > MAX_RUNS) || (scenario.step_ms < COSIM_TICK_MS) ||
+        (scenario.powertrain_phase_ms < 0) || ((scenario.end_ms < 0) && (scenario.end_ms != COSIM_NO_END)))
+    {
+        usage(argv[0]);
+        return ERROR_CODE;
+    }
+
+    // The ECUs print every message they handle: keep the report readable
+    FILE *out = stdout;
+    if (!verbose)
+    {
+        const int report_fd = dup(STDOUT_FILENO);
+        const int null_fd = open("/dev/null", O_WRONLY);
+        if ((report_fd < 0) || (null_fd < 0) || ((out = fdopen(report_fd, "w")) == NULL) ||
+            (dup2(null_fd, STDOUT_FILENO) < 0))
+        {
+            perror("Failed to silence the ECUs");
+            return ERROR_CODE;
+        }
+        (void)close(null_fd);
+    }
+
+    CosimReport first;
+    bool ok = true;
+    for (unsigned int run = 0U; ok && (run < runs); run++)
+    {
+        CosimReport report;
+        const double start = now_s();
+        if (!cosim_vehicle_run(&scenario, &report))
+        {
+            (void)fprintf(stderr, "Co-simulation of %s failed\n", scenario.cycle_path);
+            ok = false;
+        }
+        else if (run == 0U)
+        {
+            first = report;
+            print_report(out, &report, now_s() - start);
+        }
+        else if ((report.digest != first.digest) || (report.frames != first.frames) ||
+                 (report.sim_ms != first.sim_ms))
+        {
+            (void)fprintf(out, "Run %u: digest %016llx differs from run 1\n", run + 1U,
+                          (unsigned long long)report.digest);
+            ok = false;
+        }
+        else
+        {
+            // Same bus traffic as the first run
+        }
+    }
+    if (ok && (runs > 1U))
+    {
+        (void)fprintf(out, "%u runs, identical digests\n", runs);
+    }
+    (void)fflush(out);
+    return ok ? 0 : ERROR_CODE;
+}
@@ -0,0 +1,273 @@
+/*
+ * Drive cycle generator (replaces bcm/gen_simu.py).
+ *
+ * Expands a base speed trace into the full cycles the BCM replays (see
+ * drive_cycle.h), as CSV or as binary cycle files. Several cycles are built
+ * in parallel, one file each; cycle N of a seed is always the same, so a
+ * fleet study can regenerate exactly the cycles it needs (-c, -n).
+ */
+#include <getopt.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../common_includes/drive_cycle.h"
+
+#define ERROR_CODE          (1)
+#define DEFAULT_BASE        ("../src/bcm/ftp75.csv")
+#define DEFAULT_OUTPUT      ("full_simu.csv")
+#define BINARY_EXTENSION    (".bin")
+#define MAX_THREADS         (64U)
+#define PATH_SIZE           (512)
+#define NSEC_PER_SEC        (1000000000.0)
+
+typedef struct {
+    const DriveCycleBase *base;
+    const DriveCycleParams *params;
+    const char *output;
+    DriveCycleFormat format;
+    uint32_t first;
+    uint32_t count;
+    uint32_t next;              // Next cycle to build, shared by the workers
+    bool failed;
+} GenJob;
+
+static void usage(const char *prog)
+{
+    (void)fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  -b FILE     base speed trace (default %s)\n"
+        "  -o FILE     output, \"-\" for stdout (default %s)\n"
+        "              with -n > 1 the cycle number is added: cycle.bin -> cycle_0007.bin\n"
+        "  -f FORMAT   csv or bin (default: bin for a .bin output, else csv)\n"
+        "  -s SEED     random seed (default 1)\n"
+        "  -c FIRST    number of the first cycle (default 0)\n"
+        "  -n COUNT    number of cycles (default 1)\n"
+        "  -j THREADS  worker threads (default: online CPUs)\n"
+        "  -i MIN:MAX  internal temperature range (default 20:25)\n"
+        "  -e MIN:MAX  external temperature range (default 26:31)\n"
+        "  -p PROB     per row chance of a temperature change (default 0.01)\n"
+        "  -d PROB     per stopped row chance of an open door (default 0.1)\n"
+        "  -a DEG      largest tilt step while moving (default 1.0)\n"
+        "  -x SCALE    speed scale factor (default 1.0)\n"
+        "  -q          no throughput report\n",
+        prog, DEFAULT_BASE, DEFAULT_OUTPUT);
+}
+
+static bool parse_range(const char *text, int *low, int *high)
+{
+    return (sscanf(text, "%d:%d", low, high) == 2) && (*low < *high);
+}
+
+static bool has_extension(const char *path, const char *extension)
+{
+    const size_t len = strlen(path);
+    const size_t ext_len = strlen(extension);
+    return (len >= ext_len) && (strcmp(&path[len - ext_len], extension) == 0);
+}
+
+// "dir/cycle.bin" -> "dir/cycle_0007.bin"
+static void cycle_path(const char *output, uint32_t cycle, bool numbered, char *path, size_t size)
+{
+    const char *slash = strrchr(output, '/');
+    const char *dot = strrchr(output, '.');
+
+    if (!numbered)
+    {
+        (void)snprintf(path, size, "%s", output);
+    }
+    else if ((dot == NULL) || ((slash != NULL) && (dot < slash)))
+    {
+        (void)snprintf(path, size, "%s_%04u", output, cycle);
+    }
+    else
+    {
+        (void)snprintf(path, size, "%.*s_%04u%s", (int)(dot - output), output, cycle, dot);
+    }
+}
+
+static void *gen_worker(void *arg)
+{
+    GenJob *job = (GenJob *)arg;
+    char path[PATH_SIZE];
+    DriveCycleRow *rows = (DriveCycleRow *)malloc(job->base->rows * sizeof(DriveCycleRow));
+    DriveCycleWriter *writer = (DriveCycleWriter *)malloc(sizeof(DriveCycleWriter));
+
+    if ((rows == NULL) || (writer == NULL))
+    {
+        __atomic_store_n(&job->failed, true, __ATOMIC_RELAXED);
+    }
+    while (!__atomic_load_n(&job->failed, __ATOMIC_RELAXED))
+    {
+        const uint32_t index = __atomic_fetch_add(&job->next, 1U, __ATOMIC_RELAXED);
+        if (index >= job->count)
+        {
+            break;
+        }
+        const uint32_t cycle = job->first + index;
+        drive_cycle_synthesize(job->base, job->params, cycle, rows);
+
+        cycle_path(job->output, cycle, job->count > 1U, path, sizeof(path));
+        bool ok = drive_cycle_open_writer(writer, path, job->format);
+        ok = ok && drive_cycle_write(writer, job->params->seed, cycle, rows, job->base->rows);
+        ok = drive_cycle_close_writer(writer) && ok;
+        if (!ok)
+        {
+            (void)fprintf(stderr, "Error writing %s\n", path);
+            __atomic_store_n(&job->failed, true, __ATOMIC_RELAXED);
+        }
+    }
+    free(writer);
+    free(rows);
+    return NULL;
+}
+
+// Stdout keeps the cycles in order: one writer, cycles back to back
+static bool gen_stream(GenJob *job)
+{
+    DriveCycleRow *rows = (DriveCycleRow *)malloc(job->base->rows * sizeof(DriveCycleRow));
+    DriveCycleWriter *writer = (DriveCycleWriter *)malloc(sizeof(DriveCycleWriter));
+    bool ok = (rows != NULL) && (writer != NULL) &&
+              drive_cycle_open_writer(writer, DRIVE_CYCLE_STDOUT, job->format);
+
+    for (uint32_t index = 0U; ok && (index < job->count); index++)
+    {
+        drive_cycle_synthesize(job->base, job->params, job->first + index, rows);
+        ok = drive_cycle_write(writer, job->params->seed, job->first + index, rows, job->base->rows);
+    }
+    if (writer != NULL)
+    {
+        ok = drive_cycle_close_writer(writer) && ok;
+    }
+    free(writer);
+    free(rows);
+    return ok;
+}
+
+static double now_s(void)
+{
+    struct timespec now;
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + ((double)now.tv_nsec / NSEC_PER_SEC);
+}
+
+int main(int argc, char **argv)
+{
+    DriveCycleParams params;
+    DriveCycleBase base;
+    GenJob job;
+    const char *base_path = DEFAULT_BASE;
+    const char *format_name = NULL;
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    bool quiet = false;
+    int opt;
+
+    drive_cycle_default_params(&params);
+    (void)memset(&job, 0, sizeof(job));
+    job.output = DEFAULT_OUTPUT;
+    job.count = 1U;
+
+    while ((opt = getopt(argc, argv, "b:o:f:s:c:n:j:i:e:p:d:a:x:qh")) != -1)
+    {
+        bool valid = true;
+        switch (opt)
+        {
+        case 'b': base_path = optarg; break;
+        case 'o': job.output = optarg; break;
+        case 'f': format_name = optarg; break;
+        case 's': params.seed = strtoull(optarg, NULL, 0); break;
+        case 'c': job.first = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 'n': job.count = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 'j': threads = strtol(optarg, NULL, 10); break;
+        case 'i': valid = parse_range(optarg, &params.internal_min, &params.internal_max); break;
+        case 'e': valid = parse_range(optarg, &params.external_min, &params.external_max); break;
+        case 'p': params.change_probability = strtod(optarg, NULL); break;
+        case 'd': params.door_probability = strtod(optarg, NULL); break;
+        case 'a': params.max_tilt_change = strtod(optarg, NULL); break;
+        case 'x': params.speed_scale = strtod(optarg, NULL); break;
+        case 'q': quiet = true; break;
+        default: valid = false; break;
+        }
+        if (!valid)
+        {
+            usage(argv[0]);
+            return ERROR_CODE;
+        }
+    }
+
+    if (format_name == NULL)
+    {
+        job.format = has_extension(job.output, BINARY_EXTENSION) ? DRIVE_CYCLE_BINARY : DRIVE_CYCLE_CSV;
+    }
+    else if ((strcmp(format_name, "csv") == 0) || (strcmp(format_name, "bin") == 0))
+    {
+        job.format = (strcmp(format_name, "bin") == 0) ? DRIVE_CYCLE_BINARY : DRIVE_CYCLE_CSV;
+    }
+    else
+    {
+        usage(argv[0]);
+        return ERROR_CODE;
+    }
+    if ((job.count == 0U) || (threads < 1L))
+    {
+        usage(argv[0]);
+        return ERROR_CODE;
+    }
+    if (threads > (long)job.count)
+    {
+        threads = (long)job.count;
+    }
+    if (threads > (long)MAX_THREADS)
+    {
+        threads = (long)MAX_THREADS;
+    }
+
+    if (!drive_cycle_load_base(&base, base_path))
+    {
+        return ERROR_CODE;
+    }
+    job.base = &base;
+    job.params = &params;
+
+    const double start = now_s();
+    bool ok;
+    if (strcmp(job.output, DRIVE_CYCLE_STDOUT) == 0)
+    {
+        ok = gen_stream(&job);
+    }
+    else
+    {
+        pthread_t workers[MAX_THREADS];
+        long started = 0L;
+        for (; started < threads; started++)
+        {
+            if (pthread_create(&workers[started], NULL, gen_worker, &job) != 0)
+            {
+                break;
+            }
+        }
+        if (started == 0L)
+        {
+            (void)gen_worker(&job);
+        }
+        for (long i = 0L; i < started; i++)
+        {
+            (void)pthread_join(workers[i], NULL);
+        }
+        ok = !job.failed;
+    }
+    const double elapsed = now_s() - start;
+
+    if (!quiet)
+    {
+        const double rows = (double)base.rows * (double)job.count;
+        (void)fprintf(stderr, "%u cycles, %.0f rows in %.3f s (%.0f rows/s)\n",
+                      job.count, rows, elapsed, (elapsed > 0.0) ? (rows / elapsed) : 0.0);
+    }
+    drive_cycle_free_base(&base);
+    return ok ? EXIT_SUCCESS : ERROR_CODE;
+}
@@ -1,8 +1,11 @@
 #include "dashboard_func.h"
+#include "dashboard_tasks.h"
+#include "../common_includes/ecu_shutdown.h"
 
 #define CAN_INTERFACE ("vcan0")
 #define SUCCESS_CODE (0)
 #define ERROR_CODE (1)
+#define SCHED_TICK_MS (10LL)
 
 /* UI */
 
@@ -14,6 +17,12 @@ int main(void)
 {
     /* UI */
 
+    // SIGINT/SIGTERM end the loop below through a signalfd, so endwin() runs
+    if (!ecu_shutdown_init())
+    {
+        return ERROR_CODE;
+    }
+
     if (!initscr())
     {
         fprintf(stderr, "Error initializing ncurses.\n");
@@ -43,8 +52,23 @@ int main(void)
         return ERROR_CODE;
     }
 
+    // Opt-in RT mode (ECU_RT=1): memory is locked before the threads start
+    (void)rt_init("dashboard");
+
     /* CAN communication */
 
+    set_can_node_id(CAN_NODE_DASHBOARD);
+    metrics_init("dashboard");
+    (void)live_state_create(&dash_live, "dashboard");
+    // Opt-in snapshots (ECU_CHECKPOINT_DIR): counters and values carry over a restart
+    if (checkpoint_init(&dash_checkpoint, "dashboard") && restore_dashboard_checkpoint())
+    {
+        add_to_log(panel_log, "Resumed from checkpoint");
+        redraw_dashboard_values();
+        publish_dashboard_live();
+    }
+    // The periodic snapshots are written off the processing loop
+    (void)checkpoint_start_writer(&dash_checkpoint);
     sock_dash = -1;
     sock_dash = create_can_socket(CAN_INTERFACE);
     if (sock_dash < 0)
@@ -54,33 +78,34 @@ int main(void)
 
     add_to_log(panel_log, "Waiting CAN frames...");
 
-    /* Create CAN thread */
-    pthread_t can_thread;
-    pthread_t parse_thread;
-
     init_can_buffer();
 
-    if (pthread_create(&can_thread, NULL, can_receiver_thread, NULL) != 0) {
-        add_to_log(panel_log, "ERROR: Thread creation failed");
-        close_can_socket(sock_dash);
-        return ERROR_CODE;
-    }
+    /* Reception and parsing are coroutines on this thread (dashboard_tasks.h) */
+    static CoroScheduler sched;
+    static DashboardTasks tasks;
+    static Coro shutdown_co;
 
-    if (pthread_create(&parse_thread, NULL, process_frame_thread, NULL) != 0) {
-        add_to_log(panel_log, "ERROR: Thread creation failed");
+    if (!coro_sched_init(&sched, SCHED_TICK_MS) || !dashboard_tasks_spawn(&sched, &tasks) ||
+        !ecu_shutdown_spawn(&sched, &shutdown_co)) {
+        add_to_log(panel_log, "ERROR: Scheduler setup failed");
         close_can_socket(sock_dash);
         return ERROR_CODE;
     }
+    (void)rt_configure_thread("dashboard", 0U, 0);
 
-    pthread_join(can_thread, NULL);
-    pthread_join(parse_thread, NULL);
+    coro_sched_run(&sched, ecu_shutdown_flag());
 
     /* Cleanup */
-    pthread_cancel(can_thread);
-    pthread_cancel(parse_thread);
-    
+    (void)metrics_write();
+    if (checkpoint_enabled(&dash_checkpoint))
+    {
+        checkpoint_stop_writer(&dash_checkpoint);
+        (void)save_dashboard_checkpoint();
+    }
+    coro_sched_close(&sched);
     close_can_socket(sock_dash);
     cleanup_can_buffer();
+    live_state_close(&dash_live);
     
     /* UI cleanup */
     destroy_panel(panel_log->win);
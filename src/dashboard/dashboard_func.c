@@ -1,26 +1,32 @@
 #include "dashboard_func.h"
 #include <time.h>
 
-#define CAN_DATA_LENGTH (8)
-#define PROCESS_TIMEOUT (100000000L)
-#define NANO_TO_SEC (1000000000L)
-
 Actuators actuators = {0};
 
+int num_deactivs = 0;
+
 // Shared buffer for CAN messages
 static CanBuffer can_buffer;
 
+// Per CAN ID reassembly of received fragments
+static CanReassembler dash_reassembler;
+
 int sock_dash;
 
 bool test_mode_dash = false;
 
+// Live state for external monitors (published once created in main)
+LiveState dash_live;
+
+Checkpoint dash_checkpoint;
+
 // Initialize buffer (call once at startup)
 void init_can_buffer(void) {
     can_buffer.head = 0;
     can_buffer.tail = 0;
+    can_reasm_reset(&dash_reassembler);
     sem_init(&can_buffer.sem, 0, 0);
     pthread_mutex_init(&can_buffer.mutex, NULL);
-    pthread_cond_init(&can_buffer.cond, NULL);
     memset(can_buffer.messages, 0, sizeof(can_buffer.messages));  // Clear all slots
 }
 
@@ -51,6 +57,11 @@ bool check_is_valid_can_id(canid_t can_id)
 
 void parse_input_received(char *input)
 {
+    // Sensor PDUs are binary, everything else is a text message
+    if (process_sensor_pdu((const unsigned char *)input))
+    {
+        return;
+    }
     process_user_commands(input);
     process_engine_commands(input);
     process_sensor_readings(input);
@@ -87,6 +98,7 @@ void process_engine_commands(char *input)
     }
     else if (strcmp(input, "ENGINE OFF") == 0)
     {    
+        actuators.engine_off = true;
         log_toggle_event("[INFO] Engine Deactivated by Stop/Start");
         update_value_panel(panel_dash, ENGINE_ST_ROW, "OFF", RED_TEXT);
         add_to_log(panel_log, "Engine Deactivated - Stop/Start");
@@ -98,6 +110,7 @@ void process_engine_commands(char *input)
     }
     else if (strcmp(input, "RESTART") == 0)
     {
+        actuators.engine_off = false;
         log_toggle_event("[INFO] Engine Activated by Stop/Start");
         update_value_panel(panel_dash, ENGINE_ST_ROW, "ON", GREEN_TEXT);
         add_to_log(panel_log, "Engine Activated - Stop/Start");
@@ -185,6 +198,102 @@ void process_sensor_readings(char *input)
     }
 }
 
+/**
+ * @brief Decode a sensor PDU and refresh the rows of the signals it carries.
+ * @return false if the block is not a sensor PDU.
+ */
+bool process_sensor_pdu(const unsigned char *block)
+{
+    char result[MAX_VALUE_LENGTH];
+    SensorPdu pdu = {
+        .speed = actuators.speed,
+        .internal_temp = actuators.internal_temp,
+        .external_temp = actuators.external_temp,
+        .door_open = actuators.door_status,
+        .tilt_angle = actuators.tilt_angle,
+        .accel = actuators.accel,
+        .brake = actuators.brake,
+        .temp_set = actuators.temp_set,
+        .batt_soc = actuators.batt_soc,
+        .batt_volt = actuators.batt_volt,
+        .engi_temp = actuators.engi_temp,
+        .gear = actuators.gear
+    };
+
+    if (!sensor_pdu_decode(block, &pdu))
+    {
+        return false;
+    }
+
+    if (sensor_pdu_has(&pdu, SENSOR_SIG_SPEED))
+    {
+        actuators.speed = pdu.speed;
+        snprintf(result, sizeof(result), "%.1lf", actuators.speed);
+        update_value_panel(panel_dash, SPEED_ROW, result, NORMAL_TEXT);
+    }
+    if (sensor_pdu_has(&pdu, SENSOR_SIG_IN_TEMP))
+    {
+        actuators.internal_temp = pdu.internal_temp;
+        snprintf(result, sizeof(result), "%d", actuators.internal_temp);
+        update_value_panel(panel_dash, IN_TEMP_ROW, result, NORMAL_TEXT);
+    }
+    if (sensor_pdu_has(&pdu, SENSOR_SIG_EX_TEMP))
+    {
+        actuators.external_temp = pdu.external_temp;
+        snprintf(result, sizeof(result), "%d", actuators.external_temp);
+        update_value_panel(panel_dash, EXT_TEMP_ROW, result, NORMAL_TEXT);
+    }
+    if (sensor_pdu_has(&pdu, SENSOR_SIG_DOOR))
+    {
+        actuators.door_status = pdu.door_open;
+        update_value_panel(panel_dash, DOOR_ROW, actuators.door_status ? "Yes" : "No", NORMAL_TEXT);
+    }
+    if (sensor_pdu_has(&pdu, SENSOR_SIG_BATT_SOC))
+    {
+        actuators.batt_soc = pdu.batt_soc;
+        snprintf(result, sizeof(result), "%.1lf", actuators.batt_soc);
+        update_value_panel(panel_dash, BATT_SOC_ROW, result, NORMAL_TEXT);
+    }
+    if (sensor_pdu_has(&pdu, SENSOR_SIG_BATT_VOLT))
+    {
+        actuators.batt_volt = pdu.batt_volt;
+        snprintf(result, sizeof(result), "%.1lf", actuators.batt_volt);
+        update_value_panel(panel_dash, BATT_VOLT_ROW, result, NORMAL_TEXT);
+    }
+    if (sensor_pdu_has(&pdu, SENSOR_SIG_ENGI_TEMP))
+    {
+        actuators.engi_temp = pdu.engi_temp;
+        snprintf(result, sizeof(result), "%.1lf", actuators.engi_temp);
+        update_value_panel(panel_dash, ENGI_TEMP_ROW, result, NORMAL_TEXT);
+    }
+    if (sensor_pdu_has(&pdu, SENSOR_SIG_GEAR))
+    {
+        actuators.gear = pdu.gear;
+        update_value_panel(panel_dash, GEAR_ROW, actuators.gear ? "D" : "P", NORMAL_TEXT);
+    }
+    if (sensor_pdu_has(&pdu, SENSOR_SIG_ACCEL))
+    {
+        actuators.accel = pdu.accel;
+        snprintf(result, sizeof(result), "%d", actuators.accel);
+        update_value_panel(panel_dash, ACCEL_ROW, result, NORMAL_TEXT);
+    }
+    if (sensor_pdu_has(&pdu, SENSOR_SIG_BRAKE))
+    {
+        actuators.brake = pdu.brake;
+        snprintf(result, sizeof(result), "%d", actuators.brake);
+        update_value_panel(panel_dash, BRAKE_ROW, result, NORMAL_TEXT);
+    }
+    if (sensor_pdu_has(&pdu, SENSOR_SIG_TILT))
+    {
+        actuators.tilt_angle = pdu.tilt_angle;
+        snprintf(result, sizeof(result), "%.1lf", actuators.tilt_angle);
+        update_value_panel(panel_dash, TILT_ROW, result, NORMAL_TEXT);
+    }
+    // temp_set has no dashboard row
+    actuators.temp_set = pdu.temp_set;
+    return true;
+}
+
 void process_errors(char *input)
 {
     if (strcmp(input, "error_battery_drop") == 0)
@@ -206,106 +315,189 @@ void process_errors(char *input)
     }
 }
 
-void* process_frame_thread(void* arg) {
-    (void)arg;
-    struct timespec timeout;
+void publish_dashboard_live(void)
+{
+    LiveSignals signals;
+
+    (void)memset(&signals, 0, sizeof(signals));
+    signals.present = LIVE_HAS_SIGNALS | LIVE_HAS_STOP_START | LIVE_HAS_FAULTS;
+    signals.speed = actuators.speed;
+    signals.tilt_angle = actuators.tilt_angle;
+    signals.batt_soc = actuators.batt_soc;
+    signals.batt_volt = actuators.batt_volt;
+    signals.engi_temp = actuators.engi_temp;
+    signals.internal_temp = actuators.internal_temp;
+    signals.external_temp = actuators.external_temp;
+    signals.temp_set = actuators.temp_set;
+    signals.door_open = actuators.door_status;
+    signals.accel = actuators.accel;
+    signals.brake = actuators.brake;
+    signals.gear = actuators.gear;
+    signals.start_stop_active = actuators.start_stop_active ? 1U : 0U;
+    signals.engine_off = actuators.engine_off ? 1U : 0U;
+    signals.error_system = (actuators.error_system != 0) ? 1U : 0U;
+    live_state_publish(&dash_live, &signals);
+}
 
-    while(!test_mode_dash) {
-        pthread_mutex_lock(&can_buffer.mutex);
-        
-        // Calculate absolute timeout
-        clock_gettime(CLOCK_REALTIME, &timeout);
-        timeout.tv_nsec += PROCESS_TIMEOUT;
+void redraw_dashboard_values(void)
+{
+    char result[MAX_VALUE_LENGTH];
 
-        // Handle overflow
-        if (timeout.tv_nsec >= NANO_TO_SEC)
-        {
-            timeout.tv_sec += timeout.tv_nsec / NANO_TO_SEC;
-            timeout.tv_nsec %= NANO_TO_SEC;
-        }
+    snprintf(result, sizeof(result), "%.1lf", actuators.speed);
+    update_value_panel(panel_dash, SPEED_ROW, result, NORMAL_TEXT);
+    snprintf(result, sizeof(result), "%.1lf", actuators.tilt_angle);
+    update_value_panel(panel_dash, TILT_ROW, result, NORMAL_TEXT);
+    snprintf(result, sizeof(result), "%d", actuators.internal_temp);
+    update_value_panel(panel_dash, IN_TEMP_ROW, result, NORMAL_TEXT);
+    snprintf(result, sizeof(result), "%d", actuators.external_temp);
+    update_value_panel(panel_dash, EXT_TEMP_ROW, result, NORMAL_TEXT);
+    update_value_panel(panel_dash, DOOR_ROW, actuators.door_status ? "Yes" : "No", NORMAL_TEXT);
+    snprintf(result, sizeof(result), "%.1lf", actuators.engi_temp);
+    update_value_panel(panel_dash, ENGI_TEMP_ROW, result, NORMAL_TEXT);
+    snprintf(result, sizeof(result), "%.1lf", actuators.batt_volt);
+    update_value_panel(panel_dash, BATT_VOLT_ROW, result, NORMAL_TEXT);
+    snprintf(result, sizeof(result), "%.1lf", actuators.batt_soc);
+    update_value_panel(panel_dash, BATT_SOC_ROW, result, NORMAL_TEXT);
+    snprintf(result, sizeof(result), "%d", actuators.accel);
+    update_value_panel(panel_dash, ACCEL_ROW, result, NORMAL_TEXT);
+    snprintf(result, sizeof(result), "%d", actuators.brake);
+    update_value_panel(panel_dash, BRAKE_ROW, result, NORMAL_TEXT);
+    update_value_panel(panel_dash, GEAR_ROW, actuators.gear ? "D" : "P", NORMAL_TEXT);
+
+    if (actuators.start_stop_active)
+    {
+        update_value_panel(panel_dash, SYSTEM_ST_ROW, "ON", GREEN_TEXT);
+    }
+    else
+    {
+        update_value_panel(panel_dash, SYSTEM_ST_ROW, "OFF", RED_TEXT);
+    }
+    if (actuators.error_system == 1)
+    {
+        update_value_panel(panel_dash, ENGINE_ST_ROW, "ERR", RED_TEXT);
+    }
+    else if (actuators.engine_off)
+    {
+        update_value_panel(panel_dash, ENGINE_ST_ROW, "OFF", RED_TEXT);
+    }
+    else
+    {
+        update_value_panel(panel_dash, ENGINE_ST_ROW, "ON", GREEN_TEXT);
+    }
+    snprintf(result, sizeof(result), "%d", num_deactivs);
+    update_value_panel(panel_dash, NUM_SYS_ACTIV, result, NORMAL_TEXT);
+}
 
-        // Handle timeout
-        while (can_buffer.tail == can_buffer.head) {
-            if (pthread_cond_timedwait(&can_buffer.cond, &can_buffer.mutex, &timeout) != 0) {
-                // Timeout occurred
-                break;
-            }
-        }
+bool save_dashboard_checkpoint(void)
+{
+    DashCheckpointState state;
+    struct iovec part;
+
+    (void)memset(&state, 0, sizeof(state));
+    state.actuators = actuators;
+    ecu_stats_get(&state.stats);
+    state.num_deactivs = num_deactivs;
+    part.iov_base = &state;
+    part.iov_len = sizeof(state);
+    return checkpoint_write(&dash_checkpoint, DASH_CHECKPOINT_VERSION, &part, 1);
+}
 
-        // Process all available messages
-        while (can_buffer.tail != can_buffer.head) {
-            // Update panel_dash with the decoded data
-            parse_input_received(can_buffer.messages[can_buffer.tail].decrypted);
+bool restore_dashboard_checkpoint(void)
+{
+    CheckpointSnapshot snapshot;
+    DashCheckpointState state;
 
-            // Clear the processed message slot
-            memset(&can_buffer.messages[can_buffer.tail], 0, sizeof(CanMessage));
-            can_buffer.tail = (can_buffer.tail + 1) % MAX_PENDING_FRAMES;
-        }
+    if (!checkpoint_open(&dash_checkpoint, &snapshot, DASH_CHECKPOINT_VERSION))
+    {
+        return false;
+    }
+    const bool restored = snapshot.state_size == sizeof(state);
+    if (restored)
+    {
+        (void)memcpy(&state, snapshot.state, sizeof(state));
+        actuators = state.actuators;
+        ecu_stats_restore(&state.stats);
+        num_deactivs = state.num_deactivs;
+    }
+    checkpoint_close(&snapshot);
+    return restored;
+}
 
-        pthread_mutex_unlock(&can_buffer.mutex);
+bool drain_can_buffer(void)
+{
+    pthread_mutex_lock(&can_buffer.mutex);
+    const bool pending = (can_buffer.tail != can_buffer.head);
+    while (can_buffer.tail != can_buffer.head) {
+        // Update panel_dash with the decoded data
+        parse_input_received(can_buffer.messages[can_buffer.tail].decrypted);
+        metrics_inc(METRIC_MESSAGES_PROCESSED);
+
+        // Clear the processed message slot
+        memset(&can_buffer.messages[can_buffer.tail], 0, sizeof(CanMessage));
+        can_buffer.tail = (can_buffer.tail + 1) % MAX_PENDING_FRAMES;
     }
-    return NULL;
+    pthread_mutex_unlock(&can_buffer.mutex);
+    return pending;
 }
 
-void* can_receiver_thread(void* arg) {
-    (void)arg;
-    struct can_frame frame;
-    unsigned char encrypted_data[AES_BLOCK_SIZE];
-    int received_bytes = 0;
-    
-    #ifdef UNIT_TEST
-    while (!test_mode_dash)
-#else
-    for (;;)
-#endif
-    {
-        if (receive_can_frame(sock_dash, &frame) == 0) {
-            if (check_is_valid_can_id(frame.can_id) && 
-                (frame.can_dlc == CAN_DATA_LENGTH)) 
-            {
-                // Accumulate data until we have a full block
-                memcpy(encrypted_data + received_bytes, frame.data, frame.can_dlc);
-                received_bytes += frame.can_dlc;
-
-                if (received_bytes >= AES_BLOCK_SIZE) {
-                    pthread_mutex_lock(&can_buffer.mutex);
-                    // Overwrite oldest message if buffer is full
-                    if ((can_buffer.head + 1) % MAX_PENDING_FRAMES == can_buffer.tail) {
-                        can_buffer.tail = (can_buffer.tail + 1) % MAX_PENDING_FRAMES;
-                        add_to_log(panel_log, "WARN: Buffer full - dropped oldest frame");
-                    }
-
-                    // Store the new message
-                    can_buffer.messages[can_buffer.head].frame = frame;
-                    decrypt_data(encrypted_data, 
-                               can_buffer.messages[can_buffer.head].decrypted, 
-                               AES_BLOCK_SIZE);
-
-                    // Update head and notify main thread
-                    can_buffer.head = (can_buffer.head + 1) % MAX_PENDING_FRAMES;
-                    sem_post(&can_buffer.sem);
-
-                    // Log raw frame (to panel_log)
-                    char log_msg[MAX_MSG_WIDTH];
-                    int offset = snprintf(log_msg, sizeof(log_msg), "RCV: ");
-                    for (int i = 0; i < frame.can_dlc; i++) {
-                        offset += snprintf(log_msg + offset, sizeof(log_msg) - offset,
-                                 " %02X", frame.data[i]);
-                    }
-                    add_to_log(panel_log, log_msg);
-
-                    pthread_mutex_unlock(&can_buffer.mutex);
-                    received_bytes = 0;  // Reset for next frame
-                }
-            }
-        }
-        #ifdef UNIT_TEST
-        else
-        {
-            break;
-        }
-#endif
+/**
+ * @brief Take one received frame through ID filtering, reassembly and
+ * decryption. Returns true once it completes an authentic message, which is
+ * then in decrypted.
+ */
+bool dashboard_receive_frame(const struct can_frame *frame, char *decrypted)
+{
+    unsigned char encrypted_data[CAN_MSG_WIRE_SIZE];
+    bool accepted = false;
+
+    if (!check_is_valid_can_id(frame->can_id))
+    {
+        metrics_inc(METRIC_FRAMES_FILTERED);
+        return false;
+    }
+    metrics_inc(METRIC_FRAMES_ACCEPTED);
+
+    // Accumulate fragments per CAN ID until we have a full block
+    CanReasmResult result = can_reasm_push(&dash_reassembler, frame,
+                                           can_reasm_now_ms(), encrypted_data);
+    // Drops and decrypt failures are counted by reassembly and decrypt_data
+    if (result == CAN_REASM_COMPLETE)
+    {
+        // Forged, corrupted or replayed blocks are never queued
+        accepted = (decrypt_data(encrypted_data, decrypted, CAN_MSG_WIRE_SIZE,
+                                 frame->can_id) == DECRYPT_OK);
+    }
+    return accepted;
+}
+
+void queue_can_message(const struct can_frame *frame, const char *decrypted)
+{
+    pthread_mutex_lock(&can_buffer.mutex);
+    // Overwrite oldest message if buffer is full
+    if ((can_buffer.head + 1) % MAX_PENDING_FRAMES == can_buffer.tail) {
+        can_buffer.tail = (can_buffer.tail + 1) % MAX_PENDING_FRAMES;
+        metrics_inc(METRIC_BUFFER_DROPS);
+        add_to_log(panel_log, "WARN: Buffer full - dropped oldest frame");
     }
-    return NULL;
+
+    // Store the new message
+    can_buffer.messages[can_buffer.head].frame = *frame;
+    memcpy(can_buffer.messages[can_buffer.head].decrypted, decrypted,
+           sizeof(can_buffer.messages[can_buffer.head].decrypted));
+
+    // Update head and notify main thread
+    can_buffer.head = (can_buffer.head + 1) % MAX_PENDING_FRAMES;
+    sem_post(&can_buffer.sem);
+
+    // Log raw frame (to panel_log)
+    char log_msg[MAX_MSG_WIDTH];
+    int offset = snprintf(log_msg, sizeof(log_msg), "RCV: ");
+    for (int i = 0; i < frame->can_dlc; i++) {
+        offset += snprintf(log_msg + offset, sizeof(log_msg) - offset,
+                 " %02X", frame->data[i]);
+    }
+    add_to_log(panel_log, log_msg);
+
+    pthread_mutex_unlock(&can_buffer.mutex);
 }
 
@@ -3,6 +3,14 @@
 
 #include "../common_includes/can_id_list.h"
 #include "../common_includes/can_socket.h"
+#include "../common_includes/can_reassembly.h"
+#include "../common_includes/sensor_pdu.h"
+#include "../common_includes/ecu_stats.h"
+#include "../common_includes/rt_sched.h"
+#include "../common_includes/live_state.h"
+#include "../common_includes/checkpoint.h"
+#include "../common_includes/metrics.h"
+#include "../common_includes/timer_wheel.h"
 #include "../common_includes/logging.h"
 #include <stdbool.h>
 #include <stdint.h>
@@ -20,14 +28,15 @@
 #include "panels.h"
 
 #define MSG_LOG_PANEL_OFFSET 42
+#define DASH_CHECKPOINT_VERSION (3U)
 
-static int num_deactivs = 0;
+extern int num_deactivs;     // Engine deactivations shown in NUM_SYS_ACTIV
 extern int sock_dash;
 extern bool test_mode_dash;
 
 typedef struct {
     struct can_frame frame;
-    char decrypted[AES_BLOCK_SIZE];
+    char decrypted[AES_BLOCK_SIZE + 1];
 } CanMessage;
 
 // Thread communication structure
@@ -35,7 +44,6 @@ typedef struct {
     CanMessage messages[MAX_PENDING_FRAMES];
     uint8_t head;
     uint8_t tail;
-    pthread_cond_t cond;
     sem_t sem;
     pthread_mutex_t mutex;
 } CanBuffer;
@@ -56,21 +64,46 @@ typedef struct
     int temp_set;
     int gear; // 0 = P, 1 = D
     double engi_temp;
+    bool engine_off;        // Last engine command: ENGINE OFF until RESTART
 } Actuators;
 
 extern Actuators actuators;
+extern LiveState dash_live;
+
+// Checkpointed display values and receive counters
+typedef struct {
+    Actuators actuators;
+    EcuStats stats;
+    int32_t num_deactivs;
+    uint32_t reserved;
+} DashCheckpointState;
+
+// Periodic snapshots from the processing loop (disabled until checkpoint_init)
+extern Checkpoint dash_checkpoint;
 
 bool check_is_valid_can_id(canid_t can_id);
 void parse_input_received(char *input);
 void process_user_commands(char *input);
 void process_engine_commands(char *input);
 void process_sensor_readings(char *input);
+bool process_sensor_pdu(const unsigned char *block);
 void process_errors(char *input);
 void sleep_microseconds(long int microseconds);
 
+// ID filter, reassembly and decryption of one frame; true once a message is complete
+bool dashboard_receive_frame(const struct can_frame *frame, char *decrypted);
 void init_can_buffer(void);
 void cleanup_can_buffer(void);
-void* can_receiver_thread(void* arg);
-void* process_frame_thread(void* arg);
+// Queue a decrypted message for parsing; the oldest is dropped when the buffer is full
+void queue_can_message(const struct can_frame *frame, const char *decrypted);
+// Parse every queued message; true if there was any
+bool drain_can_buffer(void);
+// Publish the displayed values to the live state segment
+void publish_dashboard_live(void);
+// Draw every value row from the current state, e.g. once it was restored
+void redraw_dashboard_values(void);
+// Snapshot the values and counters now, or take over those of a previous run
+bool save_dashboard_checkpoint(void);
+bool restore_dashboard_checkpoint(void);
 
 #endif
@@ -0,0 +1,81 @@
+#include "dashboard_tasks.h"
+
+// Reception coroutine
+static void receiver_task(Coro *co)
+{
+    DashboardTasks *tasks = (DashboardTasks *)co->arg;
+    struct can_frame frame;
+    char decrypted[AES_BLOCK_SIZE + 1];
+    unsigned int queued = 0U;
+    int status = SOCKET_NO_FRAME;
+
+    CORO_BEGIN(co);
+    while (!test_mode_dash)
+    {
+        CORO_WAIT_READABLE(co, sock_dash, CORO_NO_TIMEOUT);
+
+        // A batch at most, so a flood of frames cannot hold the display back
+        queued = 0U;
+        for (unsigned int i = 0U; i < DASH_TASK_RX_BATCH; i++)
+        {
+            status = receive_can_frame_nowait(sock_dash, &frame);
+            if (status != 0)
+            {
+                break;
+            }
+            tasks->frames++;
+            if (dashboard_receive_frame(&frame, decrypted))
+            {
+                queue_can_message(&frame, decrypted);
+                queued++;
+            }
+        }
+        if (queued > 0U)
+        {
+            (void)coro_event_signal(&tasks->queued);
+        }
+
+        if (status == SOCKET_ERROR)
+        {
+            add_to_log(panel_log, "ERROR: CAN socket closed");
+            CORO_EXIT(co);
+        }
+    }
+    CORO_END(co);
+}
+
+// Processing coroutine
+static void processor_task(Coro *co)
+{
+    DashboardTasks *tasks = (DashboardTasks *)co->arg;
+    long long now_ms = 0;
+
+    CORO_BEGIN(co);
+    while (!test_mode_dash)
+    {
+        CORO_WAIT_EVENT(co, &tasks->queued, DASH_TASK_FLUSH_MS);
+
+        // The only coroutine changing the actuators, hence the only writer
+        if (drain_can_buffer())
+        {
+            tasks->batches++;
+            publish_dashboard_live();
+        }
+
+        now_ms = timer_wheel_now_ms();
+        metrics_flush(now_ms);
+        if (checkpoint_due(&dash_checkpoint, now_ms))
+        {
+            (void)save_dashboard_checkpoint();
+        }
+    }
+    CORO_END(co);
+}
+
+bool dashboard_tasks_spawn(CoroScheduler *sched, DashboardTasks *tasks)
+{
+    (void)memset(tasks, 0, sizeof(*tasks));
+    coro_event_init(&tasks->queued);
+    return coro_spawn(sched, &tasks->receiver, "receiver", receiver_task, tasks) &&
+           coro_spawn(sched, &tasks->processor, "processor", processor_task, tasks);
+}
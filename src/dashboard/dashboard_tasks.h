@@ -0,0 +1,31 @@
+#ifndef DASHBOARD_TASKS_H
+#define DASHBOARD_TASKS_H
+
+#include "dashboard_func.h"
+#include "../common_includes/coro.h"
+
+/*
+ * The dashboard loops as coroutines on the main thread (coro.h):
+ *
+ *   receiver   waits for sock_dash to be readable, queues the messages the
+ *              pending frames complete, up to a batch, and signals processor
+ *   processor  parses the queued messages when signalled, and at least every
+ *              DASH_TASK_FLUSH_MS flushes the statistics and metrics
+ *
+ * The scheduler must run in real time (reception waits on the socket).
+ */
+#define DASH_TASK_FLUSH_MS  (100LL)     // Longest wait between two flushes
+#define DASH_TASK_RX_BATCH  (32U)       // Frames taken before reception waits again
+
+typedef struct {
+    Coro receiver;
+    Coro processor;
+    CoroEvent queued;           // Messages are waiting in the buffer
+    unsigned long frames;
+    unsigned long batches;      // Wakeups of processor with messages to parse
+} DashboardTasks;
+
+// Spawn reception, then processing; both start on the scheduler's next pass
+bool dashboard_tasks_spawn(CoroScheduler *sched, DashboardTasks *tasks);
+
+#endif // DASHBOARD_TASKS_H
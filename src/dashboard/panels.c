@@ -206,6 +206,11 @@ ValuePanel *create_value_panel(Size siz, Position pos, const char *title)
 
 void update_value_panel(ValuePanel *panel, int row, const char *value, int color_pair)
 {
+    // Headless dashboard (no terminal): nothing to draw
+    if (panel == NULL || panel->win == NULL || value == NULL) {
+        return;
+    }
+
     int value_col = VALUE_PRINT_COL;
     int max_width = panel->width - value_col - 2; // -2 for borders
 
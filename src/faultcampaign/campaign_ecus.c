@@ -0,0 +1,176 @@
+#include "campaign_ecus.h"
+#include "../powertrain/can_comms.h"
+#include "../dashboard/dashboard_func.h"
+#include <errno.h>
+#include <poll.h>
+
+// The dashboard runs headless in a probe
+ValuePanel *panel_dash = NULL;
+ScrollPanel *panel_log = NULL;
+
+static const char *const probe_names[PROBE_COUNT] = {
+    [PROBE_POWERTRAIN] = "powertrain",
+    [PROBE_DASHBOARD]  = "dashboard"
+};
+
+const char *probe_ecu_name(ProbeEcu ecu)
+{
+    return ((unsigned int)ecu < PROBE_COUNT) ? probe_names[ecu] : NULL;
+}
+
+// One received message (powertrain) or frame (dashboard) through the ECU code
+static void handle_traffic(ProbeEcu ecu, int can_sock)
+{
+    if (ecu == PROBE_POWERTRAIN)
+    {
+        process_received_frame_powertrain(can_sock);
+    }
+    else
+    {
+        struct can_frame frame;
+        char decrypted[AES_BLOCK_SIZE + 1];
+
+        if ((receive_can_frame(can_sock, &frame) == 0) && dashboard_receive_frame(&frame, decrypted))
+        {
+            parse_input_received(decrypted);
+            metrics_inc(METRIC_MESSAGES_PROCESSED);
+        }
+    }
+}
+
+// 1: a frame is waiting, 0: the campaign closed the bus, -1: nothing yet
+static int traffic_pending(int can_sock)
+{
+    struct can_frame frame;
+    const ssize_t got = recv(can_sock, &frame, sizeof(frame), MSG_PEEK | MSG_DONTWAIT);
+
+    if (got > 0)
+    {
+        return 1;
+    }
+    return (got == 0) ? 0 : -1;
+}
+
+static void arm(ProbeEcu ecu)
+{
+    if (ecu == PROBE_POWERTRAIN)
+    {
+        start_stop_manual = true;
+    }
+    else
+    {
+        actuators.start_stop_active = true;
+        actuators.error_system = 0;
+    }
+}
+
+static void read_status(ProbeEcu ecu, ProbeStatus *status)
+{
+    EcuStats stats;
+
+    // Each probe is a process of its own: the counters are its ECU's
+    ecu_stats_get(&stats);
+    status->messages = stats.msgs_processed;
+    status->rejected = stats.msgs_rejected;
+    if (ecu == PROBE_POWERTRAIN)
+    {
+        status->system_enabled = start_stop_manual;
+        status->error_shown = false;
+    }
+    else
+    {
+        status->system_enabled = actuators.start_stop_active;
+        status->error_shown = (actuators.error_system != 0);
+    }
+}
+
+/**
+ * @brief Serve one ECU's receive path to the fault campaign.
+ * @requirement SWR6.4
+ */
+int probe_run(ProbeEcu ecu, int can_sock, int ctl_sock)
+{
+    struct pollfd fds[2] = {
+        { .fd = can_sock, .events = POLLIN, .revents = 0 },
+        { .fd = ctl_sock, .events = POLLIN, .revents = 0 }
+    };
+
+    for (;;)
+    {
+        if (poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+
+        // Traffic first: the campaign never waits on a probe while sending
+        if ((fds[0].revents & (POLLIN | POLLHUP)) != 0)
+        {
+            const int pending = traffic_pending(can_sock);
+            if (pending == 0)
+            {
+                return 0;   // Campaign gone
+            }
+            if (pending > 0)
+            {
+                handle_traffic(ecu, can_sock);
+                continue;
+            }
+        }
+        if ((fds[1].revents & (POLLIN | POLLHUP | POLLERR)) == 0)
+        {
+            continue;
+        }
+
+        ProbeCommand command;
+        ProbeStatus status;
+        if (read(ctl_sock, &command, sizeof(command)) != (ssize_t)sizeof(command))
+        {
+            return 0;   // Campaign gone
+        }
+        if (command == PROBE_QUIT)
+        {
+            return 0;
+        }
+        else if (command == PROBE_ARM)
+        {
+            arm(ecu);
+        }
+        else if (command == PROBE_QUERY)
+        {
+            while (traffic_pending(can_sock) > 0)
+            {
+                handle_traffic(ecu, can_sock);
+            }
+        }
+        else
+        {
+            // Unknown command: report the state unchanged
+        }
+
+        (void)memset(&status, 0, sizeof(status));
+        read_status(ecu, &status);
+        if (write(ctl_sock, &status, sizeof(status)) != (ssize_t)sizeof(status))
+        {
+            return -1;
+        }
+    }
+}
+
+bool probe_command(int ctl_sock, ProbeCommand command, ProbeStatus *status)
+{
+    ssize_t got;
+
+    if (write(ctl_sock, &command, sizeof(command)) != (ssize_t)sizeof(command))
+    {
+        return false;
+    }
+    do
+    {
+        got = read(ctl_sock, status, sizeof(*status));
+    } while ((got < 0) && (errno == EINTR));
+    return got == (ssize_t)sizeof(*status);
+}
@@ -0,0 +1,44 @@
+#ifndef CAMPAIGN_ECUS_H
+#define CAMPAIGN_ECUS_H
+
+#include <stdbool.h>
+
+/*
+ * Powertrain and dashboard receive paths run as fault campaign probes.
+ *
+ * Each probe is a process of its own (the ECUs' state and replay windows are
+ * process-wide) fed with the campaign's bus traffic on can_sock. It takes
+ * every frame through the ECU's own filtering, reassembly, decryption and
+ * parsing, and answers commands on ctl_sock with a ProbeStatus:
+ *   PROBE_ARM    reset the Stop/Start state to enabled, as at power-up
+ *   PROBE_QUERY  handle every frame already sent, then report
+ *   PROBE_QUIT   return
+ */
+typedef enum {
+    PROBE_ARM = 1,
+    PROBE_QUERY,
+    PROBE_QUIT
+} ProbeCommand;
+
+typedef struct {
+    unsigned long messages;     // Decrypted and parsed
+    unsigned long rejected;     // Failing authentication or replayed
+    bool system_enabled;        // Stop/Start still enabled
+    bool error_shown;           // System error displayed (dashboard only)
+} ProbeStatus;
+
+typedef enum {
+    PROBE_POWERTRAIN = 0,
+    PROBE_DASHBOARD,
+    PROBE_COUNT
+} ProbeEcu;
+
+const char *probe_ecu_name(ProbeEcu ecu);
+
+// Serve commands until PROBE_QUIT or the campaign closes ctl_sock
+int probe_run(ProbeEcu ecu, int can_sock, int ctl_sock);
+
+// Send a command and wait for the status
+bool probe_command(int ctl_sock, ProbeCommand command, ProbeStatus *status);
+
+#endif // CAMPAIGN_ECUS_H
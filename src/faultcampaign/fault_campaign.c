@@ -0,0 +1,597 @@
+/*
+ * Fault-injection campaign for the BCM health monitoring (SWR6.4).
+ *
+ * Generates thousands of seeded fault scenarios (cause, onset, duration,
+ * intermittence, combinations; see fault_scenario.h) and runs each one
+ * through the BCM fault timer in virtual time (fault_inject.h). The bus
+ * traffic of every scenario is fed to powertrain and dashboard probes
+ * running those ECUs' receive paths (campaign_ecus.h), so the check covers
+ * the whole chain: detection on the right sample, latency against
+ * safety_timeout_ms, causes reported, and error_disabled turning Stop/Start
+ * off on both ECUs. Scenarios are spread over worker processes, each with
+ * its own probes; scenario N of a seed is the same whatever the worker
+ * count. The exit status is non-zero when any scenario fails a check, so
+ * the campaign can gate a build.
+ */
+#include <getopt.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../common_includes/can_id_list.h"
+#include "../common_includes/can_socket.h"
+#include "../common_includes/can_reassembly.h"
+#include "../common_includes/fault_scenario.h"
+#include "../bcm/fault_inject.h"
+#include "campaign_ecus.h"
+
+#define ERROR_CODE          (1)
+#define DEFAULT_CYCLE       ("../src/bcm/full_simu.csv")
+#define DEFAULT_SCENARIOS   (1000U)
+#define DEFAULT_STEP_MS     (1000LL)    // BCM step period
+#define MIN_STEP_MS         (10LL)      // Fleet timer tick
+#define MAX_SCENARIOS       (1000000U)
+#define MAX_WORKERS         (64L)
+#define MAX_LISTED          (10U)       // Failing scenarios printed
+#define DESCRIPTION_SIZE    (160U)
+#define NSEC_PER_SEC        (1000000000.0)
+
+// Checks a scenario can fail (ScenarioOutcome.failed bits)
+#define CHECK_DETECTION     (1U << 0)   // Reported if and only if required
+#define CHECK_STEP          (1U << 1)   // Reported on the required sample
+#define CHECK_CAUSES        (1U << 2)   // Causes reported = causes present
+#define CHECK_LATENCY       (1U << 3)   // latency == timeout
+#define CHECK_POWERTRAIN    (1U << 4)   // Stop/Start disabled if and only if reported
+#define CHECK_DASHBOARD     (1U << 5)   // Disabled and error shown if and only if reported
+#define CHECK_DELIVERY      (1U << 6)   // Every message accepted by both probes
+#define NUM_CHECKS          (7U)
+
+static const char *const check_names[NUM_CHECKS] = {
+    "detection", "sample", "causes", "latency", "powertrain", "dashboard", "delivery"
+};
+
+typedef struct {
+    const char *cycle_path;
+    FaultGenConfig gen;
+    uint64_t seed;
+    uint32_t count;
+    long long step_ms;
+    long long timeout_ms;
+} Campaign;
+
+typedef struct {
+    FaultExpectation expect;
+    FaultInjectResult result;
+    ProbeStatus probes[PROBE_COUNT];    // Counters relative to the scenario start
+    unsigned long forwarded;            // Messages the BCM put on the bus
+    unsigned int failed;                // CHECK_* bits
+    bool done;
+} ScenarioOutcome;
+
+// Shared by all worker processes (anonymous shared mapping)
+typedef struct {
+    uint32_t next;              // Next scenario to run
+    bool failed;                // A worker could not run its scenario
+    ScenarioOutcome outcomes[];
+} CampaignShared;
+
+typedef struct {
+    int bcm;                    // BCM end of the bus
+    int bus;                    // Campaign end of the bus
+    int probes[PROBE_COUNT];    // Campaign side of each probe's bus
+    CanReassembler reasm;       // Counts the messages forwarded
+    unsigned long messages;
+} Forwarder;
+
+static void usage(const char *prog)
+{
+    (void)fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  -c FILE     healthy drive cycle (default %s)\n"
+        "  -n COUNT    scenarios (default %u)\n"
+        "  -s SEED     random seed (default 1)\n"
+        "  -j WORKERS  worker processes (default: online CPUs)\n"
+        "  -w ROWS     rows per scenario, 2..%u (default 40)\n"
+        "  -d ROWS     longest fault episode (default 4)\n"
+        "  -e COUNT    fault episodes per scenario, 1..%u (default 3)\n"
+        "  -f TYPES    causes to inject: door,engine_temp,tilt (default all)\n"
+        "  -i PROB     chance that an episode is intermittent (default 0.25)\n"
+        "  -t MS       step period, >= %lld (default %lld)\n"
+        "  -o FILE     per-scenario results as CSV\n",
+        prog, DEFAULT_CYCLE, DEFAULT_SCENARIOS, FAULT_MAX_STEPS, FAULT_MAX_EPISODES, MIN_STEP_MS, DEFAULT_STEP_MS);
+}
+
+static double now_s(void)
+{
+    struct timespec now;
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + ((double)now.tv_nsec / NSEC_PER_SEC);
+}
+
+static bool parse_types(const char *list, unsigned int *types)
+{
+    char copy[DESCRIPTION_SIZE];
+    char *save = NULL;
+
+    if (strlen(list) >= sizeof(copy))
+    {
+        return false;
+    }
+    (void)strcpy(copy, list);
+    *types = 0U;
+    for (char *name = strtok_r(copy, ",", &save); name != NULL; name = strtok_r(NULL, ",", &save))
+    {
+        bool known = false;
+        for (unsigned int t = 0U; t < FAULT_TYPE_COUNT; t++)
+        {
+            if (strcmp(name, fault_type_name((FaultType)t)) == 0)
+            {
+                *types |= FAULT_BIT(t);
+                known = true;
+            }
+        }
+        if (!known)
+        {
+            return false;
+        }
+    }
+    return *types != 0U;
+}
+
+static void describe(const FaultScenario *scenario, char *text, size_t size)
+{
+    size_t used = 0U;
+
+    text[0] = '\0';
+    for (unsigned int e = 0U; (e < scenario->num_episodes) && (used < size); e++)
+    {
+        const FaultEpisode *episode = &scenario->episodes[e];
+        int len = snprintf(text + used, size - used, "%s%s=%g@%u+%u", (e > 0U) ? " " : "",
+                           fault_type_name(episode->type), episode->value, episode->onset,
+                           episode->duration);
+        if ((len > 0) && (episode->period > 0U) && ((used + (size_t)len) < size))
+        {
+            len += snprintf(text + used + (size_t)len, size - used - (size_t)len, "/%u", episode->period);
+        }
+        used += (len > 0) ? (size_t)len : 0U;
+    }
+}
+
+// Move what the BCM sent to every probe (fault_inject step callback)
+static void forward_traffic(void *arg)
+{
+    Forwarder *fwd = (Forwarder *)arg;
+    struct can_frame frame;
+    unsigned char block[CAN_MSG_WIRE_SIZE];
+
+    while (recv(fwd->bus, &frame, sizeof(frame), MSG_DONTWAIT) == (ssize_t)sizeof(frame))
+    {
+        for (unsigned int p = 0U; p < PROBE_COUNT; p++)
+        {
+            (void)send_can_frame(fwd->probes[p], &frame);
+        }
+        if (can_reasm_push(&fwd->reasm, &frame, can_reasm_now_ms(), block) == CAN_REASM_COMPLETE)
+        {
+            fwd->messages++;
+        }
+    }
+}
+
+static unsigned int check_outcome(const Campaign *campaign, const ScenarioOutcome *out)
+{
+    const FaultExpectation *expect = &out->expect;
+    const FaultInjectResult *result = &out->result;
+    const ProbeStatus *pt = &out->probes[PROBE_POWERTRAIN];
+    const ProbeStatus *dash = &out->probes[PROBE_DASHBOARD];
+    unsigned int failed = 0U;
+
+    if (result->detected != expect->detected)
+    {
+        failed |= CHECK_DETECTION;
+    }
+    else if (result->detected)
+    {
+        failed |= (result->step != expect->step) ? CHECK_STEP : 0U;
+        failed |= (result->faults != expect->faults) ? CHECK_CAUSES : 0U;
+        failed |= (result->latency_ms != campaign->timeout_ms) ? CHECK_LATENCY : 0U;
+    }
+    else
+    {
+        // Nothing to report, nothing reported
+    }
+
+    // Propagation is checked against what the BCM did send
+    if (pt->system_enabled == result->detected)
+    {
+        failed |= CHECK_POWERTRAIN;
+    }
+    if ((dash->system_enabled == result->detected) || (dash->error_shown != result->detected))
+    {
+        failed |= CHECK_DASHBOARD;
+    }
+    for (unsigned int p = 0U; p < PROBE_COUNT; p++)
+    {
+        if ((out->probes[p].messages != out->forwarded) || (out->probes[p].rejected != 0UL))
+        {
+            failed |= CHECK_DELIVERY;
+        }
+    }
+    return failed;
+}
+
+/**
+ * @brief Run one scenario: arm the probes, inject and run the BCM, then
+ * collect what each probe ended up with.
+ * @requirement SWR6.4
+ */
+static bool run_scenario(const Campaign *campaign, uint32_t id, Forwarder *fwd,
+                         const int *ctl, ScenarioOutcome *out)
+{
+    FaultScenario scenario;
+    ProbeStatus armed[PROBE_COUNT];
+
+    fault_scenario_generate(&campaign->gen, campaign->seed, id, &scenario);
+    fault_scenario_expect(&scenario, campaign->step_ms, campaign->timeout_ms, &out->expect);
+
+    for (unsigned int p = 0U; p < PROBE_COUNT; p++)
+    {
+        if (!probe_command(ctl[p], PROBE_ARM, &armed[p]))
+        {
+            return false;
+        }
+    }
+    fwd->messages = 0UL;
+    if (!fault_inject_run(campaign->cycle_path, &scenario, campaign->step_ms, fwd->bcm,
+                          forward_traffic, fwd, &out->result))
+    {
+        return false;
+    }
+    forward_traffic(fwd);
+    out->forwarded = fwd->messages;
+
+    for (unsigned int p = 0U; p < PROBE_COUNT; p++)
+    {
+        if (!probe_command(ctl[p], PROBE_QUERY, &out->probes[p]))
+        {
+            return false;
+        }
+        out->probes[p].messages -= armed[p].messages;
+        out->probes[p].rejected -= armed[p].rejected;
+    }
+    out->failed = check_outcome(campaign, out);
+    out->done = true;
+    return true;
+}
+
+static pid_t start_probe(ProbeEcu ecu, int can_sock, int ctl_sock, const int *close_fds, size_t num_close)
+{
+    const pid_t pid = fork();
+
+    if (pid == 0)
+    {
+        for (size_t i = 0U; i < num_close; i++)
+        {
+            (void)close(close_fds[i]);
+        }
+        exit((probe_run(ecu, can_sock, ctl_sock) == 0) ? 0 : ERROR_CODE);
+    }
+    return pid;
+}
+
+// One batch instance: a BCM, a powertrain probe and a dashboard probe
+static int worker_main(const Campaign *campaign, CampaignShared *shared)
+{
+    int bus[2];
+    int can[PROBE_COUNT][2];
+    int ctl[PROBE_COUNT][2];
+    int ctl_local[PROBE_COUNT];
+    pid_t probes[PROBE_COUNT];
+    Forwarder fwd;
+    bool ok = true;
+
+    if ((create_can_loopback_pair(bus) != 0) ||
+        (create_can_loopback_pair(can[PROBE_POWERTRAIN]) != 0) ||
+        (create_can_loopback_pair(can[PROBE_DASHBOARD]) != 0) ||
+        (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, ctl[PROBE_POWERTRAIN]) != 0) ||
+        (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, ctl[PROBE_DASHBOARD]) != 0))
+    {
+        return ERROR_CODE;
+    }
+
+    // Each probe keeps only its own ends
+    for (unsigned int p = 0U; p < PROBE_COUNT; p++)
+    {
+        const int other = (int)(PROBE_COUNT - 1U - p);
+        const int close_fds[] = { bus[0], bus[1], can[p][0], ctl[p][0],
+                                  can[other][0], can[other][1], ctl[other][0], ctl[other][1] };
+        probes[p] = start_probe((ProbeEcu)p, can[p][1], ctl[p][1], close_fds,
+                                sizeof(close_fds) / sizeof(close_fds[0]));
+        ok = ok && (probes[p] > 0);
+    }
+    for (unsigned int p = 0U; p < PROBE_COUNT; p++)
+    {
+        (void)close(can[p][1]);
+        (void)close(ctl[p][1]);
+        fwd.probes[p] = can[p][0];
+        ctl_local[p] = ctl[p][0];
+    }
+    fwd.bcm = bus[0];
+    fwd.bus = bus[1];
+    fwd.messages = 0UL;
+    can_reasm_reset(&fwd.reasm);
+    set_can_node_id(CAN_NODE_BCM);
+
+    while (ok)
+    {
+        const uint32_t id = __atomic_fetch_add(&shared->next, 1U, __ATOMIC_RELAXED);
+        if ((id >= campaign->count) || __atomic_load_n(&shared->failed, __ATOMIC_RELAXED))
+        {
+            break;
+        }
+        ok = run_scenario(campaign, id, &fwd, ctl_local, &shared->outcomes[id]);
+    }
+    if (!ok)
+    {
+        __atomic_store_n(&shared->failed, true, __ATOMIC_RELAXED);
+    }
+
+    for (unsigned int p = 0U; p < PROBE_COUNT; p++)
+    {
+        const ProbeCommand quit = PROBE_QUIT;
+        (void)write(ctl_local[p], &quit, sizeof(quit));
+        (void)close(ctl_local[p]);
+        (void)close(fwd.probes[p]);
+        if (probes[p] > 0)
+        {
+            (void)waitpid(probes[p], NULL, 0);
+        }
+    }
+    (void)close(bus[0]);
+    (void)close(bus[1]);
+    return ok ? 0 : ERROR_CODE;
+}
+
+static bool run_campaign(const Campaign *campaign, CampaignShared *shared, long workers)
+{
+    pid_t pids[MAX_WORKERS];
+    long started = 0L;
+    bool ok = true;
+
+    (void)fflush(NULL);
+    for (long w = 0L; w < workers; w++)
+    {
+        const pid_t pid = fork();
+        if (pid == 0)
+        {
+            exit(worker_main(campaign, shared));
+        }
+        if (pid < 0)
+        {
+            __atomic_store_n(&shared->failed, true, __ATOMIC_RELAXED);
+            ok = false;
+            break;
+        }
+        pids[started] = pid;
+        started++;
+    }
+    for (long w = 0L; w < started; w++)
+    {
+        int status = 0;
+        if ((waitpid(pids[w], &status, 0) < 0) || !WIFEXITED(status) || (WEXITSTATUS(status) != 0))
+        {
+            ok = false;
+        }
+    }
+    return ok && !shared->failed;
+}
+
+static bool write_outcomes(const char *path, const Campaign *campaign, const CampaignShared *shared)
+{
+    FILE *file = fopen(path, "w");
+
+    if (file == NULL)
+    {
+        perror(path);
+        return false;
+    }
+    (void)fprintf(file, "scenario,episodes,expected,expected_row,detected,row,faults,latency_ms,"
+                        "powertrain_enabled,dashboard_enabled,dashboard_error,messages,failed\n");
+    for (uint32_t id = 0U; id < campaign->count; id++)
+    {
+        const ScenarioOutcome *out = &shared->outcomes[id];
+        FaultScenario scenario;
+        char text[DESCRIPTION_SIZE];
+
+        fault_scenario_generate(&campaign->gen, campaign->seed, id, &scenario);
+        describe(&scenario, text, sizeof(text));
+        (void)fprintf(file, "%u,%s,%d,%u,%d,%u,%u,%lld,%d,%d,%d,%lu,0x%02X\n", id, text,
+                      out->expect.detected ? 1 : 0, out->expect.step, out->result.detected ? 1 : 0,
+                      out->result.step, out->result.faults, out->result.latency_ms,
+                      out->probes[PROBE_POWERTRAIN].system_enabled ? 1 : 0,
+                      out->probes[PROBE_DASHBOARD].system_enabled ? 1 : 0,
+                      out->probes[PROBE_DASHBOARD].error_shown ? 1 : 0, out->forwarded, out->failed);
+    }
+    return fclose(file) == 0;
+}
+
+static unsigned long print_report(const Campaign *campaign, const CampaignShared *shared)
+{
+    unsigned long detections = 0UL;
+    unsigned long combined = 0UL;
+    unsigned long by_cause[FAULT_TYPE_COUNT] = { 0UL };
+    unsigned long by_check[NUM_CHECKS] = { 0UL };
+    unsigned long failures = 0UL;
+    unsigned long messages = 0UL;
+    unsigned long reported = 0UL;
+    long long latency_min = -1;
+    long long latency_max = -1;
+    double latency_sum = 0.0;
+
+    for (uint32_t id = 0U; id < campaign->count; id++)
+    {
+        const ScenarioOutcome *out = &shared->outcomes[id];
+
+        messages += out->forwarded;
+        if (out->expect.detected)
+        {
+            detections++;
+            combined += ((out->expect.faults & (out->expect.faults - 1U)) != 0U) ? 1UL : 0UL;
+            for (unsigned int t = 0U; t < FAULT_TYPE_COUNT; t++)
+            {
+                by_cause[t] += ((out->expect.faults & FAULT_BIT(t)) != 0U) ? 1UL : 0UL;
+            }
+        }
+        if (out->result.detected && (out->result.latency_ms >= 0))
+        {
+            reported++;
+            latency_sum += (double)out->result.latency_ms;
+            if ((latency_min < 0) || (out->result.latency_ms < latency_min))
+            {
+                latency_min = out->result.latency_ms;
+            }
+            if (out->result.latency_ms > latency_max)
+            {
+                latency_max = out->result.latency_ms;
+            }
+        }
+        for (unsigned int c = 0U; c < NUM_CHECKS; c++)
+        {
+            by_check[c] += ((out->failed & (1U << c)) != 0U) ? 1UL : 0UL;
+        }
+        failures += ((out->failed != 0U) || !out->done) ? 1UL : 0UL;
+    }
+
+    (void)printf("Required detections: %lu of %u scenarios (door %lu, engine_temp %lu, tilt %lu, "
+                 "several causes %lu); %lu messages delivered\n",
+                 detections, campaign->count, by_cause[FAULT_DOOR], by_cause[FAULT_ENGINE_TEMP],
+                 by_cause[FAULT_TILT], combined, messages);
+    if (reported > 0UL)
+    {
+        (void)printf("Detection latency: min %lld ms, mean %.1f ms, max %lld ms (required %lld ms)\n",
+                     latency_min, latency_sum / (double)reported, latency_max, campaign->timeout_ms);
+    }
+    (void)printf("Failed checks:\n");
+    for (unsigned int c = 0U; c < NUM_CHECKS; c++)
+    {
+        (void)printf("  %-11s %8lu\n", check_names[c], by_check[c]);
+    }
+
+    unsigned int listed = 0U;
+    for (uint32_t id = 0U; (id < campaign->count) && (listed < MAX_LISTED); id++)
+    {
+        const ScenarioOutcome *out = &shared->outcomes[id];
+        FaultScenario scenario;
+        char text[DESCRIPTION_SIZE];
+
+        if ((out->failed == 0U) && out->done)
+        {
+            continue;
+        }
+        fault_scenario_generate(&campaign->gen, campaign->seed, id, &scenario);
+        describe(&scenario, text, sizeof(text));
+        (void)printf("  FAIL scenario %u [%s]: expected %s row %u, got %s row %u, latency %lld ms, checks 0x%02X\n",
+                     id, text, out->expect.detected ? "report on" : "no report", out->expect.step,
+                     out->result.detected ? "report on" : "no report", out->result.step,
+                     out->result.latency_ms, out->failed);
+        listed++;
+    }
+    return failures;
+}
+
+int main(int argc, char **argv)
+{
+    Campaign campaign;
+    const char *output = NULL;
+    long workers = sysconf(_SC_NPROCESSORS_ONLN);
+    int opt;
+
+    (void)memset(&campaign, 0, sizeof(campaign));
+    campaign.cycle_path = DEFAULT_CYCLE;
+    campaign.count = DEFAULT_SCENARIOS;
+    campaign.seed = 1U;
+    campaign.step_ms = DEFAULT_STEP_MS;
+    campaign.timeout_ms = fault_inject_timeout_ms();
+    fault_gen_config_default(&campaign.gen);
+
+    while ((opt = getopt(argc, argv, "c:n:s:j:w:d:e:f:i:t:o:h")) != -1)
+    {
+        bool valid = true;
+        switch (opt)
+        {
+        case 'c': campaign.cycle_path = optarg; break;
+        case 'n': campaign.count = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 's': campaign.seed = strtoull(optarg, NULL, 0); break;
+        case 'j': workers = strtol(optarg, NULL, 10); break;
+        case 'w': campaign.gen.steps = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 'd': campaign.gen.max_duration = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 'e': campaign.gen.max_episodes = (unsigned int)strtoul(optarg, NULL, 10); break;
+        case 'f': valid = parse_types(optarg, &campaign.gen.types); break;
+        case 'i': campaign.gen.intermittent = strtod(optarg, NULL); break;
+        case 't': campaign.step_ms = strtoll(optarg, NULL, 10); break;
+        case 'o': output = optarg; break;
+        default: valid = false; break;
+        }
+        if (!valid)
+        {
+            usage(argv[0]);
+            return ERROR_CODE;
+        }
+    }
+    if ((campaign.count == 0U) || (campaign.count > MAX_SCENARIOS) || (workers < 1L) ||
+        (campaign.step_ms < MIN_STEP_MS) || !fault_gen_config_valid(&campaign.gen))
+    {
+        usage(argv[0]);
+        return ERROR_CODE;
+    }
+    workers = (workers > MAX_WORKERS) ? MAX_WORKERS : workers;
+    workers = (workers > (long)campaign.count) ? (long)campaign.count : workers;
+
+    if (!fault_inject_cycle_healthy(campaign.cycle_path, campaign.gen.steps))
+    {
+        (void)fprintf(stderr, "%s: needs more than %u rows, none of them faulty\n",
+                      campaign.cycle_path, campaign.gen.steps);
+        return ERROR_CODE;
+    }
+
+    const size_t size = sizeof(CampaignShared) + ((size_t)campaign.count * sizeof(ScenarioOutcome));
+    CampaignShared *shared = (CampaignShared *)mmap(NULL, size, PROT_READ | PROT_WRITE,
+                                                    MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED)
+    {
+        perror("mmap");
+        return ERROR_CODE;
+    }
+
+    // A probe that dies must fail its worker, not kill it
+    (void)signal(SIGPIPE, SIG_IGN);
+
+    const double start = now_s();
+    bool ok = run_campaign(&campaign, shared, workers);
+    const double elapsed = now_s() - start;
+
+    (void)printf("Fault campaign: %u scenarios of %u rows on %s, step %lld ms, timeout %lld ms, "
+                 "seed %llu, %ld workers, %.2f s (%.0f scenarios/s)\n",
+                 campaign.count, campaign.gen.steps, campaign.cycle_path, campaign.step_ms,
+                 campaign.timeout_ms, (unsigned long long)campaign.seed, workers, elapsed,
+                 (elapsed > 0.0) ? ((double)campaign.count / elapsed) : 0.0);
+    if (!ok)
+    {
+        (void)fprintf(stderr, "Fault campaign run failed\n");
+    }
+    const unsigned long failures = print_report(&campaign, shared);
+    (void)printf("Result: %s (%lu failing scenarios)\n", ((failures == 0UL) && ok) ? "PASS" : "FAIL", failures);
+
+    if ((output != NULL) && !write_outcomes(output, &campaign, shared))
+    {
+        ok = false;
+    }
+    (void)munmap(shared, size);
+    return ((failures == 0UL) && ok) ? 0 : ERROR_CODE;
+}
@@ -1,13 +1,61 @@
 #include "instrument_cluster_func.h"
+#include "../common_includes/ecu_shutdown.h"
+#include <errno.h>
+#include <poll.h>
 
 #define CAN_INTERFACE      ("vcan0")
 #define PERMISSIONS        (0666)
 #define ERROR_CODE         (1)
 #define FIFO_PATH "/tmp/command_pipe"
 
+/* Wait for a writer's command on the FIFO or for a stop signal; returns false
+   on the latter (or an error) */
+static bool wait_for_command(int fifo_fd)
+{
+    struct pollfd fds[2] = {
+        { .fd = fifo_fd, .events = POLLIN, .revents = 0 },
+        { .fd = ecu_shutdown_fd(), .events = POLLIN, .revents = 0 },
+    };
+
+    for (;;)
+    {
+        if (poll(fds, 2U, -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            perror("Error waiting for a command");
+            return false;
+        }
+        if ((fds[1].revents & POLLIN) != 0)
+        {
+            return false;
+        }
+        if ((fds[0].revents & (POLLIN | POLLHUP)) != 0)
+        {
+            return true;
+        }
+    }
+}
+
 int main(void) 
 {
     int sock = -1;  
+
+    // SIGINT/SIGTERM end the command loop through a signalfd (ecu_shutdown.h)
+    if (!ecu_shutdown_init())
+    {
+        return ERROR_CODE;
+    }
+
+    // Opt-in RT mode (ECU_RT=1) for the single command thread
+    (void)rt_init("instrument_cluster");
+    (void)rt_configure_thread("instrument_cluster", 0U, 0);
+
+    set_can_node_id(CAN_NODE_INSTRUMENT_CLUSTER);
+    metrics_init("instrument_cluster");
+    (void)metrics_write();
     sock = create_can_socket(CAN_INTERFACE);
     if (sock < 0)
     {
@@ -24,17 +72,34 @@ int main(void)
         return ERROR_CODE;
     }
 
+    // Commands sent so far, for monitors reading the live state
+    static LiveState live;
+    LiveSignals live_signals;
+    (void)memset(&live_signals, 0, sizeof(live_signals));
+    live_signals.present = LIVE_HAS_COMMANDS;
+    if (live_state_create(&live, "instrument_cluster"))
+    {
+        live_state_publish(&live, &live_signals);
+    }
+
     (void)printf("Waiting for new commands...\n");
     (void)fflush(stdout);
 
     for(;;) 
     {
-        fifo_fd = open(FIFO_PATH, O_RDONLY);
+        // A blocking open would wait for a writer past any stop signal
+        fifo_fd = open(FIFO_PATH, O_RDONLY | O_NONBLOCK);
         if (fifo_fd < 0) 
         {
             perror("Error opening FIFO");
             continue;
         }
+        if (!wait_for_command(fifo_fd))
+        {
+            close(fifo_fd);
+            (void)printf("Stop requested, exiting sender.\n");
+            break;
+        }
 
         memset(input, 0, sizeof(input));
         read(fifo_fd, input, AES_BLOCK_SIZE);
@@ -51,13 +116,18 @@ int main(void)
             (void)printf("Exiting sender.\n");
             break;
         }
-        if (strcmp(input, "") != 0) 
+        if ((strcmp(input, "") != 0) && check_input_command(input, sock))
         {
-            check_input_command(input, sock);
+            live_signals.commands++;
+            live_state_publish(&live, &live_signals);
         }
+        // This loop only wakes up on commands, so each one refreshes the export
+        (void)metrics_write();
     }
 
     close_can_socket(sock);
+    live_state_close(&live);
+    (void)metrics_write();
     unlink(FIFO_PATH);
     cleanup_logging_system();
     (void)printf("Sender terminated successfully.\n");
@@ -14,16 +14,20 @@
  * @brief Check inputs received by the instrument cluster.
  * @requirement SWR1.5
  */
-void check_input_command(char* option, int socket)
+bool check_input_command(char* option, int socket)
 {
+    bool sent = false;
+
     if (strcmp(option, "press_start_stop") == 0)
     {
         send_encrypted_message(socket, option, CAN_ID_COMMAND);
         log_toggle_event("[INFO] System button toggled");
+        sent = true;
     }
     else
     {
         printf("Invalid input. Try again.\n");
         fflush(stdout);
     }
+    return sent;
 }
@@ -4,6 +4,9 @@
 #include "../common_includes/can_id_list.h"
 #include "../common_includes/can_socket.h"
 #include "../common_includes/logging.h"
+#include "../common_includes/rt_sched.h"
+#include "../common_includes/live_state.h"
+#include "../common_includes/metrics.h"
 #include <fcntl.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -12,6 +15,7 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
-void check_input_command(char* option, int socket);
+// Returns true if the input was a command and was sent
+bool check_input_command(char* option, int socket);
 
 #endif
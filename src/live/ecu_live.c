@@ -0,0 +1,138 @@
+/*
+ * Live state reader.
+ *
+ * Prints the state each ECU mirrors to shared memory (see live_state.h): no
+ * CAN socket, no decryption, and nothing the ECUs wait for. Without ECU names
+ * all four are read; ECUs that are not running are reported as such.
+ */
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../common_includes/live_state.h"
+
+#define ERROR_CODE          (1)
+#define NSEC_PER_MS         (1000000L)
+#define MS_PER_SEC          (1000L)
+
+static const char *const default_ecus[] = { "bcm", "powertrain", "dashboard", "instrument_cluster" };
+
+static void usage(const char *prog)
+{
+    (void)fprintf(stderr,
+        "Usage: %s [options] [ECU...]\n"
+        "  -w MS       print again every MS milliseconds until interrupted\n"
+        "ECU: bcm, powertrain, dashboard, instrument_cluster (default: all)\n",
+        prog);
+}
+
+static int64_t now_ms(void)
+{
+    struct timespec now;
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((int64_t)now.tv_sec * MS_PER_SEC) + (now.tv_nsec / NSEC_PER_MS);
+}
+
+static void print_state(const char *ecu, const LiveSignals *s)
+{
+    (void)printf("%s updates=%" PRIu64 " age_ms=%" PRId64, ecu, s->updates, now_ms() - s->time_ms);
+    if ((s->present & LIVE_HAS_STEP) != 0U)
+    {
+        (void)printf(" step=%" PRId32, s->step);
+    }
+    if ((s->present & LIVE_HAS_SIGNALS) != 0U)
+    {
+        (void)printf(" speed=%.1f gear=%" PRId32 " accel=%" PRId32 " brake=%" PRId32
+                     " door=%" PRId32 " tilt=%.1f in_temp=%" PRId32 " ex_temp=%" PRId32
+                     " temp_set=%" PRId32 " engi_temp=%.1f batt_soc=%.1f batt_volt=%.2f",
+                     s->speed, s->gear, s->accel, s->brake, s->door_open, s->tilt_angle,
+                     s->internal_temp, s->external_temp, s->temp_set, s->engi_temp,
+                     s->batt_soc, s->batt_volt);
+    }
+    if ((s->present & LIVE_HAS_STOP_START) != 0U)
+    {
+        (void)printf(" start_stop=%u engine_off=%u restart_trigger=%u cond_bits=0x%02" PRIX32,
+                     s->start_stop_active, s->engine_off, s->restart_trigger, s->cond_bits);
+    }
+    if ((s->present & LIVE_HAS_FAULTS) != 0U)
+    {
+        (void)printf(" error=%u fault_flags=0x%02" PRIX32, s->error_system, s->fault_flags);
+    }
+    if ((s->present & LIVE_HAS_COMMANDS) != 0U)
+    {
+        (void)printf(" commands=%" PRIu32, s->commands);
+    }
+    if ((s->present & LIVE_HAS_SAVINGS) != 0U)
+    {
+        (void)printf(" engine_off_s=%.0f fuel_saved_ml=%.1f co2_saved_g=%.1f",
+                     s->engine_off_s, s->fuel_saved_ml, s->co2_saved_g);
+    }
+    (void)printf("\n");
+}
+
+// Attach on every pass, so ECUs started (or restarted) later are picked up
+static bool print_ecu(const char *ecu)
+{
+    LiveState live;
+    LiveSignals signals;
+    bool read = false;
+
+    if (!live_state_attach(&live, ecu))
+    {
+        (void)printf("%s not running\n", ecu);
+        return false;
+    }
+    read = live_state_read(&live, &signals);
+    if (read)
+    {
+        print_state(ecu, &signals);
+    }
+    else
+    {
+        (void)printf("%s busy (writer stalled mid-update)\n", ecu);
+    }
+    live_state_close(&live);
+    return read;
+}
+
+int main(int argc, char **argv)
+{
+    long watch_ms = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "w:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'w': watch_ms = atol(optarg); break;
+        default:
+            usage(argv[0]);
+            return ERROR_CODE;
+        }
+    }
+
+    const char *const *ecus = (optind < argc) ? (const char *const *)&argv[optind] : default_ecus;
+    const int num_ecus = (optind < argc) ? (argc - optind)
+                                         : (int)(sizeof(default_ecus) / sizeof(default_ecus[0]));
+    bool any = false;
+
+    do
+    {
+        for (int i = 0; i < num_ecus; i++)
+        {
+            any = print_ecu(ecus[i]) || any;
+        }
+        (void)fflush(stdout);
+        if (watch_ms > 0)
+        {
+            struct timespec pause = { watch_ms / MS_PER_SEC, (watch_ms % MS_PER_SEC) * NSEC_PER_MS };
+            (void)nanosleep(&pause, NULL);
+        }
+    } while (watch_ms > 0);
+
+    return any ? EXIT_SUCCESS : ERROR_CODE;
+}
@@ -0,0 +1,342 @@
+/*
+ * Synthetic CAN load generator.
+ *
+ * Sends encrypted sensor PDUs and command messages at a configurable rate
+ * and mix, with steady, jittered or bursty timing, then reads the receive
+ * counters exported by the powertrain and dashboard (see ecu_stats.h) and
+ * reports how many of the sent messages each consumer actually processed.
+ */
+#include <errno.h>
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../common_includes/can_id_list.h"
+#include "../common_includes/can_socket.h"
+#include "../common_includes/sensor_pdu.h"
+#include "../common_includes/can_reassembly.h"
+#include "../common_includes/ecu_stats.h"
+
+#define CAN_INTERFACE       ("vcan0")
+#define ERROR_CODE          (1)
+
+#define DEFAULT_RATE        (100.0)     // messages per second
+#define DEFAULT_DURATION_S  (10.0)
+#define DEFAULT_SENSOR_PCT  (90)
+#define DEFAULT_BURST       (20U)
+#define DEFAULT_JITTER_PCT  (50)
+#define DEFAULT_COMMAND     "loadgen_ping"
+#define SYNC_MESSAGE        "loadgen_sync"
+#define PERCENT             (100.0)
+#define NSEC_PER_SEC        (1000000000LL)
+#define USEC_PER_MSEC       (1000U)
+#define DRAIN_MS            (500U)
+#define MAX_SPEED           (130.0)
+#define SPEED_STEP          (2.0)
+
+typedef enum {
+    PROFILE_STEADY = 0,
+    PROFILE_JITTER,
+    PROFILE_BURSTY
+} LoadProfile;
+
+typedef struct {
+    const char *iface;
+    double rate;
+    double duration_s;
+    int sensor_pct;
+    LoadProfile profile;
+    unsigned int burst;
+    int jitter_pct;
+    unsigned int seed;
+    const char *command;
+} LoadConfig;
+
+typedef struct {
+    unsigned long sensor_msgs;
+    unsigned long command_msgs;
+    double elapsed_s;
+} LoadResult;
+
+static const char *const consumers[] = { "powertrain", "dashboard" };
+#define NUM_CONSUMERS (sizeof(consumers) / sizeof(consumers[0]))
+
+static long long mono_ns(void)
+{
+    struct timespec tss;
+    clock_gettime(CLOCK_MONOTONIC, &tss);
+    return ((long long)tss.tv_sec * NSEC_PER_SEC) + tss.tv_nsec;
+}
+
+static void sleep_until_ns(long long deadline_ns)
+{
+    struct timespec tss;
+    tss.tv_sec = (time_t)(deadline_ns / NSEC_PER_SEC);
+    tss.tv_nsec = (long)(deadline_ns % NSEC_PER_SEC);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &tss, NULL) == EINTR)
+    {
+        /* Interrupted: sleep the remainder */
+    }
+}
+
+// Uniform in [0, 1)
+static double rand_unit(unsigned int *seed)
+{
+    return (double)rand_r(seed) / ((double)RAND_MAX + 1.0);
+}
+
+static void usage(const char *prog)
+{
+    (void)fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  -i IFACE    CAN interface (default %s)\n"
+        "  -r RATE     mean messages per second (default %.0f)\n"
+        "  -d SECONDS  duration (default %.0f)\n"
+        "  -m PCT      share of sensor PDUs, rest are commands (default %d)\n"
+        "  -p PROFILE  steady | jitter | bursty (default steady)\n"
+        "  -b N        messages per burst for the bursty profile (default %u)\n"
+        "  -j PCT      interval jitter for the jitter profile, +/- PCT (default %d)\n"
+        "  -s SEED     random seed (default: time based)\n"
+        "  -c TEXT     command message text (default \"%s\")\n"
+        "Consumer counters are read from $%s (default %s).\n",
+        prog, CAN_INTERFACE, DEFAULT_RATE, DEFAULT_DURATION_S, DEFAULT_SENSOR_PCT,
+        DEFAULT_BURST, DEFAULT_JITTER_PCT, DEFAULT_COMMAND,
+        ECU_STATS_DIR_ENV, ECU_STATS_DEFAULT_DIR);
+}
+
+static bool parse_args(int argc, char **argv, LoadConfig *cfg)
+{
+    int opt;
+
+    while ((opt = getopt(argc, argv, "i:r:d:m:p:b:j:s:c:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'i': cfg->iface = optarg; break;
+        case 'r': cfg->rate = atof(optarg); break;
+        case 'd': cfg->duration_s = atof(optarg); break;
+        case 'm': cfg->sensor_pct = atoi(optarg); break;
+        case 'b': cfg->burst = (unsigned int)atoi(optarg); break;
+        case 'j': cfg->jitter_pct = atoi(optarg); break;
+        case 's': cfg->seed = (unsigned int)strtoul(optarg, NULL, 0); break;
+        case 'c': cfg->command = optarg; break;
+        case 'p':
+            if (strcmp(optarg, "steady") == 0)
+            {
+                cfg->profile = PROFILE_STEADY;
+            }
+            else if (strcmp(optarg, "jitter") == 0)
+            {
+                cfg->profile = PROFILE_JITTER;
+            }
+            else if (strcmp(optarg, "bursty") == 0)
+            {
+                cfg->profile = PROFILE_BURSTY;
+            }
+            else
+            {
+                return false;
+            }
+            break;
+        default:
+            return false;
+        }
+    }
+
+    return (cfg->rate > 0.0) && (cfg->duration_s > 0.0) &&
+           (cfg->sensor_pct >= 0) && (cfg->sensor_pct <= (int)PERCENT) &&
+           (cfg->burst > 0U) && (cfg->jitter_pct >= 0) && (cfg->jitter_pct < (int)PERCENT);
+}
+
+// Random-walk sensor values so consumers decode changing data
+static void next_sensor_pdu(SensorPdu *pdu, unsigned int *seed)
+{
+    pdu->speed += (rand_unit(seed) - 0.5) * SPEED_STEP * 2.0;
+    if (pdu->speed < 0.0)
+    {
+        pdu->speed = 0.0;
+    }
+    if (pdu->speed > MAX_SPEED)
+    {
+        pdu->speed = MAX_SPEED;
+    }
+    pdu->accel = (rand_unit(seed) < 0.5) ? 1 : 0;
+    pdu->brake = (pdu->accel != 0) ? 0 : 1;
+    pdu->gear = (pdu->speed > 0.0) ? 1 : 0;
+    pdu->present = SENSOR_PDU_ALL_PRESENT;
+}
+
+static void send_one(int sock, const LoadConfig *cfg, SensorPdu *pdu, unsigned int *seed,
+                     LoadResult *res)
+{
+    if (rand_unit(seed) * PERCENT < (double)cfg->sensor_pct)
+    {
+        unsigned char block[SENSOR_PDU_SIZE];
+        next_sensor_pdu(pdu, seed);
+        sensor_pdu_encode(pdu, block);
+        send_encrypted_block(sock, block, CAN_ID_SENSOR_READ);
+        res->sensor_msgs++;
+    }
+    else
+    {
+        send_encrypted_message(sock, cfg->command, CAN_ID_COMMAND);
+        res->command_msgs++;
+    }
+}
+
+static void run_load(int sock, const LoadConfig *cfg, LoadResult *res)
+{
+    const long long interval_ns = (long long)((double)NSEC_PER_SEC / cfg->rate);
+    const long long start_ns = mono_ns();
+    const long long end_ns = start_ns + (long long)(cfg->duration_s * (double)NSEC_PER_SEC);
+    long long next_ns = start_ns;
+    unsigned int seed = cfg->seed;
+    SensorPdu pdu = {
+        .internal_temp = 22, .external_temp = 25, .temp_set = 23,
+        .batt_soc = 80.0, .batt_volt = 12.5, .engi_temp = 90.0
+    };
+
+    while (next_ns < end_ns)
+    {
+        sleep_until_ns(next_ns);
+
+        switch (cfg->profile)
+        {
+        case PROFILE_BURSTY:
+            // Back-to-back burst, then idle so the mean rate is preserved
+            for (unsigned int i = 0; i < cfg->burst; i++)
+            {
+                send_one(sock, cfg, &pdu, &seed, res);
+            }
+            next_ns += interval_ns * (long long)cfg->burst;
+            break;
+        case PROFILE_JITTER:
+        {
+            send_one(sock, cfg, &pdu, &seed, res);
+            double jitter = ((rand_unit(&seed) * 2.0) - 1.0) * ((double)cfg->jitter_pct / PERCENT);
+            next_ns += (long long)((double)interval_ns * (1.0 + jitter));
+            break;
+        }
+        case PROFILE_STEADY:
+        default:
+            send_one(sock, cfg, &pdu, &seed, res);
+            next_ns += interval_ns;
+            break;
+        }
+    }
+
+    res->elapsed_s = (double)(mono_ns() - start_ns) / (double)NSEC_PER_SEC;
+}
+
+static void read_all_stats(EcuStats *stats, bool *found)
+{
+    for (size_t i = 0; i < NUM_CONSUMERS; i++)
+    {
+        found[i] = ecu_stats_read(consumers[i], &stats[i]);
+    }
+}
+
+/* Consumers flush their counters lazily: wait past the flush period, then
+   send one sync message (accepted by every consumer) so each receive loop
+   flushes again. The sync message itself is counted by the consumers. */
+static void sync_consumers(int sock)
+{
+    (void)usleep((DRAIN_MS + (unsigned int)ECU_STATS_FLUSH_MS) * USEC_PER_MSEC);
+    send_encrypted_message(sock, SYNC_MESSAGE, CAN_ID_COMMAND);
+    (void)usleep((DRAIN_MS + (unsigned int)ECU_STATS_FLUSH_MS) * USEC_PER_MSEC);
+}
+
+static void report(const LoadConfig *cfg, const LoadResult *res,
+                   const EcuStats *before, const EcuStats *after,
+                   const bool *found_before, const bool *found_after,
+                   unsigned long sync_msgs)
+{
+    const unsigned long sent = res->sensor_msgs + res->command_msgs;
+    static const char *const profile_names[] = { "steady", "jitter", "bursty" };
+
+    (void)printf("\nLoad: %s profile, target %.1f msg/s for %.1f s, %d%% sensor PDUs\n",
+                 profile_names[cfg->profile], cfg->rate, cfg->duration_s, cfg->sensor_pct);
+    (void)printf("Sent: %lu messages (%lu sensor, %lu command), %lu frames, %.1f msg/s achieved\n\n",
+                 sent, res->sensor_msgs, res->command_msgs, sent * CAN_FRAGS_PER_MSG,
+                 (res->elapsed_s > 0.0) ? ((double)sent / res->elapsed_s) : 0.0);
+
+    (void)printf("%-12s %10s %10s %9s %9s %9s %10s %8s\n", "consumer", "frames_rx",
+                 "processed", "rejected", "frag_drop", "queue_drop", "processed%", "drop%");
+
+    for (size_t i = 0; i < NUM_CONSUMERS; i++)
+    {
+        if (!found_after[i])
+        {
+            (void)printf("%-12s no counters (is it running with the same %s?)\n",
+                         consumers[i], ECU_STATS_DIR_ENV);
+            continue;
+        }
+
+        EcuStats zero = {0};
+        const EcuStats *base = found_before[i] ? &before[i] : &zero;
+        unsigned long processed = after[i].msgs_processed - base->msgs_processed;
+        unsigned long frames = after[i].frames_rx - base->frames_rx;
+        processed = (processed > sync_msgs) ? (processed - sync_msgs) : 0UL;
+        frames = (frames > (sync_msgs * CAN_FRAGS_PER_MSG)) ? (frames - (sync_msgs * CAN_FRAGS_PER_MSG)) : 0UL;
+        const double pct = (sent > 0UL) ? ((PERCENT * (double)processed) / (double)sent) : 0.0;
+
+        (void)printf("%-12s %10lu %10lu %9lu %9lu %9lu %9.1f%% %7.1f%%\n", consumers[i],
+                     frames, processed,
+                     after[i].msgs_rejected - base->msgs_rejected,
+                     after[i].frags_dropped - base->frags_dropped,
+                     after[i].queue_dropped - base->queue_dropped,
+                     pct, (pct < PERCENT) ? (PERCENT - pct) : 0.0);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    LoadConfig cfg = {
+        .iface = CAN_INTERFACE,
+        .rate = DEFAULT_RATE,
+        .duration_s = DEFAULT_DURATION_S,
+        .sensor_pct = DEFAULT_SENSOR_PCT,
+        .profile = PROFILE_STEADY,
+        .burst = DEFAULT_BURST,
+        .jitter_pct = DEFAULT_JITTER_PCT,
+        .seed = (unsigned int)time(NULL),
+        .command = DEFAULT_COMMAND
+    };
+    LoadResult res = {0};
+    EcuStats before[NUM_CONSUMERS];
+    EcuStats after[NUM_CONSUMERS];
+    bool found_before[NUM_CONSUMERS];
+    bool found_after[NUM_CONSUMERS];
+
+    if (!parse_args(argc, argv, &cfg))
+    {
+        usage(argv[0]);
+        return ERROR_CODE;
+    }
+
+    set_can_node_id(CAN_NODE_LOADGEN);
+    int sock = create_can_socket(cfg.iface);
+    if (sock < 0)
+    {
+        return ERROR_CODE;
+    }
+
+    // Counters from a previous run are the baseline
+    sync_consumers(sock);
+    read_all_stats(before, found_before);
+
+    run_load(sock, &cfg, &res);
+
+    sync_consumers(sock);
+    read_all_stats(after, found_after);
+
+    // The sync message sent after the load is counted in "after" only
+    report(&cfg, &res, before, after, found_before, found_after, 1UL);
+
+    close_can_socket(sock);
+    return EXIT_SUCCESS;
+}
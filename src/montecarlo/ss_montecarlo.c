@@ -0,0 +1,266 @@
+/*
+ * Monte Carlo sensor-noise study of the Stop/Start decision.
+ *
+ * Replays one drive cycle through thousands of seeded noise replicas (see
+ * stop_start_mc.h) on every core and reports the distribution of engine-off
+ * counts and of spurious inhibits, with the conditions to blame for them.
+ * Replica N of a seed is always the same, whatever the thread count.
+ */
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../powertrain/stop_start_mc.h"
+#include "../bcm/bcm_trace.h"
+
+#define ERROR_CODE          (1)
+#define DEFAULT_CYCLE       ("../src/bcm/full_simu.csv")
+#define DEFAULT_REPLICAS    (1000U)
+#define NSEC_PER_SEC        (1000000000.0)
+#define PERCENT             (100.0)
+
+// Used when no -N is given: typical sensor resolution and bus losses
+static const char *const default_noise[] = {
+    "all:dropout=0.01",
+    "tilt_angle:sigma=0.3",
+    "internal_temp:sigma=0.5",
+    "external_temp:sigma=0.5",
+    "engi_temp:sigma=1.0",
+    "batt_soc:sigma=0.5",
+    "batt_volt:sigma=0.05"
+};
+
+#define NUM_DEFAULT_NOISE (sizeof(default_noise) / sizeof(default_noise[0]))
+
+typedef struct {
+    const char *name;
+    size_t field;
+} ReportRow;
+
+static const ReportRow report_rows[] = {
+    { "engine_offs",       offsetof(McReplica, engine_offs) },
+    { "restarts",          offsetof(McReplica, restarts) },
+    { "restart_failures",  offsetof(McReplica, restart_failures) },
+    { "engine_off_steps",  offsetof(McReplica, engine_off_steps) },
+    { "spurious_inhibits", offsetof(McReplica, spurious_inhibits) },
+    { "spurious_allows",   offsetof(McReplica, spurious_allows) }
+};
+
+#define NUM_REPORT_ROWS (sizeof(report_rows) / sizeof(report_rows[0]))
+
+static void usage(const char *prog)
+{
+    (void)fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  -c FILE     drive cycle, CSV or binary (default %s)\n"
+        "  -r FILE     Stop/Start rule file (default: built-in rules)\n"
+        "  -n COUNT    replicas (default %u)\n"
+        "  -s SEED     random seed (default 1)\n"
+        "  -j THREADS  worker threads (default: online CPUs)\n"
+        "  -N SPEC     noise model, repeatable: signal:key=value[,key=value...]\n"
+        "              signal is a rule signal name or \"all\"; keys: bias, sigma,\n"
+        "              dropout (0..1), latency and jitter (steps)\n"
+        "              default: all:dropout=0.01, sigma 0.3 tilt_angle, 0.5 cabin\n"
+        "              temperatures and batt_soc, 1.0 engi_temp, 0.05 batt_volt\n"
+        "  -o FILE     per-replica results as CSV\n",
+        prog, DEFAULT_CYCLE, DEFAULT_REPLICAS);
+}
+
+static double now_s(void)
+{
+    struct timespec now;
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + ((double)now.tv_nsec / NSEC_PER_SEC);
+}
+
+static void print_noise(const NoiseConfig *noise)
+{
+    for (unsigned int i = 0U; i < TRACE_SIGNAL_COUNT; i++)
+    {
+        const NoiseModel *m = &noise->models[i];
+        if ((m->bias != 0.0) || (m->sigma != 0.0) || (m->dropout != 0.0) || (m->latency != 0U) || (m->jitter != 0U))
+        {
+            (void)printf("  %-14s bias=%g sigma=%g dropout=%g latency=%u jitter=%u\n",
+                         signal_trace_name((TraceSignal)i), m->bias, m->sigma, m->dropout,
+                         m->latency, m->jitter);
+        }
+    }
+}
+
+static bool write_replicas(const char *path, const McReplica *results, unsigned int count)
+{
+    FILE *file = fopen(path, "w");
+
+    if (file == NULL)
+    {
+        perror(path);
+        return false;
+    }
+    (void)fprintf(file, "replica");
+    for (size_t r = 0U; r < NUM_REPORT_ROWS; r++)
+    {
+        (void)fprintf(file, ",%s", report_rows[r].name);
+    }
+    (void)fputc('\n', file);
+    for (unsigned int i = 0U; i < count; i++)
+    {
+        (void)fprintf(file, "%u", i);
+        for (size_t r = 0U; r < NUM_REPORT_ROWS; r++)
+        {
+            unsigned long value = 0UL;
+            (void)memcpy(&value, (const unsigned char *)&results[i] + report_rows[r].field, sizeof(value));
+            (void)fprintf(file, ",%lu", value);
+        }
+        (void)fputc('\n', file);
+    }
+    return fclose(file) == 0;
+}
+
+static void print_report(const RuleSet *rules, const McReplica *clean, const McReplica *results,
+                         unsigned int count)
+{
+    McDistribution dist;
+    unsigned long blame_total = 0UL;
+
+    (void)printf("Clean trace: engine_offs=%lu restarts=%lu restart_failures=%lu engine_off_steps=%lu\n",
+                 clean->engine_offs, clean->restarts, clean->restart_failures, clean->engine_off_steps);
+    (void)printf("%-18s %10s %9s %8s %8s %8s %8s %8s\n",
+                 "", "mean", "stddev", "min", "p5", "p50", "p95", "max");
+    for (size_t r = 0U; r < NUM_REPORT_ROWS; r++)
+    {
+        if (mc_distribution(results, count, report_rows[r].field, &dist))
+        {
+            (void)printf("%-18s %10.2f %9.2f %8lu %8lu %8lu %8lu %8lu\n", report_rows[r].name,
+                         dist.mean, dist.stddev, dist.min, dist.p5, dist.p50, dist.p95, dist.max);
+        }
+    }
+
+    unsigned long blame[RULES_MAX_CONDITIONS] = { 0UL };
+    for (unsigned int i = 0U; i < count; i++)
+    {
+        for (size_t c = 0U; c < rules->num_conditions; c++)
+        {
+            blame[c] += results[i].blame[c];
+            blame_total += results[i].blame[c];
+        }
+    }
+    (void)printf("Failed conditions on spurious inhibits:\n");
+    for (size_t c = 0U; c < rules->num_conditions; c++)
+    {
+        (void)printf("  %-14s %10lu  %5.1f%%\n", rules->conditions[c].name, blame[c],
+                     (blame_total > 0UL) ? (PERCENT * (double)blame[c] / (double)blame_total) : 0.0);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    static RuleSet rules;
+    NoiseConfig noise;
+    SignalTrace clean;
+    McConfig config;
+    McReplica baseline;
+    const char *cycle_path = DEFAULT_CYCLE;
+    const char *rules_path = NULL;
+    const char *output = NULL;
+    const char *error = NULL;
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    bool noise_given = false;
+    int opt;
+
+    noise_config_clear(&noise);
+    (void)memset(&config, 0, sizeof(config));
+    config.replicas = DEFAULT_REPLICAS;
+    config.seed = 1U;
+
+    while ((opt = getopt(argc, argv, "c:r:n:s:j:N:o:h")) != -1)
+    {
+        bool valid = true;
+        switch (opt)
+        {
+        case 'c': cycle_path = optarg; break;
+        case 'r': rules_path = optarg; break;
+        case 'n': config.replicas = (unsigned int)strtoul(optarg, NULL, 10); break;
+        case 's': config.seed = strtoull(optarg, NULL, 0); break;
+        case 'j': threads = strtol(optarg, NULL, 10); break;
+        case 'N':
+            valid = noise_config_parse(&noise, optarg, &error);
+            noise_given = true;
+            if (!valid)
+            {
+                (void)fprintf(stderr, "%s: %s\n", optarg, error);
+            }
+            break;
+        case 'o': output = optarg; break;
+        default: valid = false; break;
+        }
+        if (!valid)
+        {
+            usage(argv[0]);
+            return ERROR_CODE;
+        }
+    }
+    if ((config.replicas == 0U) || (config.replicas > MC_MAX_REPLICAS) || (threads < 1L))
+    {
+        usage(argv[0]);
+        return ERROR_CODE;
+    }
+    config.threads = (threads > (long)MC_MAX_THREADS) ? MC_MAX_THREADS : (unsigned int)threads;
+
+    for (size_t i = 0U; (i < NUM_DEFAULT_NOISE) && !noise_given; i++)
+    {
+        (void)noise_config_parse(&noise, default_noise[i], &error);
+    }
+    if (!((rules_path == NULL) ? rule_set_load_default(&rules) : rule_set_load_file(&rules, rules_path)))
+    {
+        return ERROR_CODE;
+    }
+    if (!bcm_cycle_trace(cycle_path, &clean))
+    {
+        (void)fprintf(stderr, "No drive cycle in %s\n", cycle_path);
+        return ERROR_CODE;
+    }
+
+    McReplica *results = (McReplica *)calloc(config.replicas, sizeof(McReplica));
+    unsigned int *satisfied = (unsigned int *)malloc(clean.steps * sizeof(unsigned int));
+    if ((results == NULL) || (satisfied == NULL))
+    {
+        free(results);
+        free(satisfied);
+        signal_trace_free(&clean);
+        return ERROR_CODE;
+    }
+    config.rules = &rules;
+    config.clean = &clean;
+    config.noise = &noise;
+
+    rule_set_evaluate_trace(&rules, (const double *const *)clean.values, clean.steps, satisfied);
+    mc_replay(&rules, &clean, satisfied, &baseline);
+
+    const double start = now_s();
+    bool ok = mc_run(&config, results);
+    const double elapsed = now_s() - start;
+
+    if (ok)
+    {
+        (void)printf("Monte Carlo: %u replicas of %s (%zu steps), seed %llu, %u threads, %.2f s (%.0f replicas/s)\n",
+                     config.replicas, cycle_path, clean.steps, (unsigned long long)config.seed,
+                     config.threads, elapsed, (elapsed > 0.0) ? ((double)config.replicas / elapsed) : 0.0);
+        (void)printf("Noise:\n");
+        print_noise(&noise);
+        print_report(&rules, &baseline, results, config.replicas);
+        ok = (output == NULL) || write_replicas(output, results, config.replicas);
+    }
+    else
+    {
+        (void)fprintf(stderr, "Monte Carlo run failed\n");
+    }
+
+    free(satisfied);
+    free(results);
+    signal_trace_free(&clean);
+    return ok ? 0 : ERROR_CODE;
+}
@@ -1,6 +1,8 @@
 #include "can_comms.h"
+#include "powertrain_func.h"
 
 bool start_stop_manual = false;
+CanReassembler powertrain_reassembler = {0};
 
 bool check_is_valid_can_id_powertrain(canid_t can_id)
 {
@@ -31,6 +33,7 @@ void parse_input_received_powertrain(char *input)
 
         if (start_stop_manual)
         {
+            reset_engine_condition_reports();
             log_toggle_event("Stop/Start: System Activated");
         }
         else
@@ -118,15 +121,111 @@ void parse_input_received_powertrain(char *input)
     }
 }
 
+/**
+ * @brief Decode a sensor PDU into rec_data. Signals not carried by the
+ * PDU keep their last received value.
+ * @requirement SWR1.2
+ */
+bool apply_sensor_pdu_powertrain(const unsigned char *block)
+{
+    SensorPdu pdu = {
+        .speed = rec_data.speed,
+        .internal_temp = rec_data.internal_temp,
+        .external_temp = rec_data.external_temp,
+        .door_open = rec_data.door_open,
+        .tilt_angle = rec_data.tilt_angle,
+        .accel = rec_data.accel,
+        .brake = rec_data.brake,
+        .temp_set = rec_data.temp_set,
+        .batt_soc = rec_data.batt_soc,
+        .batt_volt = rec_data.batt_volt,
+        .engi_temp = rec_data.engi_temp,
+        .gear = rec_data.gear
+    };
+
+    if (!sensor_pdu_decode(block, &pdu))
+    {
+        return false;
+    }
+
+    rec_data.speed = pdu.speed;
+    rec_data.internal_temp = pdu.internal_temp;
+    rec_data.external_temp = pdu.external_temp;
+    rec_data.door_open = pdu.door_open;
+    rec_data.tilt_angle = pdu.tilt_angle;
+    rec_data.accel = pdu.accel;
+    rec_data.brake = pdu.brake;
+    rec_data.temp_set = pdu.temp_set;
+    rec_data.batt_soc = pdu.batt_soc;
+    rec_data.batt_volt = pdu.batt_volt;
+    rec_data.engi_temp = pdu.engi_temp;
+    rec_data.gear = pdu.gear;
+    return true;
+}
+
+/**
+ * @brief Take one received frame through ID filtering, reassembly,
+ * decryption and parsing. Returns true once the frame completes a message,
+ * accepted or rejected.
+ * @requirement SWR1.2
+ */
+bool powertrain_receive_frame(const struct can_frame *frame)
+{
+    unsigned char encrypted_data[CAN_MSG_WIRE_SIZE];
+    char decrypted_message[AES_BLOCK_SIZE + 1];
+    bool message_complete = false;
+
+    if (!check_is_valid_can_id_powertrain(frame->can_id))
+    {
+        metrics_inc(METRIC_FRAMES_FILTERED);
+        return false;
+    }
+
+    const long long now_ms = can_reasm_now_ms();
+    CanReasmResult result = can_reasm_push(&powertrain_reassembler, frame,
+                                           now_ms, encrypted_data);
+    metrics_inc(METRIC_FRAMES_ACCEPTED);
+
+    if (result == CAN_REASM_COMPLETE)
+    {
+        // Forged, corrupted or replayed blocks are never parsed
+        if (decrypt_data(encrypted_data, decrypted_message, CAN_MSG_WIRE_SIZE,
+                         frame->can_id) == DECRYPT_OK)
+        {
+            // Sensor PDUs are binary, everything else is a text message
+            if (!apply_sensor_pdu_powertrain((const unsigned char *)decrypted_message))
+            {
+                parse_input_received_powertrain(decrypted_message);
+            }
+            metrics_inc(METRIC_MESSAGES_PROCESSED);
+        }
+        else
+        {
+            (void)printf("Warning: Rejected message (id 0x%X).\n", frame->can_id);
+            (void)fflush(stdout);
+        }
+        metrics_flush(timer_wheel_now_ms());
+        message_complete = true;
+    }
+    else if (result == CAN_REASM_DROPPED)
+    {
+        (void)printf("Warning: Unexpected fragment (id 0x%X, %d bytes). Ignoring.\n",
+                     frame->can_id, frame->can_dlc);
+        (void)fflush(stdout);
+    }
+    else
+    {
+        /* Waiting for the remaining fragments */
+    }
+    return message_complete;
+}
+
 void process_received_frame_powertrain(int sock)
 {
     struct can_frame frame;
-    unsigned char encrypted_data[AES_BLOCK_SIZE];
-    char decrypted_message[AES_BLOCK_SIZE];
-    int received_bytes = 0;
-    char message_log[LOG_MESSAGE_SIZE];
+    bool message_complete = false;
 
-    while(received_bytes < AES_BLOCK_SIZE)
+    while (!message_complete)
     {
         if (test_mode_powertrain) 
         {
@@ -135,26 +234,7 @@ void process_received_frame_powertrain(int sock)
 
         if (receive_can_frame(sock, &frame) == 0)
         {
-            if (check_is_valid_can_id_powertrain(frame.can_id))
-            {
-                if (frame.can_dlc == CAN_DATA_LENGTH)
-                {
-                    memcpy(encrypted_data + received_bytes, frame.data, CAN_DATA_LENGTH);
-                    received_bytes += CAN_DATA_LENGTH;
-
-                    if (received_bytes == AES_BLOCK_SIZE)
-                    {
-                        decrypt_data(encrypted_data, decrypted_message, received_bytes);
-                        parse_input_received_powertrain(decrypted_message);
-                    }
-                }
-                else
-                {
-                    (void)printf("Warning: Unexpected frame size (%d bytes). Ignoring.\n", frame.can_dlc);
-                    (void)fflush(stdout);
-                }
-            }
+            message_complete = powertrain_receive_frame(&frame);
         }
     }
-    received_bytes = 0;
 }
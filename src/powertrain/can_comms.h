@@ -4,17 +4,22 @@
 #include <stdbool.h>
 #include "../common_includes/can_id_list.h"
 #include "../common_includes/can_socket.h"
+#include "../common_includes/can_reassembly.h"
+#include "../common_includes/sensor_pdu.h"
+#include "../common_includes/ecu_stats.h"
+#include "../common_includes/metrics.h"
+#include "../common_includes/timer_wheel.h"
 #include "../common_includes/logging.h"
 #include "globals.h"
 
 #define CAN_INTERFACE ("vcan0")
-#define CAN_DATA_LENGTH (8)
 #define LOG_MESSAGE_SIZE (50)
 #define SUCCESS_CODE (0)
 #define ERROR_CODE (1)
 
 extern bool start_stop_manual;
 extern int sock;
+extern CanReassembler powertrain_reassembler;
 
 // Vehicle simulation data
 typedef struct {
@@ -41,6 +46,11 @@ bool check_is_valid_can_id_powertrain(canid_t can_id);
 
 void process_received_frame_powertrain(int sock);
 
+// ID filter, reassembly, decryption and parsing of one frame; true once a message is complete
+bool powertrain_receive_frame(const struct can_frame *frame);
+
 void parse_input_received_powertrain(char *input);
 
+bool apply_sensor_pdu_powertrain(const unsigned char *block);
+
 #endif //CAN_COMMS_H
\ No newline at end of file
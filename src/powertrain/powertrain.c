@@ -1,32 +1,173 @@
 #include "powertrain_func.h"
+#include "powertrain_tasks.h"
+#include "../common_includes/can_capture.h"
+#include "../common_includes/ecu_shutdown.h"
+#include <fcntl.h>
+#include <getopt.h>
 
-int main()
+#define SAVINGS_TEXT_SIZE       (192)
+#define SCHED_TICK_MS           (10LL)
+
+typedef struct {
+    CanCaptureReader reader;
+    int sock;
+    double speed;
+    volatile sig_atomic_t stop;     // Set by main once the loops are done
+} ReplaySource;
+
+/* Feeds a recorded capture into the in-process transport in place of the
+   bus, so an incident can be replayed against this build at any speed */
+static void *replay_thread(void *arg)
+{
+    ReplaySource *source = (ReplaySource *)arg;
+    char log_msg[LOG_MESSAGE_SIZE];
+
+    (void)rt_configure_thread("replay", 2U, -1);
+
+    const size_t sent = can_replay_run(&source->reader, source->sock, source->speed, &source->stop);
+    (void)snprintf(log_msg, sizeof(log_msg), "Replay done: %zu frames", sent);
+    log_toggle_event(log_msg);
+    return NULL;
+}
+
+int main(int argc, char **argv)
 {
+    const char *capture_path = NULL;
+    const char *telemetry_path = NULL;
+    const char *rules_path = NULL;
+    bool telemetry_compress = false;
+    double replay_speed = 1.0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "c:r:s:t:z")) != -1)
+    {
+        switch (opt)
+        {
+        case 'c': rules_path = optarg; break;
+        case 'r': capture_path = optarg; break;
+        case 's': replay_speed = atof(optarg); break;
+        case 't': telemetry_path = optarg; break;
+        case 'z': telemetry_compress = true; break;
+        default:
+            fprintf(stderr, "Usage: %s [-c RULES] [-r CAPTURE [-s SPEED]] [-t TELEMETRY [-z]]\n", argv[0]);
+            return ERROR_CODE;
+        }
+    }
+
+    // Rule file errors are reported before anything else starts
+    if (!load_stop_start_rules(rules_path))
+    {
+        return ERROR_CODE;
+    }
+
     if (!init_logging_system())
     {
         fprintf(stderr, "Failed to open log file for writing.\n");
         return ERROR_CODE;
     }
 
-    sock_receiver = create_can_socket(CAN_INTERFACE);
-    sock_sender = create_can_socket(CAN_INTERFACE);
+    /* SIGINT/SIGTERM arrive through a signalfd (ecu_shutdown.h); blocked here,
+       before the replay thread exists, so no thread is ever interrupted */
+    if (!ecu_shutdown_init())
+    {
+        return ERROR_CODE;
+    }
+
+    // Opt-in RT mode (ECU_RT=1): memory is locked before the threads start
+    (void)rt_init("powertrain");
+
+    set_can_node_id(CAN_NODE_POWERTRAIN);
+    metrics_init("powertrain");
+    init_powertrain_jitter();
+    // Monitors read the live state without joining the bus (ecu_live)
+    (void)live_state_create(&powertrain_live, "powertrain");
+    // Opt-in snapshots (ECU_CHECKPOINT_DIR): pick up where the last run stopped
+    if (checkpoint_init(&powertrain_checkpoint, "powertrain") && restore_powertrain_checkpoint())
+    {
+        (void)printf("Resumed from checkpoint %llu\n", (unsigned long long)powertrain_checkpoint.sequence);
+    }
+    // The periodic snapshots are written off the Stop/Start period
+    (void)checkpoint_start_writer(&powertrain_checkpoint);
+
+    static ReplaySource replay;
+    pthread_t thread_replay;
+    bool replay_started = false;
+    if (capture_path != NULL)
+    {
+        int pair[2];
+        if (!can_capture_open_reader(&replay.reader, capture_path) ||
+            (create_can_loopback_pair(pair) != 0))
+        {
+            return ERROR_CODE;
+        }
+        replay.sock = pair[0];
+        replay.speed = replay_speed;
+        sock_receiver = pair[1];
+        // Replayed runs stay off the bus: outgoing messages are discarded
+        sock_sender = open("/dev/null", O_WRONLY);
+    }
+    else
+    {
+        sock_receiver = create_can_socket(CAN_INTERFACE);
+        sock_sender = create_can_socket(CAN_INTERFACE);
+    }
     if (sock_receiver < 0 || sock_sender < 0)
     {
         return ERROR_CODE;
     }
 
-    pthread_mutex_init(&mutex_powertrain, NULL);
+    if ((telemetry_path != NULL) && !open_powertrain_telemetry(telemetry_path, telemetry_compress))
+    {
+        fprintf(stderr, "Failed to open telemetry file %s\n", telemetry_path);
+        return ERROR_CODE;
+    }
 
-    pthread_t thread_start_stop;
-    pthread_t thread_comms;
+    // Stop/Start and reception are coroutines on this thread (powertrain_tasks.h)
+    static CoroScheduler sched;
+    static PowertrainTasks tasks;
+    static Coro shutdown_co;
+    if (!coro_sched_init(&sched, SCHED_TICK_MS) || !powertrain_tasks_spawn(&sched, &tasks) ||
+        !ecu_shutdown_spawn(&sched, &shutdown_co))
+    {
+        return ERROR_CODE;
+    }
+    (void)rt_configure_thread("powertrain", 0U, 0);
 
-    pthread_create(&thread_start_stop, NULL, function_start_stop, &rec_data);
-    pthread_create(&thread_comms, NULL, powertrain_comms, NULL);
+    if (capture_path != NULL)
+    {
+        replay_started = (pthread_create(&thread_replay, NULL, replay_thread, &replay) == 0);
+    }
+
+    coro_sched_run(&sched, ecu_shutdown_flag());
+
+    // The replay stops at its next frame, before the sockets are closed
+    if (replay_started)
+    {
+        replay.stop = 1;
+        (void)pthread_join(thread_replay, NULL);
+    }
+    if (capture_path != NULL)
+    {
+        can_capture_close_reader(&replay.reader);
+    }
 
-    pthread_join(thread_start_stop, NULL);
-    pthread_join(thread_comms, NULL);
+    // Nothing runs between two periods: the telemetry file ends on a whole row
+    close_powertrain_telemetry();
+    (void)metrics_write();
+    if (checkpoint_enabled(&powertrain_checkpoint))
+    {
+        checkpoint_stop_writer(&powertrain_checkpoint);
+        (void)save_powertrain_checkpoint();
+    }
 
-    pthread_mutex_destroy(&mutex_powertrain);
+    // Fuel saved by this run, in the log next to the Stop/Start events
+    char savings[SAVINGS_TEXT_SIZE];
+    const int prefix = snprintf(savings, sizeof(savings), "Stop/Start savings: ");
+    (void)fuel_savings_format(&powertrain_savings, &savings[prefix], sizeof(savings) - (size_t)prefix);
+    (void)printf("%s\n", savings);
+    log_toggle_event(savings);
+    live_state_close(&powertrain_live);
+    coro_sched_close(&sched);
 
     close_can_socket(sock_receiver);
     close_can_socket(sock_sender);
@@ -34,4 +175,4 @@ int main()
     cleanup_logging_system();
 
     return 0;
-}
\ No newline at end of file
+}
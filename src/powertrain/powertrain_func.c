@@ -1,17 +1,8 @@
 #include "powertrain_func.h"
 
 #define SLEEP_TIME_US (1000000U)
-#define COMMS_TIME_US (50000U)
-#define MICROSECS_IN_ONESEC (1000000L)
-#define NANO_TO_MICRO (1000)
-
-void sleep_microseconds_pw(long int msec)
-{
-    struct timespec tspec;
-    tspec.tv_sec = msec / MICROSECS_IN_ONESEC;
-    tspec.tv_nsec = (msec % MICROSECS_IN_ONESEC) * NANO_TO_MICRO;
-    nanosleep(&tspec, NULL);
-}
+#define MS_IN_ONESEC (1000LL)
+#define NANO_IN_ONEMS (1000000L)
 
 bool test_mode_powertrain = false;
 
@@ -20,23 +11,13 @@ bool test_mode_powertrain = false;
 VehicleData rec_data = {0};
 
 bool engine_off = false;
-pthread_mutex_t mutex_powertrain;
-
-/* Battery operation */
-
-#define MIN_BATTERY_VOLTAGE 10.0F
-#define MIN_BATTERY_SOC 70.0F
-
-/* Tilt angle operation */
-
-#define MAX_TILT_ANGLE 5.0F
+bool disable_pending = false;
 
-/* Temperatures operation */
-
-#define MAX_TEMP_DIFF 5
-
-#define MAX_ENGINE_TEMP 105
-#define MIN_ENGINE_TEMP 20
+RtJitterReport powertrain_jitter;
+LiveState powertrain_live;
+FuelSavings powertrain_savings = { .last_ms = -1 };
+Checkpoint powertrain_checkpoint;
+static RtLoop *start_stop_loop = NULL;
 
 /* CAN communication sockets*/
 int sock_sender = -1;
@@ -46,64 +27,70 @@ int sock_receiver = -1;
 
 bool restart_trigger = false;
 
-/* Condition check functions */
-static bool check_movement_conditions(double speed, int accel, int brake, int gear)
-{
-    return (fabs(speed) == 0.0F) && (accel == 0) && (brake != 0) && (gear == 0);
-}
+/* Conditions seen by the last check_disable_engine call (COND_BIT_*) */
+unsigned int engine_condition_bits = 0U;
 
-static bool check_temperature_conditions(int internal_temp, int external_temp, int temp_set)
-{
-    return (internal_temp <= (temp_set + MAX_TEMP_DIFF)) && (external_temp >= temp_set);
-}
+/* Inhibit conditions: built-in calibration unless a rule file is loaded */
+static RuleSet active_rules;
+static bool active_rules_loaded = false;
+
+/* Failed conditions already reported on CAN and in the log */
+static unsigned int reported_failure_bits = 0U;
 
-static bool check_engine_temp_conditions(double engi_temp)
+bool load_stop_start_rules(const char *path)
 {
-    return (engi_temp >= MIN_ENGINE_TEMP) && (engi_temp <= MAX_ENGINE_TEMP);
+    static RuleSet loaded;
+
+    if (!((path == NULL) ? rule_set_load_default(&loaded) : rule_set_load_file(&loaded, path)))
+    {
+        return false;
+    }
+    active_rules = loaded;
+    active_rules_loaded = true;
+    reported_failure_bits = 0U;
+    return true;
 }
 
-static bool check_battery_conditions(double batt_soc, double batt_volt)
+const RuleSet *get_stop_start_rules(void)
 {
-    return (batt_soc >= MIN_BATTERY_SOC) && (batt_volt > MIN_BATTERY_VOLTAGE);
+    if (!active_rules_loaded)
+    {
+        (void)load_stop_start_rules(NULL);
+    }
+    return &active_rules;
 }
 
-static bool check_door_conditions(int door_open)
+/**
+ * @brief Evaluate every engine-off condition into a mask of satisfied
+ * conditions (COND_BIT_* with the built-in rules).
+ */
+unsigned int evaluate_engine_conditions(const VehicleData *data)
 {
-    return (door_open == 0);
+    return rule_set_evaluate(get_stop_start_rules(), data);
 }
 
-static bool check_tilt_conditions(double tilt_angle)
+void reset_engine_condition_reports(void)
 {
-    return (tilt_angle <= MAX_TILT_ANGLE);
+    reported_failure_bits = 0U;
 }
 
-/* Condition evaluation with logging */
-
-typedef struct {
-    const char* can_error;    // Message for CAN bus
-    const char* system_log;   // Message for system log
-} EngineConditionMessages;
-
-/* Then modify the evaluation function */
-static int evaluate_condition_with_logging(
-    bool condition, 
-    bool engine_off_state,
-    EngineConditionMessages messages)  // Single parameter for all messages
+static void report_condition_failures(const RuleSet *rules, unsigned int new_failures)
 {
-    if (condition) {
-        return 1;
-    }
-    
-    if (!engine_off_state) {
-        send_encrypted_message(sock_sender, messages.can_error, CAN_ID_ERROR_DASH);
-        log_toggle_event(messages.system_log);
+    for (size_t i = 0U; i < rules->num_conditions; i++)
+    {
+        if ((new_failures & (1U << i)) != 0U)
+        {
+            send_encrypted_message(sock_sender, rules->conditions[i].can_error, CAN_ID_ERROR_DASH);
+            log_toggle_event((char *)rules->conditions[i].system_log);
+        }
     }
-    return 0;
 }
 
 /* Main function */
 /**
  * @brief Check each condition for disable the engine.
+ * Failures are reported once, when a condition goes from satisfied to
+ * failed while the engine is on, instead of on every evaluation.
  * @requirement SWR2.2
  * @requirement SWR2.3
  * @requirement SWR2.4
@@ -117,80 +104,37 @@ static int evaluate_condition_with_logging(
  */
 void check_disable_engine(VehicleData *ptr_rec_data)
 {
-    bool engine_off_local;
-    int cond1;
-    int cond2;
-    int cond3;
-    int cond4;
-    int cond5;
-    int cond6;
-    
-    engine_off_local = engine_off;
-
-    /* Check each condition */
-    cond1 = evaluate_condition_with_logging(
-        check_movement_conditions(ptr_rec_data->speed, ptr_rec_data->accel, 
-                                 ptr_rec_data->brake, ptr_rec_data->gear),
-        engine_off_local,
-        (EngineConditionMessages){
-            .can_error = "error_brake_not_pressed",
-            .system_log = "Stop/Start: SWR2.8 (Brake not pressed or car is moving!)"
-        });
-    
-    cond2 = evaluate_condition_with_logging(
-        check_temperature_conditions(ptr_rec_data->internal_temp,
-                                   ptr_rec_data->external_temp,
-                                   ptr_rec_data->temp_set),
-        engine_off_local,
-        (EngineConditionMessages){
-            .can_error = "error_temperature_out_range",
-            .system_log = "Stop/Start: SWR2.8 (Difference between internal and external temps out of range!)"
-        });
-    
-    cond3 = evaluate_condition_with_logging(
-        check_engine_temp_conditions(ptr_rec_data->engi_temp),
-        engine_off_local,
-        (EngineConditionMessages){
-            .can_error = "error_engine_temperature_out_range",
-            .system_log = "Stop/Start: SWR2.8 (Engine temperature out of range!)"
-        });
-    
-    cond4 = evaluate_condition_with_logging(
-        check_battery_conditions(ptr_rec_data->batt_soc, ptr_rec_data->batt_volt),
-        engine_off_local,
-        (EngineConditionMessages){
-            .can_error = "error_battery_out_range",
-            .system_log = "Stop/Start: SWR2.8 (Battery is not in operating range!)"
-        });
-    
-    cond5 = evaluate_condition_with_logging(
-        check_door_conditions(ptr_rec_data->door_open),
-        engine_off_local,
-        (EngineConditionMessages){
-            .can_error = "error_door_open",
-            .system_log = "Stop/Start: SWR2.8 (One or more doors are opened!)"
-        });
-    
-    cond6 = evaluate_condition_with_logging(
-        check_tilt_conditions(ptr_rec_data->tilt_angle),
-        engine_off_local,
-        (EngineConditionMessages){
-            .can_error = "error_tilt_angle",
-            .system_log = "Stop/Start: SWR2.8 (Tilt angle greater than 5 degrees!)"
-        });
+    const RuleSet *rules = get_stop_start_rules();
+    const unsigned int satisfied = rule_set_evaluate(rules, ptr_rec_data);
+    const unsigned int failed = rules->all_bits & ~satisfied;
+
+    engine_condition_bits = satisfied;
+
+    if (engine_off)
+    {
+        /* No reports while the engine is off, but a recovered condition
+           is reported again if it fails later */
+        reported_failure_bits &= failed;
+        return;
+    }
+
+    const unsigned int new_failures = failed & ~reported_failure_bits;
+    if (new_failures != 0U)
+    {
+        report_condition_failures(rules, new_failures);
+    }
+    reported_failure_bits = failed;
 
     /* Final decision */
-    if ((cond1 != 0) && (cond2 != 0) && (cond3 != 0) && 
-        (cond4 != 0) && (cond5 != 0) && (cond6 != 0))
+    StopStartState state = { engine_off, restart_trigger, false };
+    if (stop_start_engine_off(&state, failed))
     {
-        if (engine_off_local == false)
-        {
-            engine_off = true;
-            send_encrypted_message(sock_sender, "ENGINE OFF", CAN_ID_ECU_RESTART);
-            log_toggle_event("Stop/Start: Engine turned Off");
-            printf("Engine turned off\n");
-            fflush(stdout);
-        }
+        engine_off = state.engine_off;
+        metrics_inc(METRIC_ENGINE_OFF_EVENTS);
+        send_encrypted_message(sock_sender, "ENGINE OFF", CAN_ID_ECU_RESTART);
+        log_toggle_event("Stop/Start: Engine turned Off");
+        printf("Engine turned off\n");
+        fflush(stdout);
     }
 }
 
@@ -205,45 +149,40 @@ void check_disable_engine(VehicleData *ptr_rec_data)
 void handle_engine_restart_logic(
     VehicleData *data)
 {
-    /* Restart trigger detection */
-    if (engine_off)
+    /* Restart decision; the SWR3.5 disable reaches start_stop_manual
+       through the error_disabled frame */
+    StopStartState state = { engine_off, restart_trigger, false };
+    const StopStartRestart restart = stop_start_restart(&state, data->brake != 0, data->prev_brake != 0,
+                                                        data->accel != 0, data->prev_accel != 0,
+                                                        data->batt_volt, data->batt_soc);
+
+    if (engine_off && !restart_trigger && (restart != SS_RESTART_NONE))
     {
-        const bool brake_released = (data->prev_brake && !data->brake);
-        const bool accelerator_pressed = (!data->prev_accel && data->accel);
-
-        // Enable the persistent need for restart
-        if (brake_released || accelerator_pressed)
-        {
-            restart_trigger = true;
-            printf("Able to restart\n");
-            fflush(stdout);
-        }
+        printf("Able to restart\n");
+        fflush(stdout);
+    }
+    engine_off = state.engine_off;
+    restart_trigger = state.restart_trigger;
 
-        if (restart_trigger)
-        {
-            /* Battery check */
-            if (data->batt_volt >= MIN_BATTERY_VOLTAGE &&
-                data->batt_soc >= MIN_BATTERY_SOC)
-            {
-                send_encrypted_message(sock_sender, "RESTART", CAN_ID_ECU_RESTART);
-                log_toggle_event("Stop/Start: Engine turned On");
-                engine_off = false;
-
-                // Disable the need for restart
-                restart_trigger = false;
-                printf("Engine restart done\n");
-                fflush(stdout);
-            }
-            else
-            {
-                printf("Battery error\n");
-                fflush(stdout);
-                send_encrypted_message(sock_sender, "error_battery", CAN_ID_ERROR_DASH);
-                sleep_microseconds_pw(COMMS_TIME_US);
-                send_encrypted_message(sock_sender, "error_disabled", CAN_ID_COMMAND);
-                log_toggle_event("Fault: SWR3.5 (Low Battery)");
-            }
-        }
+    if (restart == SS_RESTART_DONE)
+    {
+        send_encrypted_message(sock_sender, "RESTART", CAN_ID_ECU_RESTART);
+        log_toggle_event("Stop/Start: Engine turned On");
+        printf("Engine restart done\n");
+        fflush(stdout);
+    }
+    else if (restart == SS_RESTART_REFUSED)
+    {
+        printf("Battery error\n");
+        fflush(stdout);
+        metrics_inc(METRIC_RESTART_FAILURES);
+        send_encrypted_message(sock_sender, "error_battery", CAN_ID_ERROR_DASH);
+        // error_disabled follows once the caller has let error_battery through
+        disable_pending = true;
+    }
+    else
+    {
+        // Engine on, or still waiting for a restart request
     }
 
     /* Update previous states */
@@ -252,74 +191,260 @@ void handle_engine_restart_logic(
 }
 
 /**
- * @brief Handle the stop start logic.
- * @requirement SWR1.2
+ * @brief Send the error_disabled of a refused restart, if one is pending.
+ * @requirement SWR3.5
+ */
+bool send_pending_disable(void)
+{
+    if (!disable_pending)
+    {
+        return false;
+    }
+    disable_pending = false;
+    send_encrypted_message(sock_sender, "error_disabled", CAN_ID_COMMAND);
+    log_toggle_event("Fault: SWR3.5 (Low Battery)");
+    return true;
+}
+
+/* Telemetry columns, in the order of the row built by record_powertrain_step */
+typedef enum {
+    TLM_TIME_MS = 0,
+    TLM_SPEED,
+    TLM_IN_TEMP,
+    TLM_EX_TEMP,
+    TLM_DOOR,
+    TLM_TILT,
+    TLM_ACCEL,
+    TLM_BRAKE,
+    TLM_TEMP_SET,
+    TLM_BATT_SOC,
+    TLM_BATT_VOLT,
+    TLM_ENGI_TEMP,
+    TLM_GEAR,
+    TLM_SS_ENABLED,
+    TLM_ENGINE_OFF,
+    TLM_RESTART,
+    TLM_COND_BITS,
+    TLM_COUNT
+} TelemetryColumnId;
+
+static const TelemetryColumn telemetry_columns[TLM_COUNT] = {
+    [TLM_TIME_MS]    = { "time_ms", 1U },
+    [TLM_SPEED]      = { "speed", 10U },
+    [TLM_IN_TEMP]    = { "in_temp", 1U },
+    [TLM_EX_TEMP]    = { "ex_temp", 1U },
+    [TLM_DOOR]       = { "door", 1U },
+    [TLM_TILT]       = { "tilt", 10U },
+    [TLM_ACCEL]      = { "accel", 1U },
+    [TLM_BRAKE]      = { "brake", 1U },
+    [TLM_TEMP_SET]   = { "temp_set", 1U },
+    [TLM_BATT_SOC]   = { "batt_soc", 10U },
+    [TLM_BATT_VOLT]  = { "batt_volt", 100U },
+    [TLM_ENGI_TEMP]  = { "engi_temp", 10U },
+    [TLM_GEAR]       = { "gear", 1U },
+    [TLM_SS_ENABLED] = { "ss_enabled", 1U },
+    [TLM_ENGINE_OFF] = { "engine_off", 1U },
+    [TLM_RESTART]    = { "restart_trig", 1U },
+    [TLM_COND_BITS]  = { "cond_bits", 1U }
+};
+
+static TelemetryWriter telemetry_writer;
+static bool telemetry_enabled = false;
+
+static long long telemetry_now_ms(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return ((long long)now.tv_sec * MS_IN_ONESEC) + (now.tv_nsec / NANO_IN_ONEMS);
+}
+
+bool open_powertrain_telemetry(const char *path, bool compress)
+{
+    telemetry_enabled = telemetry_open(&telemetry_writer, path, telemetry_columns, TLM_COUNT,
+                                       compress ? TELEMETRY_CODEC_ZSTD : TELEMETRY_CODEC_NONE);
+    return telemetry_enabled;
+}
+
+/**
+ * @brief Append one step of signals and decision bits to the telemetry file.
  */
-void *function_start_stop(void *arg)
+void record_powertrain_step(const VehicleData *data, long long time_ms)
 {
-    VehicleData *ptr_rec_data = (VehicleData *)arg;
-    static int prev_brake = 0;
-    static int prev_accel = 0;
+    int64_t row[TLM_COUNT];
 
-    while (!test_mode_powertrain)
+    if (!telemetry_enabled)
     {
-        int lock_result = pthread_mutex_lock(&mutex_powertrain);
-        if (lock_result != 0)
-        {
-            return NULL;
-        }
+        return;
+    }
 
-        /* Only check Stop/Start if the driver have enabled it */
+    row[TLM_TIME_MS] = time_ms;
+    row[TLM_SPEED] = telemetry_scale(data->speed, telemetry_columns[TLM_SPEED].scale);
+    row[TLM_IN_TEMP] = data->internal_temp;
+    row[TLM_EX_TEMP] = data->external_temp;
+    row[TLM_DOOR] = data->door_open;
+    row[TLM_TILT] = telemetry_scale(data->tilt_angle, telemetry_columns[TLM_TILT].scale);
+    row[TLM_ACCEL] = data->accel;
+    row[TLM_BRAKE] = data->brake;
+    row[TLM_TEMP_SET] = data->temp_set;
+    row[TLM_BATT_SOC] = telemetry_scale(data->batt_soc, telemetry_columns[TLM_BATT_SOC].scale);
+    row[TLM_BATT_VOLT] = telemetry_scale(data->batt_volt, telemetry_columns[TLM_BATT_VOLT].scale);
+    row[TLM_ENGI_TEMP] = telemetry_scale(data->engi_temp, telemetry_columns[TLM_ENGI_TEMP].scale);
+    row[TLM_GEAR] = data->gear;
+    row[TLM_SS_ENABLED] = start_stop_manual ? 1 : 0;
+    row[TLM_ENGINE_OFF] = engine_off ? 1 : 0;
+    row[TLM_RESTART] = restart_trigger ? 1 : 0;
+    row[TLM_COND_BITS] = (int64_t)engine_condition_bits;
+
+    if (!telemetry_append(&telemetry_writer, row))
+    {
+        log_toggle_event("Telemetry: write failed, recording stopped");
+        (void)telemetry_close(&telemetry_writer);
+        telemetry_enabled = false;
+    }
+}
 
-        if (start_stop_manual)
-        {
-            /* Check the conditions to activate Stop/Start */
+void close_powertrain_telemetry(void)
+{
+    if (telemetry_enabled)
+    {
+        (void)telemetry_close(&telemetry_writer);
+        telemetry_enabled = false;
+    }
+}
 
-            check_disable_engine(ptr_rec_data);
+void publish_powertrain_live(const VehicleData *data)
+{
+    LiveSignals signals;
+
+    (void)memset(&signals, 0, sizeof(signals));
+    signals.present = LIVE_HAS_SIGNALS | LIVE_HAS_STOP_START;
+    signals.speed = data->speed;
+    signals.tilt_angle = data->tilt_angle;
+    signals.batt_soc = data->batt_soc;
+    signals.batt_volt = data->batt_volt;
+    signals.engi_temp = data->engi_temp;
+    signals.internal_temp = data->internal_temp;
+    signals.external_temp = data->external_temp;
+    signals.temp_set = data->temp_set;
+    signals.door_open = data->door_open;
+    signals.accel = data->accel;
+    signals.brake = data->brake;
+    signals.gear = data->gear;
+    signals.start_stop_active = start_stop_manual ? 1U : 0U;
+    signals.engine_off = engine_off ? 1U : 0U;
+    signals.restart_trigger = restart_trigger ? 1U : 0U;
+    signals.cond_bits = engine_condition_bits;
+    signals.present |= LIVE_HAS_SAVINGS;
+    signals.engine_off_s = powertrain_savings.engine_off_s;
+    signals.fuel_saved_ml = fuel_savings_net_ml(&powertrain_savings);
+    signals.co2_saved_g = fuel_savings_co2_g(&powertrain_savings);
+    live_state_publish(&powertrain_live, &signals);
+}
 
-            /* printf("Start/Stop = %d\n", engine_off);
-            fflush(stdout); */
+/**
+ * @brief Account the idle fuel saved while the engine is off, once per
+ * Stop/Start step, and the restart penalty when it starts again.
+ */
+void update_powertrain_savings(const VehicleData *data, long long time_ms)
+{
+    fuel_savings_update(&powertrain_savings, time_ms, engine_off, data->engi_temp,
+                        fuel_ac_load((double)data->external_temp, (double)data->temp_set));
+}
 
-            handle_engine_restart_logic(
-                ptr_rec_data);
-        }
+bool save_powertrain_checkpoint(void)
+{
+    PowertrainCheckpointState state;
+    struct iovec part;
+
+    (void)memset(&state, 0, sizeof(state));
+    state.rec_data = rec_data;
+    state.engine_off = engine_off ? 1U : 0U;
+    state.restart_trigger = restart_trigger ? 1U : 0U;
+    state.start_stop_manual = start_stop_manual ? 1U : 0U;
+    state.condition_bits = engine_condition_bits;
+    state.reported_bits = reported_failure_bits;
+    state.savings = powertrain_savings;
+    ecu_stats_get(&state.stats);
+
+    part.iov_base = &state;
+    part.iov_len = sizeof(state);
+    return checkpoint_write(&powertrain_checkpoint, POWERTRAIN_CHECKPOINT_VERSION, &part, 1);
+}
 
-        int unlock_result = pthread_mutex_unlock(&mutex_powertrain);
-        if (unlock_result != 0)
-        {
-            return NULL;
-        }
+bool restore_powertrain_checkpoint(void)
+{
+    CheckpointSnapshot snapshot;
+    PowertrainCheckpointState state;
 
-        sleep_microseconds_pw(SLEEP_TIME_US);
+    if (!checkpoint_open(&powertrain_checkpoint, &snapshot, POWERTRAIN_CHECKPOINT_VERSION))
+    {
+        return false;
+    }
+    const bool restored = snapshot.state_size == sizeof(state);
+    if (restored)
+    {
+        (void)memcpy(&state, snapshot.state, sizeof(state));
+        rec_data = state.rec_data;
+        engine_off = state.engine_off != 0U;
+        restart_trigger = state.restart_trigger != 0U;
+        start_stop_manual = state.start_stop_manual != 0U;
+        engine_condition_bits = state.condition_bits;
+        reported_failure_bits = state.reported_bits & get_stop_start_rules()->all_bits;
+        powertrain_savings = state.savings;
+        // The time between the two runs is not integrated
+        powertrain_savings.last_ms = -1;
+        ecu_stats_restore(&state.stats);
     }
-    return NULL;
+    checkpoint_close(&snapshot);
+    return restored;
 }
 
-void *powertrain_comms(void *arg)
+void init_powertrain_jitter(void)
 {
+    rt_jitter_init(&powertrain_jitter, "powertrain");
+    start_stop_loop = rt_jitter_add(&powertrain_jitter, "start_stop", SLEEP_TIME_US);
+}
 
-    (void)printf("Listening for CAN frames...\n");
-    (void)fflush(stdout);
+/**
+ * @brief One period of the Stop/Start logic on the received data.
+ * @requirement SWR1.2
+ */
+void start_stop_step(VehicleData *data)
+{
+    /* Only check Stop/Start if the driver have enabled it */
 
-    while (!test_mode_powertrain)
+    if (start_stop_manual)
     {
-        int lock_result = pthread_mutex_lock(&mutex_powertrain);
-        if (lock_result != 0)
-        {
-            return NULL;
-        }
+        /* Check the conditions to activate Stop/Start */
 
-        /* CAN Communication logic */
+        check_disable_engine(data);
 
-        process_received_frame_powertrain(sock_receiver);
+        /* printf("Start/Stop = %d\n", engine_off);
+        fflush(stdout); */
 
-        int unlock_result = pthread_mutex_unlock(&mutex_powertrain);
-        if (unlock_result != 0)
-        {
-            return NULL;
-        }
+        handle_engine_restart_logic(
+            data);
+    }
+}
 
-        sleep_microseconds_pw(COMMS_TIME_US);
+/**
+ * @brief One Stop/Start period with its telemetry row, savings, metrics and
+ * live state.
+ * @requirement SWR1.2
+ */
+void run_start_stop_period(VehicleData *data)
+{
+    rt_loop_tick(&powertrain_jitter, start_stop_loop, rt_now_ns());
+    start_stop_step(data);
+
+    record_powertrain_step(data, telemetry_now_ms());
+    update_powertrain_savings(data, rt_now_ns() / NANO_IN_ONEMS);
+    const long long now_ms = timer_wheel_now_ms();
+    metrics_flush(now_ms);
+    rt_jitter_flush(&powertrain_jitter, now_ms);
+    publish_powertrain_live(data);
+    if (checkpoint_due(&powertrain_checkpoint, now_ms))
+    {
+        (void)save_powertrain_checkpoint();
     }
-    return NULL;
 }
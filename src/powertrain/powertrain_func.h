@@ -17,19 +17,94 @@
 
 #include "can_comms.h"
 #include "globals.h"
+#include "../common_includes/telemetry.h"
+#include "../common_includes/rt_sched.h"
+#include "../common_includes/live_state.h"
+#include "../common_includes/fuel_savings.h"
+#include "../common_includes/checkpoint.h"
+#include "stop_start_rules.h"
+
+/* Engine-off conditions of the built-in rules, bit set when satisfied */
+#define COND_BIT_MOVEMENT       (1U << 0U)
+#define COND_BIT_TEMPERATURE    (1U << 1U)
+#define COND_BIT_ENGINE_TEMP    (1U << 2U)
+#define COND_BIT_BATTERY        (1U << 3U)
+#define COND_BIT_DOOR           (1U << 4U)
+#define COND_BIT_TILT           (1U << 5U)
+#define COND_BITS_ALL           (COND_BIT_MOVEMENT | COND_BIT_TEMPERATURE | COND_BIT_ENGINE_TEMP | \
+                                 COND_BIT_BATTERY | COND_BIT_DOOR | COND_BIT_TILT)
+
+#define POWERTRAIN_CHECKPOINT_VERSION   (3U)
+
 
 extern bool restart_trigger;
+extern unsigned int engine_condition_bits;
 
-extern pthread_mutex_t mutex_powertrain;
 extern int sock_sender;
 extern int sock_receiver;
 extern bool engine_off;
+// A refused restart sent error_battery; error_disabled is still to go out
+extern bool disable_pending;
+
+// Period jitter of the Stop/Start loop (not tracked until initialized)
+extern RtJitterReport powertrain_jitter;
+
+// Live state segment for external monitors (not published until created)
+extern LiveState powertrain_live;
+
+// Fuel and CO2 saved by Stop/Start since start-up
+extern FuelSavings powertrain_savings;
+
+// Checkpointed Stop/Start state, savings and receive counters
+typedef struct {
+    VehicleData rec_data;
+    uint8_t engine_off;
+    uint8_t restart_trigger;
+    uint8_t start_stop_manual;
+    uint8_t reserved;
+    uint32_t condition_bits;
+    uint32_t reported_bits;     // Failures already reported, not reported again
+    uint32_t reserved2;
+    FuelSavings savings;
+    EcuStats stats;
+} PowertrainCheckpointState;
+
+// Periodic snapshots from the Stop/Start period (disabled until checkpoint_init)
+extern Checkpoint powertrain_checkpoint;
 
 void check_disable_engine(VehicleData *ptr_rec_data);
+unsigned int evaluate_engine_conditions(const VehicleData *data);
+// Load the inhibit rules from a file (NULL: built-in calibration)
+bool load_stop_start_rules(const char *path);
+const RuleSet *get_stop_start_rules(void);
+// Forget reported failures, so the next evaluation reports them again
+void reset_engine_condition_reports(void);
 void handle_engine_restart_logic(
     VehicleData *data);
-void *function_start_stop(void *arg);
-void *powertrain_comms(void *arg);
-void sleep_microseconds_pw(long int msec);
+/* Send the error_disabled left pending by a refused restart; false if none.
+   The caller lets some time pass after error_battery first. */
+bool send_pending_disable(void);
+// One Stop/Start period: conditions and restart logic when the system is enabled
+void start_stop_step(VehicleData *data);
+// The whole Stop/Start period: step, telemetry, savings, metrics, live state
+void run_start_stop_period(VehicleData *data);
+
+// Per-step telemetry of the received signals and the Stop/Start decision
+bool open_powertrain_telemetry(const char *path, bool compress);
+void record_powertrain_step(const VehicleData *data, long long time_ms);
+void close_powertrain_telemetry(void);
+
+// Publish the received signals and the Stop/Start state
+void publish_powertrain_live(const VehicleData *data);
+
+// Integrate the savings up to time_ms with the current engine state
+void update_powertrain_savings(const VehicleData *data, long long time_ms);
+
+// Snapshot the state now, or take over the one saved by a previous run
+bool save_powertrain_checkpoint(void);
+bool restore_powertrain_checkpoint(void);
+
+// Start the jitter report of the periodic loops
+void init_powertrain_jitter(void);
 
 #endif // POWERTRAIN_H
\ No newline at end of file
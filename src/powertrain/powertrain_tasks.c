@@ -0,0 +1,76 @@
+#include "powertrain_tasks.h"
+
+/**
+ * @brief Reception coroutine: woken by the socket, so frames are handled as
+ * they arrive.
+ */
+static void comms_task(Coro *co)
+{
+    PowertrainTasks *tasks = (PowertrainTasks *)co->arg;
+    struct can_frame frame;
+    int status = SOCKET_NO_FRAME;
+
+    CORO_BEGIN(co);
+    (void)printf("Listening for CAN frames...\n");
+    (void)fflush(stdout);
+    while (!test_mode_powertrain)
+    {
+        CORO_WAIT_READABLE(co, sock_receiver, CORO_NO_TIMEOUT);
+
+        // A batch at most, so a flood of frames cannot hold Stop/Start back
+        for (unsigned int i = 0U; i < PT_TASK_RX_BATCH; i++)
+        {
+            status = receive_can_frame_nowait(sock_receiver, &frame);
+            if (status != 0)
+            {
+                break;
+            }
+            tasks->frames++;
+            (void)powertrain_receive_frame(&frame);
+        }
+        publish_powertrain_live(&rec_data);
+
+        if (status == SOCKET_ERROR)
+        {
+            (void)fprintf(stderr, "Powertrain receive socket closed, reception stopped\n");
+            CORO_EXIT(co);
+        }
+    }
+    CORO_END(co);
+}
+
+/**
+ * @brief Stop/Start coroutine.
+ * @requirement SWR1.2
+ * @requirement SWR3.5
+ */
+static void start_stop_task(Coro *co)
+{
+    PowertrainTasks *tasks = (PowertrainTasks *)co->arg;
+
+    CORO_BEGIN(co);
+    tasks->next_period_ms = co->sched->now_ms;
+    while (!test_mode_powertrain)
+    {
+        run_start_stop_period(&rec_data);
+        tasks->periods++;
+        if (disable_pending)
+        {
+            // The dashboard gets error_battery before the system is disabled
+            CORO_SLEEP(co, PT_TASK_DISABLE_GAP_MS);
+            (void)send_pending_disable();
+        }
+
+        // Absolute deadlines: a late period does not push the next ones back
+        tasks->next_period_ms += PT_TASK_PERIOD_MS;
+        CORO_SLEEP_UNTIL(co, tasks->next_period_ms);
+    }
+    CORO_END(co);
+}
+
+bool powertrain_tasks_spawn(CoroScheduler *sched, PowertrainTasks *tasks)
+{
+    (void)memset(tasks, 0, sizeof(*tasks));
+    return coro_spawn(sched, &tasks->comms, "comms", comms_task, tasks) &&
+           coro_spawn(sched, &tasks->start_stop, "start_stop", start_stop_task, tasks);
+}
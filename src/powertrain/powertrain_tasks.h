@@ -0,0 +1,35 @@
+#ifndef POWERTRAIN_TASKS_H
+#define POWERTRAIN_TASKS_H
+
+#include "powertrain_func.h"
+#include "../common_includes/coro.h"
+
+/*
+ * The powertrain loops as coroutines on the main thread (coro.h):
+ *
+ *   comms       waits for sock_receiver to be readable, then takes the frames
+ *               pending, up to a batch, through powertrain_receive_frame
+ *   start_stop  run_start_stop_period on absolute deadlines, one period apart.
+ *               After a refused restart it sleeps PT_TASK_DISABLE_GAP_MS
+ *               between error_battery and error_disabled, so reception keeps
+ *               running meanwhile.
+ *
+ * Only one of them runs at a time, so the state they share needs no mutex.
+ * The scheduler must run in real time (reception waits on the socket).
+ */
+#define PT_TASK_PERIOD_MS       (1000LL)    // Stop/Start period (SLEEP_TIME_US)
+#define PT_TASK_DISABLE_GAP_MS  (50LL)      // From error_battery to error_disabled
+#define PT_TASK_RX_BATCH        (32U)       // Frames taken before reception waits again
+
+typedef struct {
+    Coro comms;
+    Coro start_stop;
+    long long next_period_ms;   // Deadline of the next Stop/Start period
+    unsigned long periods;
+    unsigned long frames;
+} PowertrainTasks;
+
+// Spawn reception, then Stop/Start; both start on the scheduler's next pass
+bool powertrain_tasks_spawn(CoroScheduler *sched, PowertrainTasks *tasks);
+
+#endif // POWERTRAIN_TASKS_H
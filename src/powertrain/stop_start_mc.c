@@ -0,0 +1,235 @@
+#include "stop_start_mc.h"
+#include "../common_includes/drive_cycle.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PERCENT         (100U)
+
+_Static_assert(TRACE_SIGNAL_COUNT == RULES_NUM_SIGNALS, "trace and rule signals differ");
+
+typedef struct {
+    const McConfig *config;
+    const unsigned int *clean_satisfied;
+    McReplica *results;
+    unsigned int next;          // Next replica to run, shared by the workers
+    bool failed;
+} McShared;
+
+/**
+ * @brief Engine-off decision and restart logic of the powertrain, through
+ * the same stop_start_engine_off / stop_start_restart steps, over a whole
+ * trace. A refused restart disables Stop/Start (SWR3.5), which ends the
+ * replay as it ends the drive cycle of the ECUs.
+ * @requirement SWR2.2
+ * @requirement SWR3.5
+ */
+void mc_replay(const RuleSet *rules, const SignalTrace *trace, const unsigned int *satisfied,
+               McReplica *result)
+{
+    const double *brake = trace->values[TRACE_BRAKE];
+    const double *accel = trace->values[TRACE_ACCEL];
+    const double *volt = trace->values[TRACE_BATT_VOLT];
+    const double *soc = trace->values[TRACE_BATT_SOC];
+    StopStartState state = { false, false, false };
+    bool prev_brake = false;
+    bool prev_accel = false;
+
+    (void)memset(result, 0, sizeof(*result));
+    for (size_t s = 0U; (s < trace->steps) && !state.disabled; s++)
+    {
+        const bool brake_on = (brake[s] != 0.0);
+        const bool accel_on = (accel[s] != 0.0);
+
+        if (stop_start_engine_off(&state, rules->all_bits & ~satisfied[s]))
+        {
+            result->engine_offs++;
+        }
+
+        const StopStartRestart restart = stop_start_restart(&state, brake_on, prev_brake, accel_on,
+                                                            prev_accel, volt[s], soc[s]);
+        if (restart == SS_RESTART_DONE)
+        {
+            result->restarts++;
+        }
+        else if (restart == SS_RESTART_REFUSED)
+        {
+            result->restart_failures++;
+        }
+        else
+        {
+            // No restart decision on this step
+        }
+        result->engine_off_steps += state.engine_off ? 1U : 0U;
+        prev_brake = brake_on;
+        prev_accel = accel_on;
+    }
+}
+
+void mc_run_replica(const McConfig *config, uint32_t replica, const unsigned int *clean_satisfied,
+                    SignalTrace *noisy, unsigned int *satisfied, McReplica *result)
+{
+    const unsigned int all_bits = config->rules->all_bits;
+    const size_t steps = config->clean->steps;
+
+    sensor_noise_apply(config->clean, config->noise, drive_cycle_key(config->seed, replica), noisy);
+    rule_set_evaluate_trace(config->rules, (const double *const *)noisy->values, steps, satisfied);
+    mc_replay(config->rules, noisy, satisfied, result);
+
+    for (size_t s = 0U; s < steps; s++)
+    {
+        const bool clean_ok = (clean_satisfied[s] == all_bits);
+        const bool noisy_ok = (satisfied[s] == all_bits);
+
+        if (clean_ok && !noisy_ok)
+        {
+            const unsigned int failed = all_bits & ~satisfied[s];
+            result->spurious_inhibits++;
+            for (size_t c = 0U; c < config->rules->num_conditions; c++)
+            {
+                result->blame[c] += (failed >> c) & 1U;
+            }
+        }
+        else if (!clean_ok && noisy_ok)
+        {
+            result->spurious_allows++;
+        }
+        else
+        {
+            // Same decision with and without noise
+        }
+    }
+}
+
+static void *mc_worker(void *arg)
+{
+    McShared *shared = (McShared *)arg;
+    const McConfig *config = shared->config;
+    SignalTrace noisy;
+    unsigned int *satisfied = NULL;
+
+    if (!signal_trace_alloc(&noisy, config->clean->steps))
+    {
+        __atomic_store_n(&shared->failed, true, __ATOMIC_RELAXED);
+        return NULL;
+    }
+    satisfied = (unsigned int *)malloc(config->clean->steps * sizeof(unsigned int));
+    if (satisfied == NULL)
+    {
+        signal_trace_free(&noisy);
+        __atomic_store_n(&shared->failed, true, __ATOMIC_RELAXED);
+        return NULL;
+    }
+
+    for (;;)
+    {
+        const unsigned int replica = __atomic_fetch_add(&shared->next, 1U, __ATOMIC_RELAXED);
+        if ((replica >= config->replicas) || __atomic_load_n(&shared->failed, __ATOMIC_RELAXED))
+        {
+            break;
+        }
+        mc_run_replica(config, replica, shared->clean_satisfied, &noisy, satisfied,
+                       &shared->results[replica]);
+    }
+
+    free(satisfied);
+    signal_trace_free(&noisy);
+    return NULL;
+}
+
+/**
+ * @brief Run every replica of a Monte Carlo study, spread over worker threads
+ * that take the next replica number until none is left.
+ * @requirement SWR2.2
+ */
+bool mc_run(const McConfig *config, McReplica *results)
+{
+    McShared shared;
+    pthread_t threads[MC_MAX_THREADS];
+    unsigned int started = 0U;
+    unsigned int *clean_satisfied = NULL;
+
+    if ((config->replicas == 0U) || (config->replicas > MC_MAX_REPLICAS) ||
+        (config->threads == 0U) || (config->threads > MC_MAX_THREADS) || (config->clean->steps == 0U))
+    {
+        return false;
+    }
+    clean_satisfied = (unsigned int *)malloc(config->clean->steps * sizeof(unsigned int));
+    if (clean_satisfied == NULL)
+    {
+        return false;
+    }
+    rule_set_evaluate_trace(config->rules, (const double *const *)config->clean->values,
+                            config->clean->steps, clean_satisfied);
+
+    shared.config = config;
+    shared.clean_satisfied = clean_satisfied;
+    shared.results = results;
+    shared.next = 0U;
+    shared.failed = false;
+
+    const unsigned int count = (config->threads < config->replicas) ? config->threads : config->replicas;
+    for (unsigned int i = 0U; i < count; i++)
+    {
+        if (pthread_create(&threads[i], NULL, mc_worker, &shared) != 0)
+        {
+            __atomic_store_n(&shared.failed, true, __ATOMIC_RELAXED);
+            break;
+        }
+        started++;
+    }
+    for (unsigned int i = 0U; i < started; i++)
+    {
+        (void)pthread_join(threads[i], NULL);
+    }
+
+    free(clean_satisfied);
+    return (started == count) && !shared.failed;
+}
+
+static int compare_counts(const void *a, const void *b)
+{
+    const unsigned long x = *(const unsigned long *)a;
+    const unsigned long y = *(const unsigned long *)b;
+    return (x > y) - (x < y);
+}
+
+bool mc_distribution(const McReplica *results, size_t count, size_t field, McDistribution *dist)
+{
+    unsigned long *values = NULL;
+    double sum = 0.0;
+    double squares = 0.0;
+
+    (void)memset(dist, 0, sizeof(*dist));
+    if ((count == 0U) || ((field + sizeof(unsigned long)) > sizeof(McReplica)))
+    {
+        return false;
+    }
+    values = (unsigned long *)malloc(count * sizeof(unsigned long));
+    if (values == NULL)
+    {
+        return false;
+    }
+    for (size_t i = 0U; i < count; i++)
+    {
+        (void)memcpy(&values[i], (const unsigned char *)&results[i] + field, sizeof(unsigned long));
+        sum += (double)values[i];
+    }
+    dist->mean = sum / (double)count;
+    for (size_t i = 0U; i < count; i++)
+    {
+        const double delta = (double)values[i] - dist->mean;
+        squares += delta * delta;
+    }
+    dist->stddev = (count > 1U) ? sqrt(squares / (double)(count - 1U)) : 0.0;
+
+    qsort(values, count, sizeof(unsigned long), compare_counts);
+    dist->min = values[0];
+    dist->p5 = values[((count - 1U) * 5U) / PERCENT];
+    dist->p50 = values[((count - 1U) * 50U) / PERCENT];
+    dist->p95 = values[((count - 1U) * 95U) / PERCENT];
+    dist->max = values[count - 1U];
+    free(values);
+    return true;
+}
@@ -0,0 +1,75 @@
+#ifndef STOP_START_MC_H
+#define STOP_START_MC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "stop_start_rules.h"
+#include "../common_includes/sensor_noise.h"
+
+/*
+ * Monte Carlo robustness of the Stop/Start decision to sensor noise.
+ *
+ * The clean trace of a drive cycle is evaluated once. Each replica then
+ * perturbs it with the noise models (sensor_noise.h), evaluates the inhibit
+ * rules over the whole noisy trace and replays the engine state machine
+ * (stop_start_engine_off / stop_start_restart) on it, up to the end of the
+ * trace or the first refused restart, which disables Stop/Start. Replicas share
+ * nothing but read-only inputs, so they are spread over worker threads and
+ * their results do not depend on the thread count.
+ *
+ * A spurious inhibit is a step the clean trace allows an engine-off on but
+ * the noisy one does not; the conditions that failed on it are counted per
+ * condition bit. A spurious allow is the opposite.
+ */
+#define MC_MAX_THREADS          (256U)
+#define MC_MAX_REPLICAS         (10000000U)
+
+typedef struct {
+    unsigned long engine_offs;          // Engine-off decisions
+    unsigned long restarts;
+    unsigned long restart_failures;     // Restart refused by the battery check (0 or 1)
+    unsigned long engine_off_steps;     // Steps spent with the engine off
+    unsigned long spurious_inhibits;
+    unsigned long spurious_allows;
+    unsigned long blame[RULES_MAX_CONDITIONS];  // Failed conditions on spurious inhibits
+} McReplica;
+
+typedef struct {
+    const RuleSet *rules;
+    const SignalTrace *clean;
+    const NoiseConfig *noise;
+    uint64_t seed;              // Replica r draws with drive_cycle_key(seed, r)
+    unsigned int replicas;
+    unsigned int threads;
+} McConfig;
+
+// Summary of one McReplica counter over all replicas
+typedef struct {
+    double mean;
+    double stddev;
+    unsigned long min;
+    unsigned long p5;
+    unsigned long p50;
+    unsigned long p95;
+    unsigned long max;
+} McDistribution;
+
+/* Engine state machine over a trace with its satisfied masks (no noise
+   comparison: spurious counts and blame are left at 0) */
+void mc_replay(const RuleSet *rules, const SignalTrace *trace, const unsigned int *satisfied,
+               McReplica *result);
+
+// Run one replica; noisy and satisfied/clean_satisfied hold trace->steps entries
+void mc_run_replica(const McConfig *config, uint32_t replica, const unsigned int *clean_satisfied,
+                    SignalTrace *noisy, unsigned int *satisfied, McReplica *result);
+
+// Run config->replicas replicas into results[], on config->threads threads
+bool mc_run(const McConfig *config, McReplica *results);
+
+/* Distribution of the counter at byte offset `field` of McReplica, e.g.
+   offsetof(McReplica, engine_offs) */
+bool mc_distribution(const McReplica *results, size_t count, size_t field, McDistribution *dist);
+
+#endif // STOP_START_MC_H
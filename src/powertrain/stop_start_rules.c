@@ -0,0 +1,470 @@
+#include "stop_start_rules.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RULES_LINE_SIZE     (256)
+
+typedef enum {
+    SIGNAL_DOUBLE = 0,
+    SIGNAL_INT
+} SignalType;
+
+typedef struct {
+    const char *name;
+    size_t offset;
+    SignalType type;
+} SignalInfo;
+
+static const SignalInfo signals[] = {
+    { "speed",         offsetof(VehicleData, speed),         SIGNAL_DOUBLE },
+    { "internal_temp", offsetof(VehicleData, internal_temp), SIGNAL_INT },
+    { "external_temp", offsetof(VehicleData, external_temp), SIGNAL_INT },
+    { "door_open",     offsetof(VehicleData, door_open),     SIGNAL_INT },
+    { "tilt_angle",    offsetof(VehicleData, tilt_angle),    SIGNAL_DOUBLE },
+    { "accel",         offsetof(VehicleData, accel),         SIGNAL_INT },
+    { "brake",         offsetof(VehicleData, brake),         SIGNAL_INT },
+    { "temp_set",      offsetof(VehicleData, temp_set),      SIGNAL_INT },
+    { "batt_soc",      offsetof(VehicleData, batt_soc),      SIGNAL_DOUBLE },
+    { "batt_volt",     offsetof(VehicleData, batt_volt),     SIGNAL_DOUBLE },
+    { "engi_temp",     offsetof(VehicleData, engi_temp),     SIGNAL_DOUBLE },
+    { "gear",          offsetof(VehicleData, gear),          SIGNAL_INT }
+};
+
+#define NUM_SIGNALS (sizeof(signals) / sizeof(signals[0]))
+
+_Static_assert(NUM_SIGNALS == RULES_NUM_SIGNALS, "RULES_NUM_SIGNALS out of date");
+
+static const char *const op_names[] = {
+    [RULE_OP_LT] = "<",
+    [RULE_OP_LE] = "<=",
+    [RULE_OP_GT] = ">",
+    [RULE_OP_GE] = ">=",
+    [RULE_OP_EQ] = "==",
+    [RULE_OP_NE] = "!="
+};
+
+#define NUM_OPS (sizeof(op_names) / sizeof(op_names[0]))
+
+/* Built-in calibration, same syntax as a rule file */
+static const char *const default_rules[] = {
+    "rule movement speed == 0",
+    "rule movement accel == 0",
+    "rule movement brake != 0",
+    "rule movement gear == 0",
+    "message movement error_brake_not_pressed Stop/Start: SWR2.8 (Brake not pressed or car is moving!)",
+    "rule temperature internal_temp <= temp_set+5",
+    "rule temperature external_temp >= temp_set",
+    "message temperature error_temperature_out_range Stop/Start: SWR2.8 (Difference between internal and external temps out of range!)",
+    "rule engine_temp engi_temp >= 20",
+    "rule engine_temp engi_temp <= 105",
+    "message engine_temp error_engine_temperature_out_range Stop/Start: SWR2.8 (Engine temperature out of range!)",
+    "rule battery batt_soc >= 70",
+    "rule battery batt_volt > 10",
+    "message battery error_battery_out_range Stop/Start: SWR2.8 (Battery is not in operating range!)",
+    "rule door door_open == 0",
+    "message door error_door_open Stop/Start: SWR2.8 (One or more doors are opened!)",
+    "rule tilt tilt_angle <= 5",
+    "message tilt error_tilt_angle Stop/Start: SWR2.8 (Tilt angle greater than 5 degrees!)"
+};
+
+#define NUM_DEFAULT_RULES (sizeof(default_rules) / sizeof(default_rules[0]))
+
+static int find_signal(const char *name, size_t len)
+{
+    for (size_t i = 0U; i < NUM_SIGNALS; i++)
+    {
+        if ((strlen(signals[i].name) == len) && (strncmp(signals[i].name, name, len) == 0))
+        {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+static int find_op(const char *name)
+{
+    for (size_t i = 0U; i < NUM_OPS; i++)
+    {
+        if (strcmp(op_names[i], name) == 0)
+        {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+static int find_or_add_condition(RuleSet *set, const char *name)
+{
+    for (size_t i = 0U; i < set->num_conditions; i++)
+    {
+        if (strcmp(set->conditions[i].name, name) == 0)
+        {
+            return (int)i;
+        }
+    }
+    if ((set->num_conditions >= RULES_MAX_CONDITIONS) || (strlen(name) >= RULES_NAME_SIZE))
+    {
+        return -1;
+    }
+
+    RuleCondition *cond = &set->conditions[set->num_conditions];
+    (void)memset(cond, 0, sizeof(*cond));
+    (void)snprintf(cond->name, sizeof(cond->name), "%s", name);
+    // Conditions without a message directive still report something useful
+    (void)snprintf(cond->can_error, sizeof(cond->can_error), "error_%s", name);
+    (void)snprintf(cond->system_log, sizeof(cond->system_log),
+                   "Stop/Start: SWR2.8 (Condition %s not met!)", name);
+    set->all_bits |= (1U << set->num_conditions);
+    return (int)set->num_conditions++;
+}
+
+/* operand: number | signal | signal+number | signal-number */
+static bool parse_operand(const char *text, CompiledRule *rule)
+{
+    char *end = NULL;
+
+    rule->rhs = RULES_NO_SIGNAL;
+    rule->threshold = strtod(text, &end);
+    if ((end != text) && (*end == '\0'))
+    {
+        return true;
+    }
+
+    const size_t name_len = strcspn(text, "+-");
+    const int index = find_signal(text, name_len);
+    if (index < 0)
+    {
+        return false;
+    }
+    rule->rhs = (unsigned short)index;
+    rule->threshold = 0.0;
+    if (text[name_len] == '\0')
+    {
+        return true;
+    }
+
+    rule->threshold = strtod(&text[name_len], &end);
+    return (end != &text[name_len]) && (*end == '\0');
+}
+
+static bool parse_rule(RuleSet *set, char **save, const char **error)
+{
+    const char *cond_name = strtok_r(NULL, " \t", save);
+    const char *signal = strtok_r(NULL, " \t", save);
+    const char *op = strtok_r(NULL, " \t", save);
+    const char *operand = strtok_r(NULL, " \t", save);
+    CompiledRule rule;
+
+    (void)memset(&rule, 0, sizeof(rule));
+    if ((operand == NULL) || (strtok_r(NULL, " \t", save) != NULL))
+    {
+        *error = "expected: rule <condition> <signal> <op> <operand>";
+        return false;
+    }
+    if (set->num_rules >= RULES_MAX_RULES)
+    {
+        *error = "too many rules";
+        return false;
+    }
+
+    const int lhs = find_signal(signal, strlen(signal));
+    const int op_index = find_op(op);
+    if (lhs < 0)
+    {
+        *error = "unknown signal";
+        return false;
+    }
+    if (op_index < 0)
+    {
+        *error = "unknown comparator";
+        return false;
+    }
+    if (!parse_operand(operand, &rule))
+    {
+        *error = "bad operand";
+        return false;
+    }
+    const int cond = find_or_add_condition(set, cond_name);
+    if (cond < 0)
+    {
+        *error = "too many conditions or name too long";
+        return false;
+    }
+
+    rule.bit = 1U << (unsigned int)cond;
+    rule.lhs = (unsigned short)lhs;
+    rule.op = (RuleOp)op_index;
+    set->rules[set->num_rules++] = rule;
+    return true;
+}
+
+static bool parse_message(RuleSet *set, char **save, const char **error)
+{
+    const char *cond_name = strtok_r(NULL, " \t", save);
+    const char *can_error = strtok_r(NULL, " \t", save);
+    const char *log_text = strtok_r(NULL, "", save);
+
+    if ((log_text == NULL) || (strlen(can_error) >= RULES_CAN_ERROR_SIZE))
+    {
+        *error = "expected: message <condition> <can_error> <log text>";
+        return false;
+    }
+    const int cond = find_or_add_condition(set, cond_name);
+    if (cond < 0)
+    {
+        *error = "too many conditions or name too long";
+        return false;
+    }
+
+    (void)snprintf(set->conditions[cond].can_error, RULES_CAN_ERROR_SIZE, "%s", can_error);
+    (void)snprintf(set->conditions[cond].system_log, RULES_LOG_SIZE, "%s",
+                   log_text + strspn(log_text, " \t"));
+    return true;
+}
+
+bool rule_set_parse_line(RuleSet *set, const char *line, const char **error)
+{
+    char buffer[RULES_LINE_SIZE];
+    char *save = NULL;
+
+    (void)snprintf(buffer, sizeof(buffer), "%s", line);
+    buffer[strcspn(buffer, "#\r\n")] = '\0';
+
+    const char *directive = strtok_r(buffer, " \t", &save);
+    if (directive == NULL)
+    {
+        return true;    // Blank or comment line
+    }
+    if (strcmp(directive, "rule") == 0)
+    {
+        return parse_rule(set, &save, error);
+    }
+    if (strcmp(directive, "message") == 0)
+    {
+        return parse_message(set, &save, error);
+    }
+    *error = "unknown directive";
+    return false;
+}
+
+bool rule_set_load_default(RuleSet *set)
+{
+    const char *error = NULL;
+
+    (void)memset(set, 0, sizeof(*set));
+    for (size_t i = 0U; i < NUM_DEFAULT_RULES; i++)
+    {
+        if (!rule_set_parse_line(set, default_rules[i], &error))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool rule_set_load_file(RuleSet *set, const char *path)
+{
+    char line[RULES_LINE_SIZE];
+    const char *error = NULL;
+    int line_number = 0;
+    bool ok = true;
+
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        perror(path);
+        return false;
+    }
+
+    (void)memset(set, 0, sizeof(*set));
+    while (ok && (fgets(line, sizeof(line), file) != NULL))
+    {
+        line_number++;
+        ok = rule_set_parse_line(set, line, &error);
+    }
+    (void)fclose(file);
+
+    if (!ok)
+    {
+        (void)fprintf(stderr, "%s:%d: %s\n", path, line_number, error);
+    }
+    else if (set->num_rules == 0U)
+    {
+        (void)fprintf(stderr, "%s: no rules\n", path);
+        ok = false;
+    }
+    return ok;
+}
+
+static double signal_value(const VehicleData *data, unsigned short index)
+{
+    const unsigned char *base = (const unsigned char *)data + signals[index].offset;
+
+    if (signals[index].type == SIGNAL_DOUBLE)
+    {
+        return *(const double *)(const void *)base;
+    }
+    return (double)*(const int *)(const void *)base;
+}
+
+/**
+ * @brief Evaluate a compiled rule set against one step of vehicle data.
+ * @requirement SWR2.2
+ * @requirement SWR2.3
+ * @requirement SWR2.4
+ */
+unsigned int rule_set_evaluate(const RuleSet *set, const VehicleData *data)
+{
+    unsigned int failed = 0U;
+
+    for (size_t i = 0U; i < set->num_rules; i++)
+    {
+        const CompiledRule *rule = &set->rules[i];
+        const double lhs = signal_value(data, rule->lhs);
+        const double rhs = rule->threshold +
+                           ((rule->rhs != RULES_NO_SIGNAL) ? signal_value(data, rule->rhs) : 0.0);
+        bool pass = false;
+
+        switch (rule->op)
+        {
+        case RULE_OP_LT: pass = (lhs < rhs); break;
+        case RULE_OP_LE: pass = (lhs <= rhs); break;
+        case RULE_OP_GT: pass = (lhs > rhs); break;
+        case RULE_OP_GE: pass = (lhs >= rhs); break;
+        case RULE_OP_EQ: pass = (lhs == rhs); break;
+        case RULE_OP_NE: pass = (lhs != rhs); break;
+        default: pass = false; break;
+        }
+        failed |= pass ? 0U : rule->bit;
+    }
+    return set->all_bits & ~failed;
+}
+
+const char *rule_set_signal_name(size_t index)
+{
+    return (index < NUM_SIGNALS) ? signals[index].name : NULL;
+}
+
+/* One comparison over every step; the operator is resolved once per rule so
+   the loop body is a compare and an OR, with no branch and no dependency
+   between steps */
+#define FAIL_STEPS(cmp, rhs_expr)                                       \
+    for (size_t s = 0U; s < steps; s++)                                 \
+    {                                                                   \
+        failed[s] |= (lhs[s] cmp (rhs_expr)) ? 0U : bit;                \
+    }
+
+static void fail_steps(const CompiledRule *rule, const double *const *signals, size_t steps,
+                       unsigned int *failed)
+{
+    const double *lhs = signals[rule->lhs];
+    const double threshold = rule->threshold;
+    const unsigned int bit = rule->bit;
+
+    if (rule->rhs == RULES_NO_SIGNAL)
+    {
+        switch (rule->op)
+        {
+        case RULE_OP_LT: FAIL_STEPS(<, threshold) break;
+        case RULE_OP_LE: FAIL_STEPS(<=, threshold) break;
+        case RULE_OP_GT: FAIL_STEPS(>, threshold) break;
+        case RULE_OP_GE: FAIL_STEPS(>=, threshold) break;
+        case RULE_OP_EQ: FAIL_STEPS(==, threshold) break;
+        case RULE_OP_NE: FAIL_STEPS(!=, threshold) break;
+        default: FAIL_STEPS(!=, lhs[s]) break;      // Never passes, as above
+        }
+        return;
+    }
+
+    const double *rhs = signals[rule->rhs];
+    switch (rule->op)
+    {
+    case RULE_OP_LT: FAIL_STEPS(<, threshold + rhs[s]) break;
+    case RULE_OP_LE: FAIL_STEPS(<=, threshold + rhs[s]) break;
+    case RULE_OP_GT: FAIL_STEPS(>, threshold + rhs[s]) break;
+    case RULE_OP_GE: FAIL_STEPS(>=, threshold + rhs[s]) break;
+    case RULE_OP_EQ: FAIL_STEPS(==, threshold + rhs[s]) break;
+    case RULE_OP_NE: FAIL_STEPS(!=, threshold + rhs[s]) break;
+    default: FAIL_STEPS(!=, lhs[s]) break;
+    }
+}
+
+/**
+ * @brief Evaluate a compiled rule set over every step of a trace, rule by
+ * rule, with the same results as rule_set_evaluate step by step.
+ * @requirement SWR2.2
+ * @requirement SWR2.3
+ * @requirement SWR2.4
+ */
+void rule_set_evaluate_trace(const RuleSet *set, const double *const *signals, size_t steps,
+                             unsigned int *satisfied)
+{
+    // Failed bits are accumulated in place, then inverted
+    (void)memset(satisfied, 0, steps * sizeof(*satisfied));
+    for (size_t i = 0U; i < set->num_rules; i++)
+    {
+        fail_steps(&set->rules[i], signals, steps, satisfied);
+    }
+    for (size_t s = 0U; s < steps; s++)
+    {
+        satisfied[s] = set->all_bits & ~satisfied[s];
+    }
+}
+
+/**
+ * @brief Engine-off decision: the engine goes off once every condition is
+ * satisfied, unless it is already off or Stop/Start was disabled.
+ * @requirement SWR2.2
+ */
+bool stop_start_engine_off(StopStartState *state, unsigned int failed)
+{
+    bool turned_off = false;
+
+    if (!state->engine_off && !state->disabled && (failed == 0U))
+    {
+        state->engine_off = true;
+        turned_off = true;
+    }
+    return turned_off;
+}
+
+/**
+ * @brief Restart decision while the engine is off: a brake release or an
+ * accelerator press arms the restart, which then waits for the battery. A
+ * refused restart disables Stop/Start.
+ * @requirement SWR2.5
+ * @requirement SWR3.1
+ * @requirement SWR3.4
+ * @requirement SWR3.5
+ */
+StopStartRestart stop_start_restart(StopStartState *state, bool brake, bool prev_brake,
+                                    bool accel, bool prev_accel, double batt_volt, double batt_soc)
+{
+    StopStartRestart result = SS_RESTART_NONE;
+
+    if (state->engine_off && !state->disabled)
+    {
+        if ((prev_brake && !brake) || (!prev_accel && accel))
+        {
+            state->restart_trigger = true;
+        }
+
+        if (!state->restart_trigger)
+        {
+            // Engine stays off
+        }
+        else if ((batt_volt >= MIN_BATTERY_VOLTAGE) && (batt_soc >= MIN_BATTERY_SOC))
+        {
+            state->engine_off = false;
+            state->restart_trigger = false;
+            result = SS_RESTART_DONE;
+        }
+        else
+        {
+            state->disabled = true;
+            result = SS_RESTART_REFUSED;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,108 @@
+#ifndef STOP_START_RULES_H
+#define STOP_START_RULES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "can_comms.h"
+
+/*
+ * Data-driven Stop/Start inhibit conditions.
+ *
+ * A rule file has one directive per line ('#' starts a comment):
+ *   rule    <condition> <signal> <op> <operand>
+ *   message <condition> <can_error> <log text...>
+ * op is one of < <= > >= == !=, operand is a number, a signal, or
+ * signal+number / signal-number. The rules of one condition are ANDed; each
+ * condition gets the next bit of the evaluation mask in order of first use,
+ * so the built-in set matches the COND_BIT_* layout.
+ */
+#define RULES_MAX_RULES         (32U)
+#define RULES_MAX_CONDITIONS    (16U)
+#define RULES_NAME_SIZE         (24U)
+#define RULES_CAN_ERROR_SIZE    (40U)
+#define RULES_LOG_SIZE          (128U)
+#define RULES_NUM_SIGNALS       (12U)   // speed ... gear, in VehicleData order
+
+typedef enum {
+    RULE_OP_LT = 0,
+    RULE_OP_LE,
+    RULE_OP_GT,
+    RULE_OP_GE,
+    RULE_OP_EQ,
+    RULE_OP_NE
+} RuleOp;
+
+// One comparison, flattened: lhs <op> (rhs signal, if any) + threshold
+typedef struct {
+    unsigned int bit;           // Condition bit cleared when the comparison fails
+    unsigned short lhs;         // Signal index
+    unsigned short rhs;         // Signal index or RULES_NO_SIGNAL
+    RuleOp op;
+    double threshold;
+} CompiledRule;
+
+#define RULES_NO_SIGNAL         (0xFFFFU)
+
+typedef struct {
+    char name[RULES_NAME_SIZE];
+    char can_error[RULES_CAN_ERROR_SIZE];
+    char system_log[RULES_LOG_SIZE];
+} RuleCondition;
+
+typedef struct {
+    CompiledRule rules[RULES_MAX_RULES];
+    size_t num_rules;
+    RuleCondition conditions[RULES_MAX_CONDITIONS];
+    size_t num_conditions;
+    unsigned int all_bits;      // One bit per condition
+} RuleSet;
+
+// Built-in calibration (the historical hardcoded thresholds)
+bool rule_set_load_default(RuleSet *set);
+
+// Load a rule file; on error, prints "path:line: reason" and returns false
+bool rule_set_load_file(RuleSet *set, const char *path);
+
+// Parse one directive into set (used by both loaders)
+bool rule_set_parse_line(RuleSet *set, const char *line, const char **error);
+
+// Mask of satisfied conditions for one step of data
+unsigned int rule_set_evaluate(const RuleSet *set, const VehicleData *data);
+
+// Name of signal index (as used in rule files), NULL past the last one
+const char *rule_set_signal_name(size_t index);
+
+/* Same evaluation over a whole trace: signals[i][step] holds signal index i
+   (rule_set_signal_name order). satisfied[step] gets the mask of each step. */
+void rule_set_evaluate_trace(const RuleSet *set, const double *const *signals, size_t steps,
+                             unsigned int *satisfied);
+
+/* Battery needed for a restart */
+#define MIN_BATTERY_VOLTAGE 10.0F
+#define MIN_BATTERY_SOC 70.0F
+
+/*
+ * Engine state machine of the Stop/Start logic, without CAN, log or metrics
+ * side effects. check_disable_engine / handle_engine_restart_logic and the
+ * Monte Carlo replay step the same functions and act on what they return.
+ */
+typedef struct {
+    bool engine_off;
+    bool restart_trigger;       // Brake released or accelerator pressed while off
+    bool disabled;              // Restart refused: Stop/Start is off (SWR3.5)
+} StopStartState;
+
+typedef enum {
+    SS_RESTART_NONE = 0,        // Engine on, or no restart requested
+    SS_RESTART_DONE,
+    SS_RESTART_REFUSED          // Battery check failed, state->disabled is set
+} StopStartRestart;
+
+// Engine-off decision for the failed condition bits; true when the engine goes off
+bool stop_start_engine_off(StopStartState *state, unsigned int failed);
+
+// Restart decision for one step of pedal and battery values
+StopStartRestart stop_start_restart(StopStartState *state, bool brake, bool prev_brake,
+                                    bool accel, bool prev_accel, double batt_volt, double batt_soc);
+
+#endif // STOP_START_RULES_H
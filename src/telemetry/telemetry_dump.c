@@ -0,0 +1,229 @@
+/*
+ * Telemetry file reader.
+ *
+ * Prints a columnar telemetry file written by the powertrain (see
+ * telemetry.h) as CSV, optionally restricted to a few columns, or a
+ * per-column summary with the storage cost of the file.
+ * With -f it estimates the fuel saved by Stop/Start in each file given and
+ * in all of them together (see fuel_savings.h), e.g. over a replay farm.
+ */
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "../common_includes/telemetry.h"
+#include "../common_includes/fuel_savings.h"
+
+#define ERROR_CODE      (1)
+#define COLUMN_LIST_SIZE (256)
+#define SAVINGS_TEXT_SIZE (192)
+
+typedef struct {
+    double min;
+    double max;
+    double sum;
+} ColumnSummary;
+
+static void usage(const char *prog)
+{
+    (void)fprintf(stderr,
+        "Usage: %s [options] FILE\n"
+        "       %s -f FILE...\n"
+        "  -c COLS     comma separated columns to print (default: all)\n"
+        "  -s          print a per-column summary instead of CSV rows\n"
+        "  -f          Stop/Start fuel savings of each file and of all files\n",
+        prog, prog);
+}
+
+static bool select_columns(const TelemetryReader *reader, const char *list,
+                           uint32_t *selected, uint32_t *count)
+{
+    char buffer[COLUMN_LIST_SIZE];
+    char *save = NULL;
+
+    *count = 0U;
+    if (list == NULL)
+    {
+        for (uint32_t col = 0U; col < reader->num_columns; col++)
+        {
+            selected[(*count)++] = col;
+        }
+        return true;
+    }
+
+    (void)snprintf(buffer, sizeof(buffer), "%s", list);
+    for (char *name = strtok_r(buffer, ",", &save); name != NULL; name = strtok_r(NULL, ",", &save))
+    {
+        const int index = telemetry_column_index(reader, name);
+        if ((index < 0) || (*count >= TELEMETRY_MAX_COLUMNS))
+        {
+            (void)fprintf(stderr, "Unknown column: %s\n", name);
+            return false;
+        }
+        selected[(*count)++] = (uint32_t)index;
+    }
+    return *count > 0U;
+}
+
+static void print_csv(TelemetryReader *reader, const uint32_t *selected, uint32_t count)
+{
+    for (uint32_t i = 0U; i < count; i++)
+    {
+        (void)printf("%s%s", (i > 0U) ? "," : "", reader->columns[selected[i]].name);
+    }
+    (void)printf("\n");
+
+    while (telemetry_read_block(reader))
+    {
+        for (uint32_t row = 0U; row < reader->rows; row++)
+        {
+            for (uint32_t i = 0U; i < count; i++)
+            {
+                (void)printf("%s%.10g", (i > 0U) ? "," : "",
+                             telemetry_value(reader, selected[i], row));
+            }
+            (void)printf("\n");
+        }
+    }
+}
+
+static void print_summary(TelemetryReader *reader, const uint32_t *selected, uint32_t count,
+                          const char *path)
+{
+    ColumnSummary summary[TELEMETRY_MAX_COLUMNS];
+    unsigned long rows = 0UL;
+    unsigned long blocks = 0UL;
+    unsigned long compressed = 0UL;
+    struct stat info;
+
+    (void)memset(summary, 0, sizeof(summary));
+    while (telemetry_read_block(reader))
+    {
+        for (uint32_t i = 0U; i < count; i++)
+        {
+            for (uint32_t row = 0U; row < reader->rows; row++)
+            {
+                const double value = telemetry_value(reader, selected[i], row);
+                const bool first = (rows == 0UL) && (row == 0U);
+                summary[i].min = (first || (value < summary[i].min)) ? value : summary[i].min;
+                summary[i].max = (first || (value > summary[i].max)) ? value : summary[i].max;
+                summary[i].sum += value;
+            }
+        }
+        rows += reader->rows;
+        blocks++;
+        compressed += (reader->codec != TELEMETRY_CODEC_NONE) ? 1UL : 0UL;
+    }
+
+    const long size = (stat(path, &info) == 0) ? (long)info.st_size : 0L;
+    (void)printf("rows %lu, blocks %lu (%lu compressed), %ld bytes, %.2f bytes/row\n",
+                 rows, blocks, compressed, size, (rows > 0UL) ? ((double)size / (double)rows) : 0.0);
+    if (rows == 0UL)
+    {
+        return;
+    }
+
+    (void)printf("%-16s %14s %14s %14s\n", "column", "min", "max", "mean");
+    for (uint32_t i = 0U; i < count; i++)
+    {
+        (void)printf("%-16s %14.4g %14.4g %14.4g\n", reader->columns[selected[i]].name,
+                     summary[i].min, summary[i].max, summary[i].sum / (double)rows);
+    }
+}
+
+static int print_savings(int num_files, char **paths)
+{
+    static TelemetryReader reader;
+    FuelSavings total;
+    char text[SAVINGS_TEXT_SIZE];
+    int failed = 0;
+
+    fuel_savings_reset(&total);
+    for (int i = 0; i < num_files; i++)
+    {
+        FuelSavings run;
+        fuel_savings_reset(&run);
+        if (!telemetry_reader_open(&reader, paths[i]))
+        {
+            (void)fprintf(stderr, "Not a telemetry file: %s\n", paths[i]);
+            failed++;
+            continue;
+        }
+        const bool ok = fuel_savings_add_telemetry(&run, &reader);
+        telemetry_reader_close(&reader);
+        if (!ok)
+        {
+            (void)fprintf(stderr, "Not a powertrain telemetry file: %s\n", paths[i]);
+            failed++;
+            continue;
+        }
+        (void)fuel_savings_format(&run, text, sizeof(text));
+        (void)printf("%s %s\n", paths[i], text);
+        fuel_savings_merge(&total, &run);
+    }
+    if (num_files > 1)
+    {
+        (void)fuel_savings_format(&total, text, sizeof(text));
+        (void)printf("total(%d) %s\n", num_files - failed, text);
+    }
+    return (failed == 0) ? EXIT_SUCCESS : ERROR_CODE;
+}
+
+int main(int argc, char **argv)
+{
+    static TelemetryReader reader;
+    uint32_t selected[TELEMETRY_MAX_COLUMNS];
+    uint32_t count = 0U;
+    const char *columns = NULL;
+    bool summary = false;
+    bool savings = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "c:sfh")) != -1)
+    {
+        switch (opt)
+        {
+        case 'c': columns = optarg; break;
+        case 's': summary = true; break;
+        case 'f': savings = true; break;
+        default:
+            usage(argv[0]);
+            return ERROR_CODE;
+        }
+    }
+    if (optind >= argc)
+    {
+        usage(argv[0]);
+        return ERROR_CODE;
+    }
+    if (savings)
+    {
+        return print_savings(argc - optind, &argv[optind]);
+    }
+
+    if (!telemetry_reader_open(&reader, argv[optind]))
+    {
+        (void)fprintf(stderr, "Not a telemetry file: %s\n", argv[optind]);
+        return ERROR_CODE;
+    }
+    if (!select_columns(&reader, columns, selected, &count))
+    {
+        telemetry_reader_close(&reader);
+        return ERROR_CODE;
+    }
+
+    if (summary)
+    {
+        print_summary(&reader, selected, count, argv[optind]);
+    }
+    else
+    {
+        print_csv(&reader, selected, count);
+    }
+
+    telemetry_reader_close(&reader);
+    return EXIT_SUCCESS;
+}
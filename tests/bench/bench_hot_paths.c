@@ -0,0 +1,288 @@
+/*
+ * Microbenchmarks for the hot paths of the ECUs.
+ *
+ * Built at -O2 without coverage by `make bench`. Each case runs one
+ * warm-up repetition and BENCH_REPS timed repetitions; the report gives
+ * the mean, standard deviation and minimum in ns/op and the mean ops/s.
+ */
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../../src/common_includes/can_id_list.h"
+#include "../../src/common_includes/can_socket.h"
+#include "../../src/common_includes/sensor_pdu.h"
+#include "../../src/common_includes/logging.h"
+#include "../../src/powertrain/powertrain_func.h"
+#include "../../src/dashboard/dashboard_func.h"
+
+/* bcm_func.h redefines VehicleData, so only the needed BCM symbols are declared */
+void read_csv(const char *path);
+extern int data_size;
+
+#define BENCH_REPS          (10U)
+#define BENCH_CSV_PATH      "../src/bcm/full_simu.csv"
+#define BENCH_LOG_PATH      "/tmp/bench_hot_paths.log"
+#define BENCH_NULL_DEVICE   "/dev/null"
+#define NSEC_PER_SEC        (1000000000.0)
+#define BENCH_NAME_WIDTH    (34)
+
+#define ITERS_CRYPTO        (20000UL)
+#define ITERS_SEND          (20000UL)
+#define ITERS_PARSE         (200000UL)
+#define ITERS_CSV           (200UL)
+#define ITERS_ENGINE        (1000000UL)
+#define ITERS_LOG           (20000UL)
+
+typedef struct {
+    const char *name;
+    unsigned long iters;
+    void (*setup)(unsigned long iters);     // Untimed, before each repetition
+    void (*run)(unsigned long iters);
+} BenchCase;
+
+static volatile int bench_sink = 0;
+static int bench_sock = -1;
+static unsigned char *cipher_batch = NULL;
+static unsigned long cipher_batch_size = 0;
+
+static double now_ns(void)
+{
+    struct timespec tss;
+    clock_gettime(CLOCK_MONOTONIC, &tss);
+    return ((double)tss.tv_sec * NSEC_PER_SEC) + (double)tss.tv_nsec;
+}
+
+/* ---------------------------------------------------------------------------
+ * Cases
+ * -------------------------------------------------------------------------*/
+static void run_encrypt(unsigned long iters)
+{
+    unsigned char plain[AES_BLOCK_SIZE] = "speed: 42.0";
+    unsigned char cipher[SECURED_MSG_SIZE];
+    int out_len = 0;
+
+    for (unsigned long i = 0; i < iters; i++)
+    {
+        encrypt_data(plain, cipher, &out_len, CAN_ID_SENSOR_READ);
+        bench_sink += cipher[SECURED_MSG_SIZE - 1U];
+    }
+}
+
+/* Every decrypt needs a fresh counter, otherwise the replay window rejects it */
+static void setup_decrypt(unsigned long iters)
+{
+    unsigned char plain[AES_BLOCK_SIZE] = "speed: 42.0";
+    int out_len = 0;
+
+    if (cipher_batch_size < iters)
+    {
+        free(cipher_batch);
+        cipher_batch = malloc(iters * SECURED_MSG_SIZE);
+        cipher_batch_size = (cipher_batch != NULL) ? iters : 0UL;
+    }
+    for (unsigned long i = 0; i < cipher_batch_size; i++)
+    {
+        encrypt_data(plain, &cipher_batch[i * SECURED_MSG_SIZE], &out_len, CAN_ID_SENSOR_READ);
+    }
+}
+
+static void run_decrypt(unsigned long iters)
+{
+    char plain[AES_BLOCK_SIZE + 1];
+
+    for (unsigned long i = 0; (i < iters) && (i < cipher_batch_size); i++)
+    {
+        bench_sink += decrypt_data(&cipher_batch[i * SECURED_MSG_SIZE], plain,
+                                   SECURED_MSG_SIZE, CAN_ID_SENSOR_READ);
+    }
+}
+
+static void run_send_message(unsigned long iters)
+{
+    for (unsigned long i = 0; i < iters; i++)
+    {
+        send_encrypted_message(bench_sock, "speed: 42.0", CAN_ID_SENSOR_READ);
+    }
+}
+
+static void run_parse_powertrain(unsigned long iters)
+{
+    char msg[AES_BLOCK_SIZE + 1] = "engi_temp: 95.4";
+
+    for (unsigned long i = 0; i < iters; i++)
+    {
+        parse_input_received_powertrain(msg);
+    }
+    bench_sink += (int)rec_data.engi_temp;
+}
+
+static void run_apply_pdu_powertrain(unsigned long iters)
+{
+    SensorPdu pdu = { .present = SENSOR_PDU_ALL_PRESENT, .speed = 42.0, .engi_temp = 95.4 };
+    unsigned char block[SENSOR_PDU_SIZE];
+
+    sensor_pdu_encode(&pdu, block);
+    for (unsigned long i = 0; i < iters; i++)
+    {
+        bench_sink += (int)apply_sensor_pdu_powertrain(block);
+    }
+}
+
+static void run_sensor_readings(unsigned long iters)
+{
+    char msg[AES_BLOCK_SIZE + 1] = "tilt: 7.0";
+
+    for (unsigned long i = 0; i < iters; i++)
+    {
+        process_sensor_readings(msg);
+    }
+    bench_sink += (int)actuators.tilt_angle;
+}
+
+static void run_sensor_pdu_dashboard(unsigned long iters)
+{
+    SensorPdu pdu = { .present = SENSOR_PDU_ALL_PRESENT, .speed = 42.0, .tilt_angle = 7.0 };
+    unsigned char block[SENSOR_PDU_SIZE];
+
+    sensor_pdu_encode(&pdu, block);
+    for (unsigned long i = 0; i < iters; i++)
+    {
+        bench_sink += (int)process_sensor_pdu(block);
+    }
+}
+
+static void run_read_csv(unsigned long iters)
+{
+    for (unsigned long i = 0; i < iters; i++)
+    {
+        data_size = 0;
+        read_csv(BENCH_CSV_PATH);
+    }
+    bench_sink += data_size;
+}
+
+/* Steady state with the engine already off: all conditions hold, nothing is sent */
+static void setup_engine(unsigned long iters)
+{
+    (void)iters;
+    memset(&rec_data, 0, sizeof(rec_data));
+    rec_data.brake = 1;
+    rec_data.internal_temp = 22;
+    rec_data.external_temp = 25;
+    rec_data.temp_set = 22;
+    rec_data.engi_temp = 90.0;
+    rec_data.batt_soc = 80.0;
+    rec_data.batt_volt = 12.5;
+    engine_off = true;
+}
+
+static void run_check_disable_engine(unsigned long iters)
+{
+    for (unsigned long i = 0; i < iters; i++)
+    {
+        check_disable_engine(&rec_data);
+    }
+    bench_sink += (int)engine_off;
+}
+
+static void run_log_event(unsigned long iters)
+{
+    for (unsigned long i = 0; i < iters; i++)
+    {
+        log_toggle_event("Stop/Start: Engine turned Off");
+    }
+}
+
+static const BenchCase bench_cases[] = {
+    { "encrypt_data",                       ITERS_CRYPTO, NULL,          run_encrypt },
+    { "decrypt_data",                       ITERS_CRYPTO, setup_decrypt, run_decrypt },
+    { "send_encrypted_message (null sock)", ITERS_SEND,   NULL,          run_send_message },
+    { "parse_input_received_powertrain",    ITERS_PARSE,  NULL,          run_parse_powertrain },
+    { "apply_sensor_pdu_powertrain",        ITERS_PARSE,  NULL,          run_apply_pdu_powertrain },
+    { "process_sensor_readings",            ITERS_PARSE,  NULL,          run_sensor_readings },
+    { "process_sensor_pdu",                 ITERS_PARSE,  NULL,          run_sensor_pdu_dashboard },
+    { "read_csv (full_simu.csv)",           ITERS_CSV,    NULL,          run_read_csv },
+    { "check_disable_engine",               ITERS_ENGINE, setup_engine,  run_check_disable_engine },
+    { "log_toggle_event",                   ITERS_LOG,    NULL,          run_log_event },
+};
+
+/* ---------------------------------------------------------------------------
+ * Harness
+ * -------------------------------------------------------------------------*/
+static void run_case(const BenchCase *bench)
+{
+    double samples[BENCH_REPS];
+    double mean = 0.0;
+    double var = 0.0;
+    double min = 0.0;
+
+    // Warm-up: caches, key schedule, page faults
+    if (bench->setup != NULL)
+    {
+        bench->setup(bench->iters);
+    }
+    bench->run(bench->iters);
+
+    for (unsigned int rep = 0; rep < BENCH_REPS; rep++)
+    {
+        if (bench->setup != NULL)
+        {
+            bench->setup(bench->iters);
+        }
+        double start = now_ns();
+        bench->run(bench->iters);
+        samples[rep] = (now_ns() - start) / (double)bench->iters;
+        mean += samples[rep];
+        min = ((rep == 0U) || (samples[rep] < min)) ? samples[rep] : min;
+    }
+    mean /= (double)BENCH_REPS;
+
+    for (unsigned int rep = 0; rep < BENCH_REPS; rep++)
+    {
+        var += (samples[rep] - mean) * (samples[rep] - mean);
+    }
+    var /= (double)(BENCH_REPS - 1U);
+
+    (void)printf("%-*s %10lu %12.1f %10.1f %6.1f%% %12.1f %14.0f\n",
+                 BENCH_NAME_WIDTH, bench->name, bench->iters, mean, sqrt(var),
+                 (mean > 0.0) ? (100.0 * sqrt(var) / mean) : 0.0, min,
+                 (mean > 0.0) ? (NSEC_PER_SEC / mean) : 0.0);
+    (void)fflush(stdout);
+}
+
+int main(int argc, char **argv)
+{
+    const char *filter = (argc > 1) ? argv[1] : NULL;
+
+    bench_sock = open(BENCH_NULL_DEVICE, O_WRONLY);
+    sock_sender = bench_sock;
+    set_can_node_id(CAN_NODE_BCM);
+    set_log_file_path(BENCH_LOG_PATH);
+    if ((bench_sock < 0) || !init_logging_system())
+    {
+        (void)fprintf(stderr, "bench: cannot open %s or %s\n", BENCH_NULL_DEVICE, BENCH_LOG_PATH);
+        return EXIT_FAILURE;
+    }
+
+    (void)printf("%-*s %10s %12s %10s %7s %12s %14s\n", BENCH_NAME_WIDTH, "benchmark",
+                 "iters/rep", "mean ns/op", "stddev", "rsd", "min ns/op", "ops/s");
+
+    for (size_t i = 0; i < (sizeof(bench_cases) / sizeof(bench_cases[0])); i++)
+    {
+        if ((filter == NULL) || (strstr(bench_cases[i].name, filter) != NULL))
+        {
+            run_case(&bench_cases[i]);
+        }
+    }
+
+    cleanup_logging_system();
+    (void)unlink(BENCH_LOG_PATH);
+    (void)close(bench_sock);
+    free(cipher_batch);
+    return (bench_sink == INT32_MIN) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -1,24 +1,35 @@
 #include "../../src/common_includes/can_id_list.h"
 #include "../../src/common_includes/can_socket.h"
+#include "../../src/common_includes/can_reassembly.h"
 #include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
 #include <linux/can.h>
 
 #define LAST_MESSAGE_SIZE      (256)
-#define CAN_DLC_CORRECT        (8)
 #define CAN_DLC_INCORRECT      (5)
 #define FIRST_CALL_BYTES       (0x11)
 #define SECOND_CALL_BYTES      (0x22)
 #define THIRD_CALL_BYTES       (0x33)
 #define CAN_ID_INVALID_COMMAND (0x123)
+#define MOCK_SEQ_BROKEN        (0U)
+#define MOCK_SEQ_VALID         (1U)
+#define MOCK_VALID_FIRST_CALL  (3)
 
 static int s_send_count = 0;
 static int s_received_count = 0;
 static int g_call_count = 0;
+static int s_last_can_id = 0;
 static char s_last_message_sent[LAST_MESSAGE_SIZE] = {0};
+static unsigned char s_last_block_sent[AES_BLOCK_SIZE] = {0};
 static bool force_invalid_id = false;
 static bool g_force_sys_disable_string = false;
+static bool g_force_auth_failure = false;
+
+void mock_can_force_auth_failure(bool enable)
+{
+    g_force_auth_failure = enable;
+}
 
 void  mock_can_force_sys_disable(bool enable)
 {
@@ -38,68 +49,98 @@ void mock_can_force_invalid_id(bool enable)
 void send_encrypted_message(int sock, const char *message, int can_id)
 {
     (void) sock;
-    (void) can_id;
 
     s_send_count++;
+    s_last_can_id = can_id;
     snprintf(s_last_message_sent, sizeof(s_last_message_sent), "%s", message);
     printf("[STUB] send_encrypted_message('%s')\n", message);
 }
 
+/* 
+ * Fake version of send_encrypted_block.
+ * - Keeps a copy of the raw block for later decoding.
+ */
+void send_encrypted_block(int sock, const unsigned char *block, int can_id)
+{
+    (void) sock;
+
+    s_send_count++;
+    s_last_can_id = can_id;
+    memcpy(s_last_block_sent, block, AES_BLOCK_SIZE);
+    printf("[STUB] send_encrypted_block()\n");
+}
+
 /* 
  * Fake version of receive_can_frame.
  * - Do not open real socket
- * - Simply log the call so we can validate it later. 
+ * - Feeds one broken message followed by one complete message,
+ *   fragmented the same way the real sender does.
  */
 int receive_can_frame(int sock, struct can_frame *frame)
 {
     (void)sock;
-    switch (g_call_count)
+    unsigned char payload[CAN_MSG_WIRE_SIZE];
+    memset(payload, FIRST_CALL_BYTES, sizeof(payload));
+
+    if (g_call_count == 0)
     {
-        case 0:
-            if (force_invalid_id)
-            {
-                frame->can_id = CAN_ID_INVALID_COMMAND;
-                force_invalid_id = false;
-            }
-            else
-            {
-                frame->can_id = CAN_ID_COMMAND;
-            }
-            // 1st call: valid CAN_ID_COMMAND, dlc=8
-            frame->can_dlc = CAN_DLC_CORRECT;
-            memset(frame->data, FIRST_CALL_BYTES, CAN_DLC_CORRECT);
-            break;
-        case 1:
-            // 2nd call: again dlc=8 -> triggers decrypt after 2 blocks
-            frame->can_id  = CAN_ID_COMMAND;
-            frame->can_dlc = CAN_DLC_CORRECT;
-            memset(frame->data, SECOND_CALL_BYTES, CAN_DLC_CORRECT);
-            break;
-        case 2:
-            // 3rd call: unexpected size -> triggers "Warning: Unexpected frame size"
-            frame->can_id  = CAN_ID_COMMAND;
-            frame->can_dlc = CAN_DLC_INCORRECT;
-            memset(frame->data, THIRD_CALL_BYTES, CAN_DLC_INCORRECT);
-            break;
-        case 3:
-            // 4th call
-            frame->can_id  = CAN_ID_COMMAND;
-            frame->can_dlc = CAN_DLC_CORRECT;
-            memset(frame->data, SECOND_CALL_BYTES, CAN_DLC_CORRECT);
-            break;
-        default:
-            // Return -1 on subsequent calls -> signals test to stop
-            return -1;
+        // 1st call: first fragment of message seq 0
+        can_frag_build(frame, CAN_ID_COMMAND, MOCK_SEQ_BROKEN, 0U, payload);
+        if (force_invalid_id)
+        {
+            frame->can_id = CAN_ID_INVALID_COMMAND;
+            force_invalid_id = false;
+        }
+    }
+    else if (g_call_count == 1)
+    {
+        // 2nd call: second fragment of message seq 0
+        memset(payload, SECOND_CALL_BYTES, sizeof(payload));
+        can_frag_build(frame, CAN_ID_COMMAND, MOCK_SEQ_BROKEN, 1U, payload);
+    }
+    else if (g_call_count == 2)
+    {
+        // 3rd call: unexpected size -> message seq 0 is dropped
+        can_frag_build(frame, CAN_ID_COMMAND, MOCK_SEQ_BROKEN, 2U, payload);
+        frame->can_dlc = CAN_DLC_INCORRECT;
+        memset(frame->data + 1, THIRD_CALL_BYTES, CAN_DLC_INCORRECT - 1);
+    }
+    else if (g_call_count < (MOCK_VALID_FIRST_CALL + (int)CAN_FRAGS_PER_MSG))
+    {
+        // Next calls: complete message seq 1 -> triggers decrypt
+        can_frag_build(frame, CAN_ID_COMMAND, MOCK_SEQ_VALID,
+                       (uint8_t)(g_call_count - MOCK_VALID_FIRST_CALL), payload);
+    }
+    else
+    {
+        // Return -1 on subsequent calls -> signals test to stop
+        return -1;
     }
 
     g_call_count++;
     return 0;  // success
 }
 
-void decrypt_data(const unsigned char *input, char *output, int input_len)
+/*
+ * Fake version of receive_can_frame_nowait: the same sequence, then nothing
+ * pending once it is over.
+ */
+int receive_can_frame_nowait(int sock, struct can_frame *frame)
+{
+    return (receive_can_frame(sock, frame) == 0) ? 0 : SOCKET_NO_FRAME;
+}
+
+int decrypt_data(const unsigned char *input, char *output, int input_len, canid_t can_id)
 {
     (void)input;
     (void)input_len;
+    (void)can_id;
+
+    if (g_force_auth_failure)
+    {
+        output[0] = '\0';
+        return DECRYPT_AUTH_FAILED;
+    }
 
     if (g_force_sys_disable_string)
     {
@@ -109,6 +150,7 @@ void decrypt_data(const unsigned char *input, char *output, int input_len)
     {
         strcpy(output, "press_start_stop");
     }
+    return DECRYPT_OK;
 }
 
 int stub_can_get_send_count(void)
@@ -126,12 +168,25 @@ const char* stub_can_get_last_message(void)
     return s_last_message_sent;
 }
 
+int stub_can_get_last_can_id(void)
+{
+    return s_last_can_id;
+}
+
+const unsigned char* stub_can_get_last_block(void)
+{
+    return s_last_block_sent;
+}
+
 void stub_can_reset(void)
 {
     s_send_count = 0;
     g_call_count = 0;
     s_received_count = 0;
+    s_last_can_id = 0;
     force_invalid_id = false;
     g_force_sys_disable_string = false;
+    g_force_auth_failure = false;
     s_last_message_sent[0] = '\0';
+    memset(s_last_block_sent, 0, sizeof(s_last_block_sent));
 }
@@ -5,12 +5,10 @@
 #include <string.h>
 #include <unistd.h>
 
-#include "../../src/bcm/bcm_func.h"
+#include "../../src/bcm/bcm_scheduler.h"
 #include "../../src/common_includes/logging.h"
 
 #define CSV_FILE_PATH "../src/bcm/full_simu.csv"
-#define TEST_EXPECTED_IT     (2.0F)
-#define TEST_EXPECTED_IT_INT (2)
 #define FILE_LINE_SIZE       (256)
 
 // Tolerances
@@ -59,22 +57,19 @@ const float SOC_TOLERANCE = 0.001F;
 #define DOOR_VALID 0
 #define DOOR_INVALID 2
 
-// Delay
-#define TEST_MICRO_SLEEP_DELAY (100000U)
-#define THREAD_SLEEP_TIME (200000U)
-#define MOCK_TIME_1S (1000)
-#define MOCK_TIME_25S (2500)
-
 #define MOCK_SOCKET (999)
+#define FAULT_ROWS  (6)
 
 // Mocked can_socket calls
 void mock_can_force_sys_disable(bool enable);
 void mock_can_force_invalid_id(bool enable);
+void mock_can_force_auth_failure(bool enable);
 int stub_can_get_send_count(void);
 const char *stub_can_get_last_message(void);
+const unsigned char *stub_can_get_last_block(void);
 void stub_can_reset(void);
 
-extern int mock_time_ms;
+static BcmScheduler sched;
 
 //-------------------------------------
 // Suite init/cleanup
@@ -89,7 +84,7 @@ static int init_suite(void)
     batt_soc = DEFAULT_BATTERY_SOC;
     batt_volt = DEFAULT_BATTERY_VOLTAGE;
     memset(vehicle_data, 0, sizeof(vehicle_data));
-    test_mode = false;
+    clear_system_disable();
 
     // Reset the mock counters
     stub_can_reset();
@@ -97,16 +92,6 @@ static int init_suite(void)
 }
 static int clean_suite(void) { return 0; }
 
-// We'll define a quick helper to replicate the "string contains" check
-// since we can't rely on a built-in CU_ASSERT_STRING_CONTAINS:
-static void CU_ASSERT_STRING_CONTAINS(const char *haystack, const char *needle)
-{
-    CU_ASSERT_PTR_NOT_NULL_FATAL(haystack);
-    CU_ASSERT_PTR_NOT_NULL_FATAL(needle);
-    // if haystack doesn't contain needle => fail
-    CU_ASSERT_PTR_NOT_NULL(strstr(haystack, needle));
-}
-
 typedef struct
 {
     const char *filepath;
@@ -261,85 +246,83 @@ void test_send_data_update_manyfields(void)
     vehicle_data[1].gear = 1;
 
     stub_can_reset();
+    reset_publish_state();
     send_data_update();
 
-    // We changed basically everything => many calls
-    // Let's guess we changed 12 fields => 12 calls
-    CU_ASSERT_EQUAL(stub_can_get_send_count(), 12);
-
-    // Optionally check last message
-    CU_ASSERT_STRING_CONTAINS(stub_can_get_last_message(), "gear: 0");
+    // Nothing sent yet => full refresh of every signal, in a single PDU
+    CU_ASSERT_EQUAL(stub_can_get_send_count(), 1);
+
+    SensorPdu pdu = {0};
+    CU_ASSERT_TRUE(sensor_pdu_decode(stub_can_get_last_block(), &pdu));
+    CU_ASSERT_EQUAL(pdu.present, SENSOR_PDU_ALL_PRESENT);
+    CU_ASSERT_DOUBLE_EQUAL(pdu.speed, SPEED_MEDIUM, SOC_TOLERANCE);
+    CU_ASSERT_EQUAL(pdu.internal_temp, INT_TEMP_1);
+    CU_ASSERT_DOUBLE_EQUAL(pdu.batt_volt, BATT_VOLT_1, SOC_TOLERANCE);
+    CU_ASSERT_EQUAL(pdu.brake, 1);
+    CU_ASSERT_EQUAL(pdu.gear, 0);
 }
 
 //-------------------------------------
-// 7) test_simu_speed_smallloop
-//    We'll forcibly do a small data_size so we can call simu_speed once or twice
-//    This also forces calls to sleep_microseconds(...)
+// 6b) test_send_data_update_delta_only
+//     Only signals that moved beyond their deadband are sent,
+//     and everything is sent again on the periodic refresh
 //-------------------------------------
-void test_simu_speed_smallloop(void)
+void test_send_data_update_delta_only(void)
 {
-    data_size = 2;
-    vehicle_data[0].speed = 0.0;
-    vehicle_data[1].speed = SPEED_LOW;
+    simu_curr_step = 0;
+    vehicle_data[0].speed = SPEED_MEDIUM;
+    vehicle_data[0].tilt_angle = TILT_1;
+    vehicle_data[0].door_open = DOOR_VALID;
 
-    simu_state = STATE_RUNNING;
-    simu_order = ORDER_RUN;
+    SensorPdu pdu = {0};
 
-    int count = 0;
-    while (count < 2)
-    {
-        pthread_mutex_lock(&mutex_bcm);
-        check_order(simu_order);
+    stub_can_reset();
+    reset_publish_state();
+    send_data_update();
+    CU_ASSERT_EQUAL(stub_can_get_send_count(), 1);
 
-        if (simu_state == STATE_RUNNING)
-        {
-            // If there's a next step
-            if (simu_curr_step + 1 != data_size)
-            {
-                double speed0 = vehicle_data[simu_curr_step].speed;
-                double speed1 = vehicle_data[simu_curr_step + 1].speed;
-                if (speed1 - speed0 > 0)
-                {
-                    vehicle_data[simu_curr_step].accel = 1;
-                    vehicle_data[simu_curr_step].brake = 0;
-                    vehicle_data[simu_curr_step].gear = DRIVE;
-                }
-                else
-                {
-                    vehicle_data[simu_curr_step].brake = 1;
-                    vehicle_data[simu_curr_step].accel = 0;
-                    if (speed0 == 0.0)
-                    {
-                        vehicle_data[simu_curr_step].gear = PARKING;
-                    }
-                }
-            }
-            // increment first
-            simu_curr_step++;
-
-            // now decide if we want to stop
-            if (simu_curr_step >= data_size)
-            {
-                simu_order = ORDER_STOP;
-            }
-        }
-        pthread_mutex_unlock(&mutex_bcm);
+    // Unchanged data => nothing on the bus
+    stub_can_reset();
+    send_data_update();
+    CU_ASSERT_EQUAL(stub_can_get_send_count(), 0);
 
-        // This calls sleep_microseconds => covers that code
-        sleep_microseconds(TEST_MICRO_SLEEP_DELAY);
-        count++;
-    }
+    // Speed changed, tilt moved less than its deadband
+    vehicle_data[0].speed = SPEED_HIGH;
+    vehicle_data[0].tilt_angle = TILT_1 + (DEADBAND_TILT / 2.0);
+    stub_can_reset();
+    send_data_update();
+    CU_ASSERT_EQUAL(stub_can_get_send_count(), 1);
+    CU_ASSERT_TRUE(sensor_pdu_decode(stub_can_get_last_block(), &pdu));
+    CU_ASSERT_EQUAL(pdu.present, (uint16_t)(1U << SENSOR_SIG_SPEED));
+    CU_ASSERT_DOUBLE_EQUAL(pdu.speed, SPEED_HIGH, SOC_TOLERANCE);
+
+    // Slow drift adds up against the last sent value
+    vehicle_data[0].tilt_angle = TILT_1 + (DEADBAND_TILT * 2.0);
+    stub_can_reset();
+    send_data_update();
+    CU_ASSERT_EQUAL(stub_can_get_send_count(), 1);
+    CU_ASSERT_TRUE(sensor_pdu_decode(stub_can_get_last_block(), &pdu));
+    CU_ASSERT_EQUAL(pdu.present, (uint16_t)(1U << SENSOR_SIG_TILT));
+    CU_ASSERT_DOUBLE_EQUAL(pdu.tilt_angle, TILT_1 + (DEADBAND_TILT * 2.0), SOC_TOLERANCE);
 
-    printf("simu_curr_step %d\n", simu_curr_step);
-    CU_ASSERT_EQUAL(simu_curr_step, 2);
+    // Steps without changes until the refresh period is reached
+    stub_can_reset();
+    for (unsigned int i = 4U; i < PUBLISH_REFRESH_STEPS; i++)
+    {
+        send_data_update();
+    }
+    CU_ASSERT_EQUAL(stub_can_get_send_count(), 0);
+    send_data_update();
+    CU_ASSERT_EQUAL(stub_can_get_send_count(), 1);
+    CU_ASSERT_TRUE(sensor_pdu_decode(stub_can_get_last_block(), &pdu));
+    CU_ASSERT_EQUAL(pdu.present, SENSOR_PDU_ALL_PRESENT);
 }
 
 //-------------------------------------
-// 8) Speed simulator step coverage
+// 7) Step controls derived from the speed profile
 //-------------------------------------
-void test_simu_speed_step(void)
+void test_derive_step_controls(void)
 {
-    // data_size=3
     #define data_size_simu_test  7
 
     #define STEP1 0
@@ -348,7 +331,6 @@ void test_simu_speed_step(void)
     #define STEP4 3
     #define STEP5 4
     #define STEP6 5
-    #define STEP7 6
 
     // Populate vehicle_data
     vehicle_data[STEP1].speed = 0.0;
@@ -357,521 +339,313 @@ void test_simu_speed_step(void)
     vehicle_data[STEP4].speed = SPEED_MEDIUM;
     vehicle_data[STEP5].speed = SPEED_LOW;
     vehicle_data[STEP6].speed = 0.0;
-    vehicle_data[STEP7].speed = 0.0;
+    vehicle_data[data_size_simu_test - 1].speed = 0.0;
 
-    // Mark the simulation as RUNNING
-    simu_state = STATE_RUNNING;
-    simu_curr_step = 0;
-    simu_order = ORDER_RUN;
-
-    // Build arrays of pointers
-    double *speed[data_size_simu_test];
-    int *accel[data_size_simu_test];
-    int *brake[data_size_simu_test];
-    int *gear[data_size_simu_test];
-
-    for (int i = 0; i < data_size_simu_test; i++)
+    for (int i = 0; i < data_size_simu_test - 1; i++)
     {
-        speed[i] = &vehicle_data[i].speed;
-        accel[i] = &vehicle_data[i].accel;
-        brake[i] = &vehicle_data[i].brake;
-        gear[i] = &vehicle_data[i].gear;
+        derive_step_controls(vehicle_data, i);
     }
 
-    ControlData control_data = {speed, accel, brake, gear};
-
-    // 1) First call  => index 0 => 1 => speed difference = (5.0 - 0.0) > 0
-    // => accel=1, brake=0, gear=DRIVE
-    simu_speed_step(vehicle_data, control_data);
-
-    CU_ASSERT_EQUAL(simu_curr_step, STEP1);
-    CU_ASSERT_EQUAL(*(accel[STEP1]), 1); // note the * to dereference
-    CU_ASSERT_EQUAL(*(brake[STEP1]), 0);
-    CU_ASSERT_EQUAL(*(gear[STEP1]), DRIVE);
-
-    simu_curr_step++;
-
-    // 2) Second call => index 1 => 2 => (10.0 - 5.0) > 0 (accelerating)
-    // => accel=1, brake=0, gear=DRIVE
-    simu_speed_step(vehicle_data, control_data);
-
-    CU_ASSERT_EQUAL(simu_curr_step, STEP2);
-    CU_ASSERT_EQUAL(*(accel[STEP2]), 1);
-    CU_ASSERT_EQUAL(*(brake[STEP2]), 0);
-    CU_ASSERT_EQUAL(*(gear[STEP2]), DRIVE);
-
-    simu_curr_step++;
-
-    // 3) Third call  => index 2 => 2 => 3 => (10.0 - 10.0) = 0 (constant speed)
-    // => accel=1, brake=0, gear=DRIVE
-    simu_speed_step(vehicle_data, control_data);
-
-    CU_ASSERT_EQUAL(simu_curr_step, STEP3);
-    CU_ASSERT_EQUAL(*(accel[STEP3]), 1);
-    CU_ASSERT_EQUAL(*(brake[STEP3]), 0);
-    CU_ASSERT_EQUAL(*(gear[STEP3]), DRIVE);
-
-    simu_curr_step++;
-
-    // 4) Fourth call  => index 3 => 3 => 4 => (5.0 - 10.0) = -5.0 (braking)
-    // => accel=0, brake=1, gear=DRIVE
-    simu_speed_step(vehicle_data, control_data);
-
-    CU_ASSERT_EQUAL(simu_curr_step, STEP4);
-    CU_ASSERT_EQUAL(*(accel[STEP4]), 0);
-    CU_ASSERT_EQUAL(*(brake[STEP4]), 1);
-    CU_ASSERT_EQUAL(*(gear[STEP4]), DRIVE);
-
-    simu_curr_step++;
-
-    // 5) Fifth call  => index 4 => 4 => 5 => (0.0 - 5.0) = -5.0 (stopped)
-    // => accel=0, brake=1, gear=DRIVE
-    simu_speed_step(vehicle_data, control_data);
-
-    CU_ASSERT_EQUAL(simu_curr_step, STEP5);
-    CU_ASSERT_EQUAL(*(accel[STEP5]), 0);
-    CU_ASSERT_EQUAL(*(brake[STEP5]), 1);
-    CU_ASSERT_EQUAL(*(gear[STEP5]), DRIVE);
-
-    simu_curr_step++;
-
-    // 6) Sixth call  => index 5 => 5 => 6 => (0.0 - 0.0) = 0 (stopped)
-    // => accel=0, brake=1, gear=PARKING
-    simu_speed_step(vehicle_data, control_data);
-
-    CU_ASSERT_EQUAL(simu_curr_step, STEP6);
-    CU_ASSERT_EQUAL(*(accel[STEP6]), 0);
-    CU_ASSERT_EQUAL(*(brake[STEP6]), 1);
-    CU_ASSERT_EQUAL(*(gear[STEP6]), PARKING);
-
-    simu_curr_step++;
-
-    // 7) Seventh call => index 6 => if (6+1==7) => ORDER_STOP
-    simu_speed_step(vehicle_data, control_data);
-
-    CU_ASSERT_EQUAL(simu_curr_step, STEP7);
-    CU_ASSERT_EQUAL(simu_order, ORDER_STOP);
+    // 0 => 5 (accelerating) and 5 => 10 => accel=1, brake=0, gear=DRIVE
+    CU_ASSERT_EQUAL(vehicle_data[STEP1].accel, 1);
+    CU_ASSERT_EQUAL(vehicle_data[STEP1].brake, 0);
+    CU_ASSERT_EQUAL(vehicle_data[STEP1].gear, DRIVE);
+    CU_ASSERT_EQUAL(vehicle_data[STEP2].accel, 1);
+    CU_ASSERT_EQUAL(vehicle_data[STEP2].gear, DRIVE);
+
+    // 10 => 10 (constant speed) => accel=1, brake=0, gear=DRIVE
+    CU_ASSERT_EQUAL(vehicle_data[STEP3].accel, 1);
+    CU_ASSERT_EQUAL(vehicle_data[STEP3].brake, 0);
+    CU_ASSERT_EQUAL(vehicle_data[STEP3].gear, DRIVE);
+
+    // 10 => 5 and 5 => 0 (braking) => accel=0, brake=1, gear=DRIVE
+    CU_ASSERT_EQUAL(vehicle_data[STEP4].accel, 0);
+    CU_ASSERT_EQUAL(vehicle_data[STEP4].brake, 1);
+    CU_ASSERT_EQUAL(vehicle_data[STEP4].gear, DRIVE);
+    CU_ASSERT_EQUAL(vehicle_data[STEP5].brake, 1);
+    CU_ASSERT_EQUAL(vehicle_data[STEP5].gear, DRIVE);
+
+    // 0 => 0 (stopped) => accel=0, brake=1, gear=PARKING
+    CU_ASSERT_EQUAL(vehicle_data[STEP6].accel, 0);
+    CU_ASSERT_EQUAL(vehicle_data[STEP6].brake, 1);
+    CU_ASSERT_EQUAL(vehicle_data[STEP6].gear, PARKING);
 }
 
 //-------------------------------------
-// 9) Battery sensor simulator for SOC update
+// 8) Scheduler events: battery sample and step controls
 //-------------------------------------
-void test_sensor_battery_updates_soc_when_running(void)
+void test_scheduler_updates_battery_and_controls(void)
 {
-    // Set up simulation state
-    test_mode = false;
-    simu_state = STATE_RUNNING;
-    simu_curr_step = 0;
+    simu_order = ORDER_RUN;
+    CU_ASSERT_TRUE_FATAL(bcm_scheduler_init(&sched, -1, 0));
+    CU_ASSERT_TRUE_FATAL(data_size > 2);
 
-    // Initialize vehicle data and global battery state
-    vehicle_data[0].speed = SPEED_HIGH;
-    vehicle_data[0].batt_soc = TEST_BATT_SOC_INITIAL;
+    vehicle_data[0].speed = 0.0;
+    vehicle_data[1].speed = TEST_SPEED_INCREASE;
+    vehicle_data[2].speed = TEST_SPEED_INCREASE;
     batt_soc = TEST_BATT_SOC_INITIAL;
 
-    // Calculate expected SoC after one update
-    float expected_iterations = TEST_EXPECTED_IT; // if THREAD_SLEEP_TIME * 2 allows 2 iterations
-    double expected_soc = batt_soc + (BATTERY_SOC_INCREMENT * expected_iterations);
-    if (expected_soc > MAX_BATTERY_SOC)
-    {
-        expected_soc = MAX_BATTERY_SOC;
-    }
-
-    // Start the sensor thread
-    pthread_t thread_id;
-    pthread_create(&thread_id, NULL, sensor_battery, NULL);
-
-    // Wait for the thread to finish
-    pthread_join(thread_id, NULL);
-
-    // Get actual updated SoC
-    double actual_soc = vehicle_data[0].batt_soc;
-
-    // Assert the SoC was updated as expected
-    CU_ASSERT_DOUBLE_EQUAL(expected_soc, actual_soc, SOC_TOLERANCE);
+    // t=0: battery sample of step 0 (stationary), its controls, then publish
+    CU_ASSERT_EQUAL(bcm_scheduler_advance(&sched, 0), 3U);
+    CU_ASSERT_DOUBLE_EQUAL(vehicle_data[0].batt_soc,
+                           TEST_BATT_SOC_INITIAL - (BATTERY_SOC_DECREMENT * 5.0), SOC_TOLERANCE);
+    CU_ASSERT_EQUAL(vehicle_data[0].accel, 1);
+    CU_ASSERT_EQUAL(vehicle_data[0].brake, 0);
+    CU_ASSERT_EQUAL(vehicle_data[0].gear, DRIVE);
+    CU_ASSERT_EQUAL(simu_curr_step, 1);
+
+    // Half a period later the battery samples the moving step 1
+    const double soc_before = batt_soc;
+    CU_ASSERT_EQUAL(bcm_scheduler_advance(&sched, BCM_SCHED_BATTERY_MS), 1U);
+    CU_ASSERT_DOUBLE_EQUAL(vehicle_data[1].batt_soc, soc_before + BATTERY_SOC_INCREMENT, SOC_TOLERANCE);
+
+    bcm_scheduler_close(&sched);
+    simu_state = STATE_STOPPED;
+    simu_order = ORDER_STOP;
 }
 
 //-------------------------------------
-// 10) Speed simulator thread
+// 9) Health faults and the SWR6.4 watchdog
 //-------------------------------------
-void test_simu_speed_performs_control_update(void)
+/* Start the scheduler with the given fault on every row from step 1 on and
+   publish step 0, which samples row 1 */
+static void start_with_fault(int door_open, double engi_temp, double tilt_angle)
 {
-    // Arrange
-    test_mode = false;
-    simu_state = STATE_RUNNING;
-    simu_curr_step = 0;
     simu_order = ORDER_RUN;
-    data_size = 2;
-
-    VehicleData sim_data[2] = {0};
-
-    // Initial setup: speed increases between steps
-    sim_data[0].speed = 0.0;
-    sim_data[1].speed = TEST_SPEED_INCREASE;
-
-    // Initialize outputs (accel, brake, gear)
-    sim_data[0].accel = 0;
-    sim_data[0].brake = 0;
-    sim_data[0].gear = 0;
-
-    // Act: start the thread
-    pthread_t thread_id;
-    pthread_create(&thread_id, NULL, simu_speed, (void *)sim_data);
-
-    // Let it run one iteration
-    sleep_microseconds(THREAD_SLEEP_TIME);
-    test_mode = true;
-    pthread_join(thread_id, NULL);
-
-    // Assert: check that control actions were applied
-    CU_ASSERT_EQUAL(sim_data[0].accel, 1);
-    CU_ASSERT_EQUAL(sim_data[0].brake, 0);
-    CU_ASSERT_EQUAL(sim_data[0].gear, DRIVE); // assume DRIVE is a defined constant
+    CU_ASSERT_TRUE_FATAL(bcm_scheduler_init(&sched, -1, 0));
+    CU_ASSERT_TRUE_FATAL(data_size > FAULT_ROWS);
+    for (int i = 1; i < FAULT_ROWS; i++)
+    {
+        vehicle_data[i].door_open = door_open;
+        vehicle_data[i].engi_temp = engi_temp;
+        vehicle_data[i].tilt_angle = tilt_angle;
+    }
+    (void)bcm_scheduler_advance(&sched, 0);
 }
 
-//-------------------------------------
-// 11) Get time function
-//-------------------------------------
-void test_getCurrentTimeMsReal(void)
+/* Keep the fault just under safety_timeout_ms, then up to it: the system
+   is disabled and each fault logged */
+static void run_fault_to_disable(const char *log_path, const char *fault_log)
 {
-    // Grab the initial time in ms.
-    int before_ms = getCurrentTimeMs_real();
-    // Sleep for 100ms.
-    sleep_microseconds(TEST_MICRO_SLEEP_DELAY);
+    // Still under 2 seconds => not stopped
+    (void)bcm_scheduler_advance(&sched, safety_timeout_ms - 1);
+    CU_ASSERT_TRUE(fault_active);
+    CU_ASSERT_EQUAL(simu_order, ORDER_RUN);
 
-    int after_ms = getCurrentTimeMs_real();
+    // safety_timeout_ms after the onset => error_disabled, the run stops
+    (void)bcm_scheduler_advance(&sched, safety_timeout_ms);
+    CU_ASSERT_EQUAL(simu_order, ORDER_STOP);
+    CU_ASSERT_STRING_EQUAL(stub_can_get_last_message(), "error_disabled");
+
+    f_susbtring_data err_disab = { log_path, "Fault: SWR6.4 (System Disabling Error)" };
+    CU_ASSERT_TRUE(file_contains_substring(err_disab));
+    f_susbtring_data err_fault = { log_path, fault_log };
+    CU_ASSERT_TRUE(file_contains_substring(err_fault));
 
-    // Check that after_ms is at least ~100ms greater than before_ms.
-    // We use a small margin of error, since actual scheduling can vary slightly.
-    CU_ASSERT_TRUE((after_ms - before_ms) >= 80);
+    bcm_scheduler_close(&sched);
+    simu_state = STATE_STOPPED;
 }
 
-//-------------------------------------
-// 12) Check health signals
-//-------------------------------------
 /**
- * @test test_check_health_signals_immediate
- * @brief Simulates a fault and check health signals to identify a fault immedeatly.
+ * @test test_health_fault_immediate
+ * @brief Simulates a fault and checks that the watchdog identifies it as soon
+ * as the step is sampled, without disabling the system yet.
  * @req SWR6.1
  * @file unit/test_bcm.c
  */
-void test_check_health_signals_immediate(void)
+void test_health_fault_immediate(void)
 {
-    // Reset global states
-    fault_active = false;
-    fault_start_time = 0;
-    simu_curr_step = 0;
-    simu_state = STATE_RUNNING;
-    simu_order = ORDER_RUN;
+    VehicleData data = {0};
 
-    // We'll assume time starts at zero
-    mock_time_ms = 0;
+    data.door_open = DOOR_INVALID;
+    data.engi_temp = ENGI_TEMP_3;
+    data.tilt_angle = TILT_3;
+    CU_ASSERT_EQUAL(health_fault_flags(&data), HEALTH_FAULT_DOOR | HEALTH_FAULT_ENGINE_TEMP | HEALTH_FAULT_TILT);
 
-    // 1) Create a “doorVal” that is invalid => triggers `invalidDoor`
-    vehicle_data[0].door_open = DOOR_INVALID;  // invalid
-    vehicle_data[0].engi_temp = ENGI_TEMP_2; // normal
-    vehicle_data[0].tilt_angle = TILT_1; // normal
-
-    // 2) Call check_health_signals()
-    check_health_signals();
-
-    // 3) Since the fault is new, we expect:
-    //    fault_active == true, fault_start_time = 0, but system is NOT yet stopped
+    start_with_fault(DOOR_INVALID, ENGI_TEMP_2, TILT_1);
     CU_ASSERT_TRUE(fault_active);
-    CU_ASSERT_EQUAL(fault_start_time, 0);
+    CU_ASSERT_EQUAL(sched.watchdog.onset_ms, 0LL);
     CU_ASSERT_EQUAL(simu_order, ORDER_RUN); // not stopped yet
+
+    bcm_scheduler_close(&sched);
+    simu_state = STATE_STOPPED;
 }
 
 /**
- * @test test_check_health_signals_persisted
- * @brief Simulates a fault in the tilt angle and check health signals and after elapsing the safety time send the system disabled warning.
+ * @test test_health_fault_persisted
+ * @brief Simulates a fault in the tilt angle and after elapsing the safety time send the system disabled warning.
  * @req SWR6.1
  * @req SWR6.2
  * @req SWR6.3
  * @req SWR6.4
  * @file unit/test_bcm.c
  */
-void test_check_health_signals_persisted(void)
+void test_health_fault_persisted(void)
 {
-    set_log_file_path("/tmp/test_check_health_signals_persisted.log");
+    set_log_file_path("/tmp/test_health_fault_persisted.log");
     CU_ASSERT_TRUE_FATAL(init_logging_system());
 
-    // Reset global states
-    fault_active = false;
-    fault_start_time = 0;
-    simu_curr_step = 0;
-    simu_state = STATE_RUNNING;
-    simu_order = ORDER_RUN;
-
-    mock_time_ms = 0;
-
-    // 1) Create a “tilt_angle” that is above 60 => triggers `excessiveTilt`
-    vehicle_data[0].door_open = DOOR_VALID;   // normal
-    vehicle_data[0].engi_temp = ENGI_TEMP_1;  // normal
-    vehicle_data[0].tilt_angle = TILT_3; // triggers fault
-
-    // 2) First call sets fault_active = true, fault_start_time=0
-    check_health_signals();
-    CU_ASSERT_TRUE(fault_active);
-    CU_ASSERT_EQUAL(fault_start_time, 0);
-
-    // 3) Simulate time passing < safety_timeout_ms
-    mock_time_ms = MOCK_TIME_1S; // 1 second
-    check_health_signals();
-
-    // Still under 2 seconds => not stopped
-    CU_ASSERT_TRUE(fault_active);
-    CU_ASSERT_EQUAL(simu_order, ORDER_RUN);
-
-    // 4) Simulate time passing >= safety_timeout_ms (2 seconds)
-    mock_time_ms = MOCK_TIME_25S; // 2.5 seconds
-    check_health_signals();
-
-    // Now we expect the code to set simu_order = ORDER_STOP
-    CU_ASSERT_EQUAL(simu_order, ORDER_STOP);
-
-    f_susbtring_data err_disab = {
-        "/tmp/test_check_health_signals_persisted.log",
-        "Fault: SWR6.4 (System Disabling Error)"
-    };
-    CU_ASSERT_TRUE(file_contains_substring(err_disab));
-
-    f_susbtring_data err_tilt = {
-        "/tmp/test_check_health_signals_persisted.log",
-        "Fault: SWR6.4 (Excessive tilt value)"
-    };
-    CU_ASSERT_TRUE(file_contains_substring(err_tilt));
+    // tilt_angle above 60 => excessive tilt
+    start_with_fault(DOOR_VALID, ENGI_TEMP_1, TILT_3);
+    run_fault_to_disable("/tmp/test_health_fault_persisted.log", "Fault: SWR6.4 (Excessive tilt value)");
 
     cleanup_logging_system();
 }
 
 /**
- * @test test_check_health_signals_engine_temp
- * @brief Simulates a fault in the engine temperature and check health signals and after elapsing the safety time send the system disabled warning.
+ * @test test_health_fault_engine_temp
+ * @brief Simulates a fault in the engine temperature and after elapsing the safety time send the system disabled warning.
  * @req SWR6.3
  * @req SWR6.4
  * @file unit/test_bcm.c
  */
-void test_check_health_signals_engine_temp(void)
+void test_health_fault_engine_temp(void)
 {
-    set_log_file_path("/tmp/test_check_health_signals_engine_temp.log");
+    set_log_file_path("/tmp/test_health_fault_engine_temp.log");
     CU_ASSERT_TRUE_FATAL(init_logging_system());
 
-    // Reset global states
-    fault_active = false;
-    fault_start_time = 0;
-    simu_curr_step = 0;
-    simu_state = STATE_RUNNING;
-    simu_order = ORDER_RUN;
-
-    mock_time_ms = 0;
-
-    // 1) Create a engi_temp that is above 120 => triggers `engineOvertemp`
-    vehicle_data[0].door_open = DOOR_VALID;   // normal
-    vehicle_data[0].engi_temp = ENGI_TEMP_3;  // triggers fault
-    vehicle_data[0].tilt_angle = TILT_1; // normal
-
-    // 2) First call sets fault_active = true, fault_start_time=0
-    check_health_signals();
-    CU_ASSERT_TRUE(fault_active);
-    CU_ASSERT_EQUAL(fault_start_time, 0);
-
-    // 3) Simulate time passing < safety_timeout_ms
-    mock_time_ms = MOCK_TIME_1S; // 1 second
-    check_health_signals();
-
-    // Still under 2 seconds => not stopped
-    CU_ASSERT_TRUE(fault_active);
-    CU_ASSERT_EQUAL(simu_order, ORDER_RUN);
-
-    // 4) Simulate time passing >= safety_timeout_ms (2 seconds)
-    mock_time_ms = MOCK_TIME_25S; // 2.5 seconds
-    check_health_signals();
-
-    // Now we expect the code to set simu_order = ORDER_STOP
-    CU_ASSERT_EQUAL(simu_order, ORDER_STOP);
-
-    f_susbtring_data err_disab = {
-        "/tmp/test_check_health_signals_engine_temp.log",
-        "Fault: SWR6.4 (System Disabling Error)"
-    };
-    CU_ASSERT_TRUE(file_contains_substring(err_disab));
-
-    f_susbtring_data err_overtemp = {
-        "/tmp/test_check_health_signals_engine_temp.log",
-        "Fault: SWR6.4 (Engine overtemperature)"
-    };
-    CU_ASSERT_TRUE(file_contains_substring(err_overtemp));
+    // engi_temp above 120 => engine overtemperature
+    start_with_fault(DOOR_VALID, ENGI_TEMP_3, TILT_1);
+    run_fault_to_disable("/tmp/test_health_fault_engine_temp.log", "Fault: SWR6.4 (Engine overtemperature)");
 
     cleanup_logging_system();
 }
 
 /**
- * @test test_check_health_signals_door_status
- * @brief Simulates a fault in the door and check health signals and after elapsing the safety time send the system disabled warning.
+ * @test test_health_fault_door_status
+ * @brief Simulates a fault in the door and after elapsing the safety time send the system disabled warning.
  * @req SWR6.3
  * @req SWR6.4
  * @file unit/test_bcm.c
  */
-void test_check_health_signals_door_status(void)
+void test_health_fault_door_status(void)
 {
-    set_log_file_path("/tmp/test_check_health_signals_door_status.log");
+    set_log_file_path("/tmp/test_health_fault_door_status.log");
     CU_ASSERT_TRUE_FATAL(init_logging_system());
 
-    // Reset global states
-    fault_active = false;
-    fault_start_time = 0;
-    simu_curr_step = 0;
-    simu_state = STATE_RUNNING;
-    simu_order = ORDER_RUN;
-
-    mock_time_ms = 0;
-
-    // 1) Create an invalid door_open status => triggers `invalidDoor`
-    vehicle_data[0].door_open = DOOR_INVALID;   // triggers fault
-    vehicle_data[0].engi_temp = ENGI_TEMP_1;  // normal
-    vehicle_data[0].tilt_angle = TILT_1; // normal
-
-    // 2) First call sets fault_active = true, fault_start_time=0
-    check_health_signals();
-    CU_ASSERT_TRUE(fault_active);
-    CU_ASSERT_EQUAL(fault_start_time, 0);
-
-    // 3) Simulate time passing < safety_timeout_ms
-    mock_time_ms = MOCK_TIME_1S; // 1 second
-    check_health_signals();
-
-    // Still under 2 seconds => not stopped
-    CU_ASSERT_TRUE(fault_active);
-    CU_ASSERT_EQUAL(simu_order, ORDER_RUN);
-
-    // 4) Simulate time passing >= safety_timeout_ms (2 seconds)
-    mock_time_ms = MOCK_TIME_25S; // 2.5 seconds
-    check_health_signals();
-
-    // Now we expect the code to set simu_order = ORDER_STOP
-    CU_ASSERT_EQUAL(simu_order, ORDER_STOP);
-
-    f_susbtring_data err_disab = {
-        "/tmp/test_check_health_signals_door_status.log",
-        "Fault: SWR6.4 (System Disabling Error)"
-    };
-    CU_ASSERT_TRUE(file_contains_substring(err_disab));
-
-    f_susbtring_data err_door = {
-        "/tmp/test_check_health_signals_door_status.log",
-        "Fault: SWR6.4 (Invalid door status)"
-    };
-    CU_ASSERT_TRUE(file_contains_substring(err_door));
+    // Invalid door_open status
+    start_with_fault(DOOR_INVALID, ENGI_TEMP_1, TILT_1);
+    run_fault_to_disable("/tmp/test_health_fault_door_status.log", "Fault: SWR6.4 (Invalid door status)");
 
     cleanup_logging_system();
 }
 
 //-------------------------------------
-// 13)  comms() bounded‑loop verification
+// 10) Reception: frames fed to bcm_receive_frame
 //-------------------------------------
-void test_comms_thread_expected_iterations(void)
+/* Feed the whole mock frame sequence to bcm_receive_frame and parse what
+   completes, as the scheduler does; returns the last non-pending result */
+static BcmRxResult receive_mock_frames(void)
 {
-    /* -------- Arrange ------------------------------------------------- */
-    sem_init(&sem_comms, 0, TEST_EXPECTED_IT_INT);   /* pre‑post semaphore    */
-    pthread_mutex_init(&mutex_bcm, NULL);
-
-    stub_can_reset();
-
-    data_size      = 1;          /* a single VehicleData entry is enough */
-    simu_curr_step = 0;
-    simu_state     = STATE_RUNNING;
-    simu_order     = ORDER_RUN;
-    data_updated   = true;       /* first iteration will send immediately */
-
-    /* -------- Act ----------------------------------------------------- */
-    pthread_t tid;
-    pthread_create(&tid, NULL, comms, NULL);
-    pthread_join(tid, NULL);     /* loop finishes after TEST_EXPECTED_IT_INT */
+    struct can_frame frame;
+    char message[AES_BLOCK_SIZE + 1];
+    BcmRxResult last = BCM_RX_PENDING;
 
-    /* -------- Assert -------------------------------------------------- */
-
-    /* data_updated was cleared by the last iteration                 */
-    CU_ASSERT_FALSE(data_updated);
-
-    /* -------- Cleanup ------------------------------------------------- */
-    pthread_mutex_destroy(&mutex_bcm);
-    sem_destroy(&sem_comms);
+    (void)memset(&bcm_reassembler, 0, sizeof(bcm_reassembler));
+    while (receive_can_frame(MOCK_SOCKET, &frame) == 0)
+    {
+        const BcmRxResult result = bcm_receive_frame(&frame, message);
+        if (result == BCM_RX_MESSAGE)
+        {
+            parse_input_received_bcm(message);
+        }
+        if (result != BCM_RX_PENDING)
+        {
+            last = result;
+        }
+    }
+    return last;
 }
 
-//-------------------------------------
-// 14) Function to verify the need for halting the simulation
-//-------------------------------------
-void test_check_system_disable(void)
+static void test_receive_disable(void)
 {
     stub_can_reset();
+    simu_state = STATE_RUNNING;
+    simu_order = ORDER_RUN;
 
     mock_can_force_sys_disable(true);
-    
-    check_system_disable(MOCK_SOCKET);
-
+    CU_ASSERT_EQUAL(receive_mock_frames(), BCM_RX_MESSAGE);
     mock_can_force_sys_disable(false);
-    
+
+    CU_ASSERT_EQUAL(simu_order, ORDER_STOP);
     CU_ASSERT_EQUAL(stub_can_get_send_count(), 0);
+    clear_system_disable();
+    simu_state = STATE_STOPPED;
 }
 
 static void test_invalid_can_id_branch(void)
 {
-    /* start with clean counters ---------------------------------------- */
     stub_can_reset();
+    simu_order = ORDER_RUN;
 
-    /*  tell the stub: on 1st receive() give me an *invalid* CAN-ID  ---- */
+    // The first fragment comes with an ID the BCM does not listen to
     mock_can_force_invalid_id(true);
-
-    /* run the code under test ----------------------------------------- */
-    check_system_disable(MOCK_SOCKET);
-
-    /* reset to normal behaviour, so other tests keep original paths  */
+    CU_ASSERT_EQUAL(receive_mock_frames(), BCM_RX_MESSAGE);
     mock_can_force_invalid_id(false);
 
-    /* we only wanted to exercise the branch – nothing should have been
-       sent on the bus, so send counter must still be zero              */
+    // Any other message is ignored and nothing is sent on the bus
+    CU_ASSERT_EQUAL(simu_order, ORDER_RUN);
     CU_ASSERT_EQUAL(stub_can_get_send_count(), 0);
+    simu_order = ORDER_STOP;
 }
 
-static void test_system_disabled_path(void)
+static void test_rejected_message_not_parsed(void)
 {
     stub_can_reset();
     simu_state = STATE_RUNNING;
-    test_mode = false;
+    simu_order = ORDER_RUN;
 
+    /* the block decodes to "error_disabled" but fails authentication */
     mock_can_force_sys_disable(true);
+    mock_can_force_auth_failure(true);
 
-    check_system_disable(MOCK_SOCKET);
-    
-    CU_ASSERT_EQUAL(simu_order, STATE_STOPPED);
+    CU_ASSERT_EQUAL(receive_mock_frames(), BCM_RX_REJECTED);
+    CU_ASSERT_EQUAL(simu_order, ORDER_RUN);
+    CU_ASSERT_FALSE(system_disable_latched());
 
+    mock_can_force_auth_failure(false);
     mock_can_force_sys_disable(false);
+    simu_state = STATE_STOPPED;
+    simu_order = ORDER_STOP;
 }
 
-void test_comms_reception_thread_expected_iterations(void)
+/**
+ * @test test_disable_latched
+ * @brief error_disabled latches the disable, which keeps the simulation
+ * stopped whatever order comes next
+ * @req SWR6.4
+ * @file unit/test_bcm.c
+ */
+static void test_disable_latched(void)
 {
-    /* -------- Arrange ------------------------------------------------- */
-    sem_init(&sem_comms, 0, TEST_EXPECTED_IT_INT);   /* pre‑post semaphore    */
-    pthread_mutex_init(&mutex_bcm, NULL);
-
     stub_can_reset();
-
-    simu_state     = STATE_RUNNING;
+    clear_system_disable();
+    simu_state = STATE_RUNNING;
+    simu_order = ORDER_RUN;
     mock_can_force_sys_disable(true);
 
-    /* -------- Act ----------------------------------------------------- */
-    pthread_t tid;
-    pthread_create(&tid, NULL, comms_reception, NULL);
-    pthread_join(tid, NULL);
+    CU_ASSERT_EQUAL(receive_mock_frames(), BCM_RX_MESSAGE);
+    CU_ASSERT_TRUE(system_disable_latched());
+    CU_ASSERT_EQUAL(simu_order, ORDER_STOP);
 
-    /* -------- Assert -------------------------------------------------- */
+    // A later order does not override it, and no step is computed
+    simu_order = ORDER_RUN;
+    CU_ASSERT_TRUE_FATAL(bcm_scheduler_init(&sched, -1, 0));
+    CU_ASSERT_EQUAL(simu_state, STATE_STOPPED);
+    (void)bcm_scheduler_advance(&sched, BCM_SCHED_STEP_MS);
+    CU_ASSERT_EQUAL(sched.steps, 0UL);
+    CU_ASSERT_EQUAL(stub_can_get_send_count(), 0);
+    bcm_scheduler_close(&sched);
 
-    CU_ASSERT_EQUAL(simu_order, STATE_STOPPED);
+    clear_system_disable();
+    simu_state = STATE_PAUSED;
+    check_order(ORDER_RUN);
+    CU_ASSERT_EQUAL(simu_state, STATE_RUNNING);
 
-    /* -------- Cleanup ------------------------------------------------- */
     mock_can_force_sys_disable(false);
-    pthread_mutex_destroy(&mutex_bcm);
-    sem_destroy(&sem_comms);
+    simu_state = STATE_STOPPED;
+    simu_order = ORDER_STOP;
+    data_size = 0;
 }
 
 //-------------------------------------
@@ -900,20 +674,17 @@ int main(void)
     CU_add_test(suite, "battery over 100", test_battery_overmax);
     CU_add_test(suite, "battery below 0", test_battery_belowzero);
     CU_add_test(suite, "send_data_update many fields", test_send_data_update_manyfields);
-    CU_add_test(suite, "simu_speed small loop", test_simu_speed_smallloop);
-    CU_add_test(suite, "simu_speed_step direct call", test_simu_speed_step);
-    CU_add_test(suite, "sensor_battery_updates_soc_when_running", test_sensor_battery_updates_soc_when_running);
-    CU_add_test(suite, "simu_speed_performs_control_update", test_simu_speed_performs_control_update);
-    CU_add_test(suite, "getCurrentTimeMsReal", test_getCurrentTimeMsReal);
-    CU_add_test(suite, "check_health_signals_immediate", test_check_health_signals_immediate);
-    CU_add_test(suite, "check_health_signals_persisted", test_check_health_signals_persisted);
-    CU_add_test(suite, "check_health_signals_engine_temp", test_check_health_signals_engine_temp);
-    CU_add_test(suite, "check_health_signals_door_status", test_check_health_signals_door_status);
-    CU_add_test(suite, "comms expected iterations", test_comms_thread_expected_iterations);
-    CU_add_test(suite, "check_system_disable", test_check_system_disable);
+    CU_add_test(suite, "send_data_update delta only", test_send_data_update_delta_only);
+    CU_add_test(suite, "derive_step_controls", test_derive_step_controls);
+    CU_add_test(suite, "scheduler battery and controls", test_scheduler_updates_battery_and_controls);
+    CU_add_test(suite, "health_fault_immediate", test_health_fault_immediate);
+    CU_add_test(suite, "health_fault_persisted", test_health_fault_persisted);
+    CU_add_test(suite, "health_fault_engine_temp", test_health_fault_engine_temp);
+    CU_add_test(suite, "health_fault_door_status", test_health_fault_door_status);
+    CU_add_test(suite, "receive disable", test_receive_disable);
     CU_add_test(suite, "invalid_can_id_branch", test_invalid_can_id_branch);
-    CU_add_test(suite, "system_disabled_path", test_system_disabled_path);
-    CU_add_test(suite, "comms_reception_expected_iterations", test_comms_reception_thread_expected_iterations);
+    CU_add_test(suite, "rejected_message_not_parsed", test_rejected_message_not_parsed);
+    CU_add_test(suite, "disable latched", test_disable_latched);
 
     CU_basic_set_mode(CU_BRM_VERBOSE);
     CU_basic_run_tests();
@@ -0,0 +1,349 @@
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../../src/bcm/bcm_fleet.h"
+
+#define CYCLE_URBAN     "/tmp/unit_test_fleet_urban.csv"
+#define CYCLE_HIGHWAY   "/tmp/unit_test_fleet_highway.csv"
+#define CYCLE_FAULT     "/tmp/unit_test_fleet_fault.csv"
+#define CYCLE_STEPS     (6)
+#define STEP_MS         (1000LL)
+#define ID_STRIDE       (0x10U)
+#define MOCK_SOCKET     (999)
+#define RUN_MS          (20000LL)
+
+// Mocked can_socket calls
+int stub_can_get_send_count(void);
+int stub_can_get_last_can_id(void);
+const char *stub_can_get_last_message(void);
+void stub_can_reset(void);
+
+static BcmFleet fleet;
+
+static void write_cycle(const char *path, const char *rows)
+{
+    FILE *file = fopen(path, "w");
+    CU_ASSERT_PTR_NOT_NULL_FATAL(file);
+    (void)fputs("Time (seconds),Speed (km/h),Tilt Angle (deg),Internal Temp (C),"
+                "External Temp (C),Door Open,Engine Temp (C)\n", file);
+    (void)fputs(rows, file);
+    (void)fclose(file);
+}
+
+static int init_suite(void)
+{
+    // Seven rows: six steps plus the look-ahead row
+    write_cycle(CYCLE_URBAN,
+                "0,0.0,0.0,24,27,0,80.0\n1,5.0,0.0,24,27,0,80.0\n2,10.0,0.0,24,27,0,80.0\n"
+                "3,10.0,0.0,24,27,0,80.0\n4,5.0,0.0,24,27,0,80.0\n5,0.0,0.0,24,27,0,80.0\n"
+                "6,0.0,0.0,24,27,0,80.0\n");
+    write_cycle(CYCLE_HIGHWAY,
+                "0,90.0,0.0,24,27,0,90.0\n1,95.0,0.0,24,27,0,90.0\n2,100.0,0.0,24,27,0,90.0\n"
+                "3,100.0,0.0,24,27,0,90.0\n4,95.0,0.0,24,27,0,90.0\n5,90.0,0.0,24,27,0,90.0\n"
+                "6,90.0,0.0,24,27,0,90.0\n");
+    // Invalid door status from step 1 on
+    write_cycle(CYCLE_FAULT,
+                "0,0.0,0.0,24,27,0,80.0\n1,0.0,0.0,24,27,2,80.0\n2,0.0,0.0,24,27,2,80.0\n"
+                "3,0.0,0.0,24,27,2,80.0\n4,0.0,0.0,24,27,2,80.0\n5,0.0,0.0,24,27,2,80.0\n"
+                "6,0.0,0.0,24,27,2,80.0\n");
+    return 0;
+}
+
+static int clean_suite(void)
+{
+    (void)unlink(CYCLE_URBAN);
+    (void)unlink(CYCLE_HIGHWAY);
+    (void)unlink(CYCLE_FAULT);
+    return 0;
+}
+
+static BcmFleetConfig make_config(unsigned int count)
+{
+    BcmFleetConfig config;
+
+    (void)memset(&config, 0, sizeof(config));
+    config.count = count;
+    config.cycle_paths[0] = CYCLE_URBAN;
+    config.cycle_paths[1] = CYCLE_HIGHWAY;
+    config.num_cycles = 2U;
+    config.socks[0] = MOCK_SOCKET;
+    config.num_socks = 1U;
+    config.can_id_stride = ID_STRIDE;
+    config.step_ms = STEP_MS;
+    return config;
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: each vehicle gets its own cycle, CAN IDs, phase and battery model
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_fleet_independent_vehicles
+ * @brief Runs three vehicles from one timer wheel and checks that each follows
+ * its own drive cycle on its own CAN IDs
+ * @req SWR2.1
+ * @file unit/test_bcm_fleet.c
+ */
+static void test_fleet_independent_vehicles(void)
+{
+    BcmFleetConfig config = make_config(3U);
+
+    stub_can_reset();
+    CU_ASSERT_TRUE_FATAL(bcm_fleet_init(&fleet, &config, 0));
+    CU_ASSERT_EQUAL(fleet.count, 3U);
+    CU_ASSERT_EQUAL(fleet.running, 3U);
+    CU_ASSERT_EQUAL(fleet.vehicles[0].cycle_size, CYCLE_STEPS);
+    CU_ASSERT_EQUAL(fleet.vehicles[2].sensor_can_id, CAN_ID_SENSOR_READ + (2U * ID_STRIDE));
+    CU_ASSERT_EQUAL(fleet.vehicles[2].command_can_id, CAN_ID_COMMAND + (2U * ID_STRIDE));
+    CU_ASSERT_EQUAL(fleet.vehicles[1].cycle[0].temp_set, (int)DEFAULT_SET_TEMP);
+
+    // Only vehicle 0 is due at t=0; the others are phase-shifted
+    CU_ASSERT_EQUAL(bcm_fleet_advance(&fleet, 0), 2U);
+    CU_ASSERT_EQUAL(stub_can_get_send_count(), 1);
+    CU_ASSERT_EQUAL(stub_can_get_last_can_id(), (int)CAN_ID_SENSOR_READ);
+    CU_ASSERT_EQUAL(fleet.vehicles[0].published, 1UL);
+    CU_ASSERT_EQUAL(fleet.vehicles[1].published, 0UL);
+
+    CU_ASSERT_EQUAL(bcm_fleet_advance(&fleet, STEP_MS / 3), 2U);
+    CU_ASSERT_EQUAL(stub_can_get_last_can_id(), (int)(CAN_ID_SENSOR_READ + ID_STRIDE));
+    CU_ASSERT_EQUAL(fleet.vehicles[1].published, 1UL);
+
+    (void)bcm_fleet_advance(&fleet, RUN_MS);
+    CU_ASSERT_EQUAL(fleet.running, 0U);
+    for (unsigned int i = 0U; i < fleet.count; i++)
+    {
+        CU_ASSERT_EQUAL(fleet.vehicles[i].published, (unsigned long)CYCLE_STEPS);
+        CU_ASSERT_EQUAL(fleet.vehicles[i].laps, 1UL);
+        CU_ASSERT_FALSE(fleet.vehicles[i].running);
+    }
+
+    // Controls derived per vehicle from its own speed profile
+    CU_ASSERT_EQUAL(fleet.vehicles[0].cycle[0].accel, 1);
+    CU_ASSERT_EQUAL(fleet.vehicles[0].cycle[3].brake, 1);
+    CU_ASSERT_EQUAL(fleet.vehicles[0].cycle[4].gear, DRIVE);
+    CU_ASSERT_EQUAL(fleet.vehicles[1].cycle[0].gear, DRIVE);
+
+    // Urban vehicle idles part of the time, the highway one always charges
+    CU_ASSERT_TRUE(fleet.vehicles[1].batt_soc > DEFAULT_BATTERY_SOC);
+    CU_ASSERT_TRUE(fleet.vehicles[0].batt_soc < fleet.vehicles[1].batt_soc);
+    CU_ASSERT_DOUBLE_EQUAL(fleet.vehicles[0].batt_soc, fleet.vehicles[2].batt_soc, 1e-9);
+    CU_ASSERT_TRUE(fleet.vehicles[1].cycle[2].batt_soc > DEFAULT_BATTERY_SOC);
+
+    bcm_fleet_free(&fleet);
+    CU_ASSERT_EQUAL(fleet.count, 0U);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: a persisting fault disables only the vehicle it belongs to
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_fleet_fault_per_vehicle
+ * @brief An invalid door status held past the safety timeout stops that
+ * vehicle and is reported on its command ID; the other vehicle carries on
+ * @req SWR6.1
+ * @req SWR6.4
+ * @file unit/test_bcm_fleet.c
+ */
+static void test_fleet_fault_per_vehicle(void)
+{
+    BcmFleetConfig config = make_config(2U);
+    config.cycle_paths[1] = CYCLE_FAULT;
+
+    stub_can_reset();
+    CU_ASSERT_TRUE_FATAL(bcm_fleet_init(&fleet, &config, 0));
+
+    // Fault seen after step 0 (t=500), its deadline two seconds later
+    (void)bcm_fleet_advance(&fleet, 2499);
+    CU_ASSERT_TRUE(fleet.vehicles[1].running);
+    CU_ASSERT_TRUE(health_watchdog_active(&fleet.vehicles[1].watchdog));
+    (void)bcm_fleet_advance(&fleet, 2500);
+    CU_ASSERT_FALSE(fleet.vehicles[1].running);
+    CU_ASSERT_STRING_EQUAL(stub_can_get_last_message(), "error_disabled");
+    CU_ASSERT_EQUAL(stub_can_get_last_can_id(), (int)(CAN_ID_COMMAND + ID_STRIDE));
+    CU_ASSERT_EQUAL(fleet.vehicles[1].fault_ms, 2500LL);
+    // The deadline comes before the step due at the same time
+    CU_ASSERT_EQUAL(fleet.vehicles[1].published, 2UL);
+    CU_ASSERT_EQUAL(fleet.running, 1U);
+
+    (void)bcm_fleet_advance(&fleet, RUN_MS);
+    CU_ASSERT_EQUAL(fleet.vehicles[0].laps, 1UL);
+    CU_ASSERT_FALSE(health_watchdog_active(&fleet.vehicles[0].watchdog));
+    CU_ASSERT_EQUAL(fleet.vehicles[1].laps, 0UL);
+    bcm_fleet_free(&fleet);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: looping cycles, scaled step period, configuration errors
+ * ---------------------------------------------------------------------------*/
+static void test_fleet_loop_and_config(void)
+{
+    BcmFleetConfig config = make_config(4U);
+    config.loop = true;
+    config.step_ms = STEP_MS / 10;
+
+    stub_can_reset();
+    CU_ASSERT_TRUE_FATAL(bcm_fleet_init(&fleet, &config, 0));
+    (void)bcm_fleet_advance(&fleet, RUN_MS / 10);
+    CU_ASSERT_EQUAL(fleet.running, 4U);
+    CU_ASSERT_TRUE(fleet.vehicles[3].laps >= 3UL);
+    CU_ASSERT_EQUAL(fleet.vehicles[0].published, 21UL);
+    CU_ASSERT_EQUAL(timer_wheel_next_expiry(&fleet.wheel), (RUN_MS / 10) + 25);
+    // The safety timeout scales with the step period unless it is set
+    CU_ASSERT_EQUAL(fleet.vehicles[0].watchdog.timeout_ms, (long long)safety_timeout_ms / 10);
+    bcm_fleet_free(&fleet);
+    CU_ASSERT_EQUAL(fleet.wheel.armed, 0U);
+
+    config = make_config(2U);
+    config.can_id_stride = 1U;      // Vehicle 1 sensor ID = vehicle 0 command ID
+    CU_ASSERT_FALSE(bcm_fleet_init(&fleet, &config, 0));
+    config = make_config(FLEET_MAX_VEHICLES + 1U);
+    CU_ASSERT_FALSE(bcm_fleet_init(&fleet, &config, 0));
+    config = make_config(64U);
+    config.can_id_stride = 0x20U;   // Runs past the 11-bit identifier range
+    CU_ASSERT_FALSE(bcm_fleet_init(&fleet, &config, 0));
+    config = make_config(2U);
+    config.step_ms = FLEET_TICK_MS - 1;
+    CU_ASSERT_FALSE(bcm_fleet_init(&fleet, &config, 0));
+    config = make_config(2U);
+    config.cycle_paths[1] = "/tmp/unit_test_fleet_missing.csv";
+    CU_ASSERT_FALSE(bcm_fleet_init(&fleet, &config, 0));
+    CU_ASSERT_EQUAL(fleet.count, 0U);
+    CU_ASSERT_EQUAL(fleet.wheel.armed, 0U);
+
+    // Same IDs on every vehicle is allowed (separate interfaces)
+    config = make_config(2U);
+    config.can_id_stride = 0U;
+    CU_ASSERT_TRUE(bcm_fleet_init(&fleet, &config, 0));
+    CU_ASSERT_EQUAL(fleet.vehicles[1].sensor_can_id, CAN_ID_SENSOR_READ);
+    bcm_fleet_free(&fleet);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: a readable stop descriptor ends the run between two events
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_fleet_run_stop
+ * @brief bcm_fleet_run returns as soon as its stop descriptor is readable,
+ * without waiting for the next step, and leaves the vehicles as they were
+ * @file unit/test_bcm_fleet.c
+ */
+static void test_fleet_run_stop(void)
+{
+    BcmFleetConfig config = make_config(2U);
+    int pipe_fds[2];
+
+    config.loop = true;
+    stub_can_reset();
+    CU_ASSERT_EQUAL_FATAL(pipe(pipe_fds), 0);
+    CU_ASSERT_TRUE_FATAL(bcm_fleet_init(&fleet, &config, timer_wheel_now_ms()));
+    CU_ASSERT_EQUAL(write(pipe_fds[1], "x", 1), 1);
+
+    const long long start_ms = timer_wheel_now_ms();
+    bcm_fleet_run(&fleet, pipe_fds[0]);
+    CU_ASSERT_TRUE((timer_wheel_now_ms() - start_ms) < STEP_MS);
+    CU_ASSERT_EQUAL(fleet.running, 2U);
+    bcm_fleet_free(&fleet);
+    (void)close(pipe_fds[0]);
+    (void)close(pipe_fds[1]);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: checkpoint a fleet and resume it in a new one
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_fleet_checkpoint_resume
+ * @brief A fleet re-created from the same configuration resumes every vehicle
+ * at the step, battery and counters it was saved with; a vehicle disabled by
+ * its watchdog stays stopped, and a snapshot of another fleet size is refused
+ * @req SWR6.4
+ * @file unit/test_bcm_fleet.c
+ */
+static void test_fleet_checkpoint_resume(void)
+{
+    BcmFleetConfig config = make_config(2U);
+    Checkpoint checkpoint;
+    const long long resume_ms = 10LL * STEP_MS;
+
+    config.cycle_paths[1] = CYCLE_FAULT;
+    CU_ASSERT_EQUAL(setenv(CHECKPOINT_DIR_ENV, "/tmp", 1), 0);
+    CU_ASSERT_TRUE_FATAL(checkpoint_init(&checkpoint, "unit_test_bcm_fleet"));
+    (void)unlink(checkpoint.path);
+
+    stub_can_reset();
+    CU_ASSERT_TRUE_FATAL(bcm_fleet_init(&fleet, &config, 0));
+    (void)bcm_fleet_advance(&fleet, 2500);
+    CU_ASSERT_FALSE(fleet.vehicles[1].running);
+    CU_ASSERT_EQUAL(fleet.vehicles[0].step, 3);
+    const double saved_soc = fleet.vehicles[0].batt_soc;
+    const unsigned int saved_flags = fleet.vehicles[1].fault_flags;
+    CU_ASSERT_TRUE_FATAL(bcm_fleet_checkpoint(&fleet, &checkpoint, 2500));
+    bcm_fleet_free(&fleet);
+
+    CU_ASSERT_TRUE_FATAL(bcm_fleet_init(&fleet, &config, resume_ms));
+    CU_ASSERT_TRUE(bcm_fleet_restore(&fleet, &checkpoint, resume_ms));
+    CU_ASSERT_EQUAL(fleet.running, 1U);
+    CU_ASSERT_TRUE(fleet.vehicles[0].running);
+    CU_ASSERT_EQUAL(fleet.vehicles[0].step, 3);
+    CU_ASSERT_EQUAL(fleet.vehicles[0].published, 3UL);
+    CU_ASSERT_DOUBLE_EQUAL(fleet.vehicles[0].batt_soc, saved_soc, 1e-12);
+    CU_ASSERT_FALSE(fleet.vehicles[1].running);
+    CU_ASSERT_EQUAL(fleet.vehicles[1].fault_flags, saved_flags);
+    CU_ASSERT_FALSE(health_watchdog_active(&fleet.vehicles[1].watchdog));
+
+    // Vehicle 0 finishes the three steps it had left
+    (void)bcm_fleet_advance(&fleet, resume_ms + RUN_MS);
+    CU_ASSERT_EQUAL(fleet.vehicles[0].published, (unsigned long)CYCLE_STEPS);
+    CU_ASSERT_EQUAL(fleet.vehicles[0].laps, 1UL);
+    CU_ASSERT_EQUAL(fleet.vehicles[1].published, 2UL);
+    CU_ASSERT_TRUE(bcm_fleet_checkpoint(&fleet, &checkpoint, resume_ms + RUN_MS));
+    bcm_fleet_free(&fleet);
+
+    // Nothing left running in that snapshot: the next fleet starts over
+    CU_ASSERT_TRUE_FATAL(bcm_fleet_init(&fleet, &config, 0));
+    CU_ASSERT_FALSE(bcm_fleet_restore(&fleet, &checkpoint, 0));
+    CU_ASSERT_EQUAL(fleet.vehicles[0].step, 0);
+    CU_ASSERT_EQUAL(fleet.running, 2U);
+    // A snapshot of two vehicles does not fit a fleet of three
+    (void)bcm_fleet_advance(&fleet, STEP_MS);
+    CU_ASSERT_TRUE(bcm_fleet_checkpoint(&fleet, &checkpoint, STEP_MS));
+    bcm_fleet_free(&fleet);
+    config = make_config(3U);
+    CU_ASSERT_TRUE_FATAL(bcm_fleet_init(&fleet, &config, 0));
+    CU_ASSERT_FALSE(bcm_fleet_restore(&fleet, &checkpoint, 0));
+    CU_ASSERT_EQUAL(fleet.running, 3U);
+    bcm_fleet_free(&fleet);
+
+    (void)unlink(checkpoint.path);
+    (void)unsetenv(CHECKPOINT_DIR_ENV);
+}
+
+int main(void)
+{
+    if (CUE_SUCCESS != CU_initialize_registry()) {
+        return CU_get_error();
+    }
+
+    CU_pSuite suite = CU_add_suite("BCM Fleet Test Suite", init_suite, clean_suite);
+    if (!suite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Add tests */
+    CU_add_test(suite, "independent vehicles",  test_fleet_independent_vehicles);
+    CU_add_test(suite, "fault per vehicle",     test_fleet_fault_per_vehicle);
+    CU_add_test(suite, "loop and config",       test_fleet_loop_and_config);
+    CU_add_test(suite, "run stop",              test_fleet_run_stop);
+    CU_add_test(suite, "checkpoint resume",     test_fleet_checkpoint_resume);
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+    unsigned int fails = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return (fails == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
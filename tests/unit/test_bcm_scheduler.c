@@ -0,0 +1,316 @@
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../../src/bcm/bcm_scheduler.h"
+
+#define STEP_MS         (1000LL)
+#define MAX_POLLS       (50)
+#define POLL_WAIT_MS    (100)
+#define SHORT_CYCLE     (13)
+
+// Mocked can_socket calls
+int stub_can_get_send_count(void);
+int stub_can_get_last_can_id(void);
+const char *stub_can_get_last_message(void);
+void mock_can_force_sys_disable(bool enable);
+void stub_can_reset(void);
+
+static BcmScheduler sched;
+
+static int init_suite(void)
+{
+    simu_state = STATE_STOPPED;
+    simu_order = ORDER_RUN;
+    simu_curr_step = 0;
+    data_size = 0;
+    batt_soc = DEFAULT_BATTERY_SOC;
+    batt_volt = DEFAULT_BATTERY_VOLTAGE;
+    clear_system_disable();
+    stub_can_reset();
+    return 0;
+}
+static int clean_suite(void) { return 0; }
+
+/* -----------------------------------------------------------------------------
+ * Test: battery, step and publish fire in order, once per period
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_scheduler_step_order
+ * @brief Drives the single-threaded BCM loop on simulated time and checks that
+ * each step is published exactly once per period with the data computed for it
+ * @req SWR2.1
+ * @file unit/test_bcm_scheduler.c
+ */
+static void test_scheduler_step_order(void)
+{
+    LiveState live;
+    LiveState monitor;
+    LiveSignals mirrored;
+
+    CU_ASSERT_TRUE_FATAL(bcm_scheduler_init(&sched, -1, 0));
+    CU_ASSERT_TRUE_FATAL(live_state_create(&live, "unit_test_bcm_sched"));
+    CU_ASSERT_TRUE_FATAL(live_state_attach(&monitor, "unit_test_bcm_sched"));
+    sched.live = &live;
+    CU_ASSERT_EQUAL(simu_state, STATE_RUNNING);
+    CU_ASSERT_TRUE_FATAL(data_size > SHORT_CYCLE);
+    CU_ASSERT_EQUAL(vehicle_data[0].temp_set, (int)DEFAULT_SET_TEMP);
+
+    // t=0: battery sample, step 0 computed, then published
+    CU_ASSERT_EQUAL(bcm_scheduler_advance(&sched, 0), 3U);
+    CU_ASSERT_EQUAL(stub_can_get_send_count(), 1);
+    CU_ASSERT_EQUAL(stub_can_get_last_can_id(), (int)CAN_ID_SENSOR_READ);
+    CU_ASSERT_EQUAL(simu_curr_step, 1);
+    CU_ASSERT_DOUBLE_EQUAL(vehicle_data[0].batt_soc, batt_soc, 1e-9);
+    CU_ASSERT_FALSE(data_updated);
+
+    // The step put on the bus is mirrored to the live state segment
+    CU_ASSERT_TRUE(live_state_read(&monitor, &mirrored));
+    CU_ASSERT_EQUAL(mirrored.updates, 1U);
+    CU_ASSERT_EQUAL(mirrored.step, 0);
+    CU_ASSERT_EQUAL(mirrored.present, LIVE_HAS_SIGNALS | LIVE_HAS_FAULTS | LIVE_HAS_STEP);
+    CU_ASSERT_DOUBLE_EQUAL(mirrored.speed, vehicle_data[0].speed, 1e-9);
+    CU_ASSERT_EQUAL(mirrored.fault_flags, health_fault_flags(&vehicle_data[0]));
+
+    // Mid-period: only the battery sample for the new step
+    CU_ASSERT_EQUAL(bcm_scheduler_advance(&sched, STEP_MS - 1), 1U);
+    CU_ASSERT_EQUAL(simu_curr_step, 1);
+    CU_ASSERT_DOUBLE_EQUAL(vehicle_data[1].batt_soc, batt_soc, 1e-9);
+
+    (void)bcm_scheduler_advance(&sched, 10 * STEP_MS);
+    CU_ASSERT_EQUAL(simu_curr_step, 11);
+    CU_ASSERT_EQUAL(sched.steps, 11UL);
+
+    // End of the cycle: the last step is published, then the simulation stops
+    data_size = SHORT_CYCLE;
+    (void)bcm_scheduler_advance(&sched, 20 * STEP_MS);
+    CU_ASSERT_EQUAL(simu_curr_step, SHORT_CYCLE);
+    CU_ASSERT_EQUAL(simu_state, STATE_STOPPED);
+    CU_ASSERT_EQUAL(sched.steps, (unsigned long)SHORT_CYCLE);
+    CU_ASSERT_TRUE(live_state_read(&monitor, &mirrored));
+    CU_ASSERT_EQUAL(mirrored.step, SHORT_CYCLE - 1);
+    CU_ASSERT_EQUAL(mirrored.updates, (uint64_t)SHORT_CYCLE);
+    live_state_close(&monitor);
+    live_state_close(&live);
+
+    bcm_scheduler_close(&sched);
+    CU_ASSERT_EQUAL(sched.epoll_fd, -1);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: timerfd and reception share the loop; a disable order stops the run
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_scheduler_receive_disable
+ * @brief A system disable message read by the loop stops the simulation at the
+ * next step, without blocking the timers
+ * @req SWR6.4
+ * @file unit/test_bcm_scheduler.c
+ */
+static void test_scheduler_receive_disable(void)
+{
+    int pipe_fds[2];
+
+    init_suite();
+    CU_ASSERT_EQUAL_FATAL(pipe(pipe_fds), 0);
+    // The mock ignores the descriptor; the pipe only makes epoll report it readable
+    CU_ASSERT_EQUAL(write(pipe_fds[1], "x", 1), 1);
+    mock_can_force_sys_disable(true);
+
+    CU_ASSERT_TRUE_FATAL(bcm_scheduler_init(&sched, pipe_fds[0], timer_wheel_now_ms()));
+    for (int i = 0; (i < MAX_POLLS) && ((sched.messages == 0UL) || (sched.steps == 0UL)); i++)
+    {
+        CU_ASSERT_TRUE(bcm_scheduler_poll(&sched, POLL_WAIT_MS));
+    }
+    CU_ASSERT_EQUAL(sched.messages, 1UL);
+    CU_ASSERT_TRUE(sched.frames >= (unsigned long)(CAN_FRAGS_PER_MSG + 3U));
+    CU_ASSERT_TRUE(sched.steps >= 1UL);
+    CU_ASSERT_EQUAL(simu_order, ORDER_STOP);
+    CU_ASSERT_TRUE(system_disable_latched());
+
+    // Writer gone: the socket is dropped from the loop, the timers keep going
+    (void)close(pipe_fds[1]);
+    for (int i = 0; (i < MAX_POLLS) && (sched.sock_recv >= 0); i++)
+    {
+        CU_ASSERT_TRUE(bcm_scheduler_poll(&sched, POLL_WAIT_MS));
+    }
+    CU_ASSERT_EQUAL(sched.sock_recv, -1);
+    CU_ASSERT_TRUE(bcm_scheduler_poll(&sched, 0));
+
+    bcm_scheduler_close(&sched);
+    (void)close(pipe_fds[0]);
+    mock_can_force_sys_disable(false);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: the safety watchdog fires at its deadline
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_scheduler_watchdog_disable
+ * @brief A door fault first sampled when step 2 is published is reported
+ * exactly safety_timeout_ms later from the timer wheel, and the next step
+ * finds the simulation stopped
+ * @req SWR6.4
+ * @file unit/test_bcm_scheduler.c
+ */
+static void test_scheduler_watchdog_disable(void)
+{
+    init_suite();
+    CU_ASSERT_TRUE_FATAL(bcm_scheduler_init(&sched, -1, 0));
+    CU_ASSERT_TRUE_FATAL(data_size > SHORT_CYCLE);
+    for (int i = 3; i < SHORT_CYCLE; i++)
+    {
+        vehicle_data[i].door_open = 3;
+    }
+
+    // Row 3 is sampled once step 2 is published, at t=2000
+    (void)bcm_scheduler_advance(&sched, 2LL * STEP_MS);
+    CU_ASSERT_TRUE(fault_active);
+    CU_ASSERT_EQUAL(timer_wheel_next_expiry(&sched.wheel), 2LL * STEP_MS + BCM_SCHED_BATTERY_MS);
+    (void)bcm_scheduler_advance(&sched, 2LL * STEP_MS + safety_timeout_ms - 1);
+    CU_ASSERT_NOT_EQUAL(strcmp(stub_can_get_last_message(), "error_disabled"), 0);
+    CU_ASSERT_EQUAL(simu_state, STATE_RUNNING);
+
+    (void)bcm_scheduler_advance(&sched, 2LL * STEP_MS + safety_timeout_ms);
+    CU_ASSERT_STRING_EQUAL(stub_can_get_last_message(), "error_disabled");
+    CU_ASSERT_EQUAL(stub_can_get_last_can_id(), (int)CAN_ID_COMMAND);
+    CU_ASSERT_EQUAL(simu_state, STATE_STOPPED);
+    CU_ASSERT_EQUAL(sched.steps, 4UL);
+    CU_ASSERT_FALSE(health_watchdog_active(&sched.watchdog));
+
+    bcm_scheduler_close(&sched);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: a readable stop descriptor ends the loop
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_scheduler_stop_fd
+ * @brief bcm_scheduler_run watches its stop descriptor in the epoll set and
+ * returns on the wake-up that reports it, well before the next step, then
+ * drops it from the set
+ * @file unit/test_bcm_scheduler.c
+ */
+static void test_scheduler_stop_fd(void)
+{
+    int pipe_fds[2];
+
+    init_suite();
+    CU_ASSERT_EQUAL_FATAL(pipe(pipe_fds), 0);
+    CU_ASSERT_EQUAL(write(pipe_fds[1], "x", 1), 1);
+    CU_ASSERT_TRUE_FATAL(bcm_scheduler_init(&sched, -1, timer_wheel_now_ms()));
+
+    const long long start_ms = timer_wheel_now_ms();
+    bcm_scheduler_run(&sched, pipe_fds[0]);
+    CU_ASSERT_TRUE((timer_wheel_now_ms() - start_ms) < BCM_SCHED_STEP_MS);
+    CU_ASSERT_TRUE(sched.stopping);
+    CU_ASSERT_EQUAL(sched.stop_fd, -1);
+
+    bcm_scheduler_close(&sched);
+    (void)close(pipe_fds[0]);
+    (void)close(pipe_fds[1]);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: checkpoint and resume a run
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_scheduler_checkpoint_resume
+ * @brief A snapshot taken mid-cycle resumes in a fresh scheduler at the same
+ * step, with the cycle rows, battery and the fault condition it had: the
+ * watchdog deadline keeps its distance from the original onset. A snapshot
+ * of a stopped run is not resumed.
+ * @req SWR6.4
+ * @file unit/test_bcm_scheduler.c
+ */
+static void test_scheduler_checkpoint_resume(void)
+{
+    Checkpoint checkpoint;
+    const long long resume_ms = 100LL * STEP_MS;
+
+    init_suite();
+    CU_ASSERT_EQUAL(setenv(CHECKPOINT_DIR_ENV, "/tmp", 1), 0);
+    CU_ASSERT_TRUE_FATAL(checkpoint_init(&checkpoint, "unit_test_bcm_sched"));
+    (void)unlink(checkpoint.path);
+
+    CU_ASSERT_TRUE_FATAL(bcm_scheduler_init(&sched, -1, 0));
+    CU_ASSERT_TRUE_FATAL(data_size > SHORT_CYCLE);
+    for (int i = 6; i < SHORT_CYCLE; i++)
+    {
+        vehicle_data[i].door_open = 3;
+    }
+    // Row 6 is sampled once step 5 is published, at t=5000
+    (void)bcm_scheduler_advance(&sched, 6LL * STEP_MS);
+    CU_ASSERT_EQUAL_FATAL(simu_curr_step, 7);
+    CU_ASSERT_TRUE(fault_active);
+    const double saved_soc = batt_soc;
+    const double saved_row_soc = vehicle_data[3].batt_soc;
+    const int saved_size = data_size;
+    CU_ASSERT_TRUE_FATAL(bcm_scheduler_checkpoint(&sched, &checkpoint, 6LL * STEP_MS));
+    bcm_scheduler_close(&sched);
+
+    // A new process: the cycle is loaded afresh from step 0
+    init_suite();
+    CU_ASSERT_TRUE_FATAL(bcm_scheduler_init(&sched, -1, resume_ms));
+    CU_ASSERT_EQUAL(simu_curr_step, 0);
+    CU_ASSERT_TRUE(bcm_scheduler_restore(&sched, &checkpoint, resume_ms));
+    CU_ASSERT_EQUAL(checkpoint.sequence, 1U);
+    CU_ASSERT_EQUAL(simu_curr_step, 7);
+    CU_ASSERT_EQUAL(data_size, saved_size);
+    CU_ASSERT_EQUAL(simu_state, STATE_RUNNING);
+    CU_ASSERT_EQUAL(sched.steps, 7UL);
+    CU_ASSERT_DOUBLE_EQUAL(batt_soc, saved_soc, 1e-12);
+    CU_ASSERT_DOUBLE_EQUAL(vehicle_data[3].batt_soc, saved_row_soc, 1e-12);
+    CU_ASSERT_EQUAL(vehicle_data[6].door_open, 3);
+    CU_ASSERT_TRUE(fault_active);
+    CU_ASSERT_EQUAL(sched.watchdog.timer.expires_ms, resume_ms + safety_timeout_ms - STEP_MS);
+
+    // The run goes on from there and the disable comes on time
+    (void)bcm_scheduler_advance(&sched, resume_ms + safety_timeout_ms - STEP_MS);
+    CU_ASSERT_STRING_EQUAL(stub_can_get_last_message(), "error_disabled");
+
+    // Stopped (here by the disable): the next start is a fresh run
+    (void)bcm_scheduler_advance(&sched, resume_ms + safety_timeout_ms);
+    CU_ASSERT_EQUAL(simu_state, STATE_STOPPED);
+    CU_ASSERT_TRUE(bcm_scheduler_checkpoint(&sched, &checkpoint, resume_ms + safety_timeout_ms));
+    bcm_scheduler_close(&sched);
+    init_suite();
+    CU_ASSERT_TRUE_FATAL(bcm_scheduler_init(&sched, -1, 0));
+    CU_ASSERT_FALSE(bcm_scheduler_restore(&sched, &checkpoint, 0));
+    CU_ASSERT_EQUAL(simu_curr_step, 0);
+    bcm_scheduler_close(&sched);
+
+    (void)unlink(checkpoint.path);
+    (void)unsetenv(CHECKPOINT_DIR_ENV);
+}
+
+int main(void)
+{
+    if (CUE_SUCCESS != CU_initialize_registry()) {
+        return CU_get_error();
+    }
+
+    CU_pSuite suite = CU_add_suite("BCM Scheduler Test Suite", init_suite, clean_suite);
+    if (!suite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Add tests */
+    CU_add_test(suite, "step order",            test_scheduler_step_order);
+    CU_add_test(suite, "receive disable",       test_scheduler_receive_disable);
+    CU_add_test(suite, "watchdog disable",      test_scheduler_watchdog_disable);
+    CU_add_test(suite, "stop fd",               test_scheduler_stop_fd);
+    CU_add_test(suite, "checkpoint resume",     test_scheduler_checkpoint_resume);
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+    unsigned int fails = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return (fails == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
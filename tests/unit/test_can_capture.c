@@ -0,0 +1,186 @@
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../../src/common_includes/can_socket.h"
+#include "../../src/common_includes/can_capture.h"
+
+#define TEST_CAPTURE_PATH   "/tmp/unit_test_capture.bin"
+#define TEST_IFACE          "vcan0"
+#define TEST_FRAMES         (3U)
+#define TEST_BASE_NS        (1700000000123456789ULL)
+#define TEST_GAP_NS         (50000000ULL)       // 50 ms between recorded frames
+#define TEST_SPEED          (10.0)
+#define TEST_MIN_ELAPSED_NS (9000000LL)         // 2 gaps at 10x, minus slack
+#define NSEC_PER_SEC        (1000000000LL)
+
+/* Suite init/cleanup (no special steps here) */
+static int init_suite(void)  { return 0; }
+static int clean_suite(void) { (void)unlink(TEST_CAPTURE_PATH); return 0; }
+
+static void make_frame(struct can_frame *frame, canid_t can_id, unsigned char seed)
+{
+    (void)memset(frame, 0, sizeof(*frame));
+    frame->can_id = can_id;
+    frame->can_dlc = CAN_MAX_DLEN;
+    for (unsigned char i = 0U; i < CAN_MAX_DLEN; i++)
+    {
+        frame->data[i] = (unsigned char)(seed + i);
+    }
+}
+
+static void write_test_capture(void)
+{
+    static CanCaptureWriter writer;
+    struct can_frame frame;
+
+    CU_ASSERT_TRUE_FATAL(can_capture_open_writer(&writer, TEST_CAPTURE_PATH));
+    for (unsigned int i = 0U; i < TEST_FRAMES; i++)
+    {
+        make_frame(&frame, 0x110U + i, (unsigned char)(i * 0x10U));
+        CU_ASSERT_TRUE(can_capture_write(&writer, &frame, TEST_BASE_NS + (i * TEST_GAP_NS)));
+    }
+    CU_ASSERT_EQUAL(writer.records, TEST_FRAMES);
+    CU_ASSERT_TRUE(can_capture_close_writer(&writer));
+}
+
+static long long mono_ns(void)
+{
+    struct timespec now;
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((long long)now.tv_sec * NSEC_PER_SEC) + now.tv_nsec;
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: frames written by the recorder are read back unchanged
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_capture_round_trip
+ * @brief Checks that a capture file keeps every frame and its timestamp
+ * @req SWR1.4
+ * @file unit/test_can_capture.c
+ */
+static void test_capture_round_trip(void)
+{
+    CanCaptureReader reader;
+    struct can_frame expected;
+    struct can_frame frame;
+
+    write_test_capture();
+    CU_ASSERT_TRUE_FATAL(can_capture_open_reader(&reader, TEST_CAPTURE_PATH));
+    CU_ASSERT_EQUAL(reader.count, TEST_FRAMES);
+
+    for (unsigned int i = 0U; i < reader.count; i++)
+    {
+        make_frame(&expected, 0x110U + i, (unsigned char)(i * 0x10U));
+        can_capture_to_frame(&reader.records[i], &frame);
+        CU_ASSERT_EQUAL(reader.records[i].timestamp_ns, TEST_BASE_NS + (i * TEST_GAP_NS));
+        CU_ASSERT_EQUAL(memcmp(&frame, &expected, sizeof(frame)), 0);
+    }
+    can_capture_close_reader(&reader);
+
+    // Anything else than a capture file is refused
+    FILE *file = fopen(TEST_CAPTURE_PATH, "w");
+    CU_ASSERT_PTR_NOT_NULL_FATAL(file);
+    (void)fputs("(1700000000.123456) vcan0 110#00\n", file);
+    (void)fclose(file);
+    CU_ASSERT_FALSE(can_capture_open_reader(&reader, TEST_CAPTURE_PATH));
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: candump -L text export
+ * ---------------------------------------------------------------------------*/
+static void test_capture_candump_format(void)
+{
+    CanCaptureRecord record;
+    char line[CAN_CAPTURE_LINE_SIZE];
+
+    (void)memset(&record, 0, sizeof(record));
+    record.timestamp_ns = TEST_BASE_NS;
+    record.can_id = 0x110U;
+    record.dlc = 3U;
+    record.data[0] = 0x0AU;
+    record.data[1] = 0xBCU;
+    record.data[2] = 0x01U;
+
+    (void)can_capture_format_candump(&record, TEST_IFACE, line, sizeof(line));
+    CU_ASSERT_STRING_EQUAL(line, "(1700000000.123456) vcan0 110#0ABC01");
+
+    record.can_id = 0x1ABCDEFU | CAN_EFF_FLAG;
+    record.dlc = 0U;
+    (void)can_capture_format_candump(&record, TEST_IFACE, line, sizeof(line));
+    CU_ASSERT_STRING_EQUAL(line, "(1700000000.123456) vcan0 01ABCDEF#");
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: replay over the in-process transport, max speed and scaled timing
+ * ---------------------------------------------------------------------------*/
+static void test_capture_replay_loopback(void)
+{
+    CanCaptureReader reader;
+    struct can_frame frame;
+    uint64_t timestamp_ns = 0U;
+    int socks[2];
+
+    write_test_capture();
+    CU_ASSERT_TRUE_FATAL(can_capture_open_reader(&reader, TEST_CAPTURE_PATH));
+    CU_ASSERT_EQUAL_FATAL(create_can_loopback_pair(socks), 0);
+    (void)can_capture_enable_timestamps(socks[1]);
+
+    CU_ASSERT_EQUAL(can_replay_run(&reader, socks[0], CAN_REPLAY_MAX_SPEED, NULL), TEST_FRAMES);
+    for (unsigned int i = 0U; i < TEST_FRAMES; i++)
+    {
+        CU_ASSERT_EQUAL(can_capture_receive(socks[1], &frame, &timestamp_ns),
+                        (int)sizeof(frame));
+        CU_ASSERT_EQUAL(frame.can_id, reader.records[i].can_id);
+        CU_ASSERT_EQUAL(memcmp(frame.data, reader.records[i].data, CAN_MAX_DLEN), 0);
+        CU_ASSERT_NOT_EQUAL(timestamp_ns, 0U);
+    }
+
+    // At 10x the 2 recorded gaps of 50 ms take about 10 ms
+    const long long start = mono_ns();
+    CU_ASSERT_EQUAL(can_replay_run(&reader, socks[0], TEST_SPEED, NULL), TEST_FRAMES);
+    CU_ASSERT_TRUE((mono_ns() - start) >= TEST_MIN_ELAPSED_NS);
+    for (unsigned int i = 0U; i < TEST_FRAMES; i++)
+    {
+        CU_ASSERT_EQUAL(receive_can_frame(socks[1], &frame), 0);
+    }
+
+    // A stop request ends the replay before the first frame
+    const volatile sig_atomic_t stop = 1;
+    CU_ASSERT_EQUAL(can_replay_run(&reader, socks[0], CAN_REPLAY_MAX_SPEED, &stop), 0U);
+
+    close_can_socket(socks[0]);
+    close_can_socket(socks[1]);
+    can_capture_close_reader(&reader);
+}
+
+int main(void)
+{
+    if (CUE_SUCCESS != CU_initialize_registry()) {
+        return CU_get_error();
+    }
+
+    CU_pSuite suite = CU_add_suite("CAN Capture Test Suite", init_suite, clean_suite);
+    if (!suite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Add tests */
+    CU_add_test(suite, "round trip",            test_capture_round_trip);
+    CU_add_test(suite, "candump format",        test_capture_candump_format);
+    CU_add_test(suite, "replay loopback",       test_capture_replay_loopback);
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+    unsigned int fails = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return (fails == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
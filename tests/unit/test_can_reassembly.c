@@ -0,0 +1,230 @@
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdbool.h>
+#include <sys/socket.h>
+
+#include <linux/can.h>
+#include "../../src/common_includes/can_id_list.h"
+#include "../../src/common_includes/can_socket.h"
+#include "../../src/common_includes/can_reassembly.h"
+
+#define TEST_SEQ_A          (3U)
+#define TEST_SEQ_B          (9U)
+#define TEST_BYTE_A         (0xA5)
+#define TEST_BYTE_B         (0x5A)
+#define TEST_TIME_START_MS  (1000LL)
+#define TEST_TIME_STEP_MS   (1LL)
+#define TEST_TIME_STALE_MS  (TEST_TIME_START_MS + CAN_REASM_TIMEOUT_MS + 1LL)
+#define TEST_MESSAGE        "door: 1"
+
+/* Suite init/cleanup (no special steps here) */
+static int init_suite(void) { return 0; }
+static int clean_suite(void) { return 0; }
+
+/* Fill a message with a recognizable pattern */
+static void fill_message(unsigned char *msg, unsigned char seed)
+{
+    for (unsigned int i = 0; i < CAN_MSG_WIRE_SIZE; i++)
+    {
+        msg[i] = (unsigned char)(seed + i);
+    }
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: fragments of one message rebuild the original block
+ * ---------------------------------------------------------------------------*/
+static void test_reassembly_single_message(void)
+{
+    CanReassembler reasm;
+    struct can_frame frame;
+    unsigned char msg[CAN_MSG_WIRE_SIZE];
+    unsigned char out[CAN_MSG_WIRE_SIZE] = {0};
+    CanReasmResult result = CAN_REASM_DROPPED;
+
+    can_reasm_reset(&reasm);
+    fill_message(msg, TEST_BYTE_A);
+
+    for (uint8_t index = 0U; index < CAN_FRAGS_PER_MSG; index++)
+    {
+        can_frag_build(&frame, CAN_ID_SENSOR_READ, TEST_SEQ_A, index, msg);
+        CU_ASSERT_TRUE(frame.can_dlc <= CAN_FRAG_MAX_DLC);
+        result = can_reasm_push(&reasm, &frame, TEST_TIME_START_MS, out);
+    }
+
+    CU_ASSERT_EQUAL(result, CAN_REASM_COMPLETE);
+    CU_ASSERT_EQUAL(memcmp(out, msg, CAN_MSG_WIRE_SIZE), 0);
+    CU_ASSERT_EQUAL(reasm.sequence_errors, 0);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: sensor and error frames interleaved on the bus are kept apart
+ * ---------------------------------------------------------------------------*/
+static void test_reassembly_interleaved_ids(void)
+{
+    CanReassembler reasm;
+    struct can_frame frame;
+    unsigned char msg_a[CAN_MSG_WIRE_SIZE];
+    unsigned char msg_b[CAN_MSG_WIRE_SIZE];
+    unsigned char out[CAN_MSG_WIRE_SIZE] = {0};
+    int completed = 0;
+
+    can_reasm_reset(&reasm);
+    fill_message(msg_a, TEST_BYTE_A);
+    fill_message(msg_b, TEST_BYTE_B);
+
+    for (uint8_t index = 0U; index < CAN_FRAGS_PER_MSG; index++)
+    {
+        can_frag_build(&frame, CAN_ID_SENSOR_READ, TEST_SEQ_A, index, msg_a);
+        if (can_reasm_push(&reasm, &frame, TEST_TIME_START_MS, out) == CAN_REASM_COMPLETE)
+        {
+            CU_ASSERT_EQUAL(memcmp(out, msg_a, CAN_MSG_WIRE_SIZE), 0);
+            completed++;
+        }
+
+        can_frag_build(&frame, CAN_ID_ERROR_DASH, TEST_SEQ_B, index, msg_b);
+        if (can_reasm_push(&reasm, &frame, TEST_TIME_START_MS, out) == CAN_REASM_COMPLETE)
+        {
+            CU_ASSERT_EQUAL(memcmp(out, msg_b, CAN_MSG_WIRE_SIZE), 0);
+            completed++;
+        }
+    }
+
+    CU_ASSERT_EQUAL(completed, 2);
+    CU_ASSERT_EQUAL(reasm.sequence_errors, 0);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: a half-received block older than the timeout is dropped
+ * ---------------------------------------------------------------------------*/
+static void test_reassembly_stale_timeout(void)
+{
+    CanReassembler reasm;
+    struct can_frame frame;
+    unsigned char msg[CAN_MSG_WIRE_SIZE];
+    unsigned char out[CAN_MSG_WIRE_SIZE] = {0};
+
+    can_reasm_reset(&reasm);
+    fill_message(msg, TEST_BYTE_A);
+
+    can_frag_build(&frame, CAN_ID_SENSOR_READ, TEST_SEQ_A, 0U, msg);
+    CU_ASSERT_EQUAL(can_reasm_push(&reasm, &frame, TEST_TIME_START_MS, out), CAN_REASM_PENDING);
+
+    // The rest of the message arrives too late
+    for (uint8_t index = 1U; index < CAN_FRAGS_PER_MSG; index++)
+    {
+        can_frag_build(&frame, CAN_ID_SENSOR_READ, TEST_SEQ_A, index, msg);
+        CU_ASSERT_EQUAL(can_reasm_push(&reasm, &frame, TEST_TIME_STALE_MS, out), CAN_REASM_DROPPED);
+    }
+    CU_ASSERT_EQUAL(reasm.stale_drops, 1);
+
+    // A fresh message on the same ID is still accepted afterwards
+    CanReasmResult result = CAN_REASM_DROPPED;
+    for (uint8_t index = 0U; index < CAN_FRAGS_PER_MSG; index++)
+    {
+        can_frag_build(&frame, CAN_ID_SENSOR_READ, TEST_SEQ_B, index, msg);
+        result = can_reasm_push(&reasm, &frame, TEST_TIME_STALE_MS + TEST_TIME_STEP_MS, out);
+    }
+    CU_ASSERT_EQUAL(result, CAN_REASM_COMPLETE);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: a missing fragment or a sequence change never yields a message
+ * ---------------------------------------------------------------------------*/
+static void test_reassembly_sequence_errors(void)
+{
+    CanReassembler reasm;
+    struct can_frame frame;
+    unsigned char msg[CAN_MSG_WIRE_SIZE];
+    unsigned char out[CAN_MSG_WIRE_SIZE] = {0};
+
+    can_reasm_reset(&reasm);
+    fill_message(msg, TEST_BYTE_A);
+
+    // Fragment 1 lost: fragment 2 must be dropped
+    can_frag_build(&frame, CAN_ID_SENSOR_READ, TEST_SEQ_A, 0U, msg);
+    CU_ASSERT_EQUAL(can_reasm_push(&reasm, &frame, TEST_TIME_START_MS, out), CAN_REASM_PENDING);
+    can_frag_build(&frame, CAN_ID_SENSOR_READ, TEST_SEQ_A, 2U, msg);
+    CU_ASSERT_EQUAL(can_reasm_push(&reasm, &frame, TEST_TIME_START_MS, out), CAN_REASM_DROPPED);
+
+    // Fragment 1 of another message must not complete an older one
+    can_frag_build(&frame, CAN_ID_SENSOR_READ, TEST_SEQ_A, 0U, msg);
+    CU_ASSERT_EQUAL(can_reasm_push(&reasm, &frame, TEST_TIME_START_MS, out), CAN_REASM_PENDING);
+    can_frag_build(&frame, CAN_ID_SENSOR_READ, TEST_SEQ_B, 1U, msg);
+    CU_ASSERT_EQUAL(can_reasm_push(&reasm, &frame, TEST_TIME_START_MS, out), CAN_REASM_DROPPED);
+
+    // Empty frame carries no header
+    frame.can_dlc = 0U;
+    CU_ASSERT_EQUAL(can_reasm_push(&reasm, &frame, TEST_TIME_START_MS, out), CAN_REASM_DROPPED);
+
+    CU_ASSERT_EQUAL(reasm.sequence_errors, 3);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: frames written by send_encrypted_message() reassemble and decrypt
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_reassembly_from_sender
+ * @brief Checks that an encrypted message sent in fragments is rebuilt by the receiver
+ * @req SWR1.4
+ * @file unit/test_can_reassembly.c
+ */
+static void test_reassembly_from_sender(void)
+{
+    int fds[2];
+    CU_ASSERT_EQUAL_FATAL(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds), 0);
+
+    send_encrypted_message(fds[0], TEST_MESSAGE, CAN_ID_SENSOR_READ);
+
+    CanReassembler reasm;
+    struct can_frame frame;
+    unsigned char encrypted[CAN_MSG_WIRE_SIZE];
+    char decrypted[AES_BLOCK_SIZE + 1];
+    CanReasmResult result = CAN_REASM_DROPPED;
+
+    can_reasm_reset(&reasm);
+    for (unsigned int i = 0; i < CAN_FRAGS_PER_MSG; i++)
+    {
+        CU_ASSERT_EQUAL(receive_can_frame(fds[1], &frame), 0);
+        CU_ASSERT_EQUAL(frame.can_id, CAN_ID_SENSOR_READ);
+        result = can_reasm_push(&reasm, &frame, can_reasm_now_ms(), encrypted);
+    }
+
+    CU_ASSERT_EQUAL(result, CAN_REASM_COMPLETE);
+    CU_ASSERT_EQUAL(decrypt_data(encrypted, decrypted, CAN_MSG_WIRE_SIZE, frame.can_id), DECRYPT_OK);
+    CU_ASSERT_STRING_EQUAL(decrypted, TEST_MESSAGE);
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+int main(void)
+{
+    if (CUE_SUCCESS != CU_initialize_registry()) {
+        return CU_get_error();
+    }
+
+    CU_pSuite suite = CU_add_suite("CAN Reassembly Test Suite", init_suite, clean_suite);
+    if (!suite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Add tests */
+    CU_add_test(suite, "single message",        test_reassembly_single_message);
+    CU_add_test(suite, "interleaved CAN IDs",   test_reassembly_interleaved_ids);
+    CU_add_test(suite, "stale half-block",      test_reassembly_stale_timeout);
+    CU_add_test(suite, "sequence errors",       test_reassembly_sequence_errors);
+    CU_add_test(suite, "sender to receiver",    test_reassembly_from_sender);
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+    unsigned int fails = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return (fails == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
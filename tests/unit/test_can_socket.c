@@ -25,6 +25,7 @@
 #define TEST_CAN_DLC        2
 #define TEST_DATA_0         0xAB
 #define TEST_DATA_1         0xCD
+#define TEST_FLIP_MASK      0x01
 
 /* A small utility to see if vcan0 is likely up. */
 static bool is_vcan_available(void)
@@ -164,23 +165,63 @@ static void test_close_can_socket(void)
 static void test_encrypt_decrypt(void)
 {
     unsigned char plain[AES_BLOCK_SIZE];
-    unsigned char cipher[AES_BLOCK_SIZE];
+    unsigned char cipher[SECURED_MSG_SIZE];
     char recovered[AES_BLOCK_SIZE + 1];
     int out_len = 0;
 
     memset(plain, 'A', AES_BLOCK_SIZE); // 16 'A'
-    memset(cipher, 0, AES_BLOCK_SIZE);
+    memset(cipher, 0, SECURED_MSG_SIZE);
     memset(recovered, 0, AES_BLOCK_SIZE + 1);
 
-    encrypt_data(plain, cipher, &out_len);
-    /* Expect out_len == 16 (AES_BLOCK_SIZE) */
-    CU_ASSERT_EQUAL(out_len, AES_BLOCK_SIZE);
+    encrypt_data(plain, cipher, &out_len, TEST_CAN_ID);
+    /* Expect out_len == freshness + block + truncated tag */
+    CU_ASSERT_EQUAL(out_len, SECURED_MSG_SIZE);
 
-    decrypt_data(cipher, recovered, out_len);
+    CU_ASSERT_EQUAL(decrypt_data(cipher, recovered, out_len, TEST_CAN_ID), DECRYPT_OK);
     /* Now recovered should be "AAAAAAAAAAAAAAAA" (16 'A') */
     CU_ASSERT_STRING_EQUAL(recovered, "AAAAAAAAAAAAAAAA");
 }
 
+/* -----------------------------------------------------------------------------
+ * Test: decrypt_data() rejects tampered, misrouted and replayed messages
+ *        before anything reaches the parsers.
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_decrypt_rejects_invalid
+ * @brief Test that corrupted, misrouted or replayed secured messages are rejected
+ * @req SWR1.4
+ * @file unit/test_can_socket.c
+ */
+static void test_decrypt_rejects_invalid(void)
+{
+    unsigned char plain[AES_BLOCK_SIZE];
+    unsigned char cipher[SECURED_MSG_SIZE];
+    unsigned char tampered[SECURED_MSG_SIZE];
+    char recovered[AES_BLOCK_SIZE + 1];
+    int out_len = 0;
+
+    memset(plain, 0, AES_BLOCK_SIZE);
+    memcpy(plain, "door: 0", sizeof("door: 0"));
+    encrypt_data(plain, cipher, &out_len, TEST_CAN_ID);
+
+    /* Flipped ciphertext bit => tag mismatch, output left empty */
+    memcpy(tampered, cipher, SECURED_MSG_SIZE);
+    tampered[AEAD_FRESHNESS_SIZE] ^= TEST_FLIP_MASK;
+    CU_ASSERT_EQUAL(decrypt_data(tampered, recovered, out_len, TEST_CAN_ID), DECRYPT_AUTH_FAILED);
+    CU_ASSERT_STRING_EQUAL(recovered, "");
+
+    /* Same message on another CAN ID => nonce differs => rejected */
+    CU_ASSERT_EQUAL(decrypt_data(cipher, recovered, out_len, CAN_ID_FAKE), DECRYPT_AUTH_FAILED);
+
+    /* Wrong length => rejected */
+    CU_ASSERT_EQUAL(decrypt_data(cipher, recovered, AES_BLOCK_SIZE, TEST_CAN_ID), DECRYPT_AUTH_FAILED);
+
+    /* First delivery accepted, second one is a replay */
+    CU_ASSERT_EQUAL(decrypt_data(cipher, recovered, out_len, TEST_CAN_ID), DECRYPT_OK);
+    CU_ASSERT_STRING_EQUAL(recovered, "door: 0");
+    CU_ASSERT_EQUAL(decrypt_data(cipher, recovered, out_len, TEST_CAN_ID), DECRYPT_REPLAYED);
+}
+
 /* -----------------------------------------------------------------------------
  * Test: send_encrypted_message()
  *        Check if it attempts to send 2 frames
@@ -233,6 +274,7 @@ int main(void)
     CU_add_test(suite, "receive_can_frame invalid socket",  test_receive_can_frame_invalid_socket);
     CU_add_test(suite, "close_can_socket valid",            test_close_can_socket);
     CU_add_test(suite, "encrypt/decrypt",                   test_encrypt_decrypt);
+    CU_add_test(suite, "decrypt rejects invalid",           test_decrypt_rejects_invalid);
     CU_add_test(suite, "send_encrypted_message",            test_send_encrypted_message);
 
     CU_basic_set_mode(CU_BRM_VERBOSE);
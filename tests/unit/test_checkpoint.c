@@ -0,0 +1,265 @@
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../../src/common_includes/checkpoint.h"
+
+#define TEST_DIR        "/tmp"
+#define TEST_ECU        "unit_test_ecu"
+#define TEST_PATH       TEST_DIR "/checkpoint_" TEST_ECU ".bin"
+#define STATE_VERSION   (3U)
+#define PERIOD_MS       (250LL)
+#define NUM_ROWS        (40U)
+
+typedef struct {
+    int32_t step;
+    double soc;
+} TestState;
+
+static Checkpoint checkpoint;
+
+static void write_snapshot(const TestState *state, const double *rows, size_t num_rows)
+{
+    struct iovec parts[2];
+
+    parts[0].iov_base = (void *)state;
+    parts[0].iov_len = sizeof(*state);
+    parts[1].iov_base = (void *)rows;
+    parts[1].iov_len = num_rows * sizeof(double);
+    CU_ASSERT_TRUE(checkpoint_write(&checkpoint, STATE_VERSION, parts, 2));
+}
+
+static int init_suite(void)
+{
+    (void)unlink(TEST_PATH);
+    return 0;
+}
+
+static int clean_suite(void)
+{
+    (void)unlink(TEST_PATH);
+    (void)unsetenv(CHECKPOINT_DIR_ENV);
+    (void)unsetenv(CHECKPOINT_PERIOD_ENV);
+    return 0;
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: opt-in and period
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_checkpoint_enable_and_period
+ * @brief Without ECU_CHECKPOINT_DIR nothing is ever due or written; with it,
+ * a snapshot is due once per ECU_CHECKPOINT_MS, counted from the first call
+ * @file unit/test_checkpoint.c
+ */
+static void test_checkpoint_enable_and_period(void)
+{
+    TestState state = { 1, 50.0 };
+    struct iovec part = { &state, sizeof(state) };
+
+    (void)unsetenv(CHECKPOINT_DIR_ENV);
+    CU_ASSERT_FALSE(checkpoint_init(&checkpoint, TEST_ECU));
+    CU_ASSERT_FALSE(checkpoint_enabled(&checkpoint));
+    CU_ASSERT_FALSE(checkpoint_due(&checkpoint, 0));
+    CU_ASSERT_FALSE(checkpoint_due(&checkpoint, 100LL * PERIOD_MS));
+    CU_ASSERT_FALSE(checkpoint_write(&checkpoint, STATE_VERSION, &part, 1));
+    CU_ASSERT_NOT_EQUAL(access(TEST_PATH, F_OK), 0);
+
+    CU_ASSERT_EQUAL(setenv(CHECKPOINT_DIR_ENV, TEST_DIR, 1), 0);
+    CU_ASSERT_EQUAL(setenv(CHECKPOINT_PERIOD_ENV, "250", 1), 0);
+    CU_ASSERT_TRUE_FATAL(checkpoint_init(&checkpoint, TEST_ECU));
+    CU_ASSERT_STRING_EQUAL(checkpoint.path, TEST_PATH);
+    CU_ASSERT_EQUAL(checkpoint.period_ms, PERIOD_MS);
+    CU_ASSERT_FALSE(checkpoint_due(&checkpoint, 1000));
+    CU_ASSERT_FALSE(checkpoint_due(&checkpoint, 1000 + PERIOD_MS - 1));
+    CU_ASSERT_TRUE(checkpoint_due(&checkpoint, 1000 + PERIOD_MS));
+    CU_ASSERT_FALSE(checkpoint_due(&checkpoint, 1000 + PERIOD_MS + 1));
+    CU_ASSERT_TRUE(checkpoint_due(&checkpoint, 1000 + (3LL * PERIOD_MS)));
+
+    (void)unsetenv(CHECKPOINT_PERIOD_ENV);
+    CU_ASSERT_TRUE(checkpoint_init(&checkpoint, TEST_ECU));
+    CU_ASSERT_EQUAL(checkpoint.period_ms, CHECKPOINT_DEFAULT_PERIOD_MS);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: write, then map it back
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_checkpoint_round_trip
+ * @brief The parts come back concatenated, in place in the mapped file, and
+ * the sequence numbers continue across a restore
+ * @file unit/test_checkpoint.c
+ */
+static void test_checkpoint_round_trip(void)
+{
+    TestState state = { 17, 64.5 };
+    double rows[NUM_ROWS];
+    CheckpointSnapshot snapshot;
+
+    for (unsigned int i = 0U; i < NUM_ROWS; i++)
+    {
+        rows[i] = (double)i * 1.5;
+    }
+    CU_ASSERT_EQUAL(setenv(CHECKPOINT_DIR_ENV, TEST_DIR, 1), 0);
+    CU_ASSERT_TRUE_FATAL(checkpoint_init(&checkpoint, TEST_ECU));
+    CU_ASSERT_FALSE(checkpoint_open(&checkpoint, &snapshot, STATE_VERSION));
+
+    write_snapshot(&state, rows, NUM_ROWS);
+    state.step = 18;
+    write_snapshot(&state, rows, NUM_ROWS);
+    CU_ASSERT_EQUAL(checkpoint.sequence, 2U);
+
+    // A new run: a fresh Checkpoint picks the sequence up from the file
+    CU_ASSERT_TRUE_FATAL(checkpoint_init(&checkpoint, TEST_ECU));
+    CU_ASSERT_TRUE_FATAL(checkpoint_open(&checkpoint, &snapshot, STATE_VERSION));
+    CU_ASSERT_EQUAL(checkpoint.sequence, 2U);
+    CU_ASSERT_EQUAL(snapshot.header->state_version, STATE_VERSION);
+    CU_ASSERT_STRING_EQUAL(snapshot.header->ecu, TEST_ECU);
+    CU_ASSERT_TRUE(snapshot.header->time_ns > 0);
+    CU_ASSERT_EQUAL(snapshot.state_size, sizeof(state) + sizeof(rows));
+
+    TestState restored;
+    (void)memcpy(&restored, snapshot.state, sizeof(restored));
+    CU_ASSERT_EQUAL(restored.step, 18);
+    CU_ASSERT_DOUBLE_EQUAL(restored.soc, 64.5, 1e-12);
+    CU_ASSERT_EQUAL(memcmp(snapshot.state + sizeof(state), rows, sizeof(rows)), 0);
+    checkpoint_close(&snapshot);
+    CU_ASSERT_PTR_NULL(snapshot.map);
+
+    write_snapshot(&state, rows, 1U);
+    CU_ASSERT_EQUAL(checkpoint.sequence, 3U);
+    CU_ASSERT_NOT_EQUAL(access(TEST_PATH ".tmp", F_OK), 0);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: snapshots that must not be restored
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_checkpoint_rejects
+ * @brief Another state version, another ECU's file, a corrupted byte or a
+ * truncated file are refused, so the ECU starts from zero instead
+ * @file unit/test_checkpoint.c
+ */
+static void test_checkpoint_rejects(void)
+{
+    TestState state = { 5, 80.0 };
+    double rows[NUM_ROWS];
+    CheckpointSnapshot snapshot;
+    Checkpoint other;
+
+    (void)memset(rows, 0, sizeof(rows));
+    CU_ASSERT_EQUAL(setenv(CHECKPOINT_DIR_ENV, TEST_DIR, 1), 0);
+    CU_ASSERT_TRUE_FATAL(checkpoint_init(&checkpoint, TEST_ECU));
+    write_snapshot(&state, rows, NUM_ROWS);
+    CU_ASSERT_FALSE(checkpoint_open(&checkpoint, &snapshot, STATE_VERSION + 1U));
+    CU_ASSERT_PTR_NULL(snapshot.map);
+
+    // Same file, read as another ECU's
+    CU_ASSERT_TRUE_FATAL(checkpoint_init(&other, "unit_test_other"));
+    (void)snprintf(other.path, sizeof(other.path), "%s", TEST_PATH);
+    CU_ASSERT_FALSE(checkpoint_open(&other, &snapshot, STATE_VERSION));
+
+    // One flipped bit in the state
+    const int fd = open(TEST_PATH, O_RDWR);
+    CU_ASSERT_TRUE_FATAL(fd >= 0);
+    unsigned char byte = 0U;
+    const off_t offset = (off_t)(sizeof(CheckpointHeader) + sizeof(state) + 3U);
+    CU_ASSERT_EQUAL(pread(fd, &byte, 1U, offset), 1);
+    byte ^= 0x10U;
+    CU_ASSERT_EQUAL(pwrite(fd, &byte, 1U, offset), 1);
+    CU_ASSERT_FALSE(checkpoint_open(&checkpoint, &snapshot, STATE_VERSION));
+
+    // Cut short
+    CU_ASSERT_EQUAL(ftruncate(fd, (off_t)sizeof(CheckpointHeader) + 4), 0);
+    CU_ASSERT_FALSE(checkpoint_open(&checkpoint, &snapshot, STATE_VERSION));
+    CU_ASSERT_EQUAL(ftruncate(fd, 4), 0);
+    CU_ASSERT_FALSE(checkpoint_open(&checkpoint, &snapshot, STATE_VERSION));
+    (void)close(fd);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: periodic snapshots through the writer thread
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_checkpoint_writer
+ * @brief With the writer running, checkpoint_write only copies the state: the
+ * caller may change it at once, the file gets the copy. A write while the
+ * previous one is in progress is dropped, never queued behind it. Once the
+ * writer stopped, writes are in place again.
+ * @file unit/test_checkpoint.c
+ */
+static void test_checkpoint_writer(void)
+{
+    TestState state = { 30, 70.0 };
+    double rows[NUM_ROWS];
+    CheckpointSnapshot snapshot;
+    TestState restored;
+
+    (void)memset(rows, 0, sizeof(rows));
+    (void)unsetenv(CHECKPOINT_DIR_ENV);
+    CU_ASSERT_FALSE(checkpoint_init(&checkpoint, TEST_ECU));
+    CU_ASSERT_FALSE(checkpoint_start_writer(&checkpoint));
+
+    CU_ASSERT_EQUAL(setenv(CHECKPOINT_DIR_ENV, TEST_DIR, 1), 0);
+    CU_ASSERT_TRUE_FATAL(checkpoint_init(&checkpoint, TEST_ECU));
+    (void)unlink(TEST_PATH);
+    CU_ASSERT_TRUE_FATAL(checkpoint_start_writer(&checkpoint));
+    CU_ASSERT_TRUE(checkpoint_start_writer(&checkpoint));
+
+    write_snapshot(&state, rows, NUM_ROWS);
+    state.step = 31;        // Changed as soon as the write returned
+    rows[0] = 1.0;
+    struct iovec parts[2] = { { &state, sizeof(state) }, { rows, sizeof(rows) } };
+    const bool second = checkpoint_write(&checkpoint, STATE_VERSION, parts, 2);
+    CU_ASSERT_EQUAL(checkpoint.dropped, second ? 0UL : 1UL);
+    checkpoint_stop_writer(&checkpoint);
+    CU_ASSERT_FALSE(checkpoint.writer_running);
+    CU_ASSERT_PTR_NULL(checkpoint.buffer);
+    CU_ASSERT_EQUAL(checkpoint.sequence, second ? 2U : 1U);
+
+    CU_ASSERT_TRUE_FATAL(checkpoint_open(&checkpoint, &snapshot, STATE_VERSION));
+    (void)memcpy(&restored, snapshot.state, sizeof(restored));
+    CU_ASSERT_EQUAL(restored.step, second ? 31 : 30);
+    CU_ASSERT_DOUBLE_EQUAL(*(const double *)(const void *)(snapshot.state + sizeof(state)),
+                           second ? 1.0 : 0.0, 1e-12);
+    checkpoint_close(&snapshot);
+
+    // Stopped: in place again
+    state.step = 32;
+    write_snapshot(&state, rows, NUM_ROWS);
+    CU_ASSERT_TRUE_FATAL(checkpoint_open(&checkpoint, &snapshot, STATE_VERSION));
+    (void)memcpy(&restored, snapshot.state, sizeof(restored));
+    CU_ASSERT_EQUAL(restored.step, 32);
+    checkpoint_close(&snapshot);
+}
+
+int main(void)
+{
+    if (CUE_SUCCESS != CU_initialize_registry()) {
+        return CU_get_error();
+    }
+
+    CU_pSuite suite = CU_add_suite("Checkpoint Test Suite", init_suite, clean_suite);
+    if (!suite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Add tests */
+    CU_add_test(suite, "enable and period",     test_checkpoint_enable_and_period);
+    CU_add_test(suite, "round trip",            test_checkpoint_round_trip);
+    CU_add_test(suite, "rejects",               test_checkpoint_rejects);
+    CU_add_test(suite, "writer",                test_checkpoint_writer);
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+    unsigned int fails = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return (fails == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,394 @@
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../../src/common_includes/coro.h"
+
+#define TICK_MS         (10LL)
+#define MAX_TRACE       (64U)
+#define NUM_PERIODIC    (2000U)
+#define PERIODS         (10U)       // Distinct periods, 10 ms to 100 ms
+#define RUN_MS          (10000LL)
+
+static char trace[MAX_TRACE + 1U];
+static size_t trace_len = 0U;
+
+static void note(char id)
+{
+    if (trace_len < MAX_TRACE)
+    {
+        trace[trace_len++] = id;
+        trace[trace_len] = '\0';
+    }
+}
+
+static int init_suite(void)
+{
+    trace_len = 0U;
+    trace[0] = '\0';
+    return 0;
+}
+
+static int clean_suite(void) { return 0; }
+
+/* -----------------------------------------------------------------------------
+ * Test: ordering in virtual time
+ * ---------------------------------------------------------------------------*/
+typedef struct {
+    char id;
+    long long woke_ms;
+} Sleeper;
+
+static void sleeps_then_exits(Coro *co)
+{
+    Sleeper *sleeper = (Sleeper *)co->arg;
+
+    CORO_BEGIN(co);
+    note(sleeper->id);
+    CORO_SLEEP(co, 30);
+    sleeper->woke_ms = co->sched->now_ms;
+    note(sleeper->id);
+    CORO_END(co);
+}
+
+static void yields_twice(Coro *co)
+{
+    Sleeper *sleeper = (Sleeper *)co->arg;
+
+    CORO_BEGIN(co);
+    note(sleeper->id);
+    CORO_YIELD(co);
+    note(sleeper->id);
+    CORO_YIELD(co);
+    note(sleeper->id);
+    CORO_END(co);
+}
+
+static void sleeps_until_then_yields(Coro *co)
+{
+    Sleeper *sleeper = (Sleeper *)co->arg;
+
+    CORO_BEGIN(co);
+    note(sleeper->id);
+    CORO_SLEEP_UNTIL(co, 10);
+    sleeper->woke_ms = co->sched->now_ms;
+    note(sleeper->id);
+    CORO_YIELD(co);
+    note(sleeper->id);
+    CORO_END(co);
+}
+
+/**
+ * @test test_coro_order
+ * @brief Coroutines start in spawn order, a yield lets the other ready ones
+ * run first, sleeps resume in deadline order at their time, and a coroutine
+ * reaching its end is done
+ * @req SWR1.2
+ * @file unit/test_coro.c
+ */
+static void test_coro_order(void)
+{
+    CoroScheduler sched;
+    Coro a, b, c;
+    Sleeper sa = { 'A', -1 };
+    Sleeper sb = { 'B', -1 };
+    Sleeper sc = { 'C', -1 };
+
+    init_suite();
+    coro_sched_init_virtual(&sched, TICK_MS, 0);
+    CU_ASSERT_FALSE(coro_spawn(&sched, &a, "a", NULL, &sa));
+    CU_ASSERT_TRUE(coro_spawn(&sched, &a, "a", sleeps_then_exits, &sa));
+    CU_ASSERT_TRUE(coro_spawn(&sched, &b, "b", sleeps_until_then_yields, &sb));
+    CU_ASSERT_TRUE(coro_spawn(&sched, &c, "c", yields_twice, &sc));
+    CU_ASSERT_EQUAL(sched.live, 3U);
+
+    // Time 0: everything that is ready, yields included
+    CU_ASSERT_EQUAL(coro_sched_advance(&sched, 0), 5U);
+    CU_ASSERT_STRING_EQUAL(trace, "ABCCC");
+    CU_ASSERT_EQUAL(c.state, CORO_DONE);
+    CU_ASSERT_EQUAL(a.state, CORO_SLEEPING);
+    CU_ASSERT_EQUAL(sched.live, 2U);
+
+    // Not before its time
+    CU_ASSERT_EQUAL(coro_sched_advance(&sched, 9), 0U);
+    CU_ASSERT_EQUAL(coro_sched_run_virtual(&sched, CORO_NO_TIMEOUT), 30);
+    CU_ASSERT_STRING_EQUAL(trace, "ABCCCBBA");
+    CU_ASSERT_EQUAL(sb.woke_ms, 10);
+    CU_ASSERT_EQUAL(sa.woke_ms, 30);
+    CU_ASSERT_EQUAL(sched.live, 0U);
+    CU_ASSERT_EQUAL(sched.switches, 8UL);
+    CU_ASSERT_EQUAL(c.resumes, 3UL);
+    coro_sched_close(&sched);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: thousands of periodic coroutines on one thread
+ * ---------------------------------------------------------------------------*/
+typedef struct {
+    long long period_ms;
+    long long next_ms;
+    unsigned long runs;
+    long long late_ms;      // Worst wakeup after the deadline
+} Periodic;
+
+static void periodic_task(Coro *co)
+{
+    Periodic *task = (Periodic *)co->arg;
+
+    CORO_BEGIN(co);
+    task->next_ms = co->sched->now_ms;
+    for (;;)
+    {
+        if ((co->sched->now_ms - task->next_ms) > task->late_ms)
+        {
+            task->late_ms = co->sched->now_ms - task->next_ms;
+        }
+        task->runs++;
+        task->next_ms += task->period_ms;
+        CORO_SLEEP_UNTIL(co, task->next_ms);
+    }
+    CORO_END(co);
+}
+
+/**
+ * @test test_coro_many_periodic
+ * @brief 2000 periodic coroutines with ten different periods share one
+ * thread: each runs once per period, none wakes after its deadline, and the
+ * memory is one Coro each
+ * @req SWR1.2
+ * @file unit/test_coro.c
+ */
+static void test_coro_many_periodic(void)
+{
+    static CoroScheduler sched;
+    static Coro coros[NUM_PERIODIC];
+    static Periodic tasks[NUM_PERIODIC];
+    unsigned long expected_switches = 0UL;
+    bool all_on_time = true;
+    bool all_counted = true;
+
+    coro_sched_init_virtual(&sched, TICK_MS, 0);
+    for (unsigned int i = 0U; i < NUM_PERIODIC; i++)
+    {
+        (void)memset(&tasks[i], 0, sizeof(tasks[i]));
+        tasks[i].period_ms = (long long)((i % PERIODS) + 1U) * TICK_MS;
+        CU_ASSERT_TRUE_FATAL(coro_spawn(&sched, &coros[i], "periodic", periodic_task, &tasks[i]));
+    }
+
+    CU_ASSERT_EQUAL(coro_sched_run_virtual(&sched, RUN_MS), RUN_MS);
+    for (unsigned int i = 0U; i < NUM_PERIODIC; i++)
+    {
+        // At 0, then every period up to and including RUN_MS
+        const unsigned long expected = (unsigned long)(RUN_MS / tasks[i].period_ms) + 1UL;
+        all_counted = all_counted && (tasks[i].runs == expected);
+        all_on_time = all_on_time && (tasks[i].late_ms == 0);
+        expected_switches += expected;
+    }
+    CU_ASSERT_TRUE(all_counted);
+    CU_ASSERT_TRUE(all_on_time);
+    CU_ASSERT_EQUAL(sched.switches, expected_switches);
+    CU_ASSERT_EQUAL(sched.live, NUM_PERIODIC);
+    CU_ASSERT_EQUAL(sched.wheel.armed, (size_t)NUM_PERIODIC);
+
+    // Exiting from outside stops a coroutine where it waits
+    coro_exit(&coros[0]);
+    CU_ASSERT_EQUAL(coros[0].state, CORO_DONE);
+    CU_ASSERT_EQUAL(sched.live, NUM_PERIODIC - 1U);
+    const unsigned long runs = tasks[0].runs;
+    (void)coro_sched_run_virtual(&sched, RUN_MS + 100LL);
+    CU_ASSERT_EQUAL(tasks[0].runs, runs);
+    coro_sched_close(&sched);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: events and wait timeouts
+ * ---------------------------------------------------------------------------*/
+typedef struct {
+    CoroEvent event;
+    long long signalled_ms;
+    long long timed_out_ms;
+    bool first_timed_out;
+    unsigned int woken;
+} EventTest;
+
+static void event_waiter(Coro *co)
+{
+    EventTest *test = (EventTest *)co->arg;
+
+    CORO_BEGIN(co);
+    CORO_WAIT_EVENT(co, &test->event, 50);
+    test->first_timed_out = co->timed_out;
+    test->signalled_ms = co->sched->now_ms;
+    note('W');
+
+    // Nobody signals this time
+    CORO_WAIT_EVENT(co, &test->event, 50);
+    if (co->timed_out)
+    {
+        test->timed_out_ms = co->sched->now_ms;
+    }
+    note('T');
+    CORO_END(co);
+}
+
+static void event_signaller(Coro *co)
+{
+    EventTest *test = (EventTest *)co->arg;
+
+    CORO_BEGIN(co);
+    CORO_SLEEP(co, 20);
+    note('S');
+    test->woken = coro_event_signal(&test->event);
+    CORO_END(co);
+}
+
+/**
+ * @test test_coro_event
+ * @brief A signal wakes the coroutine waiting for the event after the
+ * signaller's turn, and a wait nobody signals ends at its timeout, flagged
+ * @req SWR1.2
+ * @file unit/test_coro.c
+ */
+static void test_coro_event(void)
+{
+    CoroScheduler sched;
+    Coro waiter, signaller;
+    EventTest test;
+
+    init_suite();
+    (void)memset(&test, 0, sizeof(test));
+    coro_event_init(&test.event);
+    CU_ASSERT_EQUAL(coro_event_signal(&test.event), 0U);
+
+    coro_sched_init_virtual(&sched, TICK_MS, 0);
+    CU_ASSERT_TRUE(coro_spawn(&sched, &waiter, "waiter", event_waiter, &test));
+    CU_ASSERT_TRUE(coro_spawn(&sched, &signaller, "signaller", event_signaller, &test));
+    (void)coro_sched_run_virtual(&sched, CORO_NO_TIMEOUT);
+
+    CU_ASSERT_STRING_EQUAL(trace, "SWT");
+    CU_ASSERT_EQUAL(test.woken, 1U);
+    CU_ASSERT_FALSE(test.first_timed_out);
+    CU_ASSERT_EQUAL(test.signalled_ms, 20);
+    CU_ASSERT_EQUAL(test.timed_out_ms, 70);
+    CU_ASSERT_PTR_NULL(test.event.head);
+    CU_ASSERT_EQUAL(sched.live, 0U);
+    CU_ASSERT_EQUAL(sched.wheel.armed, 0U);
+    coro_sched_close(&sched);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: descriptor waits in real time
+ * ---------------------------------------------------------------------------*/
+typedef struct {
+    int fds[2];
+    char received[8];
+    size_t length;
+    bool first_timed_out;
+    bool second_timed_out;
+    bool closed_timed_out;
+    long long second_waited_ms;
+} PipeTest;
+
+static void pipe_reader(Coro *co)
+{
+    PipeTest *test = (PipeTest *)co->arg;
+    ssize_t got = 0;
+
+    CORO_BEGIN(co);
+    CORO_WAIT_READABLE(co, test->fds[0], 1000);
+    test->first_timed_out = co->timed_out;
+    got = read(test->fds[0], test->received, sizeof(test->received) - 1U);
+    test->length = (got > 0) ? (size_t)got : 0U;
+
+    // Nothing more is written: the wait times out and leaves epoll clean
+    test->second_waited_ms = co->sched->now_ms;
+    CORO_WAIT_READABLE(co, test->fds[0], 30);
+    test->second_timed_out = co->timed_out;
+    test->second_waited_ms = co->sched->now_ms - test->second_waited_ms;
+
+    // No descriptor to wait on: resumes at once, as after a timeout
+    CORO_WAIT_READABLE(co, -1, 1000);
+    test->closed_timed_out = co->timed_out;
+    CORO_END(co);
+}
+
+static void pipe_writer(Coro *co)
+{
+    PipeTest *test = (PipeTest *)co->arg;
+
+    CORO_BEGIN(co);
+    CORO_SLEEP(co, 20);
+    CU_ASSERT_EQUAL(write(test->fds[1], "frame", 5U), 5);
+    CORO_END(co);
+}
+
+/**
+ * @test test_coro_pipe
+ * @brief In real time a coroutine waiting for a descriptor resumes when it
+ * becomes readable, a wait with nothing to read ends at its timeout, and an
+ * invalid descriptor does not block the scheduler
+ * @req SWR1.2
+ * @file unit/test_coro.c
+ */
+static void test_coro_pipe(void)
+{
+    CoroScheduler sched;
+    Coro reader, writer;
+    PipeTest test;
+
+    (void)memset(&test, 0, sizeof(test));
+    CU_ASSERT_EQUAL_FATAL(pipe(test.fds), 0);
+    CU_ASSERT_TRUE_FATAL(coro_sched_init(&sched, 1));
+    CU_ASSERT_TRUE(coro_spawn(&sched, &reader, "reader", pipe_reader, &test));
+    CU_ASSERT_TRUE(coro_spawn(&sched, &writer, "writer", pipe_writer, &test));
+
+    const long long start_ms = timer_wheel_now_ms();
+    coro_sched_run(&sched, NULL);
+    const long long elapsed_ms = timer_wheel_now_ms() - start_ms;
+
+    CU_ASSERT_FALSE(test.first_timed_out);
+    CU_ASSERT_EQUAL(test.length, 5U);
+    CU_ASSERT_STRING_EQUAL(test.received, "frame");
+    CU_ASSERT_TRUE(test.second_timed_out);
+    CU_ASSERT_TRUE(test.second_waited_ms >= 30);
+    CU_ASSERT_TRUE(test.closed_timed_out);
+    CU_ASSERT_EQUAL(sched.live, 0U);
+    // Woken by the write, not by the 1 s timeout
+    CU_ASSERT_TRUE(elapsed_ms >= 50);
+    CU_ASSERT_TRUE(elapsed_ms < 1000);
+
+    coro_sched_close(&sched);
+    CU_ASSERT_EQUAL(sched.epoll_fd, -1);
+    (void)close(test.fds[0]);
+    (void)close(test.fds[1]);
+}
+
+int main(void)
+{
+    if (CUE_SUCCESS != CU_initialize_registry()) {
+        return CU_get_error();
+    }
+
+    CU_pSuite suite = CU_add_suite("Coroutine Test Suite", init_suite, clean_suite);
+    if (!suite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Add tests */
+    CU_add_test(suite, "order in virtual time",     test_coro_order);
+    CU_add_test(suite, "many periodic coroutines",  test_coro_many_periodic);
+    CU_add_test(suite, "events and timeouts",       test_coro_event);
+    CU_add_test(suite, "descriptor waits",          test_coro_pipe);
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+    unsigned int fails = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return (fails == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
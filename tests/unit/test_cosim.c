@@ -0,0 +1,243 @@
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../../src/common_includes/can_id_list.h"
+#include "../../src/common_includes/fault_scenario.h"
+#include "../../src/cosim/cosim_ecus.h"
+
+#define CYCLE_HEALTHY   "/tmp/unit_test_cosim_healthy.csv"
+#define CYCLE_FAULTY    "/tmp/unit_test_cosim_faulty.csv"
+#define TRACE_PATH      "/tmp/unit_test_cosim.cancap"
+#define CYCLE_ROWS      (30U)
+#define FAULTY_ROW      (10U)
+#define STEP_MS         (1000LL)
+#define TIMEOUT_MS      (2000LL)
+
+static void write_cycle(const char *path, unsigned int rows, unsigned int faulty_from)
+{
+    FILE *file = fopen(path, "w");
+    CU_ASSERT_PTR_NOT_NULL_FATAL(file);
+    (void)fputs("Time (seconds),Speed (km/h),Tilt Angle (deg),Internal Temp (C),"
+                "External Temp (C),Door Open,Engine Temp (C)\n", file);
+    for (unsigned int i = 0U; i < rows; i++)
+    {
+        // Stops every 10 s, so Stop/Start has something to do
+        (void)fprintf(file, "%u,%u.0,0.0,24,27,%d,80.0\n", i, ((i % 10U) < 4U) ? 0U : 30U,
+                      (i >= faulty_from) ? 3 : 0);
+    }
+    (void)fclose(file);
+}
+
+static int init_suite(void)
+{
+    write_cycle(CYCLE_HEALTHY, CYCLE_ROWS, CYCLE_ROWS);
+    write_cycle(CYCLE_FAULTY, CYCLE_ROWS, FAULTY_ROW);
+    return 0;
+}
+
+static int clean_suite(void)
+{
+    (void)unlink(CYCLE_HEALTHY);
+    (void)unlink(CYCLE_FAULTY);
+    (void)unlink(TRACE_PATH);
+    return 0;
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: security contexts
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_cosim_security_contexts
+ * @brief ECUs hosted in one process keep their own counters and replay
+ * windows: two receivers both accept a message, each rejects it a second time
+ * @req SWR5.2
+ * @file unit/test_cosim.c
+ */
+static void test_cosim_security_contexts(void)
+{
+    CanSecurityContext sender;
+    CanSecurityContext receivers[2];
+    unsigned char plain[AES_BLOCK_SIZE] = "press_start_stop";
+    unsigned char wire[SECURED_MSG_SIZE];
+    unsigned char again[SECURED_MSG_SIZE];
+    char decrypted[AES_BLOCK_SIZE + 1];
+    int len = 0;
+
+    can_security_init(&sender, CAN_NODE_INSTRUMENT_CLUSTER, COSIM_FIRST_COUNTER);
+    can_security_init(&receivers[0], CAN_NODE_POWERTRAIN, COSIM_FIRST_COUNTER);
+    can_security_init(&receivers[1], CAN_NODE_DASHBOARD, COSIM_FIRST_COUNTER);
+
+    can_security_select(&sender);
+    encrypt_data(plain, wire, &len, CAN_ID_COMMAND);
+    CU_ASSERT_EQUAL(len, SECURED_MSG_SIZE);
+    CU_ASSERT_EQUAL(sender.tx_counter, COSIM_FIRST_COUNTER);
+
+    for (unsigned int i = 0U; i < 2U; i++)
+    {
+        can_security_select(&receivers[i]);
+        CU_ASSERT_EQUAL(decrypt_data(wire, decrypted, len, CAN_ID_COMMAND), DECRYPT_OK);
+        CU_ASSERT_EQUAL(memcmp(decrypted, plain, AES_BLOCK_SIZE), 0);
+        CU_ASSERT_EQUAL(decrypt_data(wire, decrypted, len, CAN_ID_COMMAND), DECRYPT_REPLAYED);
+    }
+
+    // A fresh sender context starts from the same counter: same bytes
+    can_security_init(&sender, CAN_NODE_INSTRUMENT_CLUSTER, COSIM_FIRST_COUNTER);
+    can_security_select(&sender);
+    encrypt_data(plain, again, &len, CAN_ID_COMMAND);
+    CU_ASSERT_EQUAL(memcmp(wire, again, SECURED_MSG_SIZE), 0);
+    can_security_select(NULL);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: a healthy drive cycle, reproducibly
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_cosim_reproducible
+ * @brief The four ECUs run the whole cycle in virtual time: every row is
+ * published, the button press turns Stop/Start on in the powertrain and on
+ * the dashboard, and a second run gives the same bus traffic
+ * @req SWR1.2
+ * @req SWR2.1
+ * @file unit/test_cosim.c
+ */
+static void test_cosim_reproducible(void)
+{
+    CosimScenario scenario;
+    CosimReport first;
+    CosimReport second;
+
+    cosim_scenario_default(&scenario);
+    scenario.cycle_path = CYCLE_HEALTHY;
+    scenario.trace_path = TRACE_PATH;
+    CU_ASSERT_TRUE_FATAL(cosim_vehicle_run(&scenario, &first));
+
+    // The last row is only read ahead
+    CU_ASSERT_EQUAL(first.bcm_steps, (unsigned long)(CYCLE_ROWS - 1U));
+    CU_ASSERT_EQUAL(first.bcm_faults, 0U);
+    CU_ASSERT_FALSE(first.bcm_disabled);
+    CU_ASSERT_EQUAL(first.presses, 1UL);
+    CU_ASSERT_TRUE(first.pt_enabled);
+    CU_ASSERT_TRUE(first.dash_enabled);
+    CU_ASSERT_FALSE(first.dash_error);
+    CU_ASSERT_TRUE(first.pt_messages > 0UL);
+    CU_ASSERT_EQUAL(first.pt_rejected, 0UL);
+    CU_ASSERT_EQUAL(first.dash_rejected, 0UL);
+    CU_ASSERT_TRUE(first.savings.intervals > 0U);
+    CU_ASSERT_TRUE(first.frames > 0UL);
+    CU_ASSERT_EQUAL(first.frames, first.frames_sent[COSIM_BCM] + first.frames_sent[COSIM_POWERTRAIN] +
+                                  first.frames_sent[COSIM_DASHBOARD] +
+                                  first.frames_sent[COSIM_INSTRUMENT_CLUSTER]);
+    // The last step, then one more period for the other ECUs
+    CU_ASSERT_TRUE(first.sim_ms > ((long long)(CYCLE_ROWS - 2U) * STEP_MS));
+    CU_ASSERT_TRUE(first.sim_ms < ((long long)(CYCLE_ROWS - 1U) * STEP_MS));
+    CU_ASSERT_TRUE(access(TRACE_PATH, F_OK) == 0);
+
+    scenario.trace_path = NULL;
+    CU_ASSERT_TRUE_FATAL(cosim_vehicle_run(&scenario, &second));
+    CU_ASSERT_EQUAL(second.digest, first.digest);
+    CU_ASSERT_EQUAL(second.frames, first.frames);
+    CU_ASSERT_EQUAL(second.events, first.events);
+    CU_ASSERT_EQUAL(second.sim_ms, first.sim_ms);
+
+    // Without the press, Stop/Start stays off and the traffic differs
+    scenario.num_presses = 0U;
+    CU_ASSERT_TRUE_FATAL(cosim_vehicle_run(&scenario, &second));
+    CU_ASSERT_FALSE(second.pt_enabled);
+    CU_ASSERT_FALSE(second.dash_enabled);
+    CU_ASSERT_EQUAL(second.presses, 0UL);
+    CU_ASSERT_NOT_EQUAL(second.digest, first.digest);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: a fault disables the system on every ECU
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_cosim_fault_disables
+ * @brief A door fault lasting past the safety timeout is reported by the BCM,
+ * turns Stop/Start off in the powertrain and shows the error on the dashboard
+ * @req SWR6.4
+ * @file unit/test_cosim.c
+ */
+static void test_cosim_fault_disables(void)
+{
+    CosimScenario scenario;
+    CosimReport report;
+
+    cosim_scenario_default(&scenario);
+    scenario.cycle_path = CYCLE_FAULTY;
+    CU_ASSERT_TRUE_FATAL(cosim_vehicle_run(&scenario, &report));
+
+    CU_ASSERT_EQUAL(report.bcm_faults, FAULT_BIT(FAULT_DOOR));
+    // Seen when the step before it is published, reported a timeout later
+    CU_ASSERT_EQUAL(report.bcm_fault_ms, ((long long)(FAULTY_ROW - 1U) * STEP_MS) + TIMEOUT_MS);
+    CU_ASSERT_TRUE(report.bcm_steps < (unsigned long)(CYCLE_ROWS - 1U));
+    CU_ASSERT_FALSE(report.pt_enabled);
+    CU_ASSERT_FALSE(report.dash_enabled);
+    CU_ASSERT_TRUE(report.dash_error);
+    CU_ASSERT_TRUE(report.sim_ms < ((long long)(CYCLE_ROWS - 1U) * STEP_MS));
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: the scenario bounds the run
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_cosim_scenario_limits
+ * @brief end_ms stops the run early, and scenarios that cannot run are
+ * refused before anything starts
+ * @req SWR2.1
+ * @file unit/test_cosim.c
+ */
+static void test_cosim_scenario_limits(void)
+{
+    CosimScenario scenario;
+    CosimReport report;
+
+    cosim_scenario_default(&scenario);
+    scenario.cycle_path = CYCLE_HEALTHY;
+    scenario.end_ms = 5LL * STEP_MS;
+    CU_ASSERT_TRUE_FATAL(cosim_vehicle_run(&scenario, &report));
+    CU_ASSERT_TRUE(report.sim_ms <= scenario.end_ms);
+    CU_ASSERT_EQUAL(report.bcm_steps, 6UL);
+
+    scenario.cycle_path = "/tmp/does_not_exist.csv";
+    CU_ASSERT_FALSE(cosim_vehicle_run(&scenario, &report));
+    scenario.cycle_path = NULL;
+    CU_ASSERT_FALSE(cosim_vehicle_run(&scenario, &report));
+    scenario.cycle_path = CYCLE_HEALTHY;
+    scenario.presses_ms[0] = -1LL;
+    CU_ASSERT_FALSE(cosim_vehicle_run(&scenario, &report));
+
+    CU_ASSERT_STRING_EQUAL(cosim_ecu_name(COSIM_POWERTRAIN), "powertrain");
+    CU_ASSERT_PTR_NULL(cosim_ecu_name(COSIM_ECU_COUNT));
+}
+
+int main(void)
+{
+    if (CUE_SUCCESS != CU_initialize_registry()) {
+        return CU_get_error();
+    }
+
+    CU_pSuite suite = CU_add_suite("Co-simulation Test Suite", init_suite, clean_suite);
+    if (!suite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Add tests */
+    CU_add_test(suite, "security contexts",     test_cosim_security_contexts);
+    CU_add_test(suite, "reproducible run",      test_cosim_reproducible);
+    CU_add_test(suite, "fault disables",        test_cosim_fault_disables);
+    CU_add_test(suite, "scenario limits",       test_cosim_scenario_limits);
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+    unsigned int fails = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return (fails == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
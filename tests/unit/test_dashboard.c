@@ -8,14 +8,15 @@
 #include "../../src/common_includes/can_id_list.h"
 #include "../../src/common_includes/can_socket.h"
 #include "../../src/dashboard/dashboard_func.h"
+#include "../../src/dashboard/dashboard_tasks.h"
 #include "../../src/common_includes/logging.h"
 
 #include "mock_ncurses.h"
 
-#define MOCK_SOCKET (999)
 #define FILE_LINE_SIZE (256)
 #define CAN_ID_MOCK (0x7A0U)
-#define SLEEP_TIME_US_TEST (200000)
+#define MAX_TASK_POLLS (20)
+#define TASK_POLL_MS (10)
 
 static const double kDelta = 0.001;
 static const double kSpeedReceived = 48.0;
@@ -29,6 +30,8 @@ static const double ktiltReceived = 7.0;
 //-------------------------------------
 // Setup the CUnit Suite
 //-------------------------------------
+void stub_can_reset(void);
+
 static int init_suite(void) { return 0; }
 static int clean_suite(void) { return 0; }
 
@@ -63,21 +66,22 @@ static bool file_contains_substring(f_susbtring_data struct_f_subs)
 
 //-------------------------------------
 // Test 1: Test process received frames
-/* 
- * This test calls process_received_frame() with our stubs:
- *  - 2 valid frames => triggers decrypt+parse_input_received
- *  - 1 invalid-size frame => triggers warning
- *  - Then returns -1 => we break out of the loop
- */
 /**
  * @test test_process_received_frame
- * @brief Test process received frames
+ * @brief The receiver coroutine wakes on a readable socket and takes the
+ * stub frames in: two valid ones, a fragment that is dropped and a complete
+ * message. It signals the processor, which parses the message on the same
+ * thread: the press turns Stop/Start on and is logged
  * @req SWR1.2
  * @req SWR1.4
  * @file unit/test_dashboard.c
  */
 void test_process_received_frame(void)
 {
+    static CoroScheduler sched;
+    static DashboardTasks tasks;
+    int fds[2];
+
     // 1) Setup logging so "press_start_stop" toggles system & logs
     set_log_file_path("/tmp/test_dashboard_frame.log");
     CU_ASSERT_TRUE_FATAL(init_logging_system());
@@ -85,25 +89,36 @@ void test_process_received_frame(void)
     // 2) We can ensure the actuators are initially off
     actuators.start_stop_active = false;
     test_mode_dash = false;
-
-    // 3) Call the function once. It will loop until stub returns -1.
-    pthread_t thd;
-    pthread_t thd2;
-
-    sock_dash = MOCK_SOCKET;
-
+    stub_can_reset();
     init_can_buffer();
+    EcuStats before;
+    EcuStats after;
+    ecu_stats_get(&before);
+
+    // 3) A pipe with a byte in it stands for a socket with frames pending
+    CU_ASSERT_EQUAL_FATAL(pipe(fds), 0);
+    CU_ASSERT_EQUAL(write(fds[1], "x", 1U), 1);
+    sock_dash = fds[0];
+
+    CU_ASSERT_TRUE_FATAL(coro_sched_init(&sched, TASK_POLL_MS));
+    CU_ASSERT_TRUE_FATAL(dashboard_tasks_spawn(&sched, &tasks));
+    for (int i = 0; (i < MAX_TASK_POLLS) && (tasks.batches == 0UL); i++)
+    {
+        CU_ASSERT_TRUE(coro_sched_poll(&sched, TASK_POLL_MS));
+    }
 
-    pthread_create(&thd, NULL, can_receiver_thread, NULL);
-    pthread_create(&thd2, NULL, process_frame_thread, NULL);
-
-    sleep(1);
-
-    test_mode_dash = true;
+    CU_ASSERT_EQUAL(tasks.frames, 3UL + CAN_FRAGS_PER_MSG);
+    CU_ASSERT_EQUAL(tasks.batches, 1UL);
+    CU_ASSERT_TRUE(actuators.start_stop_active);
+    CU_ASSERT_EQUAL(sched.live, 2U);
 
     // 4) Cleanup
+    test_mode_dash = true;
+    coro_sched_close(&sched);
     cleanup_can_buffer();
     cleanup_logging_system();
+    close(fds[0]);
+    close(fds[1]);
 
     // 5) Check the log for "[INFO] System Activated"
     //    if parse_input_received toggled the system on.
@@ -113,6 +128,13 @@ void test_process_received_frame(void)
     params_str.substring = "[INFO] System Activated";
 
     CU_ASSERT_TRUE(file_contains_substring(params_str));
+
+    // 6) Receive counters: one broken message, one processed message
+    ecu_stats_get(&after);
+    CU_ASSERT_EQUAL(after.frames_rx - before.frames_rx, 3U + CAN_FRAGS_PER_MSG);
+    CU_ASSERT_EQUAL(after.frags_dropped - before.frags_dropped, 1U);
+    CU_ASSERT_EQUAL(after.msgs_processed - before.msgs_processed, 1U);
+    CU_ASSERT_EQUAL(after.msgs_rejected - before.msgs_rejected, 0U);
 }
 
 //-------------------------------------
@@ -230,6 +252,48 @@ void test_parse_input_variants(void)
     CU_ASSERT_TRUE(actuators.error_system);
 }
 
+/**
+ * @test test_parse_sensor_pdu
+ * @brief Tests that a multiplexed sensor PDU updates all the signals it carries
+ * @req SWR5.1
+ * @file unit/test_dashboard.c
+ */
+void test_parse_sensor_pdu(void)
+{
+    SensorPdu pdu = {0};
+    unsigned char block[SENSOR_PDU_SIZE + 1] = {0};
+
+    memset(&actuators, 0, sizeof(actuators));
+    actuators.batt_soc = kBattSocReceived;
+
+    pdu.present = (uint16_t)(SENSOR_PDU_ALL_PRESENT & ~(1U << SENSOR_SIG_BATT_SOC));
+    pdu.speed = kSpeedReceived;
+    pdu.internal_temp = kintempReceived;
+    pdu.external_temp = kextempReceived;
+    pdu.batt_volt = kBattVoltReceived;
+    pdu.engi_temp = kengiReceived;
+    pdu.tilt_angle = ktiltReceived;
+    pdu.door_open = 1;
+    pdu.gear = 1;
+    pdu.accel = 1;
+    sensor_pdu_encode(&pdu, block);
+
+    parse_input_received((char *)block);
+
+    CU_ASSERT_DOUBLE_EQUAL(actuators.speed, kSpeedReceived, kDelta);
+    CU_ASSERT_EQUAL(actuators.internal_temp, kintempReceived);
+    CU_ASSERT_EQUAL(actuators.external_temp, kextempReceived);
+    CU_ASSERT_DOUBLE_EQUAL(actuators.batt_volt, kBattVoltReceived, kDelta);
+    CU_ASSERT_DOUBLE_EQUAL(actuators.engi_temp, kengiReceived, kDelta);
+    CU_ASSERT_DOUBLE_EQUAL(actuators.tilt_angle, ktiltReceived, kDelta);
+    CU_ASSERT_TRUE(actuators.door_status);
+    CU_ASSERT_TRUE(actuators.gear);
+    CU_ASSERT_TRUE(actuators.accel);
+    CU_ASSERT_FALSE(actuators.brake);
+    // Not carried by this PDU => unchanged
+    CU_ASSERT_DOUBLE_EQUAL(actuators.batt_soc, kBattSocReceived, kDelta);
+}
+
 #define TEST_VALUE_PANEL_HEIGHT 20
 #define TEST_VALUE_PANEL_WIDTH 40
 
@@ -298,6 +362,75 @@ void test_invalid_can_id_dashboard(void)
     CU_ASSERT_FALSE(check_is_valid_can_id(INVALID_CAN_ID));
 }
 
+//-------------------------------------
+// Test 5: Checkpoint and resume
+//-------------------------------------
+/**
+ * @test test_dashboard_checkpoint_round_trip
+ * @brief A saved snapshot brings back the displayed values, the engine
+ * deactivation count and the receive counters, and the restored state is
+ * drawn again without waiting for a frame
+ * @req SWR1.4
+ * @file unit/test_dashboard.c
+ */
+void test_dashboard_checkpoint_round_trip(void)
+{
+    panel_dash = create_value_panel(
+        (Size){TEST_VALUE_PANEL_HEIGHT, TEST_VALUE_PANEL_WIDTH},
+        (Position){1, 1},
+        "Test_dash"
+    );
+    CU_ASSERT_EQUAL(setenv(CHECKPOINT_DIR_ENV, "/tmp", 1), 0);
+    CU_ASSERT_TRUE_FATAL(checkpoint_init(&dash_checkpoint, "unit_test_dashboard"));
+    (void)unlink(dash_checkpoint.path);
+
+    memset(&actuators, 0, sizeof(actuators));
+    num_deactivs = 0;
+    process_engine_commands("ENGINE OFF");
+    process_engine_commands("RESTART");
+    process_engine_commands("ENGINE OFF");
+    process_sensor_readings("speed: 48.0");
+    process_sensor_readings("batt_soc: 55.0");
+    actuators.start_stop_active = true;
+    CU_ASSERT_EQUAL(num_deactivs, 2);
+    metrics_add(METRIC_FRAMES_ACCEPTED, 17U);
+    metrics_add(METRIC_MESSAGES_PROCESSED, 15U);
+    metrics_inc(METRIC_BUFFER_DROPS);
+    EcuStats saved;
+    ecu_stats_get(&saved);
+    CU_ASSERT_TRUE_FATAL(save_dashboard_checkpoint());
+
+    // A new process: the saved counters are added to its own
+    memset(&actuators, 0, sizeof(actuators));
+    num_deactivs = 0;
+    EcuStats before;
+    EcuStats after;
+    ecu_stats_get(&before);
+    CU_ASSERT_TRUE_FATAL(checkpoint_init(&dash_checkpoint, "unit_test_dashboard"));
+    CU_ASSERT_TRUE_FATAL(restore_dashboard_checkpoint());
+    ecu_stats_get(&after);
+
+    CU_ASSERT_DOUBLE_EQUAL(actuators.speed, kSpeedReceived, kDelta);
+    CU_ASSERT_DOUBLE_EQUAL(actuators.batt_soc, kBattSocReceived, kDelta);
+    CU_ASSERT_TRUE(actuators.engine_off);
+    CU_ASSERT_TRUE(actuators.start_stop_active);
+    CU_ASSERT_EQUAL(num_deactivs, 2);
+    CU_ASSERT_TRUE(saved.frames_rx >= 17UL);
+    CU_ASSERT_EQUAL(after.frames_rx, before.frames_rx + saved.frames_rx);
+    CU_ASSERT_EQUAL(after.msgs_processed, before.msgs_processed + saved.msgs_processed);
+    CU_ASSERT_EQUAL(after.queue_dropped, before.queue_dropped + saved.queue_dropped);
+
+    // The count is the last row drawn, and the next deactivation follows it
+    redraw_dashboard_values();
+    CU_ASSERT_STRING_EQUAL(read_value_panel(), "2");
+    process_engine_commands("ENGINE OFF");
+    CU_ASSERT_STRING_EQUAL(read_value_panel(), "3");
+
+    (void)unlink(dash_checkpoint.path);
+    (void)unsetenv(CHECKPOINT_DIR_ENV);
+    CU_ASSERT_FALSE(checkpoint_init(&dash_checkpoint, "dashboard"));
+}
+
 int main(void)
 {
     // Initialize CUnit test registry
@@ -316,8 +449,10 @@ int main(void)
     // Add tests
     CU_add_test(suite, "process_received_frame_coverage", test_process_received_frame);
     CU_add_test(suite, "parse_input_variants", test_parse_input_variants);
+    CU_add_test(suite, "parse_sensor_pdu", test_parse_sensor_pdu);
     CU_add_test(suite, "panels", test_panels);
     CU_add_test(suite, "invalid_can_id_dashboard", test_invalid_can_id_dashboard);
+    CU_add_test(suite, "checkpoint_round_trip", test_dashboard_checkpoint_round_trip);
 
     // Run all tests in verbose mode
     CU_basic_set_mode(CU_BRM_VERBOSE);
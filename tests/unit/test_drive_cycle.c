@@ -0,0 +1,226 @@
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../../src/common_includes/drive_cycle.h"
+#include "../../src/bcm/bcm_func.h"
+
+#define BASE_PATH           "../src/bcm/ftp75.csv"
+#define FTP75_ROWS          (1878U)
+#define TEST_CSV_PATH       "/tmp/unit_test_cycle.csv"
+#define TEST_BIN_PATH       "/tmp/unit_test_cycle.bin"
+#define TEST_SEED           (42U)
+#define UNIFORM_SAMPLES     (100000U)
+
+static DriveCycleBase base;
+static DriveCycleParams params;
+static DriveCycleRow cycle_a[FTP75_ROWS];
+static DriveCycleRow cycle_b[FTP75_ROWS];
+static VehicleData from_csv[SPEED_ARRAY_MAX_SIZE];
+static VehicleData from_bin[SPEED_ARRAY_MAX_SIZE];
+
+static int init_suite(void)
+{
+    drive_cycle_default_params(&params);
+    params.seed = TEST_SEED;
+    return drive_cycle_load_base(&base, BASE_PATH) ? 0 : -1;
+}
+
+static int clean_suite(void)
+{
+    drive_cycle_free_base(&base);
+    (void)unlink(TEST_CSV_PATH);
+    (void)unlink(TEST_BIN_PATH);
+    return 0;
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: counter-based random draws
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_drive_cycle_uniform
+ * @brief Draws depend only on (seed, cycle, row, channel): repeatable, in
+ * [0, 1), evenly spread and different between cycles
+ * @req SWR2.1
+ * @file unit/test_drive_cycle.c
+ */
+static void test_drive_cycle_uniform(void)
+{
+    const uint64_t key = drive_cycle_key(TEST_SEED, 0U);
+    double sum = 0.0;
+    bool in_range = true;
+
+    CU_ASSERT_EQUAL(key, drive_cycle_key(TEST_SEED, 0U));
+    CU_ASSERT_NOT_EQUAL(key, drive_cycle_key(TEST_SEED, 1U));
+    CU_ASSERT_NOT_EQUAL(key, drive_cycle_key(TEST_SEED + 1U, 0U));
+    CU_ASSERT_EQUAL(drive_cycle_uniform(key, 7U, 3U), drive_cycle_uniform(key, 7U, 3U));
+    CU_ASSERT_NOT_EQUAL(drive_cycle_uniform(key, 7U, 3U), drive_cycle_uniform(key, 7U, 4U));
+    CU_ASSERT_NOT_EQUAL(drive_cycle_uniform(key, 7U, 3U), drive_cycle_uniform(key, 8U, 3U));
+
+    for (uint32_t row = 0U; row < UNIFORM_SAMPLES; row++)
+    {
+        const double u = drive_cycle_uniform(key, row, 0U);
+        in_range = in_range && (u >= 0.0) && (u < 1.0);
+        sum += u;
+    }
+    CU_ASSERT_TRUE(in_range);
+    CU_ASSERT_DOUBLE_EQUAL(sum / (double)UNIFORM_SAMPLES, 0.5, 0.01);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: base trace and synthesized channels
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_drive_cycle_synthesize
+ * @brief Loads ftp75.csv (decimal commas) and checks that a synthesized cycle
+ * follows the base speeds, keeps every channel in its range and is the same
+ * each time the same cycle is built
+ * @req SWR2.1
+ * @file unit/test_drive_cycle.c
+ */
+static void test_drive_cycle_synthesize(void)
+{
+    bool in_range = true;
+    bool doors_stopped = true;
+    bool tilt_held = true;
+    unsigned int doors = 0U;
+
+    CU_ASSERT_EQUAL_FATAL(base.rows, FTP75_ROWS);
+    CU_ASSERT_EQUAL(base.time[21], 21);
+    CU_ASSERT_DOUBLE_EQUAL(base.speed[21], 4.8, 1e-9);
+    CU_ASSERT_DOUBLE_EQUAL(base.speed[25], 23.0, 1e-9);
+
+    drive_cycle_synthesize(&base, &params, 0U, cycle_a);
+    CU_ASSERT_EQUAL(cycle_a[21].time, 21);
+    CU_ASSERT_DOUBLE_EQUAL(cycle_a[21].speed, 4.8, 1e-5);
+    // Stopped at the start: the engine starts at ambient temperature
+    CU_ASSERT_DOUBLE_EQUAL(cycle_a[0].engi_temp, (double)cycle_a[0].external_temp, 1e-5);
+    CU_ASSERT_DOUBLE_EQUAL(cycle_a[0].tilt_angle, 0.0, 1e-9);
+
+    for (size_t i = 0U; i < base.rows; i++)
+    {
+        const DriveCycleRow *row = &cycle_a[i];
+        in_range = in_range &&
+                   (row->internal_temp >= params.internal_min) && (row->internal_temp <= params.internal_max) &&
+                   (row->external_temp >= params.external_min) && (row->external_temp <= params.external_max) &&
+                   (row->tilt_angle >= 0.0F) && (row->tilt_angle <= 10.0F) &&
+                   (row->engi_temp <= 110.0F);
+        doors_stopped = doors_stopped && ((row->door_open == 0U) || (row->speed == 0.0F));
+        doors += row->door_open;
+        if ((i > 0U) && (row->speed == 0.0F))
+        {
+            tilt_held = tilt_held && (row->tilt_angle == cycle_a[i - 1U].tilt_angle);
+        }
+    }
+    CU_ASSERT_TRUE(in_range);
+    CU_ASSERT_TRUE(doors_stopped);
+    CU_ASSERT_TRUE(tilt_held);
+    CU_ASSERT_TRUE(doors > 0U);
+    // Warmed up by the end of the cycle
+    CU_ASSERT_DOUBLE_EQUAL(cycle_a[base.rows - 1U].engi_temp, 90.0, 15.0);
+
+    drive_cycle_synthesize(&base, &params, 0U, cycle_b);
+    CU_ASSERT_EQUAL(memcmp(cycle_a, cycle_b, sizeof(cycle_a)), 0);
+    drive_cycle_synthesize(&base, &params, 1U, cycle_b);
+    CU_ASSERT_NOT_EQUAL(memcmp(cycle_a, cycle_b, sizeof(cycle_a)), 0);
+
+    // Speed scale
+    params.speed_scale = 0.5;
+    drive_cycle_synthesize(&base, &params, 0U, cycle_b);
+    params.speed_scale = 1.0;
+    CU_ASSERT_DOUBLE_EQUAL(cycle_b[25].speed, 11.5, 1e-5);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: CSV and binary files, loaded by the BCM
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_drive_cycle_files
+ * @brief Formats rows as full_simu.csv does, writes one cycle as CSV and as a
+ * binary cycle file and checks that the BCM loads the same steps from both
+ * @req SWR2.1
+ * @file unit/test_drive_cycle.c
+ */
+static void test_drive_cycle_files(void)
+{
+    static DriveCycleWriter writer;
+    DriveCycleReader reader;
+    char line[DRIVE_CYCLE_LINE_SIZE];
+    const DriveCycleRow row = { 21, 4.8F, 0.3F, 33.6F, 24, 27, 1U, 0U };
+    const DriveCycleRow cold = { 5, 0.0F, 0.0F, -2.5F, -3, -10, 0U, 0U };
+
+    size_t len = drive_cycle_format_csv(&row, line);
+    line[len] = '\0';
+    CU_ASSERT_STRING_EQUAL(line, "21,4.8,0.3,24,27,1,33.6\n");
+    len = drive_cycle_format_csv(&cold, line);
+    line[len] = '\0';
+    CU_ASSERT_STRING_EQUAL(line, "5,0.0,0.0,-3,-10,0,-2.5\n");
+
+    drive_cycle_synthesize(&base, &params, 3U, cycle_a);
+    CU_ASSERT_TRUE_FATAL(drive_cycle_open_writer(&writer, TEST_CSV_PATH, DRIVE_CYCLE_CSV));
+    CU_ASSERT_TRUE(drive_cycle_write(&writer, TEST_SEED, 3U, cycle_a, base.rows));
+    CU_ASSERT_TRUE(drive_cycle_close_writer(&writer));
+    CU_ASSERT_TRUE_FATAL(drive_cycle_open_writer(&writer, TEST_BIN_PATH, DRIVE_CYCLE_BINARY));
+    CU_ASSERT_TRUE(drive_cycle_write(&writer, TEST_SEED, 3U, cycle_a, base.rows));
+    CU_ASSERT_EQUAL(writer.rows, (unsigned long)base.rows);
+    CU_ASSERT_TRUE(drive_cycle_close_writer(&writer));
+
+    CU_ASSERT_FALSE(drive_cycle_is_binary(TEST_CSV_PATH));
+    CU_ASSERT_TRUE(drive_cycle_is_binary(TEST_BIN_PATH));
+    CU_ASSERT_TRUE_FATAL(drive_cycle_open_reader(&reader, TEST_BIN_PATH));
+    CU_ASSERT_EQUAL(reader.count, base.rows);
+    CU_ASSERT_EQUAL(reader.header->seed, TEST_SEED);
+    CU_ASSERT_EQUAL(reader.header->cycle, 3U);
+    CU_ASSERT_EQUAL(memcmp(reader.rows, cycle_a, base.rows * sizeof(DriveCycleRow)), 0);
+    drive_cycle_close_reader(&reader);
+    CU_ASSERT_FALSE(drive_cycle_open_reader(&reader, TEST_CSV_PATH));
+
+    // The BCM reads both files into the same steps
+    const int csv_steps = read_csv_into(TEST_CSV_PATH, from_csv, SPEED_ARRAY_MAX_SIZE);
+    const int bin_steps = read_csv_into(TEST_BIN_PATH, from_bin, SPEED_ARRAY_MAX_SIZE);
+    CU_ASSERT_EQUAL(csv_steps, (int)FTP75_ROWS - 1);
+    CU_ASSERT_EQUAL_FATAL(bin_steps, csv_steps);
+    bool same = true;
+    for (int i = 0; i <= csv_steps; i++)
+    {
+        same = same && (from_csv[i].time == from_bin[i].time) &&
+               (from_csv[i].internal_temp == from_bin[i].internal_temp) &&
+               (from_csv[i].external_temp == from_bin[i].external_temp) &&
+               (from_csv[i].door_open == from_bin[i].door_open) &&
+               (fabs(from_csv[i].speed - from_bin[i].speed) < 1e-4) &&
+               (fabs(from_csv[i].tilt_angle - from_bin[i].tilt_angle) < 1e-4) &&
+               (fabs(from_csv[i].engi_temp - from_bin[i].engi_temp) < 1e-4);
+    }
+    CU_ASSERT_TRUE(same);
+    // A short buffer stops the binary load as it stops the CSV one
+    CU_ASSERT_EQUAL(read_csv_into(TEST_BIN_PATH, from_bin, 10), 9);
+}
+
+int main(void)
+{
+    if (CUE_SUCCESS != CU_initialize_registry()) {
+        return CU_get_error();
+    }
+
+    CU_pSuite suite = CU_add_suite("Drive Cycle Test Suite", init_suite, clean_suite);
+    if (!suite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Add tests */
+    CU_add_test(suite, "counter-based draws",   test_drive_cycle_uniform);
+    CU_add_test(suite, "synthesis",             test_drive_cycle_synthesize);
+    CU_add_test(suite, "cycle files",           test_drive_cycle_files);
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+    unsigned int fails = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return (fails == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,138 @@
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../../src/common_includes/ecu_shutdown.h"
+
+#define TICK_MS         (10LL)
+#define SIGNAL_AFTER_MS (30LL)
+#define STOP_WITHIN_MS  (500LL)
+
+static CoroScheduler sched;
+static Coro shutdown_co;
+static Coro sender_co;
+static Coro worker_co;
+static unsigned long worker_ticks;
+
+// Stands in for kill -TERM from outside, once the loop is running
+static void sender_task(Coro *co)
+{
+    CORO_BEGIN(co);
+    CORO_SLEEP(co, SIGNAL_AFTER_MS);
+    (void)kill(getpid(), SIGTERM);
+    CORO_END(co);
+}
+
+// Stands in for an ECU task that never finishes on its own
+static void worker_task(Coro *co)
+{
+    CORO_BEGIN(co);
+    for (;;)
+    {
+        worker_ticks++;
+        CORO_SLEEP(co, TICK_MS);
+    }
+    CORO_END(co);
+}
+
+static bool fd_readable(int fd)
+{
+    struct pollfd pfd = { .fd = fd, .events = POLLIN, .revents = 0 };
+    return (poll(&pfd, 1U, 0) == 1) && ((pfd.revents & POLLIN) != 0);
+}
+
+static int init_suite(void)  { return 0; }
+static int clean_suite(void) { return 0; }
+
+/* -----------------------------------------------------------------------------
+ * Test: SIGTERM ends a coroutine loop through the signalfd
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_shutdown_coroutine
+ * @brief With the stop signals routed to the signalfd, a SIGTERM sent while
+ * coro_sched_run waits neither kills the process nor goes unnoticed: the
+ * shutdown coroutine sets the flag and the loop returns at once, though
+ * another coroutine would run forever
+ * @file unit/test_ecu_shutdown.c
+ */
+static void test_shutdown_coroutine(void)
+{
+    CU_ASSERT_EQUAL(ecu_shutdown_fd(), -1);
+    CU_ASSERT_FALSE(ecu_shutdown_check());
+    CU_ASSERT_TRUE_FATAL(coro_sched_init(&sched, TICK_MS));
+    CU_ASSERT_FALSE(ecu_shutdown_spawn(&sched, &shutdown_co));
+
+    CU_ASSERT_TRUE_FATAL(ecu_shutdown_init());
+    const int fd = ecu_shutdown_fd();
+    CU_ASSERT_TRUE(fd >= 0);
+    CU_ASSERT_TRUE(ecu_shutdown_init());
+    CU_ASSERT_EQUAL(ecu_shutdown_fd(), fd);
+    CU_ASSERT_FALSE(ecu_shutdown_check());
+
+    CU_ASSERT_TRUE_FATAL(ecu_shutdown_spawn(&sched, &shutdown_co));
+    CU_ASSERT_TRUE_FATAL(coro_spawn(&sched, &sender_co, "sender", sender_task, NULL));
+    CU_ASSERT_TRUE_FATAL(coro_spawn(&sched, &worker_co, "worker", worker_task, NULL));
+
+    const long long start_ms = timer_wheel_now_ms();
+    coro_sched_run(&sched, ecu_shutdown_flag());
+    const long long elapsed_ms = timer_wheel_now_ms() - start_ms;
+
+    CU_ASSERT_TRUE(*ecu_shutdown_flag());
+    CU_ASSERT_EQUAL(shutdown_co.state, CORO_DONE);
+    CU_ASSERT_NOT_EQUAL(worker_co.state, CORO_DONE);
+    CU_ASSERT_TRUE(worker_ticks > 0UL);
+    CU_ASSERT_TRUE(elapsed_ms >= SIGNAL_AFTER_MS);
+    CU_ASSERT_TRUE(elapsed_ms < STOP_WITHIN_MS);
+    coro_sched_close(&sched);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: the signal stays visible to every later waiter
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_shutdown_stays_readable
+ * @brief The stop signal is never consumed, so the signalfd keeps reporting
+ * it to any other loop that checks later, and further stop signals are
+ * absorbed the same way
+ * @file unit/test_ecu_shutdown.c
+ */
+static void test_shutdown_stays_readable(void)
+{
+    CU_ASSERT_TRUE(fd_readable(ecu_shutdown_fd()));
+    CU_ASSERT_TRUE(ecu_shutdown_check());
+    CU_ASSERT_TRUE(fd_readable(ecu_shutdown_fd()));
+
+    (void)kill(getpid(), SIGINT);
+    CU_ASSERT_TRUE(fd_readable(ecu_shutdown_fd()));
+    CU_ASSERT_TRUE(ecu_shutdown_check());
+}
+
+int main(void)
+{
+    if (CUE_SUCCESS != CU_initialize_registry()) {
+        return CU_get_error();
+    }
+
+    CU_pSuite suite = CU_add_suite("ECU Shutdown Test Suite", init_suite, clean_suite);
+    if (!suite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Add tests */
+    CU_add_test(suite, "coroutine",             test_shutdown_coroutine);
+    CU_add_test(suite, "stays readable",        test_shutdown_stays_readable);
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+    unsigned int fails = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return (fails == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,121 @@
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../../src/common_includes/ecu_stats.h"
+#include "../../src/common_includes/metrics.h"
+
+#define TEST_STATS_DIR      "/tmp"
+#define TEST_ECU_NAME       "unit_test_ecu"
+#define TEST_FRAMES         (40UL)
+#define TEST_PROCESSED      (9UL)
+
+/* Suite init/cleanup (no special steps here) */
+static int init_suite(void)
+{
+    return setenv(ECU_STATS_DIR_ENV, TEST_STATS_DIR, 1);
+}
+static int clean_suite(void) { return 0; }
+
+/* -----------------------------------------------------------------------------
+ * Test: the receive counters are the metrics of the same events
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_ecu_stats_view
+ * @brief Checks that each receive counter follows its metric, so every event
+ * is counted once, and that restored counters are added to them
+ * @req SWR1.4
+ * @file unit/test_ecu_stats.c
+ */
+static void test_ecu_stats_view(void)
+{
+    EcuStats before;
+    EcuStats after;
+    EcuStats saved = { 3UL, 4UL, 5UL, 6UL, 7UL };
+
+    ecu_stats_get(&before);
+    metrics_add(METRIC_FRAMES_ACCEPTED, TEST_FRAMES);
+    metrics_add(METRIC_MESSAGES_PROCESSED, TEST_PROCESSED);
+    metrics_inc(METRIC_DECRYPT_FAILURES);
+    metrics_inc(METRIC_REASSEMBLY_ERRORS);
+    metrics_inc(METRIC_BUFFER_DROPS);
+    // Not a receive counter
+    metrics_inc(METRIC_FRAMES_SENT);
+    ecu_stats_get(&after);
+    CU_ASSERT_EQUAL(after.frames_rx - before.frames_rx, TEST_FRAMES);
+    CU_ASSERT_EQUAL(after.msgs_processed - before.msgs_processed, TEST_PROCESSED);
+    CU_ASSERT_EQUAL(after.msgs_rejected - before.msgs_rejected, 1UL);
+    CU_ASSERT_EQUAL(after.frags_dropped - before.frags_dropped, 1UL);
+    CU_ASSERT_EQUAL(after.queue_dropped - before.queue_dropped, 1UL);
+
+    before = after;
+    ecu_stats_restore(&saved);
+    ecu_stats_get(&after);
+    CU_ASSERT_EQUAL(after.frames_rx - before.frames_rx, 3UL);
+    CU_ASSERT_EQUAL(after.msgs_processed - before.msgs_processed, 4UL);
+    CU_ASSERT_EQUAL(after.msgs_rejected - before.msgs_rejected, 5UL);
+    CU_ASSERT_EQUAL(after.frags_dropped - before.frags_dropped, 6UL);
+    CU_ASSERT_EQUAL(after.queue_dropped - before.queue_dropped, 7UL);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: counters exported by an ECU are read back unchanged
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_ecu_stats_round_trip
+ * @brief Checks that external tools read the receive counters back from the
+ * metrics file of the ECU
+ * @req SWR1.4
+ * @file unit/test_ecu_stats.c
+ */
+static void test_ecu_stats_round_trip(void)
+{
+    EcuStats stats;
+    EcuStats read_back;
+
+    metrics_init(TEST_ECU_NAME);
+    metrics_add(METRIC_FRAMES_ACCEPTED, TEST_FRAMES);
+    metrics_inc(METRIC_BUFFER_DROPS);
+    CU_ASSERT_TRUE_FATAL(metrics_write());
+    ecu_stats_get(&stats);
+
+    CU_ASSERT_TRUE(ecu_stats_read(TEST_ECU_NAME, &read_back));
+    CU_ASSERT_EQUAL(read_back.frames_rx, stats.frames_rx);
+    CU_ASSERT_EQUAL(read_back.msgs_processed, stats.msgs_processed);
+    CU_ASSERT_EQUAL(read_back.msgs_rejected, stats.msgs_rejected);
+    CU_ASSERT_EQUAL(read_back.frags_dropped, stats.frags_dropped);
+    CU_ASSERT_EQUAL(read_back.queue_dropped, stats.queue_dropped);
+
+    CU_ASSERT_FALSE(ecu_stats_read("missing_ecu", &read_back));
+    CU_ASSERT_EQUAL(read_back.frames_rx, 0UL);
+
+    (void)unlink(metrics_path());
+}
+
+int main(void)
+{
+    if (CUE_SUCCESS != CU_initialize_registry()) {
+        return CU_get_error();
+    }
+
+    CU_pSuite suite = CU_add_suite("ECU Stats Test Suite", init_suite, clean_suite);
+    if (!suite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Add tests */
+    CU_add_test(suite, "metrics view",          test_ecu_stats_view);
+    CU_add_test(suite, "round trip",            test_ecu_stats_round_trip);
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+    unsigned int fails = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return (fails == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
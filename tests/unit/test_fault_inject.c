@@ -0,0 +1,340 @@
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../../src/common_includes/fault_scenario.h"
+#include "../../src/bcm/fault_inject.h"
+
+#define CYCLE_HEALTHY   "/tmp/unit_test_fault_healthy.csv"
+#define CYCLE_FAULTY    "/tmp/unit_test_fault_faulty.csv"
+#define CYCLE_ROWS      (24U)
+#define WINDOW          (20U)
+#define STEP_MS         (1000LL)
+#define TIMEOUT_MS      (2000LL)
+#define MOCK_SOCKET     (999)
+#define CAMPAIGN_SIZE   (60U)
+#define SEED            (42U)
+
+// Mocked can_socket calls
+int stub_can_get_send_count(void);
+const char *stub_can_get_last_message(void);
+void stub_can_reset(void);
+
+static void write_cycle(const char *path, unsigned int rows, unsigned int faulty_row)
+{
+    FILE *file = fopen(path, "w");
+    CU_ASSERT_PTR_NOT_NULL_FATAL(file);
+    (void)fputs("Time (seconds),Speed (km/h),Tilt Angle (deg),Internal Temp (C),"
+                "External Temp (C),Door Open,Engine Temp (C)\n", file);
+    for (unsigned int i = 0U; i < rows; i++)
+    {
+        (void)fprintf(file, "%u,%u.0,0.0,24,27,%d,80.0\n", i, (i % 5U) * 10U, (i == faulty_row) ? 3 : 0);
+    }
+    (void)fclose(file);
+}
+
+static int init_suite(void)
+{
+    write_cycle(CYCLE_HEALTHY, CYCLE_ROWS, CYCLE_ROWS);
+    write_cycle(CYCLE_FAULTY, CYCLE_ROWS, 5U);
+    return 0;
+}
+
+static int clean_suite(void)
+{
+    (void)unlink(CYCLE_HEALTHY);
+    (void)unlink(CYCLE_FAULTY);
+    return 0;
+}
+
+static void one_episode(FaultScenario *scenario, FaultType type, uint32_t onset, uint32_t duration,
+                        uint32_t period, double value)
+{
+    (void)memset(scenario, 0, sizeof(*scenario));
+    scenario->steps = WINDOW;
+    scenario->num_episodes = 1U;
+    scenario->episodes[0].type = type;
+    scenario->episodes[0].onset = onset;
+    scenario->episodes[0].duration = duration;
+    scenario->episodes[0].period = period;
+    scenario->episodes[0].value = value;
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: generated scenarios are reproducible and stay within the configuration
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_fault_generation
+ * @brief Scenario N of a seed is always the same, and its episodes use only
+ * the enabled causes, onsets inside the window and adverse values
+ * @req SWR6.4
+ * @file unit/test_fault_inject.c
+ */
+static void test_fault_generation(void)
+{
+    FaultGenConfig config;
+    FaultScenario a;
+    FaultScenario b;
+    bool intermittent = false;
+    bool several = false;
+
+    fault_gen_config_default(&config);
+    CU_ASSERT_TRUE(fault_gen_config_valid(&config));
+    config.types = FAULT_BIT(FAULT_DOOR) | FAULT_BIT(FAULT_TILT);
+
+    for (uint32_t id = 0U; id < 200U; id++)
+    {
+        fault_scenario_generate(&config, SEED, id, &a);
+        fault_scenario_generate(&config, SEED, id, &b);
+        CU_ASSERT_EQUAL(memcmp(&a, &b, sizeof(a)), 0);
+        CU_ASSERT_EQUAL(a.id, id);
+        CU_ASSERT_EQUAL(a.steps, config.steps);
+        CU_ASSERT_TRUE((a.num_episodes >= 1U) && (a.num_episodes <= config.max_episodes));
+        several = several || (a.num_episodes > 1U);
+        for (unsigned int e = 0U; e < a.num_episodes; e++)
+        {
+            const FaultEpisode *episode = &a.episodes[e];
+            CU_ASSERT_NOT_EQUAL(episode->type, FAULT_ENGINE_TEMP);
+            CU_ASSERT_TRUE((episode->onset >= 1U) && (episode->onset <= config.steps));
+            CU_ASSERT_TRUE((episode->duration >= 1U) && (episode->duration <= config.max_duration));
+            CU_ASSERT_TRUE((episode->period == 0U) || (episode->period >= 2U));
+            intermittent = intermittent || (episode->period > 0U);
+            if (episode->type == FAULT_DOOR)
+            {
+                CU_ASSERT_TRUE((episode->value >= 2.0) && (episode->value == (double)(int)episode->value));
+            }
+            else
+            {
+                CU_ASSERT_TRUE(episode->value > 60.0);
+            }
+        }
+    }
+    CU_ASSERT_TRUE(intermittent);
+    CU_ASSERT_TRUE(several);
+
+    // Another seed gives another campaign
+    fault_scenario_generate(&config, SEED + 1U, 0U, &b);
+    fault_scenario_generate(&config, SEED, 0U, &a);
+    CU_ASSERT_NOT_EQUAL(memcmp(&a, &b, sizeof(a)), 0);
+
+    config.types = 0U;
+    CU_ASSERT_FALSE(fault_gen_config_valid(&config));
+    fault_gen_config_default(&config);
+    config.max_episodes = FAULT_MAX_EPISODES + 1U;
+    CU_ASSERT_FALSE(fault_gen_config_valid(&config));
+    CU_ASSERT_STRING_EQUAL(fault_type_name(FAULT_ENGINE_TEMP), "engine_temp");
+    CU_ASSERT_PTR_NULL(fault_type_name(FAULT_TYPE_COUNT));
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: expected outcome of hand-made scenarios
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_fault_expectation
+ * @brief A fault must be reported at the safety deadline after its first
+ * sample, on the last row sampled before it, unless a healthy sample comes
+ * first
+ * @req SWR6.4
+ * @file unit/test_fault_inject.c
+ */
+static void test_fault_expectation(void)
+{
+    FaultScenario scenario;
+    FaultExpectation expect;
+
+    // Sampled at 3 s, the deadline is at 5 s: reported on the sample taken at 4 s
+    one_episode(&scenario, FAULT_TILT, 4U, 3U, 0U, 75.0);
+    CU_ASSERT_EQUAL(fault_scenario_mask(&scenario, 3U), 0U);
+    CU_ASSERT_EQUAL(fault_scenario_mask(&scenario, 4U), FAULT_BIT(FAULT_TILT));
+    CU_ASSERT_EQUAL(fault_scenario_mask(&scenario, 7U), 0U);
+    fault_scenario_expect(&scenario, STEP_MS, TIMEOUT_MS, &expect);
+    CU_ASSERT_TRUE(expect.detected);
+    CU_ASSERT_EQUAL(expect.step, 5U);
+    CU_ASSERT_EQUAL(expect.run_start, 4U);
+    CU_ASSERT_EQUAL(expect.faults, FAULT_BIT(FAULT_TILT));
+
+    // The healthy sample comes at the deadline itself: too late
+    scenario.episodes[0].duration = 2U;
+    fault_scenario_expect(&scenario, STEP_MS, TIMEOUT_MS, &expect);
+    CU_ASSERT_TRUE(expect.detected);
+    CU_ASSERT_EQUAL(expect.step, 5U);
+    scenario.episodes[0].duration = 1U;
+    fault_scenario_expect(&scenario, STEP_MS, TIMEOUT_MS, &expect);
+    CU_ASSERT_FALSE(expect.detected);
+
+    // A healthy sample every second one restarts the timer each time
+    one_episode(&scenario, FAULT_DOOR, 2U, 15U, 2U, 3.0);
+    CU_ASSERT_EQUAL(fault_scenario_mask(&scenario, 2U), FAULT_BIT(FAULT_DOOR));
+    CU_ASSERT_EQUAL(fault_scenario_mask(&scenario, 3U), 0U);
+    fault_scenario_expect(&scenario, STEP_MS, TIMEOUT_MS, &expect);
+    CU_ASSERT_FALSE(expect.detected);
+
+    // Causes taking over from each other keep the fault present
+    one_episode(&scenario, FAULT_DOOR, 2U, 1U, 0U, 3.0);
+    scenario.num_episodes = 2U;
+    scenario.episodes[1] = scenario.episodes[0];
+    scenario.episodes[1].type = FAULT_ENGINE_TEMP;
+    scenario.episodes[1].onset = 3U;
+    scenario.episodes[1].duration = 2U;
+    scenario.episodes[1].value = 130.0;
+    fault_scenario_expect(&scenario, STEP_MS, TIMEOUT_MS, &expect);
+    CU_ASSERT_TRUE(expect.detected);
+    CU_ASSERT_EQUAL(expect.step, 3U);
+    CU_ASSERT_EQUAL(expect.run_start, 2U);
+    CU_ASSERT_EQUAL(expect.faults, FAULT_BIT(FAULT_ENGINE_TEMP));
+
+    // Faster sampling needs more samples: ceil(2000 / 300) = 7 before the deadline
+    one_episode(&scenario, FAULT_TILT, 1U, 8U, 0U, 75.0);
+    fault_scenario_expect(&scenario, 300LL, TIMEOUT_MS, &expect);
+    CU_ASSERT_TRUE(expect.detected);
+    CU_ASSERT_EQUAL(expect.step, 7U);
+    scenario.episodes[0].duration = 6U;
+    fault_scenario_expect(&scenario, 300LL, TIMEOUT_MS, &expect);
+    CU_ASSERT_FALSE(expect.detected);
+
+    // A deadline past the last sample of the window is not reached
+    one_episode(&scenario, FAULT_TILT, WINDOW - 2U, 3U, 0U, 75.0);
+    fault_scenario_expect(&scenario, STEP_MS, TIMEOUT_MS, &expect);
+    CU_ASSERT_TRUE(expect.detected);
+    CU_ASSERT_EQUAL(expect.step, WINDOW - 1U);
+    scenario.episodes[0].onset = WINDOW - 1U;
+    fault_scenario_expect(&scenario, STEP_MS, TIMEOUT_MS, &expect);
+    CU_ASSERT_FALSE(expect.detected);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: injection into the BCM safety watchdog
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_fault_inject_run
+ * @brief An injected fault is reported on the expected sample with the
+ * safety timeout as latency, and error_disabled is sent; only healthy
+ * cycles long enough for the window are accepted
+ * @req SWR6.1
+ * @req SWR6.4
+ * @file unit/test_fault_inject.c
+ */
+static void test_fault_inject_run(void)
+{
+    FaultScenario scenario;
+    FaultInjectResult result;
+
+    CU_ASSERT_EQUAL(fault_inject_timeout_ms(), TIMEOUT_MS);
+    CU_ASSERT_TRUE(fault_inject_cycle_healthy(CYCLE_HEALTHY, WINDOW));
+    CU_ASSERT_FALSE(fault_inject_cycle_healthy(CYCLE_HEALTHY, CYCLE_ROWS));
+    CU_ASSERT_FALSE(fault_inject_cycle_healthy(CYCLE_FAULTY, WINDOW));
+    CU_ASSERT_TRUE(fault_inject_cycle_healthy(CYCLE_FAULTY, 4U));
+    CU_ASSERT_FALSE(fault_inject_cycle_healthy("/tmp/does_not_exist.csv", WINDOW));
+
+    stub_can_reset();
+    one_episode(&scenario, FAULT_ENGINE_TEMP, 5U, 4U, 0U, 135.0);
+    CU_ASSERT_TRUE_FATAL(fault_inject_run(CYCLE_HEALTHY, &scenario, STEP_MS, MOCK_SOCKET, NULL, NULL, &result));
+    CU_ASSERT_TRUE(result.detected);
+    CU_ASSERT_EQUAL(result.step, 6U);
+    CU_ASSERT_EQUAL(result.faults, FAULT_BIT(FAULT_ENGINE_TEMP));
+    CU_ASSERT_EQUAL(result.onset_ms, 4LL * STEP_MS);
+    CU_ASSERT_EQUAL(result.latency_ms, TIMEOUT_MS);
+    // Rows 0..5; the deadline comes before the step due at the same time
+    CU_ASSERT_EQUAL(result.published, 6UL);
+    CU_ASSERT_STRING_EQUAL(stub_can_get_last_message(), "error_disabled");
+
+    // Too short: the whole window is published, nothing reported
+    stub_can_reset();
+    scenario.episodes[0].duration = 1U;
+    CU_ASSERT_TRUE_FATAL(fault_inject_run(CYCLE_HEALTHY, &scenario, STEP_MS, MOCK_SOCKET, NULL, NULL, &result));
+    CU_ASSERT_FALSE(result.detected);
+    CU_ASSERT_EQUAL(result.latency_ms, -1LL);
+    CU_ASSERT_EQUAL(result.published, (unsigned long)WINDOW);
+    CU_ASSERT_NOT_EQUAL(strcmp(stub_can_get_last_message(), "error_disabled"), 0);
+
+    // The window must fit in the cycle
+    scenario.steps = CYCLE_ROWS;
+    CU_ASSERT_FALSE(fault_inject_run(CYCLE_HEALTHY, &scenario, STEP_MS, MOCK_SOCKET, NULL, NULL, &result));
+}
+
+static unsigned int steps_seen;
+
+static void count_step(void *arg)
+{
+    (void)arg;
+    steps_seen++;
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: a small campaign agrees with the expected outcomes
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_fault_campaign_agrees
+ * @brief Generated scenarios with every cause, combinations and intermittent
+ * faults, at two sampling rates, are all reported exactly when required
+ * @req SWR6.4
+ * @file unit/test_fault_inject.c
+ */
+static void test_fault_campaign_agrees(void)
+{
+    static const long long step_ms[] = { STEP_MS, 500LL };
+    FaultGenConfig config;
+    FaultScenario scenario;
+    FaultExpectation expect;
+    FaultInjectResult result;
+    unsigned int detected = 0U;
+    unsigned int mismatches = 0U;
+
+    fault_gen_config_default(&config);
+    config.steps = WINDOW;
+    config.max_duration = 6U;
+
+    for (size_t r = 0U; r < (sizeof(step_ms) / sizeof(step_ms[0])); r++)
+    {
+        for (uint32_t id = 0U; id < CAMPAIGN_SIZE; id++)
+        {
+            fault_scenario_generate(&config, SEED, id, &scenario);
+            fault_scenario_expect(&scenario, step_ms[r], TIMEOUT_MS, &expect);
+            steps_seen = 0U;
+            CU_ASSERT_TRUE_FATAL(fault_inject_run(CYCLE_HEALTHY, &scenario, step_ms[r], MOCK_SOCKET,
+                                                  count_step, NULL, &result));
+            // The deadline fires in the period after the last sample before it
+            CU_ASSERT_EQUAL(steps_seen, expect.detected ? (expect.step + 1U) : WINDOW);
+
+            if ((result.detected != expect.detected) ||
+                (expect.detected && ((result.step != expect.step) || (result.faults != expect.faults) ||
+                                     (result.latency_ms != TIMEOUT_MS))))
+            {
+                mismatches++;
+            }
+            detected += expect.detected ? 1U : 0U;
+        }
+    }
+    CU_ASSERT_EQUAL(mismatches, 0U);
+    CU_ASSERT_TRUE((detected > 0U) && (detected < (2U * CAMPAIGN_SIZE)));
+}
+
+int main(void)
+{
+    if (CUE_SUCCESS != CU_initialize_registry()) {
+        return CU_get_error();
+    }
+
+    CU_pSuite suite = CU_add_suite("Fault Injection Test Suite", init_suite, clean_suite);
+    if (!suite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Add tests */
+    CU_add_test(suite, "scenario generation",   test_fault_generation);
+    CU_add_test(suite, "expected outcome",      test_fault_expectation);
+    CU_add_test(suite, "injection run",         test_fault_inject_run);
+    CU_add_test(suite, "campaign agreement",    test_fault_campaign_agrees);
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+    unsigned int fails = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return (fails == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,198 @@
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../../src/common_includes/fuel_savings.h"
+#include "../../src/powertrain/powertrain_func.h"
+
+#define TEST_TELEMETRY_PATH "/tmp/unit_test_fuel_savings.tlm"
+#define STEP_MS             (1000LL)
+#define HOT_ENGINE          (100.0)
+#define HOT_IDLE_LPH        (0.70)
+#define ML_PER_LPH_SECOND   (1.0 / 3.6)     // 1 L/h during 1 s, in mL
+#define TOLERANCE           (1e-9)
+
+/* Suite init/cleanup (no special steps here) */
+static int init_suite(void) { return 0; }
+static int clean_suite(void)
+{
+    (void)unlink(TEST_TELEMETRY_PATH);
+    return 0;
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: idle fuel flow table
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_fuel_idle_flow
+ * @brief Checks the calibration corners, the bilinear interpolation between
+ * breakpoints, clamping outside the table and the AC load estimate
+ * @req SWR2.2
+ * @file unit/test_fuel_savings.c
+ */
+static void test_fuel_idle_flow(void)
+{
+    CU_ASSERT_DOUBLE_EQUAL(fuel_idle_flow_lph(20.0, 0.0), 1.30, TOLERANCE);
+    CU_ASSERT_DOUBLE_EQUAL(fuel_idle_flow_lph(100.0, 1.0), 1.10, TOLERANCE);
+    CU_ASSERT_DOUBLE_EQUAL(fuel_idle_flow_lph(HOT_ENGINE, 0.0), HOT_IDLE_LPH, TOLERANCE);
+    // Halfway on both axes: mean of the four surrounding points
+    CU_ASSERT_DOUBLE_EQUAL(fuel_idle_flow_lph(30.0, 0.25), 1.30, TOLERANCE);
+    CU_ASSERT_DOUBLE_EQUAL(fuel_idle_flow_lph(90.0, 0.5), 0.925, TOLERANCE);
+    // Clamped to the table
+    CU_ASSERT_DOUBLE_EQUAL(fuel_idle_flow_lph(-10.0, -1.0), 1.30, TOLERANCE);
+    CU_ASSERT_DOUBLE_EQUAL(fuel_idle_flow_lph(130.0, 2.0), 1.10, TOLERANCE);
+
+    CU_ASSERT_DOUBLE_EQUAL(fuel_ac_load(28.0, 23.0), 0.5, TOLERANCE);
+    CU_ASSERT_DOUBLE_EQUAL(fuel_ac_load(40.0, 23.0), 1.0, TOLERANCE);
+    CU_ASSERT_DOUBLE_EQUAL(fuel_ac_load(20.0, 23.0), 0.0, TOLERANCE);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: integration over engine-off intervals
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_fuel_savings_intervals
+ * @brief Integrates the idle flow over an engine-off interval, subtracts the
+ * restart penalty, skips sample gaps and merges runs into totals
+ * @req SWR2.2
+ * @file unit/test_fuel_savings.c
+ */
+static void test_fuel_savings_intervals(void)
+{
+    FuelSavings run;
+    FuelSavings total;
+    char text[192];
+    long long t = 0;
+
+    fuel_savings_reset(&run);
+    fuel_savings_update(&run, t, false, HOT_ENGINE, 0.0);
+    t += STEP_MS;
+    // Off from 1 s to 12 s
+    for (int i = 0; i < 11; i++)
+    {
+        fuel_savings_update(&run, t, true, HOT_ENGINE, 0.0);
+        t += STEP_MS;
+    }
+    CU_ASSERT_EQUAL(run.intervals, 1UL);
+    CU_ASSERT_EQUAL(run.restarts, 0UL);
+    CU_ASSERT_DOUBLE_EQUAL(run.engine_off_s, 10.0, TOLERANCE);
+    fuel_savings_update(&run, t, false, HOT_ENGINE, 0.0);
+    t += STEP_MS;
+    fuel_savings_update(&run, t, false, HOT_ENGINE, 0.0);
+
+    const double idle_ml = HOT_IDLE_LPH * 11.0 * ML_PER_LPH_SECOND;
+    CU_ASSERT_EQUAL(run.restarts, 1UL);
+    CU_ASSERT_DOUBLE_EQUAL(run.engine_off_s, 11.0, TOLERANCE);
+    CU_ASSERT_DOUBLE_EQUAL(run.idle_fuel_ml, idle_ml, TOLERANCE);
+    CU_ASSERT_DOUBLE_EQUAL(run.penalty_ml, FUEL_RESTART_PENALTY_ML, TOLERANCE);
+    CU_ASSERT_DOUBLE_EQUAL(fuel_savings_net_ml(&run), idle_ml - FUEL_RESTART_PENALTY_ML, TOLERANCE);
+    CU_ASSERT_DOUBLE_EQUAL(fuel_savings_co2_g(&run),
+                           (idle_ml - FUEL_RESTART_PENALTY_ML) * FUEL_CO2_G_PER_ML, TOLERANCE);
+
+    // A stalled process or a pause in a recording is not counted as engine-off time
+    fuel_savings_update(&run, t, true, HOT_ENGINE, 0.0);
+    t += FUEL_MAX_GAP_MS + 1;
+    fuel_savings_update(&run, t, true, HOT_ENGINE, 0.0);
+    CU_ASSERT_EQUAL(run.gaps, 1UL);
+    CU_ASSERT_EQUAL(run.intervals, 2UL);
+    CU_ASSERT_DOUBLE_EQUAL(run.engine_off_s, 11.0, TOLERANCE);
+
+    fuel_savings_reset(&total);
+    fuel_savings_merge(&total, &run);
+    fuel_savings_merge(&total, &run);
+    CU_ASSERT_EQUAL(total.intervals, 4UL);
+    CU_ASSERT_EQUAL(total.restarts, 2UL);
+    CU_ASSERT_DOUBLE_EQUAL(total.idle_fuel_ml, 2.0 * idle_ml, TOLERANCE);
+
+    CU_ASSERT_TRUE(fuel_savings_format(&run, text, sizeof(text)) > 0);
+    CU_ASSERT_PTR_NOT_NULL(strstr(text, "restarts=1 "));
+    CU_ASSERT_PTR_NOT_NULL(strstr(text, "fuel_saved_ml=0.1 "));
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: online powertrain estimate matches the batch one
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_fuel_savings_telemetry
+ * @brief Runs the powertrain hook step by step while recording telemetry, then
+ * estimates the same run from the telemetry file and compares both
+ * @req SWR2.2
+ * @file unit/test_fuel_savings.c
+ */
+static void test_fuel_savings_telemetry(void)
+{
+    static TelemetryReader reader;
+    static const TelemetryColumn other_columns[1] = { { "time_ms", 1U } };
+    static TelemetryWriter writer;
+    VehicleData data;
+    FuelSavings batch;
+    long long t = 0;
+
+    (void)memset(&data, 0, sizeof(data));
+    data.external_temp = 30;
+    data.temp_set = 22;
+    fuel_savings_reset(&powertrain_savings);
+    CU_ASSERT_TRUE_FATAL(open_powertrain_telemetry(TEST_TELEMETRY_PATH, false));
+
+    // Two stops, engine warming up and AC on
+    for (int step = 0; step < 40; step++)
+    {
+        engine_off = ((step >= 5) && (step < 15)) || ((step >= 25) && (step < 32));
+        data.engi_temp = 60.0 + (0.5 * (double)step);
+        record_powertrain_step(&data, t);
+        update_powertrain_savings(&data, t);
+        t += STEP_MS;
+    }
+    close_powertrain_telemetry();
+    engine_off = false;
+
+    CU_ASSERT_EQUAL(powertrain_savings.intervals, 2UL);
+    CU_ASSERT_EQUAL(powertrain_savings.restarts, 2UL);
+    CU_ASSERT_DOUBLE_EQUAL(powertrain_savings.engine_off_s, 17.0, TOLERANCE);
+    CU_ASSERT_TRUE(fuel_savings_net_ml(&powertrain_savings) > 0.0);
+
+    fuel_savings_reset(&batch);
+    CU_ASSERT_TRUE_FATAL(telemetry_reader_open(&reader, TEST_TELEMETRY_PATH));
+    CU_ASSERT_TRUE(fuel_savings_add_telemetry(&batch, &reader));
+    telemetry_reader_close(&reader);
+    CU_ASSERT_EQUAL(batch.restarts, powertrain_savings.restarts);
+    CU_ASSERT_DOUBLE_EQUAL(batch.engine_off_s, powertrain_savings.engine_off_s, TOLERANCE);
+    CU_ASSERT_DOUBLE_EQUAL(batch.idle_fuel_ml, powertrain_savings.idle_fuel_ml, 1e-6);
+
+    // Telemetry without the engine state is refused
+    CU_ASSERT_TRUE_FATAL(telemetry_open(&writer, TEST_TELEMETRY_PATH, other_columns, 1U,
+                                        TELEMETRY_CODEC_NONE));
+    CU_ASSERT_TRUE(telemetry_close(&writer));
+    CU_ASSERT_TRUE_FATAL(telemetry_reader_open(&reader, TEST_TELEMETRY_PATH));
+    CU_ASSERT_FALSE(fuel_savings_add_telemetry(&batch, &reader));
+    telemetry_reader_close(&reader);
+}
+
+int main(void)
+{
+    if (CUE_SUCCESS != CU_initialize_registry()) {
+        return CU_get_error();
+    }
+
+    CU_pSuite suite = CU_add_suite("Fuel Savings Test Suite", init_suite, clean_suite);
+    if (!suite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Add tests */
+    CU_add_test(suite, "idle fuel flow table",  test_fuel_idle_flow);
+    CU_add_test(suite, "engine-off intervals",  test_fuel_savings_intervals);
+    CU_add_test(suite, "online vs telemetry",   test_fuel_savings_telemetry);
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+    unsigned int fails = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return (fails == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,193 @@
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../src/bcm/health_watchdog.h"
+
+#define TICK_MS         (10LL)
+#define SAMPLE_MS       (1000LL)
+#define TIMEOUT_MS      (2500LL)
+#define DOOR            (0x1U)
+#define TILT            (0x4U)
+
+static TimerWheel wheel;
+static HealthWatchdog watchdog;
+static unsigned int expirations;
+static unsigned int expired_faults;
+static long long expired_ms;
+
+static void on_expired(void *arg, unsigned int faults, long long due_ms)
+{
+    (void)arg;
+    expirations++;
+    expired_faults = faults;
+    expired_ms = due_ms;
+}
+
+static void reset(long long timeout_ms)
+{
+    expirations = 0U;
+    expired_faults = 0U;
+    expired_ms = -1;
+    timer_wheel_init(&wheel, TICK_MS, 0);
+    health_watchdog_init(&watchdog, &wheel, timeout_ms, on_expired, NULL);
+}
+
+static int init_suite(void)  { return 0; }
+static int clean_suite(void) { return 0; }
+
+/* -----------------------------------------------------------------------------
+ * Test: the deadline fires on its own, between two samples
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_watchdog_deadline
+ * @brief A fault first sampled at t is reported at t + timeout by the timer
+ * wheel, not on the next sample, with the causes of the last faulty sample;
+ * the watchdog then stays latched until reset
+ * @req SWR6.4
+ * @file unit/test_health_watchdog.c
+ */
+static void test_watchdog_deadline(void)
+{
+    reset(TIMEOUT_MS);
+    health_watchdog_sample(&watchdog, 0U, 0);
+    CU_ASSERT_FALSE(health_watchdog_active(&watchdog));
+    CU_ASSERT_EQUAL(timer_wheel_next_expiry(&wheel), -1LL);
+
+    health_watchdog_sample(&watchdog, DOOR, SAMPLE_MS);
+    CU_ASSERT_TRUE(health_watchdog_active(&watchdog));
+    CU_ASSERT_EQUAL(timer_wheel_next_expiry(&wheel), SAMPLE_MS + TIMEOUT_MS);
+    health_watchdog_sample(&watchdog, DOOR | TILT, 2LL * SAMPLE_MS);
+    health_watchdog_sample(&watchdog, TILT, 3LL * SAMPLE_MS);
+    // Later samples do not move the deadline
+    CU_ASSERT_EQUAL(timer_wheel_next_expiry(&wheel), SAMPLE_MS + TIMEOUT_MS);
+
+    CU_ASSERT_EQUAL(timer_wheel_advance(&wheel, SAMPLE_MS + TIMEOUT_MS - 1), 0U);
+    CU_ASSERT_EQUAL(expirations, 0U);
+    CU_ASSERT_EQUAL(timer_wheel_advance(&wheel, SAMPLE_MS + TIMEOUT_MS), 1U);
+    CU_ASSERT_EQUAL(expirations, 1U);
+    CU_ASSERT_EQUAL(expired_ms, SAMPLE_MS + TIMEOUT_MS);
+    CU_ASSERT_EQUAL(expired_faults, TILT);
+
+    // Latched: neither a new fault nor a healthy sample re-arms it
+    health_watchdog_sample(&watchdog, 0U, 4LL * SAMPLE_MS);
+    health_watchdog_sample(&watchdog, DOOR, 5LL * SAMPLE_MS);
+    CU_ASSERT_EQUAL(timer_wheel_next_expiry(&wheel), -1LL);
+    (void)timer_wheel_advance(&wheel, 20LL * SAMPLE_MS);
+    CU_ASSERT_EQUAL(expirations, 1U);
+
+    health_watchdog_reset(&watchdog);
+    CU_ASSERT_FALSE(health_watchdog_active(&watchdog));
+    health_watchdog_sample(&watchdog, DOOR, 21LL * SAMPLE_MS);
+    CU_ASSERT_EQUAL(timer_wheel_next_expiry(&wheel), (21LL * SAMPLE_MS) + TIMEOUT_MS);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: healthy samples, ties and a zero timeout
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_watchdog_cancel_and_tie
+ * @brief A healthy sample before the deadline cancels it; one taken at the
+ * deadline itself, before the wheel delivered it, comes too late and the
+ * report keeps the deadline as its time; a zero timeout reports at once
+ * @req SWR6.4
+ * @file unit/test_health_watchdog.c
+ */
+static void test_watchdog_cancel_and_tie(void)
+{
+    reset(TIMEOUT_MS);
+    health_watchdog_sample(&watchdog, DOOR, 0);
+    health_watchdog_sample(&watchdog, 0U, TIMEOUT_MS - 1);
+    CU_ASSERT_FALSE(health_watchdog_active(&watchdog));
+    CU_ASSERT_FALSE(health_watchdog_check(&watchdog, 10LL * TIMEOUT_MS));
+    (void)timer_wheel_advance(&wheel, 10LL * TIMEOUT_MS);
+    CU_ASSERT_EQUAL(expirations, 0U);
+
+    // A new onset starts a new deadline
+    health_watchdog_sample(&watchdog, TILT, 10LL * TIMEOUT_MS);
+    CU_ASSERT_FALSE(health_watchdog_check(&watchdog, (11LL * TIMEOUT_MS) - 1));
+    health_watchdog_sample(&watchdog, 0U, 11LL * TIMEOUT_MS);
+    CU_ASSERT_EQUAL(expirations, 1U);
+    CU_ASSERT_EQUAL(expired_ms, 11LL * TIMEOUT_MS);
+    CU_ASSERT_EQUAL(expired_faults, TILT);
+    CU_ASSERT_EQUAL(timer_wheel_next_expiry(&wheel), -1LL);
+
+    // Late delivery: the report still carries the deadline
+    reset(TIMEOUT_MS);
+    health_watchdog_sample(&watchdog, DOOR, 0);
+    CU_ASSERT_TRUE(health_watchdog_check(&watchdog, 3LL * TIMEOUT_MS));
+    CU_ASSERT_EQUAL(expired_ms, TIMEOUT_MS);
+    CU_ASSERT_FALSE(health_watchdog_check(&watchdog, 4LL * TIMEOUT_MS));
+
+    reset(0);
+    health_watchdog_sample(&watchdog, DOOR, SAMPLE_MS);
+    CU_ASSERT_EQUAL(expirations, 1U);
+    CU_ASSERT_EQUAL(expired_ms, SAMPLE_MS);
+    CU_ASSERT_EQUAL(timer_wheel_next_expiry(&wheel), -1LL);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: resuming a fault condition from a checkpoint
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_watchdog_resume
+ * @brief A fault restored with the time it had already lasted keeps its
+ * original onset: the deadline is what was left of the timeout, one that had
+ * already run out is reported at once, and no fault arms nothing
+ * @req SWR6.4
+ * @file unit/test_health_watchdog.c
+ */
+static void test_watchdog_resume(void)
+{
+    const long long now_ms = 50LL * SAMPLE_MS;
+
+    reset(TIMEOUT_MS);
+    health_watchdog_resume(&watchdog, DOOR, SAMPLE_MS, now_ms);
+    CU_ASSERT_TRUE(health_watchdog_active(&watchdog));
+    CU_ASSERT_EQUAL(timer_wheel_next_expiry(&wheel), now_ms + TIMEOUT_MS - SAMPLE_MS);
+    // A later sample of the same condition does not restart it
+    health_watchdog_sample(&watchdog, DOOR, now_ms + SAMPLE_MS);
+    CU_ASSERT_EQUAL(timer_wheel_next_expiry(&wheel), now_ms + TIMEOUT_MS - SAMPLE_MS);
+    (void)timer_wheel_advance(&wheel, now_ms + TIMEOUT_MS - SAMPLE_MS);
+    CU_ASSERT_EQUAL(expirations, 1U);
+    CU_ASSERT_EQUAL(expired_faults, DOOR);
+
+    reset(TIMEOUT_MS);
+    health_watchdog_resume(&watchdog, TILT, TIMEOUT_MS, now_ms);
+    CU_ASSERT_EQUAL(expirations, 1U);
+    CU_ASSERT_EQUAL(expired_ms, now_ms);
+    CU_ASSERT_EQUAL(timer_wheel_next_expiry(&wheel), -1LL);
+
+    reset(TIMEOUT_MS);
+    health_watchdog_resume(&watchdog, 0U, SAMPLE_MS, now_ms);
+    CU_ASSERT_FALSE(health_watchdog_active(&watchdog));
+    CU_ASSERT_EQUAL(timer_wheel_next_expiry(&wheel), -1LL);
+}
+
+int main(void)
+{
+    if (CUE_SUCCESS != CU_initialize_registry()) {
+        return CU_get_error();
+    }
+
+    CU_pSuite suite = CU_add_suite("Health Watchdog Test Suite", init_suite, clean_suite);
+    if (!suite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Add tests */
+    CU_add_test(suite, "deadline",              test_watchdog_deadline);
+    CU_add_test(suite, "cancel and tie",        test_watchdog_cancel_and_tie);
+    CU_add_test(suite, "resume",                test_watchdog_resume);
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+    unsigned int fails = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return (fails == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,206 @@
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../../src/common_includes/live_state.h"
+
+#define TEST_ECU_NAME       "unit_test_live"
+#define MISSING_ECU_NAME    "unit_test_missing"
+#define RACE_UPDATES        (200000U)
+
+static LiveState writer;
+
+/* Suite init/cleanup (no special steps here) */
+static int init_suite(void) { return 0; }
+static int clean_suite(void)
+{
+    live_state_close(&writer);
+    return 0;
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: a published state is read back by a separate mapping
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_live_state_round_trip
+ * @brief Checks that monitors read the state an ECU publishes, without the bus
+ * @req SWR1.4
+ * @file unit/test_live_state.c
+ */
+static void test_live_state_round_trip(void)
+{
+    LiveState reader;
+    LiveSignals signals;
+    LiveSignals read_back;
+
+    CU_ASSERT_TRUE_FATAL(live_state_create(&writer, TEST_ECU_NAME));
+    CU_ASSERT_STRING_EQUAL(writer.name, "/ecu_live_" TEST_ECU_NAME);
+    CU_ASSERT_TRUE_FATAL(live_state_attach(&reader, TEST_ECU_NAME));
+    CU_ASSERT_STRING_EQUAL(reader.segment->ecu, TEST_ECU_NAME);
+
+    // Nothing published yet
+    CU_ASSERT_TRUE(live_state_read(&reader, &read_back));
+    CU_ASSERT_EQUAL(read_back.updates, 0U);
+    CU_ASSERT_EQUAL(read_back.present, 0U);
+
+    (void)memset(&signals, 0, sizeof(signals));
+    signals.present = LIVE_HAS_SIGNALS | LIVE_HAS_STOP_START;
+    signals.speed = 42.5;
+    signals.gear = 1;
+    signals.engine_off = 1U;
+    signals.cond_bits = 0x3FU;
+    live_state_publish(&writer, &signals);
+    signals.speed = 43.0;
+    live_state_publish(&writer, &signals);
+
+    CU_ASSERT_TRUE(live_state_read(&reader, &read_back));
+    CU_ASSERT_EQUAL(read_back.updates, 2U);
+    CU_ASSERT_EQUAL(read_back.present, LIVE_HAS_SIGNALS | LIVE_HAS_STOP_START);
+    CU_ASSERT_DOUBLE_EQUAL(read_back.speed, 43.0, 1e-9);
+    CU_ASSERT_EQUAL(read_back.gear, 1);
+    CU_ASSERT_EQUAL(read_back.engine_off, 1U);
+    CU_ASSERT_EQUAL(read_back.cond_bits, 0x3FU);
+    CU_ASSERT_TRUE(read_back.time_ms > 0);
+
+    // Readers cannot publish
+    live_state_publish(&reader, &signals);
+    CU_ASSERT_TRUE(live_state_read(&reader, &read_back));
+    CU_ASSERT_EQUAL(read_back.updates, 2U);
+
+    live_state_close(&reader);
+    CU_ASSERT_PTR_NULL(reader.segment);
+    // The reader does not remove the writer's segment
+    CU_ASSERT_TRUE(live_state_attach(&reader, TEST_ECU_NAME));
+    live_state_close(&reader);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: a reader never returns a half-written update
+ * ---------------------------------------------------------------------------*/
+static void *race_writer(void *arg)
+{
+    LiveSignals signals;
+    (void)arg;
+
+    (void)memset(&signals, 0, sizeof(signals));
+    for (unsigned int i = 1U; i <= RACE_UPDATES; i++)
+    {
+        signals.step = (int32_t)i;
+        signals.speed = (double)i;
+        signals.batt_soc = (double)i;
+        signals.commands = i;
+        live_state_publish(&writer, &signals);
+    }
+    return NULL;
+}
+
+/**
+ * @test test_live_state_consistent
+ * @brief Reads while another thread publishes and checks that every copy holds
+ * the fields of a single update; a writer stuck mid-update makes reads fail
+ * @req SWR1.4
+ * @file unit/test_live_state.c
+ */
+static void test_live_state_consistent(void)
+{
+    LiveState reader;
+    LiveSignals read_back;
+    pthread_t thread;
+    unsigned long torn = 0UL;
+    unsigned long reads = 0UL;
+    int32_t last_step = 0;
+    bool ordered = true;
+
+    // Start from a consistent update: the previous test left speed != step
+    (void)memset(&read_back, 0, sizeof(read_back));
+    live_state_publish(&writer, &read_back);
+    CU_ASSERT_TRUE_FATAL(live_state_attach(&reader, TEST_ECU_NAME));
+    CU_ASSERT_EQUAL_FATAL(pthread_create(&thread, NULL, race_writer, NULL), 0);
+    while (last_step < (int32_t)RACE_UPDATES)
+    {
+        if (!live_state_read(&reader, &read_back))
+        {
+            continue;
+        }
+        reads++;
+        if ((read_back.speed != (double)read_back.step) ||
+            (read_back.batt_soc != (double)read_back.step) ||
+            (read_back.commands != (uint32_t)read_back.step))
+        {
+            torn++;
+        }
+        ordered = ordered && (read_back.step >= last_step);
+        last_step = read_back.step;
+    }
+    (void)pthread_join(thread, NULL);
+    CU_ASSERT_TRUE(reads > 0UL);
+    CU_ASSERT_EQUAL(torn, 0UL);
+    CU_ASSERT_TRUE(ordered);
+
+    // An odd sequence means the writer stopped in the middle of an update
+    __atomic_fetch_add(&writer.segment->seq, 1U, __ATOMIC_RELEASE);
+    CU_ASSERT_FALSE(live_state_read(&reader, &read_back));
+    __atomic_fetch_add(&writer.segment->seq, 1U, __ATOMIC_RELEASE);
+    CU_ASSERT_TRUE(live_state_read(&reader, &read_back));
+    live_state_close(&reader);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: missing segments and handles that were never opened
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_live_state_missing
+ * @brief An ECU that is not running cannot be attached, publishing on a closed
+ * handle does nothing, and closing the writer removes the segment
+ * @req SWR1.4
+ * @file unit/test_live_state.c
+ */
+static void test_live_state_missing(void)
+{
+    LiveState closed;
+    LiveState reader;
+    LiveSignals signals;
+
+    CU_ASSERT_FALSE(live_state_attach(&reader, MISSING_ECU_NAME));
+    CU_ASSERT_FALSE(live_state_read(&reader, &signals));
+
+    (void)memset(&closed, 0, sizeof(closed));
+    (void)memset(&signals, 0, sizeof(signals));
+    live_state_publish(&closed, &signals);
+    CU_ASSERT_EQUAL(signals.updates, 0U);
+    live_state_close(&closed);
+
+    live_state_close(&writer);
+    CU_ASSERT_PTR_NULL(writer.segment);
+    CU_ASSERT_FALSE(live_state_attach(&reader, TEST_ECU_NAME));
+}
+
+int main(void)
+{
+    if (CUE_SUCCESS != CU_initialize_registry()) {
+        return CU_get_error();
+    }
+
+    CU_pSuite suite = CU_add_suite("Live State Test Suite", init_suite, clean_suite);
+    if (!suite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Add tests */
+    CU_add_test(suite, "round trip",            test_live_state_round_trip);
+    CU_add_test(suite, "consistent reads",      test_live_state_consistent);
+    CU_add_test(suite, "missing segments",      test_live_state_missing);
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+    unsigned int fails = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return (fails == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,192 @@
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../../src/common_includes/metrics.h"
+#include "../../src/common_includes/ecu_stats.h"
+#include "../../src/common_includes/can_reassembly.h"
+#include "../../src/common_includes/rt_sched.h"
+
+#define TEST_STATS_DIR      "/tmp"
+#define TEST_ECU_NAME       "unit_test_metrics"
+#define TEST_THREADS        (4)
+#define INCS_PER_THREAD     (10000U)
+#define FILE_BUFFER_SIZE    (4096)
+#define NS_PER_US           (1000LL)
+#define START_NS            (1000000000LL)
+#define TARGET_US           (50000LL)
+
+static int init_suite(void)
+{
+    return setenv(ECU_STATS_DIR_ENV, TEST_STATS_DIR, 1);
+}
+static int clean_suite(void) { return 0; }
+
+static size_t read_file(const char *path, char *buffer, size_t size)
+{
+    FILE *file = fopen(path, "r");
+    size_t len = 0U;
+
+    if (file != NULL)
+    {
+        len = fread(buffer, 1U, size - 1U, file);
+        (void)fclose(file);
+    }
+    buffer[len] = '\0';
+    return len;
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: per-thread counts add up when read
+ * ---------------------------------------------------------------------------*/
+static void *count_frames(void *arg)
+{
+    (void)arg;
+    for (unsigned int i = 0U; i < INCS_PER_THREAD; i++)
+    {
+        metrics_inc(METRIC_FRAMES_SENT);
+    }
+    return NULL;
+}
+
+/**
+ * @test test_metrics_threads
+ * @brief Several threads count the same event into their own shards; the total
+ * read afterwards holds every increment, including those of exited threads
+ * @req SWR1.4
+ * @file unit/test_metrics.c
+ */
+static void test_metrics_threads(void)
+{
+    pthread_t threads[TEST_THREADS];
+    const uint64_t before = metrics_get(METRIC_FRAMES_SENT);
+
+    for (int i = 0; i < TEST_THREADS; i++)
+    {
+        CU_ASSERT_EQUAL_FATAL(pthread_create(&threads[i], NULL, count_frames, NULL), 0);
+    }
+    metrics_inc(METRIC_FRAMES_SENT);
+    for (int i = 0; i < TEST_THREADS; i++)
+    {
+        (void)pthread_join(threads[i], NULL);
+    }
+    CU_ASSERT_EQUAL(metrics_get(METRIC_FRAMES_SENT),
+                    before + 1U + ((uint64_t)TEST_THREADS * INCS_PER_THREAD));
+
+    // Out of range ids are ignored
+    metrics_inc(METRIC_COUNT);
+    CU_ASSERT_EQUAL(metrics_get(METRIC_COUNT), 0U);
+    CU_ASSERT_STRING_EQUAL(metrics_name(METRIC_BUFFER_DROPS), "ecu_buffer_drops_total");
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: the shared modules count their events
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_metrics_sources
+ * @brief Checks that reassembly drops and loop overruns are counted where they
+ * are detected
+ * @req SWR1.4
+ * @file unit/test_metrics.c
+ */
+static void test_metrics_sources(void)
+{
+    static CanReassembler reasm;
+    static RtJitterReport report;
+    struct can_frame frame;
+    unsigned char out[CAN_MSG_WIRE_SIZE];
+
+    // A fragment too short to carry a header is dropped
+    const uint64_t reasm_errors = metrics_get(METRIC_REASSEMBLY_ERRORS);
+    can_reasm_reset(&reasm);
+    (void)memset(&frame, 0, sizeof(frame));
+    frame.can_id = 0x123U;
+    frame.can_dlc = 0U;
+    CU_ASSERT_EQUAL(can_reasm_push(&reasm, &frame, 0, out), CAN_REASM_DROPPED);
+    CU_ASSERT_EQUAL(metrics_get(METRIC_REASSEMBLY_ERRORS), reasm_errors + 1U);
+
+    // Periods up to target + 10% are on time
+    const uint64_t overruns = metrics_get(METRIC_LOOP_OVERRUNS);
+    (void)memset(&report, 0, sizeof(report));
+    (void)pthread_mutex_init(&report.lock, NULL);
+    RtLoop *loop = rt_jitter_add(&report, "loop", TARGET_US);
+    long long now_ns = START_NS;
+    rt_loop_tick(&report, loop, now_ns);
+    now_ns += 55000LL * NS_PER_US;
+    rt_loop_tick(&report, loop, now_ns);
+    CU_ASSERT_EQUAL(metrics_get(METRIC_LOOP_OVERRUNS), overruns);
+    now_ns += 55001LL * NS_PER_US;
+    rt_loop_tick(&report, loop, now_ns);
+    CU_ASSERT_EQUAL(metrics_get(METRIC_LOOP_OVERRUNS), overruns + 1U);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: Prometheus text exposition
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_metrics_exposition
+ * @brief Checks the exported file format and that periodic flushes are
+ * throttled to ECU_STATS_FLUSH_MS
+ * @req SWR1.4
+ * @file unit/test_metrics.c
+ */
+static void test_metrics_exposition(void)
+{
+    char buffer[FILE_BUFFER_SIZE];
+    char expected[128];
+
+    metrics_init(TEST_ECU_NAME);
+    CU_ASSERT_STRING_EQUAL(metrics_path(), TEST_STATS_DIR "/ecu_metrics_" TEST_ECU_NAME ".prom");
+
+    metrics_inc(METRIC_BUFFER_DROPS);
+    metrics_inc(METRIC_BUFFER_DROPS);
+    CU_ASSERT_TRUE(metrics_write());
+    CU_ASSERT_TRUE(read_file(metrics_path(), buffer, sizeof(buffer)) > 0U);
+    CU_ASSERT_PTR_NOT_NULL(strstr(buffer, "# TYPE ecu_frames_sent_total counter\n"));
+    CU_ASSERT_PTR_NOT_NULL(strstr(buffer, "# HELP ecu_loop_overruns_total "));
+    (void)snprintf(expected, sizeof(expected), "ecu_buffer_drops_total{ecu=\"%s\"} %llu\n",
+                   TEST_ECU_NAME, (unsigned long long)metrics_get(METRIC_BUFFER_DROPS));
+    CU_ASSERT_PTR_NOT_NULL(strstr(buffer, expected));
+    CU_ASSERT_PTR_NOT_NULL(strstr(buffer, "ecu_restart_failures_total{ecu=\"" TEST_ECU_NAME "\"} 0\n"));
+
+    // One write per flush period
+    (void)unlink(metrics_path());
+    metrics_flush(ECU_STATS_FLUSH_MS);
+    CU_ASSERT_EQUAL(access(metrics_path(), F_OK), 0);
+    (void)unlink(metrics_path());
+    metrics_flush(ECU_STATS_FLUSH_MS + 1);
+    CU_ASSERT_NOT_EQUAL(access(metrics_path(), F_OK), 0);
+    metrics_flush(2 * ECU_STATS_FLUSH_MS);
+    CU_ASSERT_EQUAL(access(metrics_path(), F_OK), 0);
+    (void)unlink(metrics_path());
+}
+
+int main(void)
+{
+    if (CUE_SUCCESS != CU_initialize_registry()) {
+        return CU_get_error();
+    }
+
+    CU_pSuite suite = CU_add_suite("Metrics Test Suite", init_suite, clean_suite);
+    if (!suite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Add tests */
+    CU_add_test(suite, "per-thread counters",   test_metrics_threads);
+    CU_add_test(suite, "event sources",         test_metrics_sources);
+    CU_add_test(suite, "text exposition",       test_metrics_exposition);
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+    unsigned int fails = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return (fails == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
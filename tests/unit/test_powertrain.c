@@ -1,6 +1,5 @@
 #include <CUnit/CUnit.h>
 #include <CUnit/Basic.h>
-#include <pthread.h>
 #include <time.h>
 #include <stdio.h>
 #include <stdbool.h>
@@ -10,6 +9,7 @@
 
 #include "../../src/powertrain/powertrain_func.h"
 #include "../../src/powertrain/can_comms.h"
+#include "../../src/powertrain/powertrain_tasks.h"
 
 #define LOG_EVENT_MSG_SIZE     (256)
 #define TEMP_OK                (25)
@@ -32,8 +32,6 @@
 #define ACCEL_OK               (0)
 #define BRAKE_OK               (1)
 #define BRAKE_FAIL             (0)
-#define SLEEP_TIME_US_TEST     (100000)
-#define USLEEP_DELAY_THREAD    (200000)
 #define GEAR_RECEIVED          (2)
 #define TEMP_SET_RECEIVED      (22)
 #define BRAKE_RECEIVED         (1)
@@ -53,6 +51,11 @@
 #define TEST_BYTE_8 0x88
 #define ERROR_BATTERY_VOLTAGE 10.2F
 #define FILE_LINE_SIZE    (256)
+#define TELEMETRY_TEST_PATH    "/tmp/test_powertrain_telemetry.bin"
+#define TELEMETRY_TIME_MS      (1700000000000LL)
+#define TELEMETRY_STEP_MS      (1000LL)
+#define TASK_POLL_MS           (10)
+#define MAX_TASK_POLLS         (20)
 
 //-------------------------------------
 // Declare the extra "mock" functions created
@@ -67,8 +70,6 @@ static const double kBattSocReceived   = 81.5;
 static const double kBattVoltReceived  = 13.2;
 static const double kEngTempReceived   = 95.4;
 static const double kDelta             = 0.001;
-static const double kSpeedMock         = 5.0;
-static const double kDeltaMock         = 0.0001;
 
 static bool mock_log_toggle_event_called = false;
 static char mock_log_toggle_event_msg[LOG_EVENT_MSG_SIZE] = {0};
@@ -519,7 +520,14 @@ static void test_handle_engine_restart(void)
     // Disable trigger for next tests
     restart_trigger = false;
 
-    // Check if the stub was called
+    // Check if the stub was called: error_battery goes out first
+    CU_ASSERT_EQUAL(stub_can_get_send_count(), 1);
+    CU_ASSERT_STRING_EQUAL(stub_can_get_last_message(), "error_battery");
+    CU_ASSERT_TRUE(disable_pending);
+
+    // The caller then lets error_disabled follow
+    CU_ASSERT_TRUE(send_pending_disable());
+    CU_ASSERT_FALSE(disable_pending);
     CU_ASSERT_EQUAL(stub_can_get_send_count(), 2);
 
     // Check if last message is about error
@@ -532,28 +540,14 @@ static void test_handle_engine_restart(void)
     };
     CU_ASSERT_TRUE(file_contains_substring(sys_disable));
 
+    // Nothing is left to send
+    CU_ASSERT_FALSE(send_pending_disable());
+    CU_ASSERT_EQUAL(stub_can_get_send_count(), 2);
+
     // Finalize and clean up
     cleanup_logging_system();
 }
 
-// 9) Check powertrain communication via CAN
-static void test_powertrain_comms_loop(void)
-{
-    test_mode_powertrain = false;
-
-    pthread_t thd;
-    pthread_create(&thd, NULL, powertrain_comms, NULL);
-
-    sleep_microseconds_pw(SLEEP_TIME_US_TEST);
-
-    // Ensure loop break
-    test_mode_powertrain = true;
-    pthread_cancel(thd);
-    pthread_join(thd, NULL);
-
-    CU_ASSERT_TRUE(true);
-}
-
 // 10) Example test that simulates reception of a valid CAN frame
 static void test_process_can_frame(void)
 {
@@ -569,70 +563,151 @@ static void test_process_can_frame(void)
     };    
     memcpy(mock_frame_to_return.data, fake_data, CAN_DATA_SIZE);
 
-    // Prepare rec_data
+    // Prepare rec_data; the stub sequence starts over
     rec_data.speed = SPEED_OK;
+    start_stop_manual = false;
+    stub_can_reset();
 
     // We need to call the logic that receives and processes frames.
     // Since "process_received_frame_powertrain()" has a for(;;),
     // we can either use #ifdef or manually replicate one iteration.
     // For this example, we manually reproduce the simplified “internal logic”:
     struct can_frame frame;
-    if (receive_can_frame(0, &frame) == 0) {
-        if (check_is_valid_can_id_powertrain(frame.can_id)) {
-            unsigned char encrypted_data[AES_BLOCK_TEST_SIZE];
-            memcpy(encrypted_data,     frame.data, CAN_DATA_SIZE);
-            memcpy(encrypted_data + CAN_DATA_SIZE, frame.data, CAN_DATA_SIZE);
+    CU_ASSERT_EQUAL_FATAL(receive_can_frame(0, &frame), 0);
+    CU_ASSERT_TRUE_FATAL(check_is_valid_can_id_powertrain(frame.can_id));
 
-            char decrypted[AES_BLOCK_TEST_SIZE];
-            decrypt_data(encrypted_data, decrypted, AES_BLOCK_TEST_SIZE);
+    unsigned char encrypted_data[AES_BLOCK_TEST_SIZE];
+    memcpy(encrypted_data,     frame.data, CAN_DATA_SIZE);
+    memcpy(encrypted_data + CAN_DATA_SIZE, frame.data, CAN_DATA_SIZE);
 
-            parse_input_received_powertrain(decrypted);
+    char decrypted[AES_BLOCK_TEST_SIZE + 1];
+    decrypt_data(encrypted_data, decrypted, AES_BLOCK_TEST_SIZE, frame.can_id);
 
-            // If decrypt_data always returns "speed: 5.0",
-            // then rec_data.speed should now be 5.0.
-            CU_ASSERT_DOUBLE_EQUAL(rec_data.speed, kSpeedMock, kDeltaMock);
-        }
-    }
+    parse_input_received_powertrain(decrypted);
+
+    // decrypt_data always returns "press_start_stop": the press toggles
+    // Stop/Start and leaves the sensor data alone
+    CU_ASSERT_TRUE(start_stop_manual);
+    CU_ASSERT_DOUBLE_EQUAL(rec_data.speed, SPEED_OK, kDelta);
 }
 
-// 11) Check thread for stop/start function
 /**
- * @test test_function_start_stop
- * @brief Tests stop start functionality
+ * @test test_powertrain_tasks
+ * @brief The reception coroutine wakes on a readable socket and takes the
+ * press in on the same thread as the Stop/Start coroutine, whose next period
+ * turns the engine off
  * @req SWR1.2
  * @file unit/test_powertrain.c
  */
-static void test_function_start_stop(void)
+static void test_powertrain_tasks(void)
 {
-    // 1. Initialize relevant globals
-    //    Make sure the mutex is initialized somewhere in your setup code:
-    //    pthread_mutex_init(&mutex_powertrain, NULL);
-    test_mode_powertrain = false;   // so the function won't exit immediately
-    start_stop_manual    = true;    // "driver" turned on stop/start
-    engine_off = false;   // begins inactive
-
-    // 2. Set up a VehicleData with conditions that pass check_disable_engine()
-    VehicleData data_test = base_ok_data();
+    static CoroScheduler sched;
+    static PowertrainTasks tasks;
+    int fds[2];
+
+    test_mode_powertrain = false;
+    start_stop_manual = false;
+    engine_off = false;
+    rec_data = base_ok_data();
+    stub_can_reset();
 
-    // 3. Start the function_start_stop in a separate thread
-    pthread_t thd;
-    pthread_create(&thd, NULL, function_start_stop, &data_test);
+    // A pipe with a byte in it stands for a socket with frames pending
+    CU_ASSERT_EQUAL_FATAL(pipe(fds), 0);
+    CU_ASSERT_EQUAL(write(fds[1], "x", 1U), 1);
+    sock_receiver = fds[0];
 
-    // 4. Let the thread run for a moment
-    sleep_microseconds_pw(USLEEP_DELAY_THREAD); // 200ms - enough time for the loop to run a couple times
+    CU_ASSERT_TRUE_FATAL(coro_sched_init(&sched, TASK_POLL_MS));
+    CU_ASSERT_TRUE_FATAL(powertrain_tasks_spawn(&sched, &tasks));
+    for (int i = 0; (i < MAX_TASK_POLLS) && (tasks.frames == 0UL); i++)
+    {
+        CU_ASSERT_TRUE(coro_sched_poll(&sched, TASK_POLL_MS));
+    }
+
+    // The first period ran before the press came in
+    CU_ASSERT_EQUAL(tasks.frames, 3UL + CAN_FRAGS_PER_MSG);
+    CU_ASSERT_EQUAL(tasks.periods, 1UL);
+    CU_ASSERT_TRUE(start_stop_manual);
+    CU_ASSERT_FALSE(engine_off);
+    CU_ASSERT_EQUAL(tasks.start_stop.state, CORO_SLEEPING);
+    CU_ASSERT_EQUAL(timer_wheel_next_expiry(&sched.wheel), tasks.next_period_ms);
 
-    // 5. Check if engine_off got set to 'true'
-    //    Because our conditions above should pass in check_disable_engine().
+    // The next one, a period later, turns the engine off (nothing left to read)
+    char byte;
+    CU_ASSERT_EQUAL(read(fds[0], &byte, 1U), 1);
+    for (int i = 0; (i < MAX_TASK_POLLS) && (tasks.periods < 2UL); i++)
+    {
+        CU_ASSERT_TRUE(coro_sched_poll(&sched, -1));
+    }
+    CU_ASSERT_EQUAL(tasks.periods, 2UL);
     CU_ASSERT_TRUE(engine_off);
+    CU_ASSERT_STRING_EQUAL(stub_can_get_last_message(), "ENGINE OFF");
+    CU_ASSERT_EQUAL(sched.live, 2U);
 
-    // 6. Now signal the loop to exit
     test_mode_powertrain = true;
+    coro_sched_close(&sched);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+// 11) Check the SWR3.5 disable from the Stop/Start coroutine
+/**
+ * @test test_powertrain_tasks_disable
+ * @brief A refused restart sends error_battery in its period and
+ * error_disabled PT_TASK_DISABLE_GAP_MS later, the Stop/Start coroutine
+ * sleeping on the scheduler in between
+ * @req SWR3.5
+ * @file unit/test_powertrain.c
+ */
+static void test_powertrain_tasks_disable(void)
+{
+    static CoroScheduler sched;
+    static PowertrainTasks tasks;
+    int fds[2];
+
+    test_mode_powertrain = false;
+    start_stop_manual = true;
+    engine_off = true;
+    restart_trigger = false;
+    disable_pending = false;
+    rec_data = base_ok_data();
+    rec_data.batt_soc   = BATT_SOC_LOW;
+    rec_data.prev_brake = BRAKE_OK;
+    rec_data.brake      = BRAKE_FAIL; // brake_released
+    stub_can_reset();
+
+    // An empty pipe stands for a socket with nothing to read
+    CU_ASSERT_EQUAL_FATAL(pipe(fds), 0);
+    sock_receiver = fds[0];
 
-    // 7. Join the thread to ensure clean exit
-    pthread_join(thd, NULL);
+    CU_ASSERT_TRUE_FATAL(coro_sched_init(&sched, TASK_POLL_MS));
+    CU_ASSERT_TRUE_FATAL(powertrain_tasks_spawn(&sched, &tasks));
+    for (int i = 0; (i < MAX_TASK_POLLS) && (tasks.periods == 0UL); i++)
+    {
+        CU_ASSERT_TRUE(coro_sched_poll(&sched, TASK_POLL_MS));
+    }
 
-    // If we reached here, we can do final checks or just pass
-    CU_ASSERT_TRUE(true);
+    // The period refused the restart and the disable waits on the scheduler
+    CU_ASSERT_EQUAL(tasks.periods, 1UL);
+    CU_ASSERT_TRUE(engine_off);
+    CU_ASSERT_TRUE(disable_pending);
+    CU_ASSERT_STRING_EQUAL(stub_can_get_last_message(), "error_battery");
+    CU_ASSERT_EQUAL(tasks.start_stop.state, CORO_SLEEPING);
+    CU_ASSERT_TRUE(timer_wheel_next_expiry(&sched.wheel) < tasks.next_period_ms + PT_TASK_PERIOD_MS);
+
+    for (int i = 0; (i < MAX_TASK_POLLS) && disable_pending; i++)
+    {
+        CU_ASSERT_TRUE(coro_sched_poll(&sched, -1));
+    }
+    CU_ASSERT_FALSE(disable_pending);
+    CU_ASSERT_EQUAL(tasks.periods, 1UL);
+    CU_ASSERT_STRING_EQUAL(stub_can_get_last_message(), "error_disabled");
+    CU_ASSERT_EQUAL(sched.live, 2U);
+
+    test_mode_powertrain = true;
+    restart_trigger = false;
+    coro_sched_close(&sched);
+    close(fds[0]);
+    close(fds[1]);
 }
 
 // 12) Check parse for sensor inputs
@@ -707,6 +782,230 @@ static void test_parse_input_variants_pw(void)
     CU_ASSERT_EQUAL(rec_data.gear, GEAR_RECEIVED);
 }
 
+/**
+ * @test test_apply_sensor_pdu_pw
+ * @brief Tests that a multiplexed sensor PDU only updates the signals it carries
+ * @req SWR1.2
+ * @file unit/test_powertrain.c
+ */
+static void test_apply_sensor_pdu_pw(void)
+{
+    SensorPdu pdu = {0};
+    unsigned char block[SENSOR_PDU_SIZE];
+
+    memset(&rec_data, 0, sizeof(rec_data));
+    rec_data.internal_temp = INTERNAL_TEMP_RECEIVED;
+
+    pdu.present = (uint16_t)((1U << SENSOR_SIG_SPEED) | (1U << SENSOR_SIG_BATT_VOLT) |
+                             (1U << SENSOR_SIG_BRAKE));
+    pdu.speed = kSpeedReceived;
+    pdu.batt_volt = kBattVoltReceived;
+    pdu.brake = BRAKE_RECEIVED;
+    pdu.internal_temp = TEMP_LOW;   // not present => must be ignored
+    sensor_pdu_encode(&pdu, block);
+
+    CU_ASSERT_TRUE(apply_sensor_pdu_powertrain(block));
+    CU_ASSERT_DOUBLE_EQUAL(rec_data.speed, kSpeedReceived, kDelta);
+    CU_ASSERT_DOUBLE_EQUAL(rec_data.batt_volt, kBattVoltReceived, kDelta);
+    CU_ASSERT_EQUAL(rec_data.brake, BRAKE_RECEIVED);
+    CU_ASSERT_EQUAL(rec_data.internal_temp, INTERNAL_TEMP_RECEIVED);
+
+    // Text messages are left to parse_input_received_powertrain
+    CU_ASSERT_FALSE(apply_sensor_pdu_powertrain((const unsigned char *)"speed: 45.7\0\0\0\0"));
+}
+
+/**
+ * @test test_condition_reports_on_transition
+ * @brief Tests that a failed condition is reported once per transition, not every step
+ * @req SWR2.8
+ * @file unit/test_powertrain.c
+ */
+static void test_condition_reports_on_transition(void)
+{
+    start_stop_manual = true;
+    engine_off = false;
+    reset_engine_condition_reports();
+
+    VehicleData data_test = base_ok_data();
+    data_test.door_open = DOOR_FAIL;
+    CU_ASSERT_EQUAL(evaluate_engine_conditions(&data_test), COND_BITS_ALL & ~COND_BIT_DOOR);
+
+    // Same failure on consecutive steps => one error frame
+    stub_can_reset();
+    check_disable_engine(&data_test);
+    check_disable_engine(&data_test);
+    check_disable_engine(&data_test);
+    CU_ASSERT_EQUAL(stub_can_get_send_count(), 1);
+    CU_ASSERT_STRING_EQUAL(stub_can_get_last_message(), "error_door_open");
+
+    // A second condition failing => only the new one is reported
+    data_test.tilt_angle = TILT_FAIL;
+    stub_can_reset();
+    check_disable_engine(&data_test);
+    CU_ASSERT_EQUAL(stub_can_get_send_count(), 1);
+    CU_ASSERT_STRING_EQUAL(stub_can_get_last_message(), "error_tilt_angle");
+
+    // Recovery then failure again => reported again
+    data_test.door_open = DOOR_OK;
+    stub_can_reset();
+    check_disable_engine(&data_test);
+    CU_ASSERT_EQUAL(stub_can_get_send_count(), 0);
+    data_test.door_open = DOOR_FAIL;
+    check_disable_engine(&data_test);
+    CU_ASSERT_EQUAL(stub_can_get_send_count(), 1);
+    CU_ASSERT_STRING_EQUAL(stub_can_get_last_message(), "error_door_open");
+
+    // Engine off => failures are never reported
+    engine_off = true;
+    data_test.brake = BRAKE_FAIL;
+    stub_can_reset();
+    check_disable_engine(&data_test);
+    CU_ASSERT_EQUAL(stub_can_get_send_count(), 0);
+    CU_ASSERT_EQUAL(engine_condition_bits,
+                    COND_BITS_ALL & ~(COND_BIT_DOOR | COND_BIT_TILT | COND_BIT_MOVEMENT));
+    engine_off = false;
+}
+
+/**
+ * @test test_record_powertrain_step
+ * @brief Tests that each step's signals and decision bits reach the telemetry file
+ * @req SWR1.2
+ * @file unit/test_powertrain.c
+ */
+static void test_record_powertrain_step(void)
+{
+    static TelemetryReader reader;
+    VehicleData data_test = base_ok_data();
+
+    // Not opened => nothing is recorded and nothing fails
+    record_powertrain_step(&data_test, TELEMETRY_TIME_MS);
+
+    CU_ASSERT_TRUE_FATAL(open_powertrain_telemetry(TELEMETRY_TEST_PATH, false));
+
+    start_stop_manual = true;
+    engine_off = false;
+    stub_can_reset();
+    check_disable_engine(&data_test);
+    CU_ASSERT_EQUAL(engine_condition_bits, COND_BITS_ALL);
+    record_powertrain_step(&data_test, TELEMETRY_TIME_MS);
+
+    data_test.door_open = DOOR_FAIL;
+    data_test.batt_volt = kBattVoltReceived;
+    check_disable_engine(&data_test);
+    CU_ASSERT_EQUAL(engine_condition_bits, COND_BITS_ALL & ~COND_BIT_DOOR);
+    record_powertrain_step(&data_test, TELEMETRY_TIME_MS + TELEMETRY_STEP_MS);
+    close_powertrain_telemetry();
+
+    CU_ASSERT_TRUE_FATAL(telemetry_reader_open(&reader, TELEMETRY_TEST_PATH));
+    CU_ASSERT_TRUE_FATAL(telemetry_read_block(&reader));
+    CU_ASSERT_EQUAL(reader.rows, 2U);
+
+    const int time_col = telemetry_column_index(&reader, "time_ms");
+    const int volt_col = telemetry_column_index(&reader, "batt_volt");
+    const int off_col = telemetry_column_index(&reader, "engine_off");
+    const int cond_col = telemetry_column_index(&reader, "cond_bits");
+    CU_ASSERT_TRUE_FATAL((time_col >= 0) && (volt_col >= 0) && (off_col >= 0) && (cond_col >= 0));
+
+    CU_ASSERT_DOUBLE_EQUAL(telemetry_value(&reader, (uint32_t)time_col, 1U),
+                           TELEMETRY_TIME_MS + TELEMETRY_STEP_MS, kDelta);
+    CU_ASSERT_DOUBLE_EQUAL(telemetry_value(&reader, (uint32_t)volt_col, 0U), BATT_VOLT_OK, kDelta);
+    CU_ASSERT_DOUBLE_EQUAL(telemetry_value(&reader, (uint32_t)volt_col, 1U), kBattVoltReceived, kDelta);
+    CU_ASSERT_EQUAL(reader.values[off_col][1], 1);
+    CU_ASSERT_EQUAL(reader.values[cond_col][0], (int64_t)COND_BITS_ALL);
+    CU_ASSERT_EQUAL(reader.values[cond_col][1], (int64_t)(COND_BITS_ALL & ~COND_BIT_DOOR));
+    CU_ASSERT_FALSE(telemetry_read_block(&reader));
+
+    telemetry_reader_close(&reader);
+    (void)unlink(TELEMETRY_TEST_PATH);
+}
+
+/**
+ * @test test_powertrain_checkpoint_round_trip
+ * @brief Tests that a saved snapshot brings back the received data, the
+ * Stop/Start state, the reported failures, the savings totals and the counters
+ * @req SWR1.2
+ * @req SWR2.8
+ * @file unit/test_powertrain.c
+ */
+static void test_powertrain_checkpoint_round_trip(void)
+{
+    CU_ASSERT_EQUAL(setenv(CHECKPOINT_DIR_ENV, "/tmp", 1), 0);
+    CU_ASSERT_TRUE_FATAL(checkpoint_init(&powertrain_checkpoint, "unit_test_powertrain"));
+    (void)unlink(powertrain_checkpoint.path);
+
+    // A door failure reported once, then the engine stopped
+    start_stop_manual = true;
+    engine_off = false;
+    reset_engine_condition_reports();
+    VehicleData data_test = base_ok_data();
+    data_test.door_open = DOOR_FAIL;
+    data_test.batt_soc = kBattSocReceived;
+    data_test.batt_volt = kBattVoltReceived;
+    stub_can_reset();
+    check_disable_engine(&data_test);
+    CU_ASSERT_EQUAL(stub_can_get_send_count(), 1);
+    rec_data = data_test;
+    engine_off = true;
+    restart_trigger = true;
+    fuel_savings_reset(&powertrain_savings);
+    powertrain_savings.engine_off_s = 12.5;
+    powertrain_savings.idle_fuel_ml = 3.25;
+    powertrain_savings.intervals = 4UL;
+    powertrain_savings.restarts = 3UL;
+    powertrain_savings.last_ms = TELEMETRY_TIME_MS;
+    metrics_add(METRIC_FRAMES_ACCEPTED, 42U);
+    metrics_add(METRIC_MESSAGES_PROCESSED, 40U);
+    metrics_add(METRIC_DECRYPT_FAILURES, 2U);
+    EcuStats saved;
+    ecu_stats_get(&saved);
+    CU_ASSERT_TRUE_FATAL(save_powertrain_checkpoint());
+
+    // A new process
+    memset(&rec_data, 0, sizeof(rec_data));
+    engine_off = false;
+    restart_trigger = false;
+    start_stop_manual = false;
+    reset_engine_condition_reports();
+    fuel_savings_reset(&powertrain_savings);
+    EcuStats before;
+    EcuStats after;
+    ecu_stats_get(&before);
+    CU_ASSERT_TRUE_FATAL(checkpoint_init(&powertrain_checkpoint, "unit_test_powertrain"));
+    CU_ASSERT_TRUE_FATAL(restore_powertrain_checkpoint());
+    ecu_stats_get(&after);
+    CU_ASSERT_EQUAL(powertrain_checkpoint.sequence, 1U);
+
+    CU_ASSERT_DOUBLE_EQUAL(rec_data.batt_soc, kBattSocReceived, kDelta);
+    CU_ASSERT_DOUBLE_EQUAL(rec_data.batt_volt, kBattVoltReceived, kDelta);
+    CU_ASSERT_EQUAL(rec_data.door_open, DOOR_FAIL);
+    CU_ASSERT_TRUE(engine_off);
+    CU_ASSERT_TRUE(restart_trigger);
+    CU_ASSERT_TRUE(start_stop_manual);
+    CU_ASSERT_DOUBLE_EQUAL(powertrain_savings.engine_off_s, 12.5, kDelta);
+    CU_ASSERT_DOUBLE_EQUAL(powertrain_savings.idle_fuel_ml, 3.25, kDelta);
+    CU_ASSERT_EQUAL(powertrain_savings.intervals, 4UL);
+    CU_ASSERT_EQUAL(powertrain_savings.restarts, 3UL);
+    // The time between the two runs is not integrated
+    CU_ASSERT_EQUAL(powertrain_savings.last_ms, -1LL);
+    // The saved counters are added to those of the new process
+    CU_ASSERT_TRUE(saved.frames_rx >= 42UL);
+    CU_ASSERT_EQUAL(after.frames_rx, before.frames_rx + saved.frames_rx);
+    CU_ASSERT_EQUAL(after.msgs_processed, before.msgs_processed + saved.msgs_processed);
+    CU_ASSERT_EQUAL(after.msgs_rejected, before.msgs_rejected + saved.msgs_rejected);
+
+    // The door failure was reported before the restart: not again
+    engine_off = false;
+    restart_trigger = false;
+    stub_can_reset();
+    check_disable_engine(&rec_data);
+    CU_ASSERT_EQUAL(stub_can_get_send_count(), 0);
+
+    (void)unlink(powertrain_checkpoint.path);
+    (void)unsetenv(CHECKPOINT_DIR_ENV);
+    CU_ASSERT_FALSE(checkpoint_init(&powertrain_checkpoint, "powertrain"));
+    fuel_savings_reset(&powertrain_savings);
+}
+
 int main(void)
 {
     // Initialize CUnit test registry
@@ -732,10 +1031,14 @@ int main(void)
     CU_add_test(suite, "fail_cond6",               test_check_disable_engine_fail_cond6);
     CU_add_test(suite, "deactivate_when_active",   test_check_disable_engine);
     CU_add_test(suite, "handle_engine_restart",    test_handle_engine_restart);
-    CU_add_test(suite, "powertrain_comms_loop",    test_powertrain_comms_loop);
     CU_add_test(suite, "test_process_can_frame",   test_process_can_frame);
-    CU_add_test(suite, "function_start_stop test", test_function_start_stop);
+    CU_add_test(suite, "powertrain_tasks",         test_powertrain_tasks);
+    CU_add_test(suite, "powertrain_tasks_disable", test_powertrain_tasks_disable);
     CU_add_test(suite, "parse_input_variants_pw", test_parse_input_variants_pw);
+    CU_add_test(suite, "apply_sensor_pdu_pw",     test_apply_sensor_pdu_pw);
+    CU_add_test(suite, "condition_reports",       test_condition_reports_on_transition);
+    CU_add_test(suite, "record_powertrain_step",  test_record_powertrain_step);
+    CU_add_test(suite, "checkpoint_round_trip",   test_powertrain_checkpoint_round_trip);
 
     // Run all tests in verbose mode
     CU_basic_set_mode(CU_BRM_VERBOSE);
@@ -0,0 +1,234 @@
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../../src/common_includes/rt_sched.h"
+#include "../../src/common_includes/ecu_stats.h"
+
+#define TEST_STATS_DIR      "/tmp"
+#define TEST_ECU_NAME       "unit_test_rt"
+#define NS_PER_US           (1000LL)
+#define START_NS            (5000000000LL)
+#define TARGET_US           (50000LL)
+#define REPORT_LINE_SIZE    (160)
+
+static int init_suite(void)
+{
+    (void)unsetenv(RT_ENABLE_ENV);
+    (void)unsetenv(RT_CPUS_ENV);
+    (void)unsetenv(RT_PRIORITY_ENV);
+    return setenv(ECU_STATS_DIR_ENV, TEST_STATS_DIR, 1);
+}
+static int clean_suite(void) { return 0; }
+
+/* -----------------------------------------------------------------------------
+ * Test: RT mode is opt-in and its settings are validated
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_rt_config
+ * @brief Checks that RT mode stays off by default, that CPU lists and priorities
+ * are parsed, and that malformed values disable it with an error
+ * @req SWR1.4
+ * @file unit/test_rt_sched.c
+ */
+static void test_rt_config(void)
+{
+    RtConfig config;
+
+    // Off by default: nothing is changed for the thread
+    CU_ASSERT_TRUE(rt_config_load(&config));
+    CU_ASSERT_FALSE(config.enabled);
+    CU_ASSERT_TRUE(rt_init(TEST_ECU_NAME));
+    CU_ASSERT_FALSE(rt_enabled());
+    CU_ASSERT_TRUE(rt_configure_thread("test", 0U, 0));
+
+    (void)setenv(RT_ENABLE_ENV, "1", 1);
+    CU_ASSERT_TRUE(rt_config_load(&config));
+    CU_ASSERT_TRUE(config.enabled);
+    CU_ASSERT_EQUAL(config.priority, RT_DEFAULT_PRIORITY);
+    CU_ASSERT_EQUAL(config.num_cpus, 0U);
+
+    (void)setenv(RT_CPUS_ENV, "0,2-4", 1);
+    (void)setenv(RT_PRIORITY_ENV, "80", 1);
+    CU_ASSERT_TRUE(rt_config_load(&config));
+    CU_ASSERT_EQUAL(config.priority, 80);
+    CU_ASSERT_EQUAL_FATAL(config.num_cpus, 4U);
+    CU_ASSERT_EQUAL(config.cpus[0], 0);
+    CU_ASSERT_EQUAL(config.cpus[1], 2);
+    CU_ASSERT_EQUAL(config.cpus[3], 4);
+
+    (void)setenv(RT_CPUS_ENV, "3-1", 1);
+    CU_ASSERT_FALSE(rt_config_load(&config));
+    CU_ASSERT_FALSE(config.enabled);
+    (void)setenv(RT_CPUS_ENV, "1,x", 1);
+    CU_ASSERT_FALSE(rt_config_load(&config));
+
+    (void)setenv(RT_CPUS_ENV, "1", 1);
+    (void)setenv(RT_PRIORITY_ENV, "100", 1);
+    CU_ASSERT_FALSE(rt_config_load(&config));
+    (void)setenv(RT_PRIORITY_ENV, "high", 1);
+    CU_ASSERT_FALSE(rt_config_load(&config));
+    CU_ASSERT_FALSE(config.enabled);
+
+    // "0" or anything but "1" keeps it off
+    (void)setenv(RT_ENABLE_ENV, "0", 1);
+    CU_ASSERT_TRUE(rt_config_load(&config));
+    CU_ASSERT_FALSE(config.enabled);
+    init_suite();
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: measured periods are compared to the loop target
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_rt_jitter_stats
+ * @brief Feeds known tick times to a loop and checks the period and error
+ * statistics, then reads them back from the exported report
+ * @req SWR1.4
+ * @file unit/test_rt_sched.c
+ */
+static void test_rt_jitter_stats(void)
+{
+    static RtJitterReport report;
+    const long long periods_us[] = { 49000LL, 52000LL, 50000LL, 60000LL };
+    long long now_ns = START_NS;
+
+    rt_jitter_init(&report, TEST_ECU_NAME);
+    CU_ASSERT_STRING_EQUAL(report.path, TEST_STATS_DIR "/ecu_jitter_" TEST_ECU_NAME ".txt");
+    RtLoop *loop = rt_jitter_add(&report, "comms", TARGET_US);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(loop);
+
+    // The first tick only starts the measurement
+    rt_loop_tick(&report, loop, now_ns);
+    CU_ASSERT_EQUAL(loop->periods, 0UL);
+    for (size_t i = 0U; i < sizeof(periods_us) / sizeof(periods_us[0]); i++)
+    {
+        now_ns += periods_us[i] * NS_PER_US;
+        rt_loop_tick(&report, loop, now_ns);
+    }
+    CU_ASSERT_EQUAL(loop->periods, 4UL);
+    CU_ASSERT_EQUAL(loop->min_us, 49000LL);
+    CU_ASSERT_EQUAL(loop->max_us, 60000LL);
+    CU_ASSERT_EQUAL(loop->sum_us, 211000LL);
+    CU_ASSERT_EQUAL(loop->sum_abs_error_us, 13000LL);
+    CU_ASSERT_EQUAL(loop->max_abs_error_us, 10000LL);
+
+    // Untracked loops are ignored
+    rt_loop_tick(&report, NULL, now_ns);
+    rt_loop_tick(NULL, loop, now_ns);
+    CU_ASSERT_EQUAL(loop->periods, 4UL);
+
+    CU_ASSERT_TRUE(rt_jitter_write(&report));
+    FILE *file = fopen(report.path, "r");
+    char line[REPORT_LINE_SIZE];
+    CU_ASSERT_PTR_NOT_NULL_FATAL(file);
+    CU_ASSERT_PTR_NOT_NULL(fgets(line, sizeof(line), file));
+    CU_ASSERT_EQUAL(line[0], '#');
+    CU_ASSERT_PTR_NOT_NULL(fgets(line, sizeof(line), file));
+    CU_ASSERT_STRING_EQUAL(line, "comms 50000 4 49000 52750 60000 3250 10000\n");
+    (void)fclose(file);
+    (void)unlink(report.path);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: the report is written by the flush path, never by a tick
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_rt_jitter_flush
+ * @brief Checks that ticking a loop writes no file, and that rt_jitter_flush
+ * writes the report at most every ECU_STATS_FLUSH_MS
+ * @req SWR1.4
+ * @file unit/test_rt_sched.c
+ */
+static void test_rt_jitter_flush(void)
+{
+    static RtJitterReport report;
+    const long long now_ms = START_NS / (NS_PER_US * 1000LL);
+
+    rt_jitter_init(&report, TEST_ECU_NAME);
+    RtLoop *loop = rt_jitter_add(&report, "step", TARGET_US);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(loop);
+    (void)unlink(report.path);
+
+    rt_loop_tick(&report, loop, START_NS);
+    rt_loop_tick(&report, loop, START_NS + (TARGET_US * NS_PER_US));
+    CU_ASSERT_EQUAL(loop->periods, 1UL);
+    CU_ASSERT_NOT_EQUAL(access(report.path, F_OK), 0);
+
+    rt_jitter_flush(&report, now_ms);
+    CU_ASSERT_EQUAL(access(report.path, F_OK), 0);
+
+    // Not rewritten before the flush period has elapsed
+    (void)unlink(report.path);
+    rt_jitter_flush(&report, now_ms + ECU_STATS_FLUSH_MS - 1LL);
+    CU_ASSERT_NOT_EQUAL(access(report.path, F_OK), 0);
+    rt_jitter_flush(&report, now_ms + ECU_STATS_FLUSH_MS);
+    CU_ASSERT_EQUAL(access(report.path, F_OK), 0);
+
+    // Untracked reports are ignored
+    rt_jitter_flush(NULL, now_ms);
+    (void)unlink(report.path);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: report capacity and uninitialized reports
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_rt_jitter_limits
+ * @brief A full report refuses more loops, and a report that was never
+ * initialized is not written
+ * @req SWR1.4
+ * @file unit/test_rt_sched.c
+ */
+static void test_rt_jitter_limits(void)
+{
+    static RtJitterReport report;
+    static RtJitterReport unset;
+    unsigned char buffer[3U * 4096U + 7U];
+
+    rt_jitter_init(&report, TEST_ECU_NAME);
+    for (size_t i = 0U; i < RT_MAX_LOOPS; i++)
+    {
+        CU_ASSERT_PTR_NOT_NULL(rt_jitter_add(&report, "loop", TARGET_US));
+    }
+    CU_ASSERT_PTR_NULL(rt_jitter_add(&report, "extra", TARGET_US));
+
+    CU_ASSERT_FALSE(rt_jitter_write(&unset));
+
+    // Pre-faulting only touches the pages, the content is unchanged
+    (void)memset(buffer, 0x5A, sizeof(buffer));
+    rt_prefault(buffer, sizeof(buffer));
+    CU_ASSERT_EQUAL(buffer[0], 0x5A);
+    CU_ASSERT_EQUAL(buffer[sizeof(buffer) - 1U], 0x5A);
+    CU_ASSERT_TRUE(rt_now_ns() > 0LL);
+}
+
+int main(void)
+{
+    if (CUE_SUCCESS != CU_initialize_registry()) {
+        return CU_get_error();
+    }
+
+    CU_pSuite suite = CU_add_suite("RT Scheduling Test Suite", init_suite, clean_suite);
+    if (!suite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Add tests */
+    CU_add_test(suite, "configuration",         test_rt_config);
+    CU_add_test(suite, "jitter statistics",     test_rt_jitter_stats);
+    CU_add_test(suite, "jitter flush",          test_rt_jitter_flush);
+    CU_add_test(suite, "jitter limits",         test_rt_jitter_limits);
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+    unsigned int fails = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return (fails == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
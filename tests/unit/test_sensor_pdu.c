@@ -0,0 +1,146 @@
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "../../src/common_includes/sensor_pdu.h"
+
+#define TEST_SPEED          (87.3)
+#define TEST_TILT           (-12.4)
+#define TEST_BATT_SOC       (64.9)
+#define TEST_BATT_VOLT      (12.37)
+#define TEST_ENGI_TEMP      (101.6)
+#define TEST_IN_TEMP        (-5)
+#define TEST_EX_TEMP        (34)
+#define TEST_TEMP_SET       (23)
+#define TEST_DOOR_INVALID   (2)
+#define TEST_SPEED_HUGE     (1.0e9)
+#define TEST_UNTOUCHED      (-1)
+#define TEST_DELTA          (0.001)
+
+/* Suite init/cleanup (no special steps here) */
+static int init_suite(void) { return 0; }
+static int clean_suite(void) { return 0; }
+
+/* -----------------------------------------------------------------------------
+ * Test: every signal survives an encode/decode round trip
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_sensor_pdu_round_trip
+ * @brief Checks that all sensor signals fit in one block and decode unchanged
+ * @req SWR2.1
+ * @file unit/test_sensor_pdu.c
+ */
+static void test_sensor_pdu_round_trip(void)
+{
+    SensorPdu in = {0};
+    SensorPdu out = {0};
+    unsigned char block[SENSOR_PDU_SIZE];
+
+    in.present = SENSOR_PDU_ALL_PRESENT;
+    in.speed = TEST_SPEED;
+    in.tilt_angle = TEST_TILT;
+    in.batt_soc = TEST_BATT_SOC;
+    in.batt_volt = TEST_BATT_VOLT;
+    in.engi_temp = TEST_ENGI_TEMP;
+    in.internal_temp = TEST_IN_TEMP;
+    in.external_temp = TEST_EX_TEMP;
+    in.temp_set = TEST_TEMP_SET;
+    in.door_open = TEST_DOOR_INVALID;
+    in.accel = 1;
+    in.brake = 0;
+    in.gear = 1;
+
+    sensor_pdu_encode(&in, block);
+    CU_ASSERT_TRUE(sensor_pdu_is_pdu(block));
+    CU_ASSERT_TRUE(sensor_pdu_decode(block, &out));
+
+    CU_ASSERT_EQUAL(out.present, SENSOR_PDU_ALL_PRESENT);
+    CU_ASSERT_DOUBLE_EQUAL(out.speed, TEST_SPEED, TEST_DELTA);
+    CU_ASSERT_DOUBLE_EQUAL(out.tilt_angle, TEST_TILT, TEST_DELTA);
+    CU_ASSERT_DOUBLE_EQUAL(out.batt_soc, TEST_BATT_SOC, TEST_DELTA);
+    CU_ASSERT_DOUBLE_EQUAL(out.batt_volt, TEST_BATT_VOLT, TEST_DELTA);
+    CU_ASSERT_DOUBLE_EQUAL(out.engi_temp, TEST_ENGI_TEMP, TEST_DELTA);
+    CU_ASSERT_EQUAL(out.internal_temp, TEST_IN_TEMP);
+    CU_ASSERT_EQUAL(out.external_temp, TEST_EX_TEMP);
+    CU_ASSERT_EQUAL(out.temp_set, TEST_TEMP_SET);
+    CU_ASSERT_EQUAL(out.door_open, TEST_DOOR_INVALID);
+    CU_ASSERT_EQUAL(out.accel, 1);
+    CU_ASSERT_EQUAL(out.brake, 0);
+    CU_ASSERT_EQUAL(out.gear, 1);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: signals without their presence bit are left untouched
+ * ---------------------------------------------------------------------------*/
+static void test_sensor_pdu_partial(void)
+{
+    SensorPdu in = {0};
+    SensorPdu out = {0};
+    unsigned char block[SENSOR_PDU_SIZE];
+
+    in.present = (uint16_t)((1U << SENSOR_SIG_DOOR) | (1U << SENSOR_SIG_GEAR));
+    in.door_open = 1;
+    in.gear = 1;
+    in.internal_temp = TEST_IN_TEMP;
+    sensor_pdu_encode(&in, block);
+
+    out.internal_temp = TEST_UNTOUCHED;
+    out.speed = TEST_UNTOUCHED;
+    CU_ASSERT_TRUE(sensor_pdu_decode(block, &out));
+    CU_ASSERT_EQUAL(out.present, in.present);
+    CU_ASSERT_TRUE(sensor_pdu_has(&out, SENSOR_SIG_DOOR));
+    CU_ASSERT_FALSE(sensor_pdu_has(&out, SENSOR_SIG_SPEED));
+    CU_ASSERT_EQUAL(out.door_open, 1);
+    CU_ASSERT_EQUAL(out.gear, 1);
+    CU_ASSERT_EQUAL(out.internal_temp, TEST_UNTOUCHED);
+    CU_ASSERT_DOUBLE_EQUAL(out.speed, TEST_UNTOUCHED, TEST_DELTA);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: text messages are not mistaken for a PDU, out of range values saturate
+ * ---------------------------------------------------------------------------*/
+static void test_sensor_pdu_text_and_limits(void)
+{
+    SensorPdu in = {0};
+    SensorPdu out = {0};
+    unsigned char block[SENSOR_PDU_SIZE] = {0};
+
+    (void)memcpy(block, "press_start_stop", SENSOR_PDU_SIZE);
+    CU_ASSERT_FALSE(sensor_pdu_is_pdu(block));
+    CU_ASSERT_FALSE(sensor_pdu_decode(block, &out));
+
+    in.present = (uint16_t)(1U << SENSOR_SIG_SPEED);
+    in.speed = TEST_SPEED_HUGE;
+    sensor_pdu_encode(&in, block);
+    CU_ASSERT_TRUE(sensor_pdu_decode(block, &out));
+    CU_ASSERT_DOUBLE_EQUAL(out.speed, (double)UINT16_MAX / 10.0, TEST_DELTA);
+}
+
+int main(void)
+{
+    if (CUE_SUCCESS != CU_initialize_registry()) {
+        return CU_get_error();
+    }
+
+    CU_pSuite suite = CU_add_suite("Sensor PDU Test Suite", init_suite, clean_suite);
+    if (!suite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Add tests */
+    CU_add_test(suite, "round trip",            test_sensor_pdu_round_trip);
+    CU_add_test(suite, "partial update",        test_sensor_pdu_partial);
+    CU_add_test(suite, "text and limits",       test_sensor_pdu_text_and_limits);
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+    unsigned int fails = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return (fails == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,332 @@
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../src/powertrain/stop_start_mc.h"
+#include "../../src/bcm/bcm_trace.h"
+#include "../../src/common_includes/drive_cycle.h"
+
+#define CYCLE_PATH          "../src/bcm/full_simu.csv"
+#define SHORT_STEPS         (200U)
+#define GAUSS_SAMPLES       (100000U)
+#define TEST_SEED           (7U)
+#define TEST_REPLICAS       (24U)
+
+static RuleSet rules;
+static SignalTrace clean;
+static McReplica results_one[TEST_REPLICAS];
+static McReplica results_many[TEST_REPLICAS];
+
+static int init_suite(void)
+{
+    return (rule_set_load_default(&rules) && bcm_cycle_trace(CYCLE_PATH, &clean)) ? 0 : -1;
+}
+
+static int clean_suite(void)
+{
+    signal_trace_free(&clean);
+    return 0;
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: signal table and noise specs
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_mc_noise_config
+ * @brief Trace signals are the rule signals in the same order, and noise
+ * specs set one signal or all of them and refuse bad settings
+ * @req SWR2.2
+ * @file unit/test_stop_start_mc.c
+ */
+static void test_mc_noise_config(void)
+{
+    NoiseConfig config;
+    const char *error = NULL;
+    bool same_names = true;
+
+    for (size_t i = 0U; i < TRACE_SIGNAL_COUNT; i++)
+    {
+        same_names = same_names && (strcmp(signal_trace_name((TraceSignal)i), rule_set_signal_name(i)) == 0);
+    }
+    CU_ASSERT_TRUE(same_names);
+    CU_ASSERT_PTR_NULL(rule_set_signal_name(TRACE_SIGNAL_COUNT));
+    CU_ASSERT_EQUAL(signal_trace_find("tilt_angle"), TRACE_TILT_ANGLE);
+    CU_ASSERT_EQUAL(signal_trace_find("tilt"), -1);
+
+    noise_config_clear(&config);
+    CU_ASSERT_TRUE(noise_config_parse(&config, "all:dropout=0.02", &error));
+    CU_ASSERT_TRUE(noise_config_parse(&config, "tilt_angle:sigma=0.5,latency=2,jitter=1,bias=-0.1", &error));
+    CU_ASSERT_DOUBLE_EQUAL(config.models[TRACE_GEAR].dropout, 0.02, 1e-12);
+    CU_ASSERT_DOUBLE_EQUAL(config.models[TRACE_TILT_ANGLE].dropout, 0.02, 1e-12);
+    CU_ASSERT_DOUBLE_EQUAL(config.models[TRACE_TILT_ANGLE].sigma, 0.5, 1e-12);
+    CU_ASSERT_DOUBLE_EQUAL(config.models[TRACE_TILT_ANGLE].bias, -0.1, 1e-12);
+    CU_ASSERT_EQUAL(config.models[TRACE_TILT_ANGLE].latency, 2U);
+    CU_ASSERT_EQUAL(config.models[TRACE_TILT_ANGLE].jitter, 1U);
+    CU_ASSERT_DOUBLE_EQUAL(config.models[TRACE_SPEED].sigma, 0.0, 1e-12);
+
+    CU_ASSERT_FALSE(noise_config_parse(&config, "tilt_angle", &error));
+    CU_ASSERT_PTR_NOT_NULL(error);
+    CU_ASSERT_FALSE(noise_config_parse(&config, "tilt:sigma=1", &error));
+    CU_ASSERT_FALSE(noise_config_parse(&config, "speed:sigma=-1", &error));
+    CU_ASSERT_FALSE(noise_config_parse(&config, "speed:dropout=1.5", &error));
+    CU_ASSERT_FALSE(noise_config_parse(&config, "speed:latency=-1", &error));
+    CU_ASSERT_FALSE(noise_config_parse(&config, "speed:gain=2", &error));
+    CU_ASSERT_FALSE(noise_config_parse(&config, "speed:sigma", &error));
+    // A refused spec leaves the model as it was
+    CU_ASSERT_DOUBLE_EQUAL(config.models[TRACE_SPEED].sigma, 0.0, 1e-12);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: noise, latency and dropout models
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_mc_noise_models
+ * @brief Latency delays a ramp, full dropout holds the first sample, Gaussian
+ * noise has the requested spread, integer signals stay integers and a replica
+ * key always gives the same perturbation
+ * @req SWR2.2
+ * @file unit/test_stop_start_mc.c
+ */
+static void test_mc_noise_models(void)
+{
+    SignalTrace ramp;
+    SignalTrace out;
+    SignalTrace again;
+    NoiseConfig config;
+    const uint64_t key = drive_cycle_key(TEST_SEED, 0U);
+    bool delayed = true;
+    bool held = true;
+    bool integer = true;
+    double sum = 0.0;
+    double squares = 0.0;
+
+    CU_ASSERT_TRUE_FATAL(signal_trace_alloc(&ramp, SHORT_STEPS));
+    CU_ASSERT_TRUE_FATAL(signal_trace_alloc(&out, SHORT_STEPS));
+    CU_ASSERT_TRUE_FATAL(signal_trace_alloc(&again, SHORT_STEPS));
+    for (size_t s = 0U; s < SHORT_STEPS; s++)
+    {
+        ramp.values[TRACE_SPEED][s] = (double)s;
+        ramp.values[TRACE_DOOR_OPEN][s] = (double)(s % 2U);
+        ramp.values[TRACE_EXTERNAL_TEMP][s] = 25.0;
+    }
+
+    noise_config_clear(&config);
+    config.models[TRACE_SPEED].latency = 3U;
+    config.models[TRACE_DOOR_OPEN].dropout = 1.0;
+    config.models[TRACE_EXTERNAL_TEMP].sigma = 2.0;
+    sensor_noise_apply(&ramp, &config, key, &out);
+    for (size_t s = 0U; s < SHORT_STEPS; s++)
+    {
+        delayed = delayed && (out.values[TRACE_SPEED][s] == ((s > 3U) ? (double)(s - 3U) : 0.0));
+        held = held && (out.values[TRACE_DOOR_OPEN][s] == 0.0);
+        integer = integer && (out.values[TRACE_EXTERNAL_TEMP][s] == nearbyint(out.values[TRACE_EXTERNAL_TEMP][s]));
+    }
+    CU_ASSERT_TRUE(delayed);
+    CU_ASSERT_TRUE(held);
+    CU_ASSERT_TRUE(integer);
+    // Signals without a model are copied
+    CU_ASSERT_EQUAL(memcmp(out.values[TRACE_TILT_ANGLE], ramp.values[TRACE_TILT_ANGLE],
+                           SHORT_STEPS * sizeof(double)), 0);
+
+    // Same key, same replica; another key, another one
+    sensor_noise_apply(&ramp, &config, key, &again);
+    CU_ASSERT_EQUAL(memcmp(out.values[TRACE_EXTERNAL_TEMP], again.values[TRACE_EXTERNAL_TEMP],
+                           SHORT_STEPS * sizeof(double)), 0);
+    sensor_noise_apply(&ramp, &config, drive_cycle_key(TEST_SEED, 1U), &again);
+    CU_ASSERT_NOT_EQUAL(memcmp(out.values[TRACE_EXTERNAL_TEMP], again.values[TRACE_EXTERNAL_TEMP],
+                               SHORT_STEPS * sizeof(double)), 0);
+
+    for (uint32_t i = 0U; i < GAUSS_SAMPLES; i++)
+    {
+        const double g = sensor_noise_gaussian(key, i, 0U);
+        sum += g;
+        squares += g * g;
+    }
+    CU_ASSERT_DOUBLE_EQUAL(sum / (double)GAUSS_SAMPLES, 0.0, 0.02);
+    CU_ASSERT_DOUBLE_EQUAL(sqrt(squares / (double)GAUSS_SAMPLES), 1.0, 0.02);
+
+    signal_trace_free(&again);
+    signal_trace_free(&out);
+    signal_trace_free(&ramp);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: trace evaluation matches the step by step one
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_mc_trace_evaluation
+ * @brief Builds the clean trace of full_simu.csv as the BCM publishes it and
+ * checks that evaluating the rules over the trace gives, at every step, the
+ * mask rule_set_evaluate gives for the same vehicle data
+ * @req SWR2.2
+ * @file unit/test_stop_start_mc.c
+ */
+static void test_mc_trace_evaluation(void)
+{
+    unsigned int *satisfied = (unsigned int *)malloc(clean.steps * sizeof(unsigned int));
+    VehicleData data;
+    bool same = true;
+    bool allowed = false;
+
+    CU_ASSERT_PTR_NOT_NULL_FATAL(satisfied);
+    CU_ASSERT_EQUAL(clean.steps, 1877U);
+    CU_ASSERT_DOUBLE_EQUAL(clean.values[TRACE_TEMP_SET][0], 23.0, 1e-12);
+    CU_ASSERT_TRUE(clean.values[TRACE_BATT_SOC][0] < 80.0);
+
+    rule_set_evaluate_trace(&rules, (const double *const *)clean.values, clean.steps, satisfied);
+    (void)memset(&data, 0, sizeof(data));
+    for (size_t s = 0U; s < clean.steps; s++)
+    {
+        data.speed = clean.values[TRACE_SPEED][s];
+        data.internal_temp = (int)clean.values[TRACE_INTERNAL_TEMP][s];
+        data.external_temp = (int)clean.values[TRACE_EXTERNAL_TEMP][s];
+        data.door_open = (int)clean.values[TRACE_DOOR_OPEN][s];
+        data.tilt_angle = clean.values[TRACE_TILT_ANGLE][s];
+        data.accel = (int)clean.values[TRACE_ACCEL][s];
+        data.brake = (int)clean.values[TRACE_BRAKE][s];
+        data.temp_set = (int)clean.values[TRACE_TEMP_SET][s];
+        data.batt_soc = clean.values[TRACE_BATT_SOC][s];
+        data.batt_volt = clean.values[TRACE_BATT_VOLT][s];
+        data.engi_temp = clean.values[TRACE_ENGI_TEMP][s];
+        data.gear = (int)clean.values[TRACE_GEAR][s];
+        same = same && (satisfied[s] == rule_set_evaluate(&rules, &data));
+        allowed = allowed || (satisfied[s] == rules.all_bits);
+    }
+    CU_ASSERT_TRUE(same);
+    CU_ASSERT_TRUE(allowed);
+    free(satisfied);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: replicas
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_mc_replicas
+ * @brief A refused restart ends the replay (SWR3.5); without noise every
+ * replica is the clean replay; with noise the
+ * results do not depend on the thread count, spurious inhibits are blamed on
+ * the noisy condition and the distribution summary is ordered
+ * @req SWR2.2
+ * @req SWR3.5
+ * @file unit/test_stop_start_mc.c
+ */
+static void test_mc_replicas(void)
+{
+    unsigned int *satisfied = (unsigned int *)malloc(clean.steps * sizeof(unsigned int));
+    NoiseConfig noise;
+    McConfig config;
+    SignalTrace flat;
+    McReplica baseline;
+    McReplica disabled;
+    McDistribution dist;
+    bool all_clean = true;
+    bool tilt_only = true;
+    unsigned long inhibits = 0UL;
+
+    CU_ASSERT_PTR_NOT_NULL_FATAL(satisfied);
+    rule_set_evaluate_trace(&rules, (const double *const *)clean.values, clean.steps, satisfied);
+    mc_replay(&rules, &clean, satisfied, &baseline);
+    CU_ASSERT_TRUE(baseline.engine_offs > 0UL);
+    CU_ASSERT_TRUE(baseline.restarts > 0UL);
+    CU_ASSERT_TRUE(baseline.engine_off_steps > baseline.engine_offs);
+
+    // Flat battery with every condition forced: the first restart is refused and disables Stop/Start
+    CU_ASSERT_TRUE_FATAL(signal_trace_alloc(&flat, clean.steps));
+    for (size_t i = 0U; i < TRACE_SIGNAL_COUNT; i++)
+    {
+        (void)memcpy(flat.values[i], clean.values[i], clean.steps * sizeof(double));
+    }
+    for (size_t s = 0U; s < clean.steps; s++)
+    {
+        flat.values[TRACE_BATT_SOC][s] = 0.0;
+        satisfied[s] = rules.all_bits;
+    }
+    mc_replay(&rules, &flat, satisfied, &disabled);
+    CU_ASSERT_EQUAL(disabled.engine_offs, 1UL);
+    CU_ASSERT_EQUAL(disabled.restarts, 0UL);
+    CU_ASSERT_EQUAL(disabled.restart_failures, 1UL);
+    CU_ASSERT_TRUE(disabled.engine_off_steps < clean.steps);
+    signal_trace_free(&flat);
+    free(satisfied);
+
+    noise_config_clear(&noise);
+    (void)memset(&config, 0, sizeof(config));
+    config.rules = &rules;
+    config.clean = &clean;
+    config.noise = &noise;
+    config.seed = TEST_SEED;
+    config.replicas = TEST_REPLICAS;
+    config.threads = 3U;
+    CU_ASSERT_TRUE_FATAL(mc_run(&config, results_many));
+    for (size_t i = 0U; i < TEST_REPLICAS; i++)
+    {
+        all_clean = all_clean && (memcmp(&results_many[i], &baseline, sizeof(baseline)) == 0);
+    }
+    CU_ASSERT_TRUE(all_clean);
+
+    // Tilt noise only: replicas vary, blame falls on the tilt condition
+    noise.models[TRACE_TILT_ANGLE].sigma = 1.0;
+    CU_ASSERT_TRUE_FATAL(mc_run(&config, results_many));
+    config.threads = 1U;
+    CU_ASSERT_TRUE_FATAL(mc_run(&config, results_one));
+    CU_ASSERT_EQUAL(memcmp(results_one, results_many, sizeof(results_one)), 0);
+    for (size_t i = 0U; i < TEST_REPLICAS; i++)
+    {
+        inhibits += results_one[i].spurious_inhibits;
+        for (size_t c = 0U; c < rules.num_conditions; c++)
+        {
+            if (strcmp(rules.conditions[c].name, "tilt") == 0)
+            {
+                tilt_only = tilt_only && (results_one[i].blame[c] == results_one[i].spurious_inhibits);
+            }
+            else
+            {
+                tilt_only = tilt_only && (results_one[i].blame[c] == 0UL);
+            }
+        }
+    }
+    CU_ASSERT_TRUE(inhibits > 0UL);
+    CU_ASSERT_TRUE(tilt_only);
+
+    CU_ASSERT_TRUE(mc_distribution(results_one, TEST_REPLICAS, offsetof(McReplica, spurious_inhibits), &dist));
+    CU_ASSERT_TRUE((dist.min <= dist.p5) && (dist.p5 <= dist.p50) && (dist.p50 <= dist.p95) &&
+                   (dist.p95 <= dist.max));
+    CU_ASSERT_DOUBLE_EQUAL(dist.mean, (double)inhibits / (double)TEST_REPLICAS, 1e-9);
+    CU_ASSERT_TRUE(dist.stddev > 0.0);
+    CU_ASSERT_FALSE(mc_distribution(results_one, 0U, 0U, &dist));
+    CU_ASSERT_FALSE(mc_distribution(results_one, TEST_REPLICAS, sizeof(McReplica), &dist));
+
+    // Bad configurations are refused
+    config.threads = 0U;
+    CU_ASSERT_FALSE(mc_run(&config, results_one));
+}
+
+int main(void)
+{
+    if (CUE_SUCCESS != CU_initialize_registry()) {
+        return CU_get_error();
+    }
+
+    CU_pSuite suite = CU_add_suite("Stop/Start Monte Carlo Test Suite", init_suite, clean_suite);
+    if (!suite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Add tests */
+    CU_add_test(suite, "noise specs",           test_mc_noise_config);
+    CU_add_test(suite, "noise models",          test_mc_noise_models);
+    CU_add_test(suite, "trace evaluation",      test_mc_trace_evaluation);
+    CU_add_test(suite, "replicas",              test_mc_replicas);
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+    unsigned int fails = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return (fails == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
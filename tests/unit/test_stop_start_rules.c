@@ -0,0 +1,218 @@
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../../src/powertrain/powertrain_func.h"
+#include "../../src/powertrain/stop_start_rules.h"
+
+#define RULES_CONF_PATH     "../src/powertrain/stop_start_rules.conf"
+#define RULES_TMP_PATH      "/tmp/unit_test_rules.conf"
+#define TEMP_SET_OK         (22)
+#define VARIANT_MIN_SOC     (85.0)
+#define SOC_BETWEEN         (80.0)
+
+/* Suite init/cleanup (no special steps here) */
+static int init_suite(void)  { return 0; }
+static int clean_suite(void) { (void)unlink(RULES_TMP_PATH); return 0; }
+
+static VehicleData stopped_vehicle(void)
+{
+    VehicleData data = {
+        .speed = 0.0, .internal_temp = TEMP_SET_OK + 3, .external_temp = TEMP_SET_OK + 8,
+        .door_open = 0, .tilt_angle = 1.0, .accel = 0, .brake = 1,
+        .temp_set = TEMP_SET_OK, .batt_soc = SOC_BETWEEN, .batt_volt = 12.6,
+        .engi_temp = 90.0, .gear = 0
+    };
+    return data;
+}
+
+static void write_rules(const char *text)
+{
+    FILE *file = fopen(RULES_TMP_PATH, "w");
+    CU_ASSERT_PTR_NOT_NULL_FATAL(file);
+    (void)fputs(text, file);
+    (void)fclose(file);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: built-in rules keep the historical conditions and bit layout
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_rules_default
+ * @brief Checks the built-in inhibit rules against each condition boundary
+ * @req SWR2.2
+ * @req SWR2.3
+ * @req SWR2.4
+ * @file unit/test_stop_start_rules.c
+ */
+static void test_rules_default(void)
+{
+    static RuleSet rules;
+    VehicleData data = stopped_vehicle();
+
+    CU_ASSERT_TRUE_FATAL(rule_set_load_default(&rules));
+    CU_ASSERT_EQUAL(rules.num_conditions, 6U);
+    CU_ASSERT_EQUAL(rules.all_bits, COND_BITS_ALL);
+    CU_ASSERT_STRING_EQUAL(rules.conditions[4].can_error, "error_door_open");
+    CU_ASSERT_EQUAL(rule_set_evaluate(&rules, &data), COND_BITS_ALL);
+
+    data.internal_temp = TEMP_SET_OK + 5;      // Boundary is inclusive
+    CU_ASSERT_EQUAL(rule_set_evaluate(&rules, &data), COND_BITS_ALL);
+    data.internal_temp = TEMP_SET_OK + 6;
+    CU_ASSERT_EQUAL(rule_set_evaluate(&rules, &data), COND_BITS_ALL & ~COND_BIT_TEMPERATURE);
+
+    data = stopped_vehicle();
+    data.batt_volt = 10.0;                     // Strictly above 10 V
+    data.gear = 1;
+    CU_ASSERT_EQUAL(rule_set_evaluate(&rules, &data),
+                    COND_BITS_ALL & ~(COND_BIT_BATTERY | COND_BIT_MOVEMENT));
+
+    data = stopped_vehicle();
+    data.engi_temp = 105.5;
+    data.tilt_angle = 5.1;
+    CU_ASSERT_EQUAL(rule_set_evaluate(&rules, &data),
+                    COND_BITS_ALL & ~(COND_BIT_ENGINE_TEMP | COND_BIT_TILT));
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: the shipped rule file compiles to the same rules as the built-in set
+ * ---------------------------------------------------------------------------*/
+static void test_rules_file_matches_default(void)
+{
+    static RuleSet from_file;
+    static RuleSet builtin;
+
+    CU_ASSERT_TRUE_FATAL(rule_set_load_file(&from_file, RULES_CONF_PATH));
+    CU_ASSERT_TRUE_FATAL(rule_set_load_default(&builtin));
+    CU_ASSERT_EQUAL(from_file.num_rules, builtin.num_rules);
+    CU_ASSERT_EQUAL(from_file.num_conditions, builtin.num_conditions);
+    CU_ASSERT_EQUAL(memcmp(from_file.rules, builtin.rules,
+                           builtin.num_rules * sizeof(CompiledRule)), 0);
+    for (size_t i = 0U; i < builtin.num_conditions; i++)
+    {
+        CU_ASSERT_STRING_EQUAL(from_file.conditions[i].can_error, builtin.conditions[i].can_error);
+        CU_ASSERT_STRING_EQUAL(from_file.conditions[i].system_log, builtin.conditions[i].system_log);
+    }
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: two calibrations evaluated side by side, and rule file errors
+ * ---------------------------------------------------------------------------*/
+static void test_rules_variant_and_errors(void)
+{
+    static RuleSet builtin;
+    static RuleSet variant;
+    static RuleSet unchanged;
+    const char *error = NULL;
+    VehicleData data = stopped_vehicle();
+
+    write_rules("# stricter battery, cabin comfort relative to the set point\n"
+                "rule battery batt_soc >= 85\n"
+                "rule comfort internal_temp < temp_set+3\n"
+                "rule comfort external_temp != temp_set-1\n"
+                "message comfort error_comfort   Cabin not comfortable\n");
+    CU_ASSERT_TRUE_FATAL(rule_set_load_default(&builtin));
+    CU_ASSERT_TRUE_FATAL(rule_set_load_file(&variant, RULES_TMP_PATH));
+    CU_ASSERT_EQUAL(variant.num_conditions, 2U);
+    CU_ASSERT_STRING_EQUAL(variant.conditions[0].can_error, "error_battery");
+    CU_ASSERT_STRING_EQUAL(variant.conditions[1].system_log, "Cabin not comfortable");
+
+    // Same data, different calibrations
+    CU_ASSERT_TRUE(data.batt_soc < VARIANT_MIN_SOC);
+    CU_ASSERT_EQUAL(rule_set_evaluate(&builtin, &data), COND_BITS_ALL);
+    CU_ASSERT_EQUAL(rule_set_evaluate(&variant, &data), 0U);
+    data.batt_soc = VARIANT_MIN_SOC;
+    data.internal_temp = TEMP_SET_OK + 2;
+    CU_ASSERT_EQUAL(rule_set_evaluate(&variant, &data), variant.all_bits);
+
+    CU_ASSERT_FALSE(rule_set_parse_line(&unchanged, "rule x speedy == 0", &error));
+    CU_ASSERT_STRING_EQUAL(error, "unknown signal");
+    CU_ASSERT_FALSE(rule_set_parse_line(&unchanged, "rule x speed =< 0", &error));
+    CU_ASSERT_STRING_EQUAL(error, "unknown comparator");
+    CU_ASSERT_FALSE(rule_set_parse_line(&unchanged, "rule x speed == temp_set*2", &error));
+    CU_ASSERT_STRING_EQUAL(error, "bad operand");
+    CU_ASSERT_FALSE(rule_set_parse_line(&unchanged, "rule x speed ==", &error));
+    CU_ASSERT_FALSE(rule_set_parse_line(&unchanged, "inhibit x speed == 0", &error));
+    CU_ASSERT_STRING_EQUAL(error, "unknown directive");
+
+    // A bad file is refused and the active rules stay in place
+    write_rules("rule door door_open == 0\nrule door door_open ~ 1\n");
+    CU_ASSERT_FALSE(rule_set_load_file(&unchanged, RULES_TMP_PATH));
+    CU_ASSERT_FALSE(load_stop_start_rules(RULES_TMP_PATH));
+    CU_ASSERT_EQUAL(get_stop_start_rules()->all_bits, COND_BITS_ALL);
+    CU_ASSERT_FALSE(load_stop_start_rules("/tmp/unit_test_rules_missing.conf"));
+
+    CU_ASSERT_TRUE(load_stop_start_rules(RULES_CONF_PATH));
+    CU_ASSERT_EQUAL(get_stop_start_rules()->all_bits, COND_BITS_ALL);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: engine state machine shared by the powertrain and the Monte Carlo
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_rules_engine_state
+ * @brief The engine goes off only with no failed condition, restarts on a
+ * brake release or an accelerator press with a good battery, and a refused
+ * restart disables Stop/Start until the state is reset
+ * @req SWR2.2
+ * @req SWR2.5
+ * @req SWR3.1
+ * @req SWR3.5
+ * @file unit/test_stop_start_rules.c
+ */
+static void test_rules_engine_state(void)
+{
+    StopStartState state = { false, false, false };
+
+    CU_ASSERT_FALSE(stop_start_engine_off(&state, COND_BIT_DOOR));
+    CU_ASSERT_TRUE(stop_start_engine_off(&state, 0U));
+    CU_ASSERT_TRUE(state.engine_off);
+    CU_ASSERT_FALSE(stop_start_engine_off(&state, 0U));
+
+    // Brake held: no request; brake released: restart
+    CU_ASSERT_EQUAL(stop_start_restart(&state, true, true, false, false, 12.6, SOC_BETWEEN), SS_RESTART_NONE);
+    CU_ASSERT_EQUAL(stop_start_restart(&state, false, true, false, false, 12.6, SOC_BETWEEN), SS_RESTART_DONE);
+    CU_ASSERT_FALSE(state.engine_off);
+    CU_ASSERT_FALSE(state.restart_trigger);
+    CU_ASSERT_EQUAL(stop_start_restart(&state, false, true, false, false, 12.6, SOC_BETWEEN), SS_RESTART_NONE);
+
+    // Accelerator pressed on a low battery: refused, Stop/Start disabled
+    CU_ASSERT_TRUE(stop_start_engine_off(&state, 0U));
+    CU_ASSERT_EQUAL(stop_start_restart(&state, false, false, true, false, 12.6, MIN_BATTERY_SOC - 1.0),
+                    SS_RESTART_REFUSED);
+    CU_ASSERT_TRUE(state.disabled);
+    CU_ASSERT_TRUE(state.restart_trigger);
+    CU_ASSERT_EQUAL(stop_start_restart(&state, false, false, true, false, 12.6, SOC_BETWEEN), SS_RESTART_NONE);
+    state.engine_off = false;
+    CU_ASSERT_FALSE(stop_start_engine_off(&state, 0U));
+}
+
+int main(void)
+{
+    if (CUE_SUCCESS != CU_initialize_registry()) {
+        return CU_get_error();
+    }
+
+    CU_pSuite suite = CU_add_suite("Stop/Start Rules Test Suite", init_suite, clean_suite);
+    if (!suite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Add tests */
+    CU_add_test(suite, "default rules",         test_rules_default);
+    CU_add_test(suite, "rule file",             test_rules_file_matches_default);
+    CU_add_test(suite, "variant and errors",    test_rules_variant_and_errors);
+    CU_add_test(suite, "engine state",          test_rules_engine_state);
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+    unsigned int fails = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return (fails == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,171 @@
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../../src/common_includes/telemetry.h"
+
+#define TEST_TELEMETRY_PATH "/tmp/unit_test_telemetry.bin"
+#define TEST_COLUMNS        (3U)
+#define TEST_ROWS           (TELEMETRY_BLOCK_ROWS + 10U)  // Two blocks, the last one partial
+#define TEST_TIME_BASE      (1700000000000LL)
+#define TEST_STEP_MS        (1000LL)
+#define TEST_SPEED_SCALE    (10U)
+#define TEST_MAX_ONE_BYTE   (63)        // Largest |delta| stored in one varint byte
+#define TEST_DELTA          (0.0001)
+
+/* Suite init/cleanup (no special steps here) */
+static int init_suite(void)  { return 0; }
+static int clean_suite(void) { (void)unlink(TEST_TELEMETRY_PATH); return 0; }
+
+static const TelemetryColumn test_columns[TEST_COLUMNS] = {
+    { "time_ms", 1U },
+    { "speed", TEST_SPEED_SCALE },
+    { "engine_off", 1U }
+};
+
+static double test_speed(unsigned int row)
+{
+    return (double)(row % 50U) * 1.5 - 20.0;   // Also exercises negative deltas
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: zigzag varint encoding
+ * ---------------------------------------------------------------------------*/
+/**
+ * @test test_telemetry_varint
+ * @brief Checks the varint encoding of small, negative and extreme values
+ * @req SWR1.4
+ * @file unit/test_telemetry.c
+ */
+static void test_telemetry_varint(void)
+{
+    static const int64_t values[] = {
+        0, 1, -1, TEST_MAX_ONE_BYTE, -TEST_MAX_ONE_BYTE - 1, 1000, -123456789,
+        INT64_MAX, INT64_MIN
+    };
+    unsigned char buffer[TELEMETRY_VARINT_MAX];
+    int64_t decoded = 0;
+
+    for (size_t i = 0U; i < (sizeof(values) / sizeof(values[0])); i++)
+    {
+        const size_t len = telemetry_put_varint(buffer, values[i]);
+        CU_ASSERT_TRUE((len > 0U) && (len <= TELEMETRY_VARINT_MAX));
+        CU_ASSERT_EQUAL(telemetry_get_varint(buffer, len, &decoded), len);
+        CU_ASSERT_EQUAL(decoded, values[i]);
+    }
+
+    // Small deltas of either sign fit in one byte
+    CU_ASSERT_EQUAL(telemetry_put_varint(buffer, TEST_MAX_ONE_BYTE), 1U);
+    CU_ASSERT_EQUAL(telemetry_put_varint(buffer, -TEST_MAX_ONE_BYTE - 1), 1U);
+
+    // A truncated varint is rejected
+    const size_t len = telemetry_put_varint(buffer, INT64_MAX);
+    CU_ASSERT_EQUAL(telemetry_get_varint(buffer, len - 1U, &decoded), 0U);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: rows written over several blocks are read back unchanged
+ * ---------------------------------------------------------------------------*/
+static void test_telemetry_round_trip(void)
+{
+    static TelemetryWriter writer;
+    static TelemetryReader reader;
+    int64_t row[TEST_COLUMNS];
+    unsigned int read_rows = 0U;
+
+    CU_ASSERT_TRUE_FATAL(telemetry_open(&writer, TEST_TELEMETRY_PATH, test_columns,
+                                        TEST_COLUMNS, TELEMETRY_CODEC_ZSTD));
+    for (unsigned int i = 0U; i < TEST_ROWS; i++)
+    {
+        row[0] = TEST_TIME_BASE + ((long long)i * TEST_STEP_MS);
+        row[1] = telemetry_scale(test_speed(i), TEST_SPEED_SCALE);
+        row[2] = (int64_t)((i / 7U) % 2U);
+        CU_ASSERT_TRUE(telemetry_append(&writer, row));
+    }
+    CU_ASSERT_EQUAL(writer.total_rows, TEST_ROWS);
+    CU_ASSERT_TRUE(telemetry_close(&writer));
+
+    CU_ASSERT_TRUE_FATAL(telemetry_reader_open(&reader, TEST_TELEMETRY_PATH));
+    CU_ASSERT_EQUAL(reader.num_columns, TEST_COLUMNS);
+    CU_ASSERT_STRING_EQUAL(reader.columns[1].name, "speed");
+    CU_ASSERT_EQUAL(telemetry_column_index(&reader, "engine_off"), 2);
+    CU_ASSERT_EQUAL(telemetry_column_index(&reader, "missing"), -1);
+
+    while (telemetry_read_block(&reader))
+    {
+        for (unsigned int r = 0U; r < reader.rows; r++)
+        {
+            const unsigned int i = read_rows + r;
+            CU_ASSERT_EQUAL(reader.values[0][r], TEST_TIME_BASE + ((long long)i * TEST_STEP_MS));
+            CU_ASSERT_DOUBLE_EQUAL(telemetry_value(&reader, 1U, r), test_speed(i), TEST_DELTA);
+            CU_ASSERT_EQUAL(reader.values[2][r], (int64_t)((i / 7U) % 2U));
+        }
+        read_rows += reader.rows;
+    }
+    CU_ASSERT_EQUAL(read_rows, TEST_ROWS);
+    telemetry_reader_close(&reader);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: storage cost and refusal of foreign files
+ * ---------------------------------------------------------------------------*/
+static void test_telemetry_size_and_format(void)
+{
+    static TelemetryWriter writer;
+    static TelemetryReader reader;
+    int64_t row[TEST_COLUMNS] = {0};
+
+    CU_ASSERT_TRUE_FATAL(telemetry_open(&writer, TEST_TELEMETRY_PATH, test_columns,
+                                        TEST_COLUMNS, TELEMETRY_CODEC_NONE));
+    for (unsigned int i = 0U; i < TELEMETRY_BLOCK_ROWS; i++)
+    {
+        row[0] = TEST_TIME_BASE + ((long long)i * TEST_STEP_MS);
+        CU_ASSERT_TRUE(telemetry_append(&writer, row));
+    }
+    CU_ASSERT_TRUE(telemetry_close(&writer));
+
+    // Steady 1 s steps: 2 bytes for the time delta, 1 byte per other column
+    FILE *file = fopen(TEST_TELEMETRY_PATH, "rb");
+    CU_ASSERT_PTR_NOT_NULL_FATAL(file);
+    (void)fseek(file, 0L, SEEK_END);
+    const long size = ftell(file);
+    (void)fclose(file);
+    CU_ASSERT_TRUE(size < (long)(TELEMETRY_BLOCK_ROWS * (TEST_COLUMNS + 2U) + 256U));
+
+    // Anything else than a telemetry file is refused
+    file = fopen(TEST_TELEMETRY_PATH, "w");
+    CU_ASSERT_PTR_NOT_NULL_FATAL(file);
+    (void)fputs("time_ms,speed,engine_off\n", file);
+    (void)fclose(file);
+    CU_ASSERT_FALSE(telemetry_reader_open(&reader, TEST_TELEMETRY_PATH));
+    CU_ASSERT_FALSE(telemetry_reader_open(&reader, "/tmp/unit_test_telemetry_missing.bin"));
+}
+
+int main(void)
+{
+    if (CUE_SUCCESS != CU_initialize_registry()) {
+        return CU_get_error();
+    }
+
+    CU_pSuite suite = CU_add_suite("Telemetry Test Suite", init_suite, clean_suite);
+    if (!suite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Add tests */
+    CU_add_test(suite, "varint",                test_telemetry_varint);
+    CU_add_test(suite, "round trip",            test_telemetry_round_trip);
+    CU_add_test(suite, "size and format",       test_telemetry_size_and_format);
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+    unsigned int fails = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return (fails == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,183 @@
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../src/common_includes/timer_wheel.h"
+
+#define TICK_MS         (10LL)
+#define MAX_FIRED       (64U)
+#define REVOLUTION_MS   ((long long)TIMER_WHEEL_SLOTS * TICK_MS)
+
+static char fired_ids[MAX_FIRED + 1U];
+static long long fired_due[MAX_FIRED];
+static size_t num_fired = 0U;
+static TimerWheel wheel;
+
+/* Records which timer fired (its arg is a one-letter id) and when it was due */
+static void record(TimerEntry *timer, long long due_ms)
+{
+    if (num_fired < MAX_FIRED)
+    {
+        fired_ids[num_fired] = *(const char *)timer->arg;
+        fired_due[num_fired] = due_ms;
+        num_fired++;
+        fired_ids[num_fired] = '\0';
+    }
+}
+
+static void cancel_after_three(TimerEntry *timer, long long due_ms)
+{
+    record(timer, due_ms);
+    if (num_fired == 3U)
+    {
+        timer_wheel_cancel(&wheel, timer);
+    }
+}
+
+static int init_suite(void)  { return 0; }
+static int clean_suite(void) { return 0; }
+
+static void reset(long long now_ms)
+{
+    num_fired = 0U;
+    fired_ids[0] = '\0';
+    timer_wheel_init(&wheel, TICK_MS, now_ms);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: timers fire in expiry order, ties in arming order, never early
+ * ---------------------------------------------------------------------------*/
+static void test_timer_wheel_order(void)
+{
+    TimerEntry a, b, c, d, e;
+    static const char ids[] = "ABCDE";
+
+    (void)memset(&a, 0, sizeof(a)); (void)memset(&b, 0, sizeof(b));
+    (void)memset(&c, 0, sizeof(c)); (void)memset(&d, 0, sizeof(d));
+    (void)memset(&e, 0, sizeof(e));
+    reset(0);
+
+    CU_ASSERT_EQUAL(timer_wheel_next_expiry(&wheel), -1);
+    CU_ASSERT_TRUE(timer_wheel_add(&wheel, &a, 0, 30, 0, record, (void *)&ids[0]));
+    CU_ASSERT_TRUE(timer_wheel_add(&wheel, &b, 0, 10, 0, record, (void *)&ids[1]));
+    CU_ASSERT_TRUE(timer_wheel_add(&wheel, &c, 0, 30, 0, record, (void *)&ids[2]));
+    CU_ASSERT_TRUE(timer_wheel_add(&wheel, &d, 0, 20, 0, record, (void *)&ids[3]));
+    // Same tick as A and C but 5 ms later: must wait for its own time
+    CU_ASSERT_TRUE(timer_wheel_add(&wheel, &e, 0, 35, 0, record, (void *)&ids[4]));
+    CU_ASSERT_EQUAL(wheel.armed, 5U);
+    CU_ASSERT_EQUAL(timer_wheel_next_expiry(&wheel), 10);
+
+    CU_ASSERT_EQUAL(timer_wheel_advance(&wheel, 9), 0U);
+    CU_ASSERT_EQUAL(timer_wheel_advance(&wheel, 34), 4U);
+    CU_ASSERT_STRING_EQUAL(fired_ids, "BDAC");
+    CU_ASSERT_EQUAL(fired_due[0], 10);
+    CU_ASSERT_EQUAL(fired_due[3], 30);
+    CU_ASSERT_FALSE(a.armed);
+    CU_ASSERT_TRUE(e.armed);
+
+    CU_ASSERT_EQUAL(timer_wheel_advance(&wheel, 35), 1U);
+    CU_ASSERT_STRING_EQUAL(fired_ids, "BDACE");
+    CU_ASSERT_EQUAL(fired_due[4], 35);
+    CU_ASSERT_EQUAL(wheel.armed, 0U);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: periodic timers, cancel from the callback, moving an armed timer
+ * ---------------------------------------------------------------------------*/
+static void test_timer_wheel_periodic(void)
+{
+    TimerEntry tick, self_cancel;
+    static const char ids[] = "PS";
+
+    (void)memset(&tick, 0, sizeof(tick));
+    (void)memset(&self_cancel, 0, sizeof(self_cancel));
+    reset(0);
+
+    CU_ASSERT_TRUE(timer_wheel_add(&wheel, &tick, 0, 0, 100, record, (void *)&ids[0]));
+    CU_ASSERT_EQUAL(timer_wheel_advance(&wheel, 1000), 11U);
+    CU_ASSERT_EQUAL(fired_due[10], 1000);
+    CU_ASSERT_EQUAL(timer_wheel_next_expiry(&wheel), 1100);
+
+    // Re-arming moves the timer instead of adding a second copy
+    CU_ASSERT_TRUE(timer_wheel_add(&wheel, &tick, 1000, 500, 0, record, (void *)&ids[0]));
+    CU_ASSERT_EQUAL(wheel.armed, 1U);
+    CU_ASSERT_EQUAL(timer_wheel_next_expiry(&wheel), 1500);
+    timer_wheel_cancel(&wheel, &tick);
+    timer_wheel_cancel(&wheel, &tick);
+    CU_ASSERT_EQUAL(wheel.armed, 0U);
+
+    reset(0);
+    CU_ASSERT_TRUE(timer_wheel_add(&wheel, &self_cancel, 0, 50, 50, cancel_after_three,
+                                   (void *)&ids[1]));
+    CU_ASSERT_EQUAL(timer_wheel_advance(&wheel, 10000), 3U);
+    CU_ASSERT_FALSE(self_cancel.armed);
+    CU_ASSERT_EQUAL(timer_wheel_next_expiry(&wheel), -1);
+
+    // Shorter than a tick, no callback, negative delay: refused
+    CU_ASSERT_FALSE(timer_wheel_add(&wheel, &tick, 0, 0, TICK_MS - 1, record, (void *)&ids[0]));
+    CU_ASSERT_FALSE(timer_wheel_add(&wheel, &tick, 0, 0, 0, NULL, NULL));
+    CU_ASSERT_FALSE(timer_wheel_add(&wheel, &tick, 0, -1, 0, record, (void *)&ids[0]));
+    CU_ASSERT_EQUAL(wheel.armed, 0U);
+}
+
+/* -----------------------------------------------------------------------------
+ * Test: timers more than one revolution away, idle gaps, overdue arming
+ * ---------------------------------------------------------------------------*/
+static void test_timer_wheel_far_and_overdue(void)
+{
+    TimerEntry far, farther, late;
+    static const char ids[] = "FGL";
+
+    (void)memset(&far, 0, sizeof(far));
+    (void)memset(&farther, 0, sizeof(farther));
+    (void)memset(&late, 0, sizeof(late));
+    reset(0);
+
+    // Same slot as "far", two revolutions later
+    CU_ASSERT_TRUE(timer_wheel_add(&wheel, &far, 0, REVOLUTION_MS + 40, 0, record, (void *)&ids[0]));
+    CU_ASSERT_TRUE(timer_wheel_add(&wheel, &farther, 0, (3 * REVOLUTION_MS) + 40, 0, record,
+                                   (void *)&ids[1]));
+    CU_ASSERT_EQUAL(timer_wheel_advance(&wheel, REVOLUTION_MS), 0U);
+    CU_ASSERT_EQUAL(timer_wheel_advance(&wheel, REVOLUTION_MS + 40), 1U);
+    CU_ASSERT_STRING_EQUAL(fired_ids, "F");
+
+    // A long idle stretch is skipped, not walked tick by tick
+    CU_ASSERT_EQUAL(timer_wheel_advance(&wheel, 1000000), 1U);
+    CU_ASSERT_STRING_EQUAL(fired_ids, "FG");
+    CU_ASSERT_EQUAL(fired_due[1], (3 * REVOLUTION_MS) + 40);
+    CU_ASSERT_EQUAL(wheel.next_tick, 1000000 / TICK_MS);
+
+    // Armed with a time already processed: fires on the next advance
+    CU_ASSERT_TRUE(timer_wheel_add(&wheel, &late, 999000, 0, 0, record, (void *)&ids[2]));
+    CU_ASSERT_EQUAL(timer_wheel_advance(&wheel, 1000000), 1U);
+    CU_ASSERT_STRING_EQUAL(fired_ids, "FGL");
+    CU_ASSERT_EQUAL(fired_due[2], 999000);
+}
+
+int main(void)
+{
+    if (CUE_SUCCESS != CU_initialize_registry()) {
+        return CU_get_error();
+    }
+
+    CU_pSuite suite = CU_add_suite("Timer Wheel Test Suite", init_suite, clean_suite);
+    if (!suite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Add tests */
+    CU_add_test(suite, "expiry order",          test_timer_wheel_order);
+    CU_add_test(suite, "periodic and cancel",   test_timer_wheel_periodic);
+    CU_add_test(suite, "far and overdue",       test_timer_wheel_far_and_overdue);
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+    unsigned int fails = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return (fails == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}